@@ -25,13 +25,16 @@
 
 #include "gdal_unit_test.h"
 
+#include "cpl_multiproc.h"
 #include "gdal_priv.h"
 #include "gdal_utils.h"
 #include "gdal_priv_templates.hpp"
 #include "gdal.h"
 
+#include <cmath>
 #include <limits>
 #include <string>
+#include <vector>
 
 #include "test_data.h"
 
@@ -602,4 +605,552 @@ namespace tut
         ensure( !GDALDataTypeIsConversionLossy(GDT_CFloat64, GDT_CFloat64) );
     }
 
+    // Test GDALRasterBand::ComputeStatisticsAndHistogram()
+    template<> template<> void object::test<17>()
+    {
+        GDALDriver* poMEMDrv = GetGDALDriverManager()->GetDriverByName("MEM");
+        const GDALDataType aeTypes[] = { GDT_UInt16, GDT_Float32 };
+        for( size_t iType = 0; iType < sizeof(aeTypes) / sizeof(aeTypes[0]);
+             iType++ )
+        {
+            GDALDataset* poDS =
+                poMEMDrv->Create("", 100, 100, 1, aeTypes[iType], nullptr);
+            GDALRasterBand* poBand = poDS->GetRasterBand(1);
+            std::vector<double> adfValues(100 * 100);
+            for( int i = 0; i < 100 * 100; i++ )
+                adfValues[i] = (i * 7919) % 10000;
+            CPL_IGNORE_RET_VAL(poBand->RasterIO(GF_Write, 0, 0, 100, 100,
+                                                &adfValues[0], 100, 100,
+                                                GDT_Float64, 0, 0, nullptr));
+
+            double adfRef[4] = { 0, 0, 0, 0 };
+            ensure_equals( poBand->ComputeStatistics(FALSE,
+                                                     &adfRef[0], &adfRef[1],
+                                                     &adfRef[2], &adfRef[3],
+                                                     nullptr, nullptr),
+                           CE_None );
+            GUIntBig anRefHist[10];
+            ensure_equals( poBand->GetHistogram(0, 5000, 10, anRefHist,
+                                                TRUE, FALSE, nullptr,
+                                                nullptr), CE_None );
+            poBand->SetMetadata(nullptr);
+
+            double adfStats[4] = { 0, 0, 0, 0 };
+            double dfHistMin = 0;
+            double dfHistMax = 5000;
+            GUIntBig anHist[10];
+            const double adfPercentiles[] = { 0, 50, 100 };
+            double adfPercentileValues[3] = { 0, 0, 0 };
+            ensure_equals( poBand->ComputeStatisticsAndHistogram(
+                               FALSE, &adfStats[0], &adfStats[1],
+                               &adfStats[2], &adfStats[3],
+                               &dfHistMin, &dfHistMax, 10, anHist,
+                               3, adfPercentiles, adfPercentileValues,
+                               nullptr, nullptr), CE_None );
+            for( int i = 0; i < 4; i++ )
+                ensure_equals( adfStats[i], adfRef[i] );
+            for( int i = 0; i < 10; i++ )
+                ensure_equals( anHist[i], anRefHist[i] );
+            ensure_equals( adfPercentileValues[0], 0.0 );
+            ensure( fabs(adfPercentileValues[1] - 5000) < 50 );
+            ensure_equals( adfPercentileValues[2], 9999.0 );
+            ensure( poBand->GetMetadataItem("STATISTICS_MEAN") != nullptr );
+            ensure( poBand->GetMetadataItem(
+                                "STATISTICS_PERCENTILE_50") != nullptr );
+
+            // Default histogram bounds.
+            dfHistMin = 0;
+            dfHistMax = 0;
+            GUIntBig anDefaultHist[256];
+            ensure_equals( poBand->ComputeStatisticsAndHistogram(
+                               FALSE, nullptr, nullptr, nullptr, nullptr,
+                               &dfHistMin, &dfHistMax, 256, anDefaultHist,
+                               0, nullptr, nullptr,
+                               nullptr, nullptr), CE_None );
+            ensure_equals( dfHistMin, -9999.0 / 510 );
+            ensure_equals( dfHistMax, 9999 + 9999.0 / 510 );
+            GUIntBig anRefDefaultHist[256];
+            ensure_equals( poBand->GetHistogram(dfHistMin, dfHistMax, 256,
+                                                anRefDefaultHist, TRUE, FALSE,
+                                                nullptr, nullptr), CE_None );
+            GUIntBig nTotal = 0;
+            for( int i = 0; i < 256; i++ )
+            {
+                nTotal += anDefaultHist[i];
+                // Exact for UInt16, approximate for Float32.
+                if( aeTypes[iType] == GDT_UInt16 )
+                    ensure_equals( anDefaultHist[i], anRefDefaultHist[i] );
+                else
+                    ensure( anDefaultHist[i] + 5 >= anRefDefaultHist[i] &&
+                            anDefaultHist[i] <= anRefDefaultHist[i] + 5 );
+            }
+            ensure_equals( nTotal, static_cast<GUIntBig>(100 * 100) );
+
+            GDALClose(poDS);
+        }
+
+        // The default histogram saved in the .aux.xml file must be exact:
+        // the one derived from the percentiles of a Float32 band is not
+        // saved.
+        GDALDriver* poGTiffDrv =
+            GetGDALDriverManager()->GetDriverByName("GTiff");
+        if( poGTiffDrv == nullptr )
+            return;
+        const char* pszFilename = "/vsimem/test_gdal_17.tif";
+        for( size_t iType = 0; iType < sizeof(aeTypes) / sizeof(aeTypes[0]);
+             iType++ )
+        {
+            GDALDataset* poDS = poGTiffDrv->Create(pszFilename, 100, 100, 1,
+                                                   aeTypes[iType], nullptr);
+            std::vector<double> adfValues(100 * 100);
+            for( int i = 0; i < 100 * 100; i++ )
+                adfValues[i] = (i * 7919) % 10000;
+            CPL_IGNORE_RET_VAL(poDS->GetRasterBand(1)->RasterIO(
+                GF_Write, 0, 0, 100, 100, &adfValues[0], 100, 100,
+                GDT_Float64, 0, 0, nullptr));
+            GDALClose(poDS);
+
+            poDS = static_cast<GDALDataset*>(
+                GDALOpen(pszFilename, GA_ReadOnly));
+            double dfHistMin = 0;
+            double dfHistMax = 0;
+            GUIntBig anHist[256];
+            ensure_equals( poDS->GetRasterBand(1)->
+                               ComputeStatisticsAndHistogram(
+                               FALSE, nullptr, nullptr, nullptr, nullptr,
+                               &dfHistMin, &dfHistMax, 256, anHist,
+                               0, nullptr, nullptr,
+                               nullptr, nullptr), CE_None );
+            GDALClose(poDS);
+
+            poDS = static_cast<GDALDataset*>(
+                GDALOpen(pszFilename, GA_ReadOnly));
+            double dfSavedMin = 0;
+            double dfSavedMax = 0;
+            int nSavedBuckets = 0;
+            GUIntBig* panSavedHist = nullptr;
+            const CPLErr eErr = poDS->GetRasterBand(1)->GetDefaultHistogram(
+                &dfSavedMin, &dfSavedMax, &nSavedBuckets, &panSavedHist,
+                FALSE, nullptr, nullptr);
+            if( aeTypes[iType] == GDT_UInt16 )
+            {
+                ensure_equals( eErr, CE_None );
+                ensure( fabs(dfSavedMin - dfHistMin) < 1e-10 );
+                ensure( fabs(dfSavedMax - dfHistMax) < 1e-10 );
+                ensure_equals( nSavedBuckets, 256 );
+                for( int i = 0; i < 256; i++ )
+                    ensure_equals( panSavedHist[i], anHist[i] );
+            }
+            else
+            {
+                ensure_equals( eErr, CE_Warning );
+            }
+            CPLFree(panSavedHist);
+            ensure( poDS->GetRasterBand(1)->GetMetadataItem(
+                                            "STATISTICS_MEAN") != nullptr );
+            GDALClose(poDS);
+            poGTiffDrv->Delete(pszFilename);
+        }
+    }
+
+    struct ThreadSafeDatasetJob
+    {
+        GDALDataset* poDS;
+        const std::vector<GByte>* pabyRef;
+        int nSeed;
+        bool bOK;
+    };
+
+    static void ThreadSafeDatasetStatsThreadFunc( void* pData )
+    {
+        GDALDataset* poDS = static_cast<GDALDataset*>(pData);
+        CPL_IGNORE_RET_VAL(poDS->GetRasterBand(1)->ComputeStatistics(
+            FALSE, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr));
+    }
+
+    static void ThreadSafeDatasetThreadFunc( void* pData )
+    {
+        ThreadSafeDatasetJob* psJob = static_cast<ThreadSafeDatasetJob*>(pData);
+        const int nSize = psJob->poDS->GetRasterXSize();
+        GDALRasterBand* poBand = psJob->poDS->GetRasterBand(1);
+        std::vector<GByte> abyBuffer(nSize * nSize);
+        for( int iIter = 0; iIter < 50 && psJob->bOK; iIter++ )
+        {
+            const int nXOff = (psJob->nSeed * 17 + iIter * 31) % (nSize / 2);
+            const int nYOff = (psJob->nSeed * 13 + iIter * 37) % (nSize / 2);
+            const int nWinSize = nSize / 2;
+            if( poBand->RasterIO(GF_Read, nXOff, nYOff, nWinSize, nWinSize,
+                                 &abyBuffer[0], nWinSize, nWinSize, GDT_Byte,
+                                 0, 0, nullptr) != CE_None )
+            {
+                psJob->bOK = false;
+                break;
+            }
+            for( int iY = 0; iY < nWinSize && psJob->bOK; iY++ )
+            {
+                for( int iX = 0; iX < nWinSize; iX++ )
+                {
+                    if( abyBuffer[iY * nWinSize + iX] !=
+                            (*psJob->pabyRef)[(nYOff + iY) * nSize +
+                                              nXOff + iX] )
+                    {
+                        psJob->bOK = false;
+                        break;
+                    }
+                }
+            }
+            GDALRasterBand* poOvrBand = poBand->GetOverview(0);
+            if( poOvrBand == nullptr ||
+                poOvrBand->RasterIO(GF_Read, 0, 0, nSize / 2, nSize / 2,
+                                    &abyBuffer[0], nSize / 2, nSize / 2,
+                                    GDT_Byte, 0, 0, nullptr) != CE_None ||
+                poBand->GetMaskBand()->GetMaskFlags() != GMF_ALL_VALID )
+            {
+                psJob->bOK = false;
+            }
+        }
+    }
+
+    static volatile int nThreadSafeHandlesClosed = 0;
+
+    static void CPL_STDCALL ThreadSafeDatasetErrorHandler(
+                        CPLErr eErr, CPLErrorNum, const char* pszMsg )
+    {
+        if( eErr == CE_Debug && strstr(pszMsg, "closing handle") != nullptr )
+            CPLAtomicInc(&nThreadSafeHandlesClosed);
+    }
+
+    // Test GDAL_OF_THREAD_SAFE
+    template<> template<> void object::test<18>()
+    {
+        const int nSize = 256;
+        const char* pszFilename = "/vsimem/test_gdal_thread_safe.tif";
+        std::vector<GByte> abyRef(nSize * nSize);
+        for( int i = 0; i < nSize * nSize; i++ )
+            abyRef[i] = static_cast<GByte>((i * 7919) % 251);
+        {
+            GDALDriver* poGTiffDrv =
+                GetGDALDriverManager()->GetDriverByName("GTiff");
+            if( poGTiffDrv == nullptr )
+                return;
+            const char* const apszOptions[] = {
+                "TILED=YES", "BLOCKXSIZE=32", "BLOCKYSIZE=32", nullptr };
+            GDALDataset* poDS = poGTiffDrv->Create(
+                pszFilename, nSize, nSize, 1, GDT_Byte,
+                const_cast<char**>(apszOptions));
+            CPL_IGNORE_RET_VAL(poDS->GetRasterBand(1)->RasterIO(
+                GF_Write, 0, 0, nSize, nSize, &abyRef[0], nSize, nSize,
+                GDT_Byte, 0, 0, nullptr));
+            int nOvrFactor = 2;
+            ensure_equals( poDS->BuildOverviews("NEAREST", 1, &nOvrFactor,
+                                                0, nullptr, nullptr, nullptr),
+                           CE_None );
+            GDALClose(poDS);
+        }
+
+        ensure( GDALOpenEx(pszFilename, GDAL_OF_RASTER | GDAL_OF_UPDATE |
+                           GDAL_OF_THREAD_SAFE, nullptr, nullptr,
+                           nullptr) == nullptr );
+        ensure( GDALOpenEx(pszFilename, GDAL_OF_VECTOR | GDAL_OF_THREAD_SAFE,
+                           nullptr, nullptr, nullptr) == nullptr );
+
+        GDALDataset* poDS = GDALDataset::FromHandle(
+            GDALOpenEx(pszFilename, GDAL_OF_RASTER | GDAL_OF_THREAD_SAFE,
+                       nullptr, nullptr, nullptr));
+        ensure( poDS != nullptr );
+        ensure_equals( poDS->GetRasterXSize(), nSize );
+        ensure_equals( poDS->GetRasterCount(), 1 );
+        ensure_equals( std::string(poDS->GetDriver()->GetDescription()),
+                       std::string("GTiff") );
+        ensure_equals( poDS->GetRasterBand(1)->GetOverviewCount(), 1 );
+        ensure( poDS->GetRasterBand(1)->GetOverview(0) ==
+                poDS->GetRasterBand(1)->GetOverview(0) );
+        CPLPushErrorHandler(CPLQuietErrorHandler);
+        ensure_equals( poDS->GetRasterBand(1)->SetNoDataValue(0),
+                       CE_Failure );
+        CPLPopErrorHandler();
+
+        // The handle of each thread is closed when it exits.
+        CPLString osOldDebug(CPLGetConfigOption("CPL_DEBUG", ""));
+        CPLSetConfigOption("CPL_DEBUG", "ON");
+        CPLErrorHandler pfnOldHandler =
+            CPLSetErrorHandler(ThreadSafeDatasetErrorHandler);
+        // A previous test may have disabled it.
+        CPLSetCurrentErrorHandlerCatchDebug(TRUE);
+        ThreadSafeDatasetJob asJobs[4];
+        CPLJoinableThread* ahThreads[4];
+        for( int i = 0; i < 4; i++ )
+        {
+            asJobs[i].poDS = poDS;
+            asJobs[i].pabyRef = &abyRef;
+            asJobs[i].nSeed = i;
+            asJobs[i].bOK = true;
+            ahThreads[i] = CPLCreateJoinableThread(
+                                ThreadSafeDatasetThreadFunc, &asJobs[i]);
+        }
+        for( int i = 0; i < 4; i++ )
+        {
+            CPLJoinThread(ahThreads[i]);
+            ensure( asJobs[i].bOK );
+        }
+        CPLSetErrorHandler(pfnOldHandler);
+        CPLSetConfigOption("CPL_DEBUG",
+                           osOldDebug.empty() ? nullptr : osOldDebug.c_str());
+        ensure_equals( nThreadSafeHandlesClosed, 4 );
+
+        // Statistics computed in a thread are seen by the others, and saved
+        // in the .aux.xml file.
+        CPLJoinableThread* hStatsThread = CPLCreateJoinableThread(
+                                ThreadSafeDatasetStatsThreadFunc, poDS);
+        CPLJoinThread(hStatsThread);
+        double dfMin = 0, dfMax = 0, dfMean = 0, dfStdDev = 0;
+        ensure_equals( poDS->GetRasterBand(1)->GetStatistics(
+                            FALSE, FALSE, &dfMin, &dfMax, &dfMean, &dfStdDev),
+                       CE_None );
+        ensure_equals( dfMin, 0.0 );
+        ensure_equals( dfMax, 250.0 );
+        GUIntBig anHistogram[256] = { 0 };
+        ensure_equals( poDS->GetRasterBand(1)->ComputeStatisticsAndHistogram(
+                            FALSE, nullptr, nullptr, nullptr, nullptr,
+                            nullptr, nullptr, 256, anHistogram,
+                            0, nullptr, nullptr, nullptr, nullptr),
+                       CE_None );
+        GUIntBig nTotal = 0;
+        for( int i = 0; i < 256; i++ )
+            nTotal += anHistogram[i];
+        ensure_equals( nTotal, static_cast<GUIntBig>(nSize * nSize) );
+        GDALClose(poDS);
+
+        poDS = static_cast<GDALDataset*>(GDALOpen(pszFilename, GA_ReadOnly));
+        const char* pszMean =
+            poDS->GetRasterBand(1)->GetMetadataItem("STATISTICS_MEAN");
+        ensure( pszMean != nullptr );
+        ensure( fabs(CPLAtof(pszMean) - dfMean) < 1e-10 );
+        GDALClose(poDS);
+
+        VSIUnlink(pszFilename);
+        VSIUnlink(CPLSPrintf("%s.ovr", pszFilename));
+        VSIUnlink(CPLSPrintf("%s.aux.xml", pszFilename));
+    }
+
+    // Test GDALDriverManager::GetDriversForOpen()
+    static std::string osDispatchTestOpener;
+
+    // Opens the test files of test<19> as a 1x1 MEM dataset.
+    static GDALDataset* DispatchTestOpen( GDALOpenInfo* poOpenInfo,
+                                          const char* pszDriverName )
+    {
+        if( poOpenInfo->nHeaderBytes < 13 ||
+            memcmp(poOpenInfo->pabyHeader, "TEST_DISPATCH", 13) != 0 )
+            return nullptr;
+        osDispatchTestOpener = pszDriverName;
+        GDALDriver* poMEMDrv =
+            GetGDALDriverManager()->GetDriverByName("MEM");
+        return poMEMDrv->Create("", 1, 1, 1, GDT_Byte, nullptr);
+    }
+
+    template<> template<> void object::test<19>()
+    {
+        GDALDriverManager* poDM = GetGDALDriverManager();
+        GDALDriver* poGTiffDrv = poDM->GetDriverByName("GTiff");
+        GDALDriver* poPNGDrv = poDM->GetDriverByName("PNG");
+        if( poGTiffDrv == nullptr || poPNGDrv == nullptr )
+            return;
+
+        // A GeoTIFF file with a .png extension.
+        const char* pszFilename = "/vsimem/test_gdal_dispatch.png";
+        GDALClose(poGTiffDrv->Create(pszFilename, 1, 1, 1, GDT_Byte, nullptr));
+
+        {
+            CPLSetThreadLocalConfigOption("GDAL_OPEN_DISPATCH_INDEX", "YES");
+            GDALOpenInfo oOpenInfo(pszFilename, GDAL_OF_RASTER);
+            std::vector<GDALDriver*> apoDrivers =
+                poDM->GetDriversForOpen(&oOpenInfo);
+            CPLSetThreadLocalConfigOption("GDAL_OPEN_DISPATCH_INDEX", nullptr);
+            ensure_equals( static_cast<int>(apoDrivers.size()),
+                           poDM->GetDriverCount() );
+            // Both match, and are kept in registration order.
+            ensure( apoDrivers[0] == poGTiffDrv );
+            ensure( apoDrivers[1] == poPNGDrv );
+        }
+
+        // Registration order by default.
+        {
+            GDALOpenInfo oOpenInfo(pszFilename, GDAL_OF_RASTER);
+            std::vector<GDALDriver*> apoDrivers =
+                poDM->GetDriversForOpen(&oOpenInfo);
+            for( int i = 0; i < poDM->GetDriverCount(); i++ )
+                ensure( apoDrivers[i] == poDM->GetDriver(i) );
+        }
+
+        GDALDataset* poDS = GDALDataset::FromHandle(
+            GDALOpenEx(pszFilename, GDAL_OF_RASTER, nullptr, nullptr,
+                       nullptr));
+        ensure( poDS != nullptr );
+        ensure( poDS->GetDriver() == poGTiffDrv );
+        GDALClose(poDS);
+
+        VSIUnlink(pszFilename);
+
+        // A file that two drivers can open, the last registered one
+        // declaring its extension: the first one opens it, unless the
+        // dispatch index is enabled.
+        GDALDriver* poFirstDrv = new GDALDriver();
+        poFirstDrv->SetDescription("TEST_DISPATCH_FIRST");
+        poFirstDrv->SetMetadataItem( GDAL_DCAP_RASTER, "YES" );
+        poFirstDrv->pfnOpen = [](GDALOpenInfo* poOpenInfo) -> GDALDataset*
+            { return DispatchTestOpen(poOpenInfo, "TEST_DISPATCH_FIRST"); };
+        poDM->RegisterDriver(poFirstDrv);
+        GDALDriver* poSecondDrv = new GDALDriver();
+        poSecondDrv->SetDescription("TEST_DISPATCH_SECOND");
+        poSecondDrv->SetMetadataItem( GDAL_DCAP_RASTER, "YES" );
+        poSecondDrv->SetMetadataItem( GDAL_DMD_EXTENSION, "tstdsp" );
+        poSecondDrv->pfnOpen = [](GDALOpenInfo* poOpenInfo) -> GDALDataset*
+            { return DispatchTestOpen(poOpenInfo, "TEST_DISPATCH_SECOND"); };
+        poDM->RegisterDriver(poSecondDrv);
+
+        const char* pszAmbiguousFilename = "/vsimem/test_gdal.tstdsp";
+        VSILFILE* fp = VSIFOpenL(pszAmbiguousFilename, "wb");
+        ensure( fp != nullptr );
+        CPL_IGNORE_RET_VAL(VSIFWriteL("TEST_DISPATCH", 1, 13, fp));
+        VSIFCloseL(fp);
+
+        osDispatchTestOpener.clear();
+        GDALClose(GDALOpenEx(pszAmbiguousFilename, GDAL_OF_RASTER,
+                             nullptr, nullptr, nullptr));
+        ensure_equals( osDispatchTestOpener,
+                       std::string("TEST_DISPATCH_FIRST") );
+
+        osDispatchTestOpener.clear();
+        CPLSetThreadLocalConfigOption("GDAL_OPEN_DISPATCH_INDEX", "YES");
+        GDALClose(GDALOpenEx(pszAmbiguousFilename, GDAL_OF_RASTER,
+                             nullptr, nullptr, nullptr));
+        CPLSetThreadLocalConfigOption("GDAL_OPEN_DISPATCH_INDEX", nullptr);
+        ensure_equals( osDispatchTestOpener,
+                       std::string("TEST_DISPATCH_SECOND") );
+
+        VSIUnlink(pszAmbiguousFilename);
+        poDM->DeregisterDriver(poFirstDrv);
+        delete poFirstDrv;
+        poDM->DeregisterDriver(poSecondDrv);
+        delete poSecondDrv;
+    }
+
+    // Test deferred driver metadata (pfnInitDeferredMetadata)
+    static int nDeferredInitCount = 0;
+
+    static void DeferredMetadataReaderFunc(void* pData)
+    {
+        GDALDriver* poDrv = static_cast<GDALDriver*>(pData);
+        for( int i = 0; i < 1000; i++ )
+        {
+            if( poDrv->GetMetadataItem(GDAL_DCAP_RASTER) == nullptr ||
+                poDrv->GetMetadataItem(GDAL_DMD_CREATIONOPTIONLIST) == nullptr )
+            {
+                nDeferredInitCount = -1000;
+            }
+        }
+    }
+
+    template<> template<> void object::test<20>()
+    {
+        GDALDriver* poDrv = new GDALDriver();
+        poDrv->SetDescription("TEST_DEFERRED");
+        poDrv->SetMetadataItem( GDAL_DCAP_RASTER, "YES" );
+        poDrv->pfnIdentify = [](GDALOpenInfo*) { return FALSE; };
+        poDrv->pfnInitDeferredMetadata = [](GDALDriver* poDriver)
+        {
+            nDeferredInitCount ++;
+            poDriver->SetMetadataItem( GDAL_DMD_CREATIONOPTIONLIST,
+                                       "<CreationOptionList/>" );
+            poDriver->SetMetadataItem( GDAL_DMD_OPENOPTIONLIST,
+                                       "<OpenOptionList/>" );
+        };
+        GetGDALDriverManager()->RegisterDriver(poDrv);
+
+        // Capabilities do not trigger the deferred initialization.
+        ensure( poDrv->GetMetadataItem(GDAL_DCAP_RASTER) != nullptr );
+        ensure_equals( nDeferredInitCount, 0 );
+        ensure( CSLFetchNameValue(
+            poDrv->GDALMajorObject::GetMetadata(),
+            GDAL_DMD_CREATIONOPTIONLIST) == nullptr );
+
+        // Concurrent first accesses initialize only once.
+        std::vector<CPLJoinableThread*> ahThreads;
+        for( int i = 0; i < 4; i++ )
+        {
+            ahThreads.push_back(
+                CPLCreateJoinableThread(DeferredMetadataReaderFunc, poDrv));
+        }
+        for( size_t i = 0; i < ahThreads.size(); i++ )
+            CPLJoinThread(ahThreads[i]);
+        ensure_equals( nDeferredInitCount, 1 );
+
+        char** papszMD = poDrv->GetMetadata();
+        ensure( CSLFetchNameValue(papszMD, GDAL_DCAP_RASTER) != nullptr );
+        ensure( CSLFetchNameValue(papszMD,
+                                  GDAL_DMD_OPENOPTIONLIST) != nullptr );
+        ensure_equals( std::string(
+            poDrv->GetMetadataItem(GDAL_DMD_CREATIONOPTIONLIST)),
+            std::string("<CreationOptionList/>") );
+
+        // An explicitly set value overrides the deferred one.
+        poDrv->SetMetadataItem( GDAL_DMD_OPENOPTIONLIST, "<OpenOptionList>"
+                                "<Option name='X' type='int'/>"
+                                "</OpenOptionList>" );
+        ensure( strstr(poDrv->GetMetadataItem(GDAL_DMD_OPENOPTIONLIST),
+                       "'X'") != nullptr );
+        ensure( strstr(CSLFetchNameValue(poDrv->GetMetadata(),
+                                         GDAL_DMD_OPENOPTIONLIST),
+                       "'X'") != nullptr );
+        ensure_equals( nDeferredInitCount, 1 );
+
+        GetGDALDriverManager()->DeregisterDriver(poDrv);
+        delete poDrv;
+
+        // A value set before the deferred initialization also overrides
+        // the deferred one.
+        nDeferredInitCount = 0;
+        poDrv = new GDALDriver();
+        poDrv->SetDescription("TEST_DEFERRED");
+        poDrv->SetMetadataItem( GDAL_DCAP_RASTER, "YES" );
+        poDrv->pfnIdentify = [](GDALOpenInfo*) { return FALSE; };
+        poDrv->pfnInitDeferredMetadata = [](GDALDriver* poDriver)
+        {
+            nDeferredInitCount ++;
+            poDriver->SetMetadataItem( GDAL_DMD_CREATIONOPTIONLIST,
+                                       "<CreationOptionList/>" );
+            poDriver->SetMetadataItem( GDAL_DMD_OPENOPTIONLIST,
+                                       "<OpenOptionList/>" );
+        };
+        GetGDALDriverManager()->RegisterDriver(poDrv);
+        poDrv->SetMetadataItem( GDAL_DMD_CREATIONOPTIONLIST,
+                                "<CreationOptionList>"
+                                "<Option name='Y' type='int'/>"
+                                "</CreationOptionList>" );
+        ensure_equals( nDeferredInitCount, 0 );
+        ensure( strstr(poDrv->GetMetadataItem(GDAL_DMD_CREATIONOPTIONLIST),
+                       "'Y'") != nullptr );
+        ensure_equals( nDeferredInitCount, 1 );
+        ensure( strstr(CSLFetchNameValue(poDrv->GetMetadata(),
+                                         GDAL_DMD_CREATIONOPTIONLIST),
+                       "'Y'") != nullptr );
+        ensure_equals( std::string(
+            poDrv->GetMetadataItem(GDAL_DMD_OPENOPTIONLIST)),
+            std::string("<OpenOptionList/>") );
+
+        GetGDALDriverManager()->DeregisterDriver(poDrv);
+        delete poDrv;
+
+        // Drivers of the tree using it.
+        GDALAllRegister();
+        poDrv = GetGDALDriverManager()->GetDriverByName("GTiff");
+        ensure( poDrv != nullptr );
+        const char* pszCO =
+            poDrv->GetMetadataItem(GDAL_DMD_CREATIONOPTIONLIST);
+        ensure( pszCO != nullptr );
+        ensure( strstr(pszCO, "COMPRESS") != nullptr );
+        ensure( poDrv->GetMetadataItem(GDAL_DMD_OPENOPTIONLIST) != nullptr );
+    }
+
 } // namespace tut
@@ -29,6 +29,7 @@
 #include "../../gdal/ogr/ogrsf_frmts/osm/gpb.h"
 
 #include <string>
+#include <vector>
 
 namespace tut
 {
@@ -1004,4 +1005,198 @@ namespace tut
         ensure( oIter != poLayer->end() );
     }
 
+    // Check that GetNextFeatureBatch() returns the same features as
+    // GetNextFeature()
+    static void CheckFeatureBatches( OGRLayer* poLayer, int nBatchSize )
+    {
+        std::vector<OGRFeatureUniquePtr> apoFeatures;
+        poLayer->ResetReading();
+        for( auto&& poFeature: poLayer )
+            apoFeatures.emplace_back(poFeature->Clone());
+
+        poLayer->ResetReading();
+        OGRFeatureBatch oBatch;
+        size_t nIdx = 0;
+        while( true )
+        {
+            const int nCount = poLayer->GetNextFeatureBatch(&oBatch, nBatchSize);
+            ensure_equals( oBatch.GetFeatureCount(), nCount );
+            ensure( nCount <= nBatchSize );
+            for( int i = 0; i < oBatch.GetFeatureCount(); i++ )
+            {
+                ensure( nIdx < apoFeatures.size() );
+                ensure_equals( oBatch.GetFIDs()[i],
+                               apoFeatures[nIdx]->GetFID() );
+                OGRFeatureUniquePtr poFeature(oBatch.GetFeature(i));
+                ensure( poFeature->Equal(apoFeatures[nIdx].get()) );
+                nIdx++;
+            }
+            if( nCount < nBatchSize )
+                break;
+        }
+        ensure_equals( nIdx, apoFeatures.size() );
+    }
+
+    // Test GetNextFeatureBatch()
+    template<>
+    template<>
+    void object::test<14>()
+    {
+        // Shapefile fast path
+        std::unique_ptr<GDALDataset> poDS (static_cast<GDALDataset*>(
+            GDALOpenEx("data/poly.shp", GDAL_OF_VECTOR, nullptr, nullptr, nullptr)));
+        ensure( poDS != nullptr );
+        OGRLayer* poLayer = poDS->GetLayer(0);
+        CheckFeatureBatches(poLayer, 3);
+        CheckFeatureBatches(poLayer, 100);
+
+        // Column accessors
+        poLayer->ResetReading();
+        OGRFeatureBatch oBatch;
+        ensure_equals( poLayer->GetNextFeatureBatch(&oBatch, 2), 2 );
+        const int iEAS_ID = poLayer->GetLayerDefn()->GetFieldIndex("EAS_ID");
+        const int iPRFEDEA = poLayer->GetLayerDefn()->GetFieldIndex("PRFEDEA");
+        ensure( oBatch.GetFieldColumn(iEAS_ID).IsValid(1) );
+        ensure_equals( oBatch.GetFieldColumn(iEAS_ID).GetInteger64(1),
+                       static_cast<GIntBig>(179) );
+        ensure_equals( std::string(oBatch.GetFieldColumn(iPRFEDEA).GetString(0)),
+                       std::string("35043411") );
+        ensure( oBatch.GetGeomFieldColumn(0).IsValid(0) );
+
+        // Generic implementation, used with an attribute filter
+        poLayer->SetAttributeFilter("EAS_ID > 170");
+        CheckFeatureBatches(poLayer, 2);
+        poLayer->SetAttributeFilter(nullptr);
+
+        // Memory layer fast path
+        GDALDriver* poMemDriver =
+            GetGDALDriverManager()->GetDriverByName("Memory");
+        if( poMemDriver != nullptr )
+        {
+            std::unique_ptr<GDALDataset> poMemDS(poMemDriver->Create(
+                "", 0, 0, 0, GDT_Unknown, nullptr));
+            OGRLayer* poMemLayer =
+                poMemDS->CopyLayer(poLayer, "poly", nullptr);
+            ensure( poMemLayer != nullptr );
+            CheckFeatureBatches(poMemLayer, 4);
+        }
+
+        // Null and unset fields are kept apart
+        if( poMemDriver != nullptr )
+        {
+            std::unique_ptr<GDALDataset> poMemDS(poMemDriver->Create(
+                "", 0, 0, 0, GDT_Unknown, nullptr));
+            OGRLayer* poMemLayer = poMemDS->CreateLayer("null", nullptr,
+                                                        wkbNone, nullptr);
+            OGRFieldDefn oField("str", OFTString);
+            poMemLayer->CreateField(&oField);
+            OGRFeature oFeatureNull(poMemLayer->GetLayerDefn());
+            oFeatureNull.SetFieldNull(0);
+            ensure_equals( poMemLayer->CreateFeature(&oFeatureNull),
+                           OGRERR_NONE );
+            OGRFeature oFeatureUnset(poMemLayer->GetLayerDefn());
+            ensure_equals( poMemLayer->CreateFeature(&oFeatureUnset),
+                           OGRERR_NONE );
+
+            OGRFeatureBatch oNullBatch;
+            ensure_equals( poMemLayer->GetNextFeatureBatch(&oNullBatch, 2),
+                           2 );
+            ensure( oNullBatch.GetFieldColumn(0).IsNull(0) );
+            ensure( !oNullBatch.GetFieldColumn(0).IsValid(0) );
+            ensure( !oNullBatch.GetFieldColumn(0).IsNull(1) );
+            ensure( !oNullBatch.GetFieldColumn(0).IsValid(1) );
+            OGRFeatureUniquePtr poFeatureNull(oNullBatch.GetFeature(0));
+            ensure( poFeatureNull->IsFieldNull(0) );
+            OGRFeatureUniquePtr poFeatureUnset(oNullBatch.GetFeature(1));
+            ensure( !poFeatureUnset->IsFieldSet(0) );
+        }
+
+        // Shapefile geometries written as WKB from the shapes, or through
+        // OGRGeometry for multi-part polygons
+        GDALDriver* poShapeDriver =
+            GetGDALDriverManager()->GetDriverByName("ESRI Shapefile");
+        const char* const apszWKT[][3] = {
+            { "POINT Z (1 2 3)", "POINT Z (4 5 6)", nullptr },
+            { "MULTIPOINT (1 2,3 4)", "MULTIPOINT (5 6)", nullptr },
+            { "LINESTRING M (1 2 3,4 5 6)",
+              "MULTILINESTRING M ((1 2 3,4 5 6),(7 8 9,10 11 12))", nullptr },
+            { "POLYGON Z ((0 0 1,0 1 2,1 1 3,0 0 1))",
+              "MULTIPOLYGON (((0 0,0 10,10 10,10 0,0 0),(1 1,2 1,2 2,1 1)),"
+              "((20 20,20 21,21 21,20 20)))", nullptr },
+        };
+        for( size_t iType = 0; poShapeDriver != nullptr &&
+                               iType < CPL_ARRAYSIZE(apszWKT); iType++ )
+        {
+            const char* pszSHP = "/vsimem/test_ogr_batch.shp";
+            std::unique_ptr<GDALDataset> poSHPDS(poShapeDriver->Create(
+                pszSHP, 0, 0, 0, GDT_Unknown, nullptr));
+            ensure( poSHPDS != nullptr );
+            OGRGeometry* poFirstGeom = nullptr;
+            char* pszFirstWKT = const_cast<char*>(apszWKT[iType][0]);
+            OGRGeometryFactory::createFromWkt(&pszFirstWKT, nullptr,
+                                              &poFirstGeom);
+            ensure( poFirstGeom != nullptr );
+            OGRLayer* poSHPLayer = poSHPDS->CreateLayer(
+                "test_ogr_batch", nullptr, poFirstGeom->getGeometryType(),
+                nullptr);
+            ensure( poSHPLayer != nullptr );
+            for( int i = 0; apszWKT[iType][i] != nullptr; i++ )
+            {
+                OGRGeometry* poGeom = nullptr;
+                char* pszWKT = const_cast<char*>(apszWKT[iType][i]);
+                OGRGeometryFactory::createFromWkt(&pszWKT, nullptr, &poGeom);
+                OGRFeature oFeature(poSHPLayer->GetLayerDefn());
+                oFeature.SetGeometryDirectly(poGeom);
+                ensure_equals( poSHPLayer->CreateFeature(&oFeature),
+                               OGRERR_NONE );
+            }
+            delete poFirstGeom;
+            poSHPLayer->SyncToDisk();
+            CheckFeatureBatches(poSHPLayer, 1);
+            poSHPDS.reset();
+            poShapeDriver->Delete(pszSHP);
+        }
+
+        // GeoPackage fast path
+        GDALDriver* poGPKGDriver =
+            GetGDALDriverManager()->GetDriverByName("GPKG");
+        if( poGPKGDriver != nullptr )
+        {
+            const char* pszGPKG = "/vsimem/test_ogr_batch.gpkg";
+            {
+                std::unique_ptr<GDALDataset> poGPKGDS(poGPKGDriver->Create(
+                    pszGPKG, 0, 0, 0, GDT_Unknown, nullptr));
+                ensure( poGPKGDS != nullptr );
+                OGRLayer* poGPKGLayer =
+                    poGPKGDS->CopyLayer(poLayer, "poly", nullptr);
+                ensure( poGPKGLayer != nullptr );
+                CheckFeatureBatches(poGPKGLayer, 4);
+            }
+            poGPKGDriver->Delete(pszGPKG);
+        }
+
+        // CSV fast path
+        const char* pszCSV = "/vsimem/test_ogr_batch.csv";
+        const char* pszCSVT = "/vsimem/test_ogr_batch.csvt";
+        const char* pszCSVContent =
+            "int,real,str,bool\n1,1.5,foo,true\n,,,\n3,x,bar,false\n";
+        const char* pszCSVTContent = "Integer,Real,String,Integer(Boolean)\n";
+        VSIFCloseL(VSIFileFromMemBuffer(pszCSV,
+            reinterpret_cast<GByte*>(const_cast<char*>(pszCSVContent)),
+            strlen(pszCSVContent), FALSE));
+        VSIFCloseL(VSIFileFromMemBuffer(pszCSVT,
+            reinterpret_cast<GByte*>(const_cast<char*>(pszCSVTContent)),
+            strlen(pszCSVTContent), FALSE));
+        {
+            std::unique_ptr<GDALDataset> poCSVDS(static_cast<GDALDataset*>(
+                GDALOpenEx(pszCSV, GDAL_OF_VECTOR, nullptr, nullptr, nullptr)));
+            ensure( poCSVDS != nullptr );
+            CPLPushErrorHandler(CPLQuietErrorHandler);
+            CheckFeatureBatches(poCSVDS->GetLayer(0), 2);
+            CPLPopErrorHandler();
+        }
+        VSIUnlink(pszCSV);
+        VSIUnlink(pszCSVT);
+    }
+
 } // namespace tut
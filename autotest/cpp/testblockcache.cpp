@@ -34,7 +34,9 @@
 #include "cpl_multiproc.h"
 #include "gdal_priv.h"
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstdlib>
 #include <vector>
 
@@ -43,7 +45,7 @@ CPLLock* psLock = nullptr;
 static void Usage()
 {
     printf("Usage: testblockcache [-threads X] [-loops X] [-max_requests X] [-strategy random|line|block]\n");
-    printf("                      [-migrate] [ filename |\n");
+    printf("                      [-migrate] [-bench] [ filename |\n");
     printf("                       [[-xsize val] [-ysize val] [-bands val] [-co key=value]*\n");
     printf("                       [[-memdriver] | [-ondisk]] [-check]] ]\n");
     exit(1);
@@ -314,6 +316,85 @@ static int CreateBlockStrategyRequests(GDALDataset* poDS,
     return nQueriedBands * nMaxXWin * nMaxYWin;
 }
 
+static Request* CreateRequests(GDALDataset* poDS, Strategy eStrategy,
+                               int nMaxRequests, int& nBufferSize)
+{
+    Request* psRequestList = nullptr;
+    Request* psRequestLast = nullptr;
+    if( eStrategy == STRATEGY_RANDOM )
+        nBufferSize = CreateRandomStrategyRequests(
+                poDS, nMaxRequests, psRequestList, psRequestLast);
+    else if( eStrategy == STRATEGY_LINE )
+        nBufferSize = CreateLineStrategyRequests(
+                poDS, nMaxRequests, psRequestList, psRequestLast);
+    else
+        nBufferSize = CreateBlockStrategyRequests(
+                poDS, nMaxRequests, psRequestList, psRequestLast);
+    return psRequestList;
+}
+
+/* Run the same workload with 1, 2, 4, ... up to nMaxThreads threads, each */
+/* thread with its own dataset handle, and report the throughput, so as to */
+/* measure the scalability of the block cache. */
+static void Benchmark(GDALDataset* poMEMDS, Strategy eStrategy,
+                      int nMaxRequests, int nMaxThreads)
+{
+    printf("GDAL_RB_CACHE_SHARDS=%s GDAL_RB_CACHE_POLICY=%s\n",
+           CPLGetConfigOption("GDAL_RB_CACHE_SHARDS", "(default)"),
+           CPLGetConfigOption("GDAL_RB_CACHE_POLICY", "LRU"));
+    nMaxThreads = std::max(1, nMaxThreads);
+    for( int nThreads = 1; ; nThreads = std::min(nThreads * 2, nMaxThreads) )
+    {
+        std::vector<ThreadDescription> asThreadDescription;
+        double dfMB = 0;
+        int nRequests = 0;
+        for( int i = 0; i < nThreads; i++ )
+        {
+            ThreadDescription sThreadDescription;
+            sThreadDescription.poDS = poMEMDS ? poMEMDS :
+                (GDALDataset*)GDALOpen(pszDataset, GA_ReadOnly);
+            if( sThreadDescription.poDS == nullptr )
+                exit(1);
+            sThreadDescription.psRequestList = CreateRequests(
+                sThreadDescription.poDS, eStrategy, nMaxRequests,
+                sThreadDescription.nBufferSize);
+            for( Request* psIter = sThreadDescription.psRequestList;
+                 psIter != nullptr; psIter = psIter->psNext )
+            {
+                dfMB += (double)psIter->nXWin * psIter->nYWin *
+                        psIter->nBands / (1024 * 1024);
+                nRequests ++;
+            }
+            asThreadDescription.push_back(sThreadDescription);
+        }
+
+        std::vector<CPLJoinableThread*> apsThreads;
+        const auto start = std::chrono::steady_clock::now();
+        for( int i = 0; i < nThreads; i++ )
+        {
+            apsThreads.push_back(CPLCreateJoinableThread(
+                ThreadFuncDedicatedDataset, &(asThreadDescription[i])));
+        }
+        for( int i = 0; i < nThreads; i++ )
+            CPLJoinThread(apsThreads[i]);
+        const double dfElapsed = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+
+        printf("threads=%d: %d requests, %.1f MB in %.3f s: "
+               "%.1f requests/s, %.1f MB/s\n",
+               nThreads, nRequests, dfMB, dfElapsed,
+               nRequests / dfElapsed, dfMB / dfElapsed);
+
+        if( poMEMDS == nullptr )
+        {
+            for( int i = 0; i < nThreads; i++ )
+                GDALClose(asThreadDescription[i].poDS);
+        }
+        if( nThreads == nMaxThreads )
+            break;
+    }
+}
+
 int main(int argc, char* argv[])
 {
     int i;
@@ -330,6 +411,7 @@ int main(int argc, char* argv[])
     int bMemDriver = FALSE;
     GDALDataset* poMEMDS = nullptr;
     int bMigrate = FALSE;
+    int bBench = FALSE;
     int nMaxRequests = -1;
 
     argc = GDALGeneralCmdLineProcessor( argc, &argv, 0 );
@@ -408,6 +490,8 @@ int main(int argc, char* argv[])
         }
         else if( EQUAL(argv[i], "-migrate"))
             bMigrate = TRUE;
+        else if( EQUAL(argv[i], "-bench"))
+            bBench = TRUE;
         else if( argv[i][0] == '-' )
             Usage();
         else if( pszDataset == nullptr )
@@ -470,6 +554,23 @@ int main(int argc, char* argv[])
     CSLDestroy(papszOptions);
     papszOptions = nullptr;
 
+    if( bBench )
+    {
+        Benchmark(poMEMDS, eStrategy, nMaxRequests, nThreads);
+        if( bCreatedDataset && poMEMDS == nullptr  )
+        {
+            CPLPushErrorHandler(CPLQuietErrorHandler);
+            VSIUnlink(pszDataset);
+            CPLPopErrorHandler();
+        }
+        if( poMEMDS )
+            GDALClose(poMEMDS);
+        assert( GDALGetCacheUsed64() == 0 );
+        GDALDestroyDriverManager();
+        CSLDestroy( argv );
+        return 0;
+    }
+
     Request* psGlobalRequestLast = nullptr;
 
     for(i = 0; i < nThreads; i++ )
@@ -0,0 +1,97 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL Core
+ * Purpose:  Test performance of GDALAllRegister(), i.e. of the start-up of
+ *           short-lived processes, and of the first access to deferred
+ *           driver metadata.
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "gdal.h"
+#include "cpl_conv.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static double ElapsedMicroseconds(
+    const std::chrono::steady_clock::time_point& start )
+{
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count() * 1e6;
+}
+
+// Usage: testperfallregister [iterations]
+int main(int argc, char* argv[])
+{
+    const int nIters = argc >= 2 ? atoi(argv[1]) : 100;
+
+    // The first registration also includes the loading of the library
+    // pages and of the plugins, which is what a short-lived process pays.
+    auto start = std::chrono::steady_clock::now();
+    GDALAllRegister();
+    const double dfFirst = ElapsedMicroseconds(start);
+    const int nDrivers = GDALGetDriverCount();
+    GDALDestroyDriverManager();
+
+    start = std::chrono::steady_clock::now();
+    for( int i = 0; i < nIters; i++ )
+    {
+        GDALAllRegister();
+        GDALDestroyDriverManager();
+    }
+    const double dfNext = ElapsedMicroseconds(start) / nIters;
+
+    // Cost of a full metadata dump of all drivers (as done by
+    // gdalinfo --formats / --format), which builds the deferred metadata.
+    double dfMetadata = 0.0;
+    size_t nMetadataSize = 0;
+    for( int i = 0; i < nIters; i++ )
+    {
+        GDALAllRegister();
+        start = std::chrono::steady_clock::now();
+        for( int j = 0; j < GDALGetDriverCount(); j++ )
+        {
+            char** papszMD = GDALGetMetadata(GDALGetDriver(j), nullptr);
+            for( char** papszIter = papszMD; papszIter && *papszIter;
+                 ++papszIter )
+            {
+                if( i == 0 )
+                    nMetadataSize += strlen(*papszIter);
+            }
+        }
+        dfMetadata += ElapsedMicroseconds(start);
+        GDALDestroyDriverManager();
+    }
+    dfMetadata /= nIters;
+
+    printf("%d drivers\n", nDrivers);
+    printf("First GDALAllRegister()      : %10.1f us\n", dfFirst);
+    printf("Next GDALAllRegister()       : %10.1f us\n", dfNext);
+    printf("Full driver metadata access  : %10.1f us (%d bytes)\n",
+           dfMetadata, static_cast<int>(nMetadataSize));
+
+    return nDrivers > 0 ? 0 : 1;
+}
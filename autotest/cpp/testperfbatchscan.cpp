@@ -0,0 +1,209 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  OGR Core
+ * Purpose:  Compare the performance of full layer scans through
+ *           OGRLayer::GetNextFeature() and OGRLayer::GetNextFeatureBatch().
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "gdal_priv.h"
+#include "ogrsf_frmts.h"
+#include "cpl_conv.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static double ElapsedMilliseconds(
+    const std::chrono::steady_clock::time_point& start )
+{
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count() * 1e3;
+}
+
+static GDALDataset* CreateDataset( const char* pszDriver,
+                                   const char* pszFilename,
+                                   int nFeatures )
+{
+    GDALDriver* poDriver =
+        GetGDALDriverManager()->GetDriverByName(pszDriver);
+    if( poDriver == nullptr )
+        return nullptr;
+    GDALDataset* poDS =
+        poDriver->Create(pszFilename, 0, 0, 0, GDT_Unknown, nullptr);
+    if( poDS == nullptr )
+        return nullptr;
+
+    // CSV layers are created without geometry, so that they are read
+    // by the fast path, and with a .csvt file to keep the field types.
+    const bool bHasGeom = !EQUAL(pszDriver, "CSV");
+    char** papszOptions = nullptr;
+    if( !bHasGeom )
+        papszOptions = CSLSetNameValue(papszOptions, "CREATE_CSVT", "YES");
+    OGRLayer* poLayer = poDS->CreateLayer("test", nullptr,
+                                          bHasGeom ? wkbPoint : wkbNone,
+                                          papszOptions);
+    CSLDestroy(papszOptions);
+    OGRFieldDefn oFieldInt("int", OFTInteger);
+    poLayer->CreateField(&oFieldInt);
+    OGRFieldDefn oFieldReal("real", OFTReal);
+    poLayer->CreateField(&oFieldReal);
+    OGRFieldDefn oFieldStr("str", OFTString);
+    poLayer->CreateField(&oFieldStr);
+
+    poLayer->StartTransaction();
+    for( int i = 0; i < nFeatures; i++ )
+    {
+        OGRFeature oFeature(poLayer->GetLayerDefn());
+        oFeature.SetField(0, i);
+        oFeature.SetField(1, i * 0.5);
+        oFeature.SetField(2, CPLSPrintf("value %d", i));
+        if( bHasGeom )
+            oFeature.SetGeometryDirectly(new OGRPoint(i % 360, i % 180));
+        poLayer->CreateFeature(&oFeature);
+    }
+    poLayer->CommitTransaction();
+
+    // Reopen the file-based datasets so that the reads do not benefit
+    // from any cache of the writing.
+    if( EQUAL(pszDriver, "Memory") )
+        return poDS;
+    GDALClose(poDS);
+    return static_cast<GDALDataset*>(
+        GDALOpenEx(pszFilename, GDAL_OF_VECTOR, nullptr, nullptr, nullptr));
+}
+
+static double ScanFeatures( OGRLayer* poLayer, double* pdfSum )
+{
+    const auto start = std::chrono::steady_clock::now();
+    poLayer->ResetReading();
+    double dfSum = 0.0;
+    OGRFeature* poFeature;
+    while( (poFeature = poLayer->GetNextFeature()) != nullptr )
+    {
+        dfSum += poFeature->GetFieldAsInteger(0);
+        dfSum += poFeature->GetFieldAsDouble(1);
+        dfSum += strlen(poFeature->GetFieldAsString(2));
+        if( poFeature->GetGeometryRef() != nullptr )
+            dfSum += 1;
+        delete poFeature;
+    }
+    *pdfSum = dfSum;
+    return ElapsedMilliseconds(start);
+}
+
+static double ScanBatches( OGRLayer* poLayer, int nBatchSize,
+                           double* pdfSum )
+{
+    const auto start = std::chrono::steady_clock::now();
+    poLayer->ResetReading();
+    double dfSum = 0.0;
+    OGRFeatureBatch oBatch;
+    int nCount = nBatchSize;
+    while( nCount == nBatchSize )
+    {
+        nCount = poLayer->GetNextFeatureBatch(&oBatch, nBatchSize);
+        const OGRFeatureBatch::Column& oInt = oBatch.GetFieldColumn(0);
+        const OGRFeatureBatch::Column& oReal = oBatch.GetFieldColumn(1);
+        const OGRFeatureBatch::Column& oStr = oBatch.GetFieldColumn(2);
+        const int* panValues = static_cast<const int*>(oInt.GetValues());
+        const double* padfValues =
+            static_cast<const double*>(oReal.GetValues());
+        for( int i = 0; i < nCount; i++ )
+        {
+            dfSum += panValues[i];
+            dfSum += padfValues[i];
+            dfSum += strlen(oStr.GetString(i));
+        }
+        if( oBatch.GetDefnRef()->GetGeomFieldCount() > 0 )
+        {
+            const OGRFeatureBatch::Column& oGeom =
+                oBatch.GetGeomFieldColumn(0);
+            for( int i = 0; i < nCount; i++ )
+            {
+                if( oGeom.IsValid(i) )
+                    dfSum += 1;
+            }
+        }
+    }
+    *pdfSum = dfSum;
+    return ElapsedMilliseconds(start);
+}
+
+// Usage: testperfbatchscan [features] [batch_size]
+int main(int argc, char* argv[])
+{
+    const int nFeatures = argc >= 2 ? atoi(argv[1]) : 100000;
+    const int nBatchSize = argc >= 3 ? atoi(argv[2]) : 1024;
+
+    GDALAllRegister();
+
+    const char* const apszDrivers[][2] = {
+        { "Memory", "" },
+        { "ESRI Shapefile", "/vsimem/testperfbatchscan.shp" },
+        { "GPKG", "/vsimem/testperfbatchscan.gpkg" },
+        { "CSV", "/vsimem/testperfbatchscan.csv" } };
+
+    int nRet = 0;
+    for( const auto& apszDriver : apszDrivers )
+    {
+        GDALDataset* poDS =
+            CreateDataset(apszDriver[0], apszDriver[1], nFeatures);
+        if( poDS == nullptr )
+        {
+            printf("%-15s: skipped\n", apszDriver[0]);
+            continue;
+        }
+        OGRLayer* poLayer = poDS->GetLayer(0);
+
+        double dfSumFeatures = 0.0;
+        double dfSumBatches = 0.0;
+        const double dfFeatures = ScanFeatures(poLayer, &dfSumFeatures);
+        const double dfBatches =
+            ScanBatches(poLayer, nBatchSize, &dfSumBatches);
+        printf("%-15s: GetNextFeature() %8.1f ms, "
+               "GetNextFeatureBatch() %8.1f ms (x%.1f)\n",
+               apszDriver[0], dfFeatures, dfBatches,
+               dfFeatures / std::max(dfBatches, 1e-3));
+        if( dfSumFeatures != dfSumBatches )
+        {
+            printf("%-15s: different results\n", apszDriver[0]);
+            nRet = 1;
+        }
+
+        GDALClose(poDS);
+        if( apszDriver[1][0] != '\0' )
+        {
+            VSIUnlink(apszDriver[1]);
+            VSIUnlink(CPLResetExtension(apszDriver[1], "shx"));
+            VSIUnlink(CPLResetExtension(apszDriver[1], "dbf"));
+            VSIUnlink(CPLResetExtension(apszDriver[1], "csvt"));
+        }
+    }
+
+    GDALDestroyDriverManager();
+    return nRet;
+}
@@ -0,0 +1,155 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL Core
+ * Purpose:  Test performance of GDALDatasetCopyWholeRaster(), with and
+ *           without reading the source in a worker thread (GDAL_NUM_THREADS).
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "gdal.h"
+#include "gdal_alg.h"
+#include "cpl_conv.h"
+#include "cpl_string.h"
+#include "cpl_vsi.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static const int BAND_COUNT = 3;
+
+static void CreateFile( const char* pszFilename, int nSize )
+{
+    GDALDriverH hGTiffDrv = GDALGetDriverByName("GTiff");
+    char** papszOptions = CSLSetNameValue(nullptr, "TILED", "YES");
+    papszOptions = CSLSetNameValue(papszOptions, "COMPRESS", "DEFLATE");
+    papszOptions = CSLSetNameValue(papszOptions, "BIGTIFF", "IF_SAFER");
+    GDALDatasetH hDS = GDALCreate(hGTiffDrv, pszFilename,
+                                  nSize, nSize, BAND_COUNT,
+                                  GDT_Byte, papszOptions);
+    CSLDestroy(papszOptions);
+
+    GByte* pabyLine = static_cast<GByte*>(CPLMalloc(nSize));
+    for( int iBand = 1; iBand <= BAND_COUNT; iBand++ )
+    {
+        GDALRasterBandH hBand = GDALGetRasterBand(hDS, iBand);
+        for( int iLine = 0; iLine < nSize; iLine++ )
+        {
+            for( int iPixel = 0; iPixel < nSize; iPixel++ )
+                pabyLine[iPixel] = static_cast<GByte>(
+                    (iPixel * iBand + iLine * 3) ^ (iPixel >> 5));
+            CPL_IGNORE_RET_VAL(GDALRasterIO(hBand, GF_Write, 0, iLine,
+                                            nSize, 1, pabyLine,
+                                            nSize, 1, GDT_Byte, 0, 0));
+        }
+    }
+    CPLFree(pabyLine);
+    GDALClose(hDS);
+}
+
+// Equivalent of gdal_translate -of GTiff -co TILED=YES -co COMPRESS=DEFLATE,
+// returning the elapsed (wall clock) time.
+static double CopyFile( const char* pszSrcFilename, const char* pszDstFilename,
+                        const char* pszNumThreads,
+                        const char* pszCompressionThreads,
+                        int* panChecksums )
+{
+    GDALDriverH hGTiffDrv = GDALGetDriverByName("GTiff");
+    char** papszOptions = CSLSetNameValue(nullptr, "TILED", "YES");
+    papszOptions = CSLSetNameValue(papszOptions, "COMPRESS", "DEFLATE");
+    papszOptions = CSLSetNameValue(papszOptions, "BIGTIFF", "IF_SAFER");
+    papszOptions = CSLSetNameValue(papszOptions, "NUM_THREADS",
+                                   pszCompressionThreads);
+
+    CPLSetConfigOption("GDAL_NUM_THREADS", pszNumThreads);
+    const auto start = std::chrono::steady_clock::now();
+    GDALDatasetH hSrcDS = GDALOpen(pszSrcFilename, GA_ReadOnly);
+    GDALDatasetH hDstDS = GDALCreateCopy(hGTiffDrv, pszDstFilename, hSrcDS,
+                                         FALSE, papszOptions, nullptr, nullptr);
+    GDALClose(hDstDS);
+    const auto end = std::chrono::steady_clock::now();
+    CPLSetConfigOption("GDAL_NUM_THREADS", nullptr);
+    GDALClose(hSrcDS);
+    CSLDestroy(papszOptions);
+
+    hDstDS = GDALOpen(pszDstFilename, GA_ReadOnly);
+    for( int iBand = 1; iBand <= BAND_COUNT; iBand++ )
+    {
+        panChecksums[iBand - 1] =
+            hDstDS ? GDALChecksumImage(GDALGetRasterBand(hDstDS, iBand),
+                                       0, 0, GDALGetRasterXSize(hDstDS),
+                                       GDALGetRasterYSize(hDstDS)) : -1;
+    }
+    GDALClose(hDstDS);
+    VSIUnlink(pszDstFilename);
+
+    return std::chrono::duration<double>(end - start).count();
+}
+
+// Usage: testperfcopywholeraster [raster_size [num_threads]]
+// For example "testperfcopywholeraster 30000 ALL_CPUS" to copy a 2.5 GB file.
+int main(int argc, char* argv[])
+{
+    GDALAllRegister();
+
+    const int nSize = argc >= 2 ? atoi(argv[1]) : 4096;
+    const char* pszNumThreads = argc >= 3 ? argv[2] : "ALL_CPUS";
+    const char* pszSrcFilename = "tmp_testperfcopywholeraster_src.tif";
+    const char* pszDstFilename = "tmp_testperfcopywholeraster_dst.tif";
+    int nRet = 0;
+
+    CreateFile(pszSrcFilename, nSize);
+
+    int anRefChecksums[BAND_COUNT] = { 0 };
+    int anTestChecksums[BAND_COUNT] = { 0 };
+    const double dfRef = CopyFile(pszSrcFilename, pszDstFilename,
+                                  "1", "1", anRefChecksums);
+
+    // Pipelined copy alone, then with multi-threaded compression too.
+    const char* const apszCompressionThreads[] = { "1", pszNumThreads };
+    for( int i = 0; i < 2; i++ )
+    {
+        const double dfTest = CopyFile(pszSrcFilename, pszDstFilename,
+                                       pszNumThreads,
+                                       apszCompressionThreads[i],
+                                       anTestChecksums);
+        const bool bSame = memcmp(anRefChecksums, anTestChecksums,
+                                  sizeof(anRefChecksums)) == 0;
+        if( !bSame )
+            nRet = 1;
+
+        printf("%dx%dx%d DEFLATE, NUM_THREADS=%s : GDAL_NUM_THREADS=1 %.2f s, "
+               "GDAL_NUM_THREADS=%s %.2f s, speedup %.2fx%s\n",
+               nSize, nSize, BAND_COUNT, apszCompressionThreads[i],
+               dfRef, pszNumThreads, dfTest,
+               dfTest > 0 ? dfRef / dfTest : 0.0,
+               bSame ? "" : " (results differ!)");
+    }
+
+    VSIUnlink(pszSrcFilename);
+    GDALDestroyDriverManager();
+    return nRet;
+}
@@ -2,7 +2,8 @@
  * $Id$
  *
  * Project:  GDAL Core
- * Purpose:  Test performance of GDALCopyWords().
+ * Purpose:  Test performance of GDALCopyWords(), and check that the
+ *           vectorized code paths give the same result as the per-word one.
  * Author:   Even Rouault, <even dot rouault at mines dash paris dot org>
  *
  ******************************************************************************
@@ -30,53 +31,146 @@
 #include "gdal.h"
 #include "cpl_conv.h"
 
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
-
-int main(int /* argc */, char* /* argv */ [])
+#include <limits>
+
+static const int WORD_COUNT = 256 * 256;
+// Stride, in words, of the pixel interleaved buffers
+static const int INTERLEAVE = 3;
+
+// Values around the rounding and clamping thresholds of all data types,
+// and a few special ones.
+static const double adfSpecialValues[] = {
+    0.0, -0.0, 0.25, 0.5, 0.49999997, 0.5000001, 1.5, 2.5, -0.5, -1.5, -2.5,
+    -1.0, 127.5, 254.5, 255.0, 255.4, 255.5, 256.0, -128.5,
+    32766.5, 32767.0, 32767.5, 32768.0, -32767.5, -32768.0, -32768.5,
+    -32769.0, 65534.5, 65535.0, 65535.5, 65536.0,
+    2147483520.0, 2147483647.0, 2147483647.5, 2147483648.0,
+    -2147483520.0, -2147483648.0, -2147483648.5, -2147483649.0,
+    4294967295.0, 4294967295.5, 4294967296.0, 1e10, -1e10, 1e30, -1e30,
+    3.4028234663852886e38, 3.5e38, -3.5e38, 1e300, -1e300,
+    std::numeric_limits<double>::quiet_NaN(),
+    std::numeric_limits<double>::infinity(),
+    -std::numeric_limits<double>::infinity()
+};
+
+static void FillSource( void* pSrc, GDALDataType eSrcType )
 {
-    void* in = calloc(1, 256 * 256 * 16);
-    void* out = malloc(256 * 256 * 16);
-
-    int i;
-    int intype, outtype;
-
-    clock_t start, end;
-
-    for(intype=GDT_Byte; intype<=GDT_CFloat64;intype++)
+    const int nSrcSize = GDALGetDataTypeSizeBytes(eSrcType);
+    const int nSpecialCount =
+        static_cast<int>(sizeof(adfSpecialValues) / sizeof(adfSpecialValues[0]));
+    // Scales exercising the range of each data type
+    const double adfScales[] = { 1.0 / 64, 1.0, 300.0, 70000.0, 5e9 };
+    unsigned int nSeed = 1;
+    for( int i = 0; i < WORD_COUNT; i++ )
     {
-        for(outtype=GDT_Byte;outtype<=GDT_CFloat64;outtype++)
+        double dfVal;
+        if( (i % 7) == 0 )
         {
-            start = clock();
-
-            for(i=0;i<1000;i++)
-                GDALCopyWords(in, (GDALDataType)intype, 16, out, (GDALDataType)outtype, 16, 256 * 256);
-
-            end = clock();
-
-            printf("%s -> %s : %.2f s\n",
-                   GDALGetDataTypeName((GDALDataType)intype),
-                   GDALGetDataTypeName((GDALDataType)outtype),
-                   (end - start) * 1.0 / CLOCKS_PER_SEC);
+            dfVal = adfSpecialValues[(i / 7) % nSpecialCount];
+        }
+        else
+        {
+            nSeed = nSeed * 1103515245U + 12345U;
+            const double dfRand = (nSeed >> 8) / 16777216.0 - 0.25;
+            dfVal = dfRand * adfScales[(i / 5) % 5];
+        }
+        // Converted with the per-word code path.
+        GDALCopyWords(&dfVal, GDT_Float64, 0,
+                      static_cast<GByte*>(pSrc) + i * nSrcSize, eSrcType, 0,
+                      1);
+    }
+}
 
-            start = clock();
+// Reference result: word after word, which only uses GDALCopyWord()
+static void CopyWordsOneByOne( const void* pSrc, GDALDataType eSrcType,
+                               int nSrcPixelStride,
+                               void* pDst, GDALDataType eDstType,
+                               int nDstPixelStride )
+{
+    for( int i = 0; i < WORD_COUNT; i++ )
+    {
+        GDALCopyWords(static_cast<const GByte*>(pSrc) + i * nSrcPixelStride,
+                      eSrcType, nSrcPixelStride,
+                      static_cast<GByte*>(pDst) + i * nDstPixelStride,
+                      eDstType, nDstPixelStride, 1);
+    }
+}
 
-            for(i=0;i<1000;i++)
-                GDALCopyWords(in,
-                              (GDALDataType)intype,
-                              GDALGetDataTypeSize((GDALDataType)intype) / 8,
-                              out,
-                              (GDALDataType)outtype,
-                              GDALGetDataTypeSize((GDALDataType)outtype) / 8,
-                              256 * 256);
+static double Time( const void* pSrc, GDALDataType eSrcType,
+                    int nSrcPixelStride,
+                    void* pDst, GDALDataType eDstType, int nDstPixelStride,
+                    int nIters )
+{
+    const clock_t start = clock();
+    for( int i = 0; i < nIters; i++ )
+        GDALCopyWords(pSrc, eSrcType, nSrcPixelStride,
+                      pDst, eDstType, nDstPixelStride, WORD_COUNT);
+    const clock_t end = clock();
+    return static_cast<double>(end - start) / CLOCKS_PER_SEC;
+}
 
-            end = clock();
+int main(int /* argc */, char* /* argv */ [])
+{
+    const size_t nBufferSize = static_cast<size_t>(WORD_COUNT) * 16 * INTERLEAVE;
+    GByte* pabySrc = static_cast<GByte*>(CPLCalloc(1, nBufferSize));
+    GByte* pabySrcInterleaved = static_cast<GByte*>(CPLCalloc(1, nBufferSize));
+    GByte* pabyRef = static_cast<GByte*>(CPLCalloc(1, nBufferSize));
+    GByte* pabyDst = static_cast<GByte*>(CPLCalloc(1, nBufferSize));
+    int nRet = 0;
+
+    for( int intype = GDT_Byte; intype <= GDT_CFloat64; intype++ )
+    {
+        const GDALDataType eSrcType = static_cast<GDALDataType>(intype);
+        const int nSrcSize = GDALGetDataTypeSizeBytes(eSrcType);
+        FillSource(pabySrc, eSrcType);
+        for( int i = 0; i < WORD_COUNT; i++ )
+        {
+            memcpy(pabySrcInterleaved + i * nSrcSize * INTERLEAVE,
+                   pabySrc + i * nSrcSize, nSrcSize);
+        }
 
-            printf("%s -> %s (packed) : %.2f s\n",
-                   GDALGetDataTypeName((GDALDataType)intype),
-                   GDALGetDataTypeName((GDALDataType)outtype),
-                   (end - start) * 1.0 / CLOCKS_PER_SEC);
+        for( int outtype = GDT_Byte; outtype <= GDT_CFloat64; outtype++ )
+        {
+            const GDALDataType eDstType = static_cast<GDALDataType>(outtype);
+            const int nDstSize = GDALGetDataTypeSizeBytes(eDstType);
+
+            // Packed source and destination, pixel interleaved destination,
+            // and pixel interleaved source.
+            const int anSrcStride[] = { nSrcSize, nSrcSize,
+                                        nSrcSize * INTERLEAVE };
+            const int anDstStride[] = { nDstSize, nDstSize * INTERLEAVE,
+                                        nDstSize };
+            const char* const apszMode[] = { "packed", "interleaved dst",
+                                             "interleaved src" };
+            const int anIters[] = { 1000, 200, 200 };
+            printf("%s -> %s :",
+                   GDALGetDataTypeName(eSrcType),
+                   GDALGetDataTypeName(eDstType));
+            for( int iMode = 0; iMode < 3; iMode++ )
+            {
+                const GByte* pabyIn =
+                    iMode == 2 ? pabySrcInterleaved : pabySrc;
+                memset(pabyRef, 0, nBufferSize);
+                memset(pabyDst, 0, nBufferSize);
+                CopyWordsOneByOne(pabyIn, eSrcType, anSrcStride[iMode],
+                                  pabyRef, eDstType, anDstStride[iMode]);
+                const double dfTime =
+                    Time(pabyIn, eSrcType, anSrcStride[iMode],
+                         pabyDst, eDstType, anDstStride[iMode],
+                         anIters[iMode]);
+                const bool bSame = memcmp(pabyRef, pabyDst,
+                    static_cast<size_t>(WORD_COUNT) * anDstStride[iMode]) == 0;
+                if( !bSame )
+                    nRet = 1;
+                printf(" %s %.2f s%s", apszMode[iMode], dfTime,
+                       bSame ? "" : " (results differ!)");
+            }
+            printf("\n");
         }
     }
 
@@ -88,31 +182,22 @@ int main(int /* argc */, char* /* argv */ [])
             CPLSetConfigOption("GDAL_USE_SSSE3", "NO");
         }
 
-        // 2 byte stride --> packed byte
-        start = clock();
-        for(i=0;i<100000;i++)
-            GDALCopyWords(in, GDT_Byte, 2, out, GDT_Byte, 1, 256 * 256);
-        end = clock();
-        printf("2-byte stride Byte ->packed Byte : %.2f\n",
-                (end - start) * 1.0 / CLOCKS_PER_SEC);
-
-        // 3 byte stride --> packed byte
-        start = clock();
-        for(i=0;i<100000;i++)
-            GDALCopyWords(in, GDT_Byte, 3, out, GDT_Byte, 1, 256 * 256);
-        end = clock();
-        printf("3-byte stride Byte ->packed Byte : %.2f\n",
-                (end - start) * 1.0 / CLOCKS_PER_SEC);
-
-        // 4 byte stride --> packed byte
-        start = clock();
-        for(i=0;i<100000;i++)
-            GDALCopyWords(in, GDT_Byte, 4, out, GDT_Byte, 1, 256 * 256);
-        end = clock();
-        printf("4-byte stride Byte ->packed Byte : %.2f\n",
-                (end - start) * 1.0 / CLOCKS_PER_SEC);
+        for( int nStride = 2; nStride <= 4; nStride++ )
+        {
+            const clock_t start = clock();
+            for( int i = 0; i < 100000; i++ )
+                GDALCopyWords(pabySrc, GDT_Byte, nStride,
+                              pabyDst, GDT_Byte, 1, WORD_COUNT);
+            const clock_t end = clock();
+            printf("%d-byte stride Byte ->packed Byte : %.2f\n", nStride,
+                   static_cast<double>(end - start) / CLOCKS_PER_SEC);
+        }
     }
     CPLSetConfigOption("GDAL_USE_SSSE3", nullptr);
 
-    return 0;
+    CPLFree(pabySrc);
+    CPLFree(pabySrcInterleaved);
+    CPLFree(pabyRef);
+    CPLFree(pabyDst);
+    return nRet;
 }
@@ -0,0 +1,144 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL Core
+ * Purpose:  Test performance of reading uncompressed GeoTIFF files through
+ *           the block cache and with GTIFF_DIRECT_IO.
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "gdal.h"
+#include "cpl_conv.h"
+#include "cpl_string.h"
+#include "cpl_vsi.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+static const int RASTER_SIZE = 4096;
+static const int BAND_COUNT = 3;
+static const int LOOPS = 5;
+
+static void CreateFile( const char* pszFilename, const char* pszInterleave,
+                        bool bTiled )
+{
+    GDALDriverH hGTiffDrv = GDALGetDriverByName("GTiff");
+    char** papszOptions = CSLSetNameValue(nullptr, "INTERLEAVE",
+                                          pszInterleave);
+    if( bTiled )
+        papszOptions = CSLSetNameValue(papszOptions, "TILED", "YES");
+    GDALDatasetH hDS = GDALCreate(hGTiffDrv, pszFilename,
+                                  RASTER_SIZE, RASTER_SIZE, BAND_COUNT,
+                                  GDT_Byte, papszOptions);
+    CSLDestroy(papszOptions);
+
+    GByte* pabyLine = static_cast<GByte*>(CPLMalloc(RASTER_SIZE));
+    for( int iBand = 1; iBand <= BAND_COUNT; iBand++ )
+    {
+        GDALRasterBandH hBand = GDALGetRasterBand(hDS, iBand);
+        for( int iLine = 0; iLine < RASTER_SIZE; iLine++ )
+        {
+            for( int iPixel = 0; iPixel < RASTER_SIZE; iPixel++ )
+                pabyLine[iPixel] =
+                    static_cast<GByte>(iPixel * iBand + iLine * 3);
+            CPL_IGNORE_RET_VAL(GDALRasterIO(hBand, GF_Write, 0, iLine,
+                                            RASTER_SIZE, 1, pabyLine,
+                                            RASTER_SIZE, 1, GDT_Byte, 0, 0));
+        }
+    }
+    CPLFree(pabyLine);
+    GDALClose(hDS);
+}
+
+// Read the whole raster LOOPS times, pixel-interleaved, each time from a
+// freshly opened dataset so that the block cache does not help.
+static double ReadFile( const char* pszFilename, const char* pszDirectIO,
+                        GByte* pabyBuffer )
+{
+    CPLSetConfigOption("GTIFF_DIRECT_IO", pszDirectIO);
+    const clock_t start = clock();
+    for( int i = 0; i < LOOPS; i++ )
+    {
+        GDALDatasetH hDS = GDALOpen(pszFilename, GA_ReadOnly);
+        CPL_IGNORE_RET_VAL(GDALDatasetRasterIO(
+            hDS, GF_Read, 0, 0, RASTER_SIZE, RASTER_SIZE,
+            pabyBuffer, RASTER_SIZE, RASTER_SIZE, GDT_Byte,
+            BAND_COUNT, nullptr,
+            BAND_COUNT, BAND_COUNT * RASTER_SIZE, 1));
+        GDALClose(hDS);
+        GDALFlushCache(nullptr);
+    }
+    const clock_t end = clock();
+    CPLSetConfigOption("GTIFF_DIRECT_IO", nullptr);
+
+    return static_cast<double>(end - start) / CLOCKS_PER_SEC;
+}
+
+int main(int /* argc */, char* /* argv */ [])
+{
+    GDALAllRegister();
+
+    const char* const apszInterleave[] = { "PIXEL", "BAND" };
+    const size_t nBytes =
+        static_cast<size_t>(RASTER_SIZE) * RASTER_SIZE * BAND_COUNT;
+    GByte* pabyRef = static_cast<GByte*>(CPLMalloc(nBytes));
+    GByte* pabyTest = static_cast<GByte*>(CPLMalloc(nBytes));
+    const char* pszFilename = "tmp_testperfgtiffdirectio.tif";
+    int nRet = 0;
+
+    for( int iTiled = 0; iTiled < 2; iTiled++ )
+    {
+        const bool bTiled = iTiled == 1;
+        for( size_t iInterleave = 0;
+             iInterleave < sizeof(apszInterleave) / sizeof(apszInterleave[0]);
+             iInterleave++ )
+        {
+            CreateFile(pszFilename, apszInterleave[iInterleave], bTiled);
+
+            // Warm the OS file cache.
+            ReadFile(pszFilename, "NO", pabyRef);
+
+            const double dfRef = ReadFile(pszFilename, "NO", pabyRef);
+            const double dfTest = ReadFile(pszFilename, "YES", pabyTest);
+            const bool bSame = memcmp(pabyRef, pabyTest, nBytes) == 0;
+            if( !bSame )
+                nRet = 1;
+
+            printf("%s INTERLEAVE=%s : GTIFF_DIRECT_IO=NO %.2f s, "
+                   "GTIFF_DIRECT_IO=YES %.2f s, speedup %.2fx%s\n",
+                   bTiled ? "TILED" : "STRIPPED",
+                   apszInterleave[iInterleave],
+                   dfRef, dfTest, dfTest > 0 ? dfRef / dfTest : 0.0,
+                   bSame ? "" : " (results differ!)");
+
+            VSIUnlink(pszFilename);
+        }
+    }
+
+    CPLFree(pabyRef);
+    CPLFree(pabyTest);
+    GDALDestroyDriverManager();
+    return nRet;
+}
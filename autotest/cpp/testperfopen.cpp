@@ -0,0 +1,116 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL Core
+ * Purpose:  Test performance of GDALOpenEx() on small files of various
+ *           formats, with and without the driver dispatch index.
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "gdal.h"
+#include "cpl_conv.h"
+#include "cpl_string.h"
+#include "cpl_vsi.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Opens and closes pszFilename nIters times, returning the average elapsed
+// (wall clock) time per open in microseconds.
+static double TimeOpen( const char* pszFilename, int nIters,
+                        const char* pszDispatchIndex, CPLString& osDriver )
+{
+    CPLSetConfigOption("GDAL_OPEN_DISPATCH_INDEX", pszDispatchIndex);
+    const auto start = std::chrono::steady_clock::now();
+    for( int i = 0; i < nIters; i++ )
+    {
+        GDALDatasetH hDS = GDALOpenEx(pszFilename, GDAL_OF_RASTER,
+                                      nullptr, nullptr, nullptr);
+        if( hDS == nullptr )
+        {
+            osDriver = "(failed)";
+            break;
+        }
+        osDriver = GDALGetDriverShortName(GDALGetDatasetDriver(hDS));
+        GDALClose(hDS);
+    }
+    const auto end = std::chrono::steady_clock::now();
+    CPLSetConfigOption("GDAL_OPEN_DISPATCH_INDEX", nullptr);
+    return std::chrono::duration<double>(end - start).count() * 1e6 / nIters;
+}
+
+// Usage: testperfopen [iterations]
+int main(int argc, char* argv[])
+{
+    GDALAllRegister();
+
+    const int nIters = argc >= 2 ? atoi(argv[1]) : 1000;
+    const char* const apszFormats[][2] = {
+        { "GTiff", "tif" }, { "PNG", "png" }, { "JPEG", "jpg" },
+        { "GIF", "gif" }, { "BMP", "bmp" }, { "HFA", "img" },
+        { "NITF", "ntf" }, { "AAIGrid", "asc" }, { "ENVI", "bin" } };
+    int nRet = 0;
+
+    GDALDriverH hMEMDrv = GDALGetDriverByName("MEM");
+    GDALDatasetH hSrcDS = GDALCreate(hMEMDrv, "", 64, 64, 1, GDT_Byte,
+                                     nullptr);
+    GDALFillRaster(GDALGetRasterBand(hSrcDS, 1), 1, 0);
+
+    for( size_t i = 0; i < sizeof(apszFormats) / sizeof(apszFormats[0]); i++ )
+    {
+        GDALDriverH hDrv = GDALGetDriverByName(apszFormats[i][0]);
+        if( hDrv == nullptr )
+            continue;
+        const CPLString osFilename(CPLSPrintf("tmp_testperfopen.%s",
+                                              apszFormats[i][1]));
+        GDALDatasetH hDS = GDALCreateCopy(hDrv, osFilename, hSrcDS, FALSE,
+                                          nullptr, nullptr, nullptr);
+        if( hDS == nullptr )
+            continue;
+        GDALClose(hDS);
+
+        CPLString osRefDriver;
+        CPLString osTestDriver;
+        const double dfRef = TimeOpen(osFilename, nIters, "NO", osRefDriver);
+        const double dfTest = TimeOpen(osFilename, nIters, "YES",
+                                       osTestDriver);
+        const bool bSame = osRefDriver == osTestDriver;
+        if( !bSame )
+            nRet = 1;
+
+        printf("%-8s: full scan %8.1f us/open, dispatch index %8.1f us/open, "
+               "speedup %.2fx%s\n",
+               apszFormats[i][0], dfRef, dfTest,
+               dfTest > 0 ? dfRef / dfTest : 0.0,
+               bSame ? "" : " (opened by a different driver!)");
+
+        GDALDeleteDataset(hDrv, osFilename);
+    }
+
+    GDALClose(hSrcDS);
+    GDALDestroyDriverManager();
+    return nRet;
+}
@@ -0,0 +1,128 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL Core
+ * Purpose:  Test performance of GDALRegenerateOverviews(), with and without
+ *           the AVX kernels.
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "gdal.h"
+#include "cpl_conv.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+static const int SRC_SIZE = 2048;
+static const int OVR_SIZE = SRC_SIZE / 2;
+
+static double RunOverview( GDALRasterBandH hSrcBand, GDALDataType eType,
+                           const char* pszResampling, const char* pszUseAVX,
+                           void* pOutBuffer )
+{
+    GDALDriverH hMEMDrv = GDALGetDriverByName("MEM");
+    GDALDatasetH hOvrDS = GDALCreate(hMEMDrv, "", OVR_SIZE, OVR_SIZE, 1,
+                                     eType, nullptr);
+    GDALRasterBandH hOvrBand = GDALGetRasterBand(hOvrDS, 1);
+
+    CPLSetConfigOption("GDAL_USE_AVX", pszUseAVX);
+    const clock_t start = clock();
+    GDALRegenerateOverviews(hSrcBand, 1, &hOvrBand, pszResampling,
+                            nullptr, nullptr);
+    const clock_t end = clock();
+    CPLSetConfigOption("GDAL_USE_AVX", nullptr);
+
+    CPL_IGNORE_RET_VAL(GDALRasterIO(hOvrBand, GF_Read, 0, 0,
+                                    OVR_SIZE, OVR_SIZE,
+                                    pOutBuffer, OVR_SIZE, OVR_SIZE, eType,
+                                    0, 0));
+    GDALClose(hOvrDS);
+
+    return static_cast<double>(end - start) / CLOCKS_PER_SEC;
+}
+
+int main(int /* argc */, char* /* argv */ [])
+{
+    GDALAllRegister();
+
+    const GDALDataType aeTypes[] = { GDT_Byte, GDT_UInt16, GDT_Int16,
+                                     GDT_Float32, GDT_Float64 };
+    const char* const apszResampling[] = { "CUBIC", "LANCZOS", "BILINEAR",
+                                           "AVERAGE" };
+
+    GDALDriverH hMEMDrv = GDALGetDriverByName("MEM");
+    GByte* pabyLine = static_cast<GByte*>(CPLMalloc(SRC_SIZE));
+    void* pRef = CPLMalloc(static_cast<size_t>(OVR_SIZE) * OVR_SIZE * 8);
+    void* pTest = CPLMalloc(static_cast<size_t>(OVR_SIZE) * OVR_SIZE * 8);
+    int nRet = 0;
+
+    for( size_t iType = 0; iType < sizeof(aeTypes) / sizeof(aeTypes[0]);
+         iType++ )
+    {
+        const GDALDataType eType = aeTypes[iType];
+        GDALDatasetH hSrcDS = GDALCreate(hMEMDrv, "", SRC_SIZE, SRC_SIZE, 1,
+                                         eType, nullptr);
+        GDALRasterBandH hSrcBand = GDALGetRasterBand(hSrcDS, 1);
+        for( int iLine = 0; iLine < SRC_SIZE; iLine++ )
+        {
+            for( int iPixel = 0; iPixel < SRC_SIZE; iPixel++ )
+                pabyLine[iPixel] =
+                    static_cast<GByte>((iPixel * 7 + iLine * 13) ^ iLine);
+            CPL_IGNORE_RET_VAL(GDALRasterIO(hSrcBand, GF_Write, 0, iLine,
+                                            SRC_SIZE, 1, pabyLine,
+                                            SRC_SIZE, 1, GDT_Byte, 0, 0));
+        }
+
+        const size_t nBytes = static_cast<size_t>(OVR_SIZE) * OVR_SIZE *
+                              GDALGetDataTypeSizeBytes(eType);
+        for( size_t iResampling = 0;
+             iResampling < sizeof(apszResampling) / sizeof(apszResampling[0]);
+             iResampling++ )
+        {
+            const char* pszResampling = apszResampling[iResampling];
+            const double dfRef =
+                RunOverview(hSrcBand, eType, pszResampling, "NO", pRef);
+            const double dfTest =
+                RunOverview(hSrcBand, eType, pszResampling, "YES", pTest);
+            const bool bSame = memcmp(pRef, pTest, nBytes) == 0;
+            if( !bSame )
+                nRet = 1;
+
+            printf("%s %s : GDAL_USE_AVX=NO %.2f s, "
+                   "GDAL_USE_AVX=YES %.2f s, speedup %.2fx%s\n",
+                   GDALGetDataTypeName(eType), pszResampling,
+                   dfRef, dfTest, dfTest > 0 ? dfRef / dfTest : 0.0,
+                   bSame ? "" : " (results differ!)");
+        }
+
+        GDALClose(hSrcDS);
+    }
+
+    CPLFree(pabyLine);
+    CPLFree(pRef);
+    CPLFree(pTest);
+    GDALDestroyDriverManager();
+    return nRet;
+}
@@ -28,6 +28,7 @@
 ###############################################################################
 
 import os
+import math
 import sys
 import struct
 import shutil
@@ -781,6 +782,72 @@ def stats_nodata_almost_max_float32():
 
     return 'success'
 
+###############################################################################
+# Test that statistics, min/max and histograms computed with several threads
+# are the same as with a single thread, and match the expected values
+
+def stats_num_threads():
+
+    res = {}
+    for num_threads in ['1', '4']:
+        for (dt, fmt) in [(gdal.GDT_Byte, 'B'), (gdal.GDT_UInt16, 'H'),
+                          (gdal.GDT_Int16, 'h'), (gdal.GDT_Int32, 'i'),
+                          (gdal.GDT_Float32, 'f'),
+                          (gdal.GDT_Float64, 'd')]:
+            filename = '/vsimem/stats_num_threads.tif'
+            ds = gdal.GetDriverByName('GTiff').Create(
+                filename, 250, 250, 1, dt,
+                options=['TILED=YES', 'BLOCKXSIZE=32', 'BLOCKYSIZE=32'])
+            ds.GetRasterBand(1).SetNoDataValue(7)
+            for y in range(250):
+                data = [((x * 13 + y * 7) % 101) * 0.5 if fmt in ('f', 'd')
+                        else (x * 13 + y * 7) % 101 for x in range(250)]
+                ds.GetRasterBand(1).WriteRaster(
+                    0, y, 250, 1, struct.pack(fmt * 250, *data))
+            ds = None
+
+            with gdaltest.config_option('GDAL_NUM_THREADS', num_threads):
+                ds = gdal.Open(filename)
+                band = ds.GetRasterBand(1)
+                minmax = band.ComputeRasterMinMax()
+                stats = band.ComputeStatistics(False)
+                approx_stats = band.ComputeStatistics(True)
+                hist = band.GetHistogram(-0.5, 100.5, 101,
+                                         approx_ok=0)
+                ds = None
+            gdal.GetDriverByName('GTiff').Delete(filename)
+            res[(num_threads, dt)] = (minmax, stats, approx_stats, hist)
+
+            values = [((x * 13 + y * 7) % 101) * (0.5 if fmt in ('f', 'd')
+                                                  else 1)
+                      for y in range(250) for x in range(250)]
+            values = [v for v in values if v != 7]
+            mean = float(sum(values)) / len(values)
+            stddev = math.sqrt(sum((v - mean) * (v - mean)
+                                   for v in values) / len(values))
+            expected_max = 50 if fmt in ('f', 'd') else 100
+            if minmax != (0, expected_max) or \
+               stats[0] != 0 or stats[1] != expected_max or \
+               abs(stats[2] - mean) > 1e-10 * mean or \
+               abs(stats[3] - stddev) > 1e-10 * stddev:
+                gdaltest.post_reason('got wrong statistics')
+                print(num_threads, dt)
+                print(minmax, stats)
+                print(mean, stddev)
+                return 'fail'
+
+    for key in res:
+        if key[0] == '1':
+            continue
+        if res[key] != res[('1', key[1])]:
+            gdaltest.post_reason('got different results with threads')
+            print(key[1])
+            print(res[key])
+            print(res[('1', key[1])])
+            return 'fail'
+
+    return 'success'
+
 ###############################################################################
 # Run tests
 
@@ -808,6 +875,7 @@ gdaltest_list = [
     stats_byte_partial_tiles,
     stats_uint16,
     stats_nodata_almost_max_float32,
+    stats_num_threads,
     ]
 
 if __name__ == '__main__':
@@ -1081,6 +1081,75 @@ cellsize     0
 
     return 'success'
 
+###############################################################################
+# Test GDALDatasetCopyWholeRaster() reading in a worker thread
+
+def rasterio_17_progress_interrupt(pct, message, user_data):
+    # pylint: disable=unused-argument
+    return pct < 0.5
+
+def rasterio_17():
+
+    src_ds = gdal.Open('data/rgbsmall.tif')
+    ref_cs = [src_ds.GetRasterBand(i+1).Checksum() for i in range(3)]
+
+    for interleave in ['PIXEL', 'BAND']:
+        for options in [[], ['TILED=YES', 'BLOCKXSIZE=16', 'BLOCKYSIZE=16',
+                             'COMPRESS=DEFLATE']]:
+            with gdaltest.config_options({'GDAL_NUM_THREADS': '2',
+                                          'GDAL_SWATH_SIZE': '1000'}):
+                ds = gdal.GetDriverByName('GTiff').CreateCopy(
+                    '/vsimem/rasterio_17.tif', src_ds,
+                    options = options + ['INTERLEAVE=' + interleave])
+            cs = [ds.GetRasterBand(i+1).Checksum() for i in range(3)]
+            ds = None
+            if cs != ref_cs:
+                gdaltest.post_reason('fail')
+                print(interleave, options, cs)
+                return 'fail'
+
+    # Interruption by the progress function
+    with gdaltest.config_options({'GDAL_NUM_THREADS': '2',
+                                  'GDAL_SWATH_SIZE': '1000'}):
+        with gdaltest.error_handler():
+            ds = gdal.GetDriverByName('GTiff').CreateCopy(
+                '/vsimem/rasterio_17.tif', src_ds,
+                callback = rasterio_17_progress_interrupt)
+    if ds is not None:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    gdal.Unlink('/vsimem/rasterio_17.tif')
+
+    return 'success'
+
+###############################################################################
+# Test multi-threaded resampling in RasterIO()
+
+def rasterio_18():
+
+    src_ds = gdal.Translate('', 'data/byte.tif', format = 'MEM',
+                            width = 1000, height = 1000,
+                            resampleAlg = gdal.GRIORA_Bilinear)
+    src_ds.GetRasterBand(1).SetNoDataValue(107)
+
+    for resample_alg in [gdal.GRIORA_Bilinear, gdal.GRIORA_Cubic,
+                         gdal.GRIORA_Lanczos, gdal.GRIORA_Average]:
+        for buf_type in [gdal.GDT_Byte, gdal.GDT_Float32]:
+            ref_data = src_ds.GetRasterBand(1).ReadRaster(
+                10, 20, 900, 800, 250, 200, buf_type = buf_type,
+                resample_alg = resample_alg)
+            with gdaltest.config_option('GDAL_NUM_THREADS', '4'):
+                data = src_ds.GetRasterBand(1).ReadRaster(
+                    10, 20, 900, 800, 250, 200, buf_type = buf_type,
+                    resample_alg = resample_alg)
+            if data != ref_data:
+                gdaltest.post_reason('fail')
+                print(resample_alg, buf_type)
+                return 'fail'
+
+    return 'success'
+
 
 gdaltest_list = [
     rasterio_1,
@@ -1098,7 +1167,9 @@ gdaltest_list = [
     rasterio_13,
     rasterio_14,
     rasterio_15,
-    rasterio_16
+    rasterio_16,
+    rasterio_17,
+    rasterio_18
     ]
 
 #gdaltest_list = [ rasterio_16 ]
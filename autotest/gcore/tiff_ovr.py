@@ -2203,6 +2203,34 @@ def tiff_ovr_54():
 
     return 'success'
 
+###############################################################################
+# Test that multi-threaded overview computation gives the same result as
+# the single-threaded one.
+
+def tiff_ovr_55():
+
+    src_ds = gdal.Open('../gdrivers/data/small_world.tif')
+    for interleave in [ 'BAND', 'PIXEL' ]:
+        for resampling in [ 'NEAREST', 'AVERAGE', 'GAUSS', 'CUBIC', 'MODE' ]:
+            cs = []
+            for num_threads in [ '1', '4' ]:
+                ds = gdal.GetDriverByName('GTiff').CreateCopy(
+                    '/vsimem/tiff_ovr_55.tif', src_ds,
+                    options = ['INTERLEAVE=' + interleave])
+                gdal.SetConfigOption('GDAL_NUM_THREADS', num_threads)
+                ds.BuildOverviews(resampling, [2, 4, 8])
+                gdal.SetConfigOption('GDAL_NUM_THREADS', None)
+                cs.append( [ ds.GetRasterBand(i+1).GetOverview(j).Checksum()
+                             for i in range(3) for j in range(3) ] )
+                ds = None
+                gdal.GetDriverByName('GTiff').Delete('/vsimem/tiff_ovr_55.tif')
+            if cs[0] != cs[1]:
+                gdaltest.post_reason('fail')
+                print(interleave, resampling, cs)
+                return 'fail'
+
+    return 'success'
+
 ###############################################################################
 # Cleanup
 
@@ -2321,7 +2349,8 @@ gdaltest_list.append(tiff_ovr_restore_endianness)
 gdaltest_list += [ tiff_ovr_51,
                    tiff_ovr_52,
                    tiff_ovr_53,
-                   tiff_ovr_54 ]
+                   tiff_ovr_54,
+                   tiff_ovr_55 ]
 
 if __name__ == '__main__':
 
@@ -3636,6 +3636,231 @@ def tiff_read_zstd_corrupted2():
     with gdaltest.error_handler():
         return ut.testOpen()
 
+###############################################################################
+# Test multi-threaded decompression
+
+def tiff_read_multi_threaded():
+
+    src_ds = gdal.Open('data/rgbsmall.tif')
+    for interleave in ['PIXEL', 'BAND']:
+        gdal.Translate('/vsimem/tiff_read_multi_threaded.tif', src_ds,
+                       creationOptions = ['TILED=YES', 'BLOCKXSIZE=16',
+                                          'BLOCKYSIZE=16', 'COMPRESS=DEFLATE',
+                                          'INTERLEAVE=' + interleave])
+        for num_threads in ['1', '4']:
+            ds = gdal.OpenEx('/vsimem/tiff_read_multi_threaded.tif',
+                             open_options = ['NUM_THREADS=' + num_threads])
+            if ds.ReadRaster() != src_ds.ReadRaster():
+                gdaltest.post_reason('fail')
+                print(interleave, num_threads)
+                return 'fail'
+            for i in range(3):
+                if ds.GetRasterBand(i+1).Checksum() != \
+                   src_ds.GetRasterBand(i+1).Checksum():
+                    gdaltest.post_reason('fail')
+                    print(interleave, num_threads, i)
+                    return 'fail'
+            ds = None
+    gdal.Unlink('/vsimem/tiff_read_multi_threaded.tif')
+
+    return 'success'
+
+###############################################################################
+# Test multi-threaded decompression of partial strips and tiles
+
+def tiff_read_multi_threaded_partial_blocks():
+
+    src_ds = gdal.Open('data/rgbsmall.tif')
+    # 50x50 raster: the last strip has 2 lines, and the tiles of the last
+    # row and column are partial.
+    for options in [ ['BLOCKYSIZE=16'],
+                     ['TILED=YES', 'BLOCKXSIZE=16', 'BLOCKYSIZE=16'] ]:
+        gdal.Translate('/vsimem/tiff_read_multi_threaded_partial.tif', src_ds,
+                       creationOptions = options + ['COMPRESS=DEFLATE'])
+        ds = gdal.OpenEx('/vsimem/tiff_read_multi_threaded_partial.tif',
+                         open_options = ['NUM_THREADS=4'])
+        for (xoff, yoff, xsize, ysize) in [ (0, 0, 50, 50), (3, 5, 47, 45),
+                                            (17, 33, 30, 17) ]:
+            if ds.ReadRaster(xoff, yoff, xsize, ysize) != \
+               src_ds.ReadRaster(xoff, yoff, xsize, ysize):
+                gdaltest.post_reason('fail')
+                print(options, xoff, yoff, xsize, ysize)
+                return 'fail'
+        ds = None
+    gdal.Unlink('/vsimem/tiff_read_multi_threaded_partial.tif')
+
+    return 'success'
+
+###############################################################################
+# Test that a block that cannot be decoded by a worker thread is reported as
+# in single-threaded mode
+
+def tiff_read_multi_threaded_decode_error():
+
+    src_ds = gdal.Open('data/rgbsmall.tif')
+    filename = '/vsimem/tiff_read_multi_threaded_decode_error.tif'
+    gdal.Translate(filename, src_ds,
+                   creationOptions = ['TILED=YES', 'BLOCKXSIZE=16',
+                                      'BLOCKYSIZE=16', 'COMPRESS=DEFLATE',
+                                      'INTERLEAVE=BAND'])
+    ds = gdal.Open(filename)
+    offset = int(ds.GetRasterBand(1).GetMetadataItem('BLOCK_OFFSET_1_1', 'TIFF'))
+    size = int(ds.GetRasterBand(1).GetMetadataItem('BLOCK_SIZE_1_1', 'TIFF'))
+    ds = None
+    f = gdal.VSIFOpenL(filename, 'rb+')
+    gdal.VSIFSeekL(f, offset, 0)
+    gdal.VSIFWriteL('\xff' * size, 1, size, f)
+    gdal.VSIFCloseL(f)
+
+    results = []
+    for num_threads in ['1', '4']:
+        ds = gdal.OpenEx(filename, open_options = ['NUM_THREADS=' + num_threads])
+        gdal.ErrorReset()
+        with gdaltest.error_handler():
+            data = ds.GetRasterBand(1).ReadRaster()
+        results.append((data, gdal.GetLastErrorMsg()))
+        # The other bands are not affected
+        if ds.GetRasterBand(2).ReadRaster() != \
+           src_ds.GetRasterBand(2).ReadRaster():
+            gdaltest.post_reason('fail')
+            print(num_threads)
+            return 'fail'
+        ds = None
+    gdal.Unlink(filename)
+
+    if results[0][0] is not None or results[0][1] == '' or \
+       results[1] != results[0]:
+        gdaltest.post_reason('fail')
+        print(results[0][1])
+        print(results[1][1])
+        return 'fail'
+
+    return 'success'
+
+###############################################################################
+# Test that the overviews and the mask use the decompression threads of the
+# main dataset
+
+def tiff_read_multi_threaded_overview_mask():
+
+    src_ds = gdal.Open('data/rgbsmall.tif')
+    filename = '/vsimem/tiff_read_multi_threaded_overview_mask.tif'
+    with gdaltest.config_option('GDAL_TIFF_INTERNAL_MASK', 'YES'):
+        ds = gdal.Translate(filename, src_ds,
+                            creationOptions = ['TILED=YES', 'BLOCKXSIZE=16',
+                                               'BLOCKYSIZE=16',
+                                               'COMPRESS=DEFLATE'])
+        ds.CreateMaskBand(gdal.GMF_PER_DATASET)
+        ds.GetRasterBand(1).GetMaskBand().WriteRaster(
+            0, 0, 50, 50, ''.join([chr(255 * ((i // 7) % 2)) for i in range(2500)]))
+        with gdaltest.config_option('COMPRESS_OVERVIEW', 'DEFLATE'):
+            ds.BuildOverviews('NEAR', [2])
+        ds = None
+
+    ref_ds = gdal.Open(filename)
+    ref_ovr = ref_ds.GetRasterBand(1).GetOverview(0).ReadRaster()
+    ref_mask = ref_ds.GetRasterBand(1).GetMaskBand().ReadRaster()
+    ref_ds = None
+
+    debug_messages = []
+
+    def debug_handler(err_class, err_no, msg):
+        if err_class == gdal.CE_Debug and \
+           msg.find('threads for decompression') >= 0:
+            debug_messages.append(msg)
+
+    ds = gdal.OpenEx(filename, open_options = ['NUM_THREADS=4'])
+    with gdaltest.config_option('CPL_DEBUG', 'ON'):
+        gdal.PushErrorHandler(debug_handler)
+        got_ovr = ds.GetRasterBand(1).GetOverview(0).ReadRaster()
+        got_mask = ds.GetRasterBand(1).GetMaskBand().ReadRaster()
+        got = ds.ReadRaster()
+        gdal.PopErrorHandler()
+    ds = None
+    gdal.Unlink(filename)
+
+    if got_ovr != ref_ovr or got_mask != ref_mask or \
+       got != src_ds.ReadRaster():
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    # A single job queue, created by the first read of the overview
+    if len(debug_messages) != 1:
+        gdaltest.post_reason('fail')
+        print(debug_messages)
+        return 'fail'
+
+    return 'success'
+
+###############################################################################
+# Test reading blocks ahead with GDAL_PREFETCH_NUM_THREADS
+
+def tiff_read_prefetch():
+
+    debug_messages = []
+
+    def debug_handler(err_class, err_no, msg):
+        if err_class == gdal.CE_Debug and \
+           msg.find('blocks prefetched') >= 0:
+            debug_messages.append(msg)
+
+    src_ds = gdal.Open('data/rgbsmall.tif')
+    for interleave in ['PIXEL', 'BAND']:
+        gdal.Translate('/vsimem/tiff_read_prefetch.tif', src_ds,
+                       creationOptions = ['TILED=YES', 'BLOCKXSIZE=16',
+                                          'BLOCKYSIZE=16', 'COMPRESS=DEFLATE',
+                                          'INTERLEAVE=' + interleave])
+        with gdaltest.config_option('GDAL_PREFETCH_NUM_THREADS', '2'):
+
+            # Sequential read of scanlines
+            with gdaltest.config_option('CPL_DEBUG', 'ON'):
+                gdal.PushErrorHandler(debug_handler)
+                ds = gdal.Open('/vsimem/tiff_read_prefetch.tif')
+                for i in range(3):
+                    band = ds.GetRasterBand(i+1)
+                    src_band = src_ds.GetRasterBand(i+1)
+                    for y in range(ds.RasterYSize):
+                        if band.ReadRaster(0, y, ds.RasterXSize, 1) != \
+                           src_band.ReadRaster(0, y, ds.RasterXSize, 1):
+                            gdal.PopErrorHandler()
+                            gdaltest.post_reason('fail')
+                            print(interleave, i, y)
+                            return 'fail'
+                ds = None
+                gdal.PopErrorHandler()
+
+            # Check that the blocks were really taken from the prefetcher
+            if len(debug_messages) != 1:
+                gdaltest.post_reason('fail')
+                print(debug_messages)
+                return 'fail'
+            used = int(debug_messages[0].split(', ')[1].split(' ')[0])
+            if used == 0:
+                gdaltest.post_reason('fail')
+                print(interleave, debug_messages)
+                return 'fail'
+            del debug_messages[:]
+
+            # Read of an advised window
+            ds = gdal.Open('/vsimem/tiff_read_prefetch.tif')
+            if ds.AdviseRead(5, 7, 40, 30) != 0:
+                gdaltest.post_reason('fail')
+                return 'fail'
+            if ds.ReadRaster(5, 7, 40, 30) != src_ds.ReadRaster(5, 7, 40, 30):
+                gdaltest.post_reason('fail')
+                print(interleave)
+                return 'fail'
+            ds = None
+
+            # Advised window never read
+            ds = gdal.Open('/vsimem/tiff_read_prefetch.tif')
+            ds.AdviseRead(0, 0, ds.RasterXSize, ds.RasterYSize)
+            ds = None
+
+    gdal.Unlink('/vsimem/tiff_read_prefetch.tif')
+
+    return 'success'
+
 ###############################################################################
 
 for item in init_list:
@@ -3763,6 +3988,11 @@ gdaltest_list.append( (tiff_read_negative_scaley) )
 gdaltest_list.append( (tiff_read_zstd) )
 gdaltest_list.append( (tiff_read_zstd_corrupted) )
 gdaltest_list.append( (tiff_read_zstd_corrupted2) )
+gdaltest_list.append( (tiff_read_multi_threaded) )
+gdaltest_list.append( (tiff_read_multi_threaded_partial_blocks) )
+gdaltest_list.append( (tiff_read_multi_threaded_decode_error) )
+gdaltest_list.append( (tiff_read_multi_threaded_overview_mask) )
+gdaltest_list.append( (tiff_read_prefetch) )
 
 gdaltest_list.append( (tiff_read_online_1) )
 gdaltest_list.append( (tiff_read_online_2) )
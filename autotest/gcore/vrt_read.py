@@ -1364,6 +1364,193 @@ dy           1
 
     return 'success'
 
+###############################################################################
+# Test reading sources concurrently with VRT_NUM_THREADS
+
+def vrt_read_32():
+
+    src_ds = gdal.Open('data/byte.tif')
+    ref_cs = src_ds.GetRasterBand(1).Checksum()
+    tiles = []
+    for (xoff, yoff) in [(0,0), (10,0), (0,10), (10,10)]:
+        name = '/vsimem/vrt_read_32_%d_%d.tif' % (xoff, yoff)
+        gdal.Translate(name, src_ds, srcWin = [xoff, yoff, 10, 10])
+        tiles.append(name)
+    # Overlapping the 4 previous tiles, and declared last
+    gdal.Translate('/vsimem/vrt_read_32_overlap.tif', src_ds,
+                   srcWin = [5, 5, 10, 10], scaleParams = [[0, 255, 255, 0]])
+
+    ret = 'success'
+    with gdaltest.config_option('VRT_NUM_THREADS', '4'):
+        vrt_ds = gdal.BuildVRT('', tiles)
+        cs = vrt_ds.GetRasterBand(1).Checksum()
+        if cs != ref_cs:
+            gdaltest.post_reason('fail')
+            print(cs, ref_cs)
+            ret = 'fail'
+        data = vrt_ds.GetRasterBand(1).ReadRaster(5, 5, 10, 10)
+        if data != src_ds.GetRasterBand(1).ReadRaster(5, 5, 10, 10):
+            gdaltest.post_reason('fail')
+            ret = 'fail'
+        vrt_ds = None
+
+        vrt_ds = gdal.BuildVRT('', tiles + ['/vsimem/vrt_read_32_overlap.tif'])
+        cs = vrt_ds.GetRasterBand(1).Checksum()
+    vrt_ds = gdal.BuildVRT('', tiles + ['/vsimem/vrt_read_32_overlap.tif'])
+    expected_cs = vrt_ds.GetRasterBand(1).Checksum()
+    vrt_ds = None
+    if cs != expected_cs:
+        gdaltest.post_reason('fail')
+        print(cs, expected_cs)
+        ret = 'fail'
+
+    for name in tiles:
+        gdal.Unlink(name)
+    gdal.Unlink('/vsimem/vrt_read_32_overlap.tif')
+
+    return ret
+
+###############################################################################
+# Test reading a VRT with enough sources to use the spatial index of sources
+
+def vrt_read_33():
+
+    src_ds = gdal.Open('data/byte.tif')
+    tiles = []
+    for yoff in range(0, 20, 2):
+        for xoff in range(0, 20, 2):
+            name = '/vsimem/vrt_read_33_%d_%d.tif' % (xoff, yoff)
+            gdal.Translate(name, src_ds, srcWin = [xoff, yoff, 2, 2])
+            tiles.append(name)
+
+    ret = 'success'
+    vrt_ds = gdal.BuildVRT('', tiles)
+    if vrt_ds.GetRasterBand(1).Checksum() != src_ds.GetRasterBand(1).Checksum():
+        gdaltest.post_reason('fail')
+        ret = 'fail'
+    for (xoff, yoff, xsize, ysize) in [(0, 0, 1, 1), (3, 5, 7, 2),
+                                       (19, 19, 1, 1), (1, 1, 18, 18)]:
+        if vrt_ds.ReadRaster(xoff, yoff, xsize, ysize) != \
+           src_ds.ReadRaster(xoff, yoff, xsize, ysize):
+            gdaltest.post_reason('fail')
+            print(xoff, yoff, xsize, ysize)
+            ret = 'fail'
+        if vrt_ds.GetRasterBand(1).ReadRaster(xoff, yoff, xsize, ysize) != \
+           src_ds.GetRasterBand(1).ReadRaster(xoff, yoff, xsize, ysize):
+            gdaltest.post_reason('fail')
+            print(xoff, yoff, xsize, ysize)
+            ret = 'fail'
+    vrt_ds = None
+
+    for name in tiles:
+        gdal.Unlink(name)
+
+    return ret
+
+###############################################################################
+# Test that sources with SourceProperties are only instantiated when accessed
+
+def vrt_read_34():
+
+    gdal.Translate('/vsimem/vrt_read_34.tif', 'data/byte.tif')
+    vrt_xml = """<VRTDataset rasterXSize="40" rasterYSize="20">
+  <VRTRasterBand dataType="Byte" band="1">
+    <SimpleSource>
+      <SourceFilename>/vsimem/vrt_read_34.tif</SourceFilename>
+      <SourceBand>1</SourceBand>
+      <SourceProperties RasterXSize="20" RasterYSize="20" DataType="Byte" BlockXSize="20" BlockYSize="20" />
+      <SrcRect xOff="0" yOff="0" xSize="20" ySize="20" />
+      <DstRect xOff="0" yOff="0" xSize="20" ySize="20" />
+    </SimpleSource>
+    <SimpleSource>
+      <SourceFilename>/vsimem/vrt_read_34_non_existing.tif</SourceFilename>
+      <SourceBand>1</SourceBand>
+      <SourceProperties RasterXSize="20" RasterYSize="20" DataType="Byte" BlockXSize="20" BlockYSize="20" />
+      <SrcRect xOff="0" yOff="0" xSize="20" ySize="20" />
+      <DstRect xOff="20" yOff="0" xSize="20" ySize="20" />
+    </SimpleSource>
+  </VRTRasterBand>
+</VRTDataset>"""
+
+    ret = 'success'
+    ref_ds = gdal.Open('data/byte.tif')
+    ds = gdal.Open(vrt_xml)
+    if ds is None:
+        gdaltest.post_reason('fail')
+        ret = 'fail'
+    elif ds.ReadRaster(0, 0, 20, 20) != ref_ds.ReadRaster(0, 0, 20, 20):
+        gdaltest.post_reason('fail')
+        ret = 'fail'
+    else:
+        with gdaltest.error_handler():
+            data = ds.ReadRaster(10, 0, 20, 20)
+        if data is not None:
+            gdaltest.post_reason('fail')
+            ret = 'fail'
+
+        # Serialization instantiates the sources
+        gdal.GetDriverByName('VRT').CreateCopy('/vsimem/vrt_read_34.vrt', ds)
+        ds = None
+        ds = gdal.Open('/vsimem/vrt_read_34.vrt')
+        if ds.ReadRaster(0, 0, 20, 20) != ref_ds.ReadRaster(0, 0, 20, 20):
+            gdaltest.post_reason('fail')
+            ret = 'fail'
+        ds = None
+    ds = None
+
+    # Checking whether dataset-level I/O can be used does not open the
+    # sources: delete one after open and read a window that avoids it.
+    gdal.Translate('/vsimem/vrt_read_34_2.tif', 'data/byte.tif',
+                   noData=0)
+    vrt_xml = """<VRTDataset rasterXSize="40" rasterYSize="20">
+  <VRTRasterBand dataType="Byte" band="1">
+    <NoDataValue>0</NoDataValue>
+    <SimpleSource>
+      <SourceFilename>/vsimem/vrt_read_34.tif</SourceFilename>
+      <SourceBand>1</SourceBand>
+      <SourceProperties RasterXSize="20" RasterYSize="20" DataType="Byte" BlockXSize="20" BlockYSize="20" />
+      <SrcRect xOff="0" yOff="0" xSize="20" ySize="20" />
+      <DstRect xOff="0" yOff="0" xSize="20" ySize="20" />
+    </SimpleSource>
+    <SimpleSource>
+      <SourceFilename>/vsimem/vrt_read_34_2.tif</SourceFilename>
+      <SourceBand>1</SourceBand>
+      <SourceProperties RasterXSize="20" RasterYSize="20" DataType="Byte" BlockXSize="20" BlockYSize="20" />
+      <SrcRect xOff="0" yOff="0" xSize="20" ySize="20" />
+      <DstRect xOff="20" yOff="0" xSize="20" ySize="20" />
+    </SimpleSource>
+  </VRTRasterBand>
+</VRTDataset>"""
+    gdal.Translate('/vsimem/vrt_read_34.tif', 'data/byte.tif', noData=0)
+    # The resampling kernel must not reach the second source either.
+    ref_ds = gdal.Open('/vsimem/vrt_read_34.tif')
+    ref_data = ref_ds.ReadRaster(0, 0, 16, 20, 8, 10,
+                                 resample_alg=gdal.GRIORA_Bilinear)
+    ref_ds = None
+    ds = gdal.Open(vrt_xml)
+    gdal.Unlink('/vsimem/vrt_read_34_2.tif')
+    gdal.ErrorReset()
+    data = ds.ReadRaster(0, 0, 16, 20, 8, 10,
+                         resample_alg=gdal.GRIORA_Bilinear)
+    if data is None or gdal.GetLastErrorMsg() != '':
+        gdaltest.post_reason('fail')
+        print(gdal.GetLastErrorMsg())
+        ret = 'fail'
+    elif data != ref_data:
+        gdaltest.post_reason('fail')
+        ret = 'fail'
+    with gdaltest.error_handler():
+        data = ds.ReadRaster(20, 0, 20, 20)
+    if data is not None:
+        gdaltest.post_reason('fail')
+        ret = 'fail'
+    ds = None
+
+    gdal.Unlink('/vsimem/vrt_read_34.tif')
+    gdal.Unlink('/vsimem/vrt_read_34.vrt')
+
+    return ret
+
 for item in init_list:
     ut = gdaltest.GDALTest( 'VRT', item[0], item[1], item[2] )
     if ut is None:
@@ -1402,6 +1589,9 @@ gdaltest_list.append( vrt_read_28 )
 gdaltest_list.append( vrt_read_29 )
 gdaltest_list.append( vrt_read_30 )
 gdaltest_list.append( vrt_read_31 )
+gdaltest_list.append( vrt_read_32 )
+gdaltest_list.append( vrt_read_33 )
+gdaltest_list.append( vrt_read_34 )
 
 if __name__ == '__main__':
 
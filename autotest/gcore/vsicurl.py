@@ -458,6 +458,444 @@ def vsicurl_test_fallback_from_head_to_get():
 
     return 'success'
 
+###############################################################################
+
+def vsicurl_test_cache_dir():
+
+    if gdaltest.webserver_port == 0:
+        return 'skip'
+
+    cache_dir = 'tmp/vsicurl_cache_dir'
+    gdal.SetConfigOption('CPL_VSIL_CURL_CACHE_DIR', cache_dir)
+    gdal.VSICurlClearCache()
+
+    filename = '/vsicurl/http://localhost:%d/test_cache_dir/test.bin' % gdaltest.webserver_port
+
+    def read_content():
+        f = gdal.VSIFOpenL(filename, 'rb')
+        if f is None:
+            return None
+        data = gdal.VSIFReadL(1, 3, f).decode('ascii')
+        gdal.VSIFCloseL(f)
+        return data
+
+    ret = 'success'
+    try:
+        handler = webserver.SequentialHandler()
+        handler.add('GET', '/test_cache_dir/', 404)
+        handler.add('HEAD', '/test_cache_dir/test.bin', 200,
+                    { 'Content-Length': '3', 'ETag': '"first"' } )
+        handler.add('GET', '/test_cache_dir/test.bin', 200, {}, 'foo' )
+        with webserver.install_http_handler(handler):
+            data = read_content()
+        if data != 'foo':
+            gdaltest.post_reason('fail')
+            print(data)
+            ret = 'fail'
+
+        # Same ETag: content taken from the cache directory
+        gdal.VSICurlClearCache()
+        handler = webserver.SequentialHandler()
+        handler.add('GET', '/test_cache_dir/', 404)
+        handler.add('HEAD', '/test_cache_dir/test.bin', 200,
+                    { 'Content-Length': '3', 'ETag': '"first"' } )
+        with webserver.install_http_handler(handler):
+            data = read_content()
+        if data != 'foo':
+            gdaltest.post_reason('fail')
+            print(data)
+            ret = 'fail'
+
+        # Modified file
+        gdal.VSICurlClearCache()
+        handler = webserver.SequentialHandler()
+        handler.add('GET', '/test_cache_dir/', 404)
+        handler.add('HEAD', '/test_cache_dir/test.bin', 200,
+                    { 'Content-Length': '3', 'ETag': '"second"' } )
+        handler.add('GET', '/test_cache_dir/test.bin', 200, {}, 'bar' )
+        with webserver.install_http_handler(handler):
+            data = read_content()
+        if data != 'bar':
+            gdaltest.post_reason('fail')
+            print(data)
+            ret = 'fail'
+    finally:
+        gdal.SetConfigOption('CPL_VSIL_CURL_CACHE_DIR', None)
+        gdal.VSICurlClearCache()
+        gdal.RmdirRecursive(cache_dir)
+
+    return ret
+
+###############################################################################
+# Test that the least recently used entries are removed once the cache
+# directory exceeds CPL_VSIL_CURL_CACHE_DIR_SIZE
+
+def vsicurl_test_cache_dir_eviction():
+
+    if gdaltest.webserver_port == 0:
+        return 'skip'
+
+    cache_dir = 'tmp/vsicurl_cache_dir_eviction'
+    gdal.SetConfigOption('CPL_VSIL_CURL_CACHE_DIR', cache_dir)
+    # Room for 2 chunks of 16384 bytes, but not 3
+    gdal.SetConfigOption('CPL_VSIL_CURL_CACHE_DIR_SIZE', '40000')
+    gdal.VSICurlClearCache()
+
+    content = 'x' * 16384
+
+    def count_entries():
+        return len([f for f in gdal.ReadDirRecursive(cache_dir)
+                    if f.endswith('.bin')])
+
+    ret = 'success'
+    try:
+        for i in range(3):
+            handler = webserver.SequentialHandler()
+            # The listing of the directory is cached after the first file
+            if i == 0:
+                handler.add('GET', '/test_cache_dir_eviction/', 404)
+            handler.add('HEAD', '/test_cache_dir_eviction/test%d.bin' % i, 200,
+                        { 'Content-Length': '%d' % len(content),
+                          'ETag': '"%d"' % i } )
+            handler.add('GET', '/test_cache_dir_eviction/test%d.bin' % i, 200,
+                        {}, content )
+            with webserver.install_http_handler(handler):
+                f = gdal.VSIFOpenL('/vsicurl/http://localhost:%d/test_cache_dir_eviction/test%d.bin' % (gdaltest.webserver_port, i), 'rb')
+                data = gdal.VSIFReadL(1, 3, f).decode('ascii')
+                gdal.VSIFCloseL(f)
+            if data != 'xxx':
+                gdaltest.post_reason('fail')
+                print(data)
+                ret = 'fail'
+            if count_entries() != min(i + 1, 2):
+                gdaltest.post_reason('fail')
+                print(i, count_entries())
+                ret = 'fail'
+
+        # The size of the remaining entries is recorded in the directory
+        f = gdal.VSIFOpenL(cache_dir + '/cache_size.txt', 'rb')
+        if f is None:
+            gdaltest.post_reason('fail')
+            ret = 'fail'
+        else:
+            size = int(gdal.VSIFReadL(1, 100, f).decode('ascii'))
+            gdal.VSIFCloseL(f)
+            if size <= 2 * len(content) or size > 40000:
+                gdaltest.post_reason('fail')
+                print(size)
+                ret = 'fail'
+    finally:
+        gdal.SetConfigOption('CPL_VSIL_CURL_CACHE_DIR', None)
+        gdal.SetConfigOption('CPL_VSIL_CURL_CACHE_DIR_SIZE', None)
+        gdal.VSICurlClearCache()
+        gdal.RmdirRecursive(cache_dir)
+
+    return ret
+
+###############################################################################
+# Test that CPL_VSIL_CURL_USE_CACHE=YES now enables a cache directory named
+# gdal_vsicurl_cache in the current directory, instead of the former
+# gdal_vsicurl_cache.bin file
+
+def vsicurl_test_use_cache():
+
+    if gdaltest.webserver_port == 0:
+        return 'skip'
+
+    gdal.SetConfigOption('CPL_VSIL_CURL_USE_CACHE', 'YES')
+    gdal.VSICurlClearCache()
+
+    filename = '/vsicurl/http://localhost:%d/test_use_cache/test.bin' % gdaltest.webserver_port
+
+    ret = 'success'
+    try:
+        handler = webserver.SequentialHandler()
+        handler.add('GET', '/test_use_cache/', 404)
+        handler.add('HEAD', '/test_use_cache/test.bin', 200,
+                    { 'Content-Length': '3', 'ETag': '"first"' } )
+        handler.add('GET', '/test_use_cache/test.bin', 200, {}, 'foo' )
+        with webserver.install_http_handler(handler):
+            f = gdal.VSIFOpenL(filename, 'rb')
+            data = gdal.VSIFReadL(1, 3, f).decode('ascii')
+            gdal.VSIFCloseL(f)
+        if data != 'foo':
+            gdaltest.post_reason('fail')
+            print(data)
+            ret = 'fail'
+        if gdal.VSIStatL('gdal_vsicurl_cache') is None or \
+           gdal.VSIStatL('gdal_vsicurl_cache.bin') is not None:
+            gdaltest.post_reason('fail')
+            ret = 'fail'
+
+        # Taken from the cache directory
+        gdal.VSICurlClearCache()
+        handler = webserver.SequentialHandler()
+        handler.add('GET', '/test_use_cache/', 404)
+        handler.add('HEAD', '/test_use_cache/test.bin', 200,
+                    { 'Content-Length': '3', 'ETag': '"first"' } )
+        with webserver.install_http_handler(handler):
+            f = gdal.VSIFOpenL(filename, 'rb')
+            data = gdal.VSIFReadL(1, 3, f).decode('ascii')
+            gdal.VSIFCloseL(f)
+        if data != 'foo':
+            gdaltest.post_reason('fail')
+            print(data)
+            ret = 'fail'
+    finally:
+        gdal.SetConfigOption('CPL_VSIL_CURL_USE_CACHE', None)
+        gdal.VSICurlClearCache()
+        gdal.RmdirRecursive('gdal_vsicurl_cache')
+
+    return ret
+
+###############################################################################
+def vsicurl_test_read_ahead():
+
+    if gdaltest.webserver_port == 0:
+        return 'skip'
+
+    gdal.VSICurlClearCache()
+
+    chunk_size = 16384
+    content = ''.join([chr(ord('a') + i % 26) for i in range(10 * chunk_size)])
+
+    def add_range(handler, start, end):
+        handler.add('GET', '/test_read_ahead/test.bin', 206,
+                    { 'Content-Range': 'bytes %d-%d/%d' % (start, end, len(content)) },
+                    content[start:end+1],
+                    expected_headers = { 'Range': 'bytes=%d-%d' % (start, end) })
+
+    # The first read gets 2 chunks. Once half of them has been read, the
+    # next 4 chunks are read ahead, and then the rest of the file (the 8
+    # chunk window is truncated at the end of the file).
+    handler = webserver.SequentialHandler()
+    handler.add('GET', '/test_read_ahead/', 404)
+    handler.add('HEAD', '/test_read_ahead/test.bin', 200,
+                { 'Content-Length': '%d' % len(content) } )
+    add_range(handler, 0, 2 * chunk_size - 1)
+    add_range(handler, 2 * chunk_size, 6 * chunk_size - 1)
+    add_range(handler, 6 * chunk_size, 10 * chunk_size - 1)
+    with webserver.install_http_handler(handler):
+        with gdaltest.config_option('CPL_VSIL_CURL_READ_AHEAD', 'YES'):
+            f = gdal.VSIFOpenL('/vsicurl/http://localhost:%d/test_read_ahead/test.bin' % gdaltest.webserver_port, 'rb')
+            if f is None:
+                gdaltest.post_reason('fail')
+                return 'fail'
+            data = ''
+            while True:
+                chunk = gdal.VSIFReadL(1, chunk_size, f).decode('ascii')
+                data += chunk
+                if len(chunk) < chunk_size:
+                    break
+            gdal.VSIFCloseL(f)
+    if data != content:
+        gdaltest.post_reason('fail')
+        print(len(data))
+        return 'fail'
+
+    # Statistics of the file, with VSICurlGetFileStatistics(), which is not
+    # available in the Python bindings.
+    lib = vsicurl_load_libgdal()
+    if lib is not None:
+        import ctypes
+        lib.VSICurlGetFileStatistics.argtypes = [ ctypes.c_char_p ]
+        lib.VSICurlGetFileStatistics.restype = ctypes.POINTER(ctypes.c_char_p)
+        lib.CSLDestroy.argtypes = [ ctypes.POINTER(ctypes.c_char_p) ]
+        filename = '/vsicurl/http://localhost:%d/test_read_ahead/test.bin' % gdaltest.webserver_port
+        stats_list = lib.VSICurlGetFileStatistics(filename.encode('ascii'))
+        stats = {}
+        i = 0
+        while stats_list and stats_list[i] is not None:
+            (key, value) = stats_list[i].decode('ascii').split('=')
+            stats[key] = int(value)
+            i += 1
+        lib.CSLDestroy(stats_list)
+        if stats.get('READ_AHEAD_COUNT') != 2 or \
+           stats.get('BYTES_DOWNLOADED') != len(content) or \
+           stats.get('BYTES_READ_AHEAD') != 8 * chunk_size or \
+           stats.get('CACHE_MISSES', 0) == 0:
+            gdaltest.post_reason('fail')
+            print(stats)
+            return 'fail'
+
+    return 'success'
+
+###############################################################################
+# Load libgdal with ctypes, to call VSIFReadMultiRangeL(), which is not
+# available in the Python bindings.
+
+def vsicurl_load_libgdal():
+
+    try:
+        import ctypes
+    except ImportError:
+        return None
+
+    name = gdaltest.find_lib('gdal')
+    if name is None:
+        return None
+    try:
+        lib = ctypes.cdll.LoadLibrary(name)
+    except OSError:
+        return None
+
+    lib.VSIFOpenL.argtypes = [ ctypes.c_char_p, ctypes.c_char_p ]
+    lib.VSIFOpenL.restype = ctypes.c_void_p
+    lib.VSIFCloseL.argtypes = [ ctypes.c_void_p ]
+    lib.VSIFReadL.argtypes = [ ctypes.c_void_p, ctypes.c_size_t,
+                               ctypes.c_size_t, ctypes.c_void_p ]
+    lib.VSIFReadL.restype = ctypes.c_size_t
+    lib.VSIFSeekL.argtypes = [ ctypes.c_void_p, ctypes.c_ulonglong,
+                               ctypes.c_int ]
+    lib.VSIFReadMultiRangeL.argtypes = [ ctypes.c_int,
+                                         ctypes.POINTER(ctypes.c_void_p),
+                                         ctypes.POINTER(ctypes.c_ulonglong),
+                                         ctypes.POINTER(ctypes.c_size_t),
+                                         ctypes.c_void_p ]
+    return lib
+
+###############################################################################
+# Read (offset, size) ranges of a file served by the webserver with
+# VSIFReadMultiRangeL(), repeated count times, and check their content and the
+# Range headers of the requests, sorted since the requests are sent in
+# parallel.
+
+def vsicurl_check_multi_range(lib, ranges, expected_range_headers,
+                              content, count = 1, chunk_reads = []):
+
+    import ctypes
+
+    gdal.VSICurlClearCache()
+
+    received_range_headers = []
+
+    def method(request):
+        range_header = request.headers['Range']
+        received_range_headers.append(range_header)
+        start, end = [int(x) for x in range_header[len('bytes='):].split('-')]
+        request.send_response(206)
+        request.send_header('Content-Range', 'bytes %d-%d/%d' % (start, end, len(content)))
+        request.send_header('Content-Length', end - start + 1)
+        request.end_headers()
+        request.wfile.write(content[start:end+1].encode('ascii'))
+
+    handler = webserver.SequentialHandler()
+    handler.add('GET', '/test_multi_range/', 404)
+    handler.add('HEAD', '/test_multi_range/test.bin', 200,
+                { 'Content-Length': '%d' % len(content) } )
+    expected_range_headers = expected_range_headers * count
+    for i in range(len(expected_range_headers)):
+        handler.add('GET', '/test_multi_range/test.bin', custom_method = method)
+    with webserver.install_http_handler(handler):
+        filename = '/vsicurl/http://localhost:%d/test_multi_range/test.bin' % gdaltest.webserver_port
+        f = lib.VSIFOpenL(filename.encode('ascii'), b'rb')
+        if f is None:
+            gdaltest.post_reason('fail')
+            return False
+
+        buffers = [ ctypes.create_string_buffer(max(1, size)) for (offset, size) in ranges ]
+        data = (ctypes.c_void_p * len(ranges))(*[ ctypes.cast(buf, ctypes.c_void_p) for buf in buffers ])
+        offsets = (ctypes.c_ulonglong * len(ranges))(*[ offset for (offset, size) in ranges ])
+        sizes = (ctypes.c_size_t * len(ranges))(*[ size for (offset, size) in ranges ])
+        for i in range(count):
+            ret = lib.VSIFReadMultiRangeL(len(ranges), data, offsets, sizes, f)
+            if ret != 0:
+                break
+
+        # Chunks added to the cache by VSIFReadMultiRangeL() are read
+        # without any request.
+        chunk_data = []
+        for (offset, size) in chunk_reads:
+            buf = ctypes.create_string_buffer(size)
+            lib.VSIFSeekL(f, offset, 0)
+            lib.VSIFReadL(buf, 1, size, f)
+            chunk_data.append(buf.raw.decode('ascii'))
+
+        lib.VSIFCloseL(f)
+
+    if ret != 0:
+        gdaltest.post_reason('fail')
+        print(ret)
+        return False
+
+    for i in range(len(ranges)):
+        (offset, size) = ranges[i]
+        if buffers[i].raw[0:size].decode('ascii') != content[offset:offset+size]:
+            gdaltest.post_reason('fail')
+            print(ranges[i])
+            return False
+
+    for i in range(len(chunk_reads)):
+        (offset, size) = chunk_reads[i]
+        if chunk_data[i] != content[offset:offset+size]:
+            gdaltest.post_reason('fail')
+            print(chunk_reads[i])
+            return False
+
+    if sorted(received_range_headers) != sorted(expected_range_headers):
+        gdaltest.post_reason('fail')
+        print(received_range_headers)
+        return False
+
+    return True
+
+###############################################################################
+# Test the requests of VSIFReadMultiRangeL()
+
+def vsicurl_test_read_multi_range():
+
+    if gdaltest.webserver_port == 0:
+        return 'skip'
+
+    lib = vsicurl_load_libgdal()
+    if lib is None:
+        return 'skip'
+
+    chunk_size = 16384
+    content = ''.join([chr(ord('a') + i % 26) for i in range(10 * chunk_size)])
+
+    # Unsorted ranges, too far apart to be merged
+    if not vsicurl_check_multi_range(lib,
+            [ (5 * chunk_size, 100), (0, 100) ],
+            [ 'bytes=0-99', 'bytes=81920-82019' ], content):
+        return 'fail'
+
+    # Overlapping ranges
+    if not vsicurl_check_multi_range(lib,
+            [ (0, 1000), (500, 1000), (600, 10) ],
+            [ 'bytes=0-1499' ], content):
+        return 'fail'
+
+    # Ranges separated by at most the maximum gap are merged
+    with gdaltest.config_option('GDAL_HTTP_MERGE_RANGES_MAX_GAP', '16384'):
+        if not vsicurl_check_multi_range(lib,
+                [ (0, 100), (100 + 16384, 100), (200 + 2 * 16384 + 1, 100) ],
+                [ 'bytes=0-16583', 'bytes=32969-33068' ], content):
+            return 'fail'
+
+    # No merge of consecutive ranges
+    with gdaltest.config_option('GDAL_HTTP_MERGE_CONSECUTIVE_RANGES', 'NO'):
+        if not vsicurl_check_multi_range(lib,
+                [ (0, 100), (100, 100) ],
+                [ 'bytes=0-99', 'bytes=100-199' ], content):
+            return 'fail'
+
+    # A range of size 0 in the middle is skipped (this used to loop forever)
+    if not vsicurl_check_multi_range(lib,
+            [ (0, 100), (200, 0), (300, 100) ],
+            [ 'bytes=0-399' ], content):
+        return 'fail'
+
+    # Chunks downloaded twice replace the cached ones, and are then read
+    # without request
+    if not vsicurl_check_multi_range(lib,
+            [ (0, 2 * chunk_size), (chunk_size, chunk_size) ],
+            [ 'bytes=0-32767' ], content, count = 2,
+            chunk_reads = [ (0, chunk_size), (chunk_size, chunk_size) ]):
+        return 'fail'
+
+    return 'success'
+
 ###############################################################################
 def vsicurl_stop_webserver():
 
@@ -488,6 +926,11 @@ gdaltest_list = [ vsicurl_1,
                   vsicurl_test_clear_cache,
                   vsicurl_test_retry,
                   vsicurl_test_fallback_from_head_to_get,
+                  vsicurl_test_cache_dir,
+                  vsicurl_test_cache_dir_eviction,
+                  vsicurl_test_use_cache,
+                  vsicurl_test_read_ahead,
+                  vsicurl_test_read_multi_range,
                   vsicurl_stop_webserver ]
 
 if __name__ == '__main__':
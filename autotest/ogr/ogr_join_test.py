@@ -549,6 +549,74 @@ def ogr_join_23():
 
     return 'success'
 
+###############################################################################
+# Test that the hash table used for equality joins gives the same results
+# as filtering the secondary table, including when it only caches FIDs
+
+def ogr_join_24():
+
+    ds = ogr.GetDriverByName('Memory').CreateDataSource('')
+    lyr = ds.CreateLayer('first')
+    lyr.CreateField(ogr.FieldDefn('int', ogr.OFTInteger))
+    lyr.CreateField(ogr.FieldDefn('real', ogr.OFTReal))
+    lyr.CreateField(ogr.FieldDefn('str', ogr.OFTString))
+    for (i, r, s) in [ (1, 1.5, 'Key1'), (2, 2, 'key2'), (3, None, 'key3'),
+                       (None, -0.0, None) ]:
+        f = ogr.Feature(lyr.GetLayerDefn())
+        if i is not None:
+            f['int'] = i
+        if r is not None:
+            f['real'] = r
+        if s is not None:
+            f['str'] = s
+        lyr.CreateFeature(f)
+
+    lyr = ds.CreateLayer('second')
+    lyr.CreateField(ogr.FieldDefn('int', ogr.OFTInteger64))
+    lyr.CreateField(ogr.FieldDefn('real', ogr.OFTReal))
+    lyr.CreateField(ogr.FieldDefn('str', ogr.OFTString))
+    lyr.CreateField(ogr.FieldDefn('val', ogr.OFTString))
+    for (i, r, s, v) in [ (2, 2, 'KEY1', 'a'), (1, 0, 'key2', 'b'),
+                          (2, 1.5, 'key1', 'c'), (None, None, None, 'd') ]:
+        f = ogr.Feature(lyr.GetLayerDefn())
+        if i is not None:
+            f['int'] = i
+        if r is not None:
+            f['real'] = r
+        if s is not None:
+            f['str'] = s
+        f['val'] = v
+        lyr.CreateFeature(f)
+
+    tests = [ ('int', 'int', ['b', 'a', None, None]),
+              ('int', 'real', [None, 'a', None, None]),
+              ('real', 'real', ['c', 'a', None, 'b']),
+              ('str', 'str', ['a', 'b', None, None]) ]
+
+    for options in [ {}, {'OGR_SQL_JOIN_HASH': 'YES'},
+                     {'OGR_SQL_JOIN_HASH_MAX_MEMORY': '0'},
+                     {'OGR_SQL_JOIN_HASH': 'NO'} ]:
+        for key in options:
+            gdal.SetConfigOption(key, options[key])
+        for (src_field, join_field, expected) in tests:
+            sql_lyr = ds.ExecuteSQL(
+                'SELECT second.val FROM first LEFT JOIN second ON ' +
+                'first.%s = second.%s' % (src_field, join_field))
+            got = [ f['second.val'] for f in sql_lyr ]
+            ds.ReleaseResultSet(sql_lyr)
+            if got != expected:
+                gdaltest.post_reason('fail')
+                print(options, src_field, join_field, got)
+                for key in options:
+                    gdal.SetConfigOption(key, None)
+                return 'fail'
+        for key in options:
+            gdal.SetConfigOption(key, None)
+
+    ds = None
+
+    return 'success'
+
 ###############################################################################
 
 def ogr_join_cleanup():
@@ -581,6 +649,7 @@ gdaltest_list = [
     ogr_join_21,
     ogr_join_22,
     ogr_join_23,
+    ogr_join_24,
     ogr_join_cleanup ]
 
 if __name__ == '__main__':
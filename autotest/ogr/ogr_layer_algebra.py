@@ -36,6 +36,7 @@ sys.path.append( '../pymod' )
 import gdaltest
 import ogrtest
 
+from osgeo import gdal
 from osgeo import ogr
 
 ###############################################################################
@@ -677,6 +678,71 @@ def algebra_erase():
 
     return 'success'
 
+###############################################################################
+# Test that the overlay methods give the same result, in the same order,
+# when the features are processed in several threads.
+
+def algebra_multithreaded():
+    if not ogrtest.have_geos():
+        return 'skip'
+
+    E = ds.CreateLayer( 'E' )
+    E.CreateField( ogr.FieldDefn("E", ogr.OFTInteger) )
+    F = ds.CreateLayer( 'F' )
+    F.CreateField( ogr.FieldDefn("F", ogr.OFTInteger) )
+    for i in range(100):
+        x = (i % 10) * 1.5
+        y = int(i / 10) * 1.5
+        feat = ogr.Feature( E.GetLayerDefn() )
+        feat.SetField('E', i)
+        feat.SetGeometryDirectly( ogr.CreateGeometryFromWkt(
+            'POLYGON((%f %f,%f %f,%f %f,%f %f,%f %f))' %
+            (x, y, x, y + 1, x + 1, y + 1, x + 1, y, x, y)) )
+        E.CreateFeature( feat )
+        if (i % 3) == 0:
+            feat = ogr.Feature( F.GetLayerDefn() )
+            feat.SetField('F', i)
+            feat.SetGeometryDirectly( ogr.CreateGeometryFromWkt(
+                'POINT(%f %f)' % (x + 0.8, y + 0.8)).Buffer(0.7) )
+            F.CreateFeature( feat )
+    F.SetSpatialFilterRect(1, 1, 12, 9)
+
+    for method in [ 'Intersection', 'Union', 'SymDifference', 'Identity',
+                    'Update', 'Clip', 'Erase' ]:
+        serial = ds.CreateLayer( 'serial' )
+        getattr(E, method)( F, serial )
+        threaded = ds.CreateLayer( 'threaded' )
+        gdal.SetConfigOption('GDAL_NUM_THREADS', '4')
+        err = getattr(E, method)( F, threaded )
+        gdal.SetConfigOption('GDAL_NUM_THREADS', None)
+        if err != 0:
+            gdaltest.post_reason( 'got non-zero result code '+str(err)+' from Layer.'+method )
+            return 'fail'
+        if serial.GetFeatureCount() == 0 or not is_same(serial, threaded):
+            gdaltest.post_reason( 'Layer.'+method+' returned different results in several threads' )
+            return 'fail'
+        # the features of the other layer are fetched by FID
+        fetched = ds.CreateLayer( 'fetched' )
+        gdal.SetConfigOption('GDAL_NUM_THREADS', '4')
+        gdal.SetConfigOption('OGR_LAYER_ALGEBRA_MAX_MEMORY', '0')
+        err = getattr(E, method)( F, fetched )
+        gdal.SetConfigOption('OGR_LAYER_ALGEBRA_MAX_MEMORY', None)
+        gdal.SetConfigOption('GDAL_NUM_THREADS', None)
+        if err != 0:
+            gdaltest.post_reason( 'got non-zero result code '+str(err)+' from Layer.'+method )
+            return 'fail'
+        if not is_same(serial, fetched):
+            gdaltest.post_reason( 'Layer.'+method+' returned different results with features fetched by FID' )
+            return 'fail'
+        ds.DeleteLayer( 'fetched' )
+        ds.DeleteLayer( 'threaded' )
+        ds.DeleteLayer( 'serial' )
+
+    ds.DeleteLayer( 'F' )
+    ds.DeleteLayer( 'E' )
+
+    return 'success'
+
 def algebra_cleanup():
     if not ogrtest.have_geos():
         return 'skip'
@@ -705,6 +771,7 @@ gdaltest_list = [
     algebra_update,
     algebra_clip,
     algebra_erase,
+    algebra_multithreaded,
     algebra_cleanup,
     ]
 
@@ -1542,6 +1542,142 @@ def ogr_sql_48():
 
     return 'success'
 
+###############################################################################
+# Test sorting with an external merge sort, with and without temporary files
+
+def ogr_sql_49():
+
+    ds = ogr.Open('data')
+    sql = 'SELECT * FROM poly ORDER BY prfedea DESC LIMIT 6 OFFSET 2'
+    sql_lyr = ds.ExecuteSQL(sql)
+    expected = [ (f.GetFID(), f['eas_id'], f.GetGeometryRef().ExportToWkt())
+                 for f in sql_lyr ]
+    ds.ReleaseResultSet(sql_lyr)
+    if len(expected) != 6:
+        gdaltest.post_reason('fail')
+        print(expected)
+        return 'fail'
+
+    for max_memory in [ None, '0', '2000' ]:
+        gdal.SetConfigOption('OGR_SQL_EXTERNAL_SORT', 'YES')
+        gdal.SetConfigOption('OGR_SQL_SORT_MAX_MEMORY', max_memory)
+        sql_lyr = ds.ExecuteSQL(sql)
+        got = [ (f.GetFID(), f['eas_id'], f.GetGeometryRef().ExportToWkt())
+                for f in sql_lyr ]
+        sql_lyr.SetNextByIndex(3)
+        f = sql_lyr.GetNextFeature()
+        fid_3 = f.GetFID()
+        ds.ReleaseResultSet(sql_lyr)
+        gdal.SetConfigOption('OGR_SQL_EXTERNAL_SORT', None)
+        gdal.SetConfigOption('OGR_SQL_SORT_MAX_MEMORY', None)
+        if got != expected or fid_3 != expected[3][0]:
+            gdaltest.post_reason('fail')
+            print(max_memory)
+            print(got)
+            print(fid_3)
+            return 'fail'
+
+    return 'success'
+
+
+###############################################################################
+# Test GROUP BY
+
+def ogr_sql_50():
+
+    ds = ogr.GetDriverByName('Memory').CreateDataSource('')
+    lyr = ds.CreateLayer('test')
+    lyr.CreateField(ogr.FieldDefn('cls', ogr.OFTString))
+    lyr.CreateField(ogr.FieldDefn('val', ogr.OFTInteger))
+    for (cls, val) in [ ('b', 1), ('a', 2), ('b', 3), (None, 4), ('a', None),
+                        ('b', 5) ]:
+        f = ogr.Feature(lyr.GetLayerDefn())
+        if cls is not None:
+            f['cls'] = cls
+        if val is not None:
+            f['val'] = val
+        lyr.CreateFeature(f)
+
+    sql_lyr = ds.ExecuteSQL('SELECT cls, COUNT(*), COUNT(val), SUM(val), ' +
+                            'MIN(val), MAX(val) FROM test GROUP BY cls')
+    got = [ (f.GetFID(), f['cls'], f['COUNT_*'], f['COUNT_val'], f['SUM_val'],
+             f['MIN_val'], f['MAX_val']) for f in sql_lyr ]
+    field_type = sql_lyr.GetLayerDefn().GetFieldDefn(1).GetType()
+    ds.ReleaseResultSet(sql_lyr)
+    if got != [ (0, 'b', 3, 3, 9, 1, 5), (1, 'a', 2, 1, 2, 2, 2),
+                (2, None, 1, 1, 4, 4, 4) ] or field_type != ogr.OFTInteger:
+        gdaltest.post_reason('fail')
+        print(got)
+        print(field_type)
+        return 'fail'
+
+    sql_lyr = ds.ExecuteSQL('SELECT cls, AVG(val) FROM test GROUP BY cls ' +
+                            'ORDER BY cls DESC LIMIT 2')
+    got = [ (f['cls'], f['AVG_val']) for f in sql_lyr ]
+    count = sql_lyr.GetFeatureCount()
+    ds.ReleaseResultSet(sql_lyr)
+    if got != [ ('b', 3.0), ('a', 2.0) ] or count != 2:
+        gdaltest.post_reason('fail')
+        print(got)
+        print(count)
+        return 'fail'
+
+    for sql in [ 'SELECT val, COUNT(*) FROM test GROUP BY cls',
+                 'SELECT cls FROM test GROUP BY cls ORDER BY val',
+                 'SELECT COUNT(DISTINCT val) FROM test GROUP BY cls',
+                 'SELECT DISTINCT cls FROM test GROUP BY cls',
+                 'SELECT COUNT(*) FROM test GROUP BY not_existing' ]:
+        gdal.PushErrorHandler('CPLQuietErrorHandler')
+        sql_lyr = ds.ExecuteSQL(sql)
+        gdal.PopErrorHandler()
+        if sql_lyr is not None:
+            gdaltest.post_reason('fail')
+            print(sql)
+            ds.ReleaseResultSet(sql_lyr)
+            return 'fail'
+
+    # Scan in several threads, which gives the same result as in one
+    ds = ogr.GetDriverByName('ESRI Shapefile').CreateDataSource(
+        '/vsimem/ogr_sql_50.dbf')
+    lyr = ds.CreateLayer('ogr_sql_50', geom_type = ogr.wkbNone)
+    lyr.CreateField(ogr.FieldDefn('cls', ogr.OFTString))
+    lyr.CreateField(ogr.FieldDefn('val', ogr.OFTReal))
+    for i in range(30000):
+        f = ogr.Feature(lyr.GetLayerDefn())
+        f['cls'] = '%d' % ((i * 7) % 13)
+        f['val'] = i * 0.5
+        lyr.CreateFeature(f)
+    ds = None
+
+    ds = ogr.Open('/vsimem/ogr_sql_50.dbf')
+    res = []
+    for sql in [ 'SELECT cls, COUNT(*), SUM(val), MIN(val), MAX(val) ' +
+                 'FROM ogr_sql_50 WHERE val > 10 GROUP BY cls',
+                 'SELECT COUNT(*), SUM(val), MIN(val), MAX(val) ' +
+                 'FROM ogr_sql_50 WHERE val > 10' ]:
+        for num_threads in [ None, '4' ]:
+            gdal.SetConfigOption('GDAL_NUM_THREADS', num_threads)
+            sql_lyr = ds.ExecuteSQL(sql)
+            res.append([ f.items() for f in sql_lyr ])
+            ds.ReleaseResultSet(sql_lyr)
+            gdal.SetConfigOption('GDAL_NUM_THREADS', None)
+    ds = None
+    ogr.GetDriverByName('ESRI Shapefile').DeleteDataSource(
+        '/vsimem/ogr_sql_50.dbf')
+
+    if len(res[0]) != 13 or res[0][0] != { 'cls': '4', 'COUNT_*': 2307,
+                                           'SUM_val': 17314035.0,
+                                           'MIN_val': 10.5,
+                                           'MAX_val': 14999.5 } or \
+       res[2] != [ { 'COUNT_*': 29979, 'SUM_val': 224992395.0,
+                     'MIN_val': 10.5, 'MAX_val': 14999.5 } ] or \
+       res[0] != res[1] or res[2] != res[3]:
+        gdaltest.post_reason('fail')
+        print(res)
+        return 'fail'
+
+    return 'success'
+
 
 def ogr_sql_cleanup():
     gdaltest.lyr = None
@@ -1600,6 +1736,8 @@ gdaltest_list = [
     ogr_sql_46,
     ogr_sql_47,
     ogr_sql_48,
+    ogr_sql_49,
+    ogr_sql_50,
     ogr_sql_cleanup ]
 
 if __name__ == '__main__':
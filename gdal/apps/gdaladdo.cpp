@@ -56,6 +56,8 @@ static void Usage( const char* pszErrorMsg = nullptr )
            "\n"
            "Useful configuration variables :\n"
            "  --config USE_RRD YES : Use Erdas Imagine format (.aux) as overview format.\n"
+           "  --config GDAL_NUM_THREADS {number|ALL_CPUS} : Number of threads used for\n"
+           "                                               computation.\n"
            "Below, only for external overviews in GeoTIFF format:\n"
            "  --config COMPRESS_OVERVIEW {JPEG,LZW,PACKBITS,DEFLATE} : TIFF compression\n"
            "  --config PHOTOMETRIC_OVERVIEW {RGB,YCBCR,...} : TIFF photometric interp.\n"
@@ -858,6 +858,31 @@ char *GDALInfo( GDALDatasetH hDataset, const GDALInfoOptions *psOptions )
         double dfMaxStat = 0.0;
         double dfMean = 0.0;
         double dfStdDev = 0.0;
+
+        // Compute the statistics and the default histogram in a single
+        // read of the band when both are requested and not yet available.
+        // Only done for data types for which the default histogram is exact.
+        const GDALDataType eBandType = GDALGetRasterDataType(hBand);
+        if( psOptions->bStats && psOptions->bReportHistograms &&
+            !psOptions->bApproxStats &&
+            (eBandType == GDT_Byte || eBandType == GDT_UInt16 ||
+             eBandType == GDT_Int16) &&
+            GDALGetRasterStatistics( hBand, FALSE, FALSE,
+                                     &dfMinStat, &dfMaxStat,
+                                     &dfMean, &dfStdDev ) == CE_Warning )
+        {
+            GUIntBig *panHistogram = static_cast<GUIntBig *>(
+                VSI_CALLOC_VERBOSE(sizeof(GUIntBig), 256));
+            if( panHistogram != nullptr )
+            {
+                CPL_IGNORE_RET_VAL(GDALComputeRasterStatisticsAndHistogram(
+                    hBand, FALSE, nullptr, nullptr, nullptr, nullptr,
+                    nullptr, nullptr, 256, panHistogram, 0, nullptr, nullptr,
+                    nullptr, nullptr ));
+                CPLFree(panHistogram);
+            }
+        }
+
         CPLErr eErr = GDALGetRasterStatistics( hBand, psOptions->bApproxStats,
                                                psOptions->bStats,
                                                &dfMinStat, &dfMaxStat,
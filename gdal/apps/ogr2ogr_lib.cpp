@@ -1263,6 +1263,9 @@ public:
         virtual ~GDALVectorTranslateWrappedLayer();
         virtual OGRFeatureDefn* GetLayerDefn() override { return m_poFDefn; }
         virtual OGRFeature* GetNextFeature() override;
+        virtual int GetNextFeatureBatch( OGRFeatureBatch *poBatch,
+                                         int nMaxFeatures ) override
+            { return OGRLayer::GetNextFeatureBatch(poBatch, nMaxFeatures); }
         virtual OGRFeature* GetFeature(GIntBig nFID) override;
 
         static GDALVectorTranslateWrappedLayer* New(
@@ -389,6 +389,8 @@ void GDALRegister_BIGGIF()
      poDriver->SetMetadataItem( GDAL_DMD_HELPTOPIC,
                                 "frmt_gif.html" );
      poDriver->SetMetadataItem( GDAL_DMD_EXTENSION, "gif" );
+     poDriver->SetMetadataItem( GDAL_DMD_MAGIC_BYTES,
+                                "474946383761 474946383961" );
      poDriver->SetMetadataItem( GDAL_DMD_MIMETYPE, "image/gif" );
      poDriver->SetMetadataItem( GDAL_DCAP_VIRTUALIO, "YES" );
 
@@ -236,6 +236,27 @@ typedef struct
     int           nCompressedBufferSize;
     bool          bReady;
 } GTiffCompressionJob;
+
+struct GTiffDecompressionJob
+{
+    GTiffDataset *poDS;
+    int           nBlockXOff;
+    int           nBlockYOff;
+    int           nBand;         // 1-based, or 0 for pixel interleaved.
+    int           nBlockId;
+    int           nBlockReqSize;
+
+    vsi_l_offset  nOffset;
+    size_t        nSize;
+    GByte        *pabyRaw;       // Owned by GTiffDataset::MultiThreadedRead().
+
+    // Locked destination blocks: one per band for pixel interleaved
+    // data, in which case the tile/strip is decoded in pabyTmp first.
+    std::vector<GDALRasterBlock*> apoBlocks;
+    GByte        *pabyTmp;
+
+    bool          bSuccess;
+};
 #if !defined(__MINGW32__)
 }
 #endif
@@ -456,6 +477,20 @@ class GTiffDataset final : public GDALPamDataset
     std::vector<GTiffCompressionJob> asCompressionJobs;
     CPLMutex      *hCompressThreadPoolMutex;
     void           InitCompressionThreads( char** papszOptions );
+
+    // Multi-threaded decoding of tiles/strips in read-only mode.
+    int            nDecompressThreads;
+    CPLJobQueue   *poDecompressJobQueue;  // On the global thread pool.
+    std::vector<TIFF*> ahDecompressTIFF;  // Idle per-thread handles.
+    CPLMutex      *hDecompressTIFFMutex;
+    CPLJobQueue   *GetDecompressJobQueue();
+    TIFF*          AcquireDecompressTIFF();
+    void           ReleaseDecompressTIFF( TIFF* hTIFFWorker );
+    static void    ThreadDecompressionFunc( void* pData );
+    void           MultiThreadedRead( int nXOff, int nYOff,
+                                      int nXSize, int nYSize,
+                                      int nBandCount, const int* panBandMap );
+
     void           InitCreationOrOpenOptions( char** papszOptions );
     static void    ThreadCompressionFunc( void* pData );
     void           WaitCompletionForBlock( int nBlockId );
@@ -488,6 +523,13 @@ class GTiffDataset final : public GDALPamDataset
                                  GSpacing nBandSpace,
                                  GDALRasterIOExtraArg* psExtraArg );
 
+    int            TiledDirectIOIntoBuffer(
+                             int nXOff, int nYOff, int nXSize, int nYSize,
+                             void * pData, GDALDataType eBufType,
+                             int nBandCount, int *panBandMap,
+                             GSpacing nPixelSpace, GSpacing nLineSpace,
+                             GSpacing nBandSpace );
+
     GByte          *m_pTempBufferForCommonDirectIO;
     size_t          m_nTempBufferForCommonDirectIOSize;
     template<class FetchBuffer> CPLErr CommonDirectIO(
@@ -1532,6 +1574,15 @@ int GTiffRasterBand::DirectIO( GDALRWFlag eRWFlag,
 
     if( TIFFIsTiled( poGDS->hTIFF ) )
     {
+        if( nXSize == nBufXSize && nYSize == nBufYSize )
+        {
+            const int nRet = poGDS->TiledDirectIOIntoBuffer(
+                nXOff, nYOff, nXSize, nYSize, pData, eBufType,
+                1, &nBand, nPixelSpace, nLineSpace, 0 );
+            if( nRet >= 0 )
+                return nRet;
+        }
+
         if( poGDS->m_pTempBufferForCommonDirectIO == nullptr )
         {
             const int nDTSize = nDTSizeBits / 8;
@@ -2082,6 +2133,391 @@ int GTiffDataset::HasOptimizedReadMultiRange()
     return m_nHasOptimizedReadMultiRange;
 }
 
+/************************************************************************/
+/*                       GetDecompressJobQueue()                        */
+/************************************************************************/
+
+// Return the queue of the decompression jobs, on the global thread pool,
+// or nullptr if the blocks must be decoded serially. This is notably the
+// case when called from a worker thread of the pool, e.g. when the dataset
+// is a source of a VRT read by several threads.
+CPLJobQueue* GTiffDataset::GetDecompressJobQueue()
+{
+    // Overviews and masks use the job queue of the main dataset.
+    if( poBaseDS != nullptr )
+        return poBaseDS->GetDecompressJobQueue();
+
+    if( nDecompressThreads <= 1 )
+        return nullptr;
+    CPLWorkerThreadPool* poThreadPool =
+        GDALGetGlobalThreadPool(nDecompressThreads);
+    if( poThreadPool == nullptr )
+        return nullptr;
+
+    // The global pool is replaced when a larger one is asked for.
+    if( poDecompressJobQueue != nullptr &&
+        poDecompressJobQueue->GetPool() != poThreadPool )
+    {
+        delete poDecompressJobQueue;
+        poDecompressJobQueue = nullptr;
+    }
+    if( poDecompressJobQueue == nullptr )
+    {
+        CPLDebug("GTiff", "Using %d threads for decompression",
+                 nDecompressThreads);
+        poDecompressJobQueue = new (std::nothrow) CPLJobQueue(poThreadPool);
+    }
+    return poDecompressJobQueue;
+}
+
+/************************************************************************/
+/*                        AcquireDecompressTIFF()                       */
+/************************************************************************/
+
+// Return a TIFF handle, positioned on the directory of this dataset, that
+// can be used by a worker thread. libtiff handles cannot be shared between
+// threads, so each concurrent job needs its own one.
+TIFF* GTiffDataset::AcquireDecompressTIFF()
+{
+    {
+        CPLMutexHolderD(&hDecompressTIFFMutex);
+        if( !ahDecompressTIFF.empty() )
+        {
+            TIFF* hTIFFWorker = ahDecompressTIFF.back();
+            ahDecompressTIFF.pop_back();
+            return hTIFFWorker;
+        }
+    }
+
+    VSILFILE* fpWorker = VSIFOpenL(osFilename, "rb");
+    if( fpWorker == nullptr )
+        return nullptr;
+    TIFF* hTIFFWorker = VSI_TIFFOpen(osFilename, "r", fpWorker);
+    if( hTIFFWorker == nullptr )
+    {
+        CPL_IGNORE_RET_VAL(VSIFCloseL(fpWorker));
+        return nullptr;
+    }
+    if( !TIFFSetSubDirectory(hTIFFWorker, nDirOffset) )
+    {
+        XTIFFClose(hTIFFWorker);
+        CPL_IGNORE_RET_VAL(VSIFCloseL(fpWorker));
+        return nullptr;
+    }
+
+    // Same as in SetDirectory().
+    if( nCompression == COMPRESSION_JPEG
+        && nPhotometric == PHOTOMETRIC_YCBCR
+        && CPLTestBool( CPLGetConfigOption("CONVERT_YCBCR_TO_RGB",
+                                              "YES") ) )
+    {
+        TIFFSetField(hTIFFWorker, TIFFTAG_JPEGCOLORMODE, JPEGCOLORMODE_RGB);
+    }
+    return hTIFFWorker;
+}
+
+/************************************************************************/
+/*                        ReleaseDecompressTIFF()                       */
+/************************************************************************/
+
+void GTiffDataset::ReleaseDecompressTIFF( TIFF* hTIFFWorker )
+{
+    CPLMutexHolderD(&hDecompressTIFFMutex);
+    ahDecompressTIFF.push_back(hTIFFWorker);
+}
+
+/************************************************************************/
+/*                       ThreadDecompressionFunc()                      */
+/************************************************************************/
+
+void GTiffDataset::ThreadDecompressionFunc( void* pData )
+{
+    GTiffDecompressionJob* psJob = static_cast<GTiffDecompressionJob *>(pData);
+    GTiffDataset* poDS = psJob->poDS;
+
+    TIFF* hTIFFWorker = poDS->AcquireDecompressTIFF();
+    if( hTIFFWorker == nullptr )
+        return;
+
+    const bool bPixelInterleaved = psJob->apoBlocks.size() > 1;
+    GByte* pabyDst = bPixelInterleaved ?
+        psJob->pabyTmp :
+        static_cast<GByte*>(psJob->apoBlocks[0]->GetDataRef());
+    const int nBlockBufSize = TIFFIsTiled(hTIFFWorker) ?
+        static_cast<int>(TIFFTileSize(hTIFFWorker)) :
+        static_cast<int>(TIFFStripSize(hTIFFWorker));
+    if( psJob->nBlockReqSize < nBlockBufSize )
+        memset( pabyDst, 0, nBlockBufSize );
+
+    // The compressed bytes have already been fetched by the main thread.
+    thandle_t th = TIFFClientdata(hTIFFWorker);
+    void* pRaw = psJob->pabyRaw;
+    VSI_TIFFSetCachedRanges(th, 1, &pRaw, &psJob->nOffset, &psJob->nSize);
+
+    // Errors will be reported by the regular code path, which will be
+    // used to read again blocks that failed here.
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+    const bool bOK = TIFFIsTiled(hTIFFWorker) ?
+        TIFFReadEncodedTile( hTIFFWorker, psJob->nBlockId, pabyDst,
+                             psJob->nBlockReqSize ) != -1 :
+        TIFFReadEncodedStrip( hTIFFWorker, psJob->nBlockId, pabyDst,
+                              psJob->nBlockReqSize ) != -1;
+    CPLPopErrorHandler();
+
+    VSI_TIFFSetCachedRanges(th, 0, nullptr, nullptr, nullptr);
+    poDS->ReleaseDecompressTIFF(hTIFFWorker);
+
+    psJob->bSuccess = bOK || poDS->bIgnoreReadErrors;
+    if( psJob->bSuccess && bPixelInterleaved )
+    {
+        const int nBands = static_cast<int>(psJob->apoBlocks.size());
+        const GDALDataType eDT = psJob->apoBlocks[0]->GetDataType();
+        const int nWordBytes = GDALGetDataTypeSizeBytes(eDT);
+        for( int iBand = 0; iBand < nBands; ++iBand )
+        {
+            GDALCopyWords(pabyDst + iBand * nWordBytes, eDT,
+                          nBands * nWordBytes,
+                          psJob->apoBlocks[iBand]->GetDataRef(),
+                          eDT, nWordBytes,
+                          poDS->nBlockXSize * poDS->nBlockYSize);
+        }
+    }
+}
+
+/************************************************************************/
+/*                         MultiThreadedRead()                          */
+/************************************************************************/
+
+// Decode in parallel, on the worker thread pool, the tiles or strips
+// intersecting the window that are not already in the block cache, and put
+// the result in the block cache. The compressed data is read in a single
+// pass before. The subsequent regular RasterIO() will then only have to
+// copy from cached blocks.
+void GTiffDataset::MultiThreadedRead( int nXOff, int nYOff,
+                                      int nXSize, int nYSize,
+                                      int nBandCount, const int* panBandMap )
+{
+    if( eAccess != GA_ReadOnly ||
+        bStreamingIn ||
+        bTreatAsRGBA ||
+        bTreatAsSplit ||
+        bTreatAsSplitBitmap ||
+        nCompression == COMPRESSION_NONE ||
+        (nBitsPerSample != 8 && nBitsPerSample != 16 &&
+         nBitsPerSample != 32 && nBitsPerSample != 64) ||
+        nBands != nSamplesPerPixel ||
+        (nBands > 1 && nPlanarConfig == PLANARCONFIG_CONTIG &&
+         nBands >= 128) )
+    {
+        return;
+    }
+
+    const int nBlockX1 = nXOff / nBlockXSize;
+    const int nBlockY1 = nYOff / nBlockYSize;
+    const int nBlockX2 = (nXOff + nXSize - 1) / nBlockXSize;
+    const int nBlockY2 = (nYOff + nYSize - 1) / nBlockYSize;
+    if( nBlockX1 == nBlockX2 && nBlockY1 == nBlockY2 )
+        return;
+
+    CPLJobQueue* poJobQueue = GetDecompressJobQueue();
+    if( poJobQueue == nullptr || !SetDirectory() )
+        return;
+
+    const bool bSeparate =
+        nBands == 1 || nPlanarConfig == PLANARCONFIG_SEPARATE;
+    const int nBandsPerBlock = bSeparate ? 1 : nBands;
+    const GDALDataType eDT = GetRasterBand(1)->GetRasterDataType();
+    const GIntBig nBlockBufSize = TIFFIsTiled(hTIFF) ?
+        static_cast<GIntBig>(TIFFTileSize(hTIFF)) :
+        static_cast<GIntBig>(TIFFStripSize(hTIFF));
+    if( nBlockBufSize != static_cast<GIntBig>(nBlockXSize) * nBlockYSize *
+                            GDALGetDataTypeSizeBytes(eDT) * nBandsPerBlock )
+    {
+        return;
+    }
+
+    // Do not lock more blocks than the cache can reasonably hold.
+    const GIntBig nMaxDecodedSize = GDALGetCacheMax64() / 4;
+    const int nBlocksPerRow = DIV_ROUND_UP(nRasterXSize, nBlockXSize);
+
+/* -------------------------------------------------------------------- */
+/*      Collect the blocks to decode.                                   */
+/* -------------------------------------------------------------------- */
+    std::vector<GTiffDecompressionJob> asJobs;
+    GIntBig nDecodedSize = 0;
+    size_t nRawSize = 0;
+    const int nBandIter = bSeparate ? nBandCount : 1;
+    for( int iY = nBlockY1; iY <= nBlockY2; ++iY )
+    {
+        for( int iX = nBlockX1; iX <= nBlockX2; ++iX )
+        {
+            for( int iBandIdx = 0; iBandIdx < nBandIter; ++iBandIdx )
+            {
+                if( nDecodedSize + nBlockBufSize > nMaxDecodedSize )
+                    break;
+
+                // Skip blocks already cached for all requested bands.
+                bool bAllCached = true;
+                for( int i = 0; bAllCached && i < nBandCount; ++i )
+                {
+                    if( bSeparate && i != iBandIdx )
+                        continue;
+                    GDALRasterBlock* poBlock =
+                        cpl::down_cast<GTiffRasterBand *>(
+                            GetRasterBand(panBandMap[i]))
+                                ->TryGetLockedBlockRef(iX, iY);
+                    if( poBlock == nullptr )
+                        bAllCached = false;
+                    else
+                        poBlock->DropLock();
+                }
+                if( bAllCached )
+                    continue;
+
+                const int nBand = bSeparate ? panBandMap[iBandIdx] : 0;
+                int nBlockId = iX + iY * nBlocksPerRow;
+                if( nPlanarConfig == PLANARCONFIG_SEPARATE )
+                    nBlockId += (nBand - 1) * nBlocksPerBand;
+
+                // Missing blocks are left to IReadBlock().
+                vsi_l_offset nOffset = 0;
+                vsi_l_offset nSize = 0;
+                if( !IsBlockAvailable(nBlockId, &nOffset, &nSize) ||
+                    nSize == 0 ||
+                    nSize > static_cast<vsi_l_offset>(nMaxDecodedSize) )
+                {
+                    continue;
+                }
+
+                // The bottom most partial tiles and strips are sometimes
+                // only partially encoded. Same as in IReadBlock().
+                int nBlockReqSize = static_cast<int>(nBlockBufSize);
+                if( iY * nBlockYSize > nRasterYSize - nBlockYSize )
+                {
+                    nBlockReqSize =
+                        static_cast<int>(nBlockBufSize / nBlockYSize)
+                        * (nBlockYSize - static_cast<int>(
+                            (static_cast<GIntBig>(iY + 1) * nBlockYSize)
+                                % nRasterYSize));
+                }
+
+                GTiffDecompressionJob sJob;
+                sJob.poDS = this;
+                sJob.nBlockXOff = iX;
+                sJob.nBlockYOff = iY;
+                sJob.nBand = nBand;
+                sJob.nBlockId = nBlockId;
+                sJob.nBlockReqSize = nBlockReqSize;
+                sJob.nOffset = nOffset;
+                sJob.nSize = static_cast<size_t>(nSize);
+                sJob.pabyRaw = nullptr;
+                sJob.pabyTmp = nullptr;
+                sJob.bSuccess = false;
+                asJobs.push_back(sJob);
+
+                nDecodedSize += nBlockBufSize;
+                nRawSize += static_cast<size_t>(nSize);
+            }
+        }
+    }
+
+    if( asJobs.size() < 2 ||
+        nRawSize > static_cast<size_t>(nMaxDecodedSize) )
+    {
+        return;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Fetch the compressed data of all blocks in one pass.            */
+/* -------------------------------------------------------------------- */
+    GByte* pabyRaw = static_cast<GByte*>(VSI_MALLOC_VERBOSE(nRawSize));
+    if( pabyRaw == nullptr )
+        return;
+
+    std::sort(asJobs.begin(), asJobs.end(),
+              [](const GTiffDecompressionJob& a,
+                 const GTiffDecompressionJob& b)
+              { return a.nOffset < b.nOffset; });
+
+    std::vector<void*> apData;
+    std::vector<vsi_l_offset> anOffsets;
+    std::vector<size_t> anSizes;
+    size_t nAccOffset = 0;
+    for( size_t i = 0; i < asJobs.size(); ++i )
+    {
+        asJobs[i].pabyRaw = pabyRaw + nAccOffset;
+        apData.push_back(asJobs[i].pabyRaw);
+        anOffsets.push_back(asJobs[i].nOffset);
+        anSizes.push_back(asJobs[i].nSize);
+        nAccOffset += asJobs[i].nSize;
+    }
+
+    VSILFILE* fp = VSI_TIFFGetVSILFile(TIFFClientdata(hTIFF));
+    if( VSIFReadMultiRangeL( static_cast<int>(asJobs.size()),
+                             &apData[0], &anOffsets[0], &anSizes[0],
+                             fp ) != 0 )
+    {
+        VSIFree(pabyRaw);
+        return;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Lock the destination blocks in the cache, and decode.           */
+/* -------------------------------------------------------------------- */
+    std::vector<void*> apJobs;
+    for( size_t i = 0; i < asJobs.size(); ++i )
+    {
+        GTiffDecompressionJob& sJob = asJobs[i];
+        const int nFirstBand = bSeparate ? sJob.nBand : 1;
+        const int nLastBand = bSeparate ? sJob.nBand : nBands;
+        for( int iBand = nFirstBand; iBand <= nLastBand; ++iBand )
+        {
+            GDALRasterBlock* poBlock = GetRasterBand(iBand)->
+                GetLockedBlockRef(sJob.nBlockXOff, sJob.nBlockYOff, TRUE);
+            if( poBlock == nullptr )
+                break;
+            sJob.apoBlocks.push_back(poBlock);
+        }
+        if( static_cast<int>(sJob.apoBlocks.size()) !=
+                                            nLastBand - nFirstBand + 1 )
+        {
+            continue;
+        }
+        if( !bSeparate )
+        {
+            sJob.pabyTmp = static_cast<GByte*>(
+                VSI_MALLOC_VERBOSE(static_cast<size_t>(nBlockBufSize)));
+            if( sJob.pabyTmp == nullptr )
+                continue;
+        }
+        apJobs.push_back(&sJob);
+    }
+
+    // If the jobs cannot be submitted, their blocks are evicted below.
+    if( !apJobs.empty() )
+    {
+        poJobQueue->SubmitJobs(ThreadDecompressionFunc, apJobs);
+        poJobQueue->WaitCompletion();
+    }
+
+    // Release the blocks, and evict those that could not be decoded so
+    // that they are read again, with error reporting, by IReadBlock().
+    for( size_t i = 0; i < asJobs.size(); ++i )
+    {
+        GTiffDecompressionJob& sJob = asJobs[i];
+        for( size_t j = 0; j < sJob.apoBlocks.size(); ++j )
+        {
+            GDALRasterBlock* poBlock = sJob.apoBlocks[j];
+            GDALRasterBand* poBand = poBlock->GetBand();
+            poBlock->DropLock();
+            if( !sJob.bSuccess )
+                poBand->FlushBlock(sJob.nBlockXOff, sJob.nBlockYOff, FALSE);
+        }
+        VSIFree(sJob.pabyTmp);
+    }
+    VSIFree(pabyRaw);
+}
+
 /************************************************************************/
 /*                            IRasterIO()                               */
 /************************************************************************/
@@ -2137,6 +2573,12 @@ CPLErr GTiffDataset::IRasterIO( GDALRWFlag eRWFlag,
             return static_cast<CPLErr>(nErr);
     }
 
+    if( eRWFlag == GF_Read )
+    {
+        MultiThreadedRead(nXOff, nYOff, nXSize, nYSize,
+                          nBandCount, panBandMap);
+    }
+
     void* pBufferedData = nullptr;
     if( eAccess == GA_ReadOnly &&
         eRWFlag == GF_Read &&
@@ -2439,6 +2881,161 @@ static inline void CopyContigByteMultiBand(
     }
 }
 
+/************************************************************************/
+/*                      TiledDirectIOIntoBuffer()                       */
+/************************************************************************/
+
+// Reads the tile lines intersecting the window with a single
+// ReadMultiRange() call whose destinations are directly the lines of the
+// caller buffer, thus avoiding both the block cache and any intermediate
+// copy. Only possible when the layout of the buffer is the one of the
+// file for the requested window: no resampling, no data type change, and
+// pixel (and band) spacings matching the interleaving of the tiles.
+// Returns -1 if the request cannot be served that way, in which case the
+// caller must go on with CommonDirectIO().
+
+int GTiffDataset::TiledDirectIOIntoBuffer(
+    int nXOff, int nYOff, int nXSize, int nYSize,
+    void * pData, GDALDataType eBufType,
+    int nBandCount, int *panBandMap,
+    GSpacing nPixelSpace, GSpacing nLineSpace,
+    GSpacing nBandSpace )
+{
+    const GDALDataType eDataType = GetRasterBand(1)->GetRasterDataType();
+    const int nDTSize = GDALGetDataTypeSizeBytes(eDataType);
+    if( eBufType != eDataType )
+        return -1;
+
+    const int nBandsPerBlock =
+        nPlanarConfig == PLANARCONFIG_SEPARATE ? 1 : nBands;
+    const int nBandsPerBlockDTSize = nBandsPerBlock * nDTSize;
+    if( nPixelSpace != nBandsPerBlockDTSize )
+        return -1;
+    if( nBandsPerBlock > 1 )
+    {
+        if( nBandCount != nBands || nBandSpace != nDTSize )
+            return -1;
+        for( int iBand = 0; iBand < nBandCount; ++iBand )
+        {
+            if( panBandMap[iBand] != iBand + 1 )
+                return -1;
+        }
+    }
+    else if( nBandCount != 1 )
+    {
+        return -1;
+    }
+
+    toff_t *panTIFFOffsets = nullptr;
+    if( !TIFFGetField( hTIFF, TIFFTAG_TILEOFFSETS, &panTIFFOffsets ) ||
+        panTIFFOffsets == nullptr )
+    {
+        return -1;
+    }
+
+    const int nBlocksPerRow = DIV_ROUND_UP(nRasterXSize, nBlockXSize);
+    const int nBlockIdBandOffset =
+        nPlanarConfig == PLANARCONFIG_SEPARATE ?
+            nBlocksPerBand * (panBandMap[0] - 1) : 0;
+    const int nBlockXStart = nXOff / nBlockXSize;
+    const int nBlockXEnd = (nXOff + nXSize - 1) / nBlockXSize;
+
+    std::vector<void*> apData;
+    std::vector<vsi_l_offset> anOffsets;
+    std::vector<size_t> anSizes;
+    try
+    {
+        const size_t nMaxRanges = static_cast<size_t>(nYSize) *
+                                  (nBlockXEnd - nBlockXStart + 1);
+        apData.reserve(nMaxRanges);
+        anOffsets.reserve(nMaxRanges);
+        anSizes.reserve(nMaxRanges);
+    }
+    catch( const std::bad_alloc& )
+    {
+        return -1;
+    }
+
+    for( int y = 0; y < nYSize; )
+    {
+        const int nSrcLine = nYOff + y;
+        const int nBlockYOff = nSrcLine / nBlockYSize;
+        const int nYOffsetInBlock = nSrcLine % nBlockYSize;
+        const int nUsedBlockHeight =
+            std::min( nYSize - y, nBlockYSize - nYOffsetInBlock );
+
+        for( int k = 0; k < nUsedBlockHeight; ++k )
+        {
+            GByte* pabyLine =
+                static_cast<GByte *>(pData) + (y + k) * nLineSpace;
+            int x = 0;
+            int nXOffsetInBlock = nXOff % nBlockXSize;
+            for( int nBlockXOff = nBlockXStart; nBlockXOff <= nBlockXEnd;
+                 ++nBlockXOff )
+            {
+                const int nBlockId = nBlockIdBandOffset +
+                                     nBlockXOff + nBlockYOff * nBlocksPerRow;
+                const vsi_l_offset nCurOffset = panTIFFOffsets[nBlockId];
+                // Sparse tiles are dealt with by CommonDirectIO().
+                if( nCurOffset == 0 )
+                    return -1;
+                const int nUsedBlockWidth =
+                    std::min( nBlockXSize - nXOffsetInBlock, nXSize - x );
+
+                GByte* pabyDst = pabyLine + x * nPixelSpace;
+                const vsi_l_offset nOffset = nCurOffset +
+                    (static_cast<vsi_l_offset>(nYOffsetInBlock + k) *
+                        nBlockXSize + nXOffsetInBlock) * nBandsPerBlockDTSize;
+                const size_t nSize =
+                    static_cast<size_t>(nUsedBlockWidth) * nBandsPerBlockDTSize;
+
+                // Merge with the previous range when contiguous both in
+                // the file and in the buffer (full width windows).
+                if( !anOffsets.empty() &&
+                    anOffsets.back() + anSizes.back() == nOffset &&
+                    static_cast<GByte*>(apData.back()) + anSizes.back() ==
+                        pabyDst )
+                {
+                    anSizes.back() += nSize;
+                }
+                else
+                {
+                    apData.push_back(pabyDst);
+                    anOffsets.push_back(nOffset);
+                    anSizes.push_back(nSize);
+                }
+
+                nXOffsetInBlock = 0;
+                x += nUsedBlockWidth;
+            }
+        }
+
+        y += nUsedBlockHeight;
+    }
+
+    VSILFILE* fp = VSI_TIFFGetVSILFile(TIFFClientdata( hTIFF ));
+    if( VSIFReadMultiRangeL( static_cast<int>(apData.size()), &apData[0],
+                             &anOffsets[0], &anSizes[0], fp ) != 0 )
+    {
+        CPLError(CE_Failure, CPLE_FileIO, "Cannot read tile data");
+        return CE_Failure;
+    }
+
+    if( TIFFIsByteSwapped(hTIFF) )
+    {
+        const bool bIsComplex = CPL_TO_BOOL(GDALDataTypeIsComplex(eDataType));
+        const int nWordSize = bIsComplex ? nDTSize / 2 : nDTSize;
+        for( size_t i = 0; i < apData.size(); ++i )
+        {
+            GDALSwapWords( apData[i], nWordSize,
+                           static_cast<int>(anSizes[i] / nWordSize),
+                           nWordSize );
+        }
+    }
+
+    return CE_None;
+}
+
 /************************************************************************/
 /*                         CommonDirectIO()                             */
 /************************************************************************/
@@ -3764,6 +4361,15 @@ int GTiffDataset::DirectIO( GDALRWFlag eRWFlag,
 
     if( TIFFIsTiled( hTIFF ) )
     {
+        if( nXSize == nBufXSize && nYSize == nBufYSize )
+        {
+            const int nRet = TiledDirectIOIntoBuffer(
+                nXOff, nYOff, nXSize, nYSize, pData, eBufType,
+                nBandCount, panBandMap, nPixelSpace, nLineSpace, nBandSpace );
+            if( nRet >= 0 )
+                return nRet;
+        }
+
         if( m_pTempBufferForCommonDirectIO == nullptr )
         {
             const int nDTSize = nDTSizeBits / 8;
@@ -4151,6 +4757,11 @@ CPLErr GTiffRasterBand::IRasterIO( GDALRWFlag eRWFlag,
             return static_cast<CPLErr>(nErr);
     }
 
+    if( eRWFlag == GF_Read )
+    {
+        poGDS->MultiThreadedRead(nXOff, nYOff, nXSize, nYSize, 1, &nBand);
+    }
+
     void* pBufferedData = nullptr;
     if( poGDS->eAccess == GA_ReadOnly &&
         eRWFlag == GF_Read &&
@@ -7326,6 +7937,9 @@ GTiffDataset::GTiffDataset() :
     bHasDiscardedLsb(false),
     poCompressThreadPool(nullptr),
     hCompressThreadPoolMutex(nullptr),
+    nDecompressThreads(0),
+    poDecompressJobQueue(nullptr),
+    hDecompressTIFFMutex(nullptr),
     m_pTempBufferForCommonDirectIO(nullptr),
     m_nTempBufferForCommonDirectIOSize(0),
     m_bReadGeoTransform(false),
@@ -7450,8 +8064,23 @@ int GTiffDataset::Finalize()
                 CPLFree(asCompressionJobs[i].pszTmpFilename);
             }
         }
-        CPLDestroyMutex(hCompressThreadPoolMutex);
+        if( hCompressThreadPoolMutex )
+            CPLDestroyMutex(hCompressThreadPoolMutex);
+    }
+
+    delete poDecompressJobQueue;
+    poDecompressJobQueue = nullptr;
+    for( size_t i = 0; i < ahDecompressTIFF.size(); ++i )
+    {
+        VSILFILE* fpWorker =
+            VSI_TIFFGetVSILFile(TIFFClientdata(ahDecompressTIFF[i]));
+        XTIFFClose(ahDecompressTIFF[i]);
+        CPL_IGNORE_RET_VAL(VSIFCloseL(fpWorker));
     }
+    ahDecompressTIFF.clear();
+    if( hDecompressTIFFMutex )
+        CPLDestroyMutex(hDecompressTIFFMutex);
+    hDecompressTIFFMutex = nullptr;
 
 /* -------------------------------------------------------------------- */
 /*      If there is still changed metadata, then presumably we want     */
@@ -8409,6 +9038,41 @@ bool GTiffDataset::WriteEncodedStrip( uint32 strip, GByte* pabyData,
     return bRet;
 }
 
+/************************************************************************/
+/*                        GTiffAcquireThreadPool()                      */
+/************************************************************************/
+
+// Return a thread pool with the specified number of threads, reusing the
+// one released by a previously closed dataset if possible.
+static CPLWorkerThreadPool* GTiffAcquireThreadPool( int nThreads )
+{
+    CPLWorkerThreadPool* poThreadPool = nullptr;
+    {
+        std::lock_guard<std::mutex> oLock(gMutexThreadPool);
+        if( gpoCompressThreadPool &&
+            gpoCompressThreadPool->GetThreadCount() == nThreads )
+        {
+            poThreadPool = gpoCompressThreadPool;
+        }
+        else
+        {
+            delete gpoCompressThreadPool;
+        }
+        gpoCompressThreadPool = nullptr;
+    }
+
+    if( poThreadPool == nullptr )
+    {
+        poThreadPool = new CPLWorkerThreadPool();
+        if( !poThreadPool->Setup(nThreads, nullptr, nullptr) )
+        {
+            delete poThreadPool;
+            poThreadPool = nullptr;
+        }
+    }
+    return poThreadPool;
+}
+
 /************************************************************************/
 /*                        InitCompressionThreads()                      */
 /************************************************************************/
@@ -8428,8 +9092,22 @@ void GTiffDataset::InitCompressionThreads( char** papszOptions )
             EQUAL(pszValue, "ALL_CPUS") ? CPLGetNumCPUs() : atoi(pszValue);
         if( nThreads > 1 )
         {
-            if( nCompression == COMPRESSION_NONE ||
-                nCompression == COMPRESSION_JPEG )
+            if( eAccess == GA_ReadOnly )
+            {
+                // The blocks are decoded on the global thread pool,
+                // created on the first read that can benefit from it.
+                if( nCompression == COMPRESSION_NONE )
+                {
+                    CPLDebug( "GTiff",
+                              "NUM_THREADS ignored with uncompressed" );
+                }
+                else
+                {
+                    nDecompressThreads = nThreads;
+                }
+            }
+            else if( nCompression == COMPRESSION_NONE ||
+                     nCompression == COMPRESSION_JPEG )
             {
                 CPLDebug( "GTiff",
                           "NUM_THREADS ignored with uncompressed or JPEG" );
@@ -8438,30 +9116,7 @@ void GTiffDataset::InitCompressionThreads( char** papszOptions )
             {
                 CPLDebug("GTiff", "Using %d threads for compression", nThreads);
 
-                // Try to reuse previously created thread pool
-                {
-                    std::lock_guard<std::mutex> oLock(gMutexThreadPool);
-                    if( gpoCompressThreadPool &&
-                        gpoCompressThreadPool->GetThreadCount() == nThreads )
-                    {
-                        poCompressThreadPool = gpoCompressThreadPool;
-                    }
-                    else
-                    {
-                        delete gpoCompressThreadPool;
-                    }
-                    gpoCompressThreadPool = nullptr;
-                }
-
-                if( poCompressThreadPool == nullptr )
-                {
-                    poCompressThreadPool = new CPLWorkerThreadPool();
-                    if( !poCompressThreadPool->Setup(nThreads, nullptr, nullptr) )
-                    {
-                        delete poCompressThreadPool;
-                        poCompressThreadPool = nullptr;
-                    }
-                }
+                poCompressThreadPool = GTiffAcquireThreadPool(nThreads);
                 if( poCompressThreadPool != nullptr )
                 {
                     // Add a margin of an extra job w.r.t thread number
@@ -12343,6 +12998,10 @@ GDALDataset *GTiffDataset::Open( GDALOpenInfo * poOpenInfo )
     {
         poDS->InitCreationOrOpenOptions(poOpenInfo->papszOpenOptions);
     }
+    else
+    {
+        poDS->InitCompressionThreads(poOpenInfo->papszOpenOptions);
+    }
 
     poDS->m_bLoadPam = true;
     poDS->bColorProfileMetadataChanged = false;
@@ -18658,23 +19317,18 @@ int GTIFFGetCompressionMethod(const char* pszValue, const char* pszVariableName)
 }
 
 /************************************************************************/
-/*                          GDALRegister_GTiff()                        */
+/*                  GTiffDriverInitDeferredMetadata()                   */
 /************************************************************************/
 
-void GDALRegister_GTiff()
+static void GTiffDriverInitDeferredMetadata( GDALDriver* poDriver )
 
 {
-    if( GDALGetDriverByName( "GTiff" ) != nullptr )
-        return;
-
     CPLString osOptions;
     CPLString osCompressValues;
     bool bHasJPEG = false;
     bool bHasLZMA = false;
     bool bHasZSTD = false;
 
-    GDALDriver *poDriver = new GDALDriver();
-
 /* -------------------------------------------------------------------- */
 /*      Determine which compression codecs are available that we        */
 /*      want to advertise.  If we are using an old libtiff we won't     */
@@ -18855,6 +19509,31 @@ void GDALRegister_GTiff()
 "   </Option>"
 "</CreationOptionList>";
 
+    poDriver->SetMetadataItem( GDAL_DMD_CREATIONOPTIONLIST, osOptions );
+    poDriver->SetMetadataItem( GDAL_DMD_OPENOPTIONLIST,
+"<OpenOptionList>"
+"   <Option name='NUM_THREADS' type='string' description='Number of worker threads for compression, or decompression in read-only mode. Can be set to ALL_CPUS' default='1'/>"
+"   <Option name='GEOTIFF_KEYS_FLAVOR' type='string-select' default='STANDARD' description='Which flavor of GeoTIFF keys must be used (for writing)'>"
+"       <Value>STANDARD</Value>"
+"       <Value>ESRI_PE</Value>"
+"   </Option>"
+"   <Option name='GEOREF_SOURCES' type='string' description='Comma separated list made with values INTERNAL/TABFILE/WORLDFILE/PAM/NONE that describe the priority order for georeferencing' default='PAM,INTERNAL,TABFILE,WORLDFILE'/>"
+"   <Option name='SPARSE_OK' type='boolean' description='Should empty blocks be omitted on disk?' default='FALSE'/>"
+"</OpenOptionList>" );
+}
+
+/************************************************************************/
+/*                          GDALRegister_GTiff()                        */
+/************************************************************************/
+
+void GDALRegister_GTiff()
+
+{
+    if( GDALGetDriverByName( "GTiff" ) != nullptr )
+        return;
+
+    GDALDriver *poDriver = new GDALDriver();
+
 /* -------------------------------------------------------------------- */
 /*      Set the driver details.                                         */
 /* -------------------------------------------------------------------- */
@@ -18865,20 +19544,11 @@ void GDALRegister_GTiff()
     poDriver->SetMetadataItem( GDAL_DMD_MIMETYPE, "image/tiff" );
     poDriver->SetMetadataItem( GDAL_DMD_EXTENSION, "tif" );
     poDriver->SetMetadataItem( GDAL_DMD_EXTENSIONS, "tif tiff" );
+    poDriver->SetMetadataItem( GDAL_DMD_MAGIC_BYTES,
+                               "49492A00 4D4D002A 49492B00 4D4D002B" );
     poDriver->SetMetadataItem( GDAL_DMD_CREATIONDATATYPES,
                                "Byte UInt16 Int16 UInt32 Int32 Float32 "
                                "Float64 CInt16 CInt32 CFloat32 CFloat64" );
-    poDriver->SetMetadataItem( GDAL_DMD_CREATIONOPTIONLIST, osOptions );
-    poDriver->SetMetadataItem( GDAL_DMD_OPENOPTIONLIST,
-"<OpenOptionList>"
-"   <Option name='NUM_THREADS' type='string' description='Number of worker threads for compression. Can be set to ALL_CPUS' default='1'/>"
-"   <Option name='GEOTIFF_KEYS_FLAVOR' type='string-select' default='STANDARD' description='Which flavor of GeoTIFF keys must be used (for writing)'>"
-"       <Value>STANDARD</Value>"
-"       <Value>ESRI_PE</Value>"
-"   </Option>"
-"   <Option name='GEOREF_SOURCES' type='string' description='Comma separated list made with values INTERNAL/TABFILE/WORLDFILE/PAM/NONE that describe the priority order for georeferencing' default='PAM,INTERNAL,TABFILE,WORLDFILE'/>"
-"   <Option name='SPARSE_OK' type='boolean' description='Should empty blocks be omitted on disk?' default='FALSE'/>"
-"</OpenOptionList>" );
     poDriver->SetMetadataItem( GDAL_DMD_SUBDATASETS, "YES" );
     poDriver->SetMetadataItem( GDAL_DCAP_VIRTUALIO, "YES" );
 
@@ -18893,6 +19563,7 @@ void GDALRegister_GTiff()
     poDriver->pfnCreateCopy = GTiffDataset::CreateCopy;
     poDriver->pfnUnloadDriver = GDALDeregister_GTiff;
     poDriver->pfnIdentify = GTiffDataset::Identify;
+    poDriver->pfnInitDeferredMetadata = GTiffDriverInitDeferredMetadata;
 
     GetGDALDriverManager()->RegisterDriver( poDriver );
 }
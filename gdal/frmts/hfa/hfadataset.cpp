@@ -5982,6 +5982,8 @@ void GDALRegister_HFA()
     poDriver->SetMetadataItem(GDAL_DMD_LONGNAME, "Erdas Imagine Images (.img)");
     poDriver->SetMetadataItem(GDAL_DMD_HELPTOPIC, "frmt_hfa.html");
     poDriver->SetMetadataItem(GDAL_DMD_EXTENSION, "img");
+    poDriver->SetMetadataItem(GDAL_DMD_MAGIC_BYTES,
+                              "454846415F4845414445525F544147");
     poDriver->SetMetadataItem(GDAL_DMD_CREATIONDATATYPES,
                               "Byte Int16 UInt16 Int32 UInt32 Float32 Float64 "
                               "CFloat32 CFloat64");
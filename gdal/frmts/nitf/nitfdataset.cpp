@@ -6044,12 +6044,13 @@ static const char * const apszFieldsBLOCKA[] = {
         "FRFC_LOC",       "97", "21",
         nullptr,             nullptr, nullptr };
 
-void GDALRegister_NITF()
+/************************************************************************/
+/*                   NITFDriverInitDeferredMetadata()                   */
+/************************************************************************/
 
-{
-    if( GDALGetDriverByName( "NITF" ) != nullptr )
-        return;
+static void NITFDriverInitDeferredMetadata( GDALDriver* poDriver )
 
+{
     CPLString osCreationOptions =
 "<CreationOptionList>"
 "   <Option name='IC' type='string-select' default='NC' description='Compression mode. NC=no compression. "
@@ -6128,6 +6129,19 @@ void GDALRegister_NITF()
 "   <Option name='USE_SRC_NITF_METADATA' type='boolean' description='Whether to use NITF source metadata in NITF-to-NITF conversions' default='YES'/>";
     osCreationOptions += "</CreationOptionList>";
 
+    poDriver->SetMetadataItem( GDAL_DMD_CREATIONOPTIONLIST, osCreationOptions);
+}
+
+/************************************************************************/
+/*                          GDALRegister_NITF()                         */
+/************************************************************************/
+
+void GDALRegister_NITF()
+
+{
+    if( GDALGetDriverByName( "NITF" ) != nullptr )
+        return;
+
     GDALDriver *poDriver = new GDALDriver();
 
     poDriver->SetDescription( "NITF" );
@@ -6137,17 +6151,17 @@ void GDALRegister_NITF()
 
     poDriver->SetMetadataItem( GDAL_DMD_HELPTOPIC, "frmt_nitf.html" );
     poDriver->SetMetadataItem( GDAL_DMD_EXTENSION, "ntf" );
+    poDriver->SetMetadataItem( GDAL_DMD_MAGIC_BYTES, "4E495446 4E534946" );
     poDriver->SetMetadataItem( GDAL_DMD_SUBDATASETS, "YES" );
     poDriver->SetMetadataItem( GDAL_DMD_CREATIONDATATYPES,
                                "Byte UInt16 Int16 UInt32 Int32 Float32" );
-
-    poDriver->SetMetadataItem( GDAL_DMD_CREATIONOPTIONLIST, osCreationOptions);
     poDriver->SetMetadataItem( GDAL_DCAP_VIRTUALIO, "YES" );
 
     poDriver->pfnIdentify = NITFDataset::Identify;
     poDriver->pfnOpen = NITFDataset::Open;
     poDriver->pfnCreate = NITFDataset::NITFDatasetCreate;
     poDriver->pfnCreateCopy = NITFDataset::NITFCreateCopy;
+    poDriver->pfnInitDeferredMetadata = NITFDriverInitDeferredMetadata;
 
     GetGDALDriverManager()->RegisterDriver( poDriver );
 }
@@ -6920,6 +6920,7 @@ void GDALRegister_PDF()
     poDriver->SetMetadataItem( GDAL_DMD_LONGNAME, "Geospatial PDF" );
     poDriver->SetMetadataItem( GDAL_DMD_HELPTOPIC, "frmt_pdf.html" );
     poDriver->SetMetadataItem( GDAL_DMD_EXTENSION, "pdf" );
+    poDriver->SetMetadataItem( GDAL_DMD_MAGIC_BYTES, "25504446" );
     poDriver->SetMetadataItem( GDAL_DMD_CREATIONDATATYPES, "Byte" );
 
 #if defined(HAVE_POPPLER) || defined(HAVE_PDFIUM)
@@ -2073,6 +2073,7 @@ void GDALRegister_PNG()
     poDriver->SetMetadataItem( GDAL_DMD_HELPTOPIC,
                                "frmt_various.html#PNG" );
     poDriver->SetMetadataItem( GDAL_DMD_EXTENSION, "png" );
+    poDriver->SetMetadataItem( GDAL_DMD_MAGIC_BYTES, "89504E470D0A1A0A" );
     poDriver->SetMetadataItem( GDAL_DMD_MIMETYPE, "image/png" );
 
     poDriver->SetMetadataItem( GDAL_DMD_CREATIONDATATYPES,
@@ -56,7 +56,8 @@ VRTDataset::VRTDataset( int nXSize, int nYSize ) :
     m_pszVRTPath(nullptr),
     m_poMaskBand(nullptr),
     m_bCompatibleForDatasetIO(-1),
-    m_papszXMLVRTMetadata(nullptr)
+    m_papszXMLVRTMetadata(nullptr),
+    m_nThreads(-1)
 {
     nRasterXSize = nXSize;
     nRasterYSize = nYSize;
@@ -118,6 +119,24 @@ VRTDataset::~VRTDataset()
     CSLDestroy( m_papszXMLVRTMetadata );
 }
 
+/************************************************************************/
+/*                           GetThreadPool()                            */
+/************************************************************************/
+
+// Return the worker thread pool used to read sources concurrently, if the
+// VRT_NUM_THREADS configuration option asks for more than one thread, or
+// nullptr.
+CPLWorkerThreadPool* VRTDataset::GetThreadPool()
+{
+    if( m_nThreads < 0 )
+    {
+        m_nThreads = GDALGetNumThreads("VRT_NUM_THREADS");
+        if( m_nThreads > 1 )
+            CPLDebug("VRT", "Using %d threads to read sources", m_nThreads);
+    }
+    return GDALGetGlobalThreadPool(m_nThreads);
+}
+
 /************************************************************************/
 /*                             FlushCache()                             */
 /************************************************************************/
@@ -1289,14 +1308,8 @@ int VRTDataset::CheckCompatibleForDatasetIO()
                 if( !EQUAL(poSource->GetType(), "SimpleSource") )
                     return FALSE;
 
-                GDALRasterBand *srcband = poSource->GetBand();
-                if( srcband == nullptr )
-                    return FALSE;
-                if( srcband->GetDataset() == nullptr )
-                    return FALSE;
-                if( srcband->GetDataset()->GetRasterCount() <= iBand )
-                    return FALSE;
-                if( srcband->GetDataset()->GetRasterBand(iBand + 1) != srcband )
+                // Do not instantiate deferred sources.
+                if( !poSource->IsSrcDatasetBand(iBand + 1) )
                     return FALSE;
                 osResampling = poSource->GetResampling();
             }
@@ -1322,14 +1335,8 @@ int VRTDataset::CheckCompatibleForDatasetIO()
                 if( !poSource->IsSameExceptBandNumber(poRefSource) )
                     return FALSE;
 
-                GDALRasterBand *srcband = poSource->GetBand();
-                if( srcband == nullptr )
-                    return FALSE;
-                if( srcband->GetDataset() == nullptr )
-                    return FALSE;
-                if( srcband->GetDataset()->GetRasterCount() <= iBand )
-                    return FALSE;
-                if( srcband->GetDataset()->GetRasterBand(iBand + 1) != srcband )
+                // Do not instantiate deferred sources.
+                if( !poSource->IsSrcDatasetBand(iBand + 1) )
                     return FALSE;
                 if( osResampling.compare(poSource->GetResampling()) != 0 )
                     return FALSE;
@@ -1527,14 +1534,26 @@ CPLErr VRTDataset::IRasterIO( GDALRWFlag eRWFlag,
             const double dfNoDataValue = poBand->GetNoDataValue(&bHasNoData);
             if( bHasNoData )
             {
-                for( int i = 0; i < poBand->nSources; i++ )
+                // Only the sources that are read matter: do not open the
+                // others.
+                std::vector<int> anSources;
+                poBand->GetSourcesIntersectingWindow( nXOff, nYOff,
+                                                      nXSize, nYSize,
+                                                      anSources );
+                for( size_t i = 0; i < anSources.size(); i++ )
                 {
                     VRTSimpleSource* poSource
                         = reinterpret_cast<VRTSimpleSource *>(
-                            poBand->papoSources[i] );
+                            poBand->papoSources[anSources[i]] );
+                    GDALRasterBand* poSrcBand = poSource->GetBand();
+                    if( poSrcBand == nullptr )
+                    {
+                        bLocalCompatibleForDatasetIO = false;
+                        break;
+                    }
                     int bSrcHasNoData = FALSE;
                     const double dfSrcNoData
-                        = poSource->GetBand()->GetNoDataValue(&bSrcHasNoData);
+                        = poSrcBand->GetNoDataValue(&bSrcHasNoData);
                     if( !bSrcHasNoData || dfSrcNoData != dfNoDataValue )
                     {
                         bLocalCompatibleForDatasetIO = false;
@@ -1579,20 +1598,24 @@ CPLErr VRTDataset::IRasterIO( GDALRWFlag eRWFlag,
         // they don't necessary instantiate all underlying rasterbands.
         VRTSourcedRasterBand* poBand = reinterpret_cast<VRTSourcedRasterBand *>(
             papoBands[nBands - 1] );
-        for( int iSource = 0;
-             eErr == CE_None && iSource < poBand->nSources;
-             iSource++ )
+        std::vector<int> anSources;
+        poBand->GetSourcesIntersectingWindow( nXOff, nYOff, nXSize, nYSize,
+                                              anSources );
+        const int nCandidateSources = static_cast<int>(anSources.size());
+        for( int iCandidate = 0;
+             eErr == CE_None && iCandidate < nCandidateSources;
+             iCandidate++ )
         {
             psExtraArg->pfnProgress = GDALScaledProgress;
             psExtraArg->pProgressData =
                 GDALCreateScaledProgress(
-                    1.0 * iSource / poBand->nSources,
-                    1.0 * (iSource + 1) / poBand->nSources,
+                    1.0 * iCandidate / nCandidateSources,
+                    1.0 * (iCandidate + 1) / nCandidateSources,
                     pfnProgressGlobal,
                     pProgressDataGlobal );
 
             VRTSimpleSource* poSource = reinterpret_cast<VRTSimpleSource *>(
-                poBand->papoSources[iSource] );
+                poBand->papoSources[anSources[iCandidate]] );
 
             eErr = poSource->DatasetRasterIO( poBand->GetRasterDataType(),
                                               nXOff, nYOff, nXSize, nYSize,
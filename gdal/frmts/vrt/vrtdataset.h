@@ -34,6 +34,7 @@
 #ifndef DOXYGEN_SKIP
 
 #include "cpl_hash_set.h"
+#include "cpl_quad_tree.h"
 #include "gdal_pam.h"
 #include "gdal_priv.h"
 #include "gdal_rat.h"
@@ -130,6 +131,7 @@ VRTSource *VRTParseFilterSources( CPLXMLNode *psTree, const char *, void* pUniqu
 /************************************************************************/
 
 class VRTRasterBand;
+class CPLWorkerThreadPool;
 
 class CPL_DLL VRTDataset : public GDALDataset
 {
@@ -157,6 +159,8 @@ class CPL_DLL VRTDataset : public GDALDataset
     std::vector<GDALDataset*> m_apoOverviewsBak;
     char         **m_papszXMLVRTMetadata;
 
+    int            m_nThreads; // -1 = not yet determined
+
     VRTRasterBand*      InitBand(const char* pszSubclass, int nBand,
                                  bool bAllowPansharpened);
 
@@ -225,6 +229,8 @@ class CPL_DLL VRTDataset : public GDALDataset
 
     void                UnsetPreservedRelativeFilenames();
 
+    CPLWorkerThreadPool* GetThreadPool();
+
     static int          Identify( GDALOpenInfo * );
     static GDALDataset *Open( GDALOpenInfo * );
     static GDALDataset *OpenXML( const char *, const char * = nullptr,
@@ -500,8 +506,23 @@ class CPL_DLL VRTSourcedRasterBand : public VRTRasterBand
     CPLString      m_osLastLocationInfo;
     char         **m_papszSourceList;
 
+    // Spatial index of the destination windows of the sources, built on
+    // first use for bands with many sources.
+    CPLQuadTree   *m_hSourcesIndex;
+    int            m_nSourcesInIndex;
+    std::vector<int> m_anSourcesNotInIndex;
+
     bool           CanUseSourcesMinMaxImplementations();
     void           CheckSource( VRTSimpleSource *poSS );
+    void           BuildSourcesIndex();
+    void           InvalidateSourcesIndex();
+    int            MultiThreadedSourcesRasterIO(
+                                const std::vector<int>& anSources,
+                                int nXOff, int nYOff, int nXSize, int nYSize,
+                                void *pData, int nBufXSize, int nBufYSize,
+                                GDALDataType eBufType,
+                                GSpacing nPixelSpace, GSpacing nLineSpace,
+                                GDALRasterIOExtraArg* psExtraArg );
 
   public:
     int            nSources;
@@ -553,6 +574,10 @@ class CPL_DLL VRTSourcedRasterBand : public VRTRasterBand
                                   GDALProgressFunc pfnProgress,
                                   void *pProgressData ) override;
 
+    void           GetSourcesIntersectingWindow( int nXOff, int nYOff,
+                                                 int nXSize, int nYSize,
+                                                 std::vector<int>& anSources );
+
     CPLErr         AddSource( VRTSource * );
     CPLErr         AddSimpleSource( GDALRasterBand *poSrcBand,
                                     double dfSrcXOff=-1, double dfSrcYOff=-1,
@@ -814,7 +839,14 @@ protected:
     CPLString           m_osSourceFileNameOri;
     int                 m_nExplicitSharedStatus; // -1 unknown, 0 = unshared, 1 = shared
 
+    // Set when XMLInit() deferred the creation of the source band.
+    struct DeferredSrcBand;
+    DeferredSrcBand    *m_poDeferredSrcBand;
+
     int                 NeedMaxValAdjustment() const;
+    bool                InstantiateSrcBand();
+    int                 GetSrcRasterXSize();
+    int                 GetSrcRasterYSize();
 
 public:
             VRTSimpleSource();
@@ -876,6 +908,8 @@ public:
     virtual CPLErr FlushCache() override;
 
     GDALRasterBand* GetBand();
+    const char*     GetSrcDatasetName();
+    bool            IsSrcDatasetBand( int nBand );
     int             IsSameExceptBandNumber( VRTSimpleSource* poOtherSource );
     CPLErr          DatasetRasterIO(
                                GDALDataType eBandDataType,
@@ -132,6 +132,9 @@ VRTFilteredSource::RasterIO( GDALDataType eBandDataType,
                              GDALRasterIOExtraArg* psExtraArg )
 
 {
+    if( !InstantiateSrcBand() )
+        return CE_Failure;
+
 /* -------------------------------------------------------------------- */
 /*      For now we don't support filtered access to non-full            */
 /*      resolution requests. Just collect the data directly without     */
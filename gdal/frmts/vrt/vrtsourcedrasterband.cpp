@@ -35,8 +35,11 @@
 #include <cstddef>
 #include <cstdio>
 #include <cstdlib>
+#include <algorithm>
 #include <cstring>
+#include <map>
 #include <string>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
@@ -45,6 +48,7 @@
 #include "cpl_progress.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 #include "gdal_priv.h"
 #include "ogr_geometry.h"
@@ -66,6 +70,8 @@ CPL_CVSID("$Id$")
 VRTSourcedRasterBand::VRTSourcedRasterBand( GDALDataset *poDSIn, int nBandIn ) :
     m_nRecursionCounter(0),
     m_papszSourceList(nullptr),
+    m_hSourcesIndex(nullptr),
+    m_nSourcesInIndex(0),
     nSources(0),
     papoSources(nullptr),
     bSkipBufferInitialization(FALSE)
@@ -85,6 +91,8 @@ VRTSourcedRasterBand::VRTSourcedRasterBand( GDALDataType eType,
                                             int nXSize, int nYSize ) :
     m_nRecursionCounter(0),
     m_papszSourceList(nullptr),
+    m_hSourcesIndex(nullptr),
+    m_nSourcesInIndex(0),
     nSources(0),
     papoSources(nullptr),
     bSkipBufferInitialization(FALSE)
@@ -103,6 +111,8 @@ VRTSourcedRasterBand::VRTSourcedRasterBand( GDALDataset *poDSIn, int nBandIn,
                                             int nXSize, int nYSize ) :
     m_nRecursionCounter(0),
     m_papszSourceList(nullptr),
+    m_hSourcesIndex(nullptr),
+    m_nSourcesInIndex(0),
     nSources(0),
     papoSources(nullptr),
     bSkipBufferInitialization(FALSE)
@@ -123,9 +133,139 @@ VRTSourcedRasterBand::~VRTSourcedRasterBand()
 
 {
     CloseDependentDatasets();
+    InvalidateSourcesIndex();
     CSLDestroy(m_papszSourceList);
 }
 
+/************************************************************************/
+/*                          BuildSourcesIndex()                         */
+/************************************************************************/
+
+// Minimum number of sources for which it is worth indexing them.
+static const int MIN_SOURCES_FOR_INDEX = 64;
+
+void VRTSourcedRasterBand::BuildSourcesIndex()
+{
+    InvalidateSourcesIndex();
+
+    CPLRectObj sGlobalBounds;
+    sGlobalBounds.minx = 0;
+    sGlobalBounds.miny = 0;
+    sGlobalBounds.maxx = nRasterXSize;
+    sGlobalBounds.maxy = nRasterYSize;
+    m_hSourcesIndex = CPLQuadTreeCreate(&sGlobalBounds, nullptr);
+    CPLQuadTreeSetMaxDepth(m_hSourcesIndex,
+                           CPLQuadTreeGetAdvisedMaxDepth(nSources));
+    m_nSourcesInIndex = nSources;
+
+    for( int iSource = 0; iSource < nSources; iSource++ )
+    {
+        VRTSimpleSource* poSource = nullptr;
+        if( papoSources[iSource]->IsSimpleSource() )
+        {
+            poSource = cpl::down_cast<VRTSimpleSource*>(papoSources[iSource]);
+        }
+        // Sources without a destination window cover the whole raster.
+        if( poSource == nullptr ||
+            poSource->m_dfDstXSize < 0 || poSource->m_dfDstYSize < 0 )
+        {
+            m_anSourcesNotInIndex.push_back(iSource);
+            continue;
+        }
+
+        CPLRectObj sBounds;
+        sBounds.minx = poSource->m_dfDstXOff;
+        sBounds.miny = poSource->m_dfDstYOff;
+        sBounds.maxx = poSource->m_dfDstXOff + poSource->m_dfDstXSize;
+        sBounds.maxy = poSource->m_dfDstYOff + poSource->m_dfDstYSize;
+        CPLQuadTreeInsertWithBounds(
+            m_hSourcesIndex,
+            reinterpret_cast<void*>(static_cast<size_t>(iSource)),
+            &sBounds);
+    }
+}
+
+/************************************************************************/
+/*                        InvalidateSourcesIndex()                      */
+/************************************************************************/
+
+void VRTSourcedRasterBand::InvalidateSourcesIndex()
+{
+    if( m_hSourcesIndex != nullptr )
+    {
+        CPLQuadTreeDestroy(m_hSourcesIndex);
+        m_hSourcesIndex = nullptr;
+    }
+    m_nSourcesInIndex = 0;
+    m_anSourcesNotInIndex.clear();
+}
+
+/************************************************************************/
+/*                    GetSourcesIntersectingWindow()                    */
+/************************************************************************/
+
+// Return in anSources the indices, in increasing order, of the sources that
+// may intersect the window. This is a superset of the sources for which
+// GetSrcDstWindow() succeeds. The sources are not instantiated. When there
+// are many sources, a spatial index of their destination windows is built
+// on first call, so that sources far from the window are not visited.
+
+void VRTSourcedRasterBand::GetSourcesIntersectingWindow(
+    int nXOff, int nYOff, int nXSize, int nYSize,
+    std::vector<int>& anSources )
+{
+    anSources.clear();
+    if( nSources < MIN_SOURCES_FOR_INDEX )
+    {
+        for( int iSource = 0; iSource < nSources; iSource++ )
+        {
+            if( papoSources[iSource]->IsSimpleSource() )
+            {
+                VRTSimpleSource* poSource =
+                    cpl::down_cast<VRTSimpleSource*>(papoSources[iSource]);
+                if( poSource->m_dfDstXSize >= 0 &&
+                    poSource->m_dfDstYSize >= 0 &&
+                    (poSource->m_dfDstXOff >=
+                        static_cast<double>(nXOff) + nXSize ||
+                     poSource->m_dfDstYOff >=
+                        static_cast<double>(nYOff) + nYSize ||
+                     poSource->m_dfDstXOff + poSource->m_dfDstXSize <=
+                                                                nXOff ||
+                     poSource->m_dfDstYOff + poSource->m_dfDstYSize <=
+                                                                nYOff) )
+                {
+                    continue;
+                }
+            }
+            anSources.push_back(iSource);
+        }
+        return;
+    }
+
+    if( m_hSourcesIndex == nullptr || m_nSourcesInIndex != nSources )
+        BuildSourcesIndex();
+
+    CPLRectObj sAoi;
+    sAoi.minx = nXOff;
+    sAoi.miny = nYOff;
+    sAoi.maxx = static_cast<double>(nXOff) + nXSize;
+    sAoi.maxy = static_cast<double>(nYOff) + nYSize;
+    int nFeatureCount = 0;
+    void** pahFeatures =
+        CPLQuadTreeSearch(m_hSourcesIndex, &sAoi, &nFeatureCount);
+    anSources.reserve(nFeatureCount + m_anSourcesNotInIndex.size());
+    for( int i = 0; i < nFeatureCount; i++ )
+    {
+        anSources.push_back(static_cast<int>(
+            reinterpret_cast<size_t>(pahFeatures[i])));
+    }
+    CPLFree(pahFeatures);
+    anSources.insert(anSources.end(), m_anSourcesNotInIndex.begin(),
+                     m_anSourcesNotInIndex.end());
+    // Sources must be composited in their declaration order.
+    std::sort(anSources.begin(), anSources.end());
+}
+
 /************************************************************************/
 /*                             IRasterIO()                              */
 /************************************************************************/
@@ -176,6 +316,10 @@ CPLErr VRTSourcedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
             return CE_None;
     }
 
+    std::vector<int> anSources;
+    GetSourcesIntersectingWindow( nXOff, nYOff, nXSize, nYSize, anSources );
+    const int nCandidateSources = static_cast<int>(anSources.size());
+
     // If resampling with non-nearest neighbour, we need to be careful
     // if the VRT band exposes a nodata value, but the sources do not have it
     if( eRWFlag == GF_Read &&
@@ -183,8 +327,9 @@ CPLErr VRTSourcedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
         psExtraArg->eResampleAlg != GRIORA_NearestNeighbour &&
         m_bNoDataValueSet )
     {
-        for( int i = 0; i < nSources; i++ )
+        for( int iCandidate = 0; iCandidate < nCandidateSources; iCandidate++ )
         {
+            const int i = anSources[iCandidate];
             bool bFallbackToBase = false;
             if( !papoSources[i]->IsSimpleSource() )
             {
@@ -283,23 +428,41 @@ CPLErr VRTSourcedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
     GDALProgressFunc const pfnProgressGlobal = psExtraArg->pfnProgress;
     void * const pProgressDataGlobal = psExtraArg->pProgressData;
 
+/* -------------------------------------------------------------------- */
+/*      Read sources that do not overlap concurrently if possible.      */
+/* -------------------------------------------------------------------- */
+    const int nMTRet =
+        MultiThreadedSourcesRasterIO( anSources,
+                                      nXOff, nYOff, nXSize, nYSize,
+                                      pData, nBufXSize, nBufYSize,
+                                      eBufType, nPixelSpace, nLineSpace,
+                                      psExtraArg );
+    if( nMTRet >= 0 )
+    {
+        if( nMTRet == CE_None && pfnProgressGlobal != nullptr )
+            pfnProgressGlobal( 1.0, "", pProgressDataGlobal );
+        m_nRecursionCounter--;
+        return static_cast<CPLErr>(nMTRet);
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Overlay each source in turn over top this.                      */
 /* -------------------------------------------------------------------- */
     CPLErr eErr = CE_None;
-    for( int iSource = 0; eErr == CE_None && iSource < nSources; iSource++ )
+    for( int iCandidate = 0; eErr == CE_None && iCandidate < nCandidateSources;
+         iCandidate++ )
     {
         psExtraArg->pfnProgress = GDALScaledProgress;
         psExtraArg->pProgressData =
-            GDALCreateScaledProgress( 1.0 * iSource / nSources,
-                                      1.0 * (iSource + 1) / nSources,
+            GDALCreateScaledProgress( 1.0 * iCandidate / nCandidateSources,
+                                      1.0 * (iCandidate + 1) / nCandidateSources,
                                       pfnProgressGlobal,
                                       pProgressDataGlobal );
         if( psExtraArg->pProgressData == nullptr )
             psExtraArg->pfnProgress = nullptr;
 
         eErr =
-            papoSources[iSource]->RasterIO( eDataType,
+            papoSources[anSources[iCandidate]]->RasterIO( eDataType,
                                             nXOff, nYOff, nXSize, nYSize,
                                             pData, nBufXSize, nBufYSize,
                                             eBufType, nPixelSpace, nLineSpace,
@@ -316,6 +479,203 @@ CPLErr VRTSourcedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
     return eErr;
 }
 
+/************************************************************************/
+/*                     VRTSourcesRasterIOJob                            */
+/************************************************************************/
+
+namespace {
+
+// Sources of a VRTSourcedRasterBand reading from the same dataset, to be
+// read in turn by a worker thread.
+struct VRTSourcesRasterIOJob
+{
+    std::vector<VRTSimpleSource*> apoSources{};
+    GDALDataType         eBandDataType = GDT_Unknown;
+    int                  nXOff = 0;
+    int                  nYOff = 0;
+    int                  nXSize = 0;
+    int                  nYSize = 0;
+    void                *pData = nullptr;
+    int                  nBufXSize = 0;
+    int                  nBufYSize = 0;
+    GDALDataType         eBufType = GDT_Unknown;
+    GSpacing             nPixelSpace = 0;
+    GSpacing             nLineSpace = 0;
+    GDALRIOResampleAlg   eResampleAlg = GRIORA_NearestNeighbour;
+    CPLErr               eErr = CE_None;
+};
+
+// Destination window of a source within the RasterIO() buffer.
+struct VRTSourceDstWindow
+{
+    int    nXOff;
+    int    nYOff;
+    int    nXSize;
+    int    nYSize;
+    size_t nJob;
+};
+
+}  // namespace
+
+static void VRTSourcesRasterIOJobFunc( void* pData )
+{
+    VRTSourcesRasterIOJob* psJob = static_cast<VRTSourcesRasterIOJob*>(pData);
+    GDALRasterIOExtraArg sExtraArg;
+    INIT_RASTERIO_EXTRA_ARG(sExtraArg);
+    sExtraArg.eResampleAlg = psJob->eResampleAlg;
+    for( size_t i = 0; psJob->eErr == CE_None &&
+                       i < psJob->apoSources.size(); ++i )
+    {
+        psJob->eErr = psJob->apoSources[i]->RasterIO(
+            psJob->eBandDataType,
+            psJob->nXOff, psJob->nYOff, psJob->nXSize, psJob->nYSize,
+            psJob->pData, psJob->nBufXSize, psJob->nBufYSize,
+            psJob->eBufType, psJob->nPixelSpace, psJob->nLineSpace,
+            &sExtraArg );
+    }
+}
+
+/************************************************************************/
+/*                    MultiThreadedSourcesRasterIO()                    */
+/************************************************************************/
+
+// Read the sources with the global thread pool. Sources reading
+// from the same dataset are grouped in a single job, so that a dataset is
+// never accessed by several threads at once, and jobs are only run
+// concurrently if the destination windows of sources of different jobs do
+// not overlap, so that the result does not depend on the order in which
+// they complete.
+// Returns -1 if this is not possible, in which case the caller must read
+// the sources in turn.
+
+int VRTSourcedRasterBand::MultiThreadedSourcesRasterIO(
+    const std::vector<int>& anSources,
+    int nXOff, int nYOff, int nXSize, int nYSize,
+    void *pData, int nBufXSize, int nBufYSize,
+    GDALDataType eBufType,
+    GSpacing nPixelSpace, GSpacing nLineSpace,
+    GDALRasterIOExtraArg* psExtraArg )
+{
+    if( anSources.size() < 2 )
+        return -1;
+    VRTDataset* poVRTDS = dynamic_cast<VRTDataset*>(poDS);
+    if( poVRTDS == nullptr )
+        return -1;
+    CPLWorkerThreadPool* poThreadPool = poVRTDS->GetThreadPool();
+    if( poThreadPool == nullptr )
+        return -1;
+
+    std::vector<VRTSourcesRasterIOJob> asJobs;
+    std::vector<VRTSourceDstWindow> asWindows;
+    std::map<CPLString, size_t> oMapDatasetToJob;
+    for( size_t iCandidate = 0; iCandidate < anSources.size(); iCandidate++ )
+    {
+        const int iSource = anSources[iCandidate];
+        if( !papoSources[iSource]->IsSimpleSource() )
+            return -1;
+        VRTSimpleSource* poSource =
+            cpl::down_cast<VRTSimpleSource*>(papoSources[iSource]);
+
+        double dfReqXOff = 0.0;
+        double dfReqYOff = 0.0;
+        double dfReqXSize = 0.0;
+        double dfReqYSize = 0.0;
+        int nReqXOff = 0;
+        int nReqYOff = 0;
+        int nReqXSize = 0;
+        int nReqYSize = 0;
+        VRTSourceDstWindow sWindow = { 0, 0, 0, 0, 0 };
+        if( !poSource->GetSrcDstWindow( nXOff, nYOff, nXSize, nYSize,
+                                        nBufXSize, nBufYSize,
+                                        &dfReqXOff, &dfReqYOff,
+                                        &dfReqXSize, &dfReqYSize,
+                                        &nReqXOff, &nReqYOff,
+                                        &nReqXSize, &nReqYSize,
+                                        &sWindow.nXOff, &sWindow.nYOff,
+                                        &sWindow.nXSize, &sWindow.nYSize ) )
+        {
+            continue;
+        }
+
+        if( !poSource->InstantiateSrcBand() )
+            return -1;
+        GDALRasterBand* poSrcBand = poSource->m_poMaskBandMainBand ?
+            poSource->m_poMaskBandMainBand : poSource->m_poRasterBand;
+        GDALDataset* poSrcDS =
+            poSrcBand ? poSrcBand->GetDataset() : nullptr;
+        if( poSrcDS == nullptr )
+            return -1;
+
+        const CPLString osKey(poSrcDS->GetDescription());
+        std::map<CPLString, size_t>::iterator oIter =
+            oMapDatasetToJob.find(osKey);
+        if( oIter == oMapDatasetToJob.end() )
+        {
+            sWindow.nJob = asJobs.size();
+            oMapDatasetToJob[osKey] = sWindow.nJob;
+            asJobs.push_back(VRTSourcesRasterIOJob());
+        }
+        else
+        {
+            sWindow.nJob = oIter->second;
+        }
+        asJobs[sWindow.nJob].apoSources.push_back(poSource);
+        asWindows.push_back(sWindow);
+    }
+    if( asJobs.size() < 2 )
+        return -1;
+
+    // Check that windows of different jobs do not overlap, by sweeping
+    // them along the x axis.
+    std::sort(asWindows.begin(), asWindows.end(),
+              [](const VRTSourceDstWindow& a, const VRTSourceDstWindow& b)
+              { return a.nXOff < b.nXOff; });
+    for( size_t i = 0; i < asWindows.size(); ++i )
+    {
+        const VRTSourceDstWindow& sWin = asWindows[i];
+        for( size_t j = i + 1; j < asWindows.size() &&
+                  asWindows[j].nXOff < sWin.nXOff + sWin.nXSize; ++j )
+        {
+            const VRTSourceDstWindow& sOther = asWindows[j];
+            if( sOther.nJob != sWin.nJob &&
+                sOther.nYOff < sWin.nYOff + sWin.nYSize &&
+                sWin.nYOff < sOther.nYOff + sOther.nYSize )
+            {
+                return -1;
+            }
+        }
+    }
+
+    std::vector<void*> apJobs;
+    for( size_t i = 0; i < asJobs.size(); ++i )
+    {
+        VRTSourcesRasterIOJob& sJob = asJobs[i];
+        sJob.eBandDataType = eDataType;
+        sJob.nXOff = nXOff;
+        sJob.nYOff = nYOff;
+        sJob.nXSize = nXSize;
+        sJob.nYSize = nYSize;
+        sJob.pData = pData;
+        sJob.nBufXSize = nBufXSize;
+        sJob.nBufYSize = nBufYSize;
+        sJob.eBufType = eBufType;
+        sJob.nPixelSpace = nPixelSpace;
+        sJob.nLineSpace = nLineSpace;
+        sJob.eResampleAlg = psExtraArg->eResampleAlg;
+        apJobs.push_back(&sJob);
+    }
+    CPLJobQueue oJobQueue(poThreadPool);
+    oJobQueue.SubmitJobs(VRTSourcesRasterIOJobFunc, apJobs);
+    oJobQueue.WaitCompletion();
+
+    for( size_t i = 0; i < asJobs.size(); ++i )
+    {
+        if( asJobs[i].eErr != CE_None )
+            return CE_Failure;
+    }
+    return CE_None;
+}
+
 /************************************************************************/
 /*                         IGetDataCoverageStatus()                     */
 /************************************************************************/
@@ -491,12 +851,8 @@ bool VRTSourcedRasterBand::CanUseSourcesMinMaxImplementations()
             return false;
         VRTSimpleSource * const poSimpleSource
             = reinterpret_cast<VRTSimpleSource *>( papoSources[iSource] );
-        GDALRasterBand* poBand = poSimpleSource->GetBand();
-        if( poBand == nullptr )
-            return false;
-        if( poBand->GetDataset() == nullptr )
-            return false;
-        const char* pszFilename = poBand->GetDataset()->GetDescription();
+        // Do not instantiate deferred sources.
+        const char* pszFilename = poSimpleSource->GetSrcDatasetName();
         if( pszFilename == nullptr )
             return false;
         // /vsimem/ should be fast.
@@ -898,6 +1254,7 @@ CPLErr VRTSourcedRasterBand::AddSource( VRTSource *poNewSource )
     papoSources = static_cast<VRTSource **>(
         CPLRealloc( papoSources, sizeof(void*) * nSources ) );
     papoSources[nSources-1] = poNewSource;
+    InvalidateSourcesIndex();
 
     reinterpret_cast<VRTDataset *>( poDS )->SetNeedsFlush();
 
@@ -1037,8 +1394,8 @@ void VRTSourcedRasterBand::CheckSource( VRTSimpleSource *poSS )
     if( strcmp(poSS->GetType(), "SimpleSource") == 0 &&
         poSS->m_dfSrcXOff >= 0.0 &&
         poSS->m_dfSrcYOff >= 0.0 &&
-        poSS->m_dfSrcXOff + poSS->m_dfSrcXSize <= poSS->m_poRasterBand->GetXSize() &&
-        poSS->m_dfSrcYOff + poSS->m_dfSrcYSize <= poSS->m_poRasterBand->GetYSize() &&
+        poSS->m_dfSrcXOff + poSS->m_dfSrcXSize <= poSS->GetSrcRasterXSize() &&
+        poSS->m_dfSrcYOff + poSS->m_dfSrcYSize <= poSS->GetSrcRasterYSize() &&
         poSS->m_dfDstXOff <= 0.0 &&
         poSS->m_dfDstYOff <= 0.0 &&
         poSS->m_dfDstXOff + poSS->m_dfDstXSize >= nRasterXSize &&
@@ -1595,6 +1952,7 @@ CPLErr VRTSourcedRasterBand::SetMetadataItem( const char *pszName,
         {
             delete papoSources[iSource];
             papoSources[iSource] = poSource;
+            InvalidateSourcesIndex();
             reinterpret_cast<VRTDataset *>( poDS )->SetNeedsFlush();
             return CE_None;
         }
@@ -1626,6 +1984,7 @@ CPLErr VRTSourcedRasterBand::SetMetadata( char **papszNewMD, const char *pszDoma
             CPLFree( papoSources );
             papoSources = nullptr;
             nSources = 0;
+            InvalidateSourcesIndex();
         }
 
         for( int i = 0; i < CSLCount(papszNewMD); i++ )
@@ -1687,6 +2046,7 @@ int VRTSourcedRasterBand::CloseDependentDatasets()
     CPLFree( papoSources );
     papoSources = nullptr;
     nSources = 0;
+    InvalidateSourcesIndex();
 
     return TRUE;
 }
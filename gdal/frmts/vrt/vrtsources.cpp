@@ -91,6 +91,33 @@ void VRTSource::GetFileList(char*** /* ppapszFileList */,
 /* ==================================================================== */
 /************************************************************************/
 
+/************************************************************************/
+/*                           DeferredSrcBand                            */
+/************************************************************************/
+
+// What is needed to create the proxy dataset of a source whose properties
+// are fully described in the VRT.
+struct VRTSimpleSource::DeferredSrcBand
+{
+    CPLString     osSrcDSName{};
+    char        **papszOpenOptions = nullptr;
+    int           nSrcBand = 0;
+    bool          bGetMaskBand = false;
+    bool          bShared = false;
+    int           nRasterXSize = 0;
+    int           nRasterYSize = 0;
+    GDALDataType  eDataType = GDT_Unknown;
+    int           nBlockXSize = 0;
+    int           nBlockYSize = 0;
+    CPLString     osOwner{};
+    GIntBig       nResponsiblePID = 0;
+
+    DeferredSrcBand() = default;
+    ~DeferredSrcBand() { CSLDestroy(papszOpenOptions); }
+
+    CPL_DISALLOW_COPY_ASSIGN(DeferredSrcBand)
+};
+
 /************************************************************************/
 /*                          VRTSimpleSource()                           */
 /************************************************************************/
@@ -110,7 +137,8 @@ VRTSimpleSource::VRTSimpleSource() :
     m_dfNoDataValue(VRT_NODATA_UNSET),
     m_nMaxValue(0),
     m_bRelativeToVRTOri(-1),
-    m_nExplicitSharedStatus(-1)
+    m_nExplicitSharedStatus(-1),
+    m_poDeferredSrcBand(nullptr)
 {}
 
 /************************************************************************/
@@ -119,7 +147,9 @@ VRTSimpleSource::VRTSimpleSource() :
 
 VRTSimpleSource::VRTSimpleSource( const VRTSimpleSource* poSrcSource,
                                   double dfXDstRatio, double dfYDstRatio ) :
-    m_poRasterBand(poSrcSource->m_poRasterBand),
+    m_poRasterBand(const_cast<VRTSimpleSource*>(poSrcSource)->
+                        InstantiateSrcBand() ?
+                            poSrcSource->m_poRasterBand : nullptr),
     m_poMaskBandMainBand(poSrcSource->m_poMaskBandMainBand),
     m_dfSrcXOff(poSrcSource->m_dfSrcXOff),
     m_dfSrcYOff(poSrcSource->m_dfSrcYOff),
@@ -133,7 +163,8 @@ VRTSimpleSource::VRTSimpleSource( const VRTSimpleSource* poSrcSource,
     m_dfNoDataValue(poSrcSource->m_dfNoDataValue),
     m_nMaxValue(poSrcSource->m_nMaxValue),
     m_bRelativeToVRTOri(-1),
-    m_nExplicitSharedStatus(poSrcSource->m_nExplicitSharedStatus)
+    m_nExplicitSharedStatus(poSrcSource->m_nExplicitSharedStatus),
+    m_poDeferredSrcBand(nullptr)
 {}
 
 /************************************************************************/
@@ -143,6 +174,8 @@ VRTSimpleSource::VRTSimpleSource( const VRTSimpleSource* poSrcSource,
 VRTSimpleSource::~VRTSimpleSource()
 
 {
+    delete m_poDeferredSrcBand;
+
     if( m_poMaskBandMainBand != nullptr )
     {
         if( m_poMaskBandMainBand->GetDataset() != nullptr )
@@ -163,6 +196,10 @@ VRTSimpleSource::~VRTSimpleSource()
 CPLErr VRTSimpleSource::FlushCache()
 
 {
+    // Nothing to flush if the source band was never used.
+    if( m_poDeferredSrcBand != nullptr )
+        return CE_None;
+
     if( m_poMaskBandMainBand != nullptr )
     {
         return m_poMaskBandMainBand->FlushCache();
@@ -191,6 +228,8 @@ void VRTSimpleSource::UnsetPreservedRelativeFilenames()
 void VRTSimpleSource::SetSrcBand( GDALRasterBand *poNewSrcBand )
 
 {
+    delete m_poDeferredSrcBand;
+    m_poDeferredSrcBand = nullptr;
     m_poRasterBand = poNewSrcBand;
 }
 
@@ -203,10 +242,91 @@ void VRTSimpleSource::SetSrcBand( GDALRasterBand *poNewSrcBand )
 void VRTSimpleSource::SetSrcMaskBand( GDALRasterBand *poNewSrcBand )
 
 {
+    delete m_poDeferredSrcBand;
+    m_poDeferredSrcBand = nullptr;
     m_poRasterBand = poNewSrcBand->GetMaskBand();
     m_poMaskBandMainBand = poNewSrcBand;
 }
 
+/************************************************************************/
+/*                         InstantiateSrcBand()                         */
+/************************************************************************/
+
+// Create the proxy dataset of the source if XMLInit() deferred it.
+// Returns whether the source band is available.
+
+bool VRTSimpleSource::InstantiateSrcBand()
+{
+    if( m_poDeferredSrcBand == nullptr )
+        return m_poRasterBand != nullptr;
+
+    DeferredSrcBand* psDeferred = m_poDeferredSrcBand;
+    m_poDeferredSrcBand = nullptr;
+
+    // Behave as if the proxy dataset had been created by the thread that
+    // opened the VRT.
+    const GIntBig nCurResponsiblePID = GDALGetResponsiblePIDForCurrentThread();
+    GDALSetResponsiblePIDForCurrentThread(psDeferred->nResponsiblePID);
+    GDALProxyPoolDataset * const proxyDS =
+        new GDALProxyPoolDataset( psDeferred->osSrcDSName,
+                                  psDeferred->nRasterXSize,
+                                  psDeferred->nRasterYSize,
+                                  GA_ReadOnly, psDeferred->bShared,
+                                  nullptr, nullptr,
+                                  psDeferred->osOwner.c_str() );
+    GDALSetResponsiblePIDForCurrentThread(nCurResponsiblePID);
+    proxyDS->SetOpenOptions(psDeferred->papszOpenOptions);
+
+    // Only the information of rasterBand nSrcBand will be accurate
+    // but that's OK since we only use that band afterwards.
+    for( int i = 1; i <= psDeferred->nSrcBand; i++ )
+        proxyDS->AddSrcBandDescription(psDeferred->eDataType,
+                                       psDeferred->nBlockXSize,
+                                       psDeferred->nBlockYSize);
+
+    m_poRasterBand = proxyDS->GetRasterBand(psDeferred->nSrcBand);
+    if( psDeferred->bGetMaskBand )
+    {
+        GDALProxyPoolRasterBand *poMaskBand =
+            dynamic_cast<GDALProxyPoolRasterBand *>( m_poRasterBand );
+        if( poMaskBand == nullptr )
+        {
+            CPLError( CE_Fatal, CPLE_AssertionFailed, "dynamic_cast failed." );
+        }
+        else
+        {
+            poMaskBand->AddSrcMaskBandDescription( psDeferred->eDataType,
+                                                   psDeferred->nBlockXSize,
+                                                   psDeferred->nBlockYSize );
+        }
+        m_poMaskBandMainBand = m_poRasterBand;
+        m_poRasterBand = m_poRasterBand->GetMaskBand();
+    }
+
+    delete psDeferred;
+    return m_poRasterBand != nullptr;
+}
+
+/************************************************************************/
+/*                    GetSrcRasterXSize() / YSize()                     */
+/************************************************************************/
+
+// Dimensions of the source band, without instantiating it if deferred.
+
+int VRTSimpleSource::GetSrcRasterXSize()
+{
+    if( m_poDeferredSrcBand != nullptr )
+        return m_poDeferredSrcBand->nRasterXSize;
+    return m_poRasterBand ? m_poRasterBand->GetXSize() : 0;
+}
+
+int VRTSimpleSource::GetSrcRasterYSize()
+{
+    if( m_poDeferredSrcBand != nullptr )
+        return m_poDeferredSrcBand->nRasterYSize;
+    return m_poRasterBand ? m_poRasterBand->GetYSize() : 0;
+}
+
 /************************************************************************/
 /*                         RoundIfCloseToInt()                          */
 /************************************************************************/
@@ -279,7 +399,7 @@ static const char* const apszSpecialSyntax[] = {
 CPLXMLNode *VRTSimpleSource::SerializeToXML( const char *pszVRTPath )
 
 {
-    if( m_poRasterBand == nullptr )
+    if( !InstantiateSrcBand() )
         return nullptr;
 
     GDALDataset *poDS = nullptr;
@@ -661,7 +781,6 @@ CPLErr VRTSimpleSource::XMLInit( CPLXMLNode *psSrc, const char *pszVRTPath,
         papszOpenOptions =
             CSLSetNameValue(papszOpenOptions, "ROOT_PATH", pszVRTPath);
 
-    GDALDataset *poSrcDS = nullptr;
     if( nRasterXSize == 0 || nRasterYSize == 0 ||
         eDataType == static_cast<GDALDataType>(-1) ||
         nBlockXSize == 0 || nBlockYSize == 0 )
@@ -672,70 +791,57 @@ CPLErr VRTSimpleSource::XMLInit( CPLXMLNode *psSrc, const char *pszVRTPath,
         int nOpenFlags = GDAL_OF_RASTER | GDAL_OF_VERBOSE_ERROR;
         if( bShared )
             nOpenFlags |= GDAL_OF_SHARED;
-        poSrcDS = static_cast<GDALDataset *>( GDALOpenEx(
+        GDALDataset *poSrcDS = static_cast<GDALDataset *>( GDALOpenEx(
                     pszSrcDSName, nOpenFlags, nullptr,
                     (const char* const* )papszOpenOptions, nullptr ) );
-    }
-    else
-    {
+        CSLDestroy(papszOpenOptions);
+        CPLFree( pszSrcDSName );
+
+        if( poSrcDS == nullptr )
+            return CE_Failure;
+
         /* ----------------------------------------------------------------- */
-        /*      Create a proxy dataset                                       */
+        /*      Get the raster band.                                         */
         /* ----------------------------------------------------------------- */
-        CPLString osUniqueHandle( CPLSPrintf("%p", pUniqueHandle) );
-        GDALProxyPoolDataset * const proxyDS =
-            new GDALProxyPoolDataset( pszSrcDSName, nRasterXSize, nRasterYSize,
-                                      GA_ReadOnly, bShared, nullptr, nullptr,
-                                      osUniqueHandle.c_str() );
-        proxyDS->SetOpenOptions(papszOpenOptions);
-        poSrcDS = proxyDS;
-
-        // Only the information of rasterBand nSrcBand will be accurate
-        // but that's OK since we only use that band afterwards.
-        for( int i = 1; i <= nSrcBand; i++ )
-            proxyDS->AddSrcBandDescription(eDataType, nBlockXSize, nBlockYSize);
-
+        m_poRasterBand = poSrcDS->GetRasterBand(nSrcBand);
+        if( m_poRasterBand == nullptr )
+        {
+            if( poSrcDS->GetShared() )
+                GDALClose( poSrcDS );
+            return CE_Failure;
+        }
         if( bGetMaskBand )
         {
-          GDALProxyPoolRasterBand *poMaskBand =
-              dynamic_cast<GDALProxyPoolRasterBand *>(
-              proxyDS->GetRasterBand(nSrcBand) );
-          if( poMaskBand == nullptr )
-          {
-              CPLError(
-                  CE_Fatal, CPLE_AssertionFailed, "dynamic_cast failed." );
-          }
-          else
-          {
-              poMaskBand->AddSrcMaskBandDescription(
-                  eDataType, nBlockXSize, nBlockYSize );
-          }
+            m_poMaskBandMainBand = m_poRasterBand;
+            m_poRasterBand = m_poRasterBand->GetMaskBand();
+            if( m_poRasterBand == nullptr )
+                return CE_Failure;
         }
     }
-
-    CSLDestroy(papszOpenOptions);
-
-    CPLFree( pszSrcDSName );
-
-    if( poSrcDS == nullptr )
-        return CE_Failure;
-
-/* -------------------------------------------------------------------- */
-/*      Get the raster band.                                            */
-/* -------------------------------------------------------------------- */
-
-    m_poRasterBand = poSrcDS->GetRasterBand(nSrcBand);
-    if( m_poRasterBand == nullptr )
-    {
-        if( poSrcDS->GetShared() )
-            GDALClose( poSrcDS );
-        return CE_Failure;
-    }
-    if( bGetMaskBand )
+    else
     {
-        m_poMaskBandMainBand = m_poRasterBand;
-        m_poRasterBand = m_poRasterBand->GetMaskBand();
-        if( m_poRasterBand == nullptr )
-            return CE_Failure;
+        /* ----------------------------------------------------------------- */
+        /*      Everything needed is known: defer the creation of the proxy  */
+        /*      dataset to the first use of the source, which saves time     */
+        /*      and memory for VRTs with a huge number of sources of which   */
+        /*      only a few are read.                                         */
+        /* ----------------------------------------------------------------- */
+        delete m_poDeferredSrcBand;
+        m_poDeferredSrcBand = new DeferredSrcBand();
+        m_poDeferredSrcBand->osSrcDSName = pszSrcDSName;
+        m_poDeferredSrcBand->papszOpenOptions = papszOpenOptions;
+        m_poDeferredSrcBand->nSrcBand = nSrcBand;
+        m_poDeferredSrcBand->bGetMaskBand = bGetMaskBand;
+        m_poDeferredSrcBand->bShared = bShared;
+        m_poDeferredSrcBand->nRasterXSize = nRasterXSize;
+        m_poDeferredSrcBand->nRasterYSize = nRasterYSize;
+        m_poDeferredSrcBand->eDataType = eDataType;
+        m_poDeferredSrcBand->nBlockXSize = nBlockXSize;
+        m_poDeferredSrcBand->nBlockYSize = nBlockYSize;
+        m_poDeferredSrcBand->osOwner = CPLSPrintf("%p", pUniqueHandle);
+        m_poDeferredSrcBand->nResponsiblePID =
+            GDALGetResponsiblePIDForCurrentThread();
+        CPLFree( pszSrcDSName );
     }
 
 /* -------------------------------------------------------------------- */
@@ -784,7 +890,7 @@ void VRTSimpleSource::GetFileList( char*** ppapszFileList, int *pnSize,
                                    int *pnMaxSize, CPLHashSet* hSetFiles )
 {
     const char* pszFilename = nullptr;
-    if( m_poRasterBand != nullptr && m_poRasterBand->GetDataset() != nullptr &&
+    if( InstantiateSrcBand() && m_poRasterBand->GetDataset() != nullptr &&
         (pszFilename = m_poRasterBand->GetDataset()->GetDescription()) != nullptr )
     {
 /* -------------------------------------------------------------------- */
@@ -836,9 +942,54 @@ void VRTSimpleSource::GetFileList( char*** ppapszFileList, int *pnSize,
 
 GDALRasterBand* VRTSimpleSource::GetBand()
 {
+    if( !InstantiateSrcBand() )
+        return nullptr;
     return m_poMaskBandMainBand ? nullptr : m_poRasterBand;
 }
 
+/************************************************************************/
+/*                          GetSrcDatasetName()                         */
+/************************************************************************/
+
+// Name of the dataset of GetBand(), without instantiating the source band
+// if deferred. nullptr if there is no such band.
+
+const char* VRTSimpleSource::GetSrcDatasetName()
+{
+    if( m_poDeferredSrcBand != nullptr )
+    {
+        return m_poDeferredSrcBand->bGetMaskBand ?
+            nullptr : m_poDeferredSrcBand->osSrcDSName.c_str();
+    }
+    GDALRasterBand* poBand = GetBand();
+    if( poBand == nullptr || poBand->GetDataset() == nullptr )
+        return nullptr;
+    return poBand->GetDataset()->GetDescription();
+}
+
+/************************************************************************/
+/*                          IsSrcDatasetBand()                          */
+/************************************************************************/
+
+// Whether GetBand() is the band nBand of its dataset, without instantiating
+// the source band if deferred. The proxy dataset of a deferred source has
+// the source band as its last band.
+
+bool VRTSimpleSource::IsSrcDatasetBand( int nBand )
+{
+    if( m_poDeferredSrcBand != nullptr )
+    {
+        return !m_poDeferredSrcBand->bGetMaskBand &&
+               m_poDeferredSrcBand->nSrcBand == nBand;
+    }
+    GDALRasterBand* poBand = GetBand();
+    if( poBand == nullptr || poBand->GetDataset() == nullptr )
+        return false;
+    GDALDataset* poSrcDS = poBand->GetDataset();
+    return poSrcDS->GetRasterCount() >= nBand &&
+           poSrcDS->GetRasterBand(nBand) == poBand;
+}
+
 /************************************************************************/
 /*                       IsSameExceptBandNumber()                       */
 /************************************************************************/
@@ -855,11 +1006,9 @@ int VRTSimpleSource::IsSameExceptBandNumber( VRTSimpleSource* poOtherSource )
            m_dfDstYSize == poOtherSource->m_dfDstYSize &&
            m_bNoDataSet == poOtherSource->m_bNoDataSet &&
            m_dfNoDataValue == poOtherSource->m_dfNoDataValue &&
-           GetBand() != nullptr && poOtherSource->GetBand() != nullptr &&
-           GetBand()->GetDataset() != nullptr &&
-           poOtherSource->GetBand()->GetDataset() != nullptr &&
-           EQUAL(GetBand()->GetDataset()->GetDescription(),
-                 poOtherSource->GetBand()->GetDataset()->GetDescription());
+           GetSrcDatasetName() != nullptr &&
+           poOtherSource->GetSrcDatasetName() != nullptr &&
+           EQUAL(GetSrcDatasetName(), poOtherSource->GetSrcDatasetName());
 }
 
 /************************************************************************/
@@ -1043,32 +1192,35 @@ VRTSimpleSource::GetSrcDstWindow( int nXOff, int nYOff, int nXSize, int nYSize,
 /*      Clamp within the bounds of the available source data.           */
 /* -------------------------------------------------------------------- */
 
+    const int nSrcRasterXSize = GetSrcRasterXSize();
+    const int nSrcRasterYSize = GetSrcRasterYSize();
+
     if( *pnReqXSize == 0 )
         *pnReqXSize = 1;
     if( *pnReqYSize == 0 )
         *pnReqYSize = 1;
 
     if( *pnReqXSize > INT_MAX - *pnReqXOff ||
-        *pnReqXOff + *pnReqXSize > m_poRasterBand->GetXSize() )
+        *pnReqXOff + *pnReqXSize > nSrcRasterXSize )
     {
-        *pnReqXSize = m_poRasterBand->GetXSize() - *pnReqXOff;
+        *pnReqXSize = nSrcRasterXSize - *pnReqXOff;
         bModifiedX = true;
     }
-    if( *pdfReqXOff + *pdfReqXSize > m_poRasterBand->GetXSize() )
+    if( *pdfReqXOff + *pdfReqXSize > nSrcRasterXSize )
     {
-        *pdfReqXSize = m_poRasterBand->GetXSize() - *pdfReqXOff;
+        *pdfReqXSize = nSrcRasterXSize - *pdfReqXOff;
         bModifiedX = true;
     }
 
     if( *pnReqYSize > INT_MAX - *pnReqYOff ||
-        *pnReqYOff + *pnReqYSize > m_poRasterBand->GetYSize() )
+        *pnReqYOff + *pnReqYSize > nSrcRasterYSize )
     {
-        *pnReqYSize = m_poRasterBand->GetYSize() - *pnReqYOff;
+        *pnReqYSize = nSrcRasterYSize - *pnReqYOff;
         bModifiedY = true;
     }
-    if( *pdfReqYOff + *pdfReqYSize > m_poRasterBand->GetYSize() )
+    if( *pdfReqYOff + *pdfReqYSize > nSrcRasterYSize )
     {
-        *pdfReqYSize = m_poRasterBand->GetYSize() - *pdfReqYOff;
+        *pdfReqYSize = nSrcRasterYSize - *pdfReqYOff;
         bModifiedY = true;
     }
 
@@ -1076,8 +1228,8 @@ VRTSimpleSource::GetSrcDstWindow( int nXOff, int nYOff, int nXSize, int nYSize,
 /*      Don't do anything if the requesting region is completely off    */
 /*      the source image.                                               */
 /* -------------------------------------------------------------------- */
-    if( *pnReqXOff >= m_poRasterBand->GetXSize()
-        || *pnReqYOff >= m_poRasterBand->GetYSize()
+    if( *pnReqXOff >= nSrcRasterXSize
+        || *pnReqYOff >= nSrcRasterYSize
         || *pnReqXSize <= 0 || *pnReqYSize <= 0 )
     {
         return FALSE;
@@ -1199,6 +1351,9 @@ VRTSimpleSource::RasterIO( GDALDataType eBandDataType,
                            GDALRasterIOExtraArg* psExtraArgIn )
 
 {
+    if( !InstantiateSrcBand() )
+        return CE_Failure;
+
     GDALRasterIOExtraArg sExtraArg;
     INIT_RASTERIO_EXTRA_ARG(sExtraArg);
     GDALRasterIOExtraArg* psExtraArg = &sExtraArg;
@@ -1338,6 +1493,12 @@ VRTSimpleSource::RasterIO( GDALDataType eBandDataType,
 
 double VRTSimpleSource::GetMinimum( int nXSize, int nYSize, int *pbSuccess )
 {
+    if( !InstantiateSrcBand() )
+    {
+        *pbSuccess = FALSE;
+        return 0.0;
+    }
+
     // The window we will actually request from the source raster band.
     double dfReqXOff = 0.0;
     double dfReqYOff = 0.0;
@@ -1379,6 +1540,12 @@ double VRTSimpleSource::GetMinimum( int nXSize, int nYSize, int *pbSuccess )
 
 double VRTSimpleSource::GetMaximum( int nXSize, int nYSize, int *pbSuccess )
 {
+    if( !InstantiateSrcBand() )
+    {
+        *pbSuccess = FALSE;
+        return 0.0;
+    }
+
     // The window we will actually request from the source raster band.
     double dfReqXOff = 0.0;
     double dfReqYOff = 0.0;
@@ -1421,6 +1588,9 @@ double VRTSimpleSource::GetMaximum( int nXSize, int nYSize, int *pbSuccess )
 CPLErr VRTSimpleSource::ComputeRasterMinMax( int nXSize, int nYSize,
                                              int bApproxOK, double* adfMinMax )
 {
+    if( !InstantiateSrcBand() )
+        return CE_Failure;
+
     // The window we will actually request from the source raster band.
     double dfReqXOff = 0.0;
     double dfReqYOff = 0.0;
@@ -1472,6 +1642,9 @@ CPLErr VRTSimpleSource::ComputeStatistics(
     double *pdfMean, double *pdfStdDev,
     GDALProgressFunc pfnProgress, void *pProgressData )
 {
+    if( !InstantiateSrcBand() )
+        return CE_Failure;
+
     // The window we will actually request from the source raster band.
     double dfReqXOff = 0.0;
     double dfReqYOff = 0.0;
@@ -1517,6 +1690,9 @@ CPLErr VRTSimpleSource::GetHistogram(
     int bIncludeOutOfRange, int bApproxOK,
     GDALProgressFunc pfnProgress, void *pProgressData )
 {
+    if( !InstantiateSrcBand() )
+        return CE_Failure;
+
     // The window we will actually request from the source raster band.
     double dfReqXOff = 0.0;
     double dfReqYOff = 0.0;
@@ -1566,6 +1742,9 @@ CPLErr VRTSimpleSource::DatasetRasterIO(
     GSpacing nBandSpace,
     GDALRasterIOExtraArg* psExtraArgIn )
 {
+    if( !InstantiateSrcBand() )
+        return CE_Failure;
+
     if( !EQUAL(GetType(), "SimpleSource") )
     {
         CPLError(CE_Failure, CPLE_NotSupported,
@@ -1762,6 +1941,9 @@ VRTAveragedSource::RasterIO( GDALDataType /*eBandDataType*/,
                              GDALRasterIOExtraArg* psExtraArgIn )
 
 {
+    if( !InstantiateSrcBand() )
+        return CE_Failure;
+
     GDALRasterIOExtraArg sExtraArg;
     INIT_RASTERIO_EXTRA_ARG(sExtraArg);
     GDALRasterIOExtraArg* psExtraArg = &sExtraArg;
@@ -2392,6 +2574,9 @@ VRTComplexSource::RasterIO( GDALDataType /*eBandDataType*/,
                             GDALRasterIOExtraArg* psExtraArgIn )
 
 {
+    if( !InstantiateSrcBand() )
+        return CE_Failure;
+
     GDALRasterIOExtraArg sExtraArg;
     INIT_RASTERIO_EXTRA_ARG(sExtraArg);
     GDALRasterIOExtraArg* psExtraArg = &sExtraArg;
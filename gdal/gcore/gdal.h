@@ -299,6 +299,13 @@ typedef GIntBig GSpacing;
  */
 #define GDAL_DMD_EXTENSIONS "DMD_EXTENSIONS"
 
+/** List of (space separated) hexadecimal-encoded byte sequences, one of which
+ * starts the files handled by the driver. For example "89504E470D0A1A0A" for
+ * PNG. Used by GDALOpenEx() to try the driver before the others.
+ * @since GDAL 2.3
+ */
+#define GDAL_DMD_MAGIC_BYTES "DMD_MAGIC_BYTES"
+
 /** XML snippet with creation options. */
 #define GDAL_DMD_CREATIONOPTIONLIST "DMD_CREATIONOPTIONLIST"
 
@@ -517,6 +524,16 @@ GDALDatasetH CPL_DLL CPL_STDCALL GDALOpenShared( const char *, GDALAccess ) CPL_
 #define     GDAL_OF_BLOCK_ACCESS_MASK     0x300
 #endif
 
+/** Open in thread-safe mode. The returned dataset can be used concurrently
+ * from several threads for read operations, such as RasterIO(). It is only
+ * compatible with raster datasets opened in read-only mode, and cannot be
+ * used with GDAL_OF_UPDATE or GDAL_OF_SHARED.
+ *
+ * Used by GDALOpenEx().
+ * @since GDAL 2.3
+ */
+#define     GDAL_OF_THREAD_SAFE           0x400
+
 GDALDatasetH CPL_DLL CPL_STDCALL GDALOpenEx( const char* pszFilename,
                                              unsigned int nOpenFlags,
                                              const char* const* papszAllowedDrivers,
@@ -822,6 +839,14 @@ CPLErr CPL_DLL CPL_STDCALL GDALComputeRasterStatistics(
     GDALRasterBandH, int bApproxOK,
     double *pdfMin, double *pdfMax, double *pdfMean, double *pdfStdDev,
     GDALProgressFunc pfnProgress, void *pProgressData );
+CPLErr CPL_DLL CPL_STDCALL GDALComputeRasterStatisticsAndHistogram(
+    GDALRasterBandH, int bApproxOK,
+    double *pdfMin, double *pdfMax, double *pdfMean, double *pdfStdDev,
+    double *pdfHistMin, double *pdfHistMax,
+    int nBuckets, GUIntBig *panHistogram,
+    int nPercentiles, const double *padfPercentiles,
+    double *padfPercentileValues,
+    GDALProgressFunc pfnProgress, void *pProgressData );
 CPLErr CPL_DLL CPL_STDCALL GDALSetRasterStatistics(
     GDALRasterBandH hBand,
     double dfMin, double dfMax, double dfMean, double dfStdDev );
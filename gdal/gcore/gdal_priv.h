@@ -50,6 +50,7 @@ class GDALRasterAttributeTable;
 class GDALProxyDataset;
 class GDALProxyRasterBand;
 class GDALAsyncReader;
+class GDALBlockPrefetcher;
 
 /* -------------------------------------------------------------------- */
 /*      Pull in the public declarations.  This gets the C apis, and     */
@@ -65,6 +66,7 @@ class GDALAsyncReader;
 #include "cpl_minixml.h"
 #include "cpl_multiproc.h"
 #include "cpl_atomic_ops.h"
+#include <atomic>
 #include <vector>
 #include <map>
 #include <limits>
@@ -456,6 +458,8 @@ class CPL_DLL GDALDataset : public GDALMajorObject
 
     int          AcquireMutex();
     void         ReleaseMutex();
+
+    GDALBlockPrefetcher *GetBlockPrefetcher();
 //! @endcond
 
   public:
@@ -716,6 +720,10 @@ class CPL_DLL GDALRasterBlock
 
     bool                 bMustDetach;
 
+    // Reference bit for the CLOCK cache policy, set by Touch() without
+    // the lock of the cache shard.
+    std::atomic<bool>    bReferenced;
+
     void        Detach_unlocked( void );
     void        Touch_unlocked( void );
 
@@ -892,6 +900,42 @@ class CPL_DLL GDALAbstractBandBlockCache
 GDALAbstractBandBlockCache* GDALArrayBandBlockCacheCreate(GDALRasterBand* poBand);
 GDALAbstractBandBlockCache* GDALHashSetBandBlockCacheCreate(GDALRasterBand* poBand);
 
+/* ******************************************************************** */
+/*                         GDALBlockPrefetcher                          */
+/* ******************************************************************** */
+
+/* Asynchronous read-ahead of the blocks of a dataset opened in read-only */
+/* mode, from worker threads using their own dataset handles. */
+class CPL_DLL GDALBlockPrefetcher
+{
+        class Private;
+        Private          *m_poPrivate;
+
+        bool              Schedule( int nBand, int nXBlockOff,
+                                    int nYBlockOff );
+        void              ProcessRequest();
+        static void       ProcessRequestFunc( void* pData );
+        GDALDataset      *OpenClone();
+
+        GDALBlockPrefetcher( GDALDataset* poDS, unsigned int nOpenFlags,
+                             int nThreads );
+
+        CPL_DISALLOW_COPY_ASSIGN(GDALBlockPrefetcher)
+
+    public:
+            ~GDALBlockPrefetcher();
+
+            static GDALBlockPrefetcher* Create( GDALDataset* poDS,
+                                                unsigned int nOpenFlags );
+
+            void             NotifyBlockMiss( int nBand, int nXBlockOff,
+                                              int nYBlockOff );
+            void             AdviseWindow( int nBand, int nXOff, int nYOff,
+                                           int nXSize, int nYSize );
+            bool             FetchBlock( int nBand, int nXBlockOff,
+                                         int nYBlockOff, void* pData );
+};
+
 //! @endcond
 
 /* ******************************************************************** */
@@ -906,6 +950,7 @@ class CPL_DLL GDALRasterBand : public GDALMajorObject
     friend class GDALArrayBandBlockCache;
     friend class GDALHashSetBandBlockCache;
     friend class GDALRasterBlock;
+    friend class GDALBlockPrefetcher;
 
     CPLErr eFlushBlockErr;
     GDALAbstractBandBlockCache* poBandBlockCache;
@@ -1057,6 +1102,16 @@ class CPL_DLL GDALRasterBand : public GDALMajorObject
                                       double *pdfMin, double *pdfMax,
                                       double *pdfMean, double *pdfStdDev,
                                       GDALProgressFunc, void *pProgressData );
+    virtual CPLErr ComputeStatisticsAndHistogram(
+                                  int bApproxOK,
+                                  double *pdfMin, double *pdfMax,
+                                  double *pdfMean, double *pdfStdDev,
+                                  double *pdfHistMin, double *pdfHistMax,
+                                  int nBuckets, GUIntBig *panHistogram,
+                                  int nPercentiles,
+                                  const double *padfPercentiles,
+                                  double *padfPercentileValues,
+                                  GDALProgressFunc, void *pProgressData );
     virtual CPLErr SetStatistics( double dfMin, double dfMax,
                                   double dfMean, double dfStdDev );
     virtual CPLErr ComputeRasterMinMax( int, double* );
@@ -1253,6 +1308,11 @@ class CPL_DLL GDALDriver : public GDALMajorObject
     CPLErr      SetMetadataItem( const char * pszName,
                                  const char * pszValue,
                                  const char * pszDomain = "" ) override;
+    CPLErr      SetMetadata( char ** papszMetadata,
+                             const char * pszDomain = "" ) override;
+    char      **GetMetadata( const char * pszDomain = "" ) override;
+    const char *GetMetadataItem( const char * pszName,
+                                 const char * pszDomain = "" ) override;
 
 /* -------------------------------------------------------------------- */
 /*      Public C++ methods.                                             */
@@ -1317,6 +1377,17 @@ class CPL_DLL GDALDriver : public GDALMajorObject
                                                  char ** papszOptions );
     CPLErr              (*pfnDeleteDataSource)( GDALDriver*,
                                                  const char * pszName );
+
+    /** Sets the metadata items that are only needed once the driver is
+        actually used: GDAL_DMD_CREATIONOPTIONLIST, GDAL_DMD_OPENOPTIONLIST,
+        GDAL_DS_LAYER_CREATIONOPTIONLIST, GDAL_DMD_CREATIONFIELDDATATYPES and
+        GDAL_DMD_CREATIONFIELDDATASUBTYPES. Called once, on first access to one
+        of them or to the whole default metadata domain, so that registering
+        the driver does not need to build them. The function must only set
+        items through SetMetadataItem(), and the pointer must not be changed
+        once the driver is registered.
+    */
+    void                (*pfnInitDeferredMetadata)( GDALDriver* );
 //! @endcond
 
 /* -------------------------------------------------------------------- */
@@ -1353,6 +1424,20 @@ class CPL_DLL GDALDriver : public GDALMajorObject
         { return static_cast<GDALDriver*>(hDriver); }
 
 private:
+    // Items set by pfnInitDeferredMetadata, kept apart from the other items
+    // so that they can be read without a lock while it runs.
+    char              **m_papszDeferredMetadata;
+    // Result of GetMetadata() on the default domain, when there are such
+    // items.
+    char              **m_papszMergedMetadata;
+    // Names of the items set before pfnInitDeferredMetadata ran, whose
+    // value it must not replace.
+    char              **m_papszOverriddenItems;
+    bool                m_bInInitDeferredMetadata;
+    std::atomic<bool>   m_bDeferredMetadataInitialized;
+
+    void                InitDeferredMetadata();
+
     CPL_DISALLOW_COPY_ASSIGN(GDALDriver)
 };
 
@@ -1373,6 +1458,14 @@ class CPL_DLL GDALDriverManager : public GDALMajorObject
     GDALDriver  **papoDrivers;
     std::map<CPLString, GDALDriver*> oMapNameToDrivers;
 
+    // Drivers indexed by extension and magic bytes, used to order the
+    // drivers tried by GDALOpenEx(). Rebuilt when the driver list changes.
+    bool        bDispatchIndexValid;
+    std::map<CPLString, std::vector<GDALDriver*>> oMapExtensionToDrivers;
+    std::vector<std::pair<CPLString, GDALDriver*>> aoMagicBytesToDriver;
+
+    void        BuildDispatchIndex_unlocked();
+
     GDALDriver  *GetDriver_unlocked( int iDriver )
             { return (iDriver >= 0 && iDriver < nDrivers) ?
                   papoDrivers[iDriver] : nullptr; }
@@ -1394,6 +1487,10 @@ class CPL_DLL GDALDriverManager : public GDALMajorObject
     // AutoLoadDrivers is a no-op if compiled with GDAL_NO_AUTOLOAD defined.
     static void        AutoLoadDrivers();
     void        AutoSkipDrivers();
+
+//! @cond Doxygen_Suppress
+    std::vector<GDALDriver*> GetDriversForOpen( GDALOpenInfo* poOpenInfo );
+//! @endcond
 };
 
 CPL_C_START
@@ -1660,6 +1757,17 @@ void GDALRasterIOExtraArgSetResampleAlg(GDALRasterIOExtraArg* psExtraArg,
 GDALDataset* GDALCreateOverviewDataset(GDALDataset* poDS, int nOvrLevel,
                                        int bThisLevelOnly);
 
+GDALDataset* GDALCreateThreadSafeDataset( const char* pszFilename,
+                                          unsigned int nOpenFlags,
+                                          const char* const* papszAllowedDrivers,
+                                          const char* const* papszOpenOptions,
+                                          const char* const* papszSiblingFiles );
+
+class CPLWorkerThreadPool;
+int GDALGetNumThreads( const char* pszConfigOption = "GDAL_NUM_THREADS" );
+CPLWorkerThreadPool* GDALGetGlobalThreadPool( int nThreads );
+void GDALDestroyGlobalThreadPool();
+
 // Should cover particular cases of #3573, #4183, #4506, #6578
 // Behaviour is undefined if fVal1 or fVal2 are NaN (should be tested before
 // calling this function)
@@ -155,6 +155,16 @@ class CPL_DLL GDALProxyRasterBand : public GDALRasterBand
                               double *pdfMin, double *pdfMax,
                               double *pdfMean, double *pdfStdDev,
                               GDALProgressFunc, void *pProgressData ) override;
+    CPLErr ComputeStatisticsAndHistogram(
+                              int bApproxOK,
+                              double *pdfMin, double *pdfMax,
+                              double *pdfMean, double *pdfStdDev,
+                              double *pdfHistMin, double *pdfHistMax,
+                              int nBuckets, GUIntBig *panHistogram,
+                              int nPercentiles,
+                              const double *padfPercentiles,
+                              double *padfPercentileValues,
+                              GDALProgressFunc, void *pProgressData ) override;
     CPLErr SetStatistics( double dfMin, double dfMax,
                           double dfMean, double dfStdDev ) override;
     CPLErr ComputeRasterMinMax( int, double* ) override;
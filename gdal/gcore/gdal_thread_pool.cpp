@@ -0,0 +1,142 @@
+/******************************************************************************
+ *
+ * Project:  GDAL Core
+ * Purpose:  Process-wide pool of worker threads
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cpl_port.h"
+#include "gdal_priv.h"
+
+#include <cstdlib>
+#include <algorithm>
+#include <new>
+#include <vector>
+
+#include "cpl_conv.h"
+#include "cpl_multiproc.h"
+#include "cpl_worker_thread_pool.h"
+
+CPL_CVSID("$Id$")
+
+//! @cond Doxygen_Suppress
+
+// Upper bound of the number of threads of the pool.
+static const int GDAL_MAX_THREADS = 128;
+
+static CPLMutex* hGlobalThreadPoolMutex = nullptr;
+static CPLWorkerThreadPool* poGlobalThreadPool = nullptr;
+// Pools replaced by a larger one, kept until GDALDestroyGlobalThreadPool()
+// since jobs may still be queued on them.
+static std::vector<CPLWorkerThreadPool*> apoRetiredThreadPools;
+
+/************************************************************************/
+/*                          GDALGetNumThreads()                         */
+/************************************************************************/
+
+// Return the number of threads asked by the GDAL_NUM_THREADS configuration
+// option, or another one with the same syntax (a number or ALL_CPUS),
+// between 1 and GDAL_MAX_THREADS.
+int GDALGetNumThreads( const char* pszConfigOption )
+{
+    const char* pszNumThreads = CPLGetConfigOption(pszConfigOption, "1");
+    const int nThreads = EQUAL(pszNumThreads, "ALL_CPUS") ?
+                                CPLGetNumCPUs() : atoi(pszNumThreads);
+    return std::max(1, std::min(nThreads, GDAL_MAX_THREADS));
+}
+
+/************************************************************************/
+/*                    GDALGlobalThreadPoolInitFunc()                    */
+/************************************************************************/
+
+// Mark the worker threads of the global pool, so that a job that asks for
+// the pool gets nullptr and runs serially instead of waiting for jobs queued
+// behind it.
+static void GDALGlobalThreadPoolInitFunc( void* )
+{
+    CPLSetTLS( CTLS_GDAL_GLOBAL_THREAD_POOL, &poGlobalThreadPool, FALSE );
+}
+
+/************************************************************************/
+/*                       GDALGetGlobalThreadPool()                      */
+/************************************************************************/
+
+// Return the process-wide pool of worker threads, with at least nThreads
+// threads, or nullptr if nThreads <= 1, if the pool cannot be created, or if
+// called from one of its worker threads. The pool is created lazily and
+// shared by all callers, which should submit their jobs through their own
+// CPLJobQueue so as to only wait for them.
+CPLWorkerThreadPool* GDALGetGlobalThreadPool( int nThreads )
+{
+    nThreads = std::min(nThreads, GDAL_MAX_THREADS);
+    if( nThreads <= 1 ||
+        CPLGetTLS( CTLS_GDAL_GLOBAL_THREAD_POOL ) != nullptr )
+    {
+        return nullptr;
+    }
+
+    CPLMutexHolderD( &hGlobalThreadPoolMutex );
+    if( poGlobalThreadPool != nullptr &&
+        poGlobalThreadPool->GetThreadCount() >= nThreads )
+    {
+        return poGlobalThreadPool;
+    }
+
+    CPLWorkerThreadPool* poThreadPool =
+        new (std::nothrow) CPLWorkerThreadPool();
+    if( poThreadPool == nullptr ||
+        !poThreadPool->Setup( nThreads, GDALGlobalThreadPoolInitFunc,
+                              nullptr ) )
+    {
+        delete poThreadPool;
+        return poGlobalThreadPool;
+    }
+    if( poGlobalThreadPool != nullptr )
+        apoRetiredThreadPools.push_back(poGlobalThreadPool);
+    poGlobalThreadPool = poThreadPool;
+    CPLDebug( "GDAL", "Global thread pool of %d threads created", nThreads );
+    return poGlobalThreadPool;
+}
+
+/************************************************************************/
+/*                     GDALDestroyGlobalThreadPool()                    */
+/************************************************************************/
+
+void GDALDestroyGlobalThreadPool()
+{
+    {
+        CPLMutexHolderD( &hGlobalThreadPoolMutex );
+        delete poGlobalThreadPool;
+        poGlobalThreadPool = nullptr;
+        for( size_t i = 0; i < apoRetiredThreadPools.size(); i++ )
+            delete apoRetiredThreadPools[i];
+        apoRetiredThreadPools.clear();
+    }
+    if( hGlobalThreadPoolMutex != nullptr )
+    {
+        CPLDestroyMutex( hGlobalThreadPoolMutex );
+        hGlobalThreadPoolMutex = nullptr;
+    }
+}
+
+//! @endcond
@@ -112,6 +112,8 @@ class GDALDataset::Private
     GIntBig nTotalFeaturesInLayer;
     GIntBig nTotalFeatures;
     OGRLayer *poCurrentLayer;
+    bool bBlockPrefetcherInit;
+    GDALBlockPrefetcher *poBlockPrefetcher;
 
     Private() :
         hMutex(nullptr),
@@ -122,7 +124,9 @@ class GDALDataset::Private
         nFeatureReadInDataset(0),
         nTotalFeaturesInLayer(TOTAL_FEATURES_NOT_INIT),
         nTotalFeatures(TOTAL_FEATURES_NOT_INIT),
-        poCurrentLayer(nullptr)
+        poCurrentLayer(nullptr),
+        bBlockPrefetcherInit(false),
+        poBlockPrefetcher(nullptr)
         {}
 };
 
@@ -360,6 +364,15 @@ GDALDataset::~GDALDataset()
         }
     }
 
+/* -------------------------------------------------------------------- */
+/*      Stop the reading of blocks ahead.                               */
+/* -------------------------------------------------------------------- */
+    if( m_poPrivate != nullptr )
+    {
+        delete m_poPrivate->poBlockPrefetcher;
+        m_poPrivate->poBlockPrefetcher = nullptr;
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Destroy the raster bands if they exist.                         */
 /* -------------------------------------------------------------------- */
@@ -2535,7 +2548,8 @@ CPLErr CPL_STDCALL GDALCreateDatasetMaskBand( GDALDatasetH hDS, int nFlags )
  * you want to use it from different threads, you must add all necessary code
  * (mutexes, etc.)  to avoid concurrent use of the object. (Some drivers, such
  * as GeoTIFF, maintain internal state variables that are updated each time a
- * new block is read, thus preventing concurrent use.) </li>
+ * new block is read, thus preventing concurrent use.) Raster datasets opened
+ * in read-only mode with GDAL_OF_THREAD_SAFE are an exception to this.</li>
  * </ul>
  *
  * For drivers supporting the VSI virtual file API, it is possible to open a
@@ -2603,6 +2617,13 @@ GDALOpen( const char * pszFilename, GDALAccess eAccess )
  * In some situations (dealing with unverified data), the datasets can be opened
  * in another process through the \ref gdal_api_proxy mechanism.
  *
+ * Drivers are tried in registration order. If the GDAL_OPEN_DISPATCH_INDEX
+ * configuration option is set to YES, drivers that declare the extension of
+ * the file (GDAL_DMD_EXTENSION or GDAL_DMD_EXTENSIONS metadata items), or a
+ * signature matching the first bytes of the file (GDAL_DMD_MAGIC_BYTES), are
+ * tried first, which is faster when many drivers are registered but may select
+ * another driver for a file that several drivers can open.
+ *
  * In order to reduce the need for searches through the operating system
  * file system machinery, it is possible to give an optional list of files with
  * the papszSiblingFiles parameter.
@@ -2631,6 +2652,16 @@ GDALOpen( const char * pszFilename, GDALAccess eAccess )
  * referenced and returned, if GDALOpenEx() is called from the same thread.</li>
  * <li>Verbose error: GDAL_OF_VERBOSE_ERROR. If set, a failed attempt to open
  * the file will lead to an error message to be reported.</li>
+ * <li>Thread-safe mode: GDAL_OF_THREAD_SAFE (GDAL &gt;= 2.3). If set, the
+ * returned raster dataset can be used concurrently from several threads for
+ * read operations, such as RasterIO(), GetMetadata() or GetOverview(). This is
+ * implemented by opening, on first use from a thread, a separate underlying
+ * dataset for that thread. Those datasets are closed when the returned dataset
+ * is closed. Statistics and default histograms are computed on a single
+ * dataset, shared by all threads, which saves them in the .aux.xml file.
+ * Methods that modify the dataset fail, and direct block access
+ * through GetLockedBlockRef() is not thread-safe. Cannot be combined with
+ * GDAL_OF_UPDATE or GDAL_OF_SHARED.</li>
  * </ul>
  *
  * @param papszAllowedDrivers NULL to consider all candidate drivers, or a NULL
@@ -2667,6 +2698,40 @@ GDALDatasetH CPL_STDCALL GDALOpenEx( const char *pszFilename,
 {
     VALIDATE_POINTER1(pszFilename, "GDALOpen", nullptr);
 
+/* -------------------------------------------------------------------- */
+/*      In thread-safe mode, return a proxy that opens one underlying   */
+/*      dataset per calling thread.                                     */
+/* -------------------------------------------------------------------- */
+    if( nOpenFlags & GDAL_OF_THREAD_SAFE )
+    {
+        if( nOpenFlags & (GDAL_OF_UPDATE | GDAL_OF_SHARED) )
+        {
+            CPLError(CE_Failure, CPLE_IllegalArg,
+                     "GDAL_OF_THREAD_SAFE cannot be used with "
+                     "GDAL_OF_UPDATE or GDAL_OF_SHARED");
+            return nullptr;
+        }
+        if( (nOpenFlags & GDAL_OF_KIND_MASK) != 0 &&
+            (nOpenFlags & GDAL_OF_RASTER) == 0 )
+        {
+            CPLError(CE_Failure, CPLE_IllegalArg,
+                     "GDAL_OF_THREAD_SAFE is only supported with "
+                     "GDAL_OF_RASTER");
+            return nullptr;
+        }
+
+        GDALDataset *poDS =
+            GDALCreateThreadSafeDataset(pszFilename, nOpenFlags,
+                                        papszAllowedDrivers, papszOpenOptions,
+                                        papszSiblingFiles);
+        if( poDS == nullptr )
+            return nullptr;
+        poDS->nOpenFlags = nOpenFlags;
+        if( !(nOpenFlags & GDAL_OF_INTERNAL) )
+            poDS->AddToDatasetOpenList();
+        return poDS;
+    }
+
 /* -------------------------------------------------------------------- */
 /*      In case of shared dataset, first scan the existing list to see  */
 /*      if it could already contain the requested dataset.              */
@@ -2756,7 +2821,12 @@ GDALDatasetH CPL_STDCALL GDALOpenEx( const char *pszFilename,
 
     oOpenInfo.papszOpenOptions = papszOpenOptionsCleaned;
 
-    for( int iDriver = -1; iDriver < poDM->GetDriverCount(); ++iDriver )
+    // Drivers matching the extension or the header of the file come first.
+    const std::vector<GDALDriver *> apoDrivers =
+        poDM->GetDriversForOpen(&oOpenInfo);
+
+    for( int iDriver = -1; iDriver < static_cast<int>(apoDrivers.size());
+         ++iDriver )
     {
         GDALDriver *poDriver = nullptr;
 
@@ -2766,7 +2836,7 @@ GDALDatasetH CPL_STDCALL GDALOpenEx( const char *pszFilename,
         }
         else
         {
-            poDriver = poDM->GetDriver(iDriver);
+            poDriver = apoDrivers[iDriver];
             if (papszAllowedDrivers != nullptr &&
                 CSLFindString(papszAllowedDrivers,
                               GDALGetDriverShortName(poDriver)) == -1)
@@ -6841,4 +6911,29 @@ void GDALDataset::ReleaseMutex()
     if( m_poPrivate )
         CPLReleaseMutex(m_poPrivate->hMutex);
 }
+
+/************************************************************************/
+/*                         GetBlockPrefetcher()                         */
+/************************************************************************/
+
+// Returns the object reading blocks ahead for this dataset, or nullptr.
+// Only datasets returned by GDALOpenEx() in read-only mode are eligible,
+// since the blocks are read with other handles on the same file.
+GDALBlockPrefetcher *GDALDataset::GetBlockPrefetcher()
+{
+    if( m_poPrivate == nullptr )
+        return nullptr;
+    if( !m_poPrivate->bBlockPrefetcherInit )
+    {
+        m_poPrivate->bBlockPrefetcherInit = true;
+        if( (nOpenFlags & GDAL_OF_RASTER) != 0 &&
+            (nOpenFlags & (GDAL_OF_UPDATE | GDAL_OF_INTERNAL)) == 0 &&
+            eAccess == GA_ReadOnly )
+        {
+            m_poPrivate->poBlockPrefetcher =
+                GDALBlockPrefetcher::Create(this, nOpenFlags);
+        }
+    }
+    return m_poPrivate->poBlockPrefetcher;
+}
 //! @endcond
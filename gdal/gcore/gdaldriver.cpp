@@ -69,7 +69,13 @@ GDALDriver::GDALDriver() :
     pfnCopyFiles(nullptr),
     pfnOpenWithDriverArg(nullptr),
     pfnCreateVectorOnly(nullptr),
-    pfnDeleteDataSource(nullptr)
+    pfnDeleteDataSource(nullptr),
+    pfnInitDeferredMetadata(nullptr),
+    m_papszDeferredMetadata(nullptr),
+    m_papszMergedMetadata(nullptr),
+    m_papszOverriddenItems(nullptr),
+    m_bInInitDeferredMetadata(false),
+    m_bDeferredMetadataInitialized(false)
 {}
 
 /************************************************************************/
@@ -81,6 +87,9 @@ GDALDriver::~GDALDriver()
 {
     if( pfnUnloadDriver != nullptr )
         pfnUnloadDriver( this );
+    CSLDestroy( m_papszDeferredMetadata );
+    CSLDestroy( m_papszMergedMetadata );
+    CSLDestroy( m_papszOverriddenItems );
 }
 
 /************************************************************************/
@@ -2103,6 +2112,8 @@ GDALIdentifyDriverEx( const char* pszFilename,
     return nullptr;
 }
 
+static CPLMutex* hDeferredMetadataMutex = nullptr;
+
 /************************************************************************/
 /*                          SetMetadataItem()                           */
 /************************************************************************/
@@ -2114,12 +2125,144 @@ CPLErr GDALDriver::SetMetadataItem( const char *pszName,
 {
     if( pszDomain == nullptr || pszDomain[0] == '\0' )
     {
+        // Held by InitDeferredMetadata() while pfnInitDeferredMetadata runs,
+        // so m_bInInitDeferredMetadata is only seen set by its thread.
+        CPLMutexHolderD( &hDeferredMetadataMutex );
+        if( m_bInInitDeferredMetadata )
+        {
+            if( CSLFindString( m_papszOverriddenItems, pszName ) < 0 )
+            {
+                m_papszDeferredMetadata =
+                    CSLSetNameValue( m_papszDeferredMetadata,
+                                     pszName, pszValue );
+            }
+            return CE_None;
+        }
+
         /* Automatically sets GDAL_DMD_EXTENSIONS from GDAL_DMD_EXTENSION */
         if( EQUAL(pszName, GDAL_DMD_EXTENSION) &&
             GDALMajorObject::GetMetadataItem(GDAL_DMD_EXTENSIONS) == nullptr )
         {
             GDALMajorObject::SetMetadataItem(GDAL_DMD_EXTENSIONS, pszValue);
         }
+
+        // The new value overrides the deferred one, whether it is already
+        // set or not.
+        if( m_bDeferredMetadataInitialized )
+        {
+            m_papszDeferredMetadata =
+                CSLSetNameValue( m_papszDeferredMetadata, pszName, nullptr );
+        }
+        else if( pfnInitDeferredMetadata != nullptr &&
+                 CSLFindString( m_papszOverriddenItems, pszName ) < 0 )
+        {
+            m_papszOverriddenItems =
+                CSLAddString( m_papszOverriddenItems, pszName );
+        }
+        CSLDestroy( m_papszMergedMetadata );
+        m_papszMergedMetadata = nullptr;
+        return GDALMajorObject::SetMetadataItem(pszName, pszValue, pszDomain);
     }
     return GDALMajorObject::SetMetadataItem(pszName, pszValue, pszDomain);
 }
+
+/************************************************************************/
+/*                            SetMetadata()                             */
+/************************************************************************/
+
+CPLErr GDALDriver::SetMetadata( char **papszMetadata, const char *pszDomain )
+
+{
+    if( pszDomain == nullptr || pszDomain[0] == '\0' )
+    {
+        // Replaces the deferred items too.
+        CPLMutexHolderD( &hDeferredMetadataMutex );
+        m_bDeferredMetadataInitialized = true;
+        CSLDestroy( m_papszDeferredMetadata );
+        m_papszDeferredMetadata = nullptr;
+        CSLDestroy( m_papszMergedMetadata );
+        m_papszMergedMetadata = nullptr;
+        return GDALMajorObject::SetMetadata(papszMetadata, pszDomain);
+    }
+    return GDALMajorObject::SetMetadata(papszMetadata, pszDomain);
+}
+
+/************************************************************************/
+/*                        InitDeferredMetadata()                        */
+/************************************************************************/
+
+// Run pfnInitDeferredMetadata once. The items it sets are stored in
+// m_papszDeferredMetadata, which is only read once
+// m_bDeferredMetadataInitialized is set, so that threads reading other
+// items, such as the capabilities when probing drivers, never see the
+// main metadata list being modified.
+void GDALDriver::InitDeferredMetadata()
+{
+    if( m_bDeferredMetadataInitialized )
+        return;
+    CPLMutexHolderD( &hDeferredMetadataMutex );
+    if( !m_bDeferredMetadataInitialized )
+    {
+        m_bInInitDeferredMetadata = true;
+        pfnInitDeferredMetadata(this);
+        m_bInInitDeferredMetadata = false;
+        CSLDestroy( m_papszOverriddenItems );
+        m_papszOverriddenItems = nullptr;
+        m_bDeferredMetadataInitialized = true;
+    }
+}
+
+/************************************************************************/
+/*                            GetMetadata()                             */
+/************************************************************************/
+
+char **GDALDriver::GetMetadata( const char *pszDomain )
+
+{
+    if( pfnInitDeferredMetadata != nullptr &&
+        (pszDomain == nullptr || pszDomain[0] == '\0') )
+    {
+        InitDeferredMetadata();
+        if( m_papszDeferredMetadata != nullptr )
+        {
+            CPLMutexHolderD( &hDeferredMetadataMutex );
+            if( m_papszMergedMetadata == nullptr )
+            {
+                m_papszMergedMetadata =
+                    CSLDuplicate( GDALMajorObject::GetMetadata(pszDomain) );
+                m_papszMergedMetadata =
+                    CSLMerge( m_papszMergedMetadata, m_papszDeferredMetadata );
+            }
+            return m_papszMergedMetadata;
+        }
+    }
+    return GDALMajorObject::GetMetadata(pszDomain);
+}
+
+/************************************************************************/
+/*                          GetMetadataItem()                           */
+/************************************************************************/
+
+const char *GDALDriver::GetMetadataItem( const char *pszName,
+                                         const char *pszDomain )
+
+{
+    // Only the items listed in the pfnInitDeferredMetadata documentation
+    // trigger the initialization: the capabilities of all drivers are
+    // queried when probing them.
+    if( pfnInitDeferredMetadata != nullptr &&
+        (pszDomain == nullptr || pszDomain[0] == '\0') &&
+        (EQUAL(pszName, GDAL_DMD_CREATIONOPTIONLIST) ||
+         EQUAL(pszName, GDAL_DMD_OPENOPTIONLIST) ||
+         EQUAL(pszName, GDAL_DS_LAYER_CREATIONOPTIONLIST) ||
+         EQUAL(pszName, GDAL_DMD_CREATIONFIELDDATATYPES) ||
+         EQUAL(pszName, GDAL_DMD_CREATIONFIELDDATASUBTYPES)) )
+    {
+        InitDeferredMetadata();
+        const char* pszValue =
+            CSLFetchNameValue( m_papszDeferredMetadata, pszName );
+        if( pszValue != nullptr )
+            return pszValue;
+    }
+    return GDALMajorObject::GetMetadataItem(pszName, pszDomain);
+}
@@ -30,6 +30,7 @@
 #include "cpl_port.h"
 #include "gdal_priv.h"
 
+#include <algorithm>
 #include <cstring>
 #include <map>
 
@@ -116,7 +117,8 @@ GDALDriverManager * GetGDALDriverManager()
 
 GDALDriverManager::GDALDriverManager() :
     nDrivers(0),
-    papoDrivers(nullptr)
+    papoDrivers(nullptr),
+    bDispatchIndexValid(false)
 {
     CPLAssert( poDM == nullptr );
 
@@ -224,6 +226,11 @@ GDALDriverManager::~GDALDriverManager()
 
     delete GDALGetAPIPROXYDriver();
 
+/* -------------------------------------------------------------------- */
+/*      Stop the worker threads of the global thread pool.              */
+/* -------------------------------------------------------------------- */
+    GDALDestroyGlobalThreadPool();
+
 /* -------------------------------------------------------------------- */
 /*      Cleanup local memory.                                           */
 /* -------------------------------------------------------------------- */
@@ -481,8 +488,9 @@ int GDALDriverManager::RegisterDriver( GDALDriver * poDriver )
         poDriver->SetMetadataItem( GDAL_DCAP_RASTER, "YES" );
     }
 
-    if( poDriver->GetMetadataItem( GDAL_DMD_OPENOPTIONLIST ) != nullptr &&
-        poDriver->pfnIdentify == nullptr &&
+    // Test pfnIdentify first, so as not to trigger pfnInitDeferredMetadata.
+    if( poDriver->pfnIdentify == nullptr &&
+        poDriver->GetMetadataItem( GDAL_DMD_OPENOPTIONLIST ) != nullptr &&
         !STARTS_WITH_CI(poDriver->GetDescription(), "Interlis") )
     {
         CPLDebug( "GDAL",
@@ -493,6 +501,7 @@ int GDALDriverManager::RegisterDriver( GDALDriver * poDriver )
 
     oMapNameToDrivers[CPLString(poDriver->GetDescription()).toupper()] =
         poDriver;
+    bDispatchIndexValid = false;
 
     int iResult = nDrivers - 1;
 
@@ -548,6 +557,7 @@ void GDALDriverManager::DeregisterDriver( GDALDriver * poDriver )
         return;
 
     oMapNameToDrivers.erase(CPLString(poDriver->GetDescription()).toupper());
+    bDispatchIndexValid = false;
     --nDrivers;
     // Move all following drivers down by one to pack the list.
     while( i < nDrivers )
@@ -557,6 +567,150 @@ void GDALDriverManager::DeregisterDriver( GDALDriver * poDriver )
     }
 }
 
+/************************************************************************/
+/*                    BuildDispatchIndex_unlocked()                     */
+/************************************************************************/
+
+void GDALDriverManager::BuildDispatchIndex_unlocked()
+{
+    oMapExtensionToDrivers.clear();
+    aoMagicBytesToDriver.clear();
+
+    for( int i = 0; i < nDrivers; ++i )
+    {
+        GDALDriver* poDriver = papoDrivers[i];
+
+        const char* pszExtensions =
+            poDriver->GetMetadataItem(GDAL_DMD_EXTENSIONS);
+        if( pszExtensions == nullptr )
+            pszExtensions = poDriver->GetMetadataItem(GDAL_DMD_EXTENSION);
+        if( pszExtensions != nullptr )
+        {
+            char** papszExtensions =
+                CSLTokenizeString2(pszExtensions, " ", 0);
+            for( char** papszIter = papszExtensions;
+                 papszIter && *papszIter; ++papszIter )
+            {
+                std::vector<GDALDriver*>& apoDrivers =
+                    oMapExtensionToDrivers[CPLString(*papszIter).tolower()];
+                if( apoDrivers.empty() || apoDrivers.back() != poDriver )
+                    apoDrivers.push_back(poDriver);
+            }
+            CSLDestroy(papszExtensions);
+        }
+
+        const char* pszMagicBytes =
+            poDriver->GetMetadataItem(GDAL_DMD_MAGIC_BYTES);
+        if( pszMagicBytes != nullptr )
+        {
+            char** papszMagicBytes =
+                CSLTokenizeString2(pszMagicBytes, " ", 0);
+            for( char** papszIter = papszMagicBytes;
+                 papszIter && *papszIter; ++papszIter )
+            {
+                int nBytes = 0;
+                GByte* pabyBytes = CPLHexToBinary(*papszIter, &nBytes);
+                if( nBytes > 0 )
+                {
+                    aoMagicBytesToDriver.push_back(
+                        std::pair<CPLString, GDALDriver*>(
+                            CPLString(reinterpret_cast<const char*>(pabyBytes),
+                                      nBytes),
+                            poDriver));
+                }
+                CPLFree(pabyBytes);
+            }
+            CSLDestroy(papszMagicBytes);
+        }
+    }
+
+    bDispatchIndexValid = true;
+}
+
+/************************************************************************/
+/*                         GetDriversForOpen()                          */
+/************************************************************************/
+
+/**
+ * \brief Return the registered drivers in the order GDALOpenEx() should try
+ * them for a file.
+ *
+ * This is the registration order, unless the GDAL_OPEN_DISPATCH_INDEX
+ * configuration option is set to YES. In that case, drivers that declare the
+ * extension of the file (GDAL_DMD_EXTENSION or GDAL_DMD_EXTENSIONS), or one of
+ * the byte sequences it starts with (GDAL_DMD_MAGIC_BYTES), come first,
+ * followed by all other drivers, both groups keeping the registration order.
+ * As this may change which driver opens a file that several drivers can
+ * open, it is not the default.
+ *
+ * @param poOpenInfo the file to open.
+ * @return list of drivers.
+ */
+
+std::vector<GDALDriver*>
+GDALDriverManager::GetDriversForOpen( GDALOpenInfo* poOpenInfo )
+{
+    CPLMutexHolderD( &hDMMutex );
+
+    std::vector<GDALDriver*> apoDrivers;
+    apoDrivers.reserve(nDrivers);
+
+    if( !CPLTestBool(CPLGetConfigOption("GDAL_OPEN_DISPATCH_INDEX", "NO")) )
+    {
+        apoDrivers.insert(apoDrivers.end(), papoDrivers,
+                          papoDrivers + nDrivers);
+        return apoDrivers;
+    }
+
+    if( !bDispatchIndexValid )
+        BuildDispatchIndex_unlocked();
+
+    // Usually a handful of drivers, so a linear search is fine.
+    std::vector<GDALDriver*> apoCandidates;
+    const CPLString osExtension(
+        CPLString(CPLGetExtension(poOpenInfo->pszFilename)).tolower());
+    if( !osExtension.empty() )
+    {
+        auto oIter = oMapExtensionToDrivers.find(osExtension);
+        if( oIter != oMapExtensionToDrivers.end() )
+            apoCandidates = oIter->second;
+    }
+    for( const auto& oMagicBytes : aoMagicBytesToDriver )
+    {
+        if( oMagicBytes.first.size() <=
+                static_cast<size_t>(poOpenInfo->nHeaderBytes) &&
+            memcmp(poOpenInfo->pabyHeader, oMagicBytes.first.data(),
+                   oMagicBytes.first.size()) == 0 )
+        {
+            apoCandidates.push_back(oMagicBytes.second);
+        }
+    }
+
+    if( apoCandidates.empty() )
+    {
+        apoDrivers.insert(apoDrivers.end(), papoDrivers,
+                          papoDrivers + nDrivers);
+        return apoDrivers;
+    }
+
+    const auto IsCandidate = [&apoCandidates](GDALDriver* poDriver)
+    {
+        return std::find(apoCandidates.begin(), apoCandidates.end(),
+                         poDriver) != apoCandidates.end();
+    };
+    for( int i = 0; i < nDrivers; ++i )
+    {
+        if( IsCandidate(papoDrivers[i]) )
+            apoDrivers.push_back(papoDrivers[i]);
+    }
+    for( int i = 0; i < nDrivers; ++i )
+    {
+        if( !IsCandidate(papoDrivers[i]) )
+            apoDrivers.push_back(papoDrivers[i]);
+    }
+    return apoDrivers;
+}
+
 /************************************************************************/
 /*                        GDALDeregisterDriver()                        */
 /************************************************************************/
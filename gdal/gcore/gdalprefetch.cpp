@@ -0,0 +1,710 @@
+/******************************************************************************
+ *
+ * Project:  GDAL Core
+ * Purpose:  Asynchronous read-ahead of raster blocks
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cpl_port.h"
+#include "gdal_priv.h"
+
+#include <cstring>
+#include <algorithm>
+#include <list>
+#include <map>
+#include <new>
+#include <vector>
+
+#include "cpl_conv.h"
+#include "cpl_error.h"
+#include "cpl_multiproc.h"
+#include "cpl_string.h"
+#include "cpl_worker_thread_pool.h"
+
+//! @cond Doxygen_Suppress
+
+CPL_CVSID("$Id$")
+
+// The prefetcher is enabled by setting the GDAL_PREFETCH_NUM_THREADS
+// configuration option to a number of threads greater than 1 or ALL_CPUS. It
+// is attached to datasets returned by GDALOpenEx() in read-only mode, and
+// reads blocks with its own handles on the same file, so that the dataset
+// keeps being used by a single thread. The reads are jobs of the global
+// thread pool, at most GDAL_PREFETCH_NUM_THREADS of them at a time for a
+// dataset.
+//
+// Blocks are scheduled either by GDALRasterBand::AdviseRead(), or when
+// GDALRasterBand::GetLockedBlockRef() detects that consecutive blocks are
+// missing from the block cache, in which case GDAL_PREFETCH_BLOCKS blocks
+// (by default the largest of a row of blocks and twice the number of threads)
+// are read ahead. Prefetched blocks are kept in a buffer limited to a quarter
+// of the block cache size, and moved to the block cache when requested.
+
+namespace {
+
+typedef enum
+{
+    PREFETCH_PENDING,
+    PREFETCH_READY,
+    PREFETCH_FAILED
+} GDALPrefetchState;
+
+struct GDALPrefetchRequest
+{
+    int              nXBlockOff;
+    int              nYBlockOff;
+    std::vector<int> anBands;
+};
+
+struct GDALPrefetchedBlock
+{
+    GDALPrefetchState eState;
+    GByte            *pabyData;
+    size_t            nSize;
+    // Position in anFinishedBlocks once the block is no longer pending.
+    std::list<GIntBig>::iterator oFinishedIter;
+};
+
+struct GDALPrefetchSequence
+{
+    GIntBig nLastBlock;
+    GIntBig nScheduledUpTo;
+    int     nRun;
+};
+
+} // namespace
+
+/************************************************************************/
+/*                     GDALBlockPrefetcher::Private                     */
+/************************************************************************/
+
+class GDALBlockPrefetcher::Private
+{
+  public:
+    CPLString             osFilename;
+    CPLString             osDriverName;
+    char                **papszOpenOptions;
+    unsigned int          nOpenFlags;
+
+    int                   nRasterXSize;
+    int                   nRasterYSize;
+    int                   nBands;
+    int                   nBlockXSize;
+    int                   nBlockYSize;
+    int                   nBlocksPerRow;
+    int                   nBlocksPerColumn;
+    std::vector<GDALDataType> aeDataTypes;
+    bool                  bPixelInterleaved;
+
+    int                   nThreads;
+    int                   nReadAhead;
+    GIntBig               nMaxMemory;
+
+    // Only used by the thread owning the dataset.
+    std::vector<GDALRasterBand*> apoBands;
+    std::vector<GDALPrefetchSequence> asSequences;
+    CPLJobQueue          *poJobQueue;
+
+    // Protected by hMutex.
+    CPLMutex             *hMutex;
+    CPLCond              *hCond;
+    std::list<GDALPrefetchRequest> aoQueue;
+    std::map<GIntBig, GDALPrefetchedBlock> oMapBlocks;
+    // Keys of the READY/FAILED blocks of oMapBlocks, oldest first. A block
+    // leaves the list when it leaves the map, so the list never holds more
+    // entries than the map.
+    std::list<GIntBig>    anFinishedBlocks;
+    std::vector<GDALDataset*> apoFreeClones;
+    GIntBig               nUsedMemory;
+    // Number of jobs submitted to the thread pool and not finished.
+    int                   nRunningJobs;
+    // Statistics reported when the prefetcher is destroyed.
+    int                   nPrefetchedBlocks;
+    int                   nFetchedBlocks;
+    bool                  bStopping;
+    bool                  bBroken;
+
+    Private() :
+        papszOpenOptions(nullptr),
+        nOpenFlags(0),
+        nRasterXSize(0),
+        nRasterYSize(0),
+        nBands(0),
+        nBlockXSize(0),
+        nBlockYSize(0),
+        nBlocksPerRow(0),
+        nBlocksPerColumn(0),
+        bPixelInterleaved(false),
+        nThreads(0),
+        nReadAhead(0),
+        nMaxMemory(0),
+        poJobQueue(nullptr),
+        hMutex(nullptr),
+        hCond(nullptr),
+        nUsedMemory(0),
+        nRunningJobs(0),
+        nPrefetchedBlocks(0),
+        nFetchedBlocks(0),
+        bStopping(false),
+        bBroken(false)
+        {}
+
+    GIntBig GetKey( int nBand, int nXBlockOff, int nYBlockOff ) const
+    {
+        return (static_cast<GIntBig>(nBand - 1) * nBlocksPerColumn +
+                nYBlockOff) * nBlocksPerRow + nXBlockOff;
+    }
+
+    size_t GetBlockSize( int nBand ) const
+    {
+        return static_cast<size_t>(nBlockXSize) * nBlockYSize *
+               GDALGetDataTypeSizeBytes(aeDataTypes[nBand - 1]);
+    }
+
+    void  EvictFinishedBlocks( GIntBig nNeeded );
+    void  FinishRequest( const GDALPrefetchRequest& oRequest,
+                         const std::vector<GByte*>& apabyData );
+
+    CPL_DISALLOW_COPY_ASSIGN(Private)
+};
+
+/************************************************************************/
+/*                        EvictFinishedBlocks()                         */
+/************************************************************************/
+
+// Must be called with hMutex held.
+void GDALBlockPrefetcher::Private::EvictFinishedBlocks( GIntBig nNeeded )
+{
+    while( nUsedMemory + nNeeded > nMaxMemory && !anFinishedBlocks.empty() )
+    {
+        const GIntBig nKey = anFinishedBlocks.front();
+        anFinishedBlocks.pop_front();
+        std::map<GIntBig, GDALPrefetchedBlock>::iterator oIter =
+            oMapBlocks.find(nKey);
+        if( oIter == oMapBlocks.end() )
+            continue;
+        CPLAssert( oIter->second.eState != PREFETCH_PENDING );
+        VSIFree(oIter->second.pabyData);
+        nUsedMemory -= oIter->second.nSize;
+        oMapBlocks.erase(oIter);
+    }
+}
+
+/************************************************************************/
+/*                           FinishRequest()                            */
+/************************************************************************/
+
+// Must be called with hMutex held. apabyData[i] is the content of the block
+// of band oRequest.anBands[i], or nullptr if it could not be read.
+void GDALBlockPrefetcher::Private::FinishRequest(
+    const GDALPrefetchRequest& oRequest, const std::vector<GByte*>& apabyData )
+{
+    for( size_t i = 0; i < oRequest.anBands.size(); ++i )
+    {
+        const GIntBig nKey = GetKey(oRequest.anBands[i],
+                                    oRequest.nXBlockOff,
+                                    oRequest.nYBlockOff);
+        GDALPrefetchedBlock& sBlock = oMapBlocks[nKey];
+        sBlock.pabyData = apabyData[i];
+        sBlock.eState = apabyData[i] ? PREFETCH_READY : PREFETCH_FAILED;
+        sBlock.oFinishedIter = anFinishedBlocks.insert(
+            anFinishedBlocks.end(), nKey);
+        if( apabyData[i] )
+            nPrefetchedBlocks++;
+    }
+}
+
+/************************************************************************/
+/*                        GDALBlockPrefetcher()                         */
+/************************************************************************/
+
+GDALBlockPrefetcher::GDALBlockPrefetcher( GDALDataset* poDS,
+                                          unsigned int nOpenFlags,
+                                          int nThreads ) :
+    m_poPrivate(new Private())
+{
+    m_poPrivate->osFilename = poDS->GetDescription();
+    m_poPrivate->osDriverName = poDS->GetDriver()->GetDescription();
+    m_poPrivate->papszOpenOptions = CSLDuplicate(poDS->GetOpenOptions());
+    // The clones are not visible to the user and must not be shared.
+    m_poPrivate->nOpenFlags =
+        (nOpenFlags & ~(GDAL_OF_SHARED | GDAL_OF_VERBOSE_ERROR)) |
+        GDAL_OF_INTERNAL;
+
+    m_poPrivate->nRasterXSize = poDS->GetRasterXSize();
+    m_poPrivate->nRasterYSize = poDS->GetRasterYSize();
+    m_poPrivate->nBands = poDS->GetRasterCount();
+    GDALRasterBand* poFirstBand = poDS->GetRasterBand(1);
+    poFirstBand->GetBlockSize(&m_poPrivate->nBlockXSize,
+                              &m_poPrivate->nBlockYSize);
+    m_poPrivate->nBlocksPerRow =
+        DIV_ROUND_UP(m_poPrivate->nRasterXSize, m_poPrivate->nBlockXSize);
+    m_poPrivate->nBlocksPerColumn =
+        DIV_ROUND_UP(m_poPrivate->nRasterYSize, m_poPrivate->nBlockYSize);
+    for( int i = 1; i <= m_poPrivate->nBands; ++i )
+    {
+        GDALRasterBand* poBand = poDS->GetRasterBand(i);
+        m_poPrivate->apoBands.push_back(poBand);
+        m_poPrivate->aeDataTypes.push_back(poBand->GetRasterDataType());
+        GDALPrefetchSequence sSequence;
+        sSequence.nLastBlock = -2;
+        sSequence.nScheduledUpTo = -1;
+        sSequence.nRun = 0;
+        m_poPrivate->asSequences.push_back(sSequence);
+    }
+
+    // When pixels are interleaved, reading a block of a band reads the
+    // blocks of the other bands at the same place, so prefetch them together.
+    const char* pszInterleave =
+        poDS->GetMetadataItem("INTERLEAVE", "IMAGE_STRUCTURE");
+    m_poPrivate->bPixelInterleaved =
+        m_poPrivate->nBands > 1 &&
+        pszInterleave != nullptr && EQUAL(pszInterleave, "PIXEL");
+
+    m_poPrivate->nThreads = nThreads;
+    m_poPrivate->nReadAhead = atoi(CPLGetConfigOption(
+        "GDAL_PREFETCH_BLOCKS",
+        CPLSPrintf("%d", std::max(2 * nThreads,
+                                  m_poPrivate->nBlocksPerRow))));
+    m_poPrivate->nMaxMemory = GDALGetCacheMax64() / 4;
+
+    m_poPrivate->hMutex = CPLCreateMutex();
+    if( m_poPrivate->hMutex )
+        CPLReleaseMutex(m_poPrivate->hMutex);
+    m_poPrivate->hCond = CPLCreateCond();
+
+    // nullptr if called from a worker thread of the pool.
+    CPLWorkerThreadPool* poThreadPool = GDALGetGlobalThreadPool(nThreads);
+    if( poThreadPool != nullptr )
+        m_poPrivate->poJobQueue = new (std::nothrow) CPLJobQueue(poThreadPool);
+
+    if( m_poPrivate->hMutex == nullptr || m_poPrivate->hCond == nullptr ||
+        m_poPrivate->poJobQueue == nullptr )
+        m_poPrivate->bBroken = true;
+}
+
+/************************************************************************/
+/*                       ~GDALBlockPrefetcher()                         */
+/************************************************************************/
+
+GDALBlockPrefetcher::~GDALBlockPrefetcher()
+{
+    if( m_poPrivate->hMutex )
+    {
+        CPLMutexHolderD(&m_poPrivate->hMutex);
+        m_poPrivate->bStopping = true;
+    }
+
+    // Pending requests are discarded by the workers.
+    if( m_poPrivate->poJobQueue )
+    {
+        m_poPrivate->poJobQueue->WaitCompletion();
+        delete m_poPrivate->poJobQueue;
+
+        CPLDebug("GDAL", "Block prefetching of %s: %d blocks prefetched, "
+                 "%d of them used",
+                 m_poPrivate->osFilename.c_str(),
+                 m_poPrivate->nPrefetchedBlocks,
+                 m_poPrivate->nFetchedBlocks);
+    }
+
+    for( size_t i = 0; i < m_poPrivate->apoFreeClones.size(); ++i )
+        GDALClose(m_poPrivate->apoFreeClones[i]);
+
+    std::map<GIntBig, GDALPrefetchedBlock>::iterator oIter =
+        m_poPrivate->oMapBlocks.begin();
+    for( ; oIter != m_poPrivate->oMapBlocks.end(); ++oIter )
+        VSIFree(oIter->second.pabyData);
+
+    if( m_poPrivate->hCond )
+        CPLDestroyCond(m_poPrivate->hCond);
+    if( m_poPrivate->hMutex )
+        CPLDestroyMutex(m_poPrivate->hMutex);
+    CSLDestroy(m_poPrivate->papszOpenOptions);
+    delete m_poPrivate;
+}
+
+/************************************************************************/
+/*                               Create()                               */
+/************************************************************************/
+
+// Returns a prefetcher for a dataset if GDAL_PREFETCH_NUM_THREADS asks for
+// it and the dataset can be reopened, or nullptr.
+GDALBlockPrefetcher* GDALBlockPrefetcher::Create( GDALDataset* poDS,
+                                                  unsigned int nOpenFlags )
+{
+    const int nThreads = GDALGetNumThreads("GDAL_PREFETCH_NUM_THREADS");
+    if( nThreads <= 1 )
+        return nullptr;
+
+    if( poDS->GetDriver() == nullptr || EQUAL(poDS->GetDescription(), "") ||
+        poDS->GetRasterCount() == 0 )
+        return nullptr;
+
+    int nBlockXSize = 0;
+    int nBlockYSize = 0;
+    poDS->GetRasterBand(1)->GetBlockSize(&nBlockXSize, &nBlockYSize);
+    if( nBlockXSize <= 0 || nBlockYSize <= 0 )
+        return nullptr;
+    for( int i = 2; i <= poDS->GetRasterCount(); ++i )
+    {
+        int nThisBlockXSize = 0;
+        int nThisBlockYSize = 0;
+        poDS->GetRasterBand(i)->GetBlockSize(&nThisBlockXSize,
+                                             &nThisBlockYSize);
+        if( nThisBlockXSize != nBlockXSize || nThisBlockYSize != nBlockYSize )
+            return nullptr;
+    }
+
+    GDALBlockPrefetcher* poPrefetcher =
+        new (std::nothrow) GDALBlockPrefetcher(poDS, nOpenFlags, nThreads);
+    if( poPrefetcher != nullptr && poPrefetcher->m_poPrivate->bBroken )
+    {
+        delete poPrefetcher;
+        return nullptr;
+    }
+    if( poPrefetcher != nullptr )
+    {
+        CPLDebug("GDAL", "Using %d threads for block prefetching of %s",
+                 nThreads, poDS->GetDescription());
+    }
+    return poPrefetcher;
+}
+
+/************************************************************************/
+/*                              OpenClone()                             */
+/************************************************************************/
+
+// Called from a worker thread.
+GDALDataset* GDALBlockPrefetcher::OpenClone()
+{
+    const char* const apszAllowedDrivers[] =
+        { m_poPrivate->osDriverName.c_str(), nullptr };
+    GDALDataset* poClone = GDALDataset::Open(
+        m_poPrivate->osFilename, m_poPrivate->nOpenFlags, apszAllowedDrivers,
+        m_poPrivate->papszOpenOptions, nullptr);
+    if( poClone == nullptr )
+        return nullptr;
+
+    // Check that the dataset we get is the same as the original one.
+    bool bOK = poClone->GetRasterXSize() == m_poPrivate->nRasterXSize &&
+               poClone->GetRasterYSize() == m_poPrivate->nRasterYSize &&
+               poClone->GetRasterCount() == m_poPrivate->nBands;
+    for( int i = 1; bOK && i <= m_poPrivate->nBands; ++i )
+    {
+        GDALRasterBand* poBand = poClone->GetRasterBand(i);
+        int nBlockXSize = 0;
+        int nBlockYSize = 0;
+        poBand->GetBlockSize(&nBlockXSize, &nBlockYSize);
+        bOK = nBlockXSize == m_poPrivate->nBlockXSize &&
+              nBlockYSize == m_poPrivate->nBlockYSize &&
+              poBand->GetRasterDataType() == m_poPrivate->aeDataTypes[i - 1];
+    }
+    if( !bOK )
+    {
+        CPLDebug("GDAL", "Cannot prefetch blocks of %s: "
+                 "reopened dataset does not match",
+                 m_poPrivate->osFilename.c_str());
+        GDALClose(poClone);
+        return nullptr;
+    }
+    return poClone;
+}
+
+/************************************************************************/
+/*                         ProcessRequestFunc()                         */
+/************************************************************************/
+
+void GDALBlockPrefetcher::ProcessRequestFunc( void* pData )
+{
+    static_cast<GDALBlockPrefetcher*>(pData)->ProcessRequest();
+}
+
+/************************************************************************/
+/*                           ProcessRequest()                           */
+/************************************************************************/
+
+// Called from a worker thread: read the queued requests, oldest first, with
+// a clone of the dataset, until the queue is empty.
+void GDALBlockPrefetcher::ProcessRequest()
+{
+    while( true )
+    {
+        GDALPrefetchRequest oRequest;
+        GDALDataset* poClone = nullptr;
+        bool bDiscard = false;
+        {
+            CPLMutexHolderD(&m_poPrivate->hMutex);
+            if( m_poPrivate->aoQueue.empty() )
+            {
+                m_poPrivate->nRunningJobs--;
+                return;
+            }
+            oRequest = m_poPrivate->aoQueue.front();
+            m_poPrivate->aoQueue.pop_front();
+            bDiscard = m_poPrivate->bStopping || m_poPrivate->bBroken;
+            if( !bDiscard && !m_poPrivate->apoFreeClones.empty() )
+            {
+                poClone = m_poPrivate->apoFreeClones.back();
+                m_poPrivate->apoFreeClones.pop_back();
+            }
+        }
+
+        // Errors are reported by the regular read of the block, if it is
+        // requested.
+        CPLPushErrorHandler(CPLQuietErrorHandler);
+        if( !bDiscard && poClone == nullptr )
+            poClone = OpenClone();
+
+        std::vector<GByte*> apabyData(oRequest.anBands.size(), nullptr);
+        if( poClone != nullptr )
+        {
+            for( size_t i = 0; i < oRequest.anBands.size(); ++i )
+            {
+                const int nBand = oRequest.anBands[i];
+                GDALRasterBlock* poBlock =
+                    poClone->GetRasterBand(nBand)->GetLockedBlockRef(
+                        oRequest.nXBlockOff, oRequest.nYBlockOff);
+                if( poBlock == nullptr )
+                    continue;
+                const size_t nSize = m_poPrivate->GetBlockSize(nBand);
+                apabyData[i] = static_cast<GByte*>(VSI_MALLOC_VERBOSE(nSize));
+                if( apabyData[i] )
+                    memcpy(apabyData[i], poBlock->GetDataRef(), nSize);
+                poBlock->DropLock();
+            }
+
+            // The blocks now belong to the original dataset.
+            for( size_t i = 0; i < oRequest.anBands.size(); ++i )
+            {
+                poClone->GetRasterBand(oRequest.anBands[i])->FlushBlock(
+                    oRequest.nXBlockOff, oRequest.nYBlockOff, FALSE);
+            }
+        }
+        CPLPopErrorHandler();
+
+        CPLMutexHolderD(&m_poPrivate->hMutex);
+        m_poPrivate->FinishRequest(oRequest, apabyData);
+        if( poClone != nullptr )
+            m_poPrivate->apoFreeClones.push_back(poClone);
+        else if( !bDiscard )
+            m_poPrivate->bBroken = true;
+        CPLCondBroadcast(m_poPrivate->hCond);
+    }
+}
+
+/************************************************************************/
+/*                              Schedule()                              */
+/************************************************************************/
+
+// Queue the reading of a block (and of the blocks of the other bands at the
+// same place when pixels are interleaved). Returns false if it could not be
+// done, because the prefetch buffer is full.
+bool GDALBlockPrefetcher::Schedule( int nBand, int nXBlockOff, int nYBlockOff )
+{
+    GDALPrefetchRequest oRequest;
+    oRequest.nXBlockOff = nXBlockOff;
+    oRequest.nYBlockOff = nYBlockOff;
+    bool bRet = true;
+    {
+        CPLMutexHolderD(&m_poPrivate->hMutex);
+        if( m_poPrivate->bBroken )
+            return false;
+
+        const int nFirstBand = m_poPrivate->bPixelInterleaved ? 1 : nBand;
+        const int nLastBand =
+            m_poPrivate->bPixelInterleaved ? m_poPrivate->nBands : nBand;
+        for( int iBand = nFirstBand; iBand <= nLastBand; ++iBand )
+        {
+            const GIntBig nKey =
+                m_poPrivate->GetKey(iBand, nXBlockOff, nYBlockOff);
+            if( m_poPrivate->oMapBlocks.find(nKey) !=
+                                            m_poPrivate->oMapBlocks.end() )
+                continue;
+
+            GDALRasterBlock* poBlock =
+                m_poPrivate->apoBands[iBand - 1]->TryGetLockedBlockRef(
+                    nXBlockOff, nYBlockOff);
+            if( poBlock != nullptr )
+            {
+                poBlock->DropLock();
+                continue;
+            }
+
+            const size_t nSize = m_poPrivate->GetBlockSize(iBand);
+            m_poPrivate->EvictFinishedBlocks(nSize);
+            if( m_poPrivate->nUsedMemory + static_cast<GIntBig>(nSize) >
+                                                    m_poPrivate->nMaxMemory )
+            {
+                bRet = false;
+                break;
+            }
+            GDALPrefetchedBlock sBlock;
+            sBlock.eState = PREFETCH_PENDING;
+            sBlock.pabyData = nullptr;
+            sBlock.nSize = nSize;
+            m_poPrivate->oMapBlocks[nKey] = sBlock;
+            m_poPrivate->nUsedMemory += nSize;
+            oRequest.anBands.push_back(iBand);
+        }
+        if( oRequest.anBands.empty() )
+            return bRet;
+        m_poPrivate->aoQueue.push_back(oRequest);
+
+        // The running jobs process the whole queue, so only start a new one
+        // if there are less than nThreads of them.
+        if( m_poPrivate->nRunningJobs >= m_poPrivate->nThreads )
+            return bRet;
+        m_poPrivate->nRunningJobs++;
+    }
+
+    if( !m_poPrivate->poJobQueue->SubmitJob(ProcessRequestFunc, this) )
+    {
+        CPLMutexHolderD(&m_poPrivate->hMutex);
+        m_poPrivate->nRunningJobs--;
+        m_poPrivate->bBroken = true;
+        // Nobody would process the queue: fail its blocks, so that
+        // FetchBlock() does not wait for them.
+        if( m_poPrivate->nRunningJobs == 0 )
+        {
+            while( !m_poPrivate->aoQueue.empty() )
+            {
+                const GDALPrefetchRequest& oQueued =
+                    m_poPrivate->aoQueue.front();
+                m_poPrivate->FinishRequest(
+                    oQueued,
+                    std::vector<GByte*>(oQueued.anBands.size(), nullptr));
+                m_poPrivate->aoQueue.pop_front();
+            }
+            CPLCondBroadcast(m_poPrivate->hCond);
+        }
+        return false;
+    }
+    return bRet;
+}
+
+/************************************************************************/
+/*                          NotifyBlockMiss()                           */
+/************************************************************************/
+
+// Called by GDALRasterBand::GetLockedBlockRef() when a block must be read.
+// After two consecutive blocks in raster order, read the next ones ahead.
+void GDALBlockPrefetcher::NotifyBlockMiss( int nBand, int nXBlockOff,
+                                           int nYBlockOff )
+{
+    GDALPrefetchSequence& sSequence = m_poPrivate->asSequences[nBand - 1];
+    const GIntBig nBlock =
+        static_cast<GIntBig>(nYBlockOff) * m_poPrivate->nBlocksPerRow +
+        nXBlockOff;
+    if( nBlock == sSequence.nLastBlock + 1 )
+    {
+        sSequence.nRun++;
+    }
+    else
+    {
+        sSequence.nRun = 0;
+        sSequence.nScheduledUpTo = nBlock;
+    }
+    sSequence.nLastBlock = nBlock;
+    if( sSequence.nRun == 0 )
+        return;
+
+    const GIntBig nLastBlock = std::min(
+        nBlock + m_poPrivate->nReadAhead,
+        static_cast<GIntBig>(m_poPrivate->nBlocksPerRow) *
+            m_poPrivate->nBlocksPerColumn - 1);
+    for( GIntBig i = std::max(sSequence.nScheduledUpTo, nBlock) + 1;
+         i <= nLastBlock; ++i )
+    {
+        if( !Schedule(nBand,
+                      static_cast<int>(i % m_poPrivate->nBlocksPerRow),
+                      static_cast<int>(i / m_poPrivate->nBlocksPerRow)) )
+        {
+            break;
+        }
+        sSequence.nScheduledUpTo = i;
+    }
+}
+
+/************************************************************************/
+/*                            AdviseWindow()                            */
+/************************************************************************/
+
+// Called by GDALRasterBand::AdviseRead(): read the blocks intersecting the
+// window, in raster order, as long as the prefetch buffer is not full.
+void GDALBlockPrefetcher::AdviseWindow( int nBand, int nXOff, int nYOff,
+                                        int nXSize, int nYSize )
+{
+    if( nXOff < 0 || nYOff < 0 || nXSize <= 0 || nYSize <= 0 ||
+        nXOff > m_poPrivate->nRasterXSize - nXSize ||
+        nYOff > m_poPrivate->nRasterYSize - nYSize )
+        return;
+
+    const int nXBlockStart = nXOff / m_poPrivate->nBlockXSize;
+    const int nXBlockEnd = (nXOff + nXSize - 1) / m_poPrivate->nBlockXSize;
+    const int nYBlockStart = nYOff / m_poPrivate->nBlockYSize;
+    const int nYBlockEnd = (nYOff + nYSize - 1) / m_poPrivate->nBlockYSize;
+    for( int iY = nYBlockStart; iY <= nYBlockEnd; ++iY )
+    {
+        for( int iX = nXBlockStart; iX <= nXBlockEnd; ++iX )
+        {
+            if( !Schedule(nBand, iX, iY) )
+                return;
+        }
+    }
+}
+
+/************************************************************************/
+/*                             FetchBlock()                             */
+/************************************************************************/
+
+// Copy a prefetched block into pData, waiting for it if it is being read.
+// Returns false if the block was not prefetched, or could not be read.
+bool GDALBlockPrefetcher::FetchBlock( int nBand, int nXBlockOff,
+                                      int nYBlockOff, void* pData )
+{
+    CPLMutexHolderD(&m_poPrivate->hMutex);
+    std::map<GIntBig, GDALPrefetchedBlock>::iterator oIter =
+        m_poPrivate->oMapBlocks.find(
+            m_poPrivate->GetKey(nBand, nXBlockOff, nYBlockOff));
+    if( oIter == m_poPrivate->oMapBlocks.end() )
+        return false;
+
+    // Only this thread removes blocks from the map, so oIter remains valid.
+    while( oIter->second.eState == PREFETCH_PENDING )
+        CPLCondWait(m_poPrivate->hCond, m_poPrivate->hMutex);
+
+    const bool bRet = oIter->second.eState == PREFETCH_READY;
+    if( bRet )
+    {
+        memcpy(pData, oIter->second.pabyData, oIter->second.nSize);
+        m_poPrivate->nFetchedBlocks++;
+    }
+    VSIFree(oIter->second.pabyData);
+    m_poPrivate->nUsedMemory -= oIter->second.nSize;
+    m_poPrivate->anFinishedBlocks.erase(oIter->second.oFinishedIter);
+    m_poPrivate->oMapBlocks.erase(oIter);
+    return bRet;
+}
+
+//! @endcond
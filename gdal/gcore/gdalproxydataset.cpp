@@ -369,6 +369,19 @@ RB_PROXY_METHOD_WITH_RET(CPLErr, CE_Failure, ComputeStatistics,
                         double *pdfMean, double *pdfStdDev,
                         GDALProgressFunc pfn, void *pProgressData ),
                         ( bApproxOK, pdfMin, pdfMax, pdfMean, pdfStdDev, pfn, pProgressData))
+RB_PROXY_METHOD_WITH_RET(CPLErr, CE_Failure, ComputeStatisticsAndHistogram,
+                        ( int bApproxOK,
+                        double *pdfMin, double *pdfMax,
+                        double *pdfMean, double *pdfStdDev,
+                        double *pdfHistMin, double *pdfHistMax,
+                        int nBuckets, GUIntBig *panHistogram,
+                        int nPercentiles, const double *padfPercentiles,
+                        double *padfPercentileValues,
+                        GDALProgressFunc pfn, void *pProgressData ),
+                        ( bApproxOK, pdfMin, pdfMax, pdfMean, pdfStdDev,
+                          pdfHistMin, pdfHistMax, nBuckets, panHistogram,
+                          nPercentiles, padfPercentiles, padfPercentileValues,
+                          pfn, pProgressData))
 RB_PROXY_METHOD_WITH_RET(CPLErr, CE_Failure, SetStatistics,
                         ( double dfMin, double dfMax,
                         double dfMean, double dfStdDev ),
@@ -41,6 +41,7 @@
 #include <algorithm>
 #include <limits>
 #include <new>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
@@ -48,10 +49,16 @@
 #include "cpl_string.h"
 #include "cpl_virtualmem.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 #include "gdal_rat.h"
 #include "gdal_priv_templates.hpp"
 
+#if (defined(__x86_64__) || defined(_M_X64)) && (defined(__GNUC__) || defined(_MSC_VER))
+#define GDAL_STATS_SSE2
+#include <emmintrin.h>
+#endif
+
 CPL_CVSID("$Id$")
 
 /************************************************************************/
@@ -277,6 +284,11 @@ GDALRasterBand::~GDALRasterBand()
  * to override the default resampling to one of BILINEAR, CUBIC, CUBICSPLINE,
  * LANCZOS, AVERAGE or MODE.
  *
+ * Starting with GDAL 2.3, when a read is done with a resampling other than
+ * nearest neighbour, and the GDAL_NUM_THREADS configuration option is set to
+ * a value greater than 1 (or ALL_CPUS), the resampling is done by worker
+ * threads, while the calling thread reads the source data.
+ *
  * @return CE_Failure if the access fails, otherwise CE_None.
  */
 
@@ -1331,10 +1343,29 @@ GDALRasterBlock * GDALRasterBand::GetLockedBlockRef( int nXBlockOff,
 
         if( !bJustInitialize )
         {
+            // Take the block from the read-ahead buffer of the dataset, if
+            // any.
+            GDALBlockPrefetcher* poPrefetcher =
+                poDS != nullptr && nBand >= 1 &&
+                nBand <= poDS->GetRasterCount() &&
+                poDS->GetRasterBand(nBand) == this ?
+                    poDS->GetBlockPrefetcher() : nullptr;
+            bool bPrefetched = false;
+            if( poPrefetcher != nullptr )
+            {
+                poPrefetcher->NotifyBlockMiss(nBand, nXBlockOff, nYBlockOff);
+                bPrefetched = poPrefetcher->FetchBlock(
+                    nBand, nXBlockOff, nYBlockOff, poBlock->GetDataRef());
+            }
+
             const GUInt32 nErrorCounter = CPLGetErrorCounter();
-            int bCallLeaveReadWrite = EnterReadWrite(GF_Read);
-            eErr = IReadBlock(nXBlockOff,nYBlockOff,poBlock->GetDataRef());
-            if( bCallLeaveReadWrite) LeaveReadWrite();
+            if( !bPrefetched )
+            {
+                int bCallLeaveReadWrite = EnterReadWrite(GF_Read);
+                eErr = IReadBlock(nXBlockOff,nYBlockOff,
+                                  poBlock->GetDataRef());
+                if( bCallLeaveReadWrite) LeaveReadWrite();
+            }
             if( eErr != CE_None )
             {
                 poBlock->DropLock();
@@ -2867,186 +2898,1287 @@ GDALDatasetH CPL_STDCALL GDALGetBandDataset( GDALRasterBandH hBand )
 }
 
 /************************************************************************/
-/*                            GetHistogram()                            */
+/*                    Block based statistics engine                     */
 /************************************************************************/
 
-/**
- * \brief Compute raster histogram.
- *
- * Note that the bucket size is (dfMax-dfMin) / nBuckets.
- *
- * For example to compute a simple 256 entry histogram of eight bit data,
- * the following would be suitable.  The unusual bounds are to ensure that
- * bucket boundaries don't fall right on integer values causing possible errors
- * due to rounding after scaling.
-<pre>
-    GUIntBig anHistogram[256];
+// GetHistogram(), ComputeStatistics() and ComputeRasterMinMax() process the
+// sampled blocks of the band with GDALStatsProcessBlocks(). The blocks are
+// read by the calling thread, and processed, possibly by the threads of a
+// pool if GDAL_NUM_THREADS is set, into per-block results that are then
+// merged by the calling thread in the order of the blocks, so that the
+// results do not depend on the number of threads.
 
-    poBand->GetHistogram( -0.5, 255.5, 256, anHistogram, FALSE, FALSE,
-                          GDALDummyProgress, nullptr );
-</pre>
- *
- * Note that setting bApproxOK will generally result in a subsampling of the
- * file, and will utilize overviews if available.  It should generally
- * produce a representative histogram for the data that is suitable for use
- * in generating histogram based luts for instance.  Generally bApproxOK is
- * much faster than an exactly computed histogram.
- *
- * This method is the same as the C functions GDALGetRasterHistogram() and
- * GDALGetRasterHistogramEx().
- *
- * @param dfMin the lower bound of the histogram.
- * @param dfMax the upper bound of the histogram.
- * @param nBuckets the number of buckets in panHistogram.
- * @param panHistogram array into which the histogram totals are placed.
- * @param bIncludeOutOfRange if TRUE values below the histogram range will
- * mapped into panHistogram[0], and values above will be mapped into
- * panHistogram[nBuckets-1] otherwise out of range values are discarded.
- * @param bApproxOK TRUE if an approximate, or incomplete histogram OK.
- * @param pfnProgress function to report progress to completion.
- * @param pProgressData application data to pass to pfnProgress.
- *
- * @return CE_None on success, or CE_Failure if something goes wrong.
- */
+namespace {
 
-CPLErr GDALRasterBand::GetHistogram( double dfMin, double dfMax,
-                                     int nBuckets, GUIntBig *panHistogram,
-                                     int bIncludeOutOfRange, int bApproxOK,
-                                     GDALProgressFunc pfnProgress,
-                                     void *pProgressData )
+// What is computed on each block.
+enum GDALStatsMode
+{
+    GSM_MINMAX,     // Minimum and maximum.
+    GSM_MOMENTS,    // Minimum, maximum, mean and sum of squared differences.
+    GSM_HISTOGRAM,  // Histogram.
+    GSM_INTEGRAL,   // Integer min, max, sum, sum of squares (Byte, UInt16).
+    GSM_MULTI       // GSM_MOMENTS or GSM_INTEGRAL, and optionally histogram
+                    // and quantile digest.
+};
 
+// Centroid of a quantile digest.
+struct GDALStatsCentroid
 {
-    CPLAssert( nullptr != panHistogram );
+    double dfMean;
+    double dfWeight;
+};
 
-    if( pfnProgress == nullptr )
-        pfnProgress = GDALDummyProgress;
+// Settings shared by all blocks.
+struct GDALStatsContext
+{
+    GDALStatsMode eMode;
+    GDALDataType  eDataType;
+    int           nBlockXSize;
+    bool          bSignedByte;
+    bool          bGotNoDataValue;  // Ignored for Float32.
+    double        dfNoDataValue;
+    bool          bGotFloatNoDataValue;  // Float32 only.
+    float         fNoDataValue;
+    bool          bComplexMagnitude;  // Otherwise use the real part.
+
+    // GSM_HISTOGRAM
+    double        dfHistMin;
+    double        dfHistScale;
+    int           nBuckets;
+    bool          bIncludeOutOfRange;
+    bool          bDirectByteHistogram;  // Byte value is the bucket index.
+
+    // GSM_INTEGRAL, and GSM_MULTI if nIntMaxValue > 0
+    GUInt32       nIntMaxValue;
+    GUInt32       nIntNoDataValue;  // Greater than nIntMaxValue if none.
+
+    // GSM_MULTI
+    bool          bDigest;
+
+    GDALStatsContext() :
+        eMode(GSM_MINMAX), eDataType(GDT_Unknown), nBlockXSize(0),
+        bSignedByte(false), bGotNoDataValue(false), dfNoDataValue(0.0),
+        bGotFloatNoDataValue(false), fNoDataValue(0.0f),
+        bComplexMagnitude(false), dfHistMin(0.0), dfHistScale(0.0),
+        nBuckets(0), bIncludeOutOfRange(false), bDirectByteHistogram(false),
+        nIntMaxValue(0),
+        nIntNoDataValue(0), bDigest(false) {}
+};
 
-/* -------------------------------------------------------------------- */
-/*      If we have overviews, use them for the histogram.               */
-/* -------------------------------------------------------------------- */
-    if( bApproxOK && GetOverviewCount() > 0 && !HasArbitraryOverviews() )
+// Processing of one block, and its results.
+struct GDALStatsBlockJob
+{
+    const GDALStatsContext *psCtx;
+    GDALRasterBlock        *poBlock;
+    int                     nXCheck;
+    int                     nYCheck;
+
+    std::vector<double>     adfValues;  // Scratch buffer.
+
+    GUIntBig                nValidCount;
+    double                  dfMin;
+    double                  dfMax;
+    double                  dfMean;
+    double                  dfM2;
+    std::vector<GUIntBig>   anHistogram;
+
+    GUInt32                 nIntMin;
+    GUInt32                 nIntMax;
+    GUIntBig                nIntSum;
+    GUIntBig                nIntSumSquare;
+
+    std::vector<GDALStatsCentroid> aoCentroids;  // Sorted by mean.
+
+    GDALStatsBlockJob() :
+        psCtx(nullptr), poBlock(nullptr), nXCheck(0), nYCheck(0),
+        nValidCount(0), dfMin(0.0), dfMax(0.0), dfMean(0.0), dfM2(0.0),
+        nIntMin(0), nIntMax(0), nIntSum(0), nIntSumSquare(0) {}
+};
+
+} // namespace
+
+#ifdef CPL_HAS_GINT64
+static void GDALStatsIntegralBlock( GDALStatsBlockJob& sJob );
+#endif
+
+/************************************************************************/
+/*                        GDALStatsLineToDouble()                       */
+/************************************************************************/
+
+// Convert a line of values to double, with NaN for invalid values.
+
+template<class T>
+static void GDALStatsLineToDouble( const T* pSrc, int nPixels,
+                                   const GDALStatsContext& sCtx,
+                                   double* padfDst )
+{
+    const double dfNaN = std::numeric_limits<double>::quiet_NaN();
+    for( int i = 0; i < nPixels; i++ )
     {
-        // FIXME: should we use the most reduced overview here or use some
-        // minimum number of samples like GDALRasterBand::ComputeStatistics()
-        // does?
-        GDALRasterBand *poBestOverview = GetRasterSampleOverview( 0 );
+        const double dfValue = static_cast<double>(pSrc[i]);
+        padfDst[i] = ( sCtx.bGotNoDataValue &&
+                       ARE_REAL_EQUAL(dfValue, sCtx.dfNoDataValue) ) ?
+                                                            dfNaN : dfValue;
+    }
+}
 
-        if( poBestOverview != this )
+template<>
+void GDALStatsLineToDouble<float>( const float* pSrc, int nPixels,
+                                   const GDALStatsContext& sCtx,
+                                   double* padfDst )
+{
+    const double dfNaN = std::numeric_limits<double>::quiet_NaN();
+    for( int i = 0; i < nPixels; i++ )
+    {
+        const float fValue = pSrc[i];
+        padfDst[i] = ( sCtx.bGotFloatNoDataValue &&
+                       ARE_REAL_EQUAL(fValue, sCtx.fNoDataValue) ) ?
+                                                            dfNaN : fValue;
+    }
+}
+
+template<class T>
+static void GDALStatsComplexLineToDouble( const T* pSrc, int nPixels,
+                                          const GDALStatsContext& sCtx,
+                                          double* padfDst )
+{
+    const double dfNaN = std::numeric_limits<double>::quiet_NaN();
+    for( int i = 0; i < nPixels; i++ )
+    {
+        const double dfReal = static_cast<double>(pSrc[2 * i]);
+        double dfValue = dfReal;
+        if( sCtx.bComplexMagnitude )
         {
-            return poBestOverview->GetHistogram( dfMin, dfMax, nBuckets,
-                                                 panHistogram,
-                                                 bIncludeOutOfRange, bApproxOK,
-                                                 pfnProgress, pProgressData );
+            const double dfImag = static_cast<double>(pSrc[2 * i + 1]);
+            dfValue = sqrt( dfReal * dfReal + dfImag * dfImag );
         }
+        padfDst[i] = ( sCtx.bGotNoDataValue &&
+                       ARE_REAL_EQUAL(dfValue, sCtx.dfNoDataValue) ) ?
+                                                            dfNaN : dfValue;
     }
+}
 
-/* -------------------------------------------------------------------- */
-/*      Read actual data and build histogram.                           */
-/* -------------------------------------------------------------------- */
-    if( !pfnProgress( 0.0, "Compute Histogram", pProgressData ) )
+/************************************************************************/
+/*                       GDALStatsBlockToDouble()                       */
+/************************************************************************/
+
+static void GDALStatsBlockToDouble( GDALStatsBlockJob& sJob )
+{
+    const GDALStatsContext& sCtx = *(sJob.psCtx);
+    const size_t nLineSize =
+        static_cast<size_t>(sCtx.nBlockXSize) *
+        GDALGetDataTypeSizeBytes(sCtx.eDataType);
+    const GByte* pabyData =
+        static_cast<const GByte*>(sJob.poBlock->GetDataRef());
+    const int nXCheck = sJob.nXCheck;
+    sJob.adfValues.resize(static_cast<size_t>(nXCheck) * sJob.nYCheck);
+
+    for( int iY = 0; iY < sJob.nYCheck; iY++ )
     {
-        ReportError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
-        return CE_Failure;
+        const void* pLine = pabyData + iY * nLineSize;
+        double* padfDst = &sJob.adfValues[static_cast<size_t>(iY) * nXCheck];
+        switch( sCtx.eDataType )
+        {
+          case GDT_Byte:
+            if( sCtx.bSignedByte )
+                GDALStatsLineToDouble(
+                    static_cast<const signed char*>(pLine), nXCheck, sCtx,
+                    padfDst);
+            else
+                GDALStatsLineToDouble(
+                    static_cast<const GByte*>(pLine), nXCheck, sCtx, padfDst);
+            break;
+          case GDT_UInt16:
+            GDALStatsLineToDouble(
+                static_cast<const GUInt16*>(pLine), nXCheck, sCtx, padfDst);
+            break;
+          case GDT_Int16:
+            GDALStatsLineToDouble(
+                static_cast<const GInt16*>(pLine), nXCheck, sCtx, padfDst);
+            break;
+          case GDT_UInt32:
+            GDALStatsLineToDouble(
+                static_cast<const GUInt32*>(pLine), nXCheck, sCtx, padfDst);
+            break;
+          case GDT_Int32:
+            GDALStatsLineToDouble(
+                static_cast<const GInt32*>(pLine), nXCheck, sCtx, padfDst);
+            break;
+          case GDT_Float32:
+            GDALStatsLineToDouble(
+                static_cast<const float*>(pLine), nXCheck, sCtx, padfDst);
+            break;
+          case GDT_Float64:
+            GDALStatsLineToDouble(
+                static_cast<const double*>(pLine), nXCheck, sCtx, padfDst);
+            break;
+          case GDT_CInt16:
+            GDALStatsComplexLineToDouble(
+                static_cast<const GInt16*>(pLine), nXCheck, sCtx, padfDst);
+            break;
+          case GDT_CInt32:
+            GDALStatsComplexLineToDouble(
+                static_cast<const GInt32*>(pLine), nXCheck, sCtx, padfDst);
+            break;
+          case GDT_CFloat32:
+            GDALStatsComplexLineToDouble(
+                static_cast<const float*>(pLine), nXCheck, sCtx, padfDst);
+            break;
+          case GDT_CFloat64:
+            GDALStatsComplexLineToDouble(
+                static_cast<const double*>(pLine), nXCheck, sCtx, padfDst);
+            break;
+          default:
+            CPLAssert( false );
+            break;
+        }
     }
+}
 
-    GDALRasterIOExtraArg sExtraArg;
-    INIT_RASTERIO_EXTRA_ARG(sExtraArg);
+/************************************************************************/
+/*                        GDALStatsBlockMoments()                       */
+/************************************************************************/
 
-    const double dfScale = (dfMax > dfMin) ? nBuckets / (dfMax - dfMin) : 0.0;
-    memset( panHistogram, 0, sizeof(GUIntBig) * nBuckets );
+// Count, minimum and maximum of the non-NaN values of the block and, if
+// bMoments, their mean and the sum of their squared differences to the mean
+// (computed in a second pass, which is more accurate than updating the mean
+// at each value). Values are dispatched on two accumulators, every other
+// value, that are summed at the end: this is what the SSE2 code does, and
+// the portable code does the same to give identical results.
 
-    int bGotNoDataValue = FALSE;
-    const double dfNoDataValue = GetNoDataValue( &bGotNoDataValue );
-    bGotNoDataValue = bGotNoDataValue && !CPLIsNan(dfNoDataValue);
-    // Not advertized. May be removed at any time. Just as a provision if the
-    // old behaviour made sense somethimes.
-    bGotNoDataValue = bGotNoDataValue &&
-        !CPLTestBool(CPLGetConfigOption("GDAL_NODATA_IN_HISTOGRAM", "NO"));
-    bool bGotFloatNoDataValue = false;
-    float fNoDataValue = 0.0f;
-    if( eDataType == GDT_Float32 && bGotNoDataValue &&
-        GDALIsValueInRange<float>(dfNoDataValue) )
+static void GDALStatsBlockMoments( GDALStatsBlockJob& sJob, bool bMoments )
+{
+    const double* padfValues = sJob.adfValues.data();
+    const size_t nCount = sJob.adfValues.size();
+    const double dfInf = std::numeric_limits<double>::infinity();
+
+    double adfCount[2] = { 0.0, 0.0 };
+    double adfSum[2] = { 0.0, 0.0 };
+    double adfMin[2] = { dfInf, dfInf };
+    double adfMax[2] = { -dfInf, -dfInf };
+    size_t i = 0;
+
+#ifdef GDAL_STATS_SSE2
+    const __m128d inf = _mm_set1_pd(dfInf);
+    const __m128d minusInf = _mm_set1_pd(-dfInf);
+    const __m128d one = _mm_set1_pd(1.0);
+    __m128d count = _mm_setzero_pd();
+    __m128d sum = _mm_setzero_pd();
+    __m128d minVal = inf;
+    __m128d maxVal = minusInf;
+    for( ; i + 2 <= nCount; i += 2 )
     {
-        fNoDataValue = static_cast<float>(dfNoDataValue);
-        bGotFloatNoDataValue = true;
-        bGotNoDataValue = false;
+        const __m128d val = _mm_loadu_pd(padfValues + i);
+        // All ones for non-NaN values.
+        const __m128d valid = _mm_cmpeq_pd(val, val);
+        count = _mm_add_pd(count, _mm_and_pd(valid, one));
+        sum = _mm_add_pd(sum, _mm_and_pd(valid, val));
+        minVal = _mm_min_pd(minVal, _mm_or_pd(_mm_and_pd(valid, val),
+                                              _mm_andnot_pd(valid, inf)));
+        maxVal = _mm_max_pd(maxVal, _mm_or_pd(_mm_and_pd(valid, val),
+                                              _mm_andnot_pd(valid, minusInf)));
     }
+    _mm_storeu_pd(adfCount, count);
+    _mm_storeu_pd(adfSum, sum);
+    _mm_storeu_pd(adfMin, minVal);
+    _mm_storeu_pd(adfMax, maxVal);
+#endif
 
-    const char* pszPixelType = GetMetadataItem("PIXELTYPE", "IMAGE_STRUCTURE");
-    const bool bSignedByte =
-        pszPixelType != nullptr && EQUAL(pszPixelType, "SIGNEDBYTE");
+    for( ; i < nCount; i++ )
+    {
+        const double dfValue = padfValues[i];
+        if( CPLIsNan(dfValue) )
+            continue;
+        const int iLane = static_cast<int>(i & 1);
+        adfCount[iLane] += 1.0;
+        adfSum[iLane] += dfValue;
+        // Same semantics as _mm_min_pd() and _mm_max_pd().
+        adfMin[iLane] = adfMin[iLane] < dfValue ? adfMin[iLane] : dfValue;
+        adfMax[iLane] = adfMax[iLane] > dfValue ? adfMax[iLane] : dfValue;
+    }
 
-    if ( bApproxOK && HasArbitraryOverviews() )
+    sJob.nValidCount = static_cast<GUIntBig>(adfCount[0] + adfCount[1]);
+    sJob.dfMin = std::min(adfMin[0], adfMin[1]);
+    sJob.dfMax = std::max(adfMax[0], adfMax[1]);
+    sJob.dfMean = 0.0;
+    sJob.dfM2 = 0.0;
+    if( !bMoments || sJob.nValidCount == 0 )
+        return;
+
+    const double dfMean = (adfSum[0] + adfSum[1]) / sJob.nValidCount;
+    double adfM2[2] = { 0.0, 0.0 };
+    i = 0;
+
+#ifdef GDAL_STATS_SSE2
+    const __m128d mean = _mm_set1_pd(dfMean);
+    __m128d m2 = _mm_setzero_pd();
+    for( ; i + 2 <= nCount; i += 2 )
     {
-/* -------------------------------------------------------------------- */
-/*      Figure out how much the image should be reduced to get an       */
-/*      approximate value.                                              */
-/* -------------------------------------------------------------------- */
-        const double dfReduction = sqrt(
-            static_cast<double>(nRasterXSize) * nRasterYSize /
-            GDALSTAT_APPROX_NUMSAMPLES );
+        const __m128d val = _mm_loadu_pd(padfValues + i);
+        const __m128d valid = _mm_cmpeq_pd(val, val);
+        const __m128d delta = _mm_sub_pd(val, mean);
+        m2 = _mm_add_pd(m2, _mm_and_pd(valid, _mm_mul_pd(delta, delta)));
+    }
+    _mm_storeu_pd(adfM2, m2);
+#endif
 
-        int nXReduced = nRasterXSize;
-        int nYReduced = nRasterYSize;
-        if ( dfReduction > 1.0 )
-        {
-            nXReduced = (int)( nRasterXSize / dfReduction );
-            nYReduced = (int)( nRasterYSize / dfReduction );
+    for( ; i < nCount; i++ )
+    {
+        const double dfValue = padfValues[i];
+        if( CPLIsNan(dfValue) )
+            continue;
+        const double dfDelta = dfValue - dfMean;
+        adfM2[i & 1] += dfDelta * dfDelta;
+    }
 
-            // Catch the case of huge resizing ratios here
-            if ( nXReduced == 0 )
-                nXReduced = 1;
-            if ( nYReduced == 0 )
-                nYReduced = 1;
-        }
+    sJob.dfMean = dfMean;
+    sJob.dfM2 = adfM2[0] + adfM2[1];
+}
 
-        void *pData =
-            CPLMalloc(
-                GDALGetDataTypeSizeBytes(eDataType) * nXReduced * nYReduced );
+/************************************************************************/
+/*                      GDALStatsNativeBlockMoments()                   */
+/************************************************************************/
 
-        const CPLErr eErr =
-            IRasterIO(
-                GF_Read, 0, 0, nRasterXSize, nRasterYSize, pData,
-                nXReduced, nYReduced, eDataType, 0, 0, &sExtraArg );
-        if ( eErr != CE_None )
+// Same as GDALStatsBlockToDouble() followed by GDALStatsBlockMoments(), but
+// reading the values in the block, without converting them first to a
+// buffer of doubles. The two accumulators are chosen by the parity of the
+// column.
+
+template<class T>
+static inline bool GDALStatsNativeValue( T tValue,
+                                         const GDALStatsContext& sCtx,
+                                         double& dfValue )
+{
+    dfValue = static_cast<double>(tValue);
+    return !( sCtx.bGotNoDataValue &&
+              ARE_REAL_EQUAL(dfValue, sCtx.dfNoDataValue) );
+}
+
+template<>
+inline bool GDALStatsNativeValue<float>( float fValue,
+                                         const GDALStatsContext& sCtx,
+                                         double& dfValue )
+{
+    dfValue = fValue;
+    return !CPLIsNan(fValue) &&
+           !( sCtx.bGotFloatNoDataValue &&
+              ARE_REAL_EQUAL(fValue, sCtx.fNoDataValue) );
+}
+
+template<>
+inline bool GDALStatsNativeValue<double>( double dfIn,
+                                          const GDALStatsContext& sCtx,
+                                          double& dfValue )
+{
+    dfValue = dfIn;
+    return !CPLIsNan(dfIn) &&
+           !( sCtx.bGotNoDataValue &&
+              ARE_REAL_EQUAL(dfIn, sCtx.dfNoDataValue) );
+}
+
+// Accumulate the count, sum, minimum and maximum of the valid values of a
+// line.
+template<class T>
+static void GDALStatsNativeLineSums( const T* pLine, int nPixels,
+                                    const GDALStatsContext& sCtx,
+                                    double adfCount[2], double adfSum[2],
+                                    double adfMin[2], double adfMax[2] )
+{
+    for( int iX = 0; iX < nPixels; iX++ )
+    {
+        double dfValue = 0.0;
+        if( !GDALStatsNativeValue(pLine[iX], sCtx, dfValue) )
+            continue;
+        const int iLane = iX & 1;
+        adfCount[iLane] += 1.0;
+        adfSum[iLane] += dfValue;
+        // Same semantics as _mm_min_pd() and _mm_max_pd().
+        adfMin[iLane] = adfMin[iLane] < dfValue ? adfMin[iLane] : dfValue;
+        adfMax[iLane] = adfMax[iLane] > dfValue ? adfMax[iLane] : dfValue;
+    }
+}
+
+#ifdef GDAL_STATS_SSE2
+// Float32 without nodata value: 4 values at a time, converted to 2 pairs of
+// doubles whose lanes are the parity of the column, as in the generic code.
+template<>
+void GDALStatsNativeLineSums<float>( const float* pLine, int nPixels,
+                                    const GDALStatsContext& sCtx,
+                                    double adfCount[2], double adfSum[2],
+                                    double adfMin[2], double adfMax[2] )
+{
+    int iX = 0;
+    if( !sCtx.bGotFloatNoDataValue )
+    {
+        const __m128d inf =
+            _mm_set1_pd(std::numeric_limits<double>::infinity());
+        const __m128d minusInf =
+            _mm_set1_pd(-std::numeric_limits<double>::infinity());
+        const __m128d one = _mm_set1_pd(1.0);
+        __m128d count = _mm_loadu_pd(adfCount);
+        __m128d sum = _mm_loadu_pd(adfSum);
+        __m128d minVal = _mm_loadu_pd(adfMin);
+        __m128d maxVal = _mm_loadu_pd(adfMax);
+        for( ; iX + 4 <= nPixels; iX += 4 )
         {
-            CPLFree(pData);
-            return eErr;
+            const __m128 val4 = _mm_loadu_ps(pLine + iX);
+            const __m128d aVal[2] = { _mm_cvtps_pd(val4),
+                                      _mm_cvtps_pd(_mm_movehl_ps(val4, val4)) };
+            for( int j = 0; j < 2; j++ )
+            {
+                const __m128d val = aVal[j];
+                // All ones for non-NaN values.
+                const __m128d valid = _mm_cmpeq_pd(val, val);
+                count = _mm_add_pd(count, _mm_and_pd(valid, one));
+                sum = _mm_add_pd(sum, _mm_and_pd(valid, val));
+                minVal = _mm_min_pd(minVal,
+                    _mm_or_pd(_mm_and_pd(valid, val),
+                              _mm_andnot_pd(valid, inf)));
+                maxVal = _mm_max_pd(maxVal,
+                    _mm_or_pd(_mm_and_pd(valid, val),
+                              _mm_andnot_pd(valid, minusInf)));
+            }
         }
+        _mm_storeu_pd(adfCount, count);
+        _mm_storeu_pd(adfSum, sum);
+        _mm_storeu_pd(adfMin, minVal);
+        _mm_storeu_pd(adfMax, maxVal);
+    }
+    for( ; iX < nPixels; iX++ )
+    {
+        double dfValue = 0.0;
+        if( !GDALStatsNativeValue(pLine[iX], sCtx, dfValue) )
+            continue;
+        const int iLane = iX & 1;
+        adfCount[iLane] += 1.0;
+        adfSum[iLane] += dfValue;
+        adfMin[iLane] = adfMin[iLane] < dfValue ? adfMin[iLane] : dfValue;
+        adfMax[iLane] = adfMax[iLane] > dfValue ? adfMax[iLane] : dfValue;
+    }
+}
+#endif
 
-        // This isn't the fastest way to do this, but is easier for now.
-        for( int iY = 0; iY < nYReduced; iY++ )
+template<class T>
+static void GDALStatsNativeBlockMoments( GDALStatsBlockJob& sJob,
+                                         bool bMoments )
+{
+    const GDALStatsContext& sCtx = *(sJob.psCtx);
+    const T* ptData = static_cast<const T*>(sJob.poBlock->GetDataRef());
+    const size_t nLineStride = static_cast<size_t>(sCtx.nBlockXSize);
+    const double dfInf = std::numeric_limits<double>::infinity();
+
+    double adfCount[2] = { 0.0, 0.0 };
+    double adfSum[2] = { 0.0, 0.0 };
+    double adfMin[2] = { dfInf, dfInf };
+    double adfMax[2] = { -dfInf, -dfInf };
+    for( int iY = 0; iY < sJob.nYCheck; iY++ )
+    {
+        GDALStatsNativeLineSums(ptData + iY * nLineStride, sJob.nXCheck,
+                                sCtx, adfCount, adfSum, adfMin, adfMax);
+    }
+
+    sJob.nValidCount = static_cast<GUIntBig>(adfCount[0] + adfCount[1]);
+    sJob.dfMin = std::min(adfMin[0], adfMin[1]);
+    sJob.dfMax = std::max(adfMax[0], adfMax[1]);
+    sJob.dfMean = 0.0;
+    sJob.dfM2 = 0.0;
+    if( !bMoments || sJob.nValidCount == 0 )
+        return;
+
+    const double dfMean = (adfSum[0] + adfSum[1]) / sJob.nValidCount;
+    double adfM2[2] = { 0.0, 0.0 };
+    for( int iY = 0; iY < sJob.nYCheck; iY++ )
+    {
+        const T* ptLine = ptData + iY * nLineStride;
+        for( int iX = 0; iX < sJob.nXCheck; iX++ )
         {
-            for( int iX = 0; iX < nXReduced; iX++ )
-            {
-                const int iOffset = iX + iY * nXReduced;
-                double dfValue = 0.0;
+            double dfValue = 0.0;
+            if( !GDALStatsNativeValue(ptLine[iX], sCtx, dfValue) )
+                continue;
+            const double dfDelta = dfValue - dfMean;
+            adfM2[iX & 1] += dfDelta * dfDelta;
+        }
+    }
 
-                switch( eDataType )
-                {
-                  case GDT_Byte:
-                  {
-                    if( bSignedByte )
-                        dfValue = static_cast<signed char *>(pData)[iOffset];
-                    else
-                        dfValue = static_cast<GByte *>(pData)[iOffset];
-                    break;
-                  }
-                  case GDT_UInt16:
-                    dfValue = static_cast<GUInt16 *>(pData)[iOffset];
-                    break;
-                  case GDT_Int16:
-                    dfValue = static_cast<GInt16 *>(pData)[iOffset];
-                    break;
-                  case GDT_UInt32:
-                    dfValue = static_cast<GUInt32 *>(pData)[iOffset];
-                    break;
-                  case GDT_Int32:
-                    dfValue = static_cast<GInt32 *>(pData)[iOffset];
-                    break;
-                  case GDT_Float32:
-                  {
-                    const float fValue = static_cast<float *>(pData)[iOffset];
+    sJob.dfMean = dfMean;
+    sJob.dfM2 = adfM2[0] + adfM2[1];
+}
+
+// Computes the moments of the block without the buffer of doubles if its
+// data type allows it. Returns false otherwise.
+static bool GDALStatsNativeMoments( GDALStatsBlockJob& sJob, bool bMoments )
+{
+    switch( sJob.psCtx->eDataType )
+    {
+      case GDT_UInt16:
+        GDALStatsNativeBlockMoments<GUInt16>(sJob, bMoments);
+        return true;
+      case GDT_Int16:
+        GDALStatsNativeBlockMoments<GInt16>(sJob, bMoments);
+        return true;
+      case GDT_UInt32:
+        GDALStatsNativeBlockMoments<GUInt32>(sJob, bMoments);
+        return true;
+      case GDT_Int32:
+        GDALStatsNativeBlockMoments<GInt32>(sJob, bMoments);
+        return true;
+      case GDT_Float32:
+        GDALStatsNativeBlockMoments<float>(sJob, bMoments);
+        return true;
+      case GDT_Float64:
+        GDALStatsNativeBlockMoments<double>(sJob, bMoments);
+        return true;
+      default:
+        return false;
+    }
+}
+
+/************************************************************************/
+/*                       GDALStatsBlockHistogram()                      */
+/************************************************************************/
+
+// Histogram of the values converted by GDALStatsBlockToDouble().
+
+static void GDALStatsValuesHistogram( GDALStatsBlockJob& sJob )
+{
+    const GDALStatsContext& sCtx = *(sJob.psCtx);
+    const int nBuckets = sCtx.nBuckets;
+    sJob.anHistogram.assign(nBuckets, 0);
+    GUIntBig* panHistogram = sJob.anHistogram.data();
+
+    const double* padfValues = sJob.adfValues.data();
+    const size_t nCount = sJob.adfValues.size();
+    for( size_t i = 0; i < nCount; i++ )
+    {
+        const double dfValue = padfValues[i];
+        if( CPLIsNan(dfValue) )
+            continue;
+
+        const int nIndex = static_cast<int>(
+            floor((dfValue - sCtx.dfHistMin) * sCtx.dfHistScale));
+
+        if( nIndex < 0 )
+        {
+            if( sCtx.bIncludeOutOfRange )
+                ++panHistogram[0];
+        }
+        else if( nIndex >= nBuckets )
+        {
+            if( sCtx.bIncludeOutOfRange )
+                ++panHistogram[nBuckets-1];
+        }
+        else
+        {
+            ++panHistogram[nIndex];
+        }
+    }
+}
+
+static void GDALStatsBlockHistogram( GDALStatsBlockJob& sJob )
+{
+    const GDALStatsContext& sCtx = *(sJob.psCtx);
+
+    // This is a special case for a common situation.
+    if( sCtx.bDirectByteHistogram &&
+        sJob.nXCheck == sCtx.nBlockXSize &&
+        sJob.nYCheck == sJob.poBlock->GetYSize() )
+    {
+        sJob.anHistogram.assign(sCtx.nBuckets, 0);
+        GUIntBig* panHistogram = sJob.anHistogram.data();
+        const int nPixels = sJob.nXCheck * sJob.nYCheck;
+        const GByte *pabyData =
+            static_cast<const GByte *>(sJob.poBlock->GetDataRef());
+        const bool bGotNoDataValue = sCtx.bGotNoDataValue;
+        const GByte byNoDataValue = static_cast<GByte>(sCtx.dfNoDataValue);
+
+        for( int i = 0; i < nPixels; i++ )
+        {
+            if( !(bGotNoDataValue && pabyData[i] == byNoDataValue) )
+                panHistogram[pabyData[i]]++;
+        }
+        return;
+    }
+
+    GDALStatsBlockToDouble(sJob);
+    GDALStatsValuesHistogram(sJob);
+}
+
+/************************************************************************/
+/*                          Quantile digest                             */
+/************************************************************************/
+
+// A t-digest (Dunning and Ertl, "Computing extremely accurate quantiles
+// using t-digests"), with the k1 scale function: values are summarized by
+// centroids whose weight is small near the extreme quantiles and larger
+// near the median, so that the number of centroids is bounded by about
+// GDAL_STATS_DIGEST_COMPRESSION whatever the number of values.
+
+#define GDAL_STATS_DIGEST_COMPRESSION 200.0
+
+static double GDALStatsDigestScale( double dfQ )
+{
+    dfQ = std::max(0.0, std::min(1.0, dfQ));
+    return GDAL_STATS_DIGEST_COMPRESSION / (2 * M_PI) * asin(2 * dfQ - 1);
+}
+
+static double GDALStatsDigestScaleInverse( double dfK )
+{
+    dfK = std::min(dfK, GDAL_STATS_DIGEST_COMPRESSION / 4);
+    return (sin(dfK * 2 * M_PI / GDAL_STATS_DIGEST_COMPRESSION) + 1) / 2;
+}
+
+static bool GDALStatsCentroidLess( const GDALStatsCentroid& a,
+                                   const GDALStatsCentroid& b )
+{
+    return a.dfMean < b.dfMean;
+}
+
+// Merge adjacent centroids, sorted by mean, while the scale function
+// allows it.
+static void GDALStatsDigestCompress( std::vector<GDALStatsCentroid>& aoCentroids )
+{
+    if( aoCentroids.size() <= 1 )
+        return;
+
+    double dfTotalWeight = 0.0;
+    for( size_t i = 0; i < aoCentroids.size(); i++ )
+        dfTotalWeight += aoCentroids[i].dfWeight;
+
+    size_t iOut = 0;
+    double dfWeightBefore = 0.0;  // Of the centroids before aoCentroids[iOut].
+    double dfWeightLimit = dfTotalWeight *
+        GDALStatsDigestScaleInverse(GDALStatsDigestScale(0.0) + 1.0);
+    for( size_t i = 1; i < aoCentroids.size(); i++ )
+    {
+        GDALStatsCentroid& oCur = aoCentroids[iOut];
+        const GDALStatsCentroid oNext = aoCentroids[i];
+        if( dfWeightBefore + oCur.dfWeight + oNext.dfWeight <= dfWeightLimit )
+        {
+            oCur.dfWeight += oNext.dfWeight;
+            oCur.dfMean += (oNext.dfMean - oCur.dfMean) *
+                           oNext.dfWeight / oCur.dfWeight;
+        }
+        else
+        {
+            dfWeightBefore += oCur.dfWeight;
+            dfWeightLimit = dfTotalWeight * GDALStatsDigestScaleInverse(
+                GDALStatsDigestScale(dfWeightBefore / dfTotalWeight) + 1.0);
+            aoCentroids[++iOut] = oNext;
+        }
+    }
+    aoCentroids.resize(iOut + 1);
+}
+
+// Add the centroids of a block to a digest, compressing it when it grows.
+static void GDALStatsDigestMerge( std::vector<GDALStatsCentroid>& aoDigest,
+                                  const std::vector<GDALStatsCentroid>& aoBlock,
+                                  bool bForceCompress )
+{
+    aoDigest.insert(aoDigest.end(), aoBlock.begin(), aoBlock.end());
+    if( bForceCompress ||
+        aoDigest.size() > 10 * static_cast<size_t>(
+                                        GDAL_STATS_DIGEST_COMPRESSION) )
+    {
+        std::stable_sort(aoDigest.begin(), aoDigest.end(),
+                         GDALStatsCentroidLess);
+        GDALStatsDigestCompress(aoDigest);
+    }
+}
+
+// Piecewise linear interpolation between (dfMin, 0), the centroids placed
+// at the middle of their weight, and (dfMax, total weight). If bRankToValue
+// the abscissa is the rank, otherwise it is the value.
+static double GDALStatsDigestInterpolate(
+    const std::vector<GDALStatsCentroid>& aoDigest,
+    double dfMin, double dfMax, double dfIn, bool bRankToValue )
+{
+    double dfTotalWeight = 0.0;
+    for( size_t i = 0; i < aoDigest.size(); i++ )
+        dfTotalWeight += aoDigest[i].dfWeight;
+
+    double dfPrevValue = dfMin;
+    double dfPrevRank = 0.0;
+    double dfWeightBefore = 0.0;
+    for( size_t i = 0; i <= aoDigest.size(); i++ )
+    {
+        double dfValue = dfMax;
+        double dfRank = dfTotalWeight;
+        if( i < aoDigest.size() )
+        {
+            dfValue = aoDigest[i].dfMean;
+            dfRank = dfWeightBefore + aoDigest[i].dfWeight / 2;
+            dfWeightBefore += aoDigest[i].dfWeight;
+        }
+        if( bRankToValue && dfIn <= dfRank )
+        {
+            if( dfRank <= dfPrevRank )
+                return dfValue;
+            return dfPrevValue + (dfValue - dfPrevValue) *
+                                 (dfIn - dfPrevRank) / (dfRank - dfPrevRank);
+        }
+        if( !bRankToValue && dfIn < dfValue )
+        {
+            if( dfIn <= dfPrevValue )
+                return dfPrevRank;
+            return dfPrevRank + (dfRank - dfPrevRank) *
+                                (dfIn - dfPrevValue) / (dfValue - dfPrevValue);
+        }
+        dfPrevValue = dfValue;
+        dfPrevRank = dfRank;
+    }
+    return bRankToValue ? dfMax : dfTotalWeight;
+}
+
+static void GDALStatsBlockDigest( GDALStatsBlockJob& sJob )
+{
+    sJob.aoCentroids.clear();
+    const double* padfValues = sJob.adfValues.data();
+    const size_t nCount = sJob.adfValues.size();
+    for( size_t i = 0; i < nCount; i++ )
+    {
+        if( !CPLIsNan(padfValues[i]) )
+        {
+            GDALStatsCentroid oCentroid;
+            oCentroid.dfMean = padfValues[i];
+            oCentroid.dfWeight = 1.0;
+            sJob.aoCentroids.push_back(oCentroid);
+        }
+    }
+    std::sort(sJob.aoCentroids.begin(), sJob.aoCentroids.end(),
+              GDALStatsCentroidLess);
+    GDALStatsDigestCompress(sJob.aoCentroids);
+}
+
+/************************************************************************/
+/*                         GDALStatsBlockMulti()                        */
+/************************************************************************/
+
+static void GDALStatsBlockMulti( GDALStatsBlockJob& sJob )
+{
+    const GDALStatsContext& sCtx = *(sJob.psCtx);
+#ifdef CPL_HAS_GINT64
+    if( sCtx.nIntMaxValue > 0 )
+    {
+        GDALStatsIntegralBlock(sJob);
+        if( sCtx.nBuckets > 0 || sCtx.bDigest )
+            GDALStatsBlockToDouble(sJob);
+    }
+    else
+#endif
+    if( sCtx.nBuckets > 0 || sCtx.bDigest ||
+        !GDALStatsNativeMoments(sJob, true) )
+    {
+        GDALStatsBlockToDouble(sJob);
+        GDALStatsBlockMoments(sJob, true);
+    }
+    if( sCtx.nBuckets > 0 )
+        GDALStatsValuesHistogram(sJob);
+    if( sCtx.bDigest )
+        GDALStatsBlockDigest(sJob);
+}
+
+/************************************************************************/
+/*                        GDALStatsBlockJobFunc()                       */
+/************************************************************************/
+
+static void GDALStatsBlockJobFunc( void* pData )
+{
+    GDALStatsBlockJob* psJob = static_cast<GDALStatsBlockJob *>(pData);
+
+    switch( psJob->psCtx->eMode )
+    {
+      case GSM_MINMAX:
+        if( !GDALStatsNativeMoments(*psJob, false) )
+        {
+            GDALStatsBlockToDouble(*psJob);
+            GDALStatsBlockMoments(*psJob, false);
+        }
+        break;
+      case GSM_MOMENTS:
+        if( !GDALStatsNativeMoments(*psJob, true) )
+        {
+            GDALStatsBlockToDouble(*psJob);
+            GDALStatsBlockMoments(*psJob, true);
+        }
+        break;
+      case GSM_HISTOGRAM:
+        GDALStatsBlockHistogram(*psJob);
+        break;
+      case GSM_INTEGRAL:
+#ifdef CPL_HAS_GINT64
+        GDALStatsIntegralBlock(*psJob);
+#endif
+        break;
+      case GSM_MULTI:
+        GDALStatsBlockMulti(*psJob);
+        break;
+    }
+}
+
+/************************************************************************/
+/*                       GDALStatsCreateJobQueue()                      */
+/************************************************************************/
+
+// Queue of jobs of the global thread pool with up to GDAL_NUM_THREADS
+// threads, or nullptr if a single thread is asked or if there is not enough
+// blocks to make it worthwhile.
+static CPLJobQueue* GDALStatsCreateJobQueue( int nBlocks, int& nThreads )
+{
+    nThreads = std::min(GDALGetNumThreads(), nBlocks);
+    CPLWorkerThreadPool* poThreadPool = GDALGetGlobalThreadPool(nThreads);
+    if( poThreadPool == nullptr )
+        return nullptr;
+    return new (std::nothrow) CPLJobQueue(poThreadPool);
+}
+
+/************************************************************************/
+/*                        GDALStatsProcessBlocks()                      */
+/************************************************************************/
+
+typedef void (*GDALStatsMergeFunc)( const GDALStatsBlockJob& sJob,
+                                    void* pMergeData );
+
+// Process every nSampleRate-th block of poBand according to sCtx, and call
+// pfnMerge on the result of each block, in block order.
+// pszProgressMessage is nullptr when no progress is reported. Returns
+// CE_Failure, without emitting an error, if the user interrupted.
+
+static CPLErr GDALStatsProcessBlocks( GDALRasterBand* poBand, int nSampleRate,
+                                      const GDALStatsContext& sCtx,
+                                      GDALStatsMergeFunc pfnMerge,
+                                      void* pMergeData,
+                                      const char* pszProgressMessage,
+                                      GDALProgressFunc pfnProgress,
+                                      void* pProgressData,
+                                      bool* pbInterrupted )
+{
+    *pbInterrupted = false;
+
+    int nBlockXSize = 0;
+    int nBlockYSize = 0;
+    poBand->GetBlockSize(&nBlockXSize, &nBlockYSize);
+    const int nXSize = poBand->GetXSize();
+    const int nYSize = poBand->GetYSize();
+    const int nBlocksPerRow = DIV_ROUND_UP(nXSize, nBlockXSize);
+    const int nBlocksPerColumn = DIV_ROUND_UP(nYSize, nBlockYSize);
+    const int nTotalBlocks = nBlocksPerRow * nBlocksPerColumn;
+
+    int nThreads = 1;
+    CPLJobQueue* poJobQueue =
+        GDALStatsCreateJobQueue(DIV_ROUND_UP(nTotalBlocks, nSampleRate),
+                                nThreads);
+    const size_t nBatchSize =
+        poJobQueue ? static_cast<size_t>(nThreads) : 1;
+
+    // Blocks of the batch being processed by the threads, and of the batch
+    // being read by the calling thread.
+    std::vector<GDALStatsBlockJob> aoJobs[2];
+    for( int i = 0; i < 2; i++ )
+    {
+        aoJobs[i].resize(nBatchSize);
+        for( size_t j = 0; j < nBatchSize; j++ )
+            aoJobs[i][j].psCtx = &sCtx;
+    }
+    size_t anJobCount[2] = { 0, 0 };
+    int iCurBatch = 0;
+
+    CPLErr eErr = CE_None;
+    int iSampleBlock = 0;
+    while( true )
+    {
+/* -------------------------------------------------------------------- */
+/*      Read the blocks of the new batch.                               */
+/* -------------------------------------------------------------------- */
+        std::vector<GDALStatsBlockJob>& aoNewJobs = aoJobs[iCurBatch];
+        size_t& nNewJobs = anJobCount[iCurBatch];
+        nNewJobs = 0;
+        while( eErr == CE_None && !*pbInterrupted &&
+               nNewJobs < nBatchSize && iSampleBlock < nTotalBlocks )
+        {
+            const int iYBlock = iSampleBlock / nBlocksPerRow;
+            const int iXBlock = iSampleBlock - nBlocksPerRow * iYBlock;
+            iSampleBlock += nSampleRate;
+
+            GDALRasterBlock * const poBlock =
+                poBand->GetLockedBlockRef( iXBlock, iYBlock );
+            if( poBlock == nullptr )
+            {
+                eErr = CE_Failure;
+                break;
+            }
+
+            GDALStatsBlockJob& sJob = aoNewJobs[nNewJobs++];
+            sJob.poBlock = poBlock;
+            sJob.nXCheck = std::min(nBlockXSize,
+                                    nXSize - iXBlock * nBlockXSize);
+            sJob.nYCheck = std::min(nBlockYSize,
+                                    nYSize - iYBlock * nBlockYSize);
+        }
+
+/* -------------------------------------------------------------------- */
+/*      Wait for the previous batch, and start the new one.             */
+/* -------------------------------------------------------------------- */
+        if( poJobQueue )
+        {
+            poJobQueue->WaitCompletion();
+            if( eErr == CE_None && !*pbInterrupted && nNewJobs > 0 )
+            {
+                std::vector<void*> apJobs;
+                for( size_t i = 0; i < nNewJobs; ++i )
+                    apJobs.push_back(&aoNewJobs[i]);
+                poJobQueue->SubmitJobs(GDALStatsBlockJobFunc, apJobs);
+            }
+        }
+        else if( eErr == CE_None )
+        {
+            for( size_t i = 0; i < nNewJobs; ++i )
+                GDALStatsBlockJobFunc(&aoNewJobs[i]);
+        }
+
+/* -------------------------------------------------------------------- */
+/*      Merge the results of the previous batch (of the new batch if    */
+/*      there is no thread pool).                                       */
+/* -------------------------------------------------------------------- */
+        const int iMergeBatch = poJobQueue ? 1 - iCurBatch : iCurBatch;
+        std::vector<GDALStatsBlockJob>& aoDoneJobs = aoJobs[iMergeBatch];
+        for( size_t i = 0; i < anJobCount[iMergeBatch]; ++i )
+        {
+            if( eErr == CE_None && !*pbInterrupted )
+                pfnMerge(aoDoneJobs[i], pMergeData);
+            aoDoneJobs[i].poBlock->DropLock();
+            aoDoneJobs[i].poBlock = nullptr;
+        }
+        const bool bMerged = anJobCount[iMergeBatch] > 0;
+        anJobCount[iMergeBatch] = 0;
+
+        if( eErr == CE_None && !*pbInterrupted && bMerged &&
+            pszProgressMessage != nullptr &&
+            !pfnProgress( std::min(iSampleBlock, nTotalBlocks) /
+                              static_cast<double>(nTotalBlocks),
+                          pszProgressMessage, pProgressData ) )
+        {
+            *pbInterrupted = true;
+        }
+
+        iCurBatch = 1 - iCurBatch;
+
+        if( anJobCount[0] == 0 && anJobCount[1] == 0 &&
+            (eErr != CE_None || *pbInterrupted ||
+             iSampleBlock >= nTotalBlocks) )
+        {
+            break;
+        }
+    }
+
+    delete poJobQueue;
+
+    return (eErr == CE_None && !*pbInterrupted) ? CE_None : CE_Failure;
+}
+
+/************************************************************************/
+/*                      GDALStatsMerge functions                        */
+/************************************************************************/
+
+namespace {
+
+// Running minimum, maximum, mean and sum of squared differences to the mean.
+struct GDALStatsAccumulator
+{
+    GUIntBig nCount;
+    double   dfMin;
+    double   dfMax;
+    double   dfMean;
+    double   dfM2;
+
+    GDALStatsAccumulator() :
+        nCount(0), dfMin(0.0), dfMax(0.0), dfMean(0.0), dfM2(0.0) {}
+};
+
+// Running integer statistics of GSM_INTEGRAL.
+struct GDALStatsIntegralAccumulator
+{
+    GUInt32  nMin;
+    GUInt32  nMax;
+    GUIntBig nSum;
+    GUIntBig nSumSquare;
+    GUIntBig nSampleCount;
+
+    explicit GDALStatsIntegralAccumulator( GUInt32 nMaxValue ) :
+        nMin(nMaxValue), nMax(0), nSum(0), nSumSquare(0), nSampleCount(0) {}
+};
+
+} // namespace
+
+// Merge the mean and sum of squared differences of a block with the
+// pairwise formula of Chan et al.
+static void GDALStatsMergeMoments( const GDALStatsBlockJob& sJob,
+                                   void* pMergeData )
+{
+    GDALStatsAccumulator* psAcc =
+        static_cast<GDALStatsAccumulator*>(pMergeData);
+    if( sJob.nValidCount == 0 )
+        return;
+    if( psAcc->nCount == 0 )
+    {
+        psAcc->nCount = sJob.nValidCount;
+        psAcc->dfMin = sJob.dfMin;
+        psAcc->dfMax = sJob.dfMax;
+        psAcc->dfMean = sJob.dfMean;
+        psAcc->dfM2 = sJob.dfM2;
+        return;
+    }
+
+    psAcc->dfMin = std::min(psAcc->dfMin, sJob.dfMin);
+    psAcc->dfMax = std::max(psAcc->dfMax, sJob.dfMax);
+
+    const double dfCount = static_cast<double>(psAcc->nCount);
+    const double dfBlockCount = static_cast<double>(sJob.nValidCount);
+    const double dfNewCount = dfCount + dfBlockCount;
+    const double dfDelta = sJob.dfMean - psAcc->dfMean;
+    psAcc->dfMean += dfDelta * (dfBlockCount / dfNewCount);
+    psAcc->dfM2 += sJob.dfM2 +
+        dfDelta * dfDelta * (dfCount * dfBlockCount / dfNewCount);
+    psAcc->nCount += sJob.nValidCount;
+}
+
+static void GDALStatsMergeIntegral( const GDALStatsBlockJob& sJob,
+                                    void* pMergeData )
+{
+    GDALStatsIntegralAccumulator* psAcc =
+        static_cast<GDALStatsIntegralAccumulator*>(pMergeData);
+    psAcc->nMin = std::min(psAcc->nMin, sJob.nIntMin);
+    psAcc->nMax = std::max(psAcc->nMax, sJob.nIntMax);
+    psAcc->nSum += sJob.nIntSum;
+    psAcc->nSumSquare += sJob.nIntSumSquare;
+    psAcc->nSampleCount += sJob.nValidCount;
+}
+
+static void GDALStatsMergeHistogram( const GDALStatsBlockJob& sJob,
+                                     void* pMergeData )
+{
+    GUIntBig* panHistogram = static_cast<GUIntBig*>(pMergeData);
+    for( size_t i = 0; i < sJob.anHistogram.size(); i++ )
+        panHistogram[i] += sJob.anHistogram[i];
+}
+
+namespace {
+
+// Running results of GSM_MULTI.
+struct GDALStatsMultiAccumulator
+{
+    const GDALStatsContext         *psCtx;
+    GDALStatsAccumulator            oMoments;
+    GDALStatsIntegralAccumulator    oIntegral;
+    GUIntBig                       *panHistogram;
+    std::vector<GDALStatsCentroid>  aoDigest;
+
+    explicit GDALStatsMultiAccumulator( const GDALStatsContext* psCtxIn ) :
+        psCtx(psCtxIn), oIntegral(psCtxIn->nIntMaxValue),
+        panHistogram(nullptr) {}
+};
+
+} // namespace
+
+static void GDALStatsMergeMulti( const GDALStatsBlockJob& sJob,
+                                 void* pMergeData )
+{
+    GDALStatsMultiAccumulator* psAcc =
+        static_cast<GDALStatsMultiAccumulator*>(pMergeData);
+    if( psAcc->psCtx->nIntMaxValue > 0 )
+        GDALStatsMergeIntegral(sJob, &psAcc->oIntegral);
+    else
+        GDALStatsMergeMoments(sJob, &psAcc->oMoments);
+    if( psAcc->panHistogram != nullptr )
+        GDALStatsMergeHistogram(sJob, psAcc->panHistogram);
+    if( psAcc->psCtx->bDigest )
+        GDALStatsDigestMerge(psAcc->aoDigest, sJob.aoCentroids, false);
+}
+
+/************************************************************************/
+/*                            GetHistogram()                            */
+/************************************************************************/
+
+/**
+ * \brief Compute raster histogram.
+ *
+ * Note that the bucket size is (dfMax-dfMin) / nBuckets.
+ *
+ * For example to compute a simple 256 entry histogram of eight bit data,
+ * the following would be suitable.  The unusual bounds are to ensure that
+ * bucket boundaries don't fall right on integer values causing possible errors
+ * due to rounding after scaling.
+<pre>
+    GUIntBig anHistogram[256];
+
+    poBand->GetHistogram( -0.5, 255.5, 256, anHistogram, FALSE, FALSE,
+                          GDALDummyProgress, nullptr );
+</pre>
+ *
+ * Note that setting bApproxOK will generally result in a subsampling of the
+ * file, and will utilize overviews if available.  It should generally
+ * produce a representative histogram for the data that is suitable for use
+ * in generating histogram based luts for instance.  Generally bApproxOK is
+ * much faster than an exactly computed histogram.
+ *
+ * Starting with GDAL 2.3, the GDAL_NUM_THREADS configuration option can be
+ * set to a number of threads, or ALL_CPUS, to process the blocks in
+ * parallel once they have been read.
+ *
+ * This method is the same as the C functions GDALGetRasterHistogram() and
+ * GDALGetRasterHistogramEx().
+ *
+ * @param dfMin the lower bound of the histogram.
+ * @param dfMax the upper bound of the histogram.
+ * @param nBuckets the number of buckets in panHistogram.
+ * @param panHistogram array into which the histogram totals are placed.
+ * @param bIncludeOutOfRange if TRUE values below the histogram range will
+ * mapped into panHistogram[0], and values above will be mapped into
+ * panHistogram[nBuckets-1] otherwise out of range values are discarded.
+ * @param bApproxOK TRUE if an approximate, or incomplete histogram OK.
+ * @param pfnProgress function to report progress to completion.
+ * @param pProgressData application data to pass to pfnProgress.
+ *
+ * @return CE_None on success, or CE_Failure if something goes wrong.
+ */
+
+CPLErr GDALRasterBand::GetHistogram( double dfMin, double dfMax,
+                                     int nBuckets, GUIntBig *panHistogram,
+                                     int bIncludeOutOfRange, int bApproxOK,
+                                     GDALProgressFunc pfnProgress,
+                                     void *pProgressData )
+
+{
+    CPLAssert( nullptr != panHistogram );
+
+    if( pfnProgress == nullptr )
+        pfnProgress = GDALDummyProgress;
+
+/* -------------------------------------------------------------------- */
+/*      If we have overviews, use them for the histogram.               */
+/* -------------------------------------------------------------------- */
+    if( bApproxOK && GetOverviewCount() > 0 && !HasArbitraryOverviews() )
+    {
+        // FIXME: should we use the most reduced overview here or use some
+        // minimum number of samples like GDALRasterBand::ComputeStatistics()
+        // does?
+        GDALRasterBand *poBestOverview = GetRasterSampleOverview( 0 );
+
+        if( poBestOverview != this )
+        {
+            return poBestOverview->GetHistogram( dfMin, dfMax, nBuckets,
+                                                 panHistogram,
+                                                 bIncludeOutOfRange, bApproxOK,
+                                                 pfnProgress, pProgressData );
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Read actual data and build histogram.                           */
+/* -------------------------------------------------------------------- */
+    if( !pfnProgress( 0.0, "Compute Histogram", pProgressData ) )
+    {
+        ReportError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+        return CE_Failure;
+    }
+
+    GDALRasterIOExtraArg sExtraArg;
+    INIT_RASTERIO_EXTRA_ARG(sExtraArg);
+
+    const double dfScale = (dfMax > dfMin) ? nBuckets / (dfMax - dfMin) : 0.0;
+    memset( panHistogram, 0, sizeof(GUIntBig) * nBuckets );
+
+    int bGotNoDataValue = FALSE;
+    const double dfNoDataValue = GetNoDataValue( &bGotNoDataValue );
+    bGotNoDataValue = bGotNoDataValue && !CPLIsNan(dfNoDataValue);
+    // Not advertized. May be removed at any time. Just as a provision if the
+    // old behaviour made sense somethimes.
+    bGotNoDataValue = bGotNoDataValue &&
+        !CPLTestBool(CPLGetConfigOption("GDAL_NODATA_IN_HISTOGRAM", "NO"));
+    bool bGotFloatNoDataValue = false;
+    float fNoDataValue = 0.0f;
+    if( eDataType == GDT_Float32 && bGotNoDataValue &&
+        GDALIsValueInRange<float>(dfNoDataValue) )
+    {
+        fNoDataValue = static_cast<float>(dfNoDataValue);
+        bGotFloatNoDataValue = true;
+        bGotNoDataValue = false;
+    }
+
+    const char* pszPixelType = GetMetadataItem("PIXELTYPE", "IMAGE_STRUCTURE");
+    const bool bSignedByte =
+        pszPixelType != nullptr && EQUAL(pszPixelType, "SIGNEDBYTE");
+
+    if ( bApproxOK && HasArbitraryOverviews() )
+    {
+/* -------------------------------------------------------------------- */
+/*      Figure out how much the image should be reduced to get an       */
+/*      approximate value.                                              */
+/* -------------------------------------------------------------------- */
+        const double dfReduction = sqrt(
+            static_cast<double>(nRasterXSize) * nRasterYSize /
+            GDALSTAT_APPROX_NUMSAMPLES );
+
+        int nXReduced = nRasterXSize;
+        int nYReduced = nRasterYSize;
+        if ( dfReduction > 1.0 )
+        {
+            nXReduced = (int)( nRasterXSize / dfReduction );
+            nYReduced = (int)( nRasterYSize / dfReduction );
+
+            // Catch the case of huge resizing ratios here
+            if ( nXReduced == 0 )
+                nXReduced = 1;
+            if ( nYReduced == 0 )
+                nYReduced = 1;
+        }
+
+        void *pData =
+            CPLMalloc(
+                GDALGetDataTypeSizeBytes(eDataType) * nXReduced * nYReduced );
+
+        const CPLErr eErr =
+            IRasterIO(
+                GF_Read, 0, 0, nRasterXSize, nRasterYSize, pData,
+                nXReduced, nYReduced, eDataType, 0, 0, &sExtraArg );
+        if ( eErr != CE_None )
+        {
+            CPLFree(pData);
+            return eErr;
+        }
+
+        // This isn't the fastest way to do this, but is easier for now.
+        for( int iY = 0; iY < nYReduced; iY++ )
+        {
+            for( int iX = 0; iX < nXReduced; iX++ )
+            {
+                const int iOffset = iX + iY * nXReduced;
+                double dfValue = 0.0;
+
+                switch( eDataType )
+                {
+                  case GDT_Byte:
+                  {
+                    if( bSignedByte )
+                        dfValue = static_cast<signed char *>(pData)[iOffset];
+                    else
+                        dfValue = static_cast<GByte *>(pData)[iOffset];
+                    break;
+                  }
+                  case GDT_UInt16:
+                    dfValue = static_cast<GUInt16 *>(pData)[iOffset];
+                    break;
+                  case GDT_Int16:
+                    dfValue = static_cast<GInt16 *>(pData)[iOffset];
+                    break;
+                  case GDT_UInt32:
+                    dfValue = static_cast<GUInt32 *>(pData)[iOffset];
+                    break;
+                  case GDT_Int32:
+                    dfValue = static_cast<GInt32 *>(pData)[iOffset];
+                    break;
+                  case GDT_Float32:
+                  {
+                    const float fValue = static_cast<float *>(pData)[iOffset];
                     if( CPLIsNan(fValue) ||
                         (bGotFloatNoDataValue && ARE_REAL_EQUAL(fValue, fNoDataValue)) )
                         continue;
@@ -3159,168 +4291,32 @@ CPLErr GDALRasterBand::GetHistogram( double dfMin, double dfMax,
 /* -------------------------------------------------------------------- */
 /*      Read the blocks, and add to histogram.                          */
 /* -------------------------------------------------------------------- */
-        for( int iSampleBlock = 0;
-             iSampleBlock < nBlocksPerRow * nBlocksPerColumn;
-             iSampleBlock += nSampleRate )
+        GDALStatsContext sCtx;
+        sCtx.eMode = GSM_HISTOGRAM;
+        sCtx.eDataType = eDataType;
+        sCtx.nBlockXSize = nBlockXSize;
+        sCtx.bSignedByte = bSignedByte;
+        sCtx.bGotNoDataValue = CPL_TO_BOOL(bGotNoDataValue);
+        sCtx.dfNoDataValue = dfNoDataValue;
+        sCtx.bGotFloatNoDataValue = bGotFloatNoDataValue;
+        sCtx.fNoDataValue = fNoDataValue;
+        sCtx.bComplexMagnitude = true;
+        sCtx.dfHistMin = dfMin;
+        sCtx.dfHistScale = dfScale;
+        sCtx.nBuckets = nBuckets;
+        sCtx.bIncludeOutOfRange = CPL_TO_BOOL(bIncludeOutOfRange);
+        sCtx.bDirectByteHistogram =
+            eDataType == GDT_Byte && !bSignedByte && dfScale == 1.0 &&
+            (dfMin >= -0.5 && dfMin <= 0.5) && nBuckets == 256;
+
+        bool bInterrupted = false;
+        if( GDALStatsProcessBlocks( this, nSampleRate, sCtx,
+                                    GDALStatsMergeHistogram, panHistogram,
+                                    "Compute Histogram",
+                                    pfnProgress, pProgressData,
+                                    &bInterrupted ) != CE_None )
         {
-            if( !pfnProgress(
-                    iSampleBlock /
-                        (static_cast<double>(nBlocksPerRow) * nBlocksPerColumn),
-                    "Compute Histogram", pProgressData ) )
-                return CE_Failure;
-
-            const int iYBlock = iSampleBlock / nBlocksPerRow;
-            const int iXBlock = iSampleBlock - nBlocksPerRow * iYBlock;
-
-            GDALRasterBlock *poBlock = GetLockedBlockRef( iXBlock, iYBlock );
-            if( poBlock == nullptr )
-                return CE_Failure;
-
-            void *pData = poBlock->GetDataRef();
-
-            int nXCheck = nBlockXSize;
-            if( (iXBlock+1) * nBlockXSize > GetXSize() )
-                nXCheck = GetXSize() - iXBlock * nBlockXSize;
-
-            int nYCheck = nBlockYSize;
-            if( (iYBlock+1) * nBlockYSize > GetYSize() )
-                nYCheck = GetYSize() - iYBlock * nBlockYSize;
-
-            // this is a special case for a common situation.
-            if( eDataType == GDT_Byte && !bSignedByte
-                && dfScale == 1.0 && (dfMin >= -0.5 && dfMin <= 0.5)
-                && nYCheck == nBlockYSize && nXCheck == nBlockXSize
-                && nBuckets == 256 )
-            {
-                const int nPixels = nXCheck * nYCheck;
-                GByte *pabyData = static_cast<GByte *>(pData);
-
-                for( int i = 0; i < nPixels; i++ )
-                    if( ! (bGotNoDataValue &&
-                           (pabyData[i] == (GByte)dfNoDataValue)))
-                    {
-                        panHistogram[pabyData[i]]++;
-                    }
-
-                poBlock->DropLock();
-                continue;  // To next sample block.
-            }
-
-            // This isn't the fastest way to do this, but is easier for now.
-            for( int iY = 0; iY < nYCheck; iY++ )
-            {
-                for( int iX = 0; iX < nXCheck; iX++ )
-                {
-                    const int iOffset = iX + iY * nBlockXSize;
-                    double dfValue = 0.0;
-
-                    switch( eDataType )
-                    {
-                      case GDT_Byte:
-                      {
-                        if( bSignedByte )
-                            dfValue =
-                                static_cast<signed char *>(pData)[iOffset];
-                        else
-                            dfValue = static_cast<GByte *>(pData)[iOffset];
-                        break;
-                      }
-                      case GDT_UInt16:
-                        dfValue = static_cast<GUInt16 *>(pData)[iOffset];
-                        break;
-                      case GDT_Int16:
-                        dfValue = static_cast<GInt16 *>(pData)[iOffset];
-                        break;
-                      case GDT_UInt32:
-                        dfValue = static_cast<GUInt32 *>(pData)[iOffset];
-                        break;
-                      case GDT_Int32:
-                        dfValue = static_cast<GInt32 *>(pData)[iOffset];
-                        break;
-                      case GDT_Float32:
-                      {
-                        const float fValue = static_cast<float *>(pData)[iOffset];
-                        if( CPLIsNan(fValue) ||
-                            (bGotFloatNoDataValue && ARE_REAL_EQUAL(fValue, fNoDataValue)) )
-                            continue;
-                        dfValue = fValue;
-                        break;
-                      }
-                      case GDT_Float64:
-                        dfValue = static_cast<double *>(pData)[iOffset];
-                        if( CPLIsNan(dfValue) )
-                            continue;
-                        break;
-                      case GDT_CInt16:
-                        {
-                            double  dfReal =
-                                static_cast<GInt16 *>(pData)[iOffset*2];
-                            double  dfImag =
-                                static_cast<GInt16 *>(pData)[iOffset*2+1];
-                            dfValue = sqrt( dfReal * dfReal + dfImag * dfImag );
-                        }
-                        break;
-                      case GDT_CInt32:
-                        {
-                            double  dfReal =
-                                static_cast<GInt32 *>(pData)[iOffset*2];
-                            double  dfImag =
-                                static_cast<GInt32 *>(pData)[iOffset*2+1];
-                            dfValue = sqrt( dfReal * dfReal + dfImag * dfImag );
-                        }
-                        break;
-                      case GDT_CFloat32:
-                        {
-                            double  dfReal =
-                                static_cast<float *>(pData)[iOffset*2];
-                            double  dfImag =
-                                static_cast<float *>(pData)[iOffset*2+1];
-                            if ( CPLIsNan(dfReal) || CPLIsNan(dfImag) )
-                                continue;
-                            dfValue = sqrt( dfReal * dfReal + dfImag * dfImag );
-                        }
-                        break;
-                      case GDT_CFloat64:
-                        {
-                            double  dfReal =
-                                static_cast<double *>(pData)[iOffset*2];
-                            double  dfImag =
-                                static_cast<double *>(pData)[iOffset*2+1];
-                            if ( CPLIsNan(dfReal) || CPLIsNan(dfImag) )
-                                continue;
-                            dfValue = sqrt( dfReal * dfReal + dfImag * dfImag );
-                        }
-                        break;
-                      default:
-                        CPLAssert( false );
-                        return CE_Failure;
-                    }
-
-                    if( eDataType != GDT_Float32 && bGotNoDataValue &&
-                        ARE_REAL_EQUAL(dfValue, dfNoDataValue) )
-                        continue;
-
-                    const int nIndex =
-                        static_cast<int>(floor((dfValue - dfMin) * dfScale));
-
-                    if( nIndex < 0 )
-                    {
-                        if( bIncludeOutOfRange )
-                            ++panHistogram[0];
-                    }
-                    else if( nIndex >= nBuckets )
-                    {
-                        if( bIncludeOutOfRange )
-                            ++panHistogram[nBuckets-1];
-                    }
-                    else
-                    {
-                        panHistogram[nIndex]++;
-                    }
-                }
-            }
-
-            poBlock->DropLock();
+            return CE_Failure;
         }
     }
 
@@ -3646,6 +4642,15 @@ CPLErr CPL_STDCALL GDALGetDefaultHistogramEx(
  * Depending on call paths, drivers might receive several calls to
  * AdviseRead() with the same parameters.
  *
+ * For drivers that do not implement it, and when the
+ * GDAL_PREFETCH_NUM_THREADS configuration option is set to a number of
+ * threads greater than 1 or ALL_CPUS, the blocks of the region of a dataset
+ * opened in read-only mode are read in the background by that many worker
+ * threads of the global thread pool, up to a quarter of the block cache size
+ * (GDAL >= 2.3). The same worker threads also read ahead the next blocks
+ * (GDAL_PREFETCH_BLOCKS of them) when consecutive blocks are requested from
+ * the band.
+ *
  * @param nXOff The pixel offset to the top left corner of the region
  * of the band to be accessed.  This would be zero to start from the left side.
  *
@@ -3677,15 +4682,25 @@ CPLErr CPL_STDCALL GDALGetDefaultHistogramEx(
 /**/
 
 CPLErr GDALRasterBand::AdviseRead(
-    int /*nXOff*/,
-    int /*nYOff*/,
-    int /*nXSize*/,
-    int /*nYSize*/,
-    int /*nBufXSize*/,
-    int /*nBufYSize*/,
+    int nXOff,
+    int nYOff,
+    int nXSize,
+    int nYSize,
+    int nBufXSize,
+    int nBufYSize,
     GDALDataType /*eBufType*/,
     char ** /*papszOptions*/ )
 {
+    // Only full resolution requests are served from the blocks of this band.
+    if( nBufXSize != nXSize || nBufYSize != nYSize )
+        return CE_None;
+
+    GDALBlockPrefetcher* poPrefetcher =
+        poDS != nullptr && nBand >= 1 && nBand <= poDS->GetRasterCount() &&
+        poDS->GetRasterBand(nBand) == this ?
+            poDS->GetBlockPrefetcher() : nullptr;
+    if( poPrefetcher != nullptr )
+        poPrefetcher->AdviseWindow(nBand, nXOff, nYOff, nXSize, nYSize);
     return CE_None;
 }
 
@@ -4685,6 +5700,45 @@ void ComputeStatisticsInternal<GUInt16>( int nXCheck,
 
 #endif // (defined(__x86_64__) || defined(_M_X64)) && (defined(__GNUC__) || defined(_MSC_VER))
 
+/************************************************************************/
+/*                       GDALStatsIntegralBlock()                       */
+/************************************************************************/
+
+static void GDALStatsIntegralBlock( GDALStatsBlockJob& sJob )
+{
+    const GDALStatsContext& sCtx = *(sJob.psCtx);
+    sJob.nIntMin = sCtx.nIntMaxValue;
+    sJob.nIntMax = 0;
+    sJob.nIntSum = 0;
+    sJob.nIntSumSquare = 0;
+    GUIntBig nSampleCount = 0;
+    const bool bHasNoData = sCtx.nIntNoDataValue <= sCtx.nIntMaxValue;
+
+    if( sCtx.eDataType == GDT_Byte )
+    {
+        ComputeStatisticsInternal( sJob.nXCheck, sCtx.nBlockXSize,
+                                   sJob.nYCheck,
+                                   static_cast<const GByte*>(
+                                       sJob.poBlock->GetDataRef()),
+                                   bHasNoData, sCtx.nIntNoDataValue,
+                                   sJob.nIntMin, sJob.nIntMax,
+                                   sJob.nIntSum, sJob.nIntSumSquare,
+                                   nSampleCount );
+    }
+    else
+    {
+        ComputeStatisticsInternal( sJob.nXCheck, sCtx.nBlockXSize,
+                                   sJob.nYCheck,
+                                   static_cast<const GUInt16*>(
+                                       sJob.poBlock->GetDataRef()),
+                                   bHasNoData, sCtx.nIntNoDataValue,
+                                   sJob.nIntMin, sJob.nIntMax,
+                                   sJob.nIntSum, sJob.nIntSumSquare,
+                                   nSampleCount );
+    }
+    sJob.nValidCount = nSampleCount;
+}
+
 #endif // CPL_HAS_GINT64
 
 /************************************************************************/
@@ -4702,6 +5756,11 @@ void ComputeStatisticsInternal<GUInt16>( int nXCheck,
  * Once computed, the statistics will generally be "set" back on the
  * raster band using SetStatistics().
  *
+ * Starting with GDAL 2.3, the GDAL_NUM_THREADS configuration option can be
+ * set to a number of threads, or ALL_CPUS, to process the blocks in
+ * parallel once they have been read. The result does not depend on the
+ * number of threads.
+ *
  * This method is the same as the C function GDALComputeRasterStatistics().
  *
  * @param bApproxOK If TRUE statistics may be computed based on overviews
@@ -4962,10 +6021,6 @@ GDALRasterBand::ComputeStatistics( int bApproxOK,
                         static_cast<GUInt32>(nBlockXSize * nBlockYSize)) )
         {
             const GUInt32 nMaxValueType = (eDataType == GDT_Byte) ? 255 : 65535;
-            GUInt32 nMin = nMaxValueType;
-            GUInt32 nMax = 0;
-            GUIntBig nSum = 0;
-            GUIntBig nSumSquare = 0;
             // If no valid nodata, map to invalid value (256 for Byte)
             const GUInt32 nNoDataValue =
                 (bGotNoDataValue && dfNoDataValue >= 0 &&
@@ -4975,238 +6030,541 @@ GDALRasterBand::ComputeStatistics( int bApproxOK,
                             static_cast<GUInt32>(dfNoDataValue + 1e-10) :
                             nMaxValueType+1;
 
-            for( int iSampleBlock = 0;
-                iSampleBlock < nBlocksPerRow * nBlocksPerColumn;
-                iSampleBlock += nSampleRate )
-            {
-                const int iYBlock = iSampleBlock / nBlocksPerRow;
-                const int iXBlock = iSampleBlock - nBlocksPerRow * iYBlock;
+            GDALStatsContext sCtx;
+            sCtx.eMode = GSM_INTEGRAL;
+            sCtx.eDataType = eDataType;
+            sCtx.nBlockXSize = nBlockXSize;
+            sCtx.nIntMaxValue = nMaxValueType;
+            sCtx.nIntNoDataValue = nNoDataValue;
+
+            GDALStatsIntegralAccumulator sAcc(nMaxValueType);
+            bool bInterrupted = false;
+            if( GDALStatsProcessBlocks( this, nSampleRate, sCtx,
+                                        GDALStatsMergeIntegral, &sAcc,
+                                        "Compute Statistics",
+                                        pfnProgress, pProgressData,
+                                        &bInterrupted ) != CE_None )
+            {
+                if( bInterrupted )
+                    ReportError( CE_Failure, CPLE_UserInterrupt,
+                                 "User terminated" );
+                return CE_Failure;
+            }
+            const GUInt32 nMin = sAcc.nMin;
+            const GUInt32 nMax = sAcc.nMax;
+            const GUIntBig nSum = sAcc.nSum;
+            const GUIntBig nSumSquare = sAcc.nSumSquare;
+            nSampleCount = sAcc.nSampleCount;
+
+            if( !pfnProgress( 1.0, "Compute Statistics", pProgressData ) )
+            {
+                ReportError( CE_Failure, CPLE_UserInterrupt,
+                             "User terminated" );
+                return CE_Failure;
+            }
+
+/* -------------------------------------------------------------------- */
+/*      Save computed information.                                      */
+/* -------------------------------------------------------------------- */
+            if( nSampleCount )
+                dfMean = static_cast<double>(nSum) / nSampleCount;
+
+            // To avoid potential precision issues when doing the difference,
+            // we need to do that computation on 128 bit rather than casting
+            // to double
+            const GDALUInt128 nTmpForStdDev(
+                    GDALUInt128::Mul(nSumSquare,nSampleCount) -
+                    GDALUInt128::Mul(nSum,nSum));
+            const double dfStdDev =
+                nSampleCount > 0 ?
+                    sqrt(static_cast<double>(nTmpForStdDev)) / nSampleCount :
+                    0.0;
+
+            if( nSampleCount > 0 )
+                SetStatistics( nMin, nMax, dfMean, dfStdDev );
+
+/* -------------------------------------------------------------------- */
+/*      Record results.                                                 */
+/* -------------------------------------------------------------------- */
+            if( pdfMin != nullptr )
+                *pdfMin = nSampleCount ? nMin : 0;
+            if( pdfMax != nullptr )
+                *pdfMax = nSampleCount ? nMax : 0;
+
+            if( pdfMean != nullptr )
+                *pdfMean = dfMean;
+
+            if( pdfStdDev != nullptr )
+                *pdfStdDev = dfStdDev;
+
+            if( nSampleCount > 0 )
+                return CE_None;
+
+            ReportError(
+                CE_Failure, CPLE_AppDefined,
+                "Failed to compute statistics, no valid pixels found in sampling." );
+            return CE_Failure;
+        }
+#endif
+
+        GDALStatsContext sCtx;
+        sCtx.eMode = GSM_MOMENTS;
+        sCtx.eDataType = eDataType;
+        sCtx.nBlockXSize = nBlockXSize;
+        sCtx.bSignedByte = bSignedByte;
+        sCtx.bGotNoDataValue = CPL_TO_BOOL(bGotNoDataValue);
+        sCtx.dfNoDataValue = dfNoDataValue;
+        sCtx.bGotFloatNoDataValue = bGotFloatNoDataValue;
+        sCtx.fNoDataValue = fNoDataValue;
+
+        GDALStatsAccumulator sAcc;
+        bool bInterrupted = false;
+        if( GDALStatsProcessBlocks( this, nSampleRate, sCtx,
+                                    GDALStatsMergeMoments, &sAcc,
+                                    "Compute Statistics",
+                                    pfnProgress, pProgressData,
+                                    &bInterrupted ) != CE_None )
+        {
+            if( bInterrupted )
+                ReportError( CE_Failure, CPLE_UserInterrupt,
+                             "User terminated" );
+            return CE_Failure;
+        }
+        nSampleCount = sAcc.nCount;
+        if( nSampleCount > 0 )
+        {
+            dfMin = sAcc.dfMin;
+            dfMax = sAcc.dfMax;
+            dfMean = sAcc.dfMean;
+            dfM2 = sAcc.dfM2;
+        }
+    }
+
+    if( !pfnProgress( 1.0, "Compute Statistics", pProgressData ) )
+    {
+        ReportError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+        return CE_Failure;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Save computed information.                                      */
+/* -------------------------------------------------------------------- */
+    const double dfStdDev =
+        nSampleCount > 0 ? sqrt(dfM2 / nSampleCount) : 0.0;
+
+    if( nSampleCount > 0 )
+        SetStatistics( dfMin, dfMax, dfMean, dfStdDev );
+
+/* -------------------------------------------------------------------- */
+/*      Record results.                                                 */
+/* -------------------------------------------------------------------- */
+    if( pdfMin != nullptr )
+        *pdfMin = dfMin;
+    if( pdfMax != nullptr )
+        *pdfMax = dfMax;
+
+    if( pdfMean != nullptr )
+        *pdfMean = dfMean;
+
+    if( pdfStdDev != nullptr )
+        *pdfStdDev = dfStdDev;
+
+    if( nSampleCount > 0 )
+        return CE_None;
+
+    ReportError(
+        CE_Failure, CPLE_AppDefined,
+        "Failed to compute statistics, no valid pixels found in sampling." );
+    return CE_Failure;
+}
+
+/************************************************************************/
+/*                    GDALComputeRasterStatistics()                     */
+/************************************************************************/
+
+/**
+  * \brief Compute image statistics.
+  *
+  * @see GDALRasterBand::ComputeStatistics()
+  */
+
+CPLErr CPL_STDCALL GDALComputeRasterStatistics(
+        GDALRasterBandH hBand, int bApproxOK,
+        double *pdfMin, double *pdfMax, double *pdfMean, double *pdfStdDev,
+        GDALProgressFunc pfnProgress, void *pProgressData )
+
+{
+    VALIDATE_POINTER1( hBand, "GDALComputeRasterStatistics", CE_Failure );
+
+    GDALRasterBand *poBand = GDALRasterBand::FromHandle(hBand);
+
+    return poBand->ComputeStatistics(
+        bApproxOK, pdfMin, pdfMax, pdfMean, pdfStdDev,
+        pfnProgress, pProgressData );
+}
+
+/************************************************************************/
+/*                   ComputeStatisticsAndHistogram()                    */
+/************************************************************************/
+
+/**
+ * \brief Compute image statistics, histogram and percentiles in one pass.
+ *
+ * Computes with a single read of the band what ComputeStatistics() and
+ * GetHistogram() would compute with two, as well as approximate percentiles.
+ * Blocks are processed in parallel if the GDAL_NUM_THREADS configuration
+ * option is set, as in ComputeStatistics().
+ *
+ * The statistics are set with SetStatistics(), the histogram with
+ * SetDefaultHistogram() and the percentiles as STATISTICS_PERCENTILE_xx
+ * metadata items (for example STATISTICS_PERCENTILE_99.5), so that they
+ * are saved in the .aux.xml file by GDALPamRasterBand.
+ *
+ * If pdfHistMin and pdfHistMax point to values such that *pdfHistMin is
+ * lower than *pdfHistMax, they are the bounds of the histogram. Otherwise
+ * they receive the same bounds as GetDefaultHistogram() would use: the
+ * histogram is then exact for Byte, UInt16 and Int16 bands, and derived from
+ * the percentile summary, thus approximate, for other data types. Values out
+ * of the bounds are counted in the first and last buckets. An approximate
+ * histogram is returned in panHistogram, but not set as the default
+ * histogram.
+ *
+ * Percentiles are estimated with a t-digest, whose error is the lowest near
+ * the extreme percentiles.
+ *
+ * Complex data types are not supported.
+ *
+ * This method is the same as the C function
+ * GDALComputeRasterStatisticsAndHistogram().
+ *
+ * @param bApproxOK If TRUE the computation may be based on overviews
+ * or a subset of all tiles.
+ * @param pdfMin Location into which to load image minimum (may be NULL).
+ * @param pdfMax Location into which to load image maximum (may be NULL).
+ * @param pdfMean Location into which to load image mean (may be NULL).
+ * @param pdfStdDev Location into which to load image standard deviation
+ * (may be NULL).
+ * @param pdfHistMin lower bound of the histogram (may be NULL).
+ * @param pdfHistMax upper bound of the histogram (may be NULL).
+ * @param nBuckets the number of buckets in panHistogram.
+ * @param panHistogram array into which the histogram totals are placed, or
+ * NULL if no histogram is wanted.
+ * @param nPercentiles number of values in padfPercentiles.
+ * @param padfPercentiles percentiles to compute, between 0 and 100.
+ * @param padfPercentileValues array of nPercentiles values into which the
+ * percentiles are placed.
+ * @param pfnProgress a function to call to report progress, or NULL.
+ * @param pProgressData application data to pass to the progress function.
+ *
+ * @return CE_None on success, or CE_Failure if an error occurs or processing
+ * is terminated by the user.
+ * @since GDAL 2.3
+ */
+
+CPLErr GDALRasterBand::ComputeStatisticsAndHistogram(
+    int bApproxOK,
+    double *pdfMin, double *pdfMax, double *pdfMean, double *pdfStdDev,
+    double *pdfHistMin, double *pdfHistMax,
+    int nBuckets, GUIntBig *panHistogram,
+    int nPercentiles, const double *padfPercentiles,
+    double *padfPercentileValues,
+    GDALProgressFunc pfnProgress, void *pProgressData )
+
+{
+    if( pfnProgress == nullptr )
+        pfnProgress = GDALDummyProgress;
+
+    if( GDALDataTypeIsComplex(eDataType) )
+    {
+        ReportError( CE_Failure, CPLE_NotSupported,
+                     "ComputeStatisticsAndHistogram() not supported on "
+                     "complex data types." );
+        return CE_Failure;
+    }
+    if( panHistogram == nullptr || nBuckets < 0 )
+        nBuckets = 0;
+    if( nPercentiles < 0 ||
+        (nPercentiles > 0 && (padfPercentiles == nullptr ||
+                              padfPercentileValues == nullptr)) )
+    {
+        ReportError( CE_Failure, CPLE_IllegalArg,
+                     "Invalid percentile arguments." );
+        return CE_Failure;
+    }
+    for( int i = 0; i < nPercentiles; i++ )
+    {
+        if( !(padfPercentiles[i] >= 0.0 && padfPercentiles[i] <= 100.0) )
+        {
+            ReportError( CE_Failure, CPLE_IllegalArg,
+                         "Percentile %g is not between 0 and 100.",
+                         padfPercentiles[i] );
+            return CE_Failure;
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      If we have overview bands, use them for statistics.             */
+/* -------------------------------------------------------------------- */
+    if( bApproxOK && GetOverviewCount() > 0 && !HasArbitraryOverviews() )
+    {
+        GDALRasterBand *poBand
+            = GetRasterSampleOverview( GDALSTAT_APPROX_NUMSAMPLES );
 
-                GDALRasterBlock * const poBlock =
-                    GetLockedBlockRef( iXBlock, iYBlock );
-                if( poBlock == nullptr )
-                    return CE_Failure;
+        if( poBand != this )
+            return poBand->ComputeStatisticsAndHistogram(
+                FALSE, pdfMin, pdfMax, pdfMean, pdfStdDev,
+                pdfHistMin, pdfHistMax, nBuckets, panHistogram,
+                nPercentiles, padfPercentiles, padfPercentileValues,
+                pfnProgress, pProgressData );
+    }
 
-                void* const pData = poBlock->GetDataRef();
+    if( !pfnProgress( 0.0, "Compute Statistics", pProgressData ) )
+    {
+        ReportError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+        return CE_Failure;
+    }
 
-                int nXCheck = nBlockXSize;
-                if( (iXBlock+1) * nBlockXSize > GetXSize() )
-                    nXCheck = GetXSize() - iXBlock * nBlockXSize;
+    if( !InitBlockInfo() )
+        return CE_Failure;
 
-                int nYCheck = nBlockYSize;
-                if( (iYBlock+1) * nBlockYSize > GetYSize() )
-                    nYCheck = GetYSize() - iYBlock * nBlockYSize;
+    int bGotNoDataValue = FALSE;
+    const double dfNoDataValue = GetNoDataValue( &bGotNoDataValue );
+    bGotNoDataValue = bGotNoDataValue && !CPLIsNan(dfNoDataValue);
+    bool bGotFloatNoDataValue = false;
+    float fNoDataValue = 0.0f;
+    if( eDataType == GDT_Float32 && bGotNoDataValue &&
+        GDALIsValueInRange<float>(dfNoDataValue) )
+    {
+        fNoDataValue = static_cast<float>(dfNoDataValue);
+        bGotFloatNoDataValue = true;
+        bGotNoDataValue = false;
+    }
 
-                if( eDataType == GDT_Byte )
-                {
-                    ComputeStatisticsInternal( nXCheck,
-                                               nBlockXSize,
-                                               nYCheck,
-                                               static_cast<const GByte*>(pData),
-                                               nNoDataValue <= nMaxValueType,
-                                               nNoDataValue,
-                                               nMin, nMax, nSum,
-                                               nSumSquare,
-                                               nSampleCount );
-                }
-                else
-                {
-                    ComputeStatisticsInternal( nXCheck,
-                                               nBlockXSize,
-                                               nYCheck,
-                                               static_cast<const GUInt16*>(pData),
-                                               nNoDataValue <= nMaxValueType,
-                                               nNoDataValue,
-                                               nMin, nMax, nSum,
-                                               nSumSquare,
-                                               nSampleCount );
-                }
+    const char* pszPixelType =
+        GetMetadataItem("PIXELTYPE", "IMAGE_STRUCTURE");
+    const bool bSignedByte =
+        pszPixelType != nullptr && EQUAL(pszPixelType, "SIGNEDBYTE");
 
-                poBlock->DropLock();
+    int nSampleRate = 1;
+    if ( bApproxOK )
+    {
+        nSampleRate = static_cast<int>(
+            std::max(1.0,
+                     sqrt(static_cast<double>(nBlocksPerRow) *
+                          nBlocksPerColumn)));
+        // We want to avoid probing only the first column of blocks for
+        // a square shaped raster, because it is not unlikely that it may
+        // be padding only (#6378)
+        if( nSampleRate == nBlocksPerRow && nBlocksPerRow > 1 )
+          nSampleRate += 1;
+    }
 
-                if ( !pfnProgress( iSampleBlock
-                        / static_cast<double>(nBlocksPerRow*nBlocksPerColumn),
-                        "Compute Statistics", pProgressData) )
-                {
-                    ReportError( CE_Failure, CPLE_UserInterrupt,
-                                 "User terminated" );
-                    return CE_Failure;
-                }
-            }
+    GDALStatsContext sCtx;
+    sCtx.eMode = GSM_MULTI;
+    sCtx.eDataType = eDataType;
+    sCtx.nBlockXSize = nBlockXSize;
+    sCtx.bSignedByte = bSignedByte;
+    sCtx.bGotNoDataValue = CPL_TO_BOOL(bGotNoDataValue);
+    sCtx.dfNoDataValue = dfNoDataValue;
+    sCtx.bGotFloatNoDataValue = bGotFloatNoDataValue;
+    sCtx.fNoDataValue = fNoDataValue;
+    sCtx.bDigest = nPercentiles > 0;
 
-            if( !pfnProgress( 1.0, "Compute Statistics", pProgressData ) )
-            {
-                ReportError( CE_Failure, CPLE_UserInterrupt,
-                             "User terminated" );
-                return CE_Failure;
-            }
+#ifdef CPL_HAS_GINT64
+    // Same integral computations as in ComputeStatistics().
+    if( (eDataType == GDT_Byte && !bSignedByte &&
+         static_cast<GUIntBig>(nBlocksPerRow)*nBlocksPerColumn/nSampleRate <
+            GUINTBIG_MAX / (255U * 255U) /
+                    static_cast<GUInt32>(nBlockXSize * nBlockYSize)) ||
+        (eDataType == GDT_UInt16 &&
+         static_cast<GUIntBig>(nBlocksPerRow)*nBlocksPerColumn/nSampleRate <
+            GUINTBIG_MAX / (65535U * 65535U) /
+                    static_cast<GUInt32>(nBlockXSize * nBlockYSize)) )
+    {
+        sCtx.nIntMaxValue = (eDataType == GDT_Byte) ? 255 : 65535;
+        sCtx.nIntNoDataValue =
+            (bGotNoDataValue && dfNoDataValue >= 0 &&
+             dfNoDataValue <= sCtx.nIntMaxValue &&
+             fabs(dfNoDataValue -
+                  static_cast<GUInt32>(dfNoDataValue + 1e-10)) < 1e-10 ) ?
+                        static_cast<GUInt32>(dfNoDataValue + 1e-10) :
+                        sCtx.nIntMaxValue + 1;
+    }
+#endif
 
 /* -------------------------------------------------------------------- */
-/*      Save computed information.                                      */
+/*      Histogram settings. With default bounds, they are only known    */
+/*      at the end, so for 8 and 16 bit data types we count each value */
+/*      and dispatch the counts in the buckets at the end.              */
 /* -------------------------------------------------------------------- */
-            if( nSampleCount )
-                dfMean = static_cast<double>(nSum) / nSampleCount;
-
-            // To avoid potential precision issues when doing the difference,
-            // we need to do that computation on 128 bit rather than casting
-            // to double
-            const GDALUInt128 nTmpForStdDev(
-                    GDALUInt128::Mul(nSumSquare,nSampleCount) -
-                    GDALUInt128::Mul(nSum,nSum));
-            const double dfStdDev =
-                nSampleCount > 0 ?
-                    sqrt(static_cast<double>(nTmpForStdDev)) / nSampleCount :
-                    0.0;
-
-            if( nSampleCount > 0 )
-                SetStatistics( nMin, nMax, dfMean, dfStdDev );
+    const bool bDefaultHistBounds =
+        nBuckets > 0 &&
+        (pdfHistMin == nullptr || pdfHistMax == nullptr ||
+         !(*pdfHistMin < *pdfHistMax));
+    double dfHistMin = 0.0;
+    double dfHistMax = 0.0;
+    std::vector<GUIntBig> anValueHistogram;
+    double dfFirstValue = 0.0;
+    if( nBuckets > 0 )
+    {
+        memset( panHistogram, 0, sizeof(GUIntBig) * nBuckets );
+        sCtx.bIncludeOutOfRange = true;
+        if( !bDefaultHistBounds ||
+            (eDataType == GDT_Byte && !bSignedByte) )
+        {
+            dfHistMin = bDefaultHistBounds ? -0.5 : *pdfHistMin;
+            dfHistMax = bDefaultHistBounds ? 255.5 : *pdfHistMax;
+            sCtx.dfHistMin = dfHistMin;
+            sCtx.dfHistScale = nBuckets / (dfHistMax - dfHistMin);
+            sCtx.nBuckets = nBuckets;
+        }
+        else if( eDataType == GDT_Byte || eDataType == GDT_UInt16 ||
+                 eDataType == GDT_Int16 )
+        {
+            dfFirstValue = bSignedByte ? -128.0 :
+                           (eDataType == GDT_Int16) ? -32768.0 : 0.0;
+            anValueHistogram.resize(eDataType == GDT_Byte ? 256 : 65536);
+            sCtx.dfHistMin = dfFirstValue - 0.5;
+            sCtx.dfHistScale = 1.0;
+            sCtx.nBuckets = static_cast<int>(anValueHistogram.size());
+        }
+        else
+        {
+            sCtx.bDigest = true;
+        }
+    }
 
 /* -------------------------------------------------------------------- */
-/*      Record results.                                                 */
+/*      Read the blocks.                                                */
 /* -------------------------------------------------------------------- */
-            if( pdfMin != nullptr )
-                *pdfMin = nSampleCount ? nMin : 0;
-            if( pdfMax != nullptr )
-                *pdfMax = nSampleCount ? nMax : 0;
-
-            if( pdfMean != nullptr )
-                *pdfMean = dfMean;
-
-            if( pdfStdDev != nullptr )
-                *pdfStdDev = dfStdDev;
-
-            if( nSampleCount > 0 )
-                return CE_None;
+    GDALStatsMultiAccumulator sAcc(&sCtx);
+    if( sCtx.nBuckets > 0 )
+        sAcc.panHistogram = anValueHistogram.empty() ?
+                                panHistogram : anValueHistogram.data();
+
+    bool bInterrupted = false;
+    if( GDALStatsProcessBlocks( this, nSampleRate, sCtx,
+                                GDALStatsMergeMulti, &sAcc,
+                                "Compute Statistics",
+                                pfnProgress, pProgressData,
+                                &bInterrupted ) != CE_None )
+    {
+        if( bInterrupted )
+            ReportError( CE_Failure, CPLE_UserInterrupt,
+                         "User terminated" );
+        return CE_Failure;
+    }
+    if( sCtx.bDigest )
+        GDALStatsDigestMerge(sAcc.aoDigest,
+                             std::vector<GDALStatsCentroid>(), true);
 
-            ReportError(
-                CE_Failure, CPLE_AppDefined,
-                "Failed to compute statistics, no valid pixels found in sampling." );
-            return CE_Failure;
+/* -------------------------------------------------------------------- */
+/*      Statistics.                                                     */
+/* -------------------------------------------------------------------- */
+    GUIntBig nSampleCount = 0;
+    double dfMin = 0.0;
+    double dfMax = 0.0;
+    double dfMean = 0.0;
+    double dfStdDev = 0.0;
+#ifdef CPL_HAS_GINT64
+    if( sCtx.nIntMaxValue > 0 )
+    {
+        const GDALStatsIntegralAccumulator& oIntegral = sAcc.oIntegral;
+        nSampleCount = oIntegral.nSampleCount;
+        if( nSampleCount > 0 )
+        {
+            dfMin = oIntegral.nMin;
+            dfMax = oIntegral.nMax;
+            dfMean = static_cast<double>(oIntegral.nSum) / nSampleCount;
+            const GDALUInt128 nTmpForStdDev(
+                    GDALUInt128::Mul(oIntegral.nSumSquare, nSampleCount) -
+                    GDALUInt128::Mul(oIntegral.nSum, oIntegral.nSum));
+            dfStdDev = sqrt(static_cast<double>(nTmpForStdDev)) /
+                       nSampleCount;
         }
+    }
+    else
 #endif
-
-        for( int iSampleBlock = 0;
-             iSampleBlock < nBlocksPerRow * nBlocksPerColumn;
-             iSampleBlock += nSampleRate )
+    {
+        const GDALStatsAccumulator& oMoments = sAcc.oMoments;
+        nSampleCount = oMoments.nCount;
+        if( nSampleCount > 0 )
         {
-            const int iYBlock = iSampleBlock / nBlocksPerRow;
-            const int iXBlock = iSampleBlock - nBlocksPerRow * iYBlock;
-
-            GDALRasterBlock * const poBlock = GetLockedBlockRef( iXBlock, iYBlock );
-            if( poBlock == nullptr )
-                return CE_Failure;
-
-            void* const pData = poBlock->GetDataRef();
-
-            int nXCheck = nBlockXSize;
-            if( (iXBlock+1) * nBlockXSize > GetXSize() )
-                nXCheck = GetXSize() - iXBlock * nBlockXSize;
+            dfMin = oMoments.dfMin;
+            dfMax = oMoments.dfMax;
+            dfMean = oMoments.dfMean;
+            dfStdDev = sqrt(oMoments.dfM2 / nSampleCount);
+        }
+    }
 
-            int nYCheck = nBlockYSize;
-            if( (iYBlock+1) * nBlockYSize > GetYSize() )
-                nYCheck = GetYSize() - iYBlock * nBlockYSize;
+    if( nSampleCount == 0 )
+    {
+        ReportError(
+            CE_Failure, CPLE_AppDefined,
+            "Failed to compute statistics, no valid pixels found in sampling." );
+        return CE_Failure;
+    }
 
-            // This isn't the fastest way to do this, but is easier for now.
-            for( int iY = 0; iY < nYCheck; iY++ )
+/* -------------------------------------------------------------------- */
+/*      Histogram with default bounds, as in GetDefaultHistogram().     */
+/* -------------------------------------------------------------------- */
+    if( bDefaultHistBounds && !(eDataType == GDT_Byte && !bSignedByte) )
+    {
+        const double dfHalfBucket =
+            nBuckets > 1 ? (dfMax - dfMin) / (2 * (nBuckets - 1)) : 0.5;
+        dfHistMin = dfMin - dfHalfBucket;
+        dfHistMax = dfMax + dfHalfBucket;
+        const double dfScale =
+            (dfHistMax > dfHistMin) ? nBuckets / (dfHistMax - dfHistMin) : 0.0;
+
+        if( !anValueHistogram.empty() )
+        {
+            for( size_t i = 0; i < anValueHistogram.size(); i++ )
             {
-                for( int iX = 0; iX < nXCheck; iX++ )
-                {
-                    const int iOffset = iX + iY * nBlockXSize;
-                    double dfValue = 0.0;
-
-                    switch( eDataType )
-                    {
-                      case GDT_Byte:
-                      {
-                        if( bSignedByte )
-                            dfValue =
-                                static_cast<signed char *>(pData)[iOffset];
-                        else
-                            dfValue = static_cast<GByte *>(pData)[iOffset];
-                        break;
-                      }
-                      case GDT_UInt16:
-                        dfValue = static_cast<GUInt16 *>(pData)[iOffset];
-                        break;
-                      case GDT_Int16:
-                        dfValue = static_cast<GInt16 *>(pData)[iOffset];
-                        break;
-                      case GDT_UInt32:
-                        dfValue = static_cast<GUInt32 *>(pData)[iOffset];
-                        break;
-                      case GDT_Int32:
-                        dfValue = static_cast<GInt32 *>(pData)[iOffset];
-                        break;
-                      case GDT_Float32:
-                      {
-                        const float fValue = static_cast<float *>(pData)[iOffset];
-                        if( CPLIsNan(fValue) ||
-                            (bGotFloatNoDataValue && ARE_REAL_EQUAL(fValue, fNoDataValue)) )
-                            continue;
-                        dfValue = fValue;
-                        break;
-                      }
-                      case GDT_Float64:
-                        dfValue = ((double *)pData)[iOffset];
-                        if( CPLIsNan(dfValue) )
-                            continue;
-                        break;
-                      case GDT_CInt16:
-                        dfValue = static_cast<GInt16 *>(pData)[iOffset*2];
-                        break;
-                      case GDT_CInt32:
-                        dfValue = static_cast<GInt32 *>(pData)[iOffset*2];
-                        break;
-                      case GDT_CFloat32:
-                        dfValue = static_cast<float *>(pData)[iOffset*2];
-                        if( CPLIsNan(dfValue) )
-                            continue;
-                        break;
-                      case GDT_CFloat64:
-                        dfValue = static_cast<double *>(pData)[iOffset*2];
-                        if( CPLIsNan(dfValue) )
-                            continue;
-                        break;
-                      default:
-                        CPLAssert( false );
-                    }
-
-                    if( eDataType != GDT_Float32 && bGotNoDataValue &&
-                        ARE_REAL_EQUAL(dfValue, dfNoDataValue) )
-                        continue;
-
-                    if( bFirstValue )
-                    {
-                        dfMin = dfValue;
-                        dfMax = dfValue;
-                        bFirstValue = false;
-                    }
-                    else
-                    {
-                        dfMin = std::min(dfMin, dfValue);
-                        dfMax = std::max(dfMax, dfValue);
-                    }
-
-                    nSampleCount++;
-                    const double dfDelta = dfValue - dfMean;
-                    dfMean += dfDelta / nSampleCount;
-                    dfM2 += dfDelta * (dfValue - dfMean);
-                }
+                if( anValueHistogram[i] == 0 )
+                    continue;
+                const double dfValue = dfFirstValue + static_cast<double>(i);
+                const int nIndex = static_cast<int>(
+                    floor((dfValue - dfHistMin) * dfScale));
+                panHistogram[std::max(0, std::min(nBuckets - 1, nIndex))] +=
+                    anValueHistogram[i];
             }
-
-            poBlock->DropLock();
-
-            if ( !pfnProgress(
-                     iSampleBlock
-                         / static_cast<double>(nBlocksPerRow*nBlocksPerColumn),
-                     "Compute Statistics", pProgressData) )
+        }
+        else if( dfScale == 0.0 )
+        {
+            panHistogram[0] = nSampleCount;
+        }
+        else
+        {
+            GUIntBig nCountBefore = 0;
+            for( int i = 0; i < nBuckets; i++ )
             {
-                ReportError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
-                return CE_Failure;
+                GUIntBig nCount = nSampleCount;
+                if( i < nBuckets - 1 )
+                {
+                    const double dfRank = GDALStatsDigestInterpolate(
+                        sAcc.aoDigest, dfMin, dfMax,
+                        dfHistMin + (i + 1) / dfScale, false);
+                    nCount = std::min(nSampleCount,
+                        std::max(nCountBefore,
+                                 static_cast<GUIntBig>(dfRank + 0.5)));
+                }
+                panHistogram[i] = nCount - nCountBefore;
+                nCountBefore = nCount;
             }
         }
     }
 
+/* -------------------------------------------------------------------- */
+/*      Percentiles.                                                    */
+/* -------------------------------------------------------------------- */
+    for( int i = 0; i < nPercentiles; i++ )
+    {
+        padfPercentileValues[i] = GDALStatsDigestInterpolate(
+            sAcc.aoDigest, dfMin, dfMax,
+            padfPercentiles[i] / 100.0 * nSampleCount, true);
+    }
+
     if( !pfnProgress( 1.0, "Compute Statistics", pProgressData ) )
     {
         ReportError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
@@ -5216,11 +6574,24 @@ GDALRasterBand::ComputeStatistics( int bApproxOK,
 /* -------------------------------------------------------------------- */
 /*      Save computed information.                                      */
 /* -------------------------------------------------------------------- */
-    const double dfStdDev =
-        nSampleCount > 0 ? sqrt(dfM2 / nSampleCount) : 0.0;
-
-    if( nSampleCount > 0 )
-        SetStatistics( dfMin, dfMax, dfMean, dfStdDev );
+    SetStatistics( dfMin, dfMax, dfMean, dfStdDev );
+    // The histogram derived from the percentile summary is not saved, as
+    // GetDefaultHistogram() would then return it as if it was exact.
+    const bool bDigestHistogram =
+        bDefaultHistBounds && anValueHistogram.empty() &&
+        !(eDataType == GDT_Byte && !bSignedByte);
+    if( nBuckets > 0 && !bDigestHistogram )
+    {
+        CPLPushErrorHandler(CPLQuietErrorHandler);
+        SetDefaultHistogram( dfHistMin, dfHistMax, nBuckets, panHistogram );
+        CPLPopErrorHandler();
+    }
+    for( int i = 0; i < nPercentiles; i++ )
+    {
+        SetMetadataItem(
+            CPLSPrintf("STATISTICS_PERCENTILE_%g", padfPercentiles[i]),
+            CPLSPrintf("%.14g", padfPercentileValues[i]) );
+    }
 
 /* -------------------------------------------------------------------- */
 /*      Record results.                                                 */
@@ -5229,44 +6600,48 @@ GDALRasterBand::ComputeStatistics( int bApproxOK,
         *pdfMin = dfMin;
     if( pdfMax != nullptr )
         *pdfMax = dfMax;
-
     if( pdfMean != nullptr )
         *pdfMean = dfMean;
-
     if( pdfStdDev != nullptr )
         *pdfStdDev = dfStdDev;
+    if( nBuckets > 0 && pdfHistMin != nullptr )
+        *pdfHistMin = dfHistMin;
+    if( nBuckets > 0 && pdfHistMax != nullptr )
+        *pdfHistMax = dfHistMax;
 
-    if( nSampleCount > 0 )
-        return CE_None;
-
-    ReportError(
-        CE_Failure, CPLE_AppDefined,
-        "Failed to compute statistics, no valid pixels found in sampling." );
-    return CE_Failure;
+    return CE_None;
 }
 
 /************************************************************************/
-/*                    GDALComputeRasterStatistics()                     */
+/*               GDALComputeRasterStatisticsAndHistogram()              */
 /************************************************************************/
 
 /**
-  * \brief Compute image statistics.
+  * \brief Compute image statistics, histogram and percentiles in one pass.
   *
-  * @see GDALRasterBand::ComputeStatistics()
+  * @see GDALRasterBand::ComputeStatisticsAndHistogram()
+  * @since GDAL 2.3
   */
 
-CPLErr CPL_STDCALL GDALComputeRasterStatistics(
+CPLErr CPL_STDCALL GDALComputeRasterStatisticsAndHistogram(
         GDALRasterBandH hBand, int bApproxOK,
         double *pdfMin, double *pdfMax, double *pdfMean, double *pdfStdDev,
+        double *pdfHistMin, double *pdfHistMax,
+        int nBuckets, GUIntBig *panHistogram,
+        int nPercentiles, const double *padfPercentiles,
+        double *padfPercentileValues,
         GDALProgressFunc pfnProgress, void *pProgressData )
 
 {
-    VALIDATE_POINTER1( hBand, "GDALComputeRasterStatistics", CE_Failure );
+    VALIDATE_POINTER1( hBand, "GDALComputeRasterStatisticsAndHistogram",
+                       CE_Failure );
 
     GDALRasterBand *poBand = GDALRasterBand::FromHandle(hBand);
 
-    return poBand->ComputeStatistics(
+    return poBand->ComputeStatisticsAndHistogram(
         bApproxOK, pdfMin, pdfMax, pdfMean, pdfStdDev,
+        pdfHistMin, pdfHistMax, nBuckets, panHistogram,
+        nPercentiles, padfPercentiles, padfPercentileValues,
         pfnProgress, pProgressData );
 }
 
@@ -5574,110 +6949,30 @@ CPLErr GDALRasterBand::ComputeRasterMinMax( int bApproxOK,
               nSampleRate += 1;
         }
 
-        for( int iSampleBlock = 0;
-             iSampleBlock < nBlocksPerRow * nBlocksPerColumn;
-             iSampleBlock += nSampleRate )
+        GDALStatsContext sCtx;
+        sCtx.eMode = GSM_MINMAX;
+        sCtx.eDataType = eDataType;
+        sCtx.nBlockXSize = nBlockXSize;
+        sCtx.bSignedByte = bSignedByte;
+        sCtx.bGotNoDataValue = CPL_TO_BOOL(bGotNoDataValue);
+        sCtx.dfNoDataValue = dfNoDataValue;
+        sCtx.bGotFloatNoDataValue = bGotFloatNoDataValue;
+        sCtx.fNoDataValue = fNoDataValue;
+
+        GDALStatsAccumulator sAcc;
+        bool bInterrupted = false;
+        if( GDALStatsProcessBlocks( this, nSampleRate, sCtx,
+                                    GDALStatsMergeMoments, &sAcc,
+                                    nullptr, GDALDummyProgress, nullptr,
+                                    &bInterrupted ) != CE_None )
         {
-            const int iYBlock = iSampleBlock / nBlocksPerRow;
-            const int iXBlock = iSampleBlock - nBlocksPerRow * iYBlock;
-
-            GDALRasterBlock *poBlock = GetLockedBlockRef( iXBlock, iYBlock );
-            if( poBlock == nullptr )
-                return CE_Failure;
-
-            void * const pData = poBlock->GetDataRef();
-
-            int nXCheck = nBlockXSize;
-            if( (iXBlock+1) * nBlockXSize > GetXSize() )
-                nXCheck = GetXSize() - iXBlock * nBlockXSize;
-
-            int nYCheck = nBlockYSize;
-            if( (iYBlock+1) * nBlockYSize > GetYSize() )
-                nYCheck = GetYSize() - iYBlock * nBlockYSize;
-
-            // This isn't the fastest way to do this, but is easier for now.
-            for( int iY = 0; iY < nYCheck; iY++ )
-            {
-                for( int iX = 0; iX < nXCheck; iX++ )
-                {
-                    const int iOffset = iX + iY * nBlockXSize;
-                    double dfValue = 0.0;
-
-                    switch( eDataType )
-                    {
-                      case GDT_Byte:
-                      {
-                        if (bSignedByte)
-                            dfValue = static_cast<signed char *>(pData)[iOffset];
-                        else
-                            dfValue = static_cast<GByte *>(pData)[iOffset];
-                        break;
-                      }
-                      case GDT_UInt16:
-                        dfValue = static_cast<GUInt16 *>(pData)[iOffset];
-                        break;
-                      case GDT_Int16:
-                        dfValue = static_cast<GInt16 *>(pData)[iOffset];
-                        break;
-                      case GDT_UInt32:
-                        dfValue = static_cast<GUInt32 *>(pData)[iOffset];
-                        break;
-                      case GDT_Int32:
-                        dfValue = static_cast<GInt32 *>(pData)[iOffset];
-                        break;
-                      case GDT_Float32:
-                      {
-                          const float fValue = static_cast<float *>(pData)[iOffset];
-                          if( CPLIsNan(fValue) ||
-                              (bGotFloatNoDataValue && ARE_REAL_EQUAL(fValue, fNoDataValue)) )
-                              continue;
-                          dfValue = fValue;
-                          break;
-                      }
-                      case GDT_Float64:
-                        dfValue = static_cast<double *>(pData)[iOffset];
-                        if( CPLIsNan(dfValue) )
-                            continue;
-                        break;
-                      case GDT_CInt16:
-                        dfValue = static_cast<GInt16 *>(pData)[iOffset*2];
-                        break;
-                      case GDT_CInt32:
-                        dfValue = static_cast<GInt32 *>(pData)[iOffset*2];
-                        break;
-                      case GDT_CFloat32:
-                        dfValue = static_cast<float *>(pData)[iOffset*2];
-                        if( CPLIsNan(dfValue) )
-                            continue;
-                        break;
-                      case GDT_CFloat64:
-                        dfValue = static_cast<double *>(pData)[iOffset*2];
-                        if( CPLIsNan(dfValue) )
-                            continue;
-                        break;
-                      default:
-                        CPLAssert( false );
-                    }
-
-                    if( eDataType != GDT_Float32 && bGotNoDataValue &&
-                        ARE_REAL_EQUAL(dfValue, dfNoDataValue) )
-                        continue;
-
-                    if( bFirstValue )
-                    {
-                        dfMin = dfValue;
-                        dfMax = dfValue;
-                        bFirstValue = false;
-                    }
-                    else
-                    {
-                        dfMin = std::min(dfMin, dfValue);
-                        dfMax = std::max(dfMax, dfValue);
-                    }
-                }
-            }
-
-            poBlock->DropLock();
+            return CE_Failure;
+        }
+        if( sAcc.nCount > 0 )
+        {
+            dfMin = sAcc.dfMin;
+            dfMax = sAcc.dfMax;
+            bFirstValue = false;
         }
     }
 
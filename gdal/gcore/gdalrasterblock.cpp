@@ -33,6 +33,7 @@
 #include "gdal_priv.h"
 
 #include <algorithm>
+#include <atomic>
 #include <climits>
 #include <cstring>
 
@@ -48,21 +49,37 @@ CPL_CVSID("$Id$")
 static bool bCacheMaxInitialized = false;
 // Will later be overridden by the default 5% if GDAL_CACHEMAX not defined.
 static GIntBig nCacheMax = 40 * 1024 * 1024;
-static volatile GIntBig nCacheUsed = 0;
 
-static GDALRasterBlock *poOldest = nullptr;  // Tail.
-static GDALRasterBlock *poNewest = nullptr;  // Head.
+/* -------------------------------------------------------------------- */
+/*      The global block cache is split into shards, each one with its  */
+/*      own lock, LRU list and memory accounting, so that threads       */
+/*      working on unrelated blocks do not contend on a single lock.    */
+/*      A block is assigned to a shard from a hash of its band and      */
+/*      block coordinates. The GDAL_CACHEMAX limit applies to the sum   */
+/*      of the memory used by all shards.                               */
+/* -------------------------------------------------------------------- */
 
-static int nDisableDirtyBlockFlushCounter = 0;
+#define GDAL_RB_MAX_SHARDS  64
 
-#if 0
-static CPLMutex *hRBLock = nullptr;
-#define INITIALIZE_LOCK CPLMutexHolderD( &hRBLock )
-#define TAKE_LOCK       CPLMutexHolderOptionalLockD( hRBLock )
-#define DESTROY_LOCK    CPLDestroyMutex( hRBLock )
-#else
+typedef struct
+{
+    CPLLock          *hLock;
+    GDALRasterBlock  *poOldest;  // Tail.
+    GDALRasterBlock  *poNewest;  // Head.
+    // Modified under hLock, but read without it by GetCacheUsed().
+    std::atomic<GIntBig> nCacheUsed;
+    // Avoid false sharing between shards of adjacent indices.
+    GByte             abyPadding[64 - 3 * sizeof(void*) -
+                                 sizeof(std::atomic<GIntBig>)];
+} GDALRBCacheShard;
+
+static GDALRBCacheShard asShards[GDAL_RB_MAX_SHARDS];
+static int nShards = 0;
+static unsigned int nShardMask = 0;
+static bool bClockPolicy = false;
+
+static int nDisableDirtyBlockFlushCounter = 0;
 
-static CPLLock* hRBLock = nullptr;
 static bool bDebugContention = false;
 static bool bSleepsForBockCacheDebug = false;
 static CPLLockType GetLockType()
@@ -92,12 +109,101 @@ static CPLLockType GetLockType()
     return (CPLLockType) nLockType;
 }
 
-#define INITIALIZE_LOCK         CPLLockHolderD( &hRBLock, GetLockType() ); \
-                                CPLLockSetDebugPerf(hRBLock, bDebugContention)
-#define TAKE_LOCK               CPLLockHolderOptionalLockD( hRBLock )
-#define DESTROY_LOCK            CPLDestroyLock( hRBLock )
+/************************************************************************/
+/*                         ComputeShardCount()                          */
+/************************************************************************/
 
-#endif
+// Number of shards, from the GDAL_RB_CACHE_SHARDS configuration option,
+// rounded up to a power of two. Defaults to the number of CPUs.
+static int ComputeShardCount()
+{
+    const char* pszShards = CPLGetConfigOption("GDAL_RB_CACHE_SHARDS",
+                                               nullptr);
+    int nRequested = pszShards ? atoi(pszShards) : CPLGetNumCPUs();
+    if( nRequested <= 0 )
+    {
+        if( pszShards )
+        {
+            CPLError(CE_Warning, CPLE_NotSupported,
+                     "GDAL_RB_CACHE_SHARDS=%s not supported. "
+                     "Using a single shard", pszShards);
+        }
+        nRequested = 1;
+    }
+    int nCount = 1;
+    while( nCount < nRequested && nCount < GDAL_RB_MAX_SHARDS )
+        nCount *= 2;
+
+    const char* pszPolicy =
+        CPLGetConfigOption("GDAL_RB_CACHE_POLICY", "LRU");
+    if( EQUAL(pszPolicy, "CLOCK") )
+        bClockPolicy = true;
+    else if( !EQUAL(pszPolicy, "LRU") )
+    {
+        CPLError(
+            CE_Warning, CPLE_NotSupported,
+            "GDAL_RB_CACHE_POLICY=%s not supported. Falling back to LRU",
+            pszPolicy);
+    }
+    return nCount;
+}
+
+/************************************************************************/
+/*                           GetShardCount()                            */
+/************************************************************************/
+
+static int GetShardCount()
+{
+    // Computed once, even if called concurrently.
+    static const int nShardCount = ComputeShardCount();
+    return nShardCount;
+}
+
+/************************************************************************/
+/*                          InitializeLocks()                           */
+/************************************************************************/
+
+static void InitializeLocks()
+{
+    const int nCount = GetShardCount();
+    for( int i = 0; i < nCount; ++i )
+    {
+        CPLLockHolderD( &asShards[i].hLock, GetLockType() );
+        CPLLockSetDebugPerf(asShards[i].hLock, bDebugContention);
+    }
+    nShardMask = static_cast<unsigned int>(nCount - 1);
+    nShards = nCount;
+}
+
+#define TAKE_LOCK(psShard)      CPLLockHolderOptionalLockD( (psShard)->hLock )
+
+/************************************************************************/
+/*                              GetShard()                              */
+/************************************************************************/
+
+static GDALRBCacheShard* GetShard( GDALRasterBlock* poBlock )
+{
+    GUInt32 nHash = static_cast<GUInt32>(
+        reinterpret_cast<GUIntptr_t>(poBlock->GetBand()) >> 4);
+    nHash ^= static_cast<GUInt32>(poBlock->GetXOff()) * 0x9E3779B1U;
+    nHash ^= static_cast<GUInt32>(poBlock->GetYOff()) * 0x85EBCA6BU;
+    nHash ^= nHash >> 16;
+    nHash *= 0x7FEB352DU;
+    nHash ^= nHash >> 15;
+    return &asShards[nHash & nShardMask];
+}
+
+/************************************************************************/
+/*                            GetCacheUsed()                            */
+/************************************************************************/
+
+static GIntBig GetCacheUsed()
+{
+    GIntBig nUsed = 0;
+    for( int i = 0; i < nShards; ++i )
+        nUsed += asShards[i].nCacheUsed.load(std::memory_order_relaxed);
+    return nUsed;
+}
 
 //#define ENABLE_DEBUG
 
@@ -154,9 +260,7 @@ void CPL_STDCALL GDALSetCacheMax64( GIntBig nNewSizeInBytes )
     }
 #endif
 
-    {
-        INITIALIZE_LOCK;
-    }
+    InitializeLocks();
     bCacheMaxInitialized = true;
     nCacheMax = nNewSizeInBytes;
 
@@ -164,13 +268,13 @@ void CPL_STDCALL GDALSetCacheMax64( GIntBig nNewSizeInBytes )
 /*      Flush blocks till we are under the new limit or till we         */
 /*      can't seem to flush anymore.                                    */
 /* -------------------------------------------------------------------- */
-    while( nCacheUsed > nCacheMax )
+    while( GetCacheUsed() > nCacheMax )
     {
-        const GIntBig nOldCacheUsed = nCacheUsed;
+        const GIntBig nOldCacheUsed = GetCacheUsed();
 
         GDALFlushCacheBlock();
 
-        if( nCacheUsed == nOldCacheUsed )
+        if( GetCacheUsed() == nOldCacheUsed )
             break;
     }
 }
@@ -240,9 +344,7 @@ GIntBig CPL_STDCALL GDALGetCacheMax64()
 {
     if( !bCacheMaxInitialized )
     {
-        {
-            INITIALIZE_LOCK;
-        }
+        InitializeLocks();
         bSleepsForBockCacheDebug = CPLTestBool(
             CPLGetConfigOption("GDAL_DEBUG_BLOCK_CACHE", "NO"));
 
@@ -324,6 +426,7 @@ GIntBig CPL_STDCALL GDALGetCacheMax64()
 
 int CPL_STDCALL GDALGetCacheUsed()
 {
+    const GIntBig nCacheUsed = GetCacheUsed();
     if (nCacheUsed > INT_MAX)
     {
         static bool bHasWarned = false;
@@ -352,7 +455,7 @@ int CPL_STDCALL GDALGetCacheUsed()
  * @since GDAL 1.8.0
  */
 
-GIntBig CPL_STDCALL GDALGetCacheUsed64() { return nCacheUsed; }
+GIntBig CPL_STDCALL GDALGetCacheUsed64() { return GetCacheUsed(); }
 
 /************************************************************************/
 /*                        GDALFlushCacheBlock()                         */
@@ -391,6 +494,17 @@ int CPL_STDCALL GDALFlushCacheBlock()
  * a least recently used (LRU) list and an upper cache limit (see
  * GDALSetCacheMax()) under which the cache size is normally kept.
  *
+ * Starting with GDAL 2.3, the cache is split into several shards, each one
+ * with its own lock and LRU list, so that threads accessing unrelated blocks
+ * do not serialize on a single lock. The number of shards defaults to the
+ * number of CPUs and can be set with the GDAL_RB_CACHE_SHARDS configuration
+ * option (rounded up to a power of two, at most 64). Eviction is done
+ * preferably in the shard of the block being added, so the LRU order is
+ * only approximated across shards. Setting GDAL_RB_CACHE_POLICY=CLOCK
+ * replaces the move-to-front of the LRU list on each access by a reference
+ * bit (second chance algorithm), which avoids taking a lock when a cached
+ * block is accessed.
+ *
  * Some blocks in the cache may be modified relative to the state on disk
  * (they are marked "Dirty") and must be flushed to disk before they can
  * be discarded.  Other (Clean) blocks may just be discarded if their memory
@@ -431,11 +545,20 @@ int CPL_STDCALL GDALFlushCacheBlock()
 int GDALRasterBlock::FlushCacheBlock( int bDirtyBlocksOnly )
 
 {
-    GDALRasterBlock *poTarget;
+    GDALRasterBlock *poTarget = nullptr;
+
+    // Start from a different shard at each call, so that repeated calls
+    // do not always drain the same shard first.
+    static volatile int nFlushIter = 0;
+    const int nFirstShard = CPLAtomicInc(&nFlushIter);
 
+    for( int iShard = 0; poTarget == nullptr && iShard < nShards; ++iShard )
     {
-        INITIALIZE_LOCK;
-        poTarget = poOldest;
+        GDALRBCacheShard* psShard =
+            &asShards[static_cast<unsigned int>(nFirstShard + iShard) &
+                      nShardMask];
+        TAKE_LOCK(psShard);
+        poTarget = psShard->poOldest;
 
         while( poTarget != nullptr )
         {
@@ -450,7 +573,7 @@ int GDALRasterBlock::FlushCacheBlock( int bDirtyBlocksOnly )
         }
 
         if( poTarget == nullptr )
-            return FALSE;
+            continue;
         if( bSleepsForBockCacheDebug )
             CPLSleep(CPLAtof(
                 CPLGetConfigOption(
@@ -460,6 +583,9 @@ int GDALRasterBlock::FlushCacheBlock( int bDirtyBlocksOnly )
         poTarget->GetBand()->UnreferenceBlock(poTarget);
     }
 
+    if( poTarget == nullptr )
+        return FALSE;
+
     if( bSleepsForBockCacheDebug )
         CPLSleep(CPLAtof(
             CPLGetConfigOption("GDAL_RB_FLUSHBLOCK_SLEEP_AFTER_RB_LOCK", "0")));
@@ -583,7 +709,8 @@ GDALRasterBlock::GDALRasterBlock( GDALRasterBand *poBandIn,
     poBand(poBandIn),
     poNext(nullptr),
     poPrevious(nullptr),
-    bMustDetach(true)
+    bMustDetach(true),
+    bReferenced(false)
 {
     CPLAssert( poBandIn != nullptr );
     poBand->GetBlockSize( &nXSize, &nYSize );
@@ -619,7 +746,8 @@ GDALRasterBlock::GDALRasterBlock( int nXOffIn, int nYOffIn ) :
     poBand(nullptr),
     poNext(nullptr),
     poPrevious(nullptr),
-    bMustDetach(false)
+    bMustDetach(false),
+    bReferenced(false)
 {}
 
 /************************************************************************/
@@ -645,6 +773,7 @@ void GDALRasterBlock::RecycleFor( int nXOffIn, int nYOffIn )
     nXOff = nXOffIn;
     nYOff = nYOffIn;
     bMustDetach = true;
+    bReferenced.store(false, std::memory_order_relaxed);
 }
 
 /************************************************************************/
@@ -707,19 +836,21 @@ void GDALRasterBlock::Detach()
 {
     if( bMustDetach )
     {
-        TAKE_LOCK;
+        TAKE_LOCK(GetShard(this));
         Detach_unlocked();
     }
 }
 
 void GDALRasterBlock::Detach_unlocked()
 {
-    if( poOldest == this )
-        poOldest = poPrevious;
+    GDALRBCacheShard* psShard = GetShard(this);
 
-    if( poNewest == this )
+    if( psShard->poOldest == this )
+        psShard->poOldest = poPrevious;
+
+    if( psShard->poNewest == this )
     {
-        poNewest = poNext;
+        psShard->poNewest = poNext;
     }
 
     if( poPrevious != nullptr )
@@ -733,7 +864,8 @@ void GDALRasterBlock::Detach_unlocked()
     bMustDetach = false;
 
     if( pData )
-        nCacheUsed -= GetEffectiveBlockSize(GetBlockSize());
+        psShard->nCacheUsed.fetch_sub(
+            GetEffectiveBlockSize(GetBlockSize()), std::memory_order_relaxed);
 
 #ifdef ENABLE_DEBUG
     Verify();
@@ -753,27 +885,34 @@ void GDALRasterBlock::Detach_unlocked()
 void GDALRasterBlock::Verify()
 
 {
-    TAKE_LOCK;
-
-    CPLAssert( (poNewest == nullptr && poOldest == nullptr)
-               || (poNewest != nullptr && poOldest != nullptr) );
-
-    if( poNewest != nullptr )
+    for( int iShard = 0; iShard < nShards; ++iShard )
     {
-        CPLAssert( poNewest->poPrevious == nullptr );
-        CPLAssert( poOldest->poNext == nullptr );
+        GDALRBCacheShard* psShard = &asShards[iShard];
+        TAKE_LOCK(psShard);
+        GDALRasterBlock* poNewest = psShard->poNewest;
+        GDALRasterBlock* poOldest = psShard->poOldest;
 
-        GDALRasterBlock* poLast = nullptr;
-        for( GDALRasterBlock *poBlock = poNewest;
-             poBlock != nullptr;
-             poBlock = poBlock->poNext )
+        CPLAssert( (poNewest == nullptr && poOldest == nullptr)
+                   || (poNewest != nullptr && poOldest != nullptr) );
+
+        if( poNewest != nullptr )
         {
-            CPLAssert( poBlock->poPrevious == poLast );
+            CPLAssert( poNewest->poPrevious == nullptr );
+            CPLAssert( poOldest->poNext == nullptr );
 
-            poLast = poBlock;
-        }
+            GDALRasterBlock* poLast = nullptr;
+            for( GDALRasterBlock *poBlock = poNewest;
+                 poBlock != nullptr;
+                 poBlock = poBlock->poNext )
+            {
+                CPLAssert( poBlock->poPrevious == poLast );
+                CPLAssert( GetShard(poBlock) == psShard );
+
+                poLast = poBlock;
+            }
 
-        CPLAssert( poOldest == poLast );
+            CPLAssert( poOldest == poLast );
+        }
     }
 }
 
@@ -784,8 +923,10 @@ void GDALRasterBlock::Verify() {}
 #ifdef notdef
 void GDALRasterBlock::CheckNonOrphanedBlocks( GDALRasterBand* poBand )
 {
-    TAKE_LOCK;
-    for( GDALRasterBlock *poBlock = poNewest;
+  for( int iShard = 0; iShard < nShards; ++iShard )
+  {
+    TAKE_LOCK(&asShards[iShard]);
+    for( GDALRasterBlock *poBlock = asShards[iShard].poNewest;
                           poBlock != nullptr;
                           poBlock = poBlock->poNext )
     {
@@ -805,6 +946,7 @@ void GDALRasterBlock::CheckNonOrphanedBlocks( GDALRasterBand* poBand )
                        poBand->GetDataset()->GetDescription());
         }
     }
+  }
 }
 #endif
 
@@ -853,28 +995,45 @@ CPLErr GDALRasterBlock::Write()
  *
  * This method is normally called when a block is used to keep track
  * that it has been recently used.
+ *
+ * When the GDAL_RB_CACHE_POLICY configuration option is set to CLOCK, the
+ * block is only flagged as referenced, and will be moved to the top of the
+ * list when the eviction scan reaches it.
  */
 
 void GDALRasterBlock::Touch()
 
 {
+    if( bClockPolicy )
+    {
+        // Written by readers without the shard lock.
+        bReferenced.store(true, std::memory_order_relaxed);
+        return;
+    }
+
+    GDALRBCacheShard* psShard = GetShard(this);
+
     // Can be safely tested outside the lock
-    if( poNewest == this )
+    if( psShard->poNewest == this )
         return;
 
-    TAKE_LOCK;
+    TAKE_LOCK(psShard);
     Touch_unlocked();
 }
 
 void GDALRasterBlock::Touch_unlocked()
 
 {
+    GDALRBCacheShard* psShard = GetShard(this);
+
     // Could happen even if tested in Touch() before taking the lock
     // Scenario would be :
     // 0. this is the second block (the one pointed by poNewest->poNext)
     // 1. Thread 1 calls Touch() and poNewest != this at that point
     // 2. Thread 2 detaches poNewest
     // 3. Thread 1 arrives here
+    GDALRasterBlock*& poNewest = psShard->poNewest;
+    GDALRasterBlock*& poOldest = psShard->poOldest;
     if( poNewest == this )
         return;
 
@@ -933,13 +1092,16 @@ CPLErr GDALRasterBlock::Internalize()
 
     void        *pNewData = nullptr;
 
-    // This call will initialize the hRBLock mutex. Other call places can
+    // This call will initialize the shard locks. Other call places can
     // only be called if we have go through there.
     const GIntBig nCurCacheMax = GDALGetCacheMax64();
 
     // No risk of overflow as it is checked in GDALRasterBand::InitBlockInfo().
     const int nSizeInBytes = GetBlockSize();
 
+    GDALRBCacheShard* const psOwnShard = GetShard(this);
+    const int nOwnShard = static_cast<int>(psOwnShard - asShards);
+
 /* -------------------------------------------------------------------- */
 /*      Flush old blocks if we are nearing our memory limit.            */
 /* -------------------------------------------------------------------- */
@@ -950,16 +1112,37 @@ CPLErr GDALRasterBlock::Internalize()
         bLoopAgain = false;
         GDALRasterBlock* apoBlocksToFree[64] = { nullptr };
         int nBlocksToFree = 0;
-        {
-            TAKE_LOCK;
+        bool bAdded = false;
 
-            if( bFirstIter )
-                nCacheUsed += GetEffectiveBlockSize(nSizeInBytes);
-            GDALRasterBlock *poTarget = poOldest;
-            while( nCacheUsed > nCurCacheMax )
+        // Evict preferably from the shard of this block, and only visit
+        // the other shards if it has not enough evictable blocks.
+        for( int iShard = 0; iShard < nShards; ++iShard )
+        {
+            GDALRBCacheShard* psShard =
+                &asShards[static_cast<unsigned int>(nOwnShard + iShard) &
+                          nShardMask];
+            TAKE_LOCK(psShard);
+
+            if( bFirstIter && iShard == 0 )
+                psShard->nCacheUsed.fetch_add(
+                    GetEffectiveBlockSize(nSizeInBytes),
+                    std::memory_order_relaxed);
+            GDALRasterBlock *poTarget = psShard->poOldest;
+            while( GetCacheUsed() > nCurCacheMax )
             {
                 while( poTarget != nullptr )
                 {
+                    if( bClockPolicy &&
+                        poTarget->bReferenced.load(std::memory_order_relaxed) )
+                    {
+                        // Give it a second chance.
+                        GDALRasterBlock* _poPrevious = poTarget->poPrevious;
+                        poTarget->bReferenced.store(false,
+                                                    std::memory_order_relaxed);
+                        poTarget->Touch_unlocked();
+                        poTarget = _poPrevious;
+                        continue;
+                    }
                     if( !poTarget->GetDirty() ||
                         nDisableDirtyBlockFlushCounter == 0 )
                     {
@@ -989,12 +1172,12 @@ CPLErr GDALRasterBlock::Internalize()
                         // Only free one dirty block at a time so that
                         // other dirty blocks of other bands with the same
                         // coordinates can be found with TryGetLockedBlock()
-                        bLoopAgain = nCacheUsed > nCurCacheMax;
+                        bLoopAgain = GetCacheUsed() > nCurCacheMax;
                         break;
                     }
                     if( nBlocksToFree == 64 )
                     {
-                        bLoopAgain = ( nCacheUsed > nCurCacheMax );
+                        bLoopAgain = ( GetCacheUsed() > nCurCacheMax );
                         break;
                     }
 
@@ -1006,11 +1189,26 @@ CPLErr GDALRasterBlock::Internalize()
                 }
             }
 
+            if( bLoopAgain )
+                break;
+
         /* ------------------------------------------------------------------ */
-        /*      Add this block to the list.                                   */
+        /*      Add this block to the list, in the common case where its own  */
+        /*      shard was enough to go back under the limit.                  */
         /* ------------------------------------------------------------------ */
-            if( !bLoopAgain )
+            if( iShard == 0 && GetCacheUsed() <= nCurCacheMax )
+            {
                 Touch_unlocked();
+                bAdded = true;
+            }
+            if( GetCacheUsed() <= nCurCacheMax )
+                break;
+        }
+
+        if( !bLoopAgain && !bAdded )
+        {
+            TAKE_LOCK(psOwnShard);
+            Touch_unlocked();
         }
 
         bFirstIter = false;
@@ -1100,9 +1298,12 @@ void GDALRasterBlock::MarkClean() { bDirty = false; }
 /*! @cond Doxygen_Suppress */
 void GDALRasterBlock::DestroyRBMutex()
 {
-    if( hRBLock != nullptr )
-        DESTROY_LOCK;
-    hRBLock = nullptr;
+    for( int i = 0; i < GDAL_RB_MAX_SHARDS; ++i )
+    {
+        if( asShards[i].hLock != nullptr )
+            CPLDestroyLock( asShards[i].hLock );
+        asShards[i].hLock = nullptr;
+    }
 }
 /*! @endcond */
 
@@ -1176,7 +1377,7 @@ int GDALRasterBlock::DropLockForRemovalFromStorage()
 #endif
 
     // Wait for the block for having been unreferenced.
-    TAKE_LOCK;
+    TAKE_LOCK(GetShard(this));
 
     return FALSE;
 }
@@ -1185,14 +1386,17 @@ int GDALRasterBlock::DropLockForRemovalFromStorage()
 void GDALRasterBlock::DumpAll()
 {
     int iBlock = 0;
-    for( GDALRasterBlock *poBlock = poNewest;
-         poBlock != nullptr;
-         poBlock = poBlock->poNext )
+    for( int iShard = 0; iShard < nShards; ++iShard )
     {
-        printf("Block %d\n", iBlock);/*ok*/
-        poBlock->DumpBlock();
-        printf("\n");/*ok*/
-        iBlock++;
+        for( GDALRasterBlock *poBlock = asShards[iShard].poNewest;
+             poBlock != nullptr;
+             poBlock = poBlock->poNext )
+        {
+            printf("Block %d (shard %d)\n", iBlock, iShard);/*ok*/
+            poBlock->DumpBlock();
+            printf("\n");/*ok*/
+            iBlock++;
+        }
     }
 }
 
@@ -0,0 +1,873 @@
+/******************************************************************************
+ *
+ * Project:  GDAL Core
+ * Purpose:  Read-only dataset that can be used concurrently from several
+ *           threads (GDAL_OF_THREAD_SAFE open mode).
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cpl_port.h"
+#include "gdal_proxy.h"
+
+#include <map>
+#include <set>
+
+#include "cpl_conv.h"
+#include "cpl_error.h"
+#include "cpl_multiproc.h"
+#include "cpl_string.h"
+#include "gdal.h"
+#include "gdal_priv.h"
+
+CPL_CVSID("$Id$")
+
+//! @cond Doxygen_Suppress
+
+/* The thread-safe dataset is a proxy that lazily opens one regular dataset
+ * per calling thread (keyed by CPLGetPID()), and forwards each request to
+ * the handle of the current thread. Handles are never shared between threads,
+ * so no driver needs to be made reentrant. The handle opened by the thread
+ * that created the proxy serves as a prototype to initialize the proxy bands.
+ * The handle of a thread is closed when the thread exits (through a
+ * thread-local list of the proxies it used), so that neither transient threads
+ * accumulate handles nor a reused thread id finds a stale one. The remaining
+ * handles are closed when the proxy is closed.
+ *
+ * Statistics and default histograms are computed and read on an additional
+ * handle, used by one thread at a time, so that a single PAM object saves
+ * them in the .aux.xml file instead of each per-thread handle overwriting
+ * the file of the others when it is closed.
+ */
+
+class GDALThreadSafeDataset;
+class GDALThreadSafeRasterBand;
+
+// Proxies of which a thread has a handle.
+typedef std::set<GDALThreadSafeDataset*> GDALThreadSafeDatasetSet;
+
+/************************************************************************/
+/* ==================================================================== */
+/*                        GDALThreadSafeDataset                         */
+/* ==================================================================== */
+/************************************************************************/
+
+class GDALThreadSafeDataset final: public GDALProxyDataset
+{
+    friend class GDALThreadSafeRasterBand;
+
+    CPLString                       m_osFilename;
+    unsigned int                    m_nUnderlyingOpenFlags;
+    CPLStringList                   m_aosAllowedDrivers;
+    CPLStringList                   m_aosSiblingFiles;
+    bool                            m_bHasSiblingFiles;
+
+    CPLMutex                       *m_hMutex;
+    std::map<GIntBig, GDALDataset*> m_oMapThreadToDataset;
+
+    // Handle for statistics, used while holding m_hStatisticsMutex.
+    CPLMutex                       *m_hStatisticsMutex;
+    GDALDataset                    *m_poStatisticsDS;
+
+    // Thread-local sets of the threads that have a handle, protected by
+    // hThreadSafeDatasetsMutex.
+    std::set<GDALThreadSafeDatasetSet*> m_oThreadSets;
+
+    CPL_DISALLOW_COPY_ASSIGN(GDALThreadSafeDataset)
+
+    GDALDataset *OpenHandle();
+    void RegisterCurrentThread();
+
+  protected:
+    GDALDataset *RefUnderlyingDataset() override;
+
+    CPLErr IBuildOverviews( const char *, int, int *,
+                            int, int *, GDALProgressFunc, void * ) override;
+
+  public:
+    GDALThreadSafeDataset( const char *pszFilename,
+                           unsigned int nUnderlyingOpenFlags,
+                           const char *const *papszAllowedDrivers,
+                           const char *const *papszOpenOptionsIn,
+                           const char *const *papszSiblingFiles );
+    ~GDALThreadSafeDataset() override;
+
+    bool Init();
+    void ReleaseThreadHandle( GIntBig nThreadId,
+                              GDALThreadSafeDatasetSet* poSet );
+    GDALDataset *GetStatisticsDataset();
+
+    void FlushCache() override;
+
+    CPLErr SetMetadata( char ** papszMetadata,
+                        const char * pszDomain ) override;
+    CPLErr SetMetadataItem( const char * pszName,
+                            const char * pszValue,
+                            const char * pszDomain ) override;
+    CPLErr SetProjection( const char * ) override;
+    CPLErr SetGeoTransform( double * ) override;
+    CPLErr SetGCPs( int nGCPCount, const GDAL_GCP *pasGCPList,
+                    const char *pszGCPProjection ) override;
+    CPLErr CreateMaskBand( int nFlags ) override;
+};
+
+/************************************************************************/
+/* ==================================================================== */
+/*                       GDALThreadSafeRasterBand                       */
+/* ==================================================================== */
+/************************************************************************/
+
+class GDALThreadSafeRasterBand final: public GDALProxyRasterBand
+{
+    GDALThreadSafeDataset      *m_poTSDS;
+    // Band of which this one is an overview or the mask. nullptr for a
+    // band of the dataset.
+    GDALThreadSafeRasterBand   *m_poParent;
+    int                         m_iOverview;
+    bool                        m_bIsMask;
+
+    std::map<int, GDALThreadSafeRasterBand*> m_oMapOverviews;
+    GDALThreadSafeRasterBand   *m_poMaskBand;
+
+    CPL_DISALLOW_COPY_ASSIGN(GDALThreadSafeRasterBand)
+
+    GDALRasterBand *GetBandOf( GDALDataset *poUnderlyingDS );
+    GDALRasterBand *GetStatisticsBand();
+
+  protected:
+    GDALRasterBand *RefUnderlyingRasterBand() override;
+
+  public:
+    GDALThreadSafeRasterBand( GDALThreadSafeDataset *poTSDS,
+                              GDALThreadSafeRasterBand *poParent,
+                              int nBandIn, int iOverview, bool bIsMask,
+                              GDALRasterBand *poUnderlyingBand );
+    ~GDALThreadSafeRasterBand() override;
+
+    CPLErr FlushCache() override;
+
+    GDALRasterBand *GetOverview( int ) override;
+    GDALRasterBand *GetRasterSampleOverview( GUIntBig ) override;
+    GDALRasterBand *GetMaskBand() override;
+
+    CPLErr GetStatistics( int bApproxOK, int bForce,
+                          double *pdfMin, double *pdfMax,
+                          double *pdfMean, double *pdfStdDev ) override;
+    CPLErr ComputeStatistics( int bApproxOK,
+                              double *pdfMin, double *pdfMax,
+                              double *pdfMean, double *pdfStdDev,
+                              GDALProgressFunc, void *pProgressData ) override;
+    CPLErr ComputeStatisticsAndHistogram(
+                    int bApproxOK,
+                    double *pdfMin, double *pdfMax,
+                    double *pdfMean, double *pdfStdDev,
+                    double *pdfHistMin, double *pdfHistMax,
+                    int nBuckets, GUIntBig *panHistogram,
+                    int nPercentiles, const double *padfPercentiles,
+                    double *padfPercentileValues,
+                    GDALProgressFunc, void *pProgressData ) override;
+    CPLErr GetDefaultHistogram( double *pdfMin, double *pdfMax,
+                                int *pnBuckets, GUIntBig ** ppanHistogram,
+                                int bForce,
+                                GDALProgressFunc, void *pProgressData ) override;
+
+    CPLErr SetMetadata( char ** papszMetadata,
+                        const char * pszDomain ) override;
+    CPLErr SetMetadataItem( const char * pszName,
+                            const char * pszValue,
+                            const char * pszDomain ) override;
+    CPLErr Fill( double dfRealValue, double dfImaginaryValue = 0 ) override;
+    CPLErr SetCategoryNames( char ** ) override;
+    CPLErr SetNoDataValue( double ) override;
+    CPLErr DeleteNoDataValue() override;
+    CPLErr SetColorTable( GDALColorTable * ) override;
+    CPLErr SetColorInterpretation( GDALColorInterp ) override;
+    CPLErr SetOffset( double ) override;
+    CPLErr SetScale( double ) override;
+    CPLErr SetUnitType( const char * ) override;
+    CPLErr SetStatistics( double dfMin, double dfMax,
+                          double dfMean, double dfStdDev ) override;
+    CPLErr BuildOverviews( const char *, int, int *,
+                           GDALProgressFunc, void * ) override;
+    CPLErr SetDefaultHistogram( double dfMin, double dfMax,
+                                int nBuckets, GUIntBig *panHistogram ) override;
+    CPLErr SetDefaultRAT( const GDALRasterAttributeTable * ) override;
+    CPLErr CreateMaskBand( int nFlags ) override;
+};
+
+/************************************************************************/
+/*                       GDALThreadSafeReadOnly()                       */
+/************************************************************************/
+
+static CPLErr GDALThreadSafeReadOnly( const char* pszMethod )
+{
+    CPLError(CE_Failure, CPLE_NotSupported,
+             "%s() not supported on a dataset opened with "
+             "GDAL_OF_THREAD_SAFE", pszMethod);
+    return CE_Failure;
+}
+
+/************************************************************************/
+/*                     Per-thread handle cleanup                        */
+/************************************************************************/
+
+// Protects the thread-local sets of proxies, the m_oThreadSets member of the
+// proxies, and the proxies from being destroyed while a thread exiting
+// closes its handles.
+static CPLMutex* hThreadSafeDatasetsMutex = nullptr;
+
+static void GDALThreadSafeDatasetThreadExit( void* pData )
+{
+    GDALThreadSafeDatasetSet* poSet =
+        static_cast<GDALThreadSafeDatasetSet*>(pData);
+    const GIntBig nThreadId = CPLGetPID();
+    {
+        CPLMutexHolderD(&hThreadSafeDatasetsMutex);
+        // Proxies remove themselves from the sets when they are destroyed,
+        // so those left are alive.
+        for( GDALThreadSafeDataset* poTSDS : *poSet )
+            poTSDS->ReleaseThreadHandle(nThreadId, poSet);
+    }
+    delete poSet;
+}
+
+/************************************************************************/
+/*                        RegisterCurrentThread()                       */
+/************************************************************************/
+
+// Records that the current thread has a handle of this proxy.
+void GDALThreadSafeDataset::RegisterCurrentThread()
+{
+    int bMemoryError = FALSE;
+    GDALThreadSafeDatasetSet* poSet =
+        static_cast<GDALThreadSafeDatasetSet*>(
+            CPLGetTLSEx(CTLS_GDAL_THREAD_SAFE_DATASETS, &bMemoryError));
+    if( bMemoryError )
+        return;
+    if( poSet == nullptr )
+    {
+        poSet = new GDALThreadSafeDatasetSet();
+        CPLSetTLSWithFreeFuncEx(CTLS_GDAL_THREAD_SAFE_DATASETS, poSet,
+                                GDALThreadSafeDatasetThreadExit,
+                                &bMemoryError);
+        if( bMemoryError )
+        {
+            delete poSet;
+            return;
+        }
+    }
+    CPLMutexHolderD(&hThreadSafeDatasetsMutex);
+    poSet->insert(this);
+    m_oThreadSets.insert(poSet);
+}
+
+/************************************************************************/
+/*                        GDALThreadSafeDataset()                       */
+/************************************************************************/
+
+GDALThreadSafeDataset::GDALThreadSafeDataset(
+                                const char *pszFilename,
+                                unsigned int nUnderlyingOpenFlags,
+                                const char *const *papszAllowedDrivers,
+                                const char *const *papszOpenOptionsIn,
+                                const char *const *papszSiblingFiles ) :
+    m_osFilename(pszFilename),
+    m_nUnderlyingOpenFlags(nUnderlyingOpenFlags),
+    m_aosAllowedDrivers(CSLDuplicate(
+                        const_cast<char**>(papszAllowedDrivers))),
+    m_aosSiblingFiles(CSLDuplicate(const_cast<char**>(papszSiblingFiles))),
+    m_bHasSiblingFiles(papszSiblingFiles != nullptr),
+    m_hMutex(nullptr),
+    m_hStatisticsMutex(nullptr),
+    m_poStatisticsDS(nullptr)
+{
+    SetDescription(pszFilename);
+    papszOpenOptions = CSLDuplicate(const_cast<char**>(papszOpenOptionsIn));
+}
+
+/************************************************************************/
+/*                       ~GDALThreadSafeDataset()                       */
+/************************************************************************/
+
+GDALThreadSafeDataset::~GDALThreadSafeDataset()
+{
+    {
+        // Threads still alive must not find this proxy when they exit.
+        CPLMutexHolderD(&hThreadSafeDatasetsMutex);
+        for( GDALThreadSafeDatasetSet* poSet : m_oThreadSets )
+            poSet->erase(this);
+        m_oThreadSets.clear();
+    }
+
+    // Bands must be destroyed before the underlying datasets they refer to.
+    for( int i = 0; i < nBands; i++ )
+        delete papoBands[i];
+    CPLFree(papoBands);
+    papoBands = nullptr;
+    nBands = 0;
+
+    for( auto& oIter : m_oMapThreadToDataset )
+        GDALClose(oIter.second);
+    m_oMapThreadToDataset.clear();
+
+    // Closed last, so that its .aux.xml file is the one left.
+    if( m_poStatisticsDS )
+        GDALClose(m_poStatisticsDS);
+
+    if( m_hMutex )
+        CPLDestroyMutex(m_hMutex);
+    if( m_hStatisticsMutex )
+        CPLDestroyMutex(m_hStatisticsMutex);
+}
+
+/************************************************************************/
+/*                                Init()                                */
+/************************************************************************/
+
+bool GDALThreadSafeDataset::Init()
+{
+    GDALDataset* poProtoDS = RefUnderlyingDataset();
+    if( poProtoDS == nullptr )
+        return false;
+    if( poProtoDS->GetRasterCount() == 0 )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "GDAL_OF_THREAD_SAFE is only supported on raster datasets");
+        return false;
+    }
+
+    nRasterXSize = poProtoDS->GetRasterXSize();
+    nRasterYSize = poProtoDS->GetRasterYSize();
+    for( int i = 1; i <= poProtoDS->GetRasterCount(); i++ )
+    {
+        SetBand(i, new GDALThreadSafeRasterBand(
+                        this, nullptr, i, -1, false,
+                        poProtoDS->GetRasterBand(i)));
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                             OpenHandle()                             */
+/************************************************************************/
+
+GDALDataset* GDALThreadSafeDataset::OpenHandle()
+{
+    GDALDataset* poDS = GDALDataset::FromHandle(
+        GDALOpenEx(m_osFilename, m_nUnderlyingOpenFlags,
+                   m_aosAllowedDrivers.List(), papszOpenOptions,
+                   m_bHasSiblingFiles ? m_aosSiblingFiles.List() : nullptr));
+    if( poDS == nullptr )
+        return nullptr;
+    if( nBands != 0 &&
+        (poDS->GetRasterXSize() != nRasterXSize ||
+         poDS->GetRasterYSize() != nRasterYSize ||
+         poDS->GetRasterCount() != nBands) )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "%s has changed since it was opened",
+                 m_osFilename.c_str());
+        GDALClose(poDS);
+        return nullptr;
+    }
+    return poDS;
+}
+
+/************************************************************************/
+/*                        RefUnderlyingDataset()                        */
+/************************************************************************/
+
+GDALDataset* GDALThreadSafeDataset::RefUnderlyingDataset()
+{
+    const GIntBig nThreadId = CPLGetPID();
+    {
+        CPLMutexHolderD(&m_hMutex);
+        auto oIter = m_oMapThreadToDataset.find(nThreadId);
+        if( oIter != m_oMapThreadToDataset.end() )
+            return oIter->second;
+    }
+
+    // Open outside of the lock so that threads can open their handle in
+    // parallel.
+    GDALDataset* poDS = OpenHandle();
+    if( poDS == nullptr )
+        return nullptr;
+    CPLDebug("GDAL", "GDALThreadSafeDataset(%s): opened handle for thread "
+             CPL_FRMT_GIB, m_osFilename.c_str(), nThreadId);
+
+    RegisterCurrentThread();
+
+    CPLMutexHolderD(&m_hMutex);
+    m_oMapThreadToDataset[nThreadId] = poDS;
+    return poDS;
+}
+
+/************************************************************************/
+/*                        GetStatisticsDataset()                        */
+/************************************************************************/
+
+// Must be called, and the returned handle used, while holding
+// m_hStatisticsMutex.
+GDALDataset* GDALThreadSafeDataset::GetStatisticsDataset()
+{
+    if( m_poStatisticsDS == nullptr )
+    {
+        m_poStatisticsDS = OpenHandle();
+        if( m_poStatisticsDS != nullptr )
+        {
+            CPLDebug("GDAL", "GDALThreadSafeDataset(%s): opened handle for "
+                     "statistics", m_osFilename.c_str());
+        }
+    }
+    return m_poStatisticsDS;
+}
+
+/************************************************************************/
+/*                        ReleaseThreadHandle()                         */
+/************************************************************************/
+
+// Called with hThreadSafeDatasetsMutex held when the thread nThreadId, whose
+// thread-local set of proxies is poSet, exits.
+void GDALThreadSafeDataset::ReleaseThreadHandle( GIntBig nThreadId,
+                                                 GDALThreadSafeDatasetSet* poSet )
+{
+    m_oThreadSets.erase(poSet);
+    GDALDataset* poDS = nullptr;
+    {
+        CPLMutexHolderD(&m_hMutex);
+        auto oIter = m_oMapThreadToDataset.find(nThreadId);
+        if( oIter == m_oMapThreadToDataset.end() )
+            return;
+        poDS = oIter->second;
+        m_oMapThreadToDataset.erase(oIter);
+    }
+    CPLDebug("GDAL", "GDALThreadSafeDataset(%s): closing handle of thread "
+             CPL_FRMT_GIB, m_osFilename.c_str(), nThreadId);
+    GDALClose(poDS);
+}
+
+/************************************************************************/
+/*                             FlushCache()                             */
+/************************************************************************/
+
+void GDALThreadSafeDataset::FlushCache()
+{
+    // Only flush the handle of the current thread, if it exists: the
+    // others may be in use.
+    GDALDataset* poDS = nullptr;
+    {
+        CPLMutexHolderD(&m_hMutex);
+        auto oIter = m_oMapThreadToDataset.find(CPLGetPID());
+        if( oIter != m_oMapThreadToDataset.end() )
+            poDS = oIter->second;
+    }
+    if( poDS )
+        poDS->FlushCache();
+}
+
+/************************************************************************/
+/*                          Read-only methods                           */
+/************************************************************************/
+
+CPLErr GDALThreadSafeDataset::IBuildOverviews( const char *, int, int *,
+                                               int, int *, GDALProgressFunc,
+                                               void * )
+{
+    return GDALThreadSafeReadOnly("BuildOverviews");
+}
+
+CPLErr GDALThreadSafeDataset::SetMetadata( char **, const char * )
+{
+    return GDALThreadSafeReadOnly("SetMetadata");
+}
+
+CPLErr GDALThreadSafeDataset::SetMetadataItem( const char *, const char *,
+                                               const char * )
+{
+    return GDALThreadSafeReadOnly("SetMetadataItem");
+}
+
+CPLErr GDALThreadSafeDataset::SetProjection( const char * )
+{
+    return GDALThreadSafeReadOnly("SetProjection");
+}
+
+CPLErr GDALThreadSafeDataset::SetGeoTransform( double * )
+{
+    return GDALThreadSafeReadOnly("SetGeoTransform");
+}
+
+CPLErr GDALThreadSafeDataset::SetGCPs( int, const GDAL_GCP *, const char * )
+{
+    return GDALThreadSafeReadOnly("SetGCPs");
+}
+
+CPLErr GDALThreadSafeDataset::CreateMaskBand( int )
+{
+    return GDALThreadSafeReadOnly("CreateMaskBand");
+}
+
+/************************************************************************/
+/*                      GDALThreadSafeRasterBand()                      */
+/************************************************************************/
+
+GDALThreadSafeRasterBand::GDALThreadSafeRasterBand(
+                                GDALThreadSafeDataset *poTSDS,
+                                GDALThreadSafeRasterBand *poParent,
+                                int nBandIn, int iOverview, bool bIsMask,
+                                GDALRasterBand *poUnderlyingBand ) :
+    m_poTSDS(poTSDS),
+    m_poParent(poParent),
+    m_iOverview(iOverview),
+    m_bIsMask(bIsMask),
+    m_poMaskBand(nullptr)
+{
+    // Overview and mask bands are not bands of the dataset.
+    if( poParent == nullptr )
+    {
+        poDS = poTSDS;
+        nBand = nBandIn;
+    }
+    nRasterXSize = poUnderlyingBand->GetXSize();
+    nRasterYSize = poUnderlyingBand->GetYSize();
+    eDataType = poUnderlyingBand->GetRasterDataType();
+    poUnderlyingBand->GetBlockSize(&nBlockXSize, &nBlockYSize);
+}
+
+/************************************************************************/
+/*                     ~GDALThreadSafeRasterBand()                      */
+/************************************************************************/
+
+GDALThreadSafeRasterBand::~GDALThreadSafeRasterBand()
+{
+    for( auto& oIter : m_oMapOverviews )
+        delete oIter.second;
+    delete m_poMaskBand;
+}
+
+/************************************************************************/
+/*                      RefUnderlyingRasterBand()                       */
+/************************************************************************/
+
+GDALRasterBand* GDALThreadSafeRasterBand::RefUnderlyingRasterBand()
+{
+    GDALDataset* poUnderlyingDS = m_poTSDS->RefUnderlyingDataset();
+    return poUnderlyingDS ? GetBandOf(poUnderlyingDS) : nullptr;
+}
+
+/************************************************************************/
+/*                              GetBandOf()                             */
+/************************************************************************/
+
+// Returns the band corresponding to this one in an underlying handle.
+GDALRasterBand* GDALThreadSafeRasterBand::GetBandOf(
+                                            GDALDataset* poUnderlyingDS )
+{
+    if( m_poParent == nullptr )
+        return poUnderlyingDS->GetRasterBand(nBand);
+    GDALRasterBand* poUnderlyingParent =
+        m_poParent->GetBandOf(poUnderlyingDS);
+    if( poUnderlyingParent == nullptr )
+        return nullptr;
+    if( m_bIsMask )
+        return poUnderlyingParent->GetMaskBand();
+    return poUnderlyingParent->GetOverview(m_iOverview);
+}
+
+/************************************************************************/
+/*                          GetStatisticsBand()                         */
+/************************************************************************/
+
+// Must be called, and the returned band used, while holding
+// m_poTSDS->m_hStatisticsMutex.
+GDALRasterBand* GDALThreadSafeRasterBand::GetStatisticsBand()
+{
+    GDALDataset* poStatisticsDS = m_poTSDS->GetStatisticsDataset();
+    return poStatisticsDS ? GetBandOf(poStatisticsDS) : nullptr;
+}
+
+/************************************************************************/
+/*                             FlushCache()                             */
+/************************************************************************/
+
+CPLErr GDALThreadSafeRasterBand::FlushCache()
+{
+    // The underlying bands are flushed by GDALThreadSafeDataset::FlushCache()
+    return GDALRasterBand::FlushCache();
+}
+
+/************************************************************************/
+/*                            GetOverview()                             */
+/************************************************************************/
+
+GDALRasterBand* GDALThreadSafeRasterBand::GetOverview( int iOverview )
+{
+    GDALRasterBand* poUnderlyingBand = RefUnderlyingRasterBand();
+    if( poUnderlyingBand == nullptr )
+        return nullptr;
+    GDALRasterBand* poUnderlyingOvr = poUnderlyingBand->GetOverview(iOverview);
+    if( poUnderlyingOvr == nullptr )
+        return nullptr;
+
+    CPLMutexHolderD(&m_poTSDS->m_hMutex);
+    GDALThreadSafeRasterBand*& poOvr = m_oMapOverviews[iOverview];
+    if( poOvr == nullptr )
+    {
+        poOvr = new GDALThreadSafeRasterBand(m_poTSDS, this, 0, iOverview,
+                                             false, poUnderlyingOvr);
+    }
+    return poOvr;
+}
+
+/************************************************************************/
+/*                      GetRasterSampleOverview()                       */
+/************************************************************************/
+
+GDALRasterBand* GDALThreadSafeRasterBand::GetRasterSampleOverview(
+                                                    GUIntBig nDesiredSamples )
+{
+    // Relies on GetOverview() so that a proxy band is returned.
+    return GDALRasterBand::GetRasterSampleOverview(nDesiredSamples);
+}
+
+/************************************************************************/
+/*                            GetMaskBand()                             */
+/************************************************************************/
+
+GDALRasterBand* GDALThreadSafeRasterBand::GetMaskBand()
+{
+    GDALRasterBand* poUnderlyingBand = RefUnderlyingRasterBand();
+    if( poUnderlyingBand == nullptr )
+        return nullptr;
+    GDALRasterBand* poUnderlyingMask = poUnderlyingBand->GetMaskBand();
+    if( poUnderlyingMask == nullptr )
+        return nullptr;
+
+    CPLMutexHolderD(&m_poTSDS->m_hMutex);
+    if( m_poMaskBand == nullptr )
+    {
+        m_poMaskBand = new GDALThreadSafeRasterBand(m_poTSDS, this, 0, -1,
+                                                    true, poUnderlyingMask);
+    }
+    return m_poMaskBand;
+}
+
+/************************************************************************/
+/*                            GetStatistics()                           */
+/************************************************************************/
+
+CPLErr GDALThreadSafeRasterBand::GetStatistics( int bApproxOK, int bForce,
+                                                double *pdfMin,
+                                                double *pdfMax,
+                                                double *pdfMean,
+                                                double *pdfStdDev )
+{
+    CPLMutexHolderD(&m_poTSDS->m_hStatisticsMutex);
+    GDALRasterBand* poBand = GetStatisticsBand();
+    if( poBand == nullptr )
+        return CE_Failure;
+    return poBand->GetStatistics(bApproxOK, bForce,
+                                 pdfMin, pdfMax, pdfMean, pdfStdDev);
+}
+
+/************************************************************************/
+/*                          ComputeStatistics()                         */
+/************************************************************************/
+
+CPLErr GDALThreadSafeRasterBand::ComputeStatistics( int bApproxOK,
+                                                    double *pdfMin,
+                                                    double *pdfMax,
+                                                    double *pdfMean,
+                                                    double *pdfStdDev,
+                                                    GDALProgressFunc pfnProgress,
+                                                    void *pProgressData )
+{
+    CPLMutexHolderD(&m_poTSDS->m_hStatisticsMutex);
+    GDALRasterBand* poBand = GetStatisticsBand();
+    if( poBand == nullptr )
+        return CE_Failure;
+    return poBand->ComputeStatistics(bApproxOK,
+                                     pdfMin, pdfMax, pdfMean, pdfStdDev,
+                                     pfnProgress, pProgressData);
+}
+
+/************************************************************************/
+/*                    ComputeStatisticsAndHistogram()                   */
+/************************************************************************/
+
+CPLErr GDALThreadSafeRasterBand::ComputeStatisticsAndHistogram(
+                    int bApproxOK,
+                    double *pdfMin, double *pdfMax,
+                    double *pdfMean, double *pdfStdDev,
+                    double *pdfHistMin, double *pdfHistMax,
+                    int nBuckets, GUIntBig *panHistogram,
+                    int nPercentiles, const double *padfPercentiles,
+                    double *padfPercentileValues,
+                    GDALProgressFunc pfnProgress, void *pProgressData )
+{
+    CPLMutexHolderD(&m_poTSDS->m_hStatisticsMutex);
+    GDALRasterBand* poBand = GetStatisticsBand();
+    if( poBand == nullptr )
+        return CE_Failure;
+    return poBand->ComputeStatisticsAndHistogram(
+                    bApproxOK, pdfMin, pdfMax, pdfMean, pdfStdDev,
+                    pdfHistMin, pdfHistMax, nBuckets, panHistogram,
+                    nPercentiles, padfPercentiles, padfPercentileValues,
+                    pfnProgress, pProgressData);
+}
+
+/************************************************************************/
+/*                         GetDefaultHistogram()                        */
+/************************************************************************/
+
+CPLErr GDALThreadSafeRasterBand::GetDefaultHistogram(
+                                        double *pdfMin, double *pdfMax,
+                                        int *pnBuckets,
+                                        GUIntBig ** ppanHistogram,
+                                        int bForce,
+                                        GDALProgressFunc pfnProgress,
+                                        void *pProgressData )
+{
+    CPLMutexHolderD(&m_poTSDS->m_hStatisticsMutex);
+    GDALRasterBand* poBand = GetStatisticsBand();
+    if( poBand == nullptr )
+        return CE_Failure;
+    return poBand->GetDefaultHistogram(pdfMin, pdfMax, pnBuckets,
+                                       ppanHistogram, bForce,
+                                       pfnProgress, pProgressData);
+}
+
+/************************************************************************/
+/*                          Read-only methods                           */
+/************************************************************************/
+
+CPLErr GDALThreadSafeRasterBand::SetMetadata( char **, const char * )
+{
+    return GDALThreadSafeReadOnly("SetMetadata");
+}
+
+CPLErr GDALThreadSafeRasterBand::SetMetadataItem( const char *, const char *,
+                                                  const char * )
+{
+    return GDALThreadSafeReadOnly("SetMetadataItem");
+}
+
+CPLErr GDALThreadSafeRasterBand::Fill( double, double )
+{
+    return GDALThreadSafeReadOnly("Fill");
+}
+
+CPLErr GDALThreadSafeRasterBand::SetCategoryNames( char ** )
+{
+    return GDALThreadSafeReadOnly("SetCategoryNames");
+}
+
+CPLErr GDALThreadSafeRasterBand::SetNoDataValue( double )
+{
+    return GDALThreadSafeReadOnly("SetNoDataValue");
+}
+
+CPLErr GDALThreadSafeRasterBand::DeleteNoDataValue()
+{
+    return GDALThreadSafeReadOnly("DeleteNoDataValue");
+}
+
+CPLErr GDALThreadSafeRasterBand::SetColorTable( GDALColorTable * )
+{
+    return GDALThreadSafeReadOnly("SetColorTable");
+}
+
+CPLErr GDALThreadSafeRasterBand::SetColorInterpretation( GDALColorInterp )
+{
+    return GDALThreadSafeReadOnly("SetColorInterpretation");
+}
+
+CPLErr GDALThreadSafeRasterBand::SetOffset( double )
+{
+    return GDALThreadSafeReadOnly("SetOffset");
+}
+
+CPLErr GDALThreadSafeRasterBand::SetScale( double )
+{
+    return GDALThreadSafeReadOnly("SetScale");
+}
+
+CPLErr GDALThreadSafeRasterBand::SetUnitType( const char * )
+{
+    return GDALThreadSafeReadOnly("SetUnitType");
+}
+
+CPLErr GDALThreadSafeRasterBand::SetStatistics( double, double,
+                                                double, double )
+{
+    return GDALThreadSafeReadOnly("SetStatistics");
+}
+
+CPLErr GDALThreadSafeRasterBand::BuildOverviews( const char *, int, int *,
+                                                 GDALProgressFunc, void * )
+{
+    return GDALThreadSafeReadOnly("BuildOverviews");
+}
+
+CPLErr GDALThreadSafeRasterBand::SetDefaultHistogram( double, double,
+                                                      int, GUIntBig * )
+{
+    return GDALThreadSafeReadOnly("SetDefaultHistogram");
+}
+
+CPLErr GDALThreadSafeRasterBand::SetDefaultRAT(
+                                        const GDALRasterAttributeTable * )
+{
+    return GDALThreadSafeReadOnly("SetDefaultRAT");
+}
+
+CPLErr GDALThreadSafeRasterBand::CreateMaskBand( int )
+{
+    return GDALThreadSafeReadOnly("CreateMaskBand");
+}
+
+/************************************************************************/
+/*                    GDALCreateThreadSafeDataset()                     */
+/************************************************************************/
+
+GDALDataset* GDALCreateThreadSafeDataset( const char *pszFilename,
+                                          unsigned int nOpenFlags,
+                                          const char *const *papszAllowedDrivers,
+                                          const char *const *papszOpenOptions,
+                                          const char *const *papszSiblingFiles )
+{
+    const unsigned int nUnderlyingOpenFlags =
+        (nOpenFlags & ~(GDAL_OF_THREAD_SAFE | GDAL_OF_KIND_MASK)) |
+        GDAL_OF_RASTER | GDAL_OF_INTERNAL;
+    GDALThreadSafeDataset* poDS =
+        new GDALThreadSafeDataset(pszFilename, nUnderlyingOpenFlags,
+                                  papszAllowedDrivers, papszOpenOptions,
+                                  papszSiblingFiles);
+    if( !poDS->Init() )
+    {
+        delete poDS;
+        return nullptr;
+    }
+    return poDS;
+}
+
+//! @endcond
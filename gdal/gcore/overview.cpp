@@ -39,11 +39,14 @@
 #include <vector>
 
 #include "cpl_conv.h"
+#include "cpl_cpu_features.h"
 #include "cpl_error.h"
 #include "cpl_progress.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 #include "gdalwarper.h"
+#include "memdataset.h"
 
 // Restrict to 64bit processors because they are guaranteed to have SSE2.
 // Could possibly be used too on 32bit, but we would need to check at runtime.
@@ -51,10 +54,55 @@
 #define USE_SSE2
 
 #include <gdalsse_priv.h>
+
+// When the whole file is not already compiled with AVX, select at runtime
+// the AVX kernels of overview_avx.cpp.
+#if defined(HAVE_AVX_AT_COMPILE_TIME) && !defined(__AVX__)
+#define USE_AVX_DISPATCH
+#endif
+
+// The AVX2/FMA kernels of overview_avx2.cpp have no inline equivalent, so
+// they are selected at runtime even if the whole file is compiled with AVX2.
+#if defined(HAVE_AVX2_AT_COMPILE_TIME)
+#define USE_AVX2_DISPATCH
+#endif
 #endif
 
 CPL_CVSID("$Id$")
 
+#ifdef USE_AVX_DISPATCH
+void GDALResampleConvolutionHorizontalColumn_AVX(
+    const GByte* pChunk, int nChunkXSize, int nRows,
+    const double* padfWeightsAligned, int nSrcPixelCount, bool bLess8,
+    double* padfDst, int nDstStride );
+
+void GDALResampleConvolutionHorizontalColumn_AVX(
+    const GUInt16* pChunk, int nChunkXSize, int nRows,
+    const double* padfWeightsAligned, int nSrcPixelCount, bool bLess8,
+    double* padfDst, int nDstStride );
+
+int GDALResampleConvolutionVertical_16cols_AVX(
+    const double* padfSrc, int nStride,
+    const double* padfWeights, int nSrcLineCount,
+    int nCols, float* pafDst );
+#endif
+
+#ifdef USE_AVX2_DISPATCH
+void GDALResampleConvolutionHorizontalColumn_AVX2(
+    const float* pChunk, int nChunkXSize, int nRows,
+    const double* padfWeightsAligned, int nSrcPixelCount,
+    double* padfDst, int nDstStride );
+
+int GDALResampleAverageFactor2_AVX2( const GByte* pSrc, int nSrcStride,
+                                     int nDstXWidth, GByte* pDst );
+
+int GDALResampleAverageFactor2_AVX2( const GUInt16* pSrc, int nSrcStride,
+                                     int nDstXWidth, GUInt16* pDst );
+
+int GDALResampleAverageFactor2_AVX2( const float* pSrc, int nSrcStride,
+                                     int nDstXWidth, float* pDst );
+#endif
+
 /************************************************************************/
 /*                     GDALResampleChunk32R_Near()                      */
 /************************************************************************/
@@ -249,6 +297,40 @@ static bool ReadColorTableAsArray( const GDALColorTable* poColorTable,
     return true;
 }
 
+#ifdef USE_AVX2_DISPATCH
+
+/************************************************************************/
+/*                   GDALResampleAverageFactor2AVX2<T>()                */
+/************************************************************************/
+
+// Returns the number of target pixels computed.
+template<class T> static inline int
+GDALResampleAverageFactor2AVX2( const T* /* pSrc */, int /* nSrcStride */,
+                                int /* nDstXWidth */, T* /* pDst */ )
+{
+    return 0;
+}
+
+template<> inline int GDALResampleAverageFactor2AVX2<GByte>(
+    const GByte* pSrc, int nSrcStride, int nDstXWidth, GByte* pDst )
+{
+    return GDALResampleAverageFactor2_AVX2(pSrc, nSrcStride, nDstXWidth, pDst);
+}
+
+template<> inline int GDALResampleAverageFactor2AVX2<GUInt16>(
+    const GUInt16* pSrc, int nSrcStride, int nDstXWidth, GUInt16* pDst )
+{
+    return GDALResampleAverageFactor2_AVX2(pSrc, nSrcStride, nDstXWidth, pDst);
+}
+
+template<> inline int GDALResampleAverageFactor2AVX2<float>(
+    const float* pSrc, int nSrcStride, int nDstXWidth, float* pDst )
+{
+    return GDALResampleAverageFactor2_AVX2(pSrc, nSrcStride, nDstXWidth, pDst);
+}
+
+#endif  // USE_AVX2_DISPATCH
+
 /************************************************************************/
 /*                    GDALResampleChunk32R_Average()                    */
 /************************************************************************/
@@ -380,6 +462,12 @@ GDALResampleChunk32R_AverageT( double dfXRatioDstToSrc,
             bSrcXSpacingIsTwo = false;
     }
 
+#ifdef USE_AVX2_DISPATCH
+    const bool bUseAVX2 =
+        CPLHaveRuntimeAVX2() &&
+        CPLTestBool(CPLGetConfigOption("GDAL_USE_AVX", "YES"));
+#endif
+
 /* ==================================================================== */
 /*      Loop over destination scanlines.                                */
 /* ==================================================================== */
@@ -419,6 +507,19 @@ GDALResampleChunk32R_AverageT( double dfXRatioDstToSrc,
 /* -------------------------------------------------------------------- */
         if( poColorTable == nullptr )
         {
+            int iDstPixelStart = 0;
+#ifdef USE_AVX2_DISPATCH
+            if( bUseAVX2 && bSrcXSpacingIsTwo &&
+                nSrcYOff2 == nSrcYOff + 2 && pabyChunkNodataMask == nullptr )
+            {
+                // Same optimized case as below, for Float32 too. The
+                // remaining pixels are computed by the scalar code.
+                iDstPixelStart = GDALResampleAverageFactor2AVX2(
+                    pChunk + panSrcXOffShifted[0] +
+                        (nSrcYOff - nChunkYOff) * nChunkXSize,
+                    nChunkXSize, nDstXWidth, pDstScanline);
+            }
+#endif
             if( bSrcXSpacingIsTwo && nSrcYOff2 == nSrcYOff + 2 &&
                 pabyChunkNodataMask == nullptr &&
                 (eWrkDataType == GDT_Byte || eWrkDataType == GDT_UInt16) )
@@ -426,9 +527,10 @@ GDALResampleChunk32R_AverageT( double dfXRatioDstToSrc,
                 // Optimized case : no nodata, overview by a factor of 2 and
                 // regular x and y src spacing.
                 const T* pSrcScanlineShifted =
-                    pChunk + panSrcXOffShifted[0] +
+                    pChunk + panSrcXOffShifted[0] + 2 * iDstPixelStart +
                     (nSrcYOff - nChunkYOff) * nChunkXSize;
-                for( int iDstPixel = 0; iDstPixel < nDstXWidth; ++iDstPixel )
+                for( int iDstPixel = iDstPixelStart;
+                     iDstPixel < nDstXWidth; ++iDstPixel )
                 {
                     const Tsum nTotal =
                         pSrcScanlineShifted[0]
@@ -445,7 +547,8 @@ GDALResampleChunk32R_AverageT( double dfXRatioDstToSrc,
                 nSrcYOff -= nChunkYOff;
                 nSrcYOff2 -= nChunkYOff;
 
-                for( int iDstPixel = 0; iDstPixel < nDstXWidth; ++iDstPixel )
+                for( int iDstPixel = iDstPixelStart;
+                     iDstPixel < nDstXWidth; ++iDstPixel )
                 {
                     const int nSrcXOff = panSrcXOffShifted[2 * iDstPixel];
                     const int nSrcXOff2 = panSrcXOffShifted[2 * iDstPixel + 1];
@@ -1733,6 +1836,77 @@ GDALResampleConvolutionHorizontalPixelCount4_3rows<GUInt16>(
 
 #endif  // USE_SSE2
 
+#ifdef USE_AVX_DISPATCH
+
+/************************************************************************/
+/*          GDALResampleConvolutionHorizontalColumnAVX<T>()             */
+/************************************************************************/
+
+// Only the types that have a SSE2 specialization have an AVX one, so that
+// the result does not depend on the CPU.
+template<class T> static inline bool
+GDALResampleConvolutionHorizontalColumnAVX(
+    const T* /* pChunk */, int /* nChunkXSize */, int /* nRows */,
+    const double* /* padfWeightsAligned */, int /* nSrcPixelCount */,
+    bool /* bLess8 */, double* /* padfDst */, int /* nDstStride */ )
+{
+    return false;
+}
+
+template<> inline bool GDALResampleConvolutionHorizontalColumnAVX<GByte>(
+    const GByte* pChunk, int nChunkXSize, int nRows,
+    const double* padfWeightsAligned, int nSrcPixelCount, bool bLess8,
+    double* padfDst, int nDstStride )
+{
+    GDALResampleConvolutionHorizontalColumn_AVX(
+        pChunk, nChunkXSize, nRows, padfWeightsAligned, nSrcPixelCount,
+        bLess8, padfDst, nDstStride );
+    return true;
+}
+
+template<> inline bool GDALResampleConvolutionHorizontalColumnAVX<GUInt16>(
+    const GUInt16* pChunk, int nChunkXSize, int nRows,
+    const double* padfWeightsAligned, int nSrcPixelCount, bool bLess8,
+    double* padfDst, int nDstStride )
+{
+    GDALResampleConvolutionHorizontalColumn_AVX(
+        pChunk, nChunkXSize, nRows, padfWeightsAligned, nSrcPixelCount,
+        bLess8, padfDst, nDstStride );
+    return true;
+}
+
+#endif  // USE_AVX_DISPATCH
+
+#ifdef USE_AVX2_DISPATCH
+
+/************************************************************************/
+/*          GDALResampleConvolutionHorizontalColumnAVX2<T>()            */
+/************************************************************************/
+
+// Float32 sources, which have no SSE2 specialization, use the AVX2/FMA
+// kernel.
+template<class T> static inline bool
+GDALResampleConvolutionHorizontalColumnAVX2(
+    const T* /* pChunk */, int /* nChunkXSize */, int /* nRows */,
+    const double* /* padfWeightsAligned */, int /* nSrcPixelCount */,
+    double* /* padfDst */, int /* nDstStride */ )
+{
+    return false;
+}
+
+template<> inline bool GDALResampleConvolutionHorizontalColumnAVX2<float>(
+    const float* pChunk, int nChunkXSize, int nRows,
+    const double* padfWeightsAligned, int nSrcPixelCount,
+    double* padfDst, int nDstStride )
+{
+    GDALResampleConvolutionHorizontalColumn_AVX2(
+        pChunk, nChunkXSize, nRows, padfWeightsAligned, nSrcPixelCount,
+        padfDst, nDstStride );
+    return true;
+}
+
+#endif  // USE_AVX2_DISPATCH
+
 /************************************************************************/
 /*                   GDALResampleChunk32R_Convolution()                 */
 /************************************************************************/
@@ -1812,6 +1986,16 @@ GDALResampleChunk32R_ConvolutionT( double dfXRatioDstToSrc,
     const int nChunkRightXOff = nChunkXOff + nChunkXSize;
 #ifdef USE_SSE2
     bool bSrcPixelCountLess8 = dfXScaledRadius < 4;
+#endif
+#ifdef USE_AVX_DISPATCH
+    const bool bUseAVX =
+        CPLHaveRuntimeAVX() &&
+        CPLTestBool(CPLGetConfigOption("GDAL_USE_AVX", "YES"));
+#endif
+#ifdef USE_AVX2_DISPATCH
+    const bool bUseAVX2 =
+        CPLHaveRuntimeAVX2() &&
+        CPLTestBool(CPLGetConfigOption("GDAL_USE_AVX", "YES"));
 #endif
     for( int iDstPixel = nDstXOff; iDstPixel < nDstXOff2; ++iDstPixel )
     {
@@ -1871,6 +2055,31 @@ GDALResampleChunk32R_ConvolutionT( double dfXRatioDstToSrc,
                     padfWeights[i] *= dfInvWeightSum;
             }
             int iSrcLineOff = 0;
+#ifdef USE_AVX2_DISPATCH
+            if( bUseAVX2 &&
+                GDALResampleConvolutionHorizontalColumnAVX2(
+                    pChunk + (nSrcPixelStart - nChunkXOff), nChunkXSize,
+                    nHeight, padfWeights, nSrcPixelCount,
+                    padfHorizontalFiltered + (iDstPixel - nDstXOff),
+                    nDstXSize) )
+            {
+                iSrcLineOff = nHeight;
+            }
+            else
+#endif
+#ifdef USE_AVX_DISPATCH
+            if( bUseAVX &&
+                GDALResampleConvolutionHorizontalColumnAVX(
+                    pChunk + (nSrcPixelStart - nChunkXOff), nChunkXSize,
+                    nHeight, padfWeights, nSrcPixelCount,
+                    bSrcPixelCountLess8,
+                    padfHorizontalFiltered + (iDstPixel - nDstXOff),
+                    nDstXSize) )
+            {
+                iSrcLineOff = nHeight;
+            }
+            else
+#endif
 #ifdef USE_SSE2
             if( nSrcPixelCount == 4 )
             {
@@ -2052,6 +2261,18 @@ GDALResampleChunk32R_ConvolutionT( double dfXRatioDstToSrc,
             size_t j = (nSrcLineStart - nChunkYOff) * static_cast<size_t>(nDstXSize);
 #ifdef USE_SSE2
 
+#ifdef USE_AVX_DISPATCH
+            if( bUseAVX )
+            {
+                iFilteredPixelOff =
+                    GDALResampleConvolutionVertical_16cols_AVX(
+                        padfHorizontalFilteredBand + j, nDstXSize,
+                        padfWeights, nSrcLineCount, nDstXSize,
+                        pafDstScanline );
+                j += iFilteredPixelOff;
+            }
+#endif
+
 #ifdef __AVX__
             for( ;
                  iFilteredPixelOff+15 < nDstXSize;
@@ -2759,6 +2980,539 @@ GDALDataType GDALGetOvrWorkDataType( const char* pszResampling,
     return GDT_Float32;
 }
 
+/************************************************************************/
+/*                    GDALOvrPromoteBitToGrayscale()                    */
+/************************************************************************/
+
+// Special case to promote 1bit data to 8bit 0/255 values.
+static void GDALOvrPromoteBitToGrayscale( const char* pszResampling,
+                                          GDALDataType eType,
+                                          void* pChunk, int nCount )
+{
+    if( EQUAL(pszResampling, "AVERAGE_BIT2GRAYSCALE") )
+    {
+        if( eType == GDT_Float32 )
+        {
+            float* pafChunk = static_cast<float*>(pChunk);
+            for( int i = nCount - 1; i >= 0; --i )
+            {
+                if( pafChunk[i] == 1.0 )
+                    pafChunk[i] = 255.0;
+            }
+        }
+        else if( eType == GDT_Byte )
+        {
+            GByte* pabyChunk = static_cast<GByte*>(pChunk);
+            for( int i = nCount - 1; i >= 0; --i )
+            {
+                if( pabyChunk[i] == 1 )
+                    pabyChunk[i] = 255;
+            }
+        }
+        else if( eType == GDT_UInt16 )
+        {
+            GUInt16* pasChunk = static_cast<GUInt16*>(pChunk);
+            for( int i = nCount - 1; i >= 0; --i )
+            {
+                if( pasChunk[i] == 1 )
+                    pasChunk[i] = 255;
+            }
+        }
+        else {
+            CPLAssert(false);
+        }
+    }
+    else if( EQUAL(pszResampling, "AVERAGE_BIT2GRAYSCALE_MINISWHITE") )
+    {
+        if( eType == GDT_Float32 )
+        {
+            float* pafChunk = static_cast<float*>(pChunk);
+            for( int i = nCount - 1; i >= 0; --i )
+            {
+                if( pafChunk[i] == 1.0 )
+                    pafChunk[i] = 0.0;
+                else if( pafChunk[i] == 0.0 )
+                    pafChunk[i] = 255.0;
+            }
+        }
+        else if( eType == GDT_Byte )
+        {
+            GByte* pabyChunk = static_cast<GByte*>(pChunk);
+            for( int i = nCount - 1; i >= 0; --i )
+            {
+                if( pabyChunk[i] == 1 )
+                    pabyChunk[i] = 0;
+                else if( pabyChunk[i] == 0 )
+                    pabyChunk[i] = 255;
+            }
+        }
+        else if( eType == GDT_UInt16 )
+        {
+            GUInt16* pasChunk = static_cast<GUInt16*>(pChunk);
+            for( int i = nCount - 1; i >= 0; --i )
+            {
+                if( pasChunk[i] == 1 )
+                    pasChunk[i] = 0;
+                else if( pasChunk[i] == 0 )
+                    pasChunk[i] = 255;
+            }
+        }
+        else {
+            CPLAssert(false);
+        }
+    }
+}
+
+/************************************************************************/
+/*                       GDALCreateOvrJobQueue()                        */
+/************************************************************************/
+
+// Return a queue of jobs of the global thread pool if the GDAL_NUM_THREADS
+// configuration option asks for more than one thread, or nullptr.
+static CPLJobQueue* GDALCreateOvrJobQueue( int& nThreads )
+{
+    nThreads = GDALGetNumThreads();
+    CPLWorkerThreadPool* poThreadPool = GDALGetGlobalThreadPool(nThreads);
+    if( poThreadPool == nullptr )
+        return nullptr;
+
+    CPLDebug("GDAL", "Using %d threads for overview computation", nThreads);
+    return new (std::nothrow) CPLJobQueue(poThreadPool);
+}
+
+/************************************************************************/
+/*                         GDALOvrResampleJob                           */
+/************************************************************************/
+
+namespace {
+
+// Resampling of a source chunk into a window of an overview band, run by
+// a worker thread. The result is written in pDstBuffer, with the data type
+// of the overview band, and then written to the overview band by the
+// thread that owns it.
+struct GDALOvrResampleJob
+{
+    GDALResampleFunction pfnResampleFn;  // nullptr for complex data.
+    double               dfXRatioDstToSrc;
+    double               dfYRatioDstToSrc;
+    GDALDataType         eWrkDataType;
+    void                *pChunk;
+    GByte               *pabyChunkNodataMask;
+    int                  nChunkXOff;
+    int                  nChunkXSize;
+    int                  nChunkYOff;
+    int                  nChunkYSize;
+    int                  nSrcWidth;
+    int                  nSrcHeight;
+    int                  nDstXOff;
+    int                  nDstXOff2;
+    int                  nDstYOff;
+    int                  nDstYOff2;
+    GDALRasterBand      *poDstBand;
+    int                  nDstWidth;
+    int                  nDstHeight;
+    GDALDataType         eDstDataType;
+    CPLString            osNBITS;
+    const char          *pszResampling;
+    int                  bHasNoData;
+    float                fNoDataValue;
+    GDALColorTable      *poColorTable;
+    GDALDataType         eSrcDataType;
+    bool                 bPropagateNoData;
+    void                *pDstBuffer;
+    CPLErr               eErr;
+};
+
+}  // namespace
+
+/************************************************************************/
+/*                       GDALOvrResampleJobFunc()                       */
+/************************************************************************/
+
+static void GDALOvrResampleJobFunc( void* pData )
+{
+    GDALOvrResampleJob* psJob = static_cast<GDALOvrResampleJob *>(pData);
+
+    // Wrap the output buffer in a MEM band that has the dimensions of the
+    // overview band, so that the resampling functions can write at their
+    // usual offsets.
+    const GSpacing nPixelSpace =
+        GDALGetDataTypeSizeBytes(psJob->eDstDataType);
+    const GSpacing nLineSpace =
+        nPixelSpace * (psJob->nDstXOff2 - psJob->nDstXOff);
+    GDALDataset* poMEMDS = MEMDataset::Create( "", psJob->nDstWidth,
+                                               psJob->nDstHeight, 0,
+                                               psJob->eDstDataType, nullptr );
+    if( poMEMDS == nullptr )
+    {
+        psJob->eErr = CE_Failure;
+        return;
+    }
+
+    char szBuffer[32] = { '\0' };
+    int nRet =
+        CPLPrintPointer(
+            szBuffer, static_cast<GByte*>(psJob->pDstBuffer)
+            - nPixelSpace * psJob->nDstXOff
+            - nLineSpace * psJob->nDstYOff, sizeof(szBuffer));
+    szBuffer[nRet] = '\0';
+
+    char szBuffer0[64] = { '\0' };
+    snprintf(szBuffer0, sizeof(szBuffer0), "DATAPOINTER=%s", szBuffer);
+    char szBuffer1[64] = { '\0' };
+    snprintf( szBuffer1, sizeof(szBuffer1),
+              "PIXELOFFSET=" CPL_FRMT_GIB, static_cast<GIntBig>(nPixelSpace) );
+    char szBuffer2[64] = { '\0' };
+    snprintf( szBuffer2, sizeof(szBuffer2),
+              "LINEOFFSET=" CPL_FRMT_GIB, static_cast<GIntBig>(nLineSpace) );
+    char* apszOptions[4] = { szBuffer0, szBuffer1, szBuffer2, nullptr };
+
+    poMEMDS->AddBand(psJob->eDstDataType, apszOptions);
+    GDALRasterBand* poMEMBand = poMEMDS->GetRasterBand(1);
+    if( !psJob->osNBITS.empty() )
+    {
+        poMEMBand->SetMetadataItem( "NBITS", psJob->osNBITS,
+                                    "IMAGE_STRUCTURE" );
+    }
+
+    if( psJob->pfnResampleFn != nullptr )
+    {
+        psJob->eErr = psJob->pfnResampleFn(
+            psJob->dfXRatioDstToSrc, psJob->dfYRatioDstToSrc,
+            0.0, 0.0,
+            psJob->eWrkDataType,
+            psJob->pChunk,
+            psJob->pabyChunkNodataMask,
+            psJob->nChunkXOff, psJob->nChunkXSize,
+            psJob->nChunkYOff, psJob->nChunkYSize,
+            psJob->nDstXOff, psJob->nDstXOff2,
+            psJob->nDstYOff, psJob->nDstYOff2,
+            poMEMBand, psJob->pszResampling,
+            psJob->bHasNoData, psJob->fNoDataValue, psJob->poColorTable,
+            psJob->eSrcDataType,
+            psJob->bPropagateNoData );
+    }
+    else
+    {
+        psJob->eErr = GDALResampleChunkC32R(
+            psJob->nSrcWidth, psJob->nSrcHeight,
+            static_cast<float*>(psJob->pChunk),
+            psJob->nChunkYOff, psJob->nChunkYSize,
+            psJob->nDstYOff, psJob->nDstYOff2,
+            poMEMBand, psJob->pszResampling );
+    }
+
+    GDALClose(poMEMDS);
+}
+
+/************************************************************************/
+/*                     GDALInitOvrResampleJob()                         */
+/************************************************************************/
+
+// Set the fields of the job that relate to the destination band, and
+// allocate its output buffer.
+static bool GDALInitOvrResampleJob( GDALOvrResampleJob& sJob,
+                                    GDALRasterBand* poDstBand,
+                                    int nDstXOff, int nDstXOff2,
+                                    int nDstYOff, int nDstYOff2 )
+{
+    sJob.poDstBand = poDstBand;
+    sJob.nDstXOff = nDstXOff;
+    sJob.nDstXOff2 = nDstXOff2;
+    sJob.nDstYOff = nDstYOff;
+    sJob.nDstYOff2 = nDstYOff2;
+    sJob.nDstWidth = poDstBand->GetXSize();
+    sJob.nDstHeight = poDstBand->GetYSize();
+    sJob.eDstDataType = poDstBand->GetRasterDataType();
+    const char* pszNBITS =
+        poDstBand->GetMetadataItem("NBITS", "IMAGE_STRUCTURE");
+    sJob.osNBITS = pszNBITS ? pszNBITS : "";
+    sJob.eErr = CE_None;
+    sJob.pDstBuffer = VSI_MALLOC3_VERBOSE(
+        std::max(1, nDstXOff2 - nDstXOff),
+        std::max(1, nDstYOff2 - nDstYOff),
+        GDALGetDataTypeSizeBytes(sJob.eDstDataType) );
+    return sJob.pDstBuffer != nullptr;
+}
+
+/************************************************************************/
+/*                     GDALWriteOvrResampleJob()                        */
+/************************************************************************/
+
+// Write the result of a completed job into its overview band, and free
+// its output buffer.
+static CPLErr GDALWriteOvrResampleJob( GDALOvrResampleJob& sJob )
+{
+    CPLErr eErr = sJob.eErr;
+    const int nXSize = sJob.nDstXOff2 - sJob.nDstXOff;
+    const int nYSize = sJob.nDstYOff2 - sJob.nDstYOff;
+    if( eErr == CE_None && nXSize > 0 && nYSize > 0 )
+    {
+        eErr = sJob.poDstBand->RasterIO(
+            GF_Write, sJob.nDstXOff, sJob.nDstYOff, nXSize, nYSize,
+            sJob.pDstBuffer, nXSize, nYSize, sJob.eDstDataType,
+            0, 0, nullptr );
+    }
+    VSIFree(sJob.pDstBuffer);
+    sJob.pDstBuffer = nullptr;
+    return eErr;
+}
+
+/************************************************************************/
+/*                  GDALRegenerateOverviewsTerminate()                  */
+/************************************************************************/
+
+static CPLErr
+GDALRegenerateOverviewsTerminate( GDALRasterBand* poSrcBand,
+                                  int nOverviewCount,
+                                  GDALRasterBand** papoOvrBands,
+                                  const char* pszResampling,
+                                  CPLErr eErr,
+                                  GDALProgressFunc pfnProgress,
+                                  void* pProgressData )
+{
+/* -------------------------------------------------------------------- */
+/*      Renormalized overview mean / stddev if needed.                  */
+/* -------------------------------------------------------------------- */
+    if( eErr == CE_None && EQUAL(pszResampling,"AVERAGE_MP") )
+    {
+        GDALOverviewMagnitudeCorrection(
+            poSrcBand,
+            nOverviewCount,
+            reinterpret_cast<GDALRasterBandH *>( papoOvrBands ),
+            GDALDummyProgress, nullptr );
+    }
+
+/* -------------------------------------------------------------------- */
+/*      It can be important to flush out data to overviews.             */
+/* -------------------------------------------------------------------- */
+    for( int iOverview = 0;
+         eErr == CE_None && iOverview < nOverviewCount;
+         ++iOverview )
+    {
+        eErr = papoOvrBands[iOverview]->FlushCache();
+    }
+
+    if( eErr == CE_None )
+        pfnProgress( 1.0, nullptr, pProgressData );
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                GDALRegenerateOverviewsMultiThreaded()                */
+/************************************************************************/
+
+// Pipelined variant of the chunk loop of GDALRegenerateOverviews(). The
+// source is read, in the calling thread, by batches of chunks. While a batch
+// is resampled by the worker threads, with one job per chunk and overview
+// level, the previous batch is written to the overviews and the next one is
+// read. Each overview window is computed exactly as in the sequential code
+// path, and written in the same order, so the result is identical.
+static CPLErr
+GDALRegenerateOverviewsMultiThreaded( CPLJobQueue* poJobQueue,
+                                      int nThreads,
+                                      GDALRasterBand* poSrcBand,
+                                      int nOverviewCount,
+                                      GDALRasterBand** papoOvrBands,
+                                      const char* pszResampling,
+                                      GDALResampleFunction pfnResampleFn,
+                                      int nKernelRadius, int nMaxOvrFactor,
+                                      int nFullResYChunk,
+                                      GDALDataType eType,
+                                      GDALRasterBand* poMaskBand,
+                                      bool bUseNoDataMask,
+                                      GDALColorTable* poColorTable,
+                                      int bHasNoData, float fNoDataValue,
+                                      bool bPropagateNoData,
+                                      GDALProgressFunc pfnProgress,
+                                      void* pProgressData )
+{
+    const int nWidth = poSrcBand->GetXSize();
+    const int nHeight = poSrcBand->GetYSize();
+    const int nMaxChunkYSizeQueried =
+        nFullResYChunk + 2 * nKernelRadius * nMaxOvrFactor;
+
+    // Number of chunks per batch: one per thread, but do not use more than
+    // a quarter of the block cache size for the source buffers of the two
+    // batches in flight.
+    const GIntBig nChunkSize =
+        static_cast<GIntBig>(nMaxChunkYSizeQueried) * nWidth *
+        (GDALGetDataTypeSizeBytes(eType) + (bUseNoDataMask ? 1 : 0));
+    const int nBatchSize = static_cast<int>(std::max(
+        static_cast<GIntBig>(1),
+        std::min(static_cast<GIntBig>(nThreads),
+                 GDALGetCacheMax64() / 4 / (2 * nChunkSize))));
+
+    struct Chunk
+    {
+        void   *pChunk;
+        GByte  *pabyChunkNodataMask;
+    };
+    std::vector<Chunk> asChunks(2 * nBatchSize);
+    CPLErr eErr = CE_None;
+    for( size_t i = 0; i < asChunks.size(); ++i )
+    {
+        asChunks[i].pChunk = VSI_MALLOC3_VERBOSE(
+            GDALGetDataTypeSizeBytes(eType), nMaxChunkYSizeQueried, nWidth );
+        asChunks[i].pabyChunkNodataMask = bUseNoDataMask ?
+            static_cast<GByte*>(
+                VSI_MALLOC2_VERBOSE(nMaxChunkYSizeQueried, nWidth)) : nullptr;
+        if( asChunks[i].pChunk == nullptr ||
+            (bUseNoDataMask && asChunks[i].pabyChunkNodataMask == nullptr) )
+        {
+            eErr = CE_Failure;
+        }
+    }
+
+    // Jobs of the batch being resampled, and of the batch being prepared.
+    std::vector<GDALOvrResampleJob> aoJobs[2];
+    int iCurBatch = 0;
+    int nChunkYOff = 0;
+
+    while( eErr == CE_None && (nChunkYOff < nHeight ||
+                               !aoJobs[1 - iCurBatch].empty()) )
+    {
+/* -------------------------------------------------------------------- */
+/*      Read the next batch of chunks, and prepare its jobs.            */
+/* -------------------------------------------------------------------- */
+        std::vector<GDALOvrResampleJob>& aoNewJobs = aoJobs[iCurBatch];
+        for( int iChunk = 0;
+             iChunk < nBatchSize && nChunkYOff < nHeight && eErr == CE_None;
+             ++iChunk, nChunkYOff += nFullResYChunk )
+        {
+            if( !pfnProgress( nChunkYOff / static_cast<double>( nHeight ),
+                              nullptr, pProgressData ) )
+            {
+                CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+                eErr = CE_Failure;
+                break;
+            }
+
+            if( nFullResYChunk + nChunkYOff > nHeight )
+                nFullResYChunk = nHeight - nChunkYOff;
+
+            int nChunkYOffQueried =
+                nChunkYOff - nKernelRadius * nMaxOvrFactor;
+            int nChunkYSizeQueried =
+                nFullResYChunk + 2 * nKernelRadius * nMaxOvrFactor;
+            if( nChunkYOffQueried < 0 )
+            {
+                nChunkYSizeQueried += nChunkYOffQueried;
+                nChunkYOffQueried = 0;
+            }
+            if( nChunkYOffQueried + nChunkYSizeQueried > nHeight )
+                nChunkYSizeQueried = nHeight - nChunkYOffQueried;
+
+            const Chunk& sChunk = asChunks[iCurBatch * nBatchSize + iChunk];
+            eErr = poSrcBand->RasterIO(
+                GF_Read, 0, nChunkYOffQueried, nWidth, nChunkYSizeQueried,
+                sChunk.pChunk, nWidth, nChunkYSizeQueried, eType,
+                0, 0, nullptr );
+            if( eErr == CE_None && bUseNoDataMask )
+                eErr = poMaskBand->RasterIO(
+                    GF_Read, 0, nChunkYOffQueried, nWidth, nChunkYSizeQueried,
+                    sChunk.pabyChunkNodataMask, nWidth, nChunkYSizeQueried,
+                    GDT_Byte, 0, 0, nullptr );
+            if( eErr != CE_None )
+                break;
+
+            GDALOvrPromoteBitToGrayscale( pszResampling, eType, sChunk.pChunk,
+                                          nChunkYSizeQueried * nWidth );
+
+            for( int iOverview = 0; iOverview < nOverviewCount; ++iOverview )
+            {
+                const int nDstWidth = papoOvrBands[iOverview]->GetXSize();
+                const int nDstHeight = papoOvrBands[iOverview]->GetYSize();
+
+                const double dfXRatioDstToSrc =
+                    static_cast<double>(nWidth) / nDstWidth;
+                const double dfYRatioDstToSrc =
+                    static_cast<double>(nHeight) / nDstHeight;
+
+                // Same as in GDALRegenerateOverviews().
+                const int nDstYOff =
+                    static_cast<int>(0.5 + nChunkYOff/dfYRatioDstToSrc);
+                int nDstYOff2 = static_cast<int>(
+                    0.5 + (nChunkYOff+nFullResYChunk)/dfYRatioDstToSrc);
+                if( nChunkYOff + nFullResYChunk == nHeight )
+                    nDstYOff2 = nDstHeight;
+
+                GDALOvrResampleJob sJob;
+                sJob.pfnResampleFn =
+                    ( eType == GDT_Byte ||
+                      eType == GDT_UInt16 ||
+                      eType == GDT_Float32 ) ? pfnResampleFn : nullptr;
+                sJob.dfXRatioDstToSrc = dfXRatioDstToSrc;
+                sJob.dfYRatioDstToSrc = dfYRatioDstToSrc;
+                sJob.eWrkDataType = eType;
+                sJob.pChunk = sChunk.pChunk;
+                sJob.pabyChunkNodataMask = sChunk.pabyChunkNodataMask;
+                sJob.nChunkXOff = 0;
+                sJob.nChunkXSize = nWidth;
+                sJob.nChunkYOff = nChunkYOffQueried;
+                sJob.nChunkYSize = nChunkYSizeQueried;
+                sJob.nSrcWidth = nWidth;
+                sJob.nSrcHeight = nHeight;
+                sJob.pszResampling = pszResampling;
+                sJob.bHasNoData = bHasNoData;
+                sJob.fNoDataValue = fNoDataValue;
+                sJob.poColorTable = poColorTable;
+                sJob.eSrcDataType = poSrcBand->GetRasterDataType();
+                sJob.bPropagateNoData = bPropagateNoData;
+                const bool bOK = GDALInitOvrResampleJob(
+                    sJob, papoOvrBands[iOverview],
+                    0, nDstWidth, nDstYOff, nDstYOff2 );
+                aoNewJobs.push_back(sJob);
+                if( !bOK )
+                {
+                    eErr = CE_Failure;
+                    break;
+                }
+            }
+        }
+
+/* -------------------------------------------------------------------- */
+/*      Wait for the previous batch, start the new one, and write the   */
+/*      previous one while the new one is processed.                    */
+/* -------------------------------------------------------------------- */
+        poJobQueue->WaitCompletion();
+
+        if( eErr == CE_None && !aoNewJobs.empty() )
+        {
+            std::vector<void*> apJobs;
+            for( size_t i = 0; i < aoNewJobs.size(); ++i )
+                apJobs.push_back(&aoNewJobs[i]);
+            poJobQueue->SubmitJobs(GDALOvrResampleJobFunc, apJobs);
+        }
+
+        std::vector<GDALOvrResampleJob>& aoPrevJobs = aoJobs[1 - iCurBatch];
+        for( size_t i = 0; i < aoPrevJobs.size(); ++i )
+        {
+            const CPLErr eJobErr = GDALWriteOvrResampleJob(aoPrevJobs[i]);
+            if( eErr == CE_None )
+                eErr = eJobErr;
+        }
+        aoPrevJobs.clear();
+
+        iCurBatch = 1 - iCurBatch;
+    }
+
+    poJobQueue->WaitCompletion();
+    for( int i = 0; i < 2; ++i )
+    {
+        for( size_t j = 0; j < aoJobs[i].size(); ++j )
+            VSIFree(aoJobs[i][j].pDstBuffer);
+    }
+    for( size_t i = 0; i < asChunks.size(); ++i )
+    {
+        VSIFree(asChunks[i].pChunk);
+        VSIFree(asChunks[i].pabyChunkNodataMask);
+    }
+
+    return eErr;
+}
+
 /************************************************************************/
 /*                      GDALRegenerateOverviews()                       */
 /************************************************************************/
@@ -2782,6 +3536,12 @@ GDALDataType GDALGetOvrWorkDataType( const char* pszResampling,
  * considered as the nodata value and not each value of the triplet
  * independently per band.
  *
+ * Starting with GDAL 2.3, the GDAL_NUM_THREADS configuration option can be
+ * set to a number of threads or ALL_CPUS, so that the resampling of several
+ * chunks and overview levels is done in parallel with the reading of the
+ * source and the writing of the overviews. The result is the same as with a
+ * single thread.
+ *
  * @param hSrcBand the source (base level) band.
  * @param nOverviewCount the number of downsampled bands being generated.
  * @param pahOvrBands the list of downsampled bands to be generated.
@@ -2943,6 +3703,33 @@ GDALRegenerateOverviews( GDALRasterBandH hSrcBand,
     const int nMaxChunkYSizeQueried =
         nFullResYChunk + 2 * nKernelRadius * nMaxOvrFactor;
 
+    int bHasNoData = FALSE;
+    const float fNoDataValue =
+        static_cast<float>( poSrcBand->GetNoDataValue(&bHasNoData) );
+    const bool bPropagateNoData =
+        CPLTestBool( CPLGetConfigOption("GDAL_OVR_PROPAGATE_NODATA", "NO") );
+
+/* -------------------------------------------------------------------- */
+/*      Use the pipelined code path if several threads are requested    */
+/*      through GDAL_NUM_THREADS.                                       */
+/* -------------------------------------------------------------------- */
+    int nThreads = 1;
+    CPLJobQueue* poJobQueue = GDALCreateOvrJobQueue(nThreads);
+    if( poJobQueue != nullptr )
+    {
+        CPLErr eErr = GDALRegenerateOverviewsMultiThreaded(
+            poJobQueue, nThreads, poSrcBand, nOverviewCount, papoOvrBands,
+            pszResampling, pfnResampleFn, nKernelRadius, nMaxOvrFactor,
+            nFullResYChunk, eType, poMaskBand, bUseNoDataMask, poColorTable,
+            bHasNoData, fNoDataValue, bPropagateNoData,
+            pfnProgress, pProgressData );
+        delete poJobQueue;
+        return GDALRegenerateOverviewsTerminate( poSrcBand, nOverviewCount,
+                                                 papoOvrBands, pszResampling,
+                                                 eErr,
+                                                 pfnProgress, pProgressData );
+    }
+
     GByte *pabyChunkNodataMask = nullptr;
     void *pChunk =
         VSI_MALLOC3_VERBOSE(
@@ -2960,12 +3747,6 @@ GDALRegenerateOverviews( GDALRasterBandH hSrcBand,
         return CE_Failure;
     }
 
-    int bHasNoData = FALSE;
-    const float fNoDataValue =
-        static_cast<float>( poSrcBand->GetNoDataValue(&bHasNoData) );
-    const bool bPropagateNoData =
-        CPLTestBool( CPLGetConfigOption("GDAL_OVR_PROPAGATE_NODATA", "NO") );
-
 /* -------------------------------------------------------------------- */
 /*      Loop over image operating on chunks.                            */
 /* -------------------------------------------------------------------- */
@@ -3009,79 +3790,8 @@ GDALRegenerateOverviews( GDALRasterBandH hSrcBand,
                 pabyChunkNodataMask, nWidth, nChunkYSizeQueried, GDT_Byte,
                 0, 0, nullptr );
 
-        // Special case to promote 1bit data to 8bit 0/255 values.
-        if( EQUAL(pszResampling, "AVERAGE_BIT2GRAYSCALE") )
-        {
-            if( eType == GDT_Float32 )
-            {
-                float* pafChunk = static_cast<float*>(pChunk);
-                for( int i = nChunkYSizeQueried*nWidth - 1; i >= 0; --i )
-                {
-                    if( pafChunk[i] == 1.0 )
-                        pafChunk[i] = 255.0;
-                }
-            }
-            else if( eType == GDT_Byte )
-            {
-              GByte* pabyChunk = static_cast<GByte*>(pChunk);
-                for( int i = nChunkYSizeQueried*nWidth - 1; i >= 0; --i )
-                {
-                    if( pabyChunk[i] == 1 )
-                        pabyChunk[i] = 255;
-                }
-            }
-            else if( eType == GDT_UInt16 )
-            {
-                GUInt16* pasChunk = static_cast<GUInt16*>(pChunk);
-                for( int i = nChunkYSizeQueried*nWidth - 1; i >= 0; --i )
-                {
-                    if( pasChunk[i] == 1 )
-                        pasChunk[i] = 255;
-                }
-            }
-            else {
-                CPLAssert(false);
-            }
-        }
-        else if( EQUAL(pszResampling, "AVERAGE_BIT2GRAYSCALE_MINISWHITE") )
-        {
-            if( eType == GDT_Float32 )
-            {
-                float* pafChunk = static_cast<float*>(pChunk);
-                for( int i = nChunkYSizeQueried*nWidth - 1; i >= 0; --i )
-                {
-                    if( pafChunk[i] == 1.0 )
-                        pafChunk[i] = 0.0;
-                    else if( pafChunk[i] == 0.0 )
-                        pafChunk[i] = 255.0;
-                }
-            }
-            else if( eType == GDT_Byte )
-            {
-                GByte* pabyChunk = static_cast<GByte*>(pChunk);
-                for( int i = nChunkYSizeQueried*nWidth - 1; i >= 0; --i )
-                {
-                    if( pabyChunk[i] == 1 )
-                        pabyChunk[i] = 0;
-                    else if( pabyChunk[i] == 0 )
-                        pabyChunk[i] = 255;
-                }
-            }
-            else if( eType == GDT_UInt16 )
-            {
-                GUInt16* pasChunk = static_cast<GUInt16*>(pChunk);
-                for( int i = nChunkYSizeQueried*nWidth - 1; i >= 0; --i )
-                {
-                    if( pasChunk[i] == 1 )
-                        pasChunk[i] = 0;
-                    else if( pasChunk[i] == 0 )
-                        pasChunk[i] = 255;
-                }
-            }
-            else {
-                CPLAssert(false);
-            }
-        }
+        GDALOvrPromoteBitToGrayscale( pszResampling, eType, pChunk,
+                                      nChunkYSizeQueried * nWidth );
 
         for( int iOverview = 0;
              iOverview < nOverviewCount && eErr == CE_None;
@@ -3142,32 +3852,10 @@ GDALRegenerateOverviews( GDALRasterBandH hSrcBand,
     VSIFree( pChunk );
     VSIFree( pabyChunkNodataMask );
 
-/* -------------------------------------------------------------------- */
-/*      Renormalized overview mean / stddev if needed.                  */
-/* -------------------------------------------------------------------- */
-    if( eErr == CE_None && EQUAL(pszResampling,"AVERAGE_MP") )
-    {
-        GDALOverviewMagnitudeCorrection(
-            poSrcBand,
-            nOverviewCount,
-            reinterpret_cast<GDALRasterBandH *>( papoOvrBands ),
-            GDALDummyProgress, nullptr );
-    }
-
-/* -------------------------------------------------------------------- */
-/*      It can be important to flush out data to overviews.             */
-/* -------------------------------------------------------------------- */
-    for( int iOverview = 0;
-         eErr == CE_None && iOverview < nOverviewCount;
-         ++iOverview )
-    {
-        eErr = papoOvrBands[iOverview]->FlushCache();
-    }
-
-    if( eErr == CE_None )
-        pfnProgress( 1.0, nullptr, pProgressData );
-
-    return eErr;
+    return GDALRegenerateOverviewsTerminate( poSrcBand, nOverviewCount,
+                                             papoOvrBands, pszResampling,
+                                             eErr,
+                                             pfnProgress, pProgressData );
 }
 
 /************************************************************************/
@@ -3356,6 +4044,10 @@ GDALRegenerateOverviewsMultiBand( int nBands, GDALRasterBand** papoSrcBands,
     const bool bPropagateNoData =
         CPLTestBool( CPLGetConfigOption("GDAL_OVR_PROPAGATE_NODATA", "NO") );
 
+    int nThreads = 1;
+    CPLJobQueue* poJobQueue =
+        nBands > 1 ? GDALCreateOvrJobQueue(nThreads) : nullptr;
+
     // Second pass to do the real job.
     double dfCurPixelCount = 0;
     CPLErr eErr = CE_None;
@@ -3409,6 +4101,7 @@ GDALRegenerateOverviewsMultiBand( int nBands, GDALRasterBand** papoSrcBands,
         {
             CPLFree(pabHasNoData);
             CPLFree(pafNoDataValue);
+            delete poJobQueue;
             return CE_Failure;
         }
         GByte* pabyChunkNoDataMask = nullptr;
@@ -3425,6 +4118,7 @@ GDALRegenerateOverviewsMultiBand( int nBands, GDALRasterBand** papoSrcBands,
                 CPLFree(papaChunk);
                 CPLFree(pabHasNoData);
                 CPLFree(pafNoDataValue);
+                delete poJobQueue;
                 return CE_Failure;
             }
         }
@@ -3442,6 +4136,7 @@ GDALRegenerateOverviewsMultiBand( int nBands, GDALRasterBand** papoSrcBands,
                 CPLFree(papaChunk);
                 CPLFree(pabHasNoData);
                 CPLFree(pafNoDataValue);
+                delete poJobQueue;
                 return CE_Failure;
             }
         }
@@ -3561,26 +4256,80 @@ GDALRegenerateOverviewsMultiBand( int nBands, GDALRasterBand** papoSrcBands,
                         GDT_Byte, 0, 0, nullptr );
                 }
 
-                // Compute the resulting overview block.
-                for( int iBand = 0; iBand < nBands && eErr == CE_None; ++iBand )
+                // Compute the resulting overview block, one band per
+                // worker thread if asked.
+                if( poJobQueue != nullptr && eErr == CE_None )
                 {
-                    eErr = pfnResampleFn(
-                        dfXRatioDstToSrc, dfYRatioDstToSrc,
-                        0.0, 0.0,
-                        eWrkDataType,
-                        papaChunk[iBand],
-                        pabyChunkNoDataMask,
-                        nChunkXOffQueried, nChunkXSizeQueried,
-                        nChunkYOffQueried, nChunkYSizeQueried,
-                        nDstXOff, nDstXOff + nDstXCount,
-                        nDstYOff, nDstYOff + nDstYCount,
-                        papapoOverviewBands[iBand][iOverview],
-                        pszResampling,
-                        pabHasNoData[iBand],
-                        pafNoDataValue[iBand],
-                        /*poColorTable*/ nullptr,
-                        eDataType,
-                        bPropagateNoData);
+                    std::vector<GDALOvrResampleJob> aoJobs(nBands);
+                    std::vector<void*> apJobs;
+                    for( int iBand = 0; iBand < nBands; ++iBand )
+                    {
+                        GDALOvrResampleJob& sJob = aoJobs[iBand];
+                        sJob.pfnResampleFn = pfnResampleFn;
+                        sJob.dfXRatioDstToSrc = dfXRatioDstToSrc;
+                        sJob.dfYRatioDstToSrc = dfYRatioDstToSrc;
+                        sJob.eWrkDataType = eWrkDataType;
+                        sJob.pChunk = papaChunk[iBand];
+                        sJob.pabyChunkNodataMask = pabyChunkNoDataMask;
+                        sJob.nChunkXOff = nChunkXOffQueried;
+                        sJob.nChunkXSize = nChunkXSizeQueried;
+                        sJob.nChunkYOff = nChunkYOffQueried;
+                        sJob.nChunkYSize = nChunkYSizeQueried;
+                        sJob.nSrcWidth = nSrcWidth;
+                        sJob.nSrcHeight = nSrcHeight;
+                        sJob.pszResampling = pszResampling;
+                        sJob.bHasNoData = pabHasNoData[iBand];
+                        sJob.fNoDataValue = pafNoDataValue[iBand];
+                        sJob.poColorTable = nullptr;
+                        sJob.eSrcDataType = eDataType;
+                        sJob.bPropagateNoData = bPropagateNoData;
+                        if( !GDALInitOvrResampleJob(
+                                sJob, papapoOverviewBands[iBand][iOverview],
+                                nDstXOff, nDstXOff + nDstXCount,
+                                nDstYOff, nDstYOff + nDstYCount) )
+                        {
+                            eErr = CE_Failure;
+                            break;
+                        }
+                        apJobs.push_back(&sJob);
+                    }
+                    if( eErr == CE_None )
+                    {
+                        poJobQueue->SubmitJobs(GDALOvrResampleJobFunc,
+                                               apJobs);
+                        poJobQueue->WaitCompletion();
+                    }
+                    for( int iBand = 0; iBand < nBands; ++iBand )
+                    {
+                        if( eErr == CE_None )
+                            eErr = GDALWriteOvrResampleJob(aoJobs[iBand]);
+                        else
+                            VSIFree(aoJobs[iBand].pDstBuffer);
+                    }
+                }
+                else
+                {
+                    for( int iBand = 0;
+                         iBand < nBands && eErr == CE_None; ++iBand )
+                    {
+                        eErr = pfnResampleFn(
+                            dfXRatioDstToSrc, dfYRatioDstToSrc,
+                            0.0, 0.0,
+                            eWrkDataType,
+                            papaChunk[iBand],
+                            pabyChunkNoDataMask,
+                            nChunkXOffQueried, nChunkXSizeQueried,
+                            nChunkYOffQueried, nChunkYSizeQueried,
+                            nDstXOff, nDstXOff + nDstXCount,
+                            nDstYOff, nDstYOff + nDstYCount,
+                            papapoOverviewBands[iBand][iOverview],
+                            pszResampling,
+                            pabHasNoData[iBand],
+                            pafNoDataValue[iBand],
+                            /*poColorTable*/ nullptr,
+                            eDataType,
+                            bPropagateNoData);
+                    }
                 }
             }
 
@@ -3597,6 +4346,7 @@ GDALRegenerateOverviewsMultiBand( int nBands, GDALRasterBand** papoSrcBands,
         CPLFree(pabyChunkNoDataMask);
     }
 
+    delete poJobQueue;
     CPLFree(pabHasNoData);
     CPLFree(pafNoDataValue);
 
@@ -0,0 +1,358 @@
+/******************************************************************************
+ *
+ * Project:  GDAL Core
+ * Purpose:  AVX specializations of the overview convolution kernels
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cpl_port.h"
+
+CPL_CVSID("$Id$")
+
+#if defined(HAVE_AVX_AT_COMPILE_TIME) && ( defined(__x86_64) || defined(_M_X64) )
+
+#include <immintrin.h>
+#include <cstring>
+
+// This file is compiled with AVX enabled, and its functions are only called
+// after a runtime check of AVX availability. It must not include
+// gdalsse_priv.h, whose inline classes are also instantiated without AVX in
+// overview.cpp.
+//
+// The order of the floating point operations is the same as in the SSE2
+// code paths of overview.cpp (4 doubles per register, no FMA), so that
+// the result does not depend on the CPU.
+//
+// The kernels only need 256-bit double arithmetic, so they target AVX and
+// not AVX2 (see rasterio_avx2.cpp and CPLHaveRuntimeAVX2() for the AVX2
+// dispatch): the Byte and UInt16 to double conversions of 4 values fit in
+// 128-bit registers.
+//
+// Only the convolution resamplers (CUBIC, CUBICSPLINE, LANCZOS, BILINEAR)
+// are covered: the horizontal pass for Byte and UInt16 sources, and the
+// 16-column vertical pass for all types. The horizontal pass of Float32
+// sources (which Int16 and Float64 are converted to) and the AVERAGE
+// resampler have AVX2/FMA kernels in overview_avx2.cpp.
+
+void GDALResampleConvolutionHorizontalColumn_AVX(
+    const GByte* pChunk, int nChunkXSize, int nRows,
+    const double* padfWeightsAligned, int nSrcPixelCount, bool bLess8,
+    double* padfDst, int nDstStride );
+
+void GDALResampleConvolutionHorizontalColumn_AVX(
+    const GUInt16* pChunk, int nChunkXSize, int nRows,
+    const double* padfWeightsAligned, int nSrcPixelCount, bool bLess8,
+    double* padfDst, int nDstStride );
+
+int GDALResampleConvolutionVertical_16cols_AVX(
+    const double* padfSrc, int nStride,
+    const double* padfWeights, int nSrcLineCount,
+    int nCols, float* pafDst );
+
+/************************************************************************/
+/*                             AVXLoad4Val()                            */
+/************************************************************************/
+
+static inline __m256d AVXLoad4Val( const GByte* ptr )
+{
+    GInt32 i;
+    memcpy(&i, ptr, 4);
+    return _mm256_cvtepi32_pd(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(i)));
+}
+
+static inline __m256d AVXLoad4Val( const GUInt16* ptr )
+{
+    const __m128i xmm_i =
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(ptr));
+    return _mm256_cvtepi32_pd(_mm_cvtepu16_epi32(xmm_i));
+}
+
+/************************************************************************/
+/*                            AVXHorizSum()                             */
+/************************************************************************/
+
+// Same order as XMMReg4Double::GetHorizSum() of the SSE2 implementation:
+// (v[0] + v[2]) + (v[1] + v[3])
+static inline double AVXHorizSum( __m256d ymm )
+{
+    const __m128d xmm = _mm_add_pd(_mm256_castpd256_pd128(ymm),
+                                   _mm256_extractf128_pd(ymm, 1));
+    const __m128d xmm2 = _mm_shuffle_pd(xmm, xmm, _MM_SHUFFLE2(0,1));
+    return _mm_cvtsd_f64(_mm_add_sd(xmm, xmm2));
+}
+
+/************************************************************************/
+/*                 GDALResampleConvolutionHorizontalAVX()               */
+/************************************************************************/
+
+template<class T> static inline double GDALResampleConvolutionHorizontalAVX(
+    const T* pChunk, const double* padfWeightsAligned, int nSrcPixelCount )
+{
+    __m256d v_acc1 = _mm256_setzero_pd();
+    __m256d v_acc2 = _mm256_setzero_pd();
+    int i = 0;  // Used after for.
+    for( ; i + 7 < nSrcPixelCount; i += 8 )
+    {
+        const __m256d v_pixels1 = AVXLoad4Val(pChunk+i);
+        const __m256d v_pixels2 = AVXLoad4Val(pChunk+i+4);
+        const __m256d v_weight1 = _mm256_load_pd(padfWeightsAligned+i);
+        const __m256d v_weight2 = _mm256_load_pd(padfWeightsAligned+i+4);
+
+        v_acc1 = _mm256_add_pd(v_acc1, _mm256_mul_pd(v_pixels1, v_weight1));
+        v_acc2 = _mm256_add_pd(v_acc2, _mm256_mul_pd(v_pixels2, v_weight2));
+    }
+
+    v_acc1 = _mm256_add_pd(v_acc1, v_acc2);
+
+    double dfVal = AVXHorizSum(v_acc1);
+    for( ; i < nSrcPixelCount; ++i )
+    {
+        dfVal += pChunk[i] * padfWeightsAligned[i];
+    }
+    return dfVal;
+}
+
+/************************************************************************/
+/*              GDALResampleConvolutionHorizontal_3rows_AVX()           */
+/************************************************************************/
+
+template<class T> static inline void
+GDALResampleConvolutionHorizontal_3rows_AVX(
+    const T* pChunkRow1, const T* pChunkRow2, const T* pChunkRow3,
+    const double* padfWeightsAligned, int nSrcPixelCount,
+    double& dfRes1, double& dfRes2, double& dfRes3 )
+{
+    __m256d v_acc1 = _mm256_setzero_pd();
+    __m256d v_acc2 = _mm256_setzero_pd();
+    __m256d v_acc3 = _mm256_setzero_pd();
+    int i = 0;
+    for( ; i + 7 < nSrcPixelCount; i += 8 )
+    {
+        const __m256d v_weight1 = _mm256_load_pd(padfWeightsAligned+i);
+        const __m256d v_weight2 = _mm256_load_pd(padfWeightsAligned+i+4);
+
+        v_acc1 = _mm256_add_pd(v_acc1,
+            _mm256_mul_pd(AVXLoad4Val(pChunkRow1+i), v_weight1));
+        v_acc1 = _mm256_add_pd(v_acc1,
+            _mm256_mul_pd(AVXLoad4Val(pChunkRow1+i+4), v_weight2));
+
+        v_acc2 = _mm256_add_pd(v_acc2,
+            _mm256_mul_pd(AVXLoad4Val(pChunkRow2+i), v_weight1));
+        v_acc2 = _mm256_add_pd(v_acc2,
+            _mm256_mul_pd(AVXLoad4Val(pChunkRow2+i+4), v_weight2));
+
+        v_acc3 = _mm256_add_pd(v_acc3,
+            _mm256_mul_pd(AVXLoad4Val(pChunkRow3+i), v_weight1));
+        v_acc3 = _mm256_add_pd(v_acc3,
+            _mm256_mul_pd(AVXLoad4Val(pChunkRow3+i+4), v_weight2));
+    }
+
+    dfRes1 = AVXHorizSum(v_acc1);
+    dfRes2 = AVXHorizSum(v_acc2);
+    dfRes3 = AVXHorizSum(v_acc3);
+    for( ; i < nSrcPixelCount; ++i )
+    {
+        dfRes1 += pChunkRow1[i] * padfWeightsAligned[i];
+        dfRes2 += pChunkRow2[i] * padfWeightsAligned[i];
+        dfRes3 += pChunkRow3[i] * padfWeightsAligned[i];
+    }
+}
+
+/************************************************************************/
+/*      GDALResampleConvolutionHorizontalPixelCountLess8_3rows_AVX()    */
+/************************************************************************/
+
+template<class T> static inline void
+GDALResampleConvolutionHorizontalPixelCountLess8_3rows_AVX(
+    const T* pChunkRow1, const T* pChunkRow2, const T* pChunkRow3,
+    const double* padfWeightsAligned, int nSrcPixelCount,
+    double& dfRes1, double& dfRes2, double& dfRes3 )
+{
+    __m256d v_acc1 = _mm256_setzero_pd();
+    __m256d v_acc2 = _mm256_setzero_pd();
+    __m256d v_acc3 = _mm256_setzero_pd();
+    int i = 0;  // Use after for.
+    for( ; i + 3 < nSrcPixelCount; i += 4 )
+    {
+        const __m256d v_weight = _mm256_load_pd(padfWeightsAligned + i);
+
+        v_acc1 = _mm256_add_pd(v_acc1,
+            _mm256_mul_pd(AVXLoad4Val(pChunkRow1+i), v_weight));
+        v_acc2 = _mm256_add_pd(v_acc2,
+            _mm256_mul_pd(AVXLoad4Val(pChunkRow2+i), v_weight));
+        v_acc3 = _mm256_add_pd(v_acc3,
+            _mm256_mul_pd(AVXLoad4Val(pChunkRow3+i), v_weight));
+    }
+
+    dfRes1 = AVXHorizSum(v_acc1);
+    dfRes2 = AVXHorizSum(v_acc2);
+    dfRes3 = AVXHorizSum(v_acc3);
+
+    for( ; i < nSrcPixelCount; ++i )
+    {
+        dfRes1 += pChunkRow1[i] * padfWeightsAligned[i];
+        dfRes2 += pChunkRow2[i] * padfWeightsAligned[i];
+        dfRes3 += pChunkRow3[i] * padfWeightsAligned[i];
+    }
+}
+
+/************************************************************************/
+/*        GDALResampleConvolutionHorizontalPixelCount4_3rows_AVX()      */
+/************************************************************************/
+
+template<class T> static inline void
+GDALResampleConvolutionHorizontalPixelCount4_3rows_AVX(
+    const T* pChunkRow1, const T* pChunkRow2, const T* pChunkRow3,
+    const double* padfWeightsAligned,
+    double& dfRes1, double& dfRes2, double& dfRes3 )
+{
+    const __m256d v_weight = _mm256_load_pd(padfWeightsAligned);
+
+    dfRes1 = AVXHorizSum(_mm256_mul_pd(AVXLoad4Val(pChunkRow1), v_weight));
+    dfRes2 = AVXHorizSum(_mm256_mul_pd(AVXLoad4Val(pChunkRow2), v_weight));
+    dfRes3 = AVXHorizSum(_mm256_mul_pd(AVXLoad4Val(pChunkRow3), v_weight));
+}
+
+/************************************************************************/
+/*            GDALResampleConvolutionHorizontalColumnAVX()              */
+/************************************************************************/
+
+// Horizontal filtering of nRows source lines for one target column, with
+// the same decomposition in groups of 3 lines as in
+// GDALResampleChunk32R_ConvolutionT().
+template<class T> static void GDALResampleConvolutionHorizontalColumnAVX(
+    const T* pChunk, int nChunkXSize, int nRows,
+    const double* padfWeightsAligned, int nSrcPixelCount, bool bLess8,
+    double* padfDst, int nDstStride )
+{
+    int iRow = 0;
+    if( nSrcPixelCount == 4 )
+    {
+        for( ; iRow + 2 < nRows; iRow += 3 )
+        {
+            const T* pRow = pChunk + static_cast<size_t>(iRow) * nChunkXSize;
+            GDALResampleConvolutionHorizontalPixelCount4_3rows_AVX(
+                pRow, pRow + nChunkXSize, pRow + 2 * nChunkXSize,
+                padfWeightsAligned,
+                padfDst[static_cast<size_t>(iRow) * nDstStride],
+                padfDst[static_cast<size_t>(iRow + 1) * nDstStride],
+                padfDst[static_cast<size_t>(iRow + 2) * nDstStride] );
+        }
+    }
+    else if( bLess8 )
+    {
+        for( ; iRow + 2 < nRows; iRow += 3 )
+        {
+            const T* pRow = pChunk + static_cast<size_t>(iRow) * nChunkXSize;
+            GDALResampleConvolutionHorizontalPixelCountLess8_3rows_AVX(
+                pRow, pRow + nChunkXSize, pRow + 2 * nChunkXSize,
+                padfWeightsAligned, nSrcPixelCount,
+                padfDst[static_cast<size_t>(iRow) * nDstStride],
+                padfDst[static_cast<size_t>(iRow + 1) * nDstStride],
+                padfDst[static_cast<size_t>(iRow + 2) * nDstStride] );
+        }
+    }
+    else
+    {
+        for( ; iRow + 2 < nRows; iRow += 3 )
+        {
+            const T* pRow = pChunk + static_cast<size_t>(iRow) * nChunkXSize;
+            GDALResampleConvolutionHorizontal_3rows_AVX(
+                pRow, pRow + nChunkXSize, pRow + 2 * nChunkXSize,
+                padfWeightsAligned, nSrcPixelCount,
+                padfDst[static_cast<size_t>(iRow) * nDstStride],
+                padfDst[static_cast<size_t>(iRow + 1) * nDstStride],
+                padfDst[static_cast<size_t>(iRow + 2) * nDstStride] );
+        }
+    }
+    for( ; iRow < nRows; ++iRow )
+    {
+        padfDst[static_cast<size_t>(iRow) * nDstStride] =
+            GDALResampleConvolutionHorizontalAVX(
+                pChunk + static_cast<size_t>(iRow) * nChunkXSize,
+                padfWeightsAligned, nSrcPixelCount );
+    }
+}
+
+void GDALResampleConvolutionHorizontalColumn_AVX(
+    const GByte* pChunk, int nChunkXSize, int nRows,
+    const double* padfWeightsAligned, int nSrcPixelCount, bool bLess8,
+    double* padfDst, int nDstStride )
+{
+    GDALResampleConvolutionHorizontalColumnAVX(
+        pChunk, nChunkXSize, nRows, padfWeightsAligned, nSrcPixelCount,
+        bLess8, padfDst, nDstStride );
+}
+
+void GDALResampleConvolutionHorizontalColumn_AVX(
+    const GUInt16* pChunk, int nChunkXSize, int nRows,
+    const double* padfWeightsAligned, int nSrcPixelCount, bool bLess8,
+    double* padfDst, int nDstStride )
+{
+    GDALResampleConvolutionHorizontalColumnAVX(
+        pChunk, nChunkXSize, nRows, padfWeightsAligned, nSrcPixelCount,
+        bLess8, padfDst, nDstStride );
+}
+
+/************************************************************************/
+/*             GDALResampleConvolutionVertical_16cols_AVX()             */
+/************************************************************************/
+
+// Vertical filtering of the first nCols / 16 * 16 columns of a target line.
+// Returns the number of columns processed.
+int GDALResampleConvolutionVertical_16cols_AVX(
+    const double* padfSrc, int nStride,
+    const double* padfWeights, int nSrcLineCount,
+    int nCols, float* pafDst )
+{
+    int iCol = 0;
+    for( ; iCol + 15 < nCols; iCol += 16 )
+    {
+        const double* pChunk = padfSrc + iCol;
+        __m256d v_acc0 = _mm256_setzero_pd();
+        __m256d v_acc1 = _mm256_setzero_pd();
+        __m256d v_acc2 = _mm256_setzero_pd();
+        __m256d v_acc3 = _mm256_setzero_pd();
+        int i = 0;
+        size_t j = 0;
+        for( ; i < nSrcLineCount; ++i, j += nStride )
+        {
+            const __m256d w = _mm256_set1_pd(padfWeights[i]);
+            v_acc0 = _mm256_add_pd(v_acc0,
+                _mm256_mul_pd(_mm256_loadu_pd(pChunk+j+ 0), w));
+            v_acc1 = _mm256_add_pd(v_acc1,
+                _mm256_mul_pd(_mm256_loadu_pd(pChunk+j+ 4), w));
+            v_acc2 = _mm256_add_pd(v_acc2,
+                _mm256_mul_pd(_mm256_loadu_pd(pChunk+j+ 8), w));
+            v_acc3 = _mm256_add_pd(v_acc3,
+                _mm256_mul_pd(_mm256_loadu_pd(pChunk+j+12), w));
+        }
+        _mm_storeu_ps(pafDst + iCol +  0, _mm256_cvtpd_ps(v_acc0));
+        _mm_storeu_ps(pafDst + iCol +  4, _mm256_cvtpd_ps(v_acc1));
+        _mm_storeu_ps(pafDst + iCol +  8, _mm256_cvtpd_ps(v_acc2));
+        _mm_storeu_ps(pafDst + iCol + 12, _mm256_cvtpd_ps(v_acc3));
+    }
+    return iCol;
+}
+
+#endif // HAVE_AVX_AT_COMPILE_TIME
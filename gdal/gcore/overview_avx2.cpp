@@ -0,0 +1,275 @@
+/******************************************************************************
+ *
+ * Project:  GDAL Core
+ * Purpose:  AVX2/FMA specializations of the overview resampling kernels
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cpl_port.h"
+
+CPL_CVSID("$Id$")
+
+#if defined(HAVE_AVX2_AT_COMPILE_TIME) && ( defined(__x86_64) || defined(_M_X64) )
+
+#include <immintrin.h>
+
+// This file is compiled with AVX2 and FMA enabled, and its functions are
+// only called from overview.cpp after CPLHaveRuntimeAVX2(), which checks
+// both. It must not include gdalsse_priv.h, whose inline classes are also
+// instantiated without AVX2 in overview.cpp.
+//
+// Float32 sources (Int16, Float32 and Float64 bands are resampled as
+// Float32) have no SSE2 code path, so their horizontal convolution uses FMA.
+// Byte and UInt16 sources keep the AVX kernels of overview_avx.cpp, which
+// give the same result as the SSE2 code.
+//
+// The AVERAGE kernels only handle the common case of a factor of 2 in both
+// directions without nodata, and compute exactly the same values as the
+// scalar code.
+
+void GDALResampleConvolutionHorizontalColumn_AVX2(
+    const float* pChunk, int nChunkXSize, int nRows,
+    const double* padfWeightsAligned, int nSrcPixelCount,
+    double* padfDst, int nDstStride );
+
+int GDALResampleAverageFactor2_AVX2( const GByte* pSrc, int nSrcStride,
+                                     int nDstXWidth, GByte* pDst );
+
+int GDALResampleAverageFactor2_AVX2( const GUInt16* pSrc, int nSrcStride,
+                                     int nDstXWidth, GUInt16* pDst );
+
+int GDALResampleAverageFactor2_AVX2( const float* pSrc, int nSrcStride,
+                                     int nDstXWidth, float* pDst );
+
+/************************************************************************/
+/*                            AVX2Load4Val()                            */
+/************************************************************************/
+
+static inline __m256d AVX2Load4Val( const float* ptr )
+{
+    return _mm256_cvtps_pd(_mm_loadu_ps(ptr));
+}
+
+/************************************************************************/
+/*                           AVX2HorizSum()                             */
+/************************************************************************/
+
+static inline double AVX2HorizSum( __m256d ymm )
+{
+    const __m128d xmm = _mm_add_pd(_mm256_castpd256_pd128(ymm),
+                                   _mm256_extractf128_pd(ymm, 1));
+    const __m128d xmm2 = _mm_shuffle_pd(xmm, xmm, _MM_SHUFFLE2(0,1));
+    return _mm_cvtsd_f64(_mm_add_sd(xmm, xmm2));
+}
+
+/************************************************************************/
+/*                GDALResampleConvolutionHorizontalAVX2()               */
+/************************************************************************/
+
+static inline double GDALResampleConvolutionHorizontalAVX2(
+    const float* pChunk, const double* padfWeightsAligned,
+    int nSrcPixelCount )
+{
+    __m256d v_acc1 = _mm256_setzero_pd();
+    __m256d v_acc2 = _mm256_setzero_pd();
+    int i = 0;  // Used after for.
+    for( ; i + 7 < nSrcPixelCount; i += 8 )
+    {
+        v_acc1 = _mm256_fmadd_pd(AVX2Load4Val(pChunk+i),
+                                 _mm256_load_pd(padfWeightsAligned+i),
+                                 v_acc1);
+        v_acc2 = _mm256_fmadd_pd(AVX2Load4Val(pChunk+i+4),
+                                 _mm256_load_pd(padfWeightsAligned+i+4),
+                                 v_acc2);
+    }
+
+    double dfVal = AVX2HorizSum(_mm256_add_pd(v_acc1, v_acc2));
+    for( ; i < nSrcPixelCount; ++i )
+    {
+        dfVal += pChunk[i] * padfWeightsAligned[i];
+    }
+    return dfVal;
+}
+
+/************************************************************************/
+/*             GDALResampleConvolutionHorizontal_3rows_AVX2()           */
+/************************************************************************/
+
+static inline void GDALResampleConvolutionHorizontal_3rows_AVX2(
+    const float* pChunkRow1, const float* pChunkRow2,
+    const float* pChunkRow3,
+    const double* padfWeightsAligned, int nSrcPixelCount,
+    double& dfRes1, double& dfRes2, double& dfRes3 )
+{
+    __m256d v_acc1 = _mm256_setzero_pd();
+    __m256d v_acc2 = _mm256_setzero_pd();
+    __m256d v_acc3 = _mm256_setzero_pd();
+    int i = 0;  // Used after for.
+    for( ; i + 3 < nSrcPixelCount; i += 4 )
+    {
+        const __m256d v_weight = _mm256_load_pd(padfWeightsAligned + i);
+        v_acc1 = _mm256_fmadd_pd(AVX2Load4Val(pChunkRow1+i), v_weight, v_acc1);
+        v_acc2 = _mm256_fmadd_pd(AVX2Load4Val(pChunkRow2+i), v_weight, v_acc2);
+        v_acc3 = _mm256_fmadd_pd(AVX2Load4Val(pChunkRow3+i), v_weight, v_acc3);
+    }
+
+    dfRes1 = AVX2HorizSum(v_acc1);
+    dfRes2 = AVX2HorizSum(v_acc2);
+    dfRes3 = AVX2HorizSum(v_acc3);
+    for( ; i < nSrcPixelCount; ++i )
+    {
+        dfRes1 += pChunkRow1[i] * padfWeightsAligned[i];
+        dfRes2 += pChunkRow2[i] * padfWeightsAligned[i];
+        dfRes3 += pChunkRow3[i] * padfWeightsAligned[i];
+    }
+}
+
+/************************************************************************/
+/*            GDALResampleConvolutionHorizontalColumn_AVX2()            */
+/************************************************************************/
+
+// Horizontal filtering of nRows source lines for one target column, with
+// the same decomposition in groups of 3 lines as in
+// GDALResampleChunk32R_ConvolutionT().
+void GDALResampleConvolutionHorizontalColumn_AVX2(
+    const float* pChunk, int nChunkXSize, int nRows,
+    const double* padfWeightsAligned, int nSrcPixelCount,
+    double* padfDst, int nDstStride )
+{
+    int iRow = 0;
+    for( ; iRow + 2 < nRows; iRow += 3 )
+    {
+        const float* pRow = pChunk + static_cast<size_t>(iRow) * nChunkXSize;
+        GDALResampleConvolutionHorizontal_3rows_AVX2(
+            pRow, pRow + nChunkXSize, pRow + 2 * nChunkXSize,
+            padfWeightsAligned, nSrcPixelCount,
+            padfDst[static_cast<size_t>(iRow) * nDstStride],
+            padfDst[static_cast<size_t>(iRow + 1) * nDstStride],
+            padfDst[static_cast<size_t>(iRow + 2) * nDstStride] );
+    }
+    for( ; iRow < nRows; ++iRow )
+    {
+        padfDst[static_cast<size_t>(iRow) * nDstStride] =
+            GDALResampleConvolutionHorizontalAVX2(
+                pChunk + static_cast<size_t>(iRow) * nChunkXSize,
+                padfWeightsAligned, nSrcPixelCount );
+    }
+}
+
+/************************************************************************/
+/*                   GDALResampleAverageFactor2_AVX2()                  */
+/************************************************************************/
+
+// Average of 2x2 source pixels, pSrc pointing to the first of the 2 source
+// lines. Returns the number of target pixels computed.
+
+int GDALResampleAverageFactor2_AVX2( const GByte* pSrc, int nSrcStride,
+                                     int nDstXWidth, GByte* pDst )
+{
+    const __m256i ymm_one = _mm256_set1_epi8(1);
+    const __m256i ymm_two = _mm256_set1_epi16(2);
+    int iDstPixel = 0;
+    for( ; iDstPixel + 15 < nDstXWidth; iDstPixel += 16 )
+    {
+        const __m256i ymm_row1 = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(pSrc + 2 * iDstPixel));
+        const __m256i ymm_row2 = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(pSrc + 2 * iDstPixel +
+                                             nSrcStride));
+        // Sums of pairs of horizontally adjacent pixels, on 16 bits.
+        __m256i ymm_sum = _mm256_add_epi16(
+            _mm256_maddubs_epi16(ymm_row1, ymm_one),
+            _mm256_maddubs_epi16(ymm_row2, ymm_one));
+        // (nTotal + 2) / 4
+        ymm_sum = _mm256_srli_epi16(_mm256_add_epi16(ymm_sum, ymm_two), 2);
+        // Pack to bytes: each 128-bit lane has its 8 values in its low half.
+        ymm_sum = _mm256_packus_epi16(ymm_sum, ymm_sum);
+        ymm_sum = _mm256_permute4x64_epi64(ymm_sum, 0 | (2 << 2));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + iDstPixel),
+                         _mm256_castsi256_si128(ymm_sum));
+    }
+    return iDstPixel;
+}
+
+int GDALResampleAverageFactor2_AVX2( const GUInt16* pSrc, int nSrcStride,
+                                     int nDstXWidth, GUInt16* pDst )
+{
+    const __m256i ymm_mask_low = _mm256_set1_epi32(0xFFFF);
+    const __m256i ymm_two = _mm256_set1_epi32(2);
+    int iDstPixel = 0;
+    for( ; iDstPixel + 7 < nDstXWidth; iDstPixel += 8 )
+    {
+        const __m256i ymm_row1 = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(pSrc + 2 * iDstPixel));
+        const __m256i ymm_row2 = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(pSrc + 2 * iDstPixel +
+                                             nSrcStride));
+        // Even and odd pixels as 32-bit values, so that the sum cannot
+        // overflow.
+        __m256i ymm_sum = _mm256_add_epi32(
+            _mm256_add_epi32(_mm256_and_si256(ymm_row1, ymm_mask_low),
+                             _mm256_srli_epi32(ymm_row1, 16)),
+            _mm256_add_epi32(_mm256_and_si256(ymm_row2, ymm_mask_low),
+                             _mm256_srli_epi32(ymm_row2, 16)));
+        // (nTotal + 2) / 4
+        ymm_sum = _mm256_srli_epi32(_mm256_add_epi32(ymm_sum, ymm_two), 2);
+        ymm_sum = _mm256_packus_epi32(ymm_sum, ymm_sum);
+        ymm_sum = _mm256_permute4x64_epi64(ymm_sum, 0 | (2 << 2));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + iDstPixel),
+                         _mm256_castsi256_si128(ymm_sum));
+    }
+    return iDstPixel;
+}
+
+int GDALResampleAverageFactor2_AVX2( const float* pSrc, int nSrcStride,
+                                     int nDstXWidth, float* pDst )
+{
+    const __m256d ymm_quarter = _mm256_set1_pd(0.25);
+    int iDstPixel = 0;
+    for( ; iDstPixel + 3 < nDstXWidth; iDstPixel += 4 )
+    {
+        const float* pSrcRow1 = pSrc + 2 * iDstPixel;
+        const float* pSrcRow2 = pSrcRow1 + nSrcStride;
+        // Pairs of pixels of each line, as doubles.
+        const __m256d ymm_row1_lo = _mm256_cvtps_pd(_mm_loadu_ps(pSrcRow1));
+        const __m256d ymm_row1_hi =
+            _mm256_cvtps_pd(_mm_loadu_ps(pSrcRow1 + 4));
+        const __m256d ymm_row2_lo = _mm256_cvtps_pd(_mm_loadu_ps(pSrcRow2));
+        const __m256d ymm_row2_hi =
+            _mm256_cvtps_pd(_mm_loadu_ps(pSrcRow2 + 4));
+        // The additions are done in the same order as in the scalar code,
+        // for target pixels 0, 2, 1, 3.
+        __m256d ymm_sum = _mm256_hadd_pd(ymm_row1_lo, ymm_row1_hi);
+        ymm_sum = _mm256_add_pd(ymm_sum,
+                                _mm256_unpacklo_pd(ymm_row2_lo, ymm_row2_hi));
+        ymm_sum = _mm256_add_pd(ymm_sum,
+                                _mm256_unpackhi_pd(ymm_row2_lo, ymm_row2_hi));
+        // Dividing by 4 and multiplying by 0.25 give the same result.
+        ymm_sum = _mm256_mul_pd(ymm_sum, ymm_quarter);
+        ymm_sum = _mm256_permute4x64_pd(ymm_sum, _MM_SHUFFLE(3,1,2,0));
+        _mm_storeu_ps(pDst + iDstPixel, _mm256_cvtpd_ps(ymm_sum));
+    }
+    return iDstPixel;
+}
+
+#endif // HAVE_AVX2_AT_COMPILE_TIME
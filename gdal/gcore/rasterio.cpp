@@ -41,7 +41,10 @@
 
 #include <algorithm>
 #include <limits>
+#include <mutex>
+#include <new>
 #include <stdexcept>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_cpu_features.h"
@@ -49,6 +52,7 @@
 #include "cpl_progress.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal_priv_templates.hpp"
 #include "gdal_vrt.h"
 #include "gdalwarper.h"
@@ -803,6 +807,316 @@ static int GDALRasterIOTransformer( void *pTransformerArg,
     return TRUE;
 }
 
+/************************************************************************/
+/*                      GDALCreateMEMBufferDataset()                    */
+/************************************************************************/
+
+// Create a single band MEM dataset whose band wraps an existing buffer.
+// pabyOrigin is the address of the top left pixel of the band.
+static GDALDataset* GDALCreateMEMBufferDataset( GByte* pabyOrigin,
+                                                int nXSize, int nYSize,
+                                                GDALDataType eDT,
+                                                GSpacing nPixelSpace,
+                                                GSpacing nLineSpace,
+                                                const char* pszNBITS )
+{
+    GDALDataset* poMEMDS = MEMDataset::Create( "", nXSize, nYSize, 0,
+                                               eDT, nullptr );
+    if( poMEMDS == nullptr )
+        return nullptr;
+
+    char szBuffer[32] = { '\0' };
+    int nRet = CPLPrintPointer(szBuffer, pabyOrigin, sizeof(szBuffer));
+    szBuffer[nRet] = '\0';
+
+    char szBuffer0[64] = { '\0' };
+    snprintf(szBuffer0, sizeof(szBuffer0), "DATAPOINTER=%s", szBuffer);
+    char szBuffer1[64] = { '\0' };
+    snprintf( szBuffer1, sizeof(szBuffer1),
+              "PIXELOFFSET=" CPL_FRMT_GIB, static_cast<GIntBig>(nPixelSpace) );
+    char szBuffer2[64] = { '\0' };
+    snprintf( szBuffer2, sizeof(szBuffer2),
+              "LINEOFFSET=" CPL_FRMT_GIB, static_cast<GIntBig>(nLineSpace) );
+    char* apszOptions[4] = { szBuffer0, szBuffer1, szBuffer2, nullptr };
+
+    poMEMDS->AddBand(eDT, apszOptions);
+
+    if( pszNBITS )
+        poMEMDS->GetRasterBand(1)->SetMetadataItem( "NBITS", pszNBITS,
+                                                    "IMAGE_STRUCTURE" );
+    return poMEMDS;
+}
+
+/************************************************************************/
+/*                        GDALRIOResampledBuffers                       */
+/************************************************************************/
+
+// Minimum number of output rows of a chunk when RasterIOResampled() cuts
+// the output in stripes for the worker threads.
+static const int GDAL_RIO_RESAMPLED_MIN_ROWS = 16;
+
+// Maximum size of the working buffers kept between two calls to
+// RasterIOResampled(), summed over all threads.
+static const size_t GDAL_RIO_RESAMPLED_MAX_CACHED_BYTES = 64 * 1024 * 1024;
+
+static std::mutex oRIOResampledCacheMutex;
+static size_t nRIOResampledCachedBytes = 0;
+
+namespace {
+
+struct GDALRIOResampledBufferCache
+{
+    bool                bInUse;
+    std::vector<void*>  apBuffers;
+    std::vector<size_t> anSizes;
+    // Part of nRIOResampledCachedBytes held by this cache.
+    size_t              nCachedBytes;
+
+    GDALRIOResampledBufferCache() : bInUse(false), nCachedBytes(0) {}
+
+    void Clear()
+    {
+        for( size_t i = 0; i < apBuffers.size(); i++ )
+            VSIFree(apBuffers[i]);
+        apBuffers.clear();
+        anSizes.clear();
+    }
+
+    // Keep the buffers if the caches of all threads stay within
+    // GDAL_RIO_RESAMPLED_MAX_CACHED_BYTES, otherwise free them.
+    void Release()
+    {
+        size_t nTotalSize = 0;
+        for( size_t i = 0; i < anSizes.size(); i++ )
+            nTotalSize += anSizes[i];
+
+        std::lock_guard<std::mutex> oLock(oRIOResampledCacheMutex);
+        nRIOResampledCachedBytes -= nCachedBytes;
+        if( nTotalSize >
+                GDAL_RIO_RESAMPLED_MAX_CACHED_BYTES - nRIOResampledCachedBytes )
+        {
+            Clear();
+            nTotalSize = 0;
+        }
+        nCachedBytes = nTotalSize;
+        nRIOResampledCachedBytes += nCachedBytes;
+    }
+};
+
+// Working buffers of RasterIOResampled(). They are taken from a per-thread
+// cache, so that the many small downsampled reads of a tile server do not
+// reallocate them at each call. A nested call from the same thread, for
+// example when the source band is itself resampled, gets buffers of its own.
+class GDALRIOResampledBuffers
+{
+    GDALRIOResampledBufferCache* m_psCache;
+    GDALRIOResampledBufferCache  m_sLocal;
+
+    CPL_DISALLOW_COPY_ASSIGN(GDALRIOResampledBuffers)
+
+  public:
+    GDALRIOResampledBuffers();
+    ~GDALRIOResampledBuffers();
+
+    void* Get( int iBuffer, size_t nSize );
+};
+
+}  // namespace
+
+static void GDALRIOResampledBufferCacheFree( void* pData )
+{
+    GDALRIOResampledBufferCache* psCache =
+        static_cast<GDALRIOResampledBufferCache *>(pData);
+    psCache->Clear();
+    psCache->Release();
+    delete psCache;
+}
+
+GDALRIOResampledBuffers::GDALRIOResampledBuffers() :
+    m_psCache(nullptr)
+{
+    int bMemoryError = FALSE;
+    GDALRIOResampledBufferCache* psCache =
+        static_cast<GDALRIOResampledBufferCache *>(
+            CPLGetTLSEx(CTLS_RASTERIO_RESAMPLED_BUFFERS, &bMemoryError));
+    if( bMemoryError )
+        return;
+    if( psCache == nullptr )
+    {
+        psCache = new (std::nothrow) GDALRIOResampledBufferCache();
+        if( psCache == nullptr )
+            return;
+        CPLSetTLSWithFreeFuncEx( CTLS_RASTERIO_RESAMPLED_BUFFERS, psCache,
+                                 GDALRIOResampledBufferCacheFree,
+                                 &bMemoryError );
+        if( bMemoryError )
+        {
+            delete psCache;
+            return;
+        }
+    }
+    if( !psCache->bInUse )
+    {
+        psCache->bInUse = true;
+        m_psCache = psCache;
+    }
+}
+
+GDALRIOResampledBuffers::~GDALRIOResampledBuffers()
+{
+    m_sLocal.Clear();
+    if( m_psCache )
+    {
+        m_psCache->Release();
+        m_psCache->bInUse = false;
+    }
+}
+
+// Return buffer number iBuffer, grown to at least nSize bytes if needed.
+void* GDALRIOResampledBuffers::Get( int iBuffer, size_t nSize )
+{
+    GDALRIOResampledBufferCache* psCache =
+        m_psCache ? m_psCache : &m_sLocal;
+    if( static_cast<size_t>(iBuffer) >= psCache->apBuffers.size() )
+    {
+        psCache->apBuffers.resize(iBuffer + 1, nullptr);
+        psCache->anSizes.resize(iBuffer + 1, 0);
+    }
+    if( psCache->anSizes[iBuffer] < nSize )
+    {
+        VSIFree(psCache->apBuffers[iBuffer]);
+        psCache->apBuffers[iBuffer] = VSI_MALLOC_VERBOSE(nSize);
+        psCache->anSizes[iBuffer] =
+            psCache->apBuffers[iBuffer] != nullptr ? nSize : 0;
+    }
+    return psCache->apBuffers[iBuffer];
+}
+
+/************************************************************************/
+/*                          GDALRIOResampleJob                          */
+/************************************************************************/
+
+namespace {
+
+// Resampling of a source chunk into a window of the output buffer of
+// RasterIOResampled(). In multi-threaded mode, poMEMBand is nullptr and
+// the job wraps the output buffer in a MEM band of its own.
+struct GDALRIOResampleJob
+{
+    GDALResampleFunction pfnResampleFunc;
+    double               dfXRatioDstToSrc;
+    double               dfYRatioDstToSrc;
+    double               dfSrcXDelta;
+    double               dfSrcYDelta;
+    GDALDataType         eWrkDataType;
+    void                *pChunk;
+    GByte               *pabyChunkNoDataMask;
+    int                  nChunkXOff;
+    int                  nChunkXSize;
+    int                  nChunkYOff;
+    int                  nChunkYSize;
+    int                  nDstXOff;
+    int                  nDstXOff2;
+    int                  nDstYOff;
+    int                  nDstYOff2;
+    GDALRasterBand      *poMEMBand;
+    GByte               *pabyMEMOrigin;
+    int                  nMEMXSize;
+    int                  nMEMYSize;
+    GDALDataType         eMEMDataType;
+    GSpacing             nMEMPixelSpace;
+    GSpacing             nMEMLineSpace;
+    const char          *pszNBITS;
+    const char          *pszResampling;
+    int                  bHasNoData;
+    float                fNoDataValue;
+    GDALColorTable      *poColorTable;
+    GDALDataType         eSrcDataType;
+    CPLErr               eErr;
+};
+
+}  // namespace
+
+static void GDALRIOResampleJobFunc( void* pData )
+{
+    GDALRIOResampleJob* psJob = static_cast<GDALRIOResampleJob *>(pData);
+
+    GDALDataset* poMEMDS = nullptr;
+    GDALRasterBand* poMEMBand = psJob->poMEMBand;
+    if( poMEMBand == nullptr )
+    {
+        poMEMDS = GDALCreateMEMBufferDataset( psJob->pabyMEMOrigin,
+                                              psJob->nMEMXSize,
+                                              psJob->nMEMYSize,
+                                              psJob->eMEMDataType,
+                                              psJob->nMEMPixelSpace,
+                                              psJob->nMEMLineSpace,
+                                              psJob->pszNBITS );
+        if( poMEMDS == nullptr )
+        {
+            psJob->eErr = CE_Failure;
+            return;
+        }
+        poMEMBand = poMEMDS->GetRasterBand(1);
+    }
+
+    const bool bPropagateNoData = false;
+    psJob->eErr = psJob->pfnResampleFunc(
+        psJob->dfXRatioDstToSrc,
+        psJob->dfYRatioDstToSrc,
+        psJob->dfSrcXDelta,
+        psJob->dfSrcYDelta,
+        psJob->eWrkDataType,
+        psJob->pChunk,
+        psJob->pabyChunkNoDataMask,
+        psJob->nChunkXOff, psJob->nChunkXSize,
+        psJob->nChunkYOff, psJob->nChunkYSize,
+        psJob->nDstXOff, psJob->nDstXOff2,
+        psJob->nDstYOff, psJob->nDstYOff2,
+        poMEMBand,
+        psJob->pszResampling,
+        psJob->bHasNoData, psJob->fNoDataValue,
+        psJob->poColorTable,
+        psJob->eSrcDataType,
+        bPropagateNoData );
+
+    if( poMEMDS )
+        GDALClose(poMEMDS);
+}
+
+/************************************************************************/
+/*                     GDALRIOResampledSubmitBatch()                    */
+/************************************************************************/
+
+// Wait for the batch of jobs being resampled, and submit the one that has
+// just been read, whose source buffers will be reused after the next call.
+static CPLErr GDALRIOResampledSubmitBatch(
+    CPLJobQueue* poJobQueue,
+    std::vector<GDALRIOResampleJob> aoJobs[2], int& iCurBatch )
+{
+    poJobQueue->WaitCompletion();
+
+    CPLErr eErr = CE_None;
+    std::vector<GDALRIOResampleJob>& aoPrevJobs = aoJobs[1 - iCurBatch];
+    for( size_t i = 0; i < aoPrevJobs.size(); i++ )
+    {
+        if( eErr == CE_None )
+            eErr = aoPrevJobs[i].eErr;
+    }
+    aoPrevJobs.clear();
+
+    if( eErr == CE_None )
+    {
+        std::vector<void*> apJobs;
+        for( size_t i = 0; i < aoJobs[iCurBatch].size(); i++ )
+            apJobs.push_back(&aoJobs[iCurBatch][i]);
+        poJobQueue->SubmitJobs(GDALRIOResampleJobFunc, apJobs);
+    }
+
+    iCurBatch = 1 - iCurBatch;
+    return eErr;
+}
+
 /************************************************************************/
 /*                          RasterIOResampled()                         */
 /************************************************************************/
@@ -865,8 +1179,7 @@ CPLErr GDALRasterBand::RasterIOResampled(
     }
 
     // Create a MEM dataset that wraps the output buffer.
-    GDALDataset* poMEMDS;
-    void* pTempBuffer = nullptr;
+    GDALRIOResampledBuffers oBuffers;
     GSpacing nPSMem = nPixelSpace;
     GSpacing nLSMem = nLineSpace;
     void* pDataMem = pData;
@@ -875,43 +1188,33 @@ CPLErr GDALRasterBand::RasterIOResampled(
     {
         nPSMem = GDALGetDataTypeSizeBytes(eDataType);
         nLSMem = nPSMem * nBufXSize;
-        pTempBuffer = VSI_MALLOC2_VERBOSE( nBufYSize, static_cast<size_t>(nLSMem) );
-        if( pTempBuffer == nullptr )
+        if( static_cast<GUIntBig>(nLSMem) >
+                std::numeric_limits<size_t>::max() / nBufYSize )
+        {
+            ReportError( CE_Failure, CPLE_OutOfMemory,
+                         "Too large temporary buffer" );
+            return CE_Failure;
+        }
+        pDataMem = oBuffers.Get( 0, static_cast<size_t>(nLSMem) * nBufYSize );
+        if( pDataMem == nullptr )
             return CE_Failure;
-        pDataMem = pTempBuffer;
         eDTMem = eDataType;
     }
 
-    poMEMDS = MEMDataset::Create( "", nDestXOffVirtual + nBufXSize,
-                                  nDestYOffVirtual + nBufYSize, 0,
-                                  eDTMem, nullptr );
-    char szBuffer[32] = { '\0' };
-    int nRet =
-        CPLPrintPointer(
-            szBuffer, static_cast<GByte*>(pDataMem)
-            - nPSMem * nDestXOffVirtual
-            - nLSMem * nDestYOffVirtual, sizeof(szBuffer));
-    szBuffer[nRet] = '\0';
-
-    char szBuffer0[64] = { '\0' };
-    snprintf(szBuffer0, sizeof(szBuffer0), "DATAPOINTER=%s", szBuffer);
-    char szBuffer1[64] = { '\0' };
-    snprintf( szBuffer1, sizeof(szBuffer1),
-              "PIXELOFFSET=" CPL_FRMT_GIB, static_cast<GIntBig>(nPSMem) );
-    char szBuffer2[64] = { '\0' };
-    snprintf( szBuffer2, sizeof(szBuffer2),
-              "LINEOFFSET=" CPL_FRMT_GIB, static_cast<GIntBig>(nLSMem) );
-    char* apszOptions[4] = { szBuffer0, szBuffer1, szBuffer2, nullptr };
-
-    poMEMDS->AddBand(eDTMem, apszOptions);
+    const char* pszNBITS = GetMetadataItem("NBITS", "IMAGE_STRUCTURE");
+    GByte* const pabyMEMOrigin = static_cast<GByte*>(pDataMem)
+                                 - nPSMem * nDestXOffVirtual
+                                 - nLSMem * nDestYOffVirtual;
+    const int nMEMXSize = nDestXOffVirtual + nBufXSize;
+    const int nMEMYSize = nDestYOffVirtual + nBufYSize;
+    GDALDataset* poMEMDS =
+        GDALCreateMEMBufferDataset( pabyMEMOrigin, nMEMXSize, nMEMYSize,
+                                    eDTMem, nPSMem, nLSMem, pszNBITS );
+    if( poMEMDS == nullptr )
+        return CE_Failure;
 
     GDALRasterBandH hMEMBand = poMEMDS->GetRasterBand(1);
 
-    const char* pszNBITS = GetMetadataItem("NBITS", "IMAGE_STRUCTURE");
-    if( pszNBITS )
-        reinterpret_cast<GDALRasterBand *>(hMEMBand)->
-            SetMetadataItem("NBITS", pszNBITS, "IMAGE_STRUCTURE");
-
     CPLErr eErr = CE_None;
 
     // Do the resampling.
@@ -1055,6 +1358,40 @@ CPLErr GDALRasterBand::RasterIOResampled(
                 nDstBlockYSize /= 2;
         }
 
+        // With GDAL_NUM_THREADS, resample the chunks in worker threads,
+        // while the calling thread reads the source. Cut the output in
+        // stripes of rows so that there is at least one chunk per thread,
+        // but not too thin, as each chunk is read with a margin of the
+        // kernel radius.
+        const int nXChunks = (nBufXSize + nDstBlockXSize - 1) / nDstBlockXSize;
+        CPLJobQueue* poJobQueue = nullptr;
+        int nThreads = GDALGetNumThreads();
+        if( nThreads > 1 && nBufYSize >= 2 * GDAL_RIO_RESAMPLED_MIN_ROWS )
+        {
+            const int nYChunksWanted = (nThreads + nXChunks - 1) / nXChunks;
+            nDstBlockYSize = std::min(
+                nDstBlockYSize,
+                std::max(GDAL_RIO_RESAMPLED_MIN_ROWS,
+                         (nBufYSize + nYChunksWanted - 1) / nYChunksWanted));
+            nFullResYChunk =
+                3 + static_cast<int>(nDstBlockYSize * dfYRatioDstToSrc);
+            if( nFullResYChunk > nRasterYSize )
+                nFullResYChunk = nRasterYSize;
+        }
+        const int nTotalBlocks =
+            nXChunks * ((nBufYSize + nDstBlockYSize - 1) / nDstBlockYSize);
+        nThreads = std::min(nThreads, nTotalBlocks);
+        CPLWorkerThreadPool* poThreadPool = GDALGetGlobalThreadPool(nThreads);
+        if( poThreadPool != nullptr )
+        {
+            poJobQueue = new (std::nothrow) CPLJobQueue(poThreadPool);
+            if( poJobQueue != nullptr )
+            {
+                CPLDebug( "GDAL", "RasterIOResampled(): using %d threads",
+                          nThreads );
+            }
+        }
+
         int nOvrXFactor = static_cast<int>(0.5 + dfXRatioDstToSrc);
         int nOvrYFactor = static_cast<int>(0.5 + dfYRatioDstToSrc);
         if( nOvrXFactor == 0 ) nOvrXFactor = 1;
@@ -1069,32 +1406,73 @@ CPLErr GDALRasterBand::RasterIOResampled(
         if( nFullResYSizeQueried > nRasterYSize )
             nFullResYSizeQueried = nRasterYSize;
 
-        void * pChunk =
-            VSI_MALLOC3_VERBOSE( GDALGetDataTypeSizeBytes(eWrkDataType),
-                                 nFullResXSizeQueried, nFullResYSizeQueried );
-        GByte * pabyChunkNoDataMask = nullptr;
-
         GDALRasterBand* poMaskBand = GetMaskBand();
         int l_nMaskFlags = GetMaskFlags();
 
         bool bUseNoDataMask = ((l_nMaskFlags & GMF_ALL_VALID) == 0);
-        if (bUseNoDataMask)
-        {
-            pabyChunkNoDataMask = static_cast<GByte *>(
-                VSI_MALLOC2_VERBOSE( nFullResXSizeQueried,
-                                     nFullResYSizeQueried ) );
-        }
-        if( pChunk == nullptr || (bUseNoDataMask && pabyChunkNoDataMask == nullptr) )
+
+        // Source buffers: one per job of the batch being resampled and of
+        // the batch being read in multi-threaded mode, otherwise just one.
+        const int nBatchSize = poJobQueue ? nThreads : 1;
+        const int nChunkBuffers = poJobQueue ? 2 * nBatchSize : 1;
+        const size_t nChunkPixels =
+            static_cast<size_t>(nFullResXSizeQueried) * nFullResYSizeQueried;
+        std::vector<void*> apChunks(nChunkBuffers);
+        std::vector<GByte*> apabyChunkNoDataMasks(nChunkBuffers);
+        for( int i = 0; i < nChunkBuffers; i++ )
         {
-            GDALClose(poMEMDS);
-            CPLFree(pChunk);
-            CPLFree(pabyChunkNoDataMask);
-            VSIFree(pTempBuffer);
-            return CE_Failure;
+            apChunks[i] = oBuffers.Get(
+                1 + 2 * i,
+                nChunkPixels * GDALGetDataTypeSizeBytes(eWrkDataType) );
+            apabyChunkNoDataMasks[i] = bUseNoDataMask ?
+                static_cast<GByte*>(oBuffers.Get(2 + 2 * i, nChunkPixels)) :
+                nullptr;
+            if( apChunks[i] == nullptr ||
+                (bUseNoDataMask && apabyChunkNoDataMasks[i] == nullptr) )
+            {
+                delete poJobQueue;
+                GDALClose(poMEMDS);
+                return CE_Failure;
+            }
         }
 
-        int nTotalBlocks = ((nBufXSize + nDstBlockXSize - 1) / nDstBlockXSize) *
-                           ((nBufYSize + nDstBlockYSize - 1) / nDstBlockYSize);
+        GDALRIOResampleJob sJobTemplate;
+        sJobTemplate.pfnResampleFunc = pfnResampleFunc;
+        sJobTemplate.dfXRatioDstToSrc = dfXRatioDstToSrc;
+        sJobTemplate.dfYRatioDstToSrc = dfYRatioDstToSrc;
+        sJobTemplate.dfSrcXDelta = dfXOff - nXOff; /* == 0 if bHasXOffVirtual */
+        sJobTemplate.dfSrcYDelta = dfYOff - nYOff; /* == 0 if bHasYOffVirtual */
+        sJobTemplate.eWrkDataType = eWrkDataType;
+        sJobTemplate.pChunk = nullptr;
+        sJobTemplate.pabyChunkNoDataMask = nullptr;
+        sJobTemplate.nChunkXOff = 0;
+        sJobTemplate.nChunkXSize = 0;
+        sJobTemplate.nChunkYOff = 0;
+        sJobTemplate.nChunkYSize = 0;
+        sJobTemplate.nDstXOff = 0;
+        sJobTemplate.nDstXOff2 = 0;
+        sJobTemplate.nDstYOff = 0;
+        sJobTemplate.nDstYOff2 = 0;
+        sJobTemplate.poMEMBand =
+            poJobQueue ? nullptr : GDALRasterBand::FromHandle(hMEMBand);
+        sJobTemplate.pabyMEMOrigin = pabyMEMOrigin;
+        sJobTemplate.nMEMXSize = nMEMXSize;
+        sJobTemplate.nMEMYSize = nMEMYSize;
+        sJobTemplate.eMEMDataType = eDTMem;
+        sJobTemplate.nMEMPixelSpace = nPSMem;
+        sJobTemplate.nMEMLineSpace = nLSMem;
+        sJobTemplate.pszNBITS = pszNBITS;
+        sJobTemplate.pszResampling = pszResampling;
+        sJobTemplate.bHasNoData = bHasNoData;
+        sJobTemplate.fNoDataValue = fNoDataValue;
+        sJobTemplate.poColorTable = GetColorTable();
+        sJobTemplate.eSrcDataType = eDataType;
+        sJobTemplate.eErr = CE_None;
+
+        // Jobs of the batch being resampled, and of the batch being read.
+        std::vector<GDALRIOResampleJob> aoJobs[2];
+        int iCurBatch = 0;
+
         int nBlocksDone = 0;
 
         int nDstYOff;
@@ -1162,6 +1540,12 @@ CPLErr GDALRasterBand::RasterIOResampled(
                     nChunkXSizeQueried = nRasterXSize - nChunkXOffQueried;
                 CPLAssert(nChunkXSizeQueried <= nFullResXSizeQueried);
 
+                const int iBuffer = poJobQueue ?
+                    iCurBatch * nBatchSize +
+                        static_cast<int>(aoJobs[iCurBatch].size()) : 0;
+                void* pChunk = apChunks[iBuffer];
+                GByte* pabyChunkNoDataMask = apabyChunkNoDataMasks[iBuffer];
+
                 // Read the source buffers.
                 eErr = RasterIO( GF_Read,
                                 nChunkXOffQueried, nChunkYOffQueried,
@@ -1197,14 +1581,17 @@ CPLErr GDALRasterBand::RasterIOResampled(
                     {
                         if( bVal == 0 )
                         {
+                            // Written in the buffer wrapped by the MEM
+                            // band, so that it is also right when it is
+                            // a temporary one.
                             for(int j=0;j<nDstYCount;j++)
                             {
                                 GDALCopyWords(
                                     &fNoDataValue, GDT_Float32, 0,
-                                    static_cast<GByte*>(pData) +
-                                    nLineSpace * (j + nDstYOff) +
-                                    nDstXOff * nPixelSpace,
-                                    eBufType, static_cast<int>(nPixelSpace),
+                                    pabyMEMOrigin +
+                                    nLSMem * (j + nDstYOff + nDestYOffVirtual) +
+                                    (nDstXOff + nDestXOffVirtual) * nPSMem,
+                                    eDTMem, static_cast<int>(nPSMem),
                                     nDstXCount);
                             }
                             bSkipResample = true;
@@ -1218,29 +1605,35 @@ CPLErr GDALRasterBand::RasterIOResampled(
 
                 if( !bSkipResample && eErr == CE_None )
                 {
-                    const bool bPropagateNoData = false;
-                    eErr = pfnResampleFunc(
-                        dfXRatioDstToSrc,
-                        dfYRatioDstToSrc,
-                        dfXOff - nXOff, /* == 0 if bHasXOffVirtual */
-                        dfYOff - nYOff, /* == 0 if bHasYOffVirtual */
-                        eWrkDataType,
-                        pChunk,
-                        bNoDataMaskFullyOpaque ? nullptr : pabyChunkNoDataMask,
-                        nChunkXOffQueried - (bHasXOffVirtual ? 0 : nXOff),
-                        nChunkXSizeQueried,
-                        nChunkYOffQueried - (bHasYOffVirtual ? 0 : nYOff),
-                        nChunkYSizeQueried,
-                        nDstXOff + nDestXOffVirtual,
-                        nDstXOff + nDestXOffVirtual + nDstXCount,
-                        nDstYOff + nDestYOffVirtual,
-                        nDstYOff + nDestYOffVirtual + nDstYCount,
-                        GDALRasterBand::FromHandle(hMEMBand),
-                        pszResampling,
-                        bHasNoData, fNoDataValue,
-                        GetColorTable(),
-                        eDataType,
-                        bPropagateNoData);
+                    GDALRIOResampleJob sJob(sJobTemplate);
+                    sJob.pChunk = pChunk;
+                    sJob.pabyChunkNoDataMask =
+                        bNoDataMaskFullyOpaque ? nullptr : pabyChunkNoDataMask;
+                    sJob.nChunkXOff =
+                        nChunkXOffQueried - (bHasXOffVirtual ? 0 : nXOff);
+                    sJob.nChunkXSize = nChunkXSizeQueried;
+                    sJob.nChunkYOff =
+                        nChunkYOffQueried - (bHasYOffVirtual ? 0 : nYOff);
+                    sJob.nChunkYSize = nChunkYSizeQueried;
+                    sJob.nDstXOff = nDstXOff + nDestXOffVirtual;
+                    sJob.nDstXOff2 = nDstXOff + nDestXOffVirtual + nDstXCount;
+                    sJob.nDstYOff = nDstYOff + nDestYOffVirtual;
+                    sJob.nDstYOff2 = nDstYOff + nDestYOffVirtual + nDstYCount;
+                    if( poJobQueue == nullptr )
+                    {
+                        GDALRIOResampleJobFunc(&sJob);
+                        eErr = sJob.eErr;
+                    }
+                    else
+                    {
+                        aoJobs[iCurBatch].push_back(sJob);
+                        if( static_cast<int>(aoJobs[iCurBatch].size()) ==
+                                                                nBatchSize )
+                        {
+                            eErr = GDALRIOResampledSubmitBatch(
+                                poJobQueue, aoJobs, iCurBatch );
+                        }
+                    }
                 }
 
                 nBlocksDone ++;
@@ -1254,8 +1647,24 @@ CPLErr GDALRasterBand::RasterIOResampled(
             }
         }
 
-        CPLFree(pChunk);
-        CPLFree(pabyChunkNoDataMask);
+        if( poJobQueue )
+        {
+            if( eErr == CE_None && !aoJobs[iCurBatch].empty() )
+            {
+                eErr = GDALRIOResampledSubmitBatch( poJobQueue, aoJobs,
+                                                    iCurBatch );
+            }
+            poJobQueue->WaitCompletion();
+            for( int i = 0; i < 2; i++ )
+            {
+                for( size_t j = 0; j < aoJobs[i].size(); j++ )
+                {
+                    if( eErr == CE_None )
+                        eErr = aoJobs[i][j].eErr;
+                }
+            }
+            delete poJobQueue;
+        }
     }
 
     if( eBufType != eDataType )
@@ -1270,7 +1679,6 @@ CPLErr GDALRasterBand::RasterIOResampled(
                           nullptr));
     }
     GDALClose(poMEMDS);
-    VSIFree(pTempBuffer);
 
     return eErr;
 }
@@ -1897,6 +2305,51 @@ void CPL_STDCALL GDALSwapWordsEx( void *pData, int nWordSize, size_t nWordCount,
     }
 }
 
+#if defined(HAVE_AVX2_AT_COMPILE_TIME) && (defined(__x86_64) || defined(_M_X64))
+
+// Implemented in rasterio_avx2.cpp. They only deal with packed buffers,
+// and return the number of words converted, the remaining ones being left
+// to the caller.
+
+int GDALCopyWordsFloat32ToByte_AVX2( const float* CPL_RESTRICT pSrc,
+                                     GByte* CPL_RESTRICT pDst,
+                                     int nWordCount );
+int GDALCopyWordsFloat32ToUInt16_AVX2( const float* CPL_RESTRICT pSrc,
+                                       GUInt16* CPL_RESTRICT pDst,
+                                       int nWordCount );
+int GDALCopyWordsFloat32ToInt16_AVX2( const float* CPL_RESTRICT pSrc,
+                                      GInt16* CPL_RESTRICT pDst,
+                                      int nWordCount );
+int GDALCopyWordsFloat32ToInt32_AVX2( const float* CPL_RESTRICT pSrc,
+                                      GInt32* CPL_RESTRICT pDst,
+                                      int nWordCount );
+int GDALCopyWordsFloat64ToByte_AVX2( const double* CPL_RESTRICT pSrc,
+                                     GByte* CPL_RESTRICT pDst,
+                                     int nWordCount );
+int GDALCopyWordsFloat64ToUInt16_AVX2( const double* CPL_RESTRICT pSrc,
+                                       GUInt16* CPL_RESTRICT pDst,
+                                       int nWordCount );
+int GDALCopyWordsFloat64ToInt16_AVX2( const double* CPL_RESTRICT pSrc,
+                                      GInt16* CPL_RESTRICT pDst,
+                                      int nWordCount );
+int GDALCopyWordsFloat64ToInt32_AVX2( const double* CPL_RESTRICT pSrc,
+                                      GInt32* CPL_RESTRICT pDst,
+                                      int nWordCount );
+int GDALCopyWordsByteToFloat32_AVX2( const GByte* CPL_RESTRICT pSrc,
+                                     float* CPL_RESTRICT pDst,
+                                     int nWordCount );
+int GDALCopyWordsUInt16ToFloat32_AVX2( const GUInt16* CPL_RESTRICT pSrc,
+                                       float* CPL_RESTRICT pDst,
+                                       int nWordCount );
+int GDALCopyWordsInt16ToFloat32_AVX2( const GInt16* CPL_RESTRICT pSrc,
+                                      float* CPL_RESTRICT pDst,
+                                      int nWordCount );
+
+// Below that number of words, do not bother checking for AVX2.
+static const int GDAL_COPY_WORDS_AVX2_MIN = 64;
+
+#endif // defined(HAVE_AVX2_AT_COMPILE_TIME)
+
 // Place the new GDALCopyWords helpers in an anonymous namespace
 namespace {
 
@@ -2008,6 +2461,142 @@ static void inline GDALCopyWordsT_8atatime( const Tin* const CPL_RESTRICT pSrcDa
 
 #include <emmintrin.h>
 
+/************************************************************************/
+/*                      GDALCopyWordsByChunksT()                        */
+/************************************************************************/
+
+// Used for strided (e.g. pixel interleaved) buffers, for conversions whose
+// packed code path is much faster than the per-word GDALCopyWord(): words
+// are gathered into a small packed buffer, converted with the packed code
+// path, and scattered back.
+template <class Tin, class Tout>
+static void GDALCopyWordsByChunksT( const Tin* const CPL_RESTRICT pSrcData,
+                                    int nSrcPixelStride,
+                                    Tout* const CPL_RESTRICT pDstData,
+                                    int nDstPixelStride,
+                                    int nWordCount )
+{
+    const int CHUNK_SIZE = 256;
+    if( nWordCount < 16 )
+    {
+        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+                              pDstData, nDstPixelStride,
+                              nWordCount);
+        return;
+    }
+
+    Tin atIn[CHUNK_SIZE];
+    Tout atOut[CHUNK_SIZE];
+    const bool bPackedSrc = nSrcPixelStride == static_cast<int>(sizeof(Tin));
+    const bool bPackedDst = nDstPixelStride == static_cast<int>(sizeof(Tout));
+    const char* const pSrcDataPtr = reinterpret_cast<const char*>(pSrcData);
+    char* const pDstDataPtr = reinterpret_cast<char*>(pDstData);
+    for( int nStart = 0; nStart < nWordCount; nStart += CHUNK_SIZE )
+    {
+        const int nCount = std::min(CHUNK_SIZE, nWordCount - nStart);
+        const Tin* pIn = atIn;
+        if( bPackedSrc )
+        {
+            pIn = pSrcData + nStart;
+        }
+        else
+        {
+            const char* pSrc = pSrcDataPtr +
+                static_cast<std::ptrdiff_t>(nStart) * nSrcPixelStride;
+            for( int i = 0; i < nCount; i++, pSrc += nSrcPixelStride )
+                atIn[i] = *reinterpret_cast<const Tin*>(pSrc);
+        }
+        Tout* pOut = bPackedDst ? pDstData + nStart : atOut;
+
+        GDALCopyWordsT(pIn, static_cast<int>(sizeof(Tin)),
+                       pOut, static_cast<int>(sizeof(Tout)), nCount);
+
+        if( !bPackedDst )
+        {
+            char* pDst = pDstDataPtr +
+                static_cast<std::ptrdiff_t>(nStart) * nDstPixelStride;
+            for( int i = 0; i < nCount; i++, pDst += nDstPixelStride )
+                *reinterpret_cast<Tout*>(pDst) = atOut[i];
+        }
+    }
+}
+
+/************************************************************************/
+/*                         SSE2 helpers                                 */
+/************************************************************************/
+
+// Sign extension of the 4 lower/upper int16 of xmm to int32
+static inline __m128i GDALUnpackLoInt16ToInt32( const __m128i xmm )
+{
+    return _mm_srai_epi32(_mm_unpacklo_epi16(xmm, xmm), 16);
+}
+
+static inline __m128i GDALUnpackHiInt16ToInt32( const __m128i xmm )
+{
+    return _mm_srai_epi32(_mm_unpackhi_epi16(xmm, xmm), 16);
+}
+
+// Unsigned minimum of 4 uint32, with xmm_max <= INT_MAX. SSE2 has no
+// min_epu32 (nor min_epi32), so flip the sign bit to use a signed compare.
+static inline __m128i GDALMinUInt32( const __m128i xmm, const __m128i xmm_max )
+{
+    const __m128i xmm_sign = _mm_set1_epi32(INT_MIN);
+    const __m128i mask = _mm_cmpgt_epi32(_mm_xor_si128(xmm, xmm_sign),
+                                         _mm_xor_si128(xmm_max, xmm_sign));
+    return _mm_or_si128(_mm_and_si128(mask, xmm_max),
+                        _mm_andnot_si128(mask, xmm));
+}
+
+// Pack 2x4 int32 in [0,65535] range to 8 uint16. _mm_packus_epi32 is SSE4.1
+// only, so translate to the int16 range, pack, and translate back.
+static inline __m128i GDALPackUInt16( const __m128i xmm0, const __m128i xmm1 )
+{
+    const __m128i xmm_m32768_32 = _mm_set1_epi32(-32768);
+    const __m128i xmm_m32768_16 = _mm_set1_epi16(-32768);
+    return _mm_add_epi16(
+        _mm_packs_epi32(_mm_add_epi32(xmm0, xmm_m32768_32),
+                        _mm_add_epi32(xmm1, xmm_m32768_32)),
+        xmm_m32768_16);
+}
+
+// Same as GDALCopyWord(double, Tout&) for unsigned Tout, on 4 doubles:
+// (d + 0.5) clamped to [0, dfMax] and truncated. NaN ends up as 0.5, hence 0.
+static inline __m128i GDALRoundUnsignedPD( const double* pSrc,
+                                           const __m128d xmm_max )
+{
+    const __m128d p0d5 = _mm_set1_pd(0.5);
+    __m128d xmm0 = _mm_add_pd(_mm_loadu_pd(pSrc), p0d5);
+    __m128d xmm1 = _mm_add_pd(_mm_loadu_pd(pSrc + 2), p0d5);
+    xmm0 = _mm_min_pd(_mm_max_pd(xmm0, p0d5), xmm_max);
+    xmm1 = _mm_min_pd(_mm_max_pd(xmm1, p0d5), xmm_max);
+    return _mm_unpacklo_epi64(_mm_cvttpd_epi32(xmm0), _mm_cvttpd_epi32(xmm1));
+}
+
+// Same as GDALCopyWord(double, short&) and GDALCopyWord(double, int&), on
+// 4 doubles: NaN is 0, otherwise round half away from zero and clamp.
+static inline __m128d GDALRoundSignedPD2( __m128d xmm, const __m128d xmm_min,
+                                          const __m128d xmm_max )
+{
+    const __m128d p0d5 = _mm_set1_pd(0.5);
+    const __m128d m0d5 = _mm_set1_pd(-0.5);
+    xmm = _mm_and_pd(xmm, _mm_cmpord_pd(xmm, xmm));
+    const __m128d mask = _mm_cmpge_pd(xmm, _mm_setzero_pd());
+    xmm = _mm_add_pd(xmm, _mm_or_pd(_mm_and_pd(mask, p0d5),
+                                    _mm_andnot_pd(mask, m0d5)));
+    return _mm_min_pd(_mm_max_pd(xmm, xmm_min), xmm_max);
+}
+
+static inline __m128i GDALRoundSignedPD( const double* pSrc,
+                                         const __m128d xmm_min,
+                                         const __m128d xmm_max )
+{
+    const __m128d xmm0 =
+        GDALRoundSignedPD2(_mm_loadu_pd(pSrc), xmm_min, xmm_max);
+    const __m128d xmm1 =
+        GDALRoundSignedPD2(_mm_loadu_pd(pSrc + 2), xmm_min, xmm_max);
+    return _mm_unpacklo_epi64(_mm_cvttpd_epi32(xmm0), _mm_cvttpd_epi32(xmm1));
+}
+
 template<class Tout> void GDALCopyWordsByteTo16Bit(
                                 const GByte* const CPL_RESTRICT pSrcData,
                                 int nSrcPixelStride,
@@ -2140,6 +2729,11 @@ template<> void GDALCopyWordsT( const GByte* const CPL_RESTRICT pSrcData,
         nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
     {
         int n = 0;
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+        if( nWordCount >= GDAL_COPY_WORDS_AVX2_MIN && CPLHaveRuntimeAVX2() )
+            n = GDALCopyWordsByteToFloat32_AVX2(pSrcData, pDstData,
+                                                nWordCount);
+#endif
         const __m128i xmm_zero = _mm_setzero_si128 ();
         GByte* CPL_RESTRICT pabyDstDataPtr = reinterpret_cast<GByte*>(pDstData);
         for (; n < nWordCount-15; n+=16)
@@ -2244,7 +2838,850 @@ template<> void GDALCopyWordsT( const GByte* const CPL_RESTRICT pSrcData,
     }
 }
 
-template<> void GDALCopyWordsT( const GUInt16* const CPL_RESTRICT pSrcData,
+template<> void GDALCopyWordsT( const GUInt16* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                GByte* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                int nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        int n = 0;
+        // In SSE2, min_epu16 does not exist, so shift from
+        // UInt16 to SInt16 to be able to use min_epi16
+        const __m128i xmm_UINT16_to_INT16 = _mm_set1_epi16 (-32768);
+        const __m128i xmm_m255_shifted = _mm_set1_epi16 (255-32768);
+        for (; n < nWordCount-7; n+=8)
+        {
+            __m128i xmm = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n) );
+            xmm = _mm_add_epi16(xmm, xmm_UINT16_to_INT16);
+            xmm = _mm_min_epi16(xmm, xmm_m255_shifted);
+            xmm = _mm_sub_epi16(xmm, xmm_UINT16_to_INT16);
+            xmm = _mm_packus_epi16(xmm, xmm);
+            GDALCopyXMMToInt64(xmm, reinterpret_cast<GInt64*>(pDstData + n));
+        }
+        for( ; n < nWordCount; n++  )
+        {
+            pDstData[n] =
+                pSrcData[n] >= 255 ? 255 : static_cast<GByte>(pSrcData[n]);
+        }
+    }
+    else
+    {
+        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+                              pDstData, nDstPixelStride,
+                              nWordCount);
+    }
+}
+
+template<> void GDALCopyWordsT( const GUInt16* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                GInt16* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                int nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        int n = 0;
+        // In SSE2, min_epu16 does not exist, so shift from
+        // UInt16 to SInt16 to be able to use min_epi16
+        const __m128i xmm_UINT16_to_INT16 = _mm_set1_epi16 (-32768);
+        const __m128i xmm_32767_shifted = _mm_set1_epi16 (32767-32768);
+        for (; n < nWordCount-7; n+=8)
+        {
+            __m128i xmm = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n) );
+            xmm = _mm_add_epi16(xmm, xmm_UINT16_to_INT16);
+            xmm = _mm_min_epi16(xmm, xmm_32767_shifted);
+            xmm = _mm_sub_epi16(xmm, xmm_UINT16_to_INT16);
+            _mm_storeu_si128( reinterpret_cast<__m128i*>(pDstData + n),
+                              xmm );
+        }
+        for( ; n < nWordCount; n++  )
+        {
+            pDstData[n] =
+                pSrcData[n] >= 32767 ? 32767 : static_cast<GInt16>(pSrcData[n]);
+        }
+    }
+    else
+    {
+        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+                              pDstData, nDstPixelStride,
+                              nWordCount);
+    }
+}
+
+template<> void GDALCopyWordsT( const GUInt16* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                float* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                int nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        int n = 0;
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+        if( nWordCount >= GDAL_COPY_WORDS_AVX2_MIN && CPLHaveRuntimeAVX2() )
+            n = GDALCopyWordsUInt16ToFloat32_AVX2(pSrcData, pDstData,
+                                                  nWordCount);
+#endif
+        const __m128i xmm_zero = _mm_setzero_si128 ();
+        GByte* CPL_RESTRICT pabyDstDataPtr = reinterpret_cast<GByte*>(pDstData);
+        for (; n < nWordCount-7; n+=8)
+        {
+            __m128i xmm = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n) );
+            __m128i xmm0 = _mm_unpacklo_epi16(xmm, xmm_zero);
+            __m128i xmm1 = _mm_unpackhi_epi16(xmm, xmm_zero);
+            __m128 xmm0_f = _mm_cvtepi32_ps(xmm0);
+            __m128 xmm1_f = _mm_cvtepi32_ps(xmm1);
+            _mm_storeu_ps( reinterpret_cast<float*>(pabyDstDataPtr + n * 4),
+                           xmm0_f );
+            _mm_storeu_ps( reinterpret_cast<float*>(pabyDstDataPtr + n * 4 + 16),
+                           xmm1_f );
+        }
+        for( ; n < nWordCount; n++  )
+        {
+            pDstData[n] = pSrcData[n];
+        }
+    }
+    else
+    {
+        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+                              pDstData, nDstPixelStride,
+                              nWordCount);
+    }
+}
+
+template<> void GDALCopyWordsT( const GUInt16* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                double* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                int nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        int n = 0;
+        const __m128i xmm_zero = _mm_setzero_si128 ();
+        GByte* CPL_RESTRICT pabyDstDataPtr = reinterpret_cast<GByte*>(pDstData);
+        for (; n < nWordCount-7; n+=8)
+        {
+            __m128i xmm = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n) );
+            __m128i xmm0 = _mm_unpacklo_epi16(xmm, xmm_zero);
+            __m128i xmm1 = _mm_unpackhi_epi16(xmm, xmm_zero);
+
+            __m128d xmm0_low_d = _mm_cvtepi32_pd(xmm0);
+            __m128d xmm1_low_d = _mm_cvtepi32_pd(xmm1);
+            xmm0 = _mm_srli_si128(xmm0, 8);
+            xmm1 = _mm_srli_si128(xmm1, 8);
+            __m128d xmm0_high_d = _mm_cvtepi32_pd(xmm0);
+            __m128d xmm1_high_d = _mm_cvtepi32_pd(xmm1);
+
+            _mm_storeu_pd( reinterpret_cast<double*>(pabyDstDataPtr + n * 8),
+                           xmm0_low_d );
+            _mm_storeu_pd( reinterpret_cast<double*>(pabyDstDataPtr + n * 8 + 16),
+                           xmm0_high_d );
+            _mm_storeu_pd( reinterpret_cast<double*>(pabyDstDataPtr + n * 8 + 32),
+                           xmm1_low_d );
+            _mm_storeu_pd( reinterpret_cast<double*>(pabyDstDataPtr + n * 8 + 48),
+                           xmm1_high_d );
+        }
+        for( ; n < nWordCount; n++  )
+        {
+            pDstData[n] = pSrcData[n];
+        }
+    }
+    else
+    {
+        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+                              pDstData, nDstPixelStride,
+                              nWordCount);
+    }
+}
+
+template<> void GDALCopyWordsT( const GInt16* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                GByte* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                int nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        int n = 0;
+        for (; n < nWordCount-15; n+=16)
+        {
+            __m128i xmm0 = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n) );
+            __m128i xmm1 = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n + 8) );
+            // The saturating pack does the clamping to [0,255]
+            xmm0 = _mm_packus_epi16(xmm0, xmm1);
+            _mm_storeu_si128( reinterpret_cast<__m128i*>(pDstData + n),
+                              xmm0 );
+        }
+        for( ; n < nWordCount; n++  )
+        {
+            GDALCopyWord(pSrcData[n], pDstData[n]);
+        }
+    }
+    else
+    {
+        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+                              pDstData, nDstPixelStride,
+                              nWordCount);
+    }
+}
+
+template<> void GDALCopyWordsT( const GInt16* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                GUInt16* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                int nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        int n = 0;
+        const __m128i xmm_zero = _mm_setzero_si128 ();
+        for (; n < nWordCount-7; n+=8)
+        {
+            __m128i xmm = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n) );
+            xmm = _mm_max_epi16(xmm, xmm_zero);
+            _mm_storeu_si128( reinterpret_cast<__m128i*>(pDstData + n),
+                              xmm );
+        }
+        for( ; n < nWordCount; n++  )
+        {
+            GDALCopyWord(pSrcData[n], pDstData[n]);
+        }
+    }
+    else
+    {
+        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+                              pDstData, nDstPixelStride,
+                              nWordCount);
+    }
+}
+
+template<class Tout> void GDALCopyWordsInt16To32Bit(
+                                const GInt16* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                Tout* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                int nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        int n = 0;
+        const __m128i xmm_zero = _mm_setzero_si128 ();
+        for (; n < nWordCount-7; n+=8)
+        {
+            __m128i xmm = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n) );
+            // Negative values are clamped to 0 for UInt32
+            if( !std::numeric_limits<Tout>::is_signed )
+                xmm = _mm_max_epi16(xmm, xmm_zero);
+            _mm_storeu_si128( reinterpret_cast<__m128i*>(pDstData + n),
+                              GDALUnpackLoInt16ToInt32(xmm) );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>(pDstData + n + 4),
+                              GDALUnpackHiInt16ToInt32(xmm) );
+        }
+        for( ; n < nWordCount; n++  )
+        {
+            GDALCopyWord(pSrcData[n], pDstData[n]);
+        }
+    }
+    else
+    {
+        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+                              pDstData, nDstPixelStride,
+                              nWordCount);
+    }
+}
+
+template<> void GDALCopyWordsT( const GInt16* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                GUInt32* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                int nWordCount )
+{
+    GDALCopyWordsInt16To32Bit(pSrcData, nSrcPixelStride, pDstData,
+                              nDstPixelStride, nWordCount);
+}
+
+template<> void GDALCopyWordsT( const GInt16* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                GInt32* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                int nWordCount )
+{
+    GDALCopyWordsInt16To32Bit(pSrcData, nSrcPixelStride, pDstData,
+                              nDstPixelStride, nWordCount);
+}
+
+template<> void GDALCopyWordsT( const GInt16* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                float* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                int nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        int n = 0;
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+        if( nWordCount >= GDAL_COPY_WORDS_AVX2_MIN && CPLHaveRuntimeAVX2() )
+            n = GDALCopyWordsInt16ToFloat32_AVX2(pSrcData, pDstData,
+                                                 nWordCount);
+#endif
+        for (; n < nWordCount-7; n+=8)
+        {
+            __m128i xmm = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n) );
+            _mm_storeu_ps( pDstData + n,
+                           _mm_cvtepi32_ps(GDALUnpackLoInt16ToInt32(xmm)) );
+            _mm_storeu_ps( pDstData + n + 4,
+                           _mm_cvtepi32_ps(GDALUnpackHiInt16ToInt32(xmm)) );
+        }
+        for( ; n < nWordCount; n++  )
+        {
+            pDstData[n] = pSrcData[n];
+        }
+    }
+    else
+    {
+        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+                              pDstData, nDstPixelStride,
+                              nWordCount);
+    }
+}
+
+template<> void GDALCopyWordsT( const GInt16* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                double* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                int nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        int n = 0;
+        for (; n < nWordCount-7; n+=8)
+        {
+            __m128i xmm = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n) );
+            __m128i xmm0 = GDALUnpackLoInt16ToInt32(xmm);
+            __m128i xmm1 = GDALUnpackHiInt16ToInt32(xmm);
+            _mm_storeu_pd( pDstData + n, _mm_cvtepi32_pd(xmm0) );
+            _mm_storeu_pd( pDstData + n + 2,
+                           _mm_cvtepi32_pd(_mm_srli_si128(xmm0, 8)) );
+            _mm_storeu_pd( pDstData + n + 4, _mm_cvtepi32_pd(xmm1) );
+            _mm_storeu_pd( pDstData + n + 6,
+                           _mm_cvtepi32_pd(_mm_srli_si128(xmm1, 8)) );
+        }
+        for( ; n < nWordCount; n++  )
+        {
+            pDstData[n] = pSrcData[n];
+        }
+    }
+    else
+    {
+        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+                              pDstData, nDstPixelStride,
+                              nWordCount);
+    }
+}
+
+template<class Tout> void GDALCopyWordsUInt16To32Bit(
+                                const GUInt16* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                Tout* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                int nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        int n = 0;
+        const __m128i xmm_zero = _mm_setzero_si128 ();
+        for (; n < nWordCount-7; n+=8)
+        {
+            __m128i xmm = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n) );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>(pDstData + n),
+                              _mm_unpacklo_epi16(xmm, xmm_zero) );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>(pDstData + n + 4),
+                              _mm_unpackhi_epi16(xmm, xmm_zero) );
+        }
+        for( ; n < nWordCount; n++  )
+        {
+            pDstData[n] = pSrcData[n];
+        }
+    }
+    else
+    {
+        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+                              pDstData, nDstPixelStride,
+                              nWordCount);
+    }
+}
+
+template<> void GDALCopyWordsT( const GUInt16* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                GUInt32* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                int nWordCount )
+{
+    GDALCopyWordsUInt16To32Bit(pSrcData, nSrcPixelStride, pDstData,
+                               nDstPixelStride, nWordCount);
+}
+
+template<> void GDALCopyWordsT( const GUInt16* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                GInt32* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                int nWordCount )
+{
+    GDALCopyWordsUInt16To32Bit(pSrcData, nSrcPixelStride, pDstData,
+                               nDstPixelStride, nWordCount);
+}
+
+template<> void GDALCopyWordsT( const GInt32* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                GByte* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                int nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        int n = 0;
+        for (; n < nWordCount-15; n+=16)
+        {
+            __m128i xmm0 = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n) );
+            __m128i xmm1 = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n + 4) );
+            __m128i xmm2 = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n + 8) );
+            __m128i xmm3 = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n + 12) );
+            // Saturating packs: int32 -> int16 -> uint8 clamps to [0,255]
+            xmm0 = _mm_packs_epi32(xmm0, xmm1);
+            xmm2 = _mm_packs_epi32(xmm2, xmm3);
+            xmm0 = _mm_packus_epi16(xmm0, xmm2);
+            _mm_storeu_si128( reinterpret_cast<__m128i*>(pDstData + n),
+                              xmm0 );
+        }
+        for( ; n < nWordCount; n++  )
+        {
+            GDALCopyWord(pSrcData[n], pDstData[n]);
+        }
+    }
+    else
+    {
+        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+                              pDstData, nDstPixelStride,
+                              nWordCount);
+    }
+}
+
+template<> void GDALCopyWordsT( const GInt32* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                GInt16* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                int nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        int n = 0;
+        for (; n < nWordCount-7; n+=8)
+        {
+            __m128i xmm0 = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n) );
+            __m128i xmm1 = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n + 4) );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>(pDstData + n),
+                              _mm_packs_epi32(xmm0, xmm1) );
+        }
+        for( ; n < nWordCount; n++  )
+        {
+            GDALCopyWord(pSrcData[n], pDstData[n]);
+        }
+    }
+    else
+    {
+        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+                              pDstData, nDstPixelStride,
+                              nWordCount);
+    }
+}
+
+template<> void GDALCopyWordsT( const GInt32* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                GUInt16* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                int nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        int n = 0;
+        const __m128i xmm_zero = _mm_setzero_si128 ();
+        const __m128i xmm_max = _mm_set1_epi32(65535);
+        for (; n < nWordCount-7; n+=8)
+        {
+            __m128i xmm0 = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n) );
+            __m128i xmm1 = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n + 4) );
+            // Negative values to 0, then values above 65535 to 65535
+            xmm0 = _mm_and_si128(xmm0, _mm_cmpgt_epi32(xmm0, xmm_zero));
+            xmm1 = _mm_and_si128(xmm1, _mm_cmpgt_epi32(xmm1, xmm_zero));
+            xmm0 = GDALMinUInt32(xmm0, xmm_max);
+            xmm1 = GDALMinUInt32(xmm1, xmm_max);
+            _mm_storeu_si128( reinterpret_cast<__m128i*>(pDstData + n),
+                              GDALPackUInt16(xmm0, xmm1) );
+        }
+        for( ; n < nWordCount; n++  )
+        {
+            GDALCopyWord(pSrcData[n], pDstData[n]);
+        }
+    }
+    else
+    {
+        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+                              pDstData, nDstPixelStride,
+                              nWordCount);
+    }
+}
+
+template<> void GDALCopyWordsT( const GInt32* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                GUInt32* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                int nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        int n = 0;
+        const __m128i xmm_zero = _mm_setzero_si128 ();
+        for (; n < nWordCount-3; n+=4)
+        {
+            __m128i xmm = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n) );
+            xmm = _mm_and_si128(xmm, _mm_cmpgt_epi32(xmm, xmm_zero));
+            _mm_storeu_si128( reinterpret_cast<__m128i*>(pDstData + n),
+                              xmm );
+        }
+        for( ; n < nWordCount; n++  )
+        {
+            GDALCopyWord(pSrcData[n], pDstData[n]);
+        }
+    }
+    else
+    {
+        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+                              pDstData, nDstPixelStride,
+                              nWordCount);
+    }
+}
+
+template<> void GDALCopyWordsT( const GInt32* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                float* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                int nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        int n = 0;
+        for (; n < nWordCount-7; n+=8)
+        {
+            __m128i xmm0 = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n) );
+            __m128i xmm1 = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n + 4) );
+            _mm_storeu_ps( pDstData + n, _mm_cvtepi32_ps(xmm0) );
+            _mm_storeu_ps( pDstData + n + 4, _mm_cvtepi32_ps(xmm1) );
+        }
+        for( ; n < nWordCount; n++  )
+        {
+            GDALCopyWord(pSrcData[n], pDstData[n]);
+        }
+    }
+    else
+    {
+        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+                              pDstData, nDstPixelStride,
+                              nWordCount);
+    }
+}
+
+template<> void GDALCopyWordsT( const GInt32* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                double* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                int nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        int n = 0;
+        for (; n < nWordCount-3; n+=4)
+        {
+            __m128i xmm = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n) );
+            _mm_storeu_pd( pDstData + n, _mm_cvtepi32_pd(xmm) );
+            _mm_storeu_pd( pDstData + n + 2,
+                           _mm_cvtepi32_pd(_mm_srli_si128(xmm, 8)) );
+        }
+        for( ; n < nWordCount; n++  )
+        {
+            pDstData[n] = pSrcData[n];
+        }
+    }
+    else
+    {
+        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+                              pDstData, nDstPixelStride,
+                              nWordCount);
+    }
+}
+
+template<> void GDALCopyWordsT( const GUInt32* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                GByte* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                int nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        int n = 0;
+        const __m128i xmm_max = _mm_set1_epi32(255);
+        for (; n < nWordCount-15; n+=16)
+        {
+            __m128i xmm0 = GDALMinUInt32(_mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n) ), xmm_max);
+            __m128i xmm1 = GDALMinUInt32(_mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n + 4) ), xmm_max);
+            __m128i xmm2 = GDALMinUInt32(_mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n + 8) ), xmm_max);
+            __m128i xmm3 = GDALMinUInt32(_mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n + 12) ), xmm_max);
+            xmm0 = _mm_packs_epi32(xmm0, xmm1);
+            xmm2 = _mm_packs_epi32(xmm2, xmm3);
+            xmm0 = _mm_packus_epi16(xmm0, xmm2);
+            _mm_storeu_si128( reinterpret_cast<__m128i*>(pDstData + n),
+                              xmm0 );
+        }
+        for( ; n < nWordCount; n++  )
+        {
+            GDALCopyWord(pSrcData[n], pDstData[n]);
+        }
+    }
+    else
+    {
+        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+                              pDstData, nDstPixelStride,
+                              nWordCount);
+    }
+}
+
+template<> void GDALCopyWordsT( const GUInt32* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                GUInt16* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                int nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        int n = 0;
+        const __m128i xmm_max = _mm_set1_epi32(65535);
+        for (; n < nWordCount-7; n+=8)
+        {
+            __m128i xmm0 = GDALMinUInt32(_mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n) ), xmm_max);
+            __m128i xmm1 = GDALMinUInt32(_mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n + 4) ), xmm_max);
+            _mm_storeu_si128( reinterpret_cast<__m128i*>(pDstData + n),
+                              GDALPackUInt16(xmm0, xmm1) );
+        }
+        for( ; n < nWordCount; n++  )
+        {
+            GDALCopyWord(pSrcData[n], pDstData[n]);
+        }
+    }
+    else
+    {
+        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+                              pDstData, nDstPixelStride,
+                              nWordCount);
+    }
+}
+
+template<> void GDALCopyWordsT( const GUInt32* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                GInt32* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                int nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        int n = 0;
+        const __m128i xmm_max = _mm_set1_epi32(INT_MAX);
+        for (; n < nWordCount-3; n+=4)
+        {
+            __m128i xmm = GDALMinUInt32(_mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n) ), xmm_max);
+            _mm_storeu_si128( reinterpret_cast<__m128i*>(pDstData + n),
+                              xmm );
+        }
+        for( ; n < nWordCount; n++  )
+        {
+            GDALCopyWord(pSrcData[n], pDstData[n]);
+        }
+    }
+    else
+    {
+        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+                              pDstData, nDstPixelStride,
+                              nWordCount);
+    }
+}
+
+template<> void GDALCopyWordsT( const GUInt32* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                double* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                int nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        int n = 0;
+        // Convert as int32 after flipping the sign bit, and add back 2^31
+        const __m128i xmm_sign = _mm_set1_epi32(INT_MIN);
+        const __m128d xmm_2pow31 = _mm_set1_pd(2147483648.0);
+        for (; n < nWordCount-3; n+=4)
+        {
+            __m128i xmm = _mm_xor_si128(_mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n) ), xmm_sign);
+            _mm_storeu_pd( pDstData + n,
+                           _mm_add_pd(_mm_cvtepi32_pd(xmm), xmm_2pow31) );
+            _mm_storeu_pd( pDstData + n + 2,
+                           _mm_add_pd(_mm_cvtepi32_pd(_mm_srli_si128(xmm, 8)),
+                                      xmm_2pow31) );
+        }
+        for( ; n < nWordCount; n++  )
+        {
+            pDstData[n] = pSrcData[n];
+        }
+    }
+    else
+    {
+        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+                              pDstData, nDstPixelStride,
+                              nWordCount);
+    }
+}
+
+template<> void GDALCopyWordsT( const float* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                GInt32* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                int nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        int n = 0;
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+        if( nWordCount >= GDAL_COPY_WORDS_AVX2_MIN && CPLHaveRuntimeAVX2() )
+            n = GDALCopyWordsFloat32ToInt32_AVX2(pSrcData, pDstData,
+                                                 nWordCount);
+#endif
+        // Mirrors GDALCopyWord(float, int&): values >= 2^31 saturate to
+        // INT_MAX, whereas values <= -2^31 (and NaN) get 0x80000000 from
+        // the conversion.
+        const __m128 xmm_zero = _mm_setzero_ps();
+        const __m128 p0d5 = _mm_set1_ps(0.5f);
+        const __m128 m0d5 = _mm_set1_ps(-0.5f);
+        const __m128 xmm_2pow31 = _mm_set1_ps(2147483648.0f);
+        const __m128i xmm_int_max = _mm_set1_epi32(INT_MAX);
+        for (; n < nWordCount-3; n+=4)
+        {
+            const __m128 xmm = _mm_loadu_ps(pSrcData + n);
+            const __m128 mask_pos = _mm_cmpgt_ps(xmm, xmm_zero);
+            const __m128i mask_max =
+                _mm_castps_si128(_mm_cmpge_ps(xmm, xmm_2pow31));
+            __m128i xmm_i = _mm_cvttps_epi32(_mm_add_ps(xmm,
+                _mm_or_ps(_mm_and_ps(mask_pos, p0d5),
+                          _mm_andnot_ps(mask_pos, m0d5))));
+            xmm_i = _mm_or_si128(_mm_and_si128(mask_max, xmm_int_max),
+                                 _mm_andnot_si128(mask_max, xmm_i));
+            _mm_storeu_si128( reinterpret_cast<__m128i*>(pDstData + n),
+                              xmm_i );
+        }
+        for( ; n < nWordCount; n++  )
+        {
+            GDALCopyWord(pSrcData[n], pDstData[n]);
+        }
+    }
+    else
+    {
+        GDALCopyWordsByChunksT(pSrcData, nSrcPixelStride,
+                               pDstData, nDstPixelStride,
+                               nWordCount);
+    }
+}
+
+template<> void GDALCopyWordsT( const float* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                double* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                int nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        int n = 0;
+        for (; n < nWordCount-3; n+=4)
+        {
+            const __m128 xmm = _mm_loadu_ps(pSrcData + n);
+            _mm_storeu_pd( pDstData + n, _mm_cvtps_pd(xmm) );
+            _mm_storeu_pd( pDstData + n + 2,
+                           _mm_cvtps_pd(_mm_movehl_ps(xmm, xmm)) );
+        }
+        for( ; n < nWordCount; n++  )
+        {
+            pDstData[n] = pSrcData[n];
+        }
+    }
+    else
+    {
+        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+                              pDstData, nDstPixelStride,
+                              nWordCount);
+    }
+}
+
+template<> void GDALCopyWordsT( const double* const CPL_RESTRICT pSrcData,
                                 int nSrcPixelStride,
                                 GByte* const CPL_RESTRICT pDstData,
                                 int nDstPixelStride,
@@ -2254,37 +3691,40 @@ template<> void GDALCopyWordsT( const GUInt16* const CPL_RESTRICT pSrcData,
         nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
     {
         int n = 0;
-        // In SSE2, min_epu16 does not exist, so shift from
-        // UInt16 to SInt16 to be able to use min_epi16
-        const __m128i xmm_UINT16_to_INT16 = _mm_set1_epi16 (-32768);
-        const __m128i xmm_m255_shifted = _mm_set1_epi16 (255-32768);
-        for (; n < nWordCount-7; n+=8)
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+        if( nWordCount >= GDAL_COPY_WORDS_AVX2_MIN && CPLHaveRuntimeAVX2() )
+            n = GDALCopyWordsFloat64ToByte_AVX2(pSrcData, pDstData,
+                                                nWordCount);
+#endif
+        const __m128d xmm_max = _mm_set1_pd(255.0);
+        for (; n < nWordCount-15; n+=16)
         {
-            __m128i xmm = _mm_loadu_si128(
-                reinterpret_cast<const __m128i*> (pSrcData + n) );
-            xmm = _mm_add_epi16(xmm, xmm_UINT16_to_INT16);
-            xmm = _mm_min_epi16(xmm, xmm_m255_shifted);
-            xmm = _mm_sub_epi16(xmm, xmm_UINT16_to_INT16);
-            xmm = _mm_packus_epi16(xmm, xmm);
-            GDALCopyXMMToInt64(xmm, reinterpret_cast<GInt64*>(pDstData + n));
+            __m128i xmm0 = GDALRoundUnsignedPD(pSrcData + n, xmm_max);
+            __m128i xmm1 = GDALRoundUnsignedPD(pSrcData + n + 4, xmm_max);
+            __m128i xmm2 = GDALRoundUnsignedPD(pSrcData + n + 8, xmm_max);
+            __m128i xmm3 = GDALRoundUnsignedPD(pSrcData + n + 12, xmm_max);
+            xmm0 = _mm_packs_epi32(xmm0, xmm1);
+            xmm2 = _mm_packs_epi32(xmm2, xmm3);
+            xmm0 = _mm_packus_epi16(xmm0, xmm2);
+            _mm_storeu_si128( reinterpret_cast<__m128i*>(pDstData + n),
+                              xmm0 );
         }
         for( ; n < nWordCount; n++  )
         {
-            pDstData[n] =
-                pSrcData[n] >= 255 ? 255 : static_cast<GByte>(pSrcData[n]);
+            GDALCopyWord(pSrcData[n], pDstData[n]);
         }
     }
     else
     {
-        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
-                              pDstData, nDstPixelStride,
-                              nWordCount);
+        GDALCopyWordsByChunksT(pSrcData, nSrcPixelStride,
+                               pDstData, nDstPixelStride,
+                               nWordCount);
     }
 }
 
-template<> void GDALCopyWordsT( const GUInt16* const CPL_RESTRICT pSrcData,
+template<> void GDALCopyWordsT( const double* const CPL_RESTRICT pSrcData,
                                 int nSrcPixelStride,
-                                GInt16* const CPL_RESTRICT pDstData,
+                                GUInt16* const CPL_RESTRICT pDstData,
                                 int nDstPixelStride,
                                 int nWordCount )
 {
@@ -2292,37 +3732,35 @@ template<> void GDALCopyWordsT( const GUInt16* const CPL_RESTRICT pSrcData,
         nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
     {
         int n = 0;
-        // In SSE2, min_epu16 does not exist, so shift from
-        // UInt16 to SInt16 to be able to use min_epi16
-        const __m128i xmm_UINT16_to_INT16 = _mm_set1_epi16 (-32768);
-        const __m128i xmm_32767_shifted = _mm_set1_epi16 (32767-32768);
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+        if( nWordCount >= GDAL_COPY_WORDS_AVX2_MIN && CPLHaveRuntimeAVX2() )
+            n = GDALCopyWordsFloat64ToUInt16_AVX2(pSrcData, pDstData,
+                                                  nWordCount);
+#endif
+        const __m128d xmm_max = _mm_set1_pd(65535.0);
         for (; n < nWordCount-7; n+=8)
         {
-            __m128i xmm = _mm_loadu_si128(
-                reinterpret_cast<const __m128i*> (pSrcData + n) );
-            xmm = _mm_add_epi16(xmm, xmm_UINT16_to_INT16);
-            xmm = _mm_min_epi16(xmm, xmm_32767_shifted);
-            xmm = _mm_sub_epi16(xmm, xmm_UINT16_to_INT16);
+            __m128i xmm0 = GDALRoundUnsignedPD(pSrcData + n, xmm_max);
+            __m128i xmm1 = GDALRoundUnsignedPD(pSrcData + n + 4, xmm_max);
             _mm_storeu_si128( reinterpret_cast<__m128i*>(pDstData + n),
-                              xmm );
+                              GDALPackUInt16(xmm0, xmm1) );
         }
         for( ; n < nWordCount; n++  )
         {
-            pDstData[n] =
-                pSrcData[n] >= 32767 ? 32767 : static_cast<GInt16>(pSrcData[n]);
+            GDALCopyWord(pSrcData[n], pDstData[n]);
         }
     }
     else
     {
-        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
-                              pDstData, nDstPixelStride,
-                              nWordCount);
+        GDALCopyWordsByChunksT(pSrcData, nSrcPixelStride,
+                               pDstData, nDstPixelStride,
+                               nWordCount);
     }
 }
 
-template<> void GDALCopyWordsT( const GUInt16* const CPL_RESTRICT pSrcData,
+template<> void GDALCopyWordsT( const double* const CPL_RESTRICT pSrcData,
                                 int nSrcPixelStride,
-                                float* const CPL_RESTRICT pDstData,
+                                GInt16* const CPL_RESTRICT pDstData,
                                 int nDstPixelStride,
                                 int nWordCount )
 {
@@ -2330,37 +3768,37 @@ template<> void GDALCopyWordsT( const GUInt16* const CPL_RESTRICT pSrcData,
         nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
     {
         int n = 0;
-        const __m128i xmm_zero = _mm_setzero_si128 ();
-        GByte* CPL_RESTRICT pabyDstDataPtr = reinterpret_cast<GByte*>(pDstData);
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+        if( nWordCount >= GDAL_COPY_WORDS_AVX2_MIN && CPLHaveRuntimeAVX2() )
+            n = GDALCopyWordsFloat64ToInt16_AVX2(pSrcData, pDstData,
+                                                 nWordCount);
+#endif
+        const __m128d xmm_min = _mm_set1_pd(-32768.0);
+        const __m128d xmm_max = _mm_set1_pd(32767.0);
         for (; n < nWordCount-7; n+=8)
         {
-            __m128i xmm = _mm_loadu_si128(
-                reinterpret_cast<const __m128i*> (pSrcData + n) );
-            __m128i xmm0 = _mm_unpacklo_epi16(xmm, xmm_zero);
-            __m128i xmm1 = _mm_unpackhi_epi16(xmm, xmm_zero);
-            __m128 xmm0_f = _mm_cvtepi32_ps(xmm0);
-            __m128 xmm1_f = _mm_cvtepi32_ps(xmm1);
-            _mm_storeu_ps( reinterpret_cast<float*>(pabyDstDataPtr + n * 4),
-                           xmm0_f );
-            _mm_storeu_ps( reinterpret_cast<float*>(pabyDstDataPtr + n * 4 + 16),
-                           xmm1_f );
+            __m128i xmm0 = GDALRoundSignedPD(pSrcData + n, xmm_min, xmm_max);
+            __m128i xmm1 = GDALRoundSignedPD(pSrcData + n + 4,
+                                             xmm_min, xmm_max);
+            _mm_storeu_si128( reinterpret_cast<__m128i*>(pDstData + n),
+                              _mm_packs_epi32(xmm0, xmm1) );
         }
         for( ; n < nWordCount; n++  )
         {
-            pDstData[n] = pSrcData[n];
+            GDALCopyWord(pSrcData[n], pDstData[n]);
         }
     }
     else
     {
-        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
-                              pDstData, nDstPixelStride,
-                              nWordCount);
+        GDALCopyWordsByChunksT(pSrcData, nSrcPixelStride,
+                               pDstData, nDstPixelStride,
+                               nWordCount);
     }
 }
 
-template<> void GDALCopyWordsT( const GUInt16* const CPL_RESTRICT pSrcData,
+template<> void GDALCopyWordsT( const double* const CPL_RESTRICT pSrcData,
                                 int nSrcPixelStride,
-                                double* const CPL_RESTRICT pDstData,
+                                GInt32* const CPL_RESTRICT pDstData,
                                 int nDstPixelStride,
                                 int nWordCount )
 {
@@ -2368,55 +3806,117 @@ template<> void GDALCopyWordsT( const GUInt16* const CPL_RESTRICT pSrcData,
         nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
     {
         int n = 0;
-        const __m128i xmm_zero = _mm_setzero_si128 ();
-        GByte* CPL_RESTRICT pabyDstDataPtr = reinterpret_cast<GByte*>(pDstData);
-        for (; n < nWordCount-7; n+=8)
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+        if( nWordCount >= GDAL_COPY_WORDS_AVX2_MIN && CPLHaveRuntimeAVX2() )
+            n = GDALCopyWordsFloat64ToInt32_AVX2(pSrcData, pDstData,
+                                                 nWordCount);
+#endif
+        const __m128d xmm_min = _mm_set1_pd(-2147483648.0);
+        const __m128d xmm_max = _mm_set1_pd(2147483647.0);
+        for (; n < nWordCount-3; n+=4)
         {
-            __m128i xmm = _mm_loadu_si128(
-                reinterpret_cast<const __m128i*> (pSrcData + n) );
-            __m128i xmm0 = _mm_unpacklo_epi16(xmm, xmm_zero);
-            __m128i xmm1 = _mm_unpackhi_epi16(xmm, xmm_zero);
-
-            __m128d xmm0_low_d = _mm_cvtepi32_pd(xmm0);
-            __m128d xmm1_low_d = _mm_cvtepi32_pd(xmm1);
-            xmm0 = _mm_srli_si128(xmm0, 8);
-            xmm1 = _mm_srli_si128(xmm1, 8);
-            __m128d xmm0_high_d = _mm_cvtepi32_pd(xmm0);
-            __m128d xmm1_high_d = _mm_cvtepi32_pd(xmm1);
-
-            _mm_storeu_pd( reinterpret_cast<double*>(pabyDstDataPtr + n * 8),
-                           xmm0_low_d );
-            _mm_storeu_pd( reinterpret_cast<double*>(pabyDstDataPtr + n * 8 + 16),
-                           xmm0_high_d );
-            _mm_storeu_pd( reinterpret_cast<double*>(pabyDstDataPtr + n * 8 + 32),
-                           xmm1_low_d );
-            _mm_storeu_pd( reinterpret_cast<double*>(pabyDstDataPtr + n * 8 + 48),
-                           xmm1_high_d );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>(pDstData + n),
+                              GDALRoundSignedPD(pSrcData + n,
+                                                xmm_min, xmm_max) );
         }
         for( ; n < nWordCount; n++  )
         {
-            pDstData[n] = pSrcData[n];
+            GDALCopyWord(pSrcData[n], pDstData[n]);
         }
     }
     else
     {
-        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
-                              pDstData, nDstPixelStride,
-                              nWordCount);
+        GDALCopyWordsByChunksT(pSrcData, nSrcPixelStride,
+                               pDstData, nDstPixelStride,
+                               nWordCount);
     }
 }
 
-template<> void GDALCopyWordsT( const double* const CPL_RESTRICT pSrcData,
+// The float to Byte/Int16/UInt16 conversions use GDALCopy8Words(), which is
+// SSE2 vectorized in gdal_priv_templates.hpp.
+
+template<> void GDALCopyWordsT( const float* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                GByte* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                int nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        int n = 0;
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+        if( nWordCount >= GDAL_COPY_WORDS_AVX2_MIN && CPLHaveRuntimeAVX2() )
+            n = GDALCopyWordsFloat32ToByte_AVX2(pSrcData, pDstData,
+                                                nWordCount);
+#endif
+        GDALCopyWordsT_8atatime( pSrcData + n, nSrcPixelStride,
+                                 pDstData + n, nDstPixelStride,
+                                 nWordCount - n );
+    }
+    else
+    {
+        GDALCopyWordsByChunksT(pSrcData, nSrcPixelStride,
+                               pDstData, nDstPixelStride,
+                               nWordCount);
+    }
+}
+
+template<> void GDALCopyWordsT( const float* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                GInt16* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                int nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        int n = 0;
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+        if( nWordCount >= GDAL_COPY_WORDS_AVX2_MIN && CPLHaveRuntimeAVX2() )
+            n = GDALCopyWordsFloat32ToInt16_AVX2(pSrcData, pDstData,
+                                                 nWordCount);
+#endif
+        GDALCopyWordsT_8atatime( pSrcData + n, nSrcPixelStride,
+                                 pDstData + n, nDstPixelStride,
+                                 nWordCount - n );
+    }
+    else
+    {
+        GDALCopyWordsByChunksT(pSrcData, nSrcPixelStride,
+                               pDstData, nDstPixelStride,
+                               nWordCount);
+    }
+}
+
+template<> void GDALCopyWordsT( const float* const CPL_RESTRICT pSrcData,
                                 int nSrcPixelStride,
                                 GUInt16* const CPL_RESTRICT pDstData,
                                 int nDstPixelStride,
                                 int nWordCount )
 {
-    GDALCopyWordsT_8atatime( pSrcData, nSrcPixelStride,
-                             pDstData, nDstPixelStride, nWordCount );
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        int n = 0;
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+        if( nWordCount >= GDAL_COPY_WORDS_AVX2_MIN && CPLHaveRuntimeAVX2() )
+            n = GDALCopyWordsFloat32ToUInt16_AVX2(pSrcData, pDstData,
+                                                  nWordCount);
+#endif
+        GDALCopyWordsT_8atatime( pSrcData + n, nSrcPixelStride,
+                                 pDstData + n, nDstPixelStride,
+                                 nWordCount - n );
+    }
+    else
+    {
+        GDALCopyWordsByChunksT(pSrcData, nSrcPixelStride,
+                               pDstData, nDstPixelStride,
+                               nWordCount);
+    }
 }
 
-#endif // defined(__x86_64) || defined(_M_X64)
+#else // defined(__x86_64) || defined(_M_X64)
 
 template<> void GDALCopyWordsT( const float* const CPL_RESTRICT pSrcData,
                                 int nSrcPixelStride,
@@ -2448,6 +3948,8 @@ template<> void GDALCopyWordsT( const float* const CPL_RESTRICT pSrcData,
                              pDstData, nDstPixelStride, nWordCount );
 }
 
+#endif // defined(__x86_64) || defined(_M_X64)
+
 /************************************************************************/
 /*                   GDALCopyWordsComplexT()                            */
 /************************************************************************/
@@ -4262,6 +5764,241 @@ static void GDALCopyWholeRasterGetSwathSize(
     *pnSwathLines = nSwathLines;
 }
 
+/************************************************************************/
+/*                    GDALCopyWholeRasterReadJob                        */
+/************************************************************************/
+
+namespace {
+
+struct GDALCopyWholeRasterError
+{
+    GDALCopyWholeRasterError( CPLErr eErrIn, CPLErrorNum nErrNoIn,
+                              const char* pszMsg ) :
+        eErr(eErrIn), nErrNo(nErrNoIn), osErrorMsg(pszMsg) {}
+
+    CPLErr      eErr;
+    CPLErrorNum nErrNo;
+    CPLString   osErrorMsg;
+};
+
+// Reading of a swath of the source dataset, run by a worker thread while
+// the previous swath is written to the destination dataset.
+struct GDALCopyWholeRasterReadJob
+{
+    GDALDataset   *poSrcDS;
+    int            nXOff;
+    int            nYOff;
+    int            nXSize;
+    int            nYSize;
+    GDALDataType   eDT;
+    int            nBandCount;
+    int           *panBandMap;   // nullptr for all bands.
+    bool           bCheckHoles;
+    void          *pSwathBuf;
+
+    // Set by the job.
+    bool           bHasData;
+    CPLErr         eErr;
+    std::vector<GDALCopyWholeRasterError> aoErrors;
+};
+
+} // namespace
+
+/************************************************************************/
+/*                   GDALCopyWholeRasterErrorHandler()                  */
+/************************************************************************/
+
+// Collect the errors emitted in the worker thread, so that they can be
+// re-emitted in the thread of the caller.
+static void CPL_STDCALL GDALCopyWholeRasterErrorHandler(
+    CPLErr eErr, CPLErrorNum nErrNo, const char* pszErrorMsg )
+{
+    std::vector<GDALCopyWholeRasterError>* paoErrors =
+        static_cast<std::vector<GDALCopyWholeRasterError> *>(
+            CPLGetErrorHandlerUserData());
+    if( paoErrors )
+        paoErrors->push_back(
+            GDALCopyWholeRasterError(eErr, nErrNo, pszErrorMsg));
+}
+
+/************************************************************************/
+/*                   GDALCopyWholeRasterReadJobFunc()                   */
+/************************************************************************/
+
+static void GDALCopyWholeRasterReadJobFunc( void* pData )
+{
+    GDALCopyWholeRasterReadJob* psJob =
+        static_cast<GDALCopyWholeRasterReadJob *>(pData);
+
+    CPLPushErrorHandlerEx(GDALCopyWholeRasterErrorHandler, &psJob->aoErrors);
+
+    psJob->bHasData = true;
+    if( psJob->bCheckHoles )
+    {
+        int nStatus = 0;
+        for( int iBand = 0; iBand < psJob->nBandCount; iBand++ )
+        {
+            const int nBand =
+                psJob->panBandMap ? psJob->panBandMap[iBand] : iBand + 1;
+            nStatus |= psJob->poSrcDS->GetRasterBand(nBand)->
+                GetDataCoverageStatus(psJob->nXOff, psJob->nYOff,
+                                      psJob->nXSize, psJob->nYSize,
+                                      GDAL_DATA_COVERAGE_STATUS_DATA);
+            if( nStatus & GDAL_DATA_COVERAGE_STATUS_DATA )
+                break;
+        }
+        psJob->bHasData = (nStatus & GDAL_DATA_COVERAGE_STATUS_DATA) != 0;
+    }
+
+    psJob->eErr = CE_None;
+    if( psJob->bHasData )
+    {
+        psJob->eErr = psJob->poSrcDS->RasterIO( GF_Read,
+                                                psJob->nXOff, psJob->nYOff,
+                                                psJob->nXSize, psJob->nYSize,
+                                                psJob->pSwathBuf,
+                                                psJob->nXSize, psJob->nYSize,
+                                                psJob->eDT, psJob->nBandCount,
+                                                psJob->panBandMap,
+                                                0, 0, 0, nullptr );
+    }
+
+    CPLPopErrorHandler();
+}
+
+/************************************************************************/
+/*                 GDALDatasetCopyWholeRasterPipelined()                */
+/************************************************************************/
+
+// Variant of GDALDatasetCopyWholeRaster() where the next swath is read from
+// the source dataset by a worker thread while the current one is written
+// to the destination dataset, so that decoding and datatype conversion of
+// the source overlap with the encoding of the destination.
+// Returns -1 if it could not be used, and then nothing has been done.
+
+static int GDALDatasetCopyWholeRasterPipelined(
+    GDALDataset* poSrcDS, GDALDataset* poDstDS,
+    GDALDataType eDT, bool bInterleave, bool bCheckHoles,
+    int nSwathCols, int nSwathLines, int nPixelSize,
+    GDALProgressFunc pfnProgress, void *pProgressData )
+{
+    const int nThreads = GDALGetNumThreads();
+    if( nThreads <= 1 || poSrcDS == poDstDS )
+        return -1;
+
+    const int nXSize = poDstDS->GetRasterXSize();
+    const int nYSize = poDstDS->GetRasterYSize();
+    const int nBandCount = poDstDS->GetRasterCount();
+
+    void *apSwathBuf[2] = { nullptr, nullptr };
+    apSwathBuf[0] = VSI_MALLOC3_VERBOSE(nSwathCols, nSwathLines, nPixelSize);
+    apSwathBuf[1] = VSI_MALLOC3_VERBOSE(nSwathCols, nSwathLines, nPixelSize);
+    CPLWorkerThreadPool* poThreadPool = GDALGetGlobalThreadPool(nThreads);
+    CPLJobQueue* poJobQueue = poThreadPool ?
+        new (std::nothrow) CPLJobQueue(poThreadPool) : nullptr;
+    if( apSwathBuf[0] == nullptr || apSwathBuf[1] == nullptr ||
+        poJobQueue == nullptr )
+    {
+        delete poJobQueue;
+        CPLFree(apSwathBuf[0]);
+        CPLFree(apSwathBuf[1]);
+        return -1;
+    }
+
+    CPLDebug( "GDAL",
+              "GDALDatasetCopyWholeRaster(): reading in a worker thread" );
+
+/* -------------------------------------------------------------------- */
+/*      Enumerate the swaths in the order of the serial implementation. */
+/* -------------------------------------------------------------------- */
+    std::vector<GDALCopyWholeRasterReadJob> aoJobs;
+    std::vector<int> anBands;
+    for( int iBand = 0; iBand < nBandCount; iBand++ )
+        anBands.push_back(iBand + 1);
+    const int nBandIter = bInterleave ? 1 : nBandCount;
+    for( int iBand = 0; iBand < nBandIter; iBand++ )
+    {
+        for( int iY = 0; iY < nYSize; iY += nSwathLines )
+        {
+            for( int iX = 0; iX < nXSize; iX += nSwathCols )
+            {
+                GDALCopyWholeRasterReadJob sJob;
+                sJob.poSrcDS = poSrcDS;
+                sJob.nXOff = iX;
+                sJob.nYOff = iY;
+                sJob.nXSize = std::min(nSwathCols, nXSize - iX);
+                sJob.nYSize = std::min(nSwathLines, nYSize - iY);
+                sJob.eDT = eDT;
+                sJob.nBandCount = bInterleave ? nBandCount : 1;
+                sJob.panBandMap = bInterleave ? nullptr : &anBands[iBand];
+                sJob.bCheckHoles = bCheckHoles;
+                sJob.pSwathBuf = nullptr;
+                sJob.bHasData = false;
+                sJob.eErr = CE_None;
+                aoJobs.push_back(sJob);
+            }
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Read swath i+1 while writing swath i.                           */
+/* -------------------------------------------------------------------- */
+    CPLErr eErr = CE_None;
+    const size_t nJobs = aoJobs.size();
+    aoJobs[0].pSwathBuf = apSwathBuf[0];
+    poJobQueue->SubmitJob(GDALCopyWholeRasterReadJobFunc, &aoJobs[0]);
+    for( size_t i = 0; i < nJobs; i++ )
+    {
+        poJobQueue->WaitCompletion();
+
+        GDALCopyWholeRasterReadJob& sJob = aoJobs[i];
+        for( size_t j = 0; j < sJob.aoErrors.size(); j++ )
+        {
+            CPLError( sJob.aoErrors[j].eErr, sJob.aoErrors[j].nErrNo,
+                      "%s", sJob.aoErrors[j].osErrorMsg.c_str() );
+        }
+        eErr = sJob.eErr;
+        if( eErr != CE_None )
+            break;
+
+        if( i + 1 < nJobs )
+        {
+            aoJobs[i + 1].pSwathBuf = apSwathBuf[(i + 1) % 2];
+            poJobQueue->SubmitJob(GDALCopyWholeRasterReadJobFunc,
+                                  &aoJobs[i + 1]);
+        }
+
+        if( sJob.bHasData )
+        {
+            eErr = poDstDS->RasterIO( GF_Write,
+                                      sJob.nXOff, sJob.nYOff,
+                                      sJob.nXSize, sJob.nYSize,
+                                      sJob.pSwathBuf,
+                                      sJob.nXSize, sJob.nYSize,
+                                      eDT, sJob.nBandCount, sJob.panBandMap,
+                                      0, 0, 0, nullptr );
+        }
+
+        if( eErr == CE_None &&
+            !pfnProgress( (i + 1) / static_cast<double>(nJobs),
+                          nullptr, pProgressData ) )
+        {
+            eErr = CE_Failure;
+            CPLError( CE_Failure, CPLE_UserInterrupt,
+                      "User terminated CreateCopy()" );
+        }
+        if( eErr != CE_None )
+            break;
+    }
+
+    // Wait for a pending read before releasing its buffer.
+    delete poJobQueue;
+    CPLFree(apSwathBuf[0]);
+    CPLFree(apSwathBuf[1]);
+
+    return eErr == CE_None;
+}
+
 /************************************************************************/
 /*                     GDALDatasetCopyWholeRaster()                     */
 /************************************************************************/
@@ -4289,6 +6026,12 @@ static void GDALCopyWholeRasterGetSwathSize(
  * </ul>
  * More options may be supported in the future.
  *
+ * Starting with GDAL 2.3, if the GDAL_NUM_THREADS configuration option is
+ * set to a value greater than 1 (or ALL_CPUS), the source dataset is read
+ * in a worker thread, one swath ahead of the writing of the destination
+ * dataset. In that mode, the progress function is only called from the
+ * calling thread, once per swath written.
+ *
  * @param hSrcDS the source dataset
  * @param hDstDS the destination dataset
  * @param papszOptions transfer hints in "StringList" Name=Value format.
@@ -4398,12 +6141,6 @@ CPLErr CPL_STDCALL GDALDatasetCopyWholeRaster(
     if( bInterleave)
         nPixelSize *= nBandCount;
 
-    void *pSwathBuf = VSI_MALLOC3_VERBOSE(nSwathCols, nSwathLines, nPixelSize );
-    if( pSwathBuf == nullptr )
-    {
-        return CE_Failure;
-    }
-
     CPLDebug( "GDAL",
               "GDALDatasetCopyWholeRaster(): %d*%d swaths, bInterleave=%d",
               nSwathCols, nSwathLines, static_cast<int>(bInterleave) );
@@ -4421,6 +6158,18 @@ CPLErr CPL_STDCALL GDALDatasetCopyWholeRaster(
     const bool bCheckHoles = CPLTestBool( CSLFetchNameValueDef(
                                         papszOptions, "SKIP_HOLES", "NO" ) );
 
+    const int nRet = GDALDatasetCopyWholeRasterPipelined(
+        poSrcDS, poDstDS, eDT, bInterleave, bCheckHoles,
+        nSwathCols, nSwathLines, nPixelSize, pfnProgress, pProgressData );
+    if( nRet >= 0 )
+        return nRet ? CE_None : CE_Failure;
+
+    void *pSwathBuf = VSI_MALLOC3_VERBOSE(nSwathCols, nSwathLines, nPixelSize );
+    if( pSwathBuf == nullptr )
+    {
+        return CE_Failure;
+    }
+
     if( !bInterleave )
     {
         GDALRasterIOExtraArg sExtraArg;
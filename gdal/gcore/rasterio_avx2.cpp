@@ -0,0 +1,414 @@
+/******************************************************************************
+ *
+ * Project:  GDAL Core
+ * Purpose:  AVX2 specializations of GDALCopyWords()
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cpl_port.h"
+
+CPL_CVSID("$Id$")
+
+#if defined(HAVE_AVX2_AT_COMPILE_TIME) && ( defined(__x86_64) || defined(_M_X64) )
+
+#include <immintrin.h>
+
+// This file is compiled with AVX2 enabled, and its functions are only called
+// from rasterio.cpp after a runtime check of AVX2 availability. It must not
+// include gdal_priv_templates.hpp, whose inline functions are also
+// instantiated without AVX2 in the rest of the library.
+//
+// All kernels work on packed buffers. They convert as many words as fit in
+// whole iterations, return that count, and leave the remaining words to the
+// caller. The rounding and clamping rules are exactly the ones of
+// GDALCopyWord(), including the handling of NaN.
+
+int GDALCopyWordsFloat32ToByte_AVX2( const float* CPL_RESTRICT pSrc,
+                                     GByte* CPL_RESTRICT pDst,
+                                     int nWordCount );
+int GDALCopyWordsFloat32ToUInt16_AVX2( const float* CPL_RESTRICT pSrc,
+                                       GUInt16* CPL_RESTRICT pDst,
+                                       int nWordCount );
+int GDALCopyWordsFloat32ToInt16_AVX2( const float* CPL_RESTRICT pSrc,
+                                      GInt16* CPL_RESTRICT pDst,
+                                      int nWordCount );
+int GDALCopyWordsFloat32ToInt32_AVX2( const float* CPL_RESTRICT pSrc,
+                                      GInt32* CPL_RESTRICT pDst,
+                                      int nWordCount );
+int GDALCopyWordsFloat64ToByte_AVX2( const double* CPL_RESTRICT pSrc,
+                                     GByte* CPL_RESTRICT pDst,
+                                     int nWordCount );
+int GDALCopyWordsFloat64ToUInt16_AVX2( const double* CPL_RESTRICT pSrc,
+                                       GUInt16* CPL_RESTRICT pDst,
+                                       int nWordCount );
+int GDALCopyWordsFloat64ToInt16_AVX2( const double* CPL_RESTRICT pSrc,
+                                      GInt16* CPL_RESTRICT pDst,
+                                      int nWordCount );
+int GDALCopyWordsFloat64ToInt32_AVX2( const double* CPL_RESTRICT pSrc,
+                                      GInt32* CPL_RESTRICT pDst,
+                                      int nWordCount );
+int GDALCopyWordsByteToFloat32_AVX2( const GByte* CPL_RESTRICT pSrc,
+                                     float* CPL_RESTRICT pDst,
+                                     int nWordCount );
+int GDALCopyWordsUInt16ToFloat32_AVX2( const GUInt16* CPL_RESTRICT pSrc,
+                                       float* CPL_RESTRICT pDst,
+                                       int nWordCount );
+int GDALCopyWordsInt16ToFloat32_AVX2( const GInt16* CPL_RESTRICT pSrc,
+                                      float* CPL_RESTRICT pDst,
+                                      int nWordCount );
+
+/************************************************************************/
+/*                       Rounding helpers                               */
+/************************************************************************/
+
+// Same as GDALCopyWord(float, Tout&) for unsigned Tout: (f + 0.5) clamped
+// to [0, fMax] and truncated. NaN ends up as 0.5, hence 0.
+static inline __m256i GDALRoundUnsignedPS_AVX2( __m256 ymm, __m256 ymm_max )
+{
+    const __m256 p0d5 = _mm256_set1_ps(0.5f);
+    ymm = _mm256_add_ps(ymm, p0d5);
+    ymm = _mm256_min_ps(_mm256_max_ps(ymm, p0d5), ymm_max);
+    return _mm256_cvttps_epi32(ymm);
+}
+
+// Same as GDALCopyWord(float, short&): NaN is 0, otherwise round half
+// away from zero and clamp.
+static inline __m256i GDALRoundSignedPS_AVX2( __m256 ymm,
+                                              __m256 ymm_min,
+                                              __m256 ymm_max )
+{
+    ymm = _mm256_and_ps(ymm, _mm256_cmp_ps(ymm, ymm, _CMP_ORD_Q));
+    const __m256 mask = _mm256_cmp_ps(ymm, _mm256_setzero_ps(), _CMP_GE_OQ);
+    ymm = _mm256_add_ps(ymm, _mm256_blendv_ps(_mm256_set1_ps(-0.5f),
+                                              _mm256_set1_ps(0.5f), mask));
+    ymm = _mm256_min_ps(_mm256_max_ps(ymm, ymm_min), ymm_max);
+    return _mm256_cvttps_epi32(ymm);
+}
+
+static inline __m128i GDALRoundUnsignedPD_AVX2( __m256d ymm, __m256d ymm_max )
+{
+    const __m256d p0d5 = _mm256_set1_pd(0.5);
+    ymm = _mm256_add_pd(ymm, p0d5);
+    ymm = _mm256_min_pd(_mm256_max_pd(ymm, p0d5), ymm_max);
+    return _mm256_cvttpd_epi32(ymm);
+}
+
+// GDALCopyWord(double, short&) adds 0.5 if the value is > 0, whereas
+// GDALCopyWord(double, int&) does it if the value is >= 0. Both lead to the
+// same result, since -0.5 and 0.5 are both truncated to 0.
+static inline __m128i GDALRoundSignedPD_AVX2( __m256d ymm,
+                                              __m256d ymm_min,
+                                              __m256d ymm_max )
+{
+    ymm = _mm256_and_pd(ymm, _mm256_cmp_pd(ymm, ymm, _CMP_ORD_Q));
+    const __m256d mask = _mm256_cmp_pd(ymm, _mm256_setzero_pd(), _CMP_GE_OQ);
+    ymm = _mm256_add_pd(ymm, _mm256_blendv_pd(_mm256_set1_pd(-0.5),
+                                              _mm256_set1_pd(0.5), mask));
+    ymm = _mm256_min_pd(_mm256_max_pd(ymm, ymm_min), ymm_max);
+    return _mm256_cvttpd_epi32(ymm);
+}
+
+/************************************************************************/
+/*                  GDALCopyWordsFloat32ToByte_AVX2()                   */
+/************************************************************************/
+
+int GDALCopyWordsFloat32ToByte_AVX2( const float* CPL_RESTRICT pSrc,
+                                     GByte* CPL_RESTRICT pDst,
+                                     int nWordCount )
+{
+    const __m256 ymm_max = _mm256_set1_ps(255.0f);
+    // packs/packus work within 128 bit lanes: restore the word order
+    const __m256i ymm_perm = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    int n = 0;
+    for( ; n < nWordCount - 31; n += 32 )
+    {
+        __m256i ymm0 = GDALRoundUnsignedPS_AVX2(_mm256_loadu_ps(pSrc + n),
+                                                ymm_max);
+        __m256i ymm1 = GDALRoundUnsignedPS_AVX2(_mm256_loadu_ps(pSrc + n + 8),
+                                                ymm_max);
+        __m256i ymm2 = GDALRoundUnsignedPS_AVX2(_mm256_loadu_ps(pSrc + n + 16),
+                                                ymm_max);
+        __m256i ymm3 = GDALRoundUnsignedPS_AVX2(_mm256_loadu_ps(pSrc + n + 24),
+                                                ymm_max);
+        ymm0 = _mm256_packs_epi32(ymm0, ymm1);
+        ymm2 = _mm256_packs_epi32(ymm2, ymm3);
+        ymm0 = _mm256_packus_epi16(ymm0, ymm2);
+        ymm0 = _mm256_permutevar8x32_epi32(ymm0, ymm_perm);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst + n), ymm0);
+    }
+    return n;
+}
+
+/************************************************************************/
+/*                 GDALCopyWordsFloat32ToUInt16_AVX2()                  */
+/************************************************************************/
+
+int GDALCopyWordsFloat32ToUInt16_AVX2( const float* CPL_RESTRICT pSrc,
+                                       GUInt16* CPL_RESTRICT pDst,
+                                       int nWordCount )
+{
+    const __m256 ymm_max = _mm256_set1_ps(65535.0f);
+    int n = 0;
+    for( ; n < nWordCount - 15; n += 16 )
+    {
+        __m256i ymm0 = GDALRoundUnsignedPS_AVX2(_mm256_loadu_ps(pSrc + n),
+                                                ymm_max);
+        __m256i ymm1 = GDALRoundUnsignedPS_AVX2(_mm256_loadu_ps(pSrc + n + 8),
+                                                ymm_max);
+        ymm0 = _mm256_packus_epi32(ymm0, ymm1);
+        ymm0 = _mm256_permute4x64_epi64(ymm0, 0 | (2 << 2) | (1 << 4) | (3 << 6));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst + n), ymm0);
+    }
+    return n;
+}
+
+/************************************************************************/
+/*                 GDALCopyWordsFloat32ToInt16_AVX2()                   */
+/************************************************************************/
+
+int GDALCopyWordsFloat32ToInt16_AVX2( const float* CPL_RESTRICT pSrc,
+                                      GInt16* CPL_RESTRICT pDst,
+                                      int nWordCount )
+{
+    const __m256 ymm_min = _mm256_set1_ps(-32768.0f);
+    const __m256 ymm_max = _mm256_set1_ps(32767.0f);
+    int n = 0;
+    for( ; n < nWordCount - 15; n += 16 )
+    {
+        __m256i ymm0 = GDALRoundSignedPS_AVX2(_mm256_loadu_ps(pSrc + n),
+                                              ymm_min, ymm_max);
+        __m256i ymm1 = GDALRoundSignedPS_AVX2(_mm256_loadu_ps(pSrc + n + 8),
+                                              ymm_min, ymm_max);
+        ymm0 = _mm256_packs_epi32(ymm0, ymm1);
+        ymm0 = _mm256_permute4x64_epi64(ymm0, 0 | (2 << 2) | (1 << 4) | (3 << 6));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst + n), ymm0);
+    }
+    return n;
+}
+
+/************************************************************************/
+/*                 GDALCopyWordsFloat32ToInt32_AVX2()                   */
+/************************************************************************/
+
+int GDALCopyWordsFloat32ToInt32_AVX2( const float* CPL_RESTRICT pSrc,
+                                      GInt32* CPL_RESTRICT pDst,
+                                      int nWordCount )
+{
+    // Mirrors GDALCopyWord(float, int&): values >= 2^31 saturate to INT_MAX,
+    // whereas values <= -2^31 (and NaN) get 0x80000000 from the conversion.
+    const __m256 ymm_zero = _mm256_setzero_ps();
+    const __m256 p0d5 = _mm256_set1_ps(0.5f);
+    const __m256 m0d5 = _mm256_set1_ps(-0.5f);
+    const __m256 ymm_2pow31 = _mm256_set1_ps(2147483648.0f);
+    const __m256i ymm_int_max = _mm256_set1_epi32(0x7FFFFFFF);
+    int n = 0;
+    for( ; n < nWordCount - 7; n += 8 )
+    {
+        const __m256 ymm = _mm256_loadu_ps(pSrc + n);
+        const __m256 mask_pos = _mm256_cmp_ps(ymm, ymm_zero, _CMP_GT_OQ);
+        const __m256 mask_max = _mm256_cmp_ps(ymm, ymm_2pow31, _CMP_GE_OQ);
+        __m256i ymm_i = _mm256_cvttps_epi32(
+            _mm256_add_ps(ymm, _mm256_blendv_ps(m0d5, p0d5, mask_pos)));
+        ymm_i = _mm256_blendv_epi8(ymm_i, ymm_int_max,
+                                   _mm256_castps_si256(mask_max));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst + n), ymm_i);
+    }
+    return n;
+}
+
+/************************************************************************/
+/*                  GDALCopyWordsFloat64ToByte_AVX2()                   */
+/************************************************************************/
+
+int GDALCopyWordsFloat64ToByte_AVX2( const double* CPL_RESTRICT pSrc,
+                                     GByte* CPL_RESTRICT pDst,
+                                     int nWordCount )
+{
+    const __m256d ymm_max = _mm256_set1_pd(255.0);
+    int n = 0;
+    for( ; n < nWordCount - 15; n += 16 )
+    {
+        __m128i xmm0 = GDALRoundUnsignedPD_AVX2(_mm256_loadu_pd(pSrc + n),
+                                                ymm_max);
+        __m128i xmm1 = GDALRoundUnsignedPD_AVX2(_mm256_loadu_pd(pSrc + n + 4),
+                                                ymm_max);
+        __m128i xmm2 = GDALRoundUnsignedPD_AVX2(_mm256_loadu_pd(pSrc + n + 8),
+                                                ymm_max);
+        __m128i xmm3 = GDALRoundUnsignedPD_AVX2(_mm256_loadu_pd(pSrc + n + 12),
+                                                ymm_max);
+        xmm0 = _mm_packs_epi32(xmm0, xmm1);
+        xmm2 = _mm_packs_epi32(xmm2, xmm3);
+        xmm0 = _mm_packus_epi16(xmm0, xmm2);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + n), xmm0);
+    }
+    return n;
+}
+
+/************************************************************************/
+/*                 GDALCopyWordsFloat64ToUInt16_AVX2()                  */
+/************************************************************************/
+
+int GDALCopyWordsFloat64ToUInt16_AVX2( const double* CPL_RESTRICT pSrc,
+                                       GUInt16* CPL_RESTRICT pDst,
+                                       int nWordCount )
+{
+    const __m256d ymm_max = _mm256_set1_pd(65535.0);
+    int n = 0;
+    for( ; n < nWordCount - 15; n += 16 )
+    {
+        __m128i xmm0 = GDALRoundUnsignedPD_AVX2(_mm256_loadu_pd(pSrc + n),
+                                                ymm_max);
+        __m128i xmm1 = GDALRoundUnsignedPD_AVX2(_mm256_loadu_pd(pSrc + n + 4),
+                                                ymm_max);
+        __m128i xmm2 = GDALRoundUnsignedPD_AVX2(_mm256_loadu_pd(pSrc + n + 8),
+                                                ymm_max);
+        __m128i xmm3 = GDALRoundUnsignedPD_AVX2(_mm256_loadu_pd(pSrc + n + 12),
+                                                ymm_max);
+        xmm0 = _mm_packus_epi32(xmm0, xmm1);
+        xmm2 = _mm_packus_epi32(xmm2, xmm3);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + n), xmm0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + n + 8), xmm2);
+    }
+    return n;
+}
+
+/************************************************************************/
+/*                 GDALCopyWordsFloat64ToInt16_AVX2()                   */
+/************************************************************************/
+
+int GDALCopyWordsFloat64ToInt16_AVX2( const double* CPL_RESTRICT pSrc,
+                                      GInt16* CPL_RESTRICT pDst,
+                                      int nWordCount )
+{
+    const __m256d ymm_min = _mm256_set1_pd(-32768.0);
+    const __m256d ymm_max = _mm256_set1_pd(32767.0);
+    int n = 0;
+    for( ; n < nWordCount - 15; n += 16 )
+    {
+        __m128i xmm0 = GDALRoundSignedPD_AVX2(_mm256_loadu_pd(pSrc + n),
+                                              ymm_min, ymm_max);
+        __m128i xmm1 = GDALRoundSignedPD_AVX2(_mm256_loadu_pd(pSrc + n + 4),
+                                              ymm_min, ymm_max);
+        __m128i xmm2 = GDALRoundSignedPD_AVX2(_mm256_loadu_pd(pSrc + n + 8),
+                                              ymm_min, ymm_max);
+        __m128i xmm3 = GDALRoundSignedPD_AVX2(_mm256_loadu_pd(pSrc + n + 12),
+                                              ymm_min, ymm_max);
+        xmm0 = _mm_packs_epi32(xmm0, xmm1);
+        xmm2 = _mm_packs_epi32(xmm2, xmm3);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + n), xmm0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + n + 8), xmm2);
+    }
+    return n;
+}
+
+/************************************************************************/
+/*                 GDALCopyWordsFloat64ToInt32_AVX2()                   */
+/************************************************************************/
+
+int GDALCopyWordsFloat64ToInt32_AVX2( const double* CPL_RESTRICT pSrc,
+                                      GInt32* CPL_RESTRICT pDst,
+                                      int nWordCount )
+{
+    const __m256d ymm_min = _mm256_set1_pd(-2147483648.0);
+    const __m256d ymm_max = _mm256_set1_pd(2147483647.0);
+    int n = 0;
+    for( ; n < nWordCount - 7; n += 8 )
+    {
+        __m128i xmm0 = GDALRoundSignedPD_AVX2(_mm256_loadu_pd(pSrc + n),
+                                              ymm_min, ymm_max);
+        __m128i xmm1 = GDALRoundSignedPD_AVX2(_mm256_loadu_pd(pSrc + n + 4),
+                                              ymm_min, ymm_max);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + n), xmm0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + n + 4), xmm1);
+    }
+    return n;
+}
+
+/************************************************************************/
+/*                  GDALCopyWordsByteToFloat32_AVX2()                   */
+/************************************************************************/
+
+int GDALCopyWordsByteToFloat32_AVX2( const GByte* CPL_RESTRICT pSrc,
+                                     float* CPL_RESTRICT pDst,
+                                     int nWordCount )
+{
+    int n = 0;
+    for( ; n < nWordCount - 15; n += 16 )
+    {
+        const __m128i xmm = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(pSrc + n));
+        const __m256i ymm0 = _mm256_cvtepu8_epi32(xmm);
+        const __m256i ymm1 = _mm256_cvtepu8_epi32(_mm_srli_si128(xmm, 8));
+        _mm256_storeu_ps(pDst + n, _mm256_cvtepi32_ps(ymm0));
+        _mm256_storeu_ps(pDst + n + 8, _mm256_cvtepi32_ps(ymm1));
+    }
+    return n;
+}
+
+/************************************************************************/
+/*                 GDALCopyWordsUInt16ToFloat32_AVX2()                  */
+/************************************************************************/
+
+int GDALCopyWordsUInt16ToFloat32_AVX2( const GUInt16* CPL_RESTRICT pSrc,
+                                       float* CPL_RESTRICT pDst,
+                                       int nWordCount )
+{
+    int n = 0;
+    for( ; n < nWordCount - 15; n += 16 )
+    {
+        const __m128i xmm0 = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(pSrc + n));
+        const __m128i xmm1 = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(pSrc + n + 8));
+        _mm256_storeu_ps(pDst + n,
+                         _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(xmm0)));
+        _mm256_storeu_ps(pDst + n + 8,
+                         _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(xmm1)));
+    }
+    return n;
+}
+
+/************************************************************************/
+/*                  GDALCopyWordsInt16ToFloat32_AVX2()                  */
+/************************************************************************/
+
+int GDALCopyWordsInt16ToFloat32_AVX2( const GInt16* CPL_RESTRICT pSrc,
+                                      float* CPL_RESTRICT pDst,
+                                      int nWordCount )
+{
+    int n = 0;
+    for( ; n < nWordCount - 15; n += 16 )
+    {
+        const __m128i xmm0 = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(pSrc + n));
+        const __m128i xmm1 = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(pSrc + n + 8));
+        _mm256_storeu_ps(pDst + n,
+                         _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(xmm0)));
+        _mm256_storeu_ps(pDst + n + 8,
+                         _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(xmm1)));
+    }
+    return n;
+}
+
+#endif // defined(HAVE_AVX2_AT_COMPILE_TIME)
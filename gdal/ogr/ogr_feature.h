@@ -583,6 +583,162 @@ struct CPL_DLL OGRFeatureUniquePtrDeleter
  */
 typedef std::unique_ptr<OGRFeature, OGRFeatureUniquePtrDeleter> OGRFeatureUniquePtr;
 
+/************************************************************************/
+/*                           OGRFeatureBatch                            */
+/************************************************************************/
+
+/**
+ * A batch of features, whose attribute and geometry fields are stored
+ * in columns of contiguous values.
+ *
+ * Each column has a validity bitmap, whose bit i (bit i%8 of byte i/8) is
+ * set when the value of the i-th feature is set and not null, a null bitmap,
+ * whose bit i is set when the value of the i-th feature is null, and values
+ * stored according to the type of the field:
+ * <ul>
+ * <li>OFTInteger, OFTInteger64 and OFTReal: arrays of int, GIntBig and
+ * double.</li>
+ * <li>OFTDate, OFTTime and OFTDateTime: array of OGRField, whose Date member
+ * is set.</li>
+ * <li>OFTString: nul-terminated strings, concatenated.</li>
+ * <li>OFTBinary: binary values, concatenated.</li>
+ * <li>OFTIntegerList, OFTInteger64List and OFTRealList: elements of the
+ * lists, concatenated in arrays of int, GIntBig and double.</li>
+ * <li>OFTStringList: nul-terminated elements of the lists, concatenated.</li>
+ * <li>Geometry fields: geometries as ISO WKB, concatenated.</li>
+ * </ul>
+ * For the variable-size types, the values of the i-th feature are the
+ * elements between offsets i and i+1 of the array of offsets.
+ *
+ * Batches are filled by OGRLayer::GetNextFeatureBatch(). They are meant to
+ * be reused for successive batches, so that the memory of the columns is
+ * only allocated for the first ones.
+ *
+ * @since GDAL 2.3
+ */
+class CPL_DLL OGRFeatureBatch
+{
+  public:
+    /** A column of an OGRFeatureBatch. */
+    class CPL_DLL Column
+    {
+        friend class OGRFeatureBatch;
+
+        OGRFieldType         m_eType;
+        size_t               m_nElementSize;
+        bool                 m_bVariableSize;
+        std::vector<GByte>   m_abyValidity;
+        std::vector<GByte>   m_abyNull;
+        std::vector<GByte>   m_abyValues;
+        std::vector<size_t>  m_anOffsets;
+
+        void                 Reset( OGRFieldType eType, bool bIsGeometry );
+        void                 AddRow( int iRow );
+        GByte               *SetValue( int iRow );
+        GByte               *SetValues( int iRow, size_t nElements );
+        void                 SetNull( int iRow );
+
+      public:
+        Column();
+
+        /** Return the type of the field (OFTBinary for geometry fields). */
+        OGRFieldType         GetType() const { return m_eType; }
+
+        /** Return whether the value of a feature is set and not null. */
+        bool                 IsValid( int iFeature ) const
+            { return (m_abyValidity[iFeature / 8] &
+                      (1 << (iFeature % 8))) != 0; }
+
+        /** Return whether the value of a feature is null. A value that is
+         * neither valid nor null is unset. */
+        bool                 IsNull( int iFeature ) const
+            { return (m_abyNull[iFeature / 8] &
+                      (1 << (iFeature % 8))) != 0; }
+
+        /** Return the validity bitmap. */
+        const GByte         *GetValidityBitmap() const
+            { return m_abyValidity.data(); }
+
+        /** Return the null bitmap. */
+        const GByte         *GetNullBitmap() const
+            { return m_abyNull.data(); }
+
+        /** Return the array of values, or of elements of variable-size
+         * values. */
+        const void          *GetValues() const
+            { return m_abyValues.data(); }
+
+        /** Return the array of offsets of variable-size values, or NULL
+         * for fixed-size ones. */
+        const size_t        *GetOffsets() const
+            { return m_bVariableSize ? m_anOffsets.data() : nullptr; }
+
+        int                  GetInteger( int iFeature ) const;
+        GIntBig              GetInteger64( int iFeature ) const;
+        double               GetReal( int iFeature ) const;
+        const OGRField      *GetDateTime( int iFeature ) const;
+        const char          *GetString( int iFeature ) const;
+        const GByte         *GetBinary( int iFeature, int *pnBytes ) const;
+    };
+
+  private:
+    OGRFeatureDefn      *m_poDefn;
+    int                  m_nFeatureCount;
+    std::vector<GIntBig> m_anFIDs;
+    std::vector<Column>  m_aoFieldColumns;
+    std::vector<Column>  m_aoGeomFieldColumns;
+    OGRFeature          *m_poConversionFeature;
+
+    OGRFeature          *GetConversionFeature();
+    void                 SetFieldFromConversionFeature( int iField );
+
+  public:
+                         OGRFeatureBatch();
+                        ~OGRFeatureBatch();
+
+    void                 Reset( OGRFeatureDefn *poDefn );
+
+    /** Return the feature definition of the batch. */
+    OGRFeatureDefn      *GetDefnRef() { return m_poDefn; }
+    /** Return the number of features of the batch. */
+    int                  GetFeatureCount() const { return m_nFeatureCount; }
+    /** Return the array of the FIDs of the features. */
+    const GIntBig       *GetFIDs() const { return m_anFIDs.data(); }
+    /** Return the column of an attribute field. */
+    const Column        &GetFieldColumn( int iField ) const
+        { return m_aoFieldColumns[iField]; }
+    /** Return the column of a geometry field. */
+    const Column        &GetGeomFieldColumn( int iGeomField ) const
+        { return m_aoGeomFieldColumns[iGeomField]; }
+
+    OGRFeature          *GetFeature( int iFeature ) const
+                                                    CPL_WARN_UNUSED_RESULT;
+
+    void                 AddFeature( GIntBig nFID );
+    void                 AddFeature( const OGRFeature *poFeature );
+
+    // Setters of the last added feature, similar to the ones of OGRFeature.
+    void                 SetFieldNull( int iField );
+    void                 SetField( int iField, int nValue );
+    void                 SetField( int iField, GIntBig nValue );
+    void                 SetField( int iField, double dfValue );
+    void                 SetField( int iField, const char *pszValue );
+    void                 SetField( int iField, int nBytes,
+                                   const GByte *pabyData );
+    void                 SetField( int iField, int nYear, int nMonth,
+                                   int nDay, int nHour = 0, int nMinute = 0,
+                                   float fSecond = 0.f, int nTZFlag = 0 );
+    void                 SetField( int iField, const OGRField *psValue );
+    void                 SetGeomField( int iGeomField,
+                                       const OGRGeometry *poGeom );
+    void                 SetGeomFieldWkb( int iGeomField,
+                                          const GByte *pabyWkb,
+                                          size_t nWkbSize );
+
+  private:
+    CPL_DISALLOW_COPY_ASSIGN(OGRFeatureBatch)
+};
+
 /************************************************************************/
 /*                           OGRFeatureQuery                            */
 /************************************************************************/
@@ -0,0 +1,835 @@
+/******************************************************************************
+ *
+ * Project:  OpenGIS Simple Features Reference Implementation
+ * Purpose:  The OGRFeatureBatch class implementation.
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cpl_port.h"
+#include "ogr_feature.h"
+
+#include <cstring>
+#include <vector>
+
+#include "cpl_string.h"
+#include "ogr_api.h"
+#include "ogr_core.h"
+#include "ogr_geometry.h"
+
+CPL_CVSID("$Id$")
+
+/************************************************************************/
+/*                               Column()                               */
+/************************************************************************/
+
+OGRFeatureBatch::Column::Column() :
+    m_eType(OFTString),
+    m_nElementSize(1),
+    m_bVariableSize(true)
+{
+}
+
+/************************************************************************/
+/*                               Reset()                                */
+/************************************************************************/
+
+void OGRFeatureBatch::Column::Reset( OGRFieldType eType, bool bIsGeometry )
+{
+    m_eType = bIsGeometry ? OFTBinary : eType;
+    switch( m_eType )
+    {
+        case OFTInteger:
+            m_nElementSize = sizeof(int);
+            m_bVariableSize = false;
+            break;
+        case OFTInteger64:
+            m_nElementSize = sizeof(GIntBig);
+            m_bVariableSize = false;
+            break;
+        case OFTReal:
+            m_nElementSize = sizeof(double);
+            m_bVariableSize = false;
+            break;
+        case OFTDate:
+        case OFTTime:
+        case OFTDateTime:
+            m_nElementSize = sizeof(OGRField);
+            m_bVariableSize = false;
+            break;
+        case OFTIntegerList:
+            m_nElementSize = sizeof(int);
+            m_bVariableSize = true;
+            break;
+        case OFTInteger64List:
+            m_nElementSize = sizeof(GIntBig);
+            m_bVariableSize = true;
+            break;
+        case OFTRealList:
+            m_nElementSize = sizeof(double);
+            m_bVariableSize = true;
+            break;
+        default:
+            m_nElementSize = 1;
+            m_bVariableSize = true;
+            break;
+    }
+
+    // clear() keeps the allocated memory for the next batch.
+    m_abyValidity.clear();
+    m_abyNull.clear();
+    m_abyValues.clear();
+    m_anOffsets.clear();
+    if( m_bVariableSize )
+        m_anOffsets.push_back(0);
+}
+
+/************************************************************************/
+/*                               AddRow()                               */
+/************************************************************************/
+
+// Adds a row whose value is not set.
+void OGRFeatureBatch::Column::AddRow( int iRow )
+{
+    if( (iRow % 8) == 0 )
+    {
+        m_abyValidity.push_back(0);
+        m_abyNull.push_back(0);
+    }
+    if( m_bVariableSize )
+        m_anOffsets.push_back(m_anOffsets.back());
+    else
+        m_abyValues.resize(m_abyValues.size() + m_nElementSize);
+}
+
+/************************************************************************/
+/*                              SetValue()                              */
+/************************************************************************/
+
+// Marks the fixed-size value of a row as valid, and returns where to
+// write it.
+GByte *OGRFeatureBatch::Column::SetValue( int iRow )
+{
+    m_abyValidity[iRow / 8] |= static_cast<GByte>(1 << (iRow % 8));
+    return m_abyValues.data() + static_cast<size_t>(iRow) * m_nElementSize;
+}
+
+/************************************************************************/
+/*                             SetValues()                              */
+/************************************************************************/
+
+// Marks the variable-size value of the last row as valid, and returns where
+// to write its nElements elements.
+GByte *OGRFeatureBatch::Column::SetValues( int iRow, size_t nElements )
+{
+    m_abyValidity[iRow / 8] |= static_cast<GByte>(1 << (iRow % 8));
+    m_anOffsets[iRow + 1] = m_anOffsets[iRow] + nElements;
+    m_abyValues.resize(m_anOffsets[iRow + 1] * m_nElementSize);
+    return m_abyValues.data() + m_anOffsets[iRow] * m_nElementSize;
+}
+
+/************************************************************************/
+/*                              SetNull()                               */
+/************************************************************************/
+
+// Marks the value of a row as null. The value is left zeroed, or empty.
+void OGRFeatureBatch::Column::SetNull( int iRow )
+{
+    m_abyNull[iRow / 8] |= static_cast<GByte>(1 << (iRow % 8));
+}
+
+/************************************************************************/
+/*                             GetInteger()                             */
+/************************************************************************/
+
+/** Return the value of a feature in an OFTInteger column (0 if it is not
+ * valid). */
+int OGRFeatureBatch::Column::GetInteger( int iFeature ) const
+{
+    return reinterpret_cast<const int*>(m_abyValues.data())[iFeature];
+}
+
+/************************************************************************/
+/*                            GetInteger64()                            */
+/************************************************************************/
+
+/** Return the value of a feature in an OFTInteger64 column (0 if it is not
+ * valid). */
+GIntBig OGRFeatureBatch::Column::GetInteger64( int iFeature ) const
+{
+    return reinterpret_cast<const GIntBig*>(m_abyValues.data())[iFeature];
+}
+
+/************************************************************************/
+/*                              GetReal()                               */
+/************************************************************************/
+
+/** Return the value of a feature in an OFTReal column (0 if it is not
+ * valid). */
+double OGRFeatureBatch::Column::GetReal( int iFeature ) const
+{
+    return reinterpret_cast<const double*>(m_abyValues.data())[iFeature];
+}
+
+/************************************************************************/
+/*                            GetDateTime()                             */
+/************************************************************************/
+
+/** Return the value of a feature in an OFTDate, OFTTime or OFTDateTime
+ * column, or NULL if it is not valid. */
+const OGRField *OGRFeatureBatch::Column::GetDateTime( int iFeature ) const
+{
+    if( !IsValid(iFeature) )
+        return nullptr;
+    return reinterpret_cast<const OGRField*>(m_abyValues.data()) + iFeature;
+}
+
+/************************************************************************/
+/*                             GetString()                              */
+/************************************************************************/
+
+/** Return the value of a feature in an OFTString column, or NULL if it is
+ * not valid. */
+const char *OGRFeatureBatch::Column::GetString( int iFeature ) const
+{
+    if( !IsValid(iFeature) )
+        return nullptr;
+    return reinterpret_cast<const char*>(m_abyValues.data()) +
+                                                    m_anOffsets[iFeature];
+}
+
+/************************************************************************/
+/*                             GetBinary()                              */
+/************************************************************************/
+
+/** Return the value of a feature in an OFTBinary or geometry column, or
+ * NULL if it is not valid. */
+const GByte *OGRFeatureBatch::Column::GetBinary( int iFeature,
+                                                 int *pnBytes ) const
+{
+    if( !IsValid(iFeature) )
+    {
+        *pnBytes = 0;
+        return nullptr;
+    }
+    *pnBytes = static_cast<int>(m_anOffsets[iFeature + 1] -
+                                m_anOffsets[iFeature]);
+    return m_abyValues.data() + m_anOffsets[iFeature];
+}
+
+/************************************************************************/
+/*                          OGRFeatureBatch()                           */
+/************************************************************************/
+
+/**
+ * \brief Constructor.
+ *
+ * The batch is empty, and must be reset with a feature definition before
+ * features are added to it.
+ *
+ * @since GDAL 2.3
+ */
+
+OGRFeatureBatch::OGRFeatureBatch() :
+    m_poDefn(nullptr),
+    m_nFeatureCount(0),
+    m_poConversionFeature(nullptr)
+{
+}
+
+/************************************************************************/
+/*                          ~OGRFeatureBatch()                          */
+/************************************************************************/
+
+OGRFeatureBatch::~OGRFeatureBatch()
+{
+    delete m_poConversionFeature;
+    if( m_poDefn != nullptr )
+        m_poDefn->Release();
+}
+
+/************************************************************************/
+/*                               Reset()                                */
+/************************************************************************/
+
+/**
+ * \brief Remove all features and set the feature definition of the batch.
+ *
+ * The memory allocated for the columns is kept, to be reused by the
+ * features added afterwards.
+ *
+ * @param poDefn the feature definition, which is referenced by the batch.
+ *
+ * @since GDAL 2.3
+ */
+
+void OGRFeatureBatch::Reset( OGRFeatureDefn *poDefn )
+{
+    // The fields of the definition may have changed since the last call.
+    delete m_poConversionFeature;
+    m_poConversionFeature = nullptr;
+
+    if( poDefn != m_poDefn )
+    {
+        if( poDefn != nullptr )
+            poDefn->Reference();
+        if( m_poDefn != nullptr )
+            m_poDefn->Release();
+        m_poDefn = poDefn;
+    }
+
+    m_nFeatureCount = 0;
+    m_anFIDs.clear();
+
+    const int nFieldCount = poDefn ? poDefn->GetFieldCount() : 0;
+    m_aoFieldColumns.resize(nFieldCount);
+    for( int i = 0; i < nFieldCount; i++ )
+    {
+        m_aoFieldColumns[i].Reset(poDefn->GetFieldDefn(i)->GetType(), false);
+    }
+
+    const int nGeomFieldCount = poDefn ? poDefn->GetGeomFieldCount() : 0;
+    m_aoGeomFieldColumns.resize(nGeomFieldCount);
+    for( int i = 0; i < nGeomFieldCount; i++ )
+    {
+        m_aoGeomFieldColumns[i].Reset(OFTBinary, true);
+    }
+}
+
+/************************************************************************/
+/*                             GetFeature()                             */
+/************************************************************************/
+
+/**
+ * \brief Create a feature from a feature of the batch.
+ *
+ * Null values are set to null, and other values that are not valid are
+ * left unset.
+ *
+ * @param iFeature the index of the feature in the batch.
+ *
+ * @return a new feature, to be destroyed by the caller.
+ *
+ * @since GDAL 2.3
+ */
+
+OGRFeature *OGRFeatureBatch::GetFeature( int iFeature ) const
+{
+    OGRFeature *poFeature = new OGRFeature(m_poDefn);
+    poFeature->SetFID(m_anFIDs[iFeature]);
+
+    for( int iField = 0;
+         iField < static_cast<int>(m_aoFieldColumns.size()); iField++ )
+    {
+        const Column& oColumn = m_aoFieldColumns[iField];
+        if( oColumn.IsNull(iFeature) )
+        {
+            poFeature->SetFieldNull(iField);
+            continue;
+        }
+        if( !oColumn.IsValid(iFeature) )
+            continue;
+
+        const GByte *pabyValues = nullptr;
+        int nCount = 0;
+        if( oColumn.m_bVariableSize )
+        {
+            pabyValues = oColumn.m_abyValues.data() +
+                oColumn.m_anOffsets[iFeature] * oColumn.m_nElementSize;
+            nCount = static_cast<int>(oColumn.m_anOffsets[iFeature + 1] -
+                                      oColumn.m_anOffsets[iFeature]);
+        }
+
+        switch( oColumn.m_eType )
+        {
+            case OFTInteger:
+                poFeature->SetField(iField, oColumn.GetInteger(iFeature));
+                break;
+            case OFTInteger64:
+                poFeature->SetField(iField, oColumn.GetInteger64(iFeature));
+                break;
+            case OFTReal:
+                poFeature->SetField(iField, oColumn.GetReal(iFeature));
+                break;
+            case OFTDate:
+            case OFTTime:
+            case OFTDateTime:
+                poFeature->SetField(iField,
+                    const_cast<OGRField*>(oColumn.GetDateTime(iFeature)));
+                break;
+            case OFTString:
+                poFeature->SetField(iField,
+                                    reinterpret_cast<const char*>(pabyValues));
+                break;
+            case OFTBinary:
+                poFeature->SetField(iField, nCount,
+                                    const_cast<GByte*>(pabyValues));
+                break;
+            case OFTIntegerList:
+                poFeature->SetField(iField, nCount,
+                    reinterpret_cast<int*>(const_cast<GByte*>(pabyValues)));
+                break;
+            case OFTInteger64List:
+                poFeature->SetField(iField, nCount,
+                    reinterpret_cast<const GIntBig*>(pabyValues));
+                break;
+            case OFTRealList:
+                poFeature->SetField(iField, nCount,
+                    reinterpret_cast<double*>(const_cast<GByte*>(pabyValues)));
+                break;
+            case OFTStringList:
+            {
+                CPLStringList aosList;
+                const char *pszIter = reinterpret_cast<const char*>(pabyValues);
+                const char *pszEnd = pszIter + nCount;
+                while( pszIter < pszEnd )
+                {
+                    aosList.AddString(pszIter);
+                    pszIter += strlen(pszIter) + 1;
+                }
+                poFeature->SetField(iField, aosList.List());
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    for( int iGeomField = 0;
+         iGeomField < static_cast<int>(m_aoGeomFieldColumns.size());
+         iGeomField++ )
+    {
+        int nBytes = 0;
+        const GByte *pabyWkb =
+            m_aoGeomFieldColumns[iGeomField].GetBinary(iFeature, &nBytes);
+        if( pabyWkb == nullptr )
+            continue;
+        OGRGeometry *poGeom = nullptr;
+        int nBytesConsumed = 0;
+        if( OGRGeometryFactory::createFromWkb(
+                pabyWkb,
+                m_poDefn->GetGeomFieldDefn(iGeomField)->GetSpatialRef(),
+                &poGeom, nBytes, wkbVariantIso, nBytesConsumed) ==
+                                                                OGRERR_NONE )
+        {
+            poFeature->SetGeomFieldDirectly(iGeomField, poGeom);
+        }
+    }
+
+    return poFeature;
+}
+
+/************************************************************************/
+/*                             AddFeature()                             */
+/************************************************************************/
+
+/**
+ * \brief Add a feature whose fields are not set.
+ *
+ * The fields of the feature can then be set with the SetField(),
+ * SetGeomField() and SetGeomFieldWkb() methods, which apply to the last
+ * added feature.
+ *
+ * @param nFID the feature id.
+ *
+ * @since GDAL 2.3
+ */
+
+void OGRFeatureBatch::AddFeature( GIntBig nFID )
+{
+    const int iRow = m_nFeatureCount;
+    m_nFeatureCount++;
+    m_anFIDs.push_back(nFID);
+    for( size_t i = 0; i < m_aoFieldColumns.size(); i++ )
+        m_aoFieldColumns[i].AddRow(iRow);
+    for( size_t i = 0; i < m_aoGeomFieldColumns.size(); i++ )
+        m_aoGeomFieldColumns[i].AddRow(iRow);
+}
+
+/**
+ * \brief Add a copy of a feature.
+ *
+ * @param poFeature a feature of the same definition as the batch.
+ *
+ * @since GDAL 2.3
+ */
+
+void OGRFeatureBatch::AddFeature( const OGRFeature *poFeature )
+{
+    AddFeature(poFeature->GetFID());
+
+    for( int iField = 0;
+         iField < static_cast<int>(m_aoFieldColumns.size()); iField++ )
+    {
+        if( poFeature->IsFieldSet(iField) )
+            SetField(iField, poFeature->GetRawFieldRef(iField));
+    }
+
+    for( int iGeomField = 0;
+         iGeomField < static_cast<int>(m_aoGeomFieldColumns.size());
+         iGeomField++ )
+    {
+        SetGeomField(iGeomField, poFeature->GetGeomFieldRef(iGeomField));
+    }
+}
+
+/************************************************************************/
+/*                        GetConversionFeature()                        */
+/************************************************************************/
+
+// Values that are not of the type of their field are converted through
+// a feature, so that the conversions are the ones of OGRFeature.
+OGRFeature *OGRFeatureBatch::GetConversionFeature()
+{
+    if( m_poConversionFeature == nullptr )
+        m_poConversionFeature = new OGRFeature(m_poDefn);
+    return m_poConversionFeature;
+}
+
+/************************************************************************/
+/*                   SetFieldFromConversionFeature()                    */
+/************************************************************************/
+
+void OGRFeatureBatch::SetFieldFromConversionFeature( int iField )
+{
+    if( m_poConversionFeature->IsFieldSet(iField) )
+        SetField(iField, m_poConversionFeature->GetRawFieldRef(iField));
+    m_poConversionFeature->UnsetField(iField);
+}
+
+/************************************************************************/
+/*                            SetFieldNull()                            */
+/************************************************************************/
+
+/**
+ * \brief Set a field of the last added feature to null.
+ *
+ * @param iField the field to set.
+ *
+ * @since GDAL 2.3
+ */
+
+void OGRFeatureBatch::SetFieldNull( int iField )
+{
+    m_aoFieldColumns[iField].SetNull(m_nFeatureCount - 1);
+}
+
+/************************************************************************/
+/*                              SetField()                              */
+/************************************************************************/
+
+/**
+ * \brief Set a field of the last added feature.
+ *
+ * The value is converted as by OGRFeature::SetField() if it is not of the
+ * type of the field. A field should be set at most once per feature.
+ *
+ * @param iField the field to set.
+ * @param nValue the value.
+ *
+ * @since GDAL 2.3
+ */
+
+void OGRFeatureBatch::SetField( int iField, int nValue )
+{
+    Column& oColumn = m_aoFieldColumns[iField];
+    const int iRow = m_nFeatureCount - 1;
+    if( oColumn.m_eType == OFTInteger &&
+        m_poDefn->GetFieldDefn(iField)->GetSubType() == OFSTNone )
+    {
+        memcpy(oColumn.SetValue(iRow), &nValue, sizeof(nValue));
+    }
+    else if( oColumn.m_eType == OFTInteger64 )
+    {
+        const GIntBig nValue64 = nValue;
+        memcpy(oColumn.SetValue(iRow), &nValue64, sizeof(nValue64));
+    }
+    else if( oColumn.m_eType == OFTReal )
+    {
+        const double dfValue = nValue;
+        memcpy(oColumn.SetValue(iRow), &dfValue, sizeof(dfValue));
+    }
+    else
+    {
+        GetConversionFeature()->SetField(iField, nValue);
+        SetFieldFromConversionFeature(iField);
+    }
+}
+
+/**
+ * \brief Set a field of the last added feature.
+ *
+ * @see SetField(int, int)
+ *
+ * @since GDAL 2.3
+ */
+
+void OGRFeatureBatch::SetField( int iField, GIntBig nValue )
+{
+    Column& oColumn = m_aoFieldColumns[iField];
+    if( oColumn.m_eType == OFTInteger64 )
+    {
+        memcpy(oColumn.SetValue(m_nFeatureCount - 1), &nValue,
+               sizeof(nValue));
+    }
+    else
+    {
+        GetConversionFeature()->SetField(iField, nValue);
+        SetFieldFromConversionFeature(iField);
+    }
+}
+
+/**
+ * \brief Set a field of the last added feature.
+ *
+ * @see SetField(int, int)
+ *
+ * @since GDAL 2.3
+ */
+
+void OGRFeatureBatch::SetField( int iField, double dfValue )
+{
+    Column& oColumn = m_aoFieldColumns[iField];
+    if( oColumn.m_eType == OFTReal )
+    {
+        memcpy(oColumn.SetValue(m_nFeatureCount - 1), &dfValue,
+               sizeof(dfValue));
+    }
+    else
+    {
+        GetConversionFeature()->SetField(iField, dfValue);
+        SetFieldFromConversionFeature(iField);
+    }
+}
+
+/**
+ * \brief Set a field of the last added feature.
+ *
+ * @see SetField(int, int)
+ *
+ * @since GDAL 2.3
+ */
+
+void OGRFeatureBatch::SetField( int iField, const char *pszValue )
+{
+    Column& oColumn = m_aoFieldColumns[iField];
+    if( oColumn.m_eType == OFTString )
+    {
+        if( pszValue == nullptr )
+            pszValue = "";
+        const size_t nLen = strlen(pszValue) + 1;
+        memcpy(oColumn.SetValues(m_nFeatureCount - 1, nLen), pszValue, nLen);
+    }
+    else
+    {
+        GetConversionFeature()->SetField(iField, pszValue);
+        SetFieldFromConversionFeature(iField);
+    }
+}
+
+/**
+ * \brief Set a field of the last added feature.
+ *
+ * @see SetField(int, int)
+ *
+ * @since GDAL 2.3
+ */
+
+void OGRFeatureBatch::SetField( int iField, int nBytes,
+                                const GByte *pabyData )
+{
+    Column& oColumn = m_aoFieldColumns[iField];
+    if( oColumn.m_eType == OFTBinary )
+    {
+        GByte *pabyDst = oColumn.SetValues(m_nFeatureCount - 1, nBytes);
+        if( nBytes > 0 )
+            memcpy(pabyDst, pabyData, nBytes);
+    }
+    else
+    {
+        GetConversionFeature()->SetField(iField, nBytes,
+                                         const_cast<GByte*>(pabyData));
+        SetFieldFromConversionFeature(iField);
+    }
+}
+
+/**
+ * \brief Set a field of the last added feature.
+ *
+ * @see SetField(int, int)
+ *
+ * @since GDAL 2.3
+ */
+
+void OGRFeatureBatch::SetField( int iField, int nYear, int nMonth, int nDay,
+                                int nHour, int nMinute, float fSecond,
+                                int nTZFlag )
+{
+    GetConversionFeature()->SetField(iField, nYear, nMonth, nDay,
+                                     nHour, nMinute, fSecond, nTZFlag);
+    SetFieldFromConversionFeature(iField);
+}
+
+/**
+ * \brief Set a field of the last added feature from a raw field.
+ *
+ * The raw field must be of the type of the field. Unset values are ignored,
+ * and null values set the field to null.
+ *
+ * @see SetField(int, int)
+ *
+ * @since GDAL 2.3
+ */
+
+void OGRFeatureBatch::SetField( int iField, const OGRField *psValue )
+{
+    if( OGR_RawField_IsUnset(psValue) )
+        return;
+    if( OGR_RawField_IsNull(psValue) )
+    {
+        SetFieldNull(iField);
+        return;
+    }
+
+    Column& oColumn = m_aoFieldColumns[iField];
+    const int iRow = m_nFeatureCount - 1;
+    switch( oColumn.m_eType )
+    {
+        case OFTInteger:
+            memcpy(oColumn.SetValue(iRow), &psValue->Integer, sizeof(int));
+            break;
+        case OFTInteger64:
+            memcpy(oColumn.SetValue(iRow), &psValue->Integer64,
+                   sizeof(GIntBig));
+            break;
+        case OFTReal:
+            memcpy(oColumn.SetValue(iRow), &psValue->Real, sizeof(double));
+            break;
+        case OFTDate:
+        case OFTTime:
+        case OFTDateTime:
+            memcpy(oColumn.SetValue(iRow), psValue, sizeof(OGRField));
+            break;
+        case OFTString:
+        {
+            const size_t nLen = strlen(psValue->String) + 1;
+            memcpy(oColumn.SetValues(iRow, nLen), psValue->String, nLen);
+            break;
+        }
+        case OFTBinary:
+        {
+            GByte *pabyDst = oColumn.SetValues(iRow, psValue->Binary.nCount);
+            if( psValue->Binary.nCount > 0 )
+                memcpy(pabyDst, psValue->Binary.paData,
+                       psValue->Binary.nCount);
+            break;
+        }
+        case OFTIntegerList:
+        {
+            const int nCount = psValue->IntegerList.nCount;
+            GByte *pabyDst = oColumn.SetValues(iRow, nCount);
+            if( nCount > 0 )
+                memcpy(pabyDst, psValue->IntegerList.paList,
+                       nCount * sizeof(int));
+            break;
+        }
+        case OFTInteger64List:
+        {
+            const int nCount = psValue->Integer64List.nCount;
+            GByte *pabyDst = oColumn.SetValues(iRow, nCount);
+            if( nCount > 0 )
+                memcpy(pabyDst, psValue->Integer64List.paList,
+                       nCount * sizeof(GIntBig));
+            break;
+        }
+        case OFTRealList:
+        {
+            const int nCount = psValue->RealList.nCount;
+            GByte *pabyDst = oColumn.SetValues(iRow, nCount);
+            if( nCount > 0 )
+                memcpy(pabyDst, psValue->RealList.paList,
+                       nCount * sizeof(double));
+            break;
+        }
+        case OFTStringList:
+        {
+            size_t nTotalLen = 0;
+            for( int i = 0; i < psValue->StringList.nCount; i++ )
+                nTotalLen += strlen(psValue->StringList.paList[i]) + 1;
+            GByte *pabyDst = oColumn.SetValues(iRow, nTotalLen);
+            for( int i = 0; i < psValue->StringList.nCount; i++ )
+            {
+                const size_t nLen = strlen(psValue->StringList.paList[i]) + 1;
+                memcpy(pabyDst, psValue->StringList.paList[i], nLen);
+                pabyDst += nLen;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+/************************************************************************/
+/*                            SetGeomField()                            */
+/************************************************************************/
+
+/**
+ * \brief Set a geometry field of the last added feature.
+ *
+ * @param iGeomField the geometry field to set.
+ * @param poGeom the geometry, which is exported as ISO WKB. NULL is ignored.
+ *
+ * @since GDAL 2.3
+ */
+
+void OGRFeatureBatch::SetGeomField( int iGeomField, const OGRGeometry *poGeom )
+{
+    if( poGeom == nullptr )
+        return;
+    GByte *pabyWkb = m_aoGeomFieldColumns[iGeomField].SetValues(
+        m_nFeatureCount - 1, poGeom->WkbSize());
+    poGeom->exportToWkb(wkbNDR, pabyWkb, wkbVariantIso);
+}
+
+/************************************************************************/
+/*                          SetGeomFieldWkb()                           */
+/************************************************************************/
+
+/**
+ * \brief Set a geometry field of the last added feature from WKB.
+ *
+ * @param iGeomField the geometry field to set.
+ * @param pabyWkb the geometry as ISO WKB, which is copied.
+ * @param nWkbSize the size of pabyWkb in bytes.
+ *
+ * @since GDAL 2.3
+ */
+
+void OGRFeatureBatch::SetGeomFieldWkb( int iGeomField, const GByte *pabyWkb,
+                                       size_t nWkbSize )
+{
+    GByte *pabyDst = m_aoGeomFieldColumns[iGeomField].SetValues(
+        m_nFeatureCount - 1, nWkbSize);
+    if( nWkbSize > 0 )
+        memcpy(pabyDst, pabyWkb, nWkbSize);
+}
@@ -128,6 +128,12 @@ class OGRCSVLayer : public OGRLayer
     bool                bEmptyStringNull;
 
     char              **GetNextLineTokens();
+    int                 ParseBooleanToken( OGRFieldDefn *poFieldDefn,
+                                           const char *pszToken );
+    bool                CheckNumericToken( OGRFieldDefn *poFieldDefn,
+                                           char *pszToken );
+    void                CheckStringToken( OGRFieldDefn *poFieldDefn,
+                                          const char *pszToken );
 
     static bool         Matches( const char *pszFieldName,
                                  char **papszPossibleNames );
@@ -156,6 +162,8 @@ class OGRCSVLayer : public OGRLayer
 
     void                ResetReading() override;
     OGRFeature         *GetNextFeature() override;
+    virtual int         GetNextFeatureBatch( OGRFeatureBatch *poBatch,
+                                             int nMaxFeatures ) override;
     virtual OGRFeature *GetFeature( GIntBig nFID ) override;
 
     OGRFeatureDefn     *GetLayerDefn() override { return poFeatureDefn; }
@@ -1407,6 +1407,134 @@ OGRFeature *OGRCSVLayer::GetFeature(GIntBig nFID)
     return GetNextUnfilteredFeature();
 }
 
+/************************************************************************/
+/*                         ParseBooleanToken()                          */
+/*                                                                      */
+/*      Return 1 or 0 for a true or false value, or -1 (with a warning) */
+/*      for an invalid one.                                             */
+/************************************************************************/
+
+int OGRCSVLayer::ParseBooleanToken( OGRFieldDefn *poFieldDefn,
+                                    const char *pszToken )
+
+{
+    if( OGRCSVIsTrue(pszToken) || strcmp(pszToken, "1") == 0 )
+        return 1;
+    if( OGRCSVIsFalse(pszToken) || strcmp(pszToken, "0") == 0 )
+        return 0;
+    if( !bWarningBadTypeOrWidth )
+    {
+        bWarningBadTypeOrWidth = true;
+        CPLError(
+            CE_Warning, CPLE_AppDefined,
+            "Invalid value type found in record %d for field %s. "
+            "This warning will no longer be emitted",
+            nNextFID, poFieldDefn->GetNameRef());
+    }
+    return -1;
+}
+
+/************************************************************************/
+/*                         CheckNumericToken()                          */
+/*                                                                      */
+/*      Return whether a token can be assigned to a numeric field, and  */
+/*      warn about values that do not fit it. The decimal comma of      */
+/*      semicolon-delimited files is replaced in place.                 */
+/************************************************************************/
+
+bool OGRCSVLayer::CheckNumericToken( OGRFieldDefn *poFieldDefn,
+                                     char *pszToken )
+
+{
+    const OGRFieldType eFieldType = poFieldDefn->GetType();
+    if( chDelimiter == ';' && eFieldType == OFTReal )
+    {
+        char *chComma = strchr(pszToken, ',');
+        if( chComma )
+            *chComma = '.';
+    }
+    const CPLValueType eType = CPLGetValueType(pszToken);
+    if( eType == CPL_VALUE_INTEGER || eType == CPL_VALUE_REAL )
+    {
+        if( !bWarningBadTypeOrWidth &&
+            (eFieldType == OFTInteger ||
+             eFieldType == OFTInteger64) &&
+            eType == CPL_VALUE_REAL )
+        {
+            bWarningBadTypeOrWidth = true;
+            CPLError(CE_Warning, CPLE_AppDefined,
+                     "Invalid value type found in record %d for "
+                     "field %s. "
+                     "This warning will no longer be emitted",
+                     nNextFID, poFieldDefn->GetNameRef());
+        }
+        else if( !bWarningBadTypeOrWidth &&
+                 poFieldDefn->GetWidth() > 0 &&
+                 static_cast<int>(strlen(pszToken)) >
+                     poFieldDefn->GetWidth() )
+        {
+            bWarningBadTypeOrWidth = true;
+            CPLError(CE_Warning, CPLE_AppDefined,
+                     "Value with a width greater than field width "
+                     "found in record %d for field %s. "
+                     "This warning will no longer be emitted",
+                     nNextFID, poFieldDefn->GetNameRef());
+        }
+        else if( !bWarningBadTypeOrWidth &&
+                 eType == CPL_VALUE_REAL &&
+                 poFieldDefn->GetWidth() > 0)
+        {
+            const char *pszDot = strchr(pszToken, '.');
+            const int nPrecision =
+                pszDot != nullptr
+                    ? static_cast<int>(strlen(pszDot + 1))
+                    : 0;
+            if( nPrecision > poFieldDefn->GetPrecision() )
+            {
+                bWarningBadTypeOrWidth = true;
+                CPLError(CE_Warning, CPLE_AppDefined,
+                         "Value with a precision greater than "
+                         "field precision found in record %d for "
+                         "field %s. "
+                         "This warning will no longer be emitted",
+                         nNextFID, poFieldDefn->GetNameRef());
+            }
+        }
+        return true;
+    }
+
+    if( !bWarningBadTypeOrWidth )
+    {
+        bWarningBadTypeOrWidth = true;
+        CPLError(
+            CE_Warning, CPLE_AppDefined,
+            "Invalid value type found in record %d for field "
+            "%s. This warning will no longer be emitted.",
+            nNextFID, poFieldDefn->GetNameRef());
+    }
+    return false;
+}
+
+/************************************************************************/
+/*                          CheckStringToken()                          */
+/************************************************************************/
+
+void OGRCSVLayer::CheckStringToken( OGRFieldDefn *poFieldDefn,
+                                    const char *pszToken )
+
+{
+    if( !bWarningBadTypeOrWidth && poFieldDefn->GetWidth() > 0 &&
+        static_cast<int>(strlen(pszToken)) > poFieldDefn->GetWidth() )
+    {
+        bWarningBadTypeOrWidth = true;
+        CPLError(CE_Warning, CPLE_AppDefined,
+                 "Value with a width greater than field width "
+                 "found in record %d for field %s. "
+                 "This warning will no longer be emitted",
+                 nNextFID, poFieldDefn->GetNameRef());
+    }
+}
+
 /************************************************************************/
 /*                      GetNextUnfilteredFeature()                      */
 /************************************************************************/
@@ -1496,99 +1624,19 @@ OGRFeature *OGRCSVLayer::GetNextUnfilteredFeature()
         {
             if( papszTokens[iAttr][0] != '\0' && !poFieldDefn->IsIgnored() )
             {
-                if( OGRCSVIsTrue(papszTokens[iAttr]) ||
-                    strcmp(papszTokens[iAttr], "1") == 0 )
-                {
-                    poFeature->SetField(iOGRField, 1);
-                }
-                else if( OGRCSVIsFalse(papszTokens[iAttr]) ||
-                         strcmp(papszTokens[iAttr], "0") == 0 )
-                {
-                    poFeature->SetField(iOGRField, 0);
-                }
-                else if( !bWarningBadTypeOrWidth )
-                {
-                    bWarningBadTypeOrWidth = true;
-                    CPLError(
-                        CE_Warning, CPLE_AppDefined,
-                        "Invalid value type found in record %d for field %s. "
-                        "This warning will no longer be emitted",
-                        nNextFID, poFieldDefn->GetNameRef());
-                }
+                const int nValue =
+                    ParseBooleanToken(poFieldDefn, papszTokens[iAttr]);
+                if( nValue >= 0 )
+                    poFeature->SetField(iOGRField, nValue);
             }
         }
         else if( eFieldType == OFTReal || eFieldType == OFTInteger ||
                  eFieldType == OFTInteger64 )
         {
-            if( papszTokens[iAttr][0] != '\0' && !poFieldDefn->IsIgnored() )
+            if( papszTokens[iAttr][0] != '\0' && !poFieldDefn->IsIgnored() &&
+                CheckNumericToken(poFieldDefn, papszTokens[iAttr]) )
             {
-                if( chDelimiter == ';' && eFieldType == OFTReal )
-                {
-                    char *chComma = strchr(papszTokens[iAttr], ',');
-                    if( chComma )
-                        *chComma = '.';
-                }
-                eType = CPLGetValueType(papszTokens[iAttr]);
-                if( eType == CPL_VALUE_INTEGER || eType == CPL_VALUE_REAL )
-                {
-                    poFeature->SetField(iOGRField, papszTokens[iAttr]);
-                    if( !bWarningBadTypeOrWidth &&
-                        (eFieldType == OFTInteger ||
-                         eFieldType == OFTInteger64) &&
-                        eType == CPL_VALUE_REAL )
-                    {
-                        bWarningBadTypeOrWidth = true;
-                        CPLError(CE_Warning, CPLE_AppDefined,
-                                 "Invalid value type found in record %d for "
-                                 "field %s. "
-                                 "This warning will no longer be emitted",
-                                 nNextFID, poFieldDefn->GetNameRef());
-                    }
-                    else if( !bWarningBadTypeOrWidth &&
-                             poFieldDefn->GetWidth() > 0 &&
-                             static_cast<int>(strlen(papszTokens[iAttr])) >
-                                 poFieldDefn->GetWidth() )
-                    {
-                        bWarningBadTypeOrWidth = true;
-                        CPLError(CE_Warning, CPLE_AppDefined,
-                                 "Value with a width greater than field width "
-                                 "found in record %d for field %s. "
-                                 "This warning will no longer be emitted",
-                                 nNextFID, poFieldDefn->GetNameRef());
-                    }
-                    else if( !bWarningBadTypeOrWidth &&
-                             eType == CPL_VALUE_REAL &&
-                             poFieldDefn->GetWidth() > 0)
-                    {
-                        const char *pszDot = strchr(papszTokens[iAttr], '.');
-                        const int nPrecision =
-                            pszDot != nullptr
-                                ? static_cast<int>(strlen(pszDot + 1))
-                                : 0;
-                        if( nPrecision > poFieldDefn->GetPrecision() )
-                        {
-                            bWarningBadTypeOrWidth = true;
-                            CPLError(CE_Warning, CPLE_AppDefined,
-                                     "Value with a precision greater than "
-                                     "field precision found in record %d for "
-                                     "field %s. "
-                                     "This warning will no longer be emitted",
-                                     nNextFID, poFieldDefn->GetNameRef());
-                        }
-                    }
-                }
-                else
-                {
-                    if( !bWarningBadTypeOrWidth )
-                    {
-                        bWarningBadTypeOrWidth = true;
-                        CPLError(
-                            CE_Warning, CPLE_AppDefined,
-                            "Invalid value type found in record %d for field "
-                            "%s. This warning will no longer be emitted.",
-                            nNextFID, poFieldDefn->GetNameRef());
-                    }
-                }
+                poFeature->SetField(iOGRField, papszTokens[iAttr]);
             }
         }
         else if( eFieldType != OFTString )
@@ -1617,17 +1665,7 @@ OGRFeature *OGRCSVLayer::GetNextUnfilteredFeature()
             else
             {
                 poFeature->SetField(iOGRField, papszTokens[iAttr]);
-                if( !bWarningBadTypeOrWidth && poFieldDefn->GetWidth() > 0 &&
-                    static_cast<int>(strlen(papszTokens[iAttr])) >
-                        poFieldDefn->GetWidth() )
-                {
-                    bWarningBadTypeOrWidth = true;
-                    CPLError(CE_Warning, CPLE_AppDefined,
-                             "Value with a width greater than field width "
-                             "found in record %d for field %s. "
-                             "This warning will no longer be emitted",
-                             nNextFID, poFieldDefn->GetNameRef());
-                }
+                CheckStringToken(poFieldDefn, papszTokens[iAttr]);
             }
         }
 
@@ -1772,6 +1810,89 @@ OGRFeature *OGRCSVLayer::GetNextFeature()
     }
 }
 
+/************************************************************************/
+/*                        GetNextFeatureBatch()                         */
+/************************************************************************/
+
+int OGRCSVLayer::GetNextFeatureBatch( OGRFeatureBatch *poBatch,
+                                      int nMaxFeatures )
+
+{
+    // Only plain attribute tables are read directly into the batch. The
+    // other cases go through GetNextFeature().
+    bool bFastPath = m_poFilterGeom == nullptr && m_poAttrQuery == nullptr &&
+                     !bIsEurostatTSV && !bKeepSourceColumns &&
+                     !bHiddenWKTColumn &&
+                     poFeatureDefn->GetGeomFieldCount() == 0 &&
+                     poFeatureDefn->GetFieldCount() == nCSVFieldCount;
+    const int nFieldCount = poFeatureDefn->GetFieldCount();
+    for( int iField = 0; bFastPath && iField < nFieldCount; iField++ )
+    {
+        const OGRFieldType eFieldType =
+            poFeatureDefn->GetFieldDefn(iField)->GetType();
+        bFastPath = eFieldType == OFTString || eFieldType == OFTInteger ||
+                    eFieldType == OFTInteger64 || eFieldType == OFTReal;
+    }
+    if( !bFastPath )
+        return OGRLayer::GetNextFeatureBatch(poBatch, nMaxFeatures);
+
+    if( bNeedRewindBeforeRead )
+        ResetReading();
+
+    poBatch->Reset(poFeatureDefn);
+    while( fpCSV != nullptr && poBatch->GetFeatureCount() < nMaxFeatures )
+    {
+        char **papszTokens = GetNextLineTokens();
+        if( papszTokens == nullptr )
+            break;
+
+        poBatch->AddFeature(nNextFID);
+
+        const int nAttrCount =
+            std::min(CSLCount(papszTokens), nCSVFieldCount);
+        for( int iField = 0; iField < nAttrCount; iField++ )
+        {
+            OGRFieldDefn *poFieldDefn = poFeatureDefn->GetFieldDefn(iField);
+            if( poFieldDefn->IsIgnored() )
+                continue;
+            char *pszToken = papszTokens[iField];
+            if( poFieldDefn->GetType() == OFTString )
+            {
+                if( bEmptyStringNull && pszToken[0] == '\0' )
+                {
+                    poBatch->SetFieldNull(iField);
+                }
+                else
+                {
+                    poBatch->SetField(iField, pszToken);
+                    CheckStringToken(poFieldDefn, pszToken);
+                }
+            }
+            else if( pszToken[0] == '\0' )
+            {
+                continue;
+            }
+            else if( poFieldDefn->GetSubType() == OFSTBoolean )
+            {
+                const int nValue = ParseBooleanToken(poFieldDefn, pszToken);
+                if( nValue >= 0 )
+                    poBatch->SetField(iField, nValue);
+            }
+            else if( CheckNumericToken(poFieldDefn, pszToken) )
+            {
+                poBatch->SetField(iField, pszToken);
+            }
+        }
+
+        CSLDestroy(papszTokens);
+
+        nNextFID++;
+        m_nFeaturesRead++;
+    }
+
+    return poBatch->GetFeatureCount();
+}
+
 /************************************************************************/
 /*                           TestCapability()                           */
 /************************************************************************/
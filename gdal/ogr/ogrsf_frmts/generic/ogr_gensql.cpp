@@ -30,10 +30,16 @@
 #include "swq.h"
 #include "ogr_p.h"
 #include "ogr_gensql.h"
+#include "ogr_attrind.h"
 #include "cpl_string.h"
 #include "ogr_api.h"
 #include "cpl_time.h"
+#include "cpl_multiproc.h"
+#include "cpl_worker_thread_pool.h"
 #include <algorithm>
+#include <limits>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 //! @cond Doxygen_Suppress
@@ -81,6 +87,1750 @@ int OGRGenSQLResultsLayerHasSpecialField(swq_expr_node* expr,
     return FALSE;
 }
 
+/************************************************************************/
+/*                       GetSQLMaxMemoryOption()                        */
+/*                                                                      */
+/*      Memory budget of the hash joins and external sorts, from a      */
+/*      configuration option or a quarter of the usable RAM.            */
+/************************************************************************/
+
+static GIntBig GetSQLMaxMemoryOption( const char* pszKey )
+{
+    const char *pszMaxMemory = CPLGetConfigOption(pszKey, nullptr);
+    if( pszMaxMemory != nullptr )
+        return CPLAtoGIntBig(pszMaxMemory);
+
+    const GIntBig nMaxMemory = CPLGetUsablePhysicalRAM() / 4;
+    if( nMaxMemory <= 0 )
+        return 100 * 1024 * 1024;
+    return nMaxMemory;
+}
+
+/************************************************************************/
+/*                          OGRGenSQLJoinHash                           */
+/*                                                                      */
+/*      In-memory hash table of the features of a secondary layer,      */
+/*      indexed on the value of its join key, so that an equality       */
+/*      JOIN can be resolved with one scan of the secondary layer       */
+/*      instead of one filtered scan per source feature.                */
+/************************************************************************/
+
+class OGRGenSQLJoinHash
+{
+    typedef enum
+    {
+        KEY_INTEGER,
+        KEY_REAL,
+        KEY_STRING
+    } KeyType;
+
+    struct Entry
+    {
+        OGRFeature *poFeature;
+        GIntBig     nFID;
+    };
+
+    OGRLayer   *m_poJoinLayer;
+    int         m_iSrcField;
+    int         m_iJoinField;
+    KeyType     m_eKeyType;
+
+    // When the features of the secondary layer do not fit in the allowed
+    // memory, only their FID is kept and they are fetched again with
+    // GetFeature() on a match.
+    bool        m_bFIDOnly;
+    std::unordered_map<std::string, Entry> m_oMap;
+
+                OGRGenSQLJoinHash( OGRLayer* poJoinLayer,
+                                   int iSrcField, int iJoinField,
+                                   KeyType eKeyType ) :
+                    m_poJoinLayer(poJoinLayer),
+                    m_iSrcField(iSrcField),
+                    m_iJoinField(iJoinField),
+                    m_eKeyType(eKeyType),
+                    m_bFIDOnly(false) {}
+
+    bool        GetKey( OGRFeature* poFeature, int iField,
+                        std::string& osKey ) const;
+    void        DropFeatures();
+    bool        Build();
+
+    CPL_DISALLOW_COPY_ASSIGN(OGRGenSQLJoinHash)
+
+  public:
+               ~OGRGenSQLJoinHash();
+
+    static OGRGenSQLJoinHash *Create( swq_join_def *psJoinInfo,
+                                      OGRLayer* poSrcLayer,
+                                      GDALDataset* poJoinDS,
+                                      OGRLayer* poJoinLayer );
+
+    OGRFeature *GetJoinedFeature( OGRFeature* poSrcFeat, bool* pbOwned );
+};
+
+/************************************************************************/
+/*                         ~OGRGenSQLJoinHash()                         */
+/************************************************************************/
+
+OGRGenSQLJoinHash::~OGRGenSQLJoinHash()
+
+{
+    DropFeatures();
+}
+
+/************************************************************************/
+/*                            DropFeatures()                            */
+/************************************************************************/
+
+void OGRGenSQLJoinHash::DropFeatures()
+
+{
+    for( auto& oIter : m_oMap )
+    {
+        delete oIter.second.poFeature;
+        oIter.second.poFeature = nullptr;
+    }
+}
+
+/************************************************************************/
+/*                               Create()                               */
+/*                                                                      */
+/*      Returns nullptr if the JOIN cannot be resolved with a hash      */
+/*      table, in which case GetFilterForJoin() must be used.           */
+/************************************************************************/
+
+OGRGenSQLJoinHash *OGRGenSQLJoinHash::Create( swq_join_def *psJoinInfo,
+                                              OGRLayer* poSrcLayer,
+                                              GDALDataset* poJoinDS,
+                                              OGRLayer* poJoinLayer )
+{
+    const char* pszJoinHash =
+        CPLGetConfigOption("OGR_SQL_JOIN_HASH", "AUTO");
+    if( EQUAL(pszJoinHash, "AUTO") )
+    {
+        // Drivers that translate attribute filters, for example into a
+        // WHERE clause run by a database, do not scan the secondary layer
+        // for each feature, and may compare strings with another case
+        // sensitivity than OGR SQL. So only use the hash table by default
+        // for drivers whose attribute filters are evaluated by OGR.
+        GDALDriver* poDriver = poJoinDS->GetDriver();
+        const char* pszDriverName =
+            poDriver ? poDriver->GetDescription() : "";
+        if( !EQUAL(pszDriverName, "Memory") &&
+            !EQUAL(pszDriverName, "ESRI Shapefile") &&
+            !EQUAL(pszDriverName, "CSV") )
+        {
+            return nullptr;
+        }
+    }
+    else if( !CPLTestBool(pszJoinHash) )
+        return nullptr;
+
+    // Reading the secondary layer would interfere with the reading of
+    // the main layer.
+    if( poJoinLayer == poSrcLayer )
+        return nullptr;
+
+/* -------------------------------------------------------------------- */
+/*      Only a single equality between a field of the main layer and    */
+/*      a field of the secondary layer can be hashed.                   */
+/* -------------------------------------------------------------------- */
+    swq_expr_node *poExpr = psJoinInfo->poExpr;
+    if( poExpr == nullptr ||
+        poExpr->eNodeType != SNT_OPERATION ||
+        poExpr->nOperation != SWQ_EQ ||
+        poExpr->nSubExprCount != 2 ||
+        poExpr->papoSubExpr[0]->eNodeType != SNT_COLUMN ||
+        poExpr->papoSubExpr[1]->eNodeType != SNT_COLUMN )
+    {
+        return nullptr;
+    }
+
+    swq_expr_node *poSrcNode = poExpr->papoSubExpr[0];
+    swq_expr_node *poJoinNode = poExpr->papoSubExpr[1];
+    if( poSrcNode->table_index != 0 )
+        std::swap(poSrcNode, poJoinNode);
+    if( poSrcNode->table_index != 0 ||
+        poJoinNode->table_index != psJoinInfo->secondary_table )
+    {
+        return nullptr;
+    }
+
+    OGRFeatureDefn *poSrcDefn = poSrcLayer->GetLayerDefn();
+    OGRFeatureDefn *poJoinDefn = poJoinLayer->GetLayerDefn();
+    const int iSrcField = poSrcNode->field_index;
+    const int iJoinField = poJoinNode->field_index;
+    if( iSrcField < 0 || iSrcField >= poSrcDefn->GetFieldCount() ||
+        iJoinField < 0 || iJoinField >= poJoinDefn->GetFieldCount() )
+    {
+        return nullptr;
+    }
+
+    // The nested loop can benefit from an attribute index.
+    if( poJoinLayer->GetIndex() != nullptr &&
+        poJoinLayer->GetIndex()->GetFieldIndex(iJoinField) != nullptr )
+    {
+        return nullptr;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Determine how the key values must be compared to follow the     */
+/*      OGR SQL semantics of the = operator.                            */
+/* -------------------------------------------------------------------- */
+    const OGRFieldType eSrcType =
+        poSrcDefn->GetFieldDefn(iSrcField)->GetType();
+    const OGRFieldType eJoinType =
+        poJoinDefn->GetFieldDefn(iJoinField)->GetType();
+    const bool bSrcIsInt = eSrcType == OFTInteger || eSrcType == OFTInteger64;
+    const bool bJoinIsInt =
+        eJoinType == OFTInteger || eJoinType == OFTInteger64;
+
+    KeyType eKeyType;
+    if( bSrcIsInt && bJoinIsInt )
+        eKeyType = KEY_INTEGER;
+    else if( (bSrcIsInt || eSrcType == OFTReal) &&
+             (bJoinIsInt || eJoinType == OFTReal) )
+        eKeyType = KEY_REAL;
+    else if( eSrcType == OFTString && eJoinType == OFTString )
+        eKeyType = KEY_STRING;
+    else
+        return nullptr;
+
+    OGRGenSQLJoinHash* poHash =
+        new OGRGenSQLJoinHash(poJoinLayer, iSrcField, iJoinField, eKeyType);
+    if( !poHash->Build() )
+    {
+        delete poHash;
+        return nullptr;
+    }
+    return poHash;
+}
+
+/************************************************************************/
+/*                               GetKey()                               */
+/************************************************************************/
+
+bool OGRGenSQLJoinHash::GetKey( OGRFeature* poFeature, int iField,
+                                std::string& osKey ) const
+{
+    // NULL keys never match.
+    if( !poFeature->IsFieldSetAndNotNull(iField) )
+        return false;
+
+    switch( m_eKeyType )
+    {
+        case KEY_INTEGER:
+        {
+            const GIntBig nVal = poFeature->GetFieldAsInteger64(iField);
+            osKey.assign(reinterpret_cast<const char*>(&nVal), sizeof(nVal));
+            break;
+        }
+
+        case KEY_REAL:
+        {
+            double dfVal = poFeature->GetFieldAsDouble(iField);
+            if( CPLIsNan(dfVal) )
+                return false;
+            if( dfVal == 0.0 )
+                dfVal = 0.0;  // -0 == 0
+            osKey.assign(reinterpret_cast<const char*>(&dfVal),
+                         sizeof(dfVal));
+            break;
+        }
+
+        case KEY_STRING:
+        {
+            // String equality is case insensitive in OGR SQL.
+            osKey = poFeature->GetFieldAsString(iField);
+            for( size_t i = 0; i < osKey.size(); i++ )
+                osKey[i] = static_cast<char>(
+                    tolower(static_cast<unsigned char>(osKey[i])));
+            break;
+        }
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                       EstimateFeatureMemory()                        */
+/************************************************************************/
+
+static GIntBig EstimateFeatureMemory( OGRFeature* poFeature )
+{
+    OGRFeatureDefn *poDefn = poFeature->GetDefnRef();
+    GIntBig nSize = static_cast<GIntBig>(sizeof(OGRFeature)) +
+        poDefn->GetFieldCount() * static_cast<GIntBig>(sizeof(OGRField)) +
+        poDefn->GetGeomFieldCount() * static_cast<GIntBig>(sizeof(void*));
+
+    for( int iField = 0; iField < poDefn->GetFieldCount(); iField++ )
+    {
+        if( !poFeature->IsFieldSetAndNotNull(iField) )
+            continue;
+        const OGRField *psField = poFeature->GetRawFieldRef(iField);
+        switch( poDefn->GetFieldDefn(iField)->GetType() )
+        {
+            case OFTString:
+                nSize += strlen(psField->String) + 1;
+                break;
+            case OFTBinary:
+                nSize += psField->Binary.nCount;
+                break;
+            case OFTIntegerList:
+                nSize += psField->IntegerList.nCount * sizeof(int);
+                break;
+            case OFTInteger64List:
+                nSize += psField->Integer64List.nCount * sizeof(GIntBig);
+                break;
+            case OFTRealList:
+                nSize += psField->RealList.nCount * sizeof(double);
+                break;
+            case OFTStringList:
+                for( int i = 0; i < psField->StringList.nCount; i++ )
+                {
+                    nSize += sizeof(char*) +
+                             strlen(psField->StringList.paList[i]) + 1;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    for( int iGeom = 0; iGeom < poDefn->GetGeomFieldCount(); iGeom++ )
+    {
+        OGRGeometry *poGeom = poFeature->GetGeomFieldRef(iGeom);
+        if( poGeom != nullptr )
+            nSize += poGeom->WkbSize();
+    }
+
+    return nSize;
+}
+
+/************************************************************************/
+/*                               Build()                                */
+/************************************************************************/
+
+bool OGRGenSQLJoinHash::Build()
+
+{
+    const GIntBig nMaxMemory =
+        GetSQLMaxMemoryOption("OGR_SQL_JOIN_HASH_MAX_MEMORY");
+
+    const bool bCanFetchByFID =
+        CPL_TO_BOOL(m_poJoinLayer->TestCapability(OLCRandomRead));
+
+    m_poJoinLayer->SetAttributeFilter( nullptr );
+    m_poJoinLayer->ResetReading();
+
+    GIntBig nMemory = 0;
+    bool bHasNullFID = false;
+    std::string osKey;
+    OGRFeature *poFeature = nullptr;
+    while( (poFeature = m_poJoinLayer->GetNextFeature()) != nullptr )
+    {
+        if( !GetKey(poFeature, m_iJoinField, osKey) )
+        {
+            delete poFeature;
+            continue;
+        }
+
+        // Like the filtered scan, retain the first matching feature.
+        auto oIter = m_oMap.find(osKey);
+        if( oIter != m_oMap.end() )
+        {
+            delete poFeature;
+            continue;
+        }
+
+        Entry sEntry;
+        sEntry.nFID = poFeature->GetFID();
+        sEntry.poFeature = nullptr;
+        if( sEntry.nFID == OGRNullFID )
+            bHasNullFID = true;
+        nMemory += static_cast<GIntBig>(sizeof(Entry) + osKey.size()) + 32;
+
+        if( !m_bFIDOnly )
+        {
+            nMemory += EstimateFeatureMemory(poFeature);
+            if( nMemory > nMaxMemory )
+            {
+                if( !bCanFetchByFID || bHasNullFID )
+                {
+                    delete poFeature;
+                    CPLDebug("GenSQL",
+                             "Join on layer %s would require more than "
+                             CPL_FRMT_GIB " bytes of memory. "
+                             "Using filtered reads instead of a hash join",
+                             m_poJoinLayer->GetName(), nMaxMemory);
+                    m_poJoinLayer->ResetReading();
+                    return false;
+                }
+                CPLDebug("GenSQL",
+                         "Join on layer %s would require more than "
+                         CPL_FRMT_GIB " bytes of memory. "
+                         "Only caching feature ids",
+                         m_poJoinLayer->GetName(), nMaxMemory);
+                DropFeatures();
+                m_bFIDOnly = true;
+            }
+        }
+
+        if( m_bFIDOnly )
+        {
+            delete poFeature;
+            if( bHasNullFID )
+            {
+                m_poJoinLayer->ResetReading();
+                return false;
+            }
+        }
+        else
+        {
+            sEntry.poFeature = poFeature;
+        }
+
+        m_oMap[osKey] = sEntry;
+    }
+
+    m_poJoinLayer->ResetReading();
+    return true;
+}
+
+/************************************************************************/
+/*                          GetJoinedFeature()                          */
+/*                                                                      */
+/*      Returns the feature of the secondary layer matching the source  */
+/*      feature, or nullptr.  *pbOwned is set to whether the caller     */
+/*      must delete it.                                                 */
+/************************************************************************/
+
+OGRFeature *OGRGenSQLJoinHash::GetJoinedFeature( OGRFeature* poSrcFeat,
+                                                 bool* pbOwned )
+{
+    *pbOwned = false;
+
+    std::string osKey;
+    if( !GetKey(poSrcFeat, m_iSrcField, osKey) )
+        return nullptr;
+
+    auto oIter = m_oMap.find(osKey);
+    if( oIter == m_oMap.end() )
+        return nullptr;
+
+    if( !m_bFIDOnly )
+        return oIter->second.poFeature;
+
+    *pbOwned = true;
+    return m_poJoinLayer->GetFeature(oIter->second.nFID);
+}
+
+/************************************************************************/
+/*                      OGRGenSQLSerializeFeature()                     */
+/*                                                                      */
+/*      Append a compact binary representation of a feature to a        */
+/*      buffer.  It is only meant to be read back by the same process.  */
+/************************************************************************/
+
+template<class T> static void AppendRaw( std::vector<GByte>& abyBuffer,
+                                         const T& value )
+{
+    const GByte *pabyValue = reinterpret_cast<const GByte*>(&value);
+    abyBuffer.insert(abyBuffer.end(), pabyValue, pabyValue + sizeof(T));
+}
+
+static void AppendBytes( std::vector<GByte>& abyBuffer,
+                         const void* pData, GUInt32 nSize )
+{
+    AppendRaw(abyBuffer, nSize);
+    const GByte *pabyData = static_cast<const GByte*>(pData);
+    abyBuffer.insert(abyBuffer.end(), pabyData, pabyData + nSize);
+}
+
+static void AppendString( std::vector<GByte>& abyBuffer, const char* pszStr )
+{
+    // The terminating nul character is kept so that the string can be
+    // used in place when reading.
+    if( pszStr == nullptr )
+        AppendRaw(abyBuffer, static_cast<GUInt32>(0));
+    else
+        AppendBytes(abyBuffer, pszStr,
+                    static_cast<GUInt32>(strlen(pszStr) + 1));
+}
+
+static void OGRGenSQLSerializeFeature( OGRFeature* poFeature,
+                                       std::vector<GByte>& abyBuffer )
+{
+    OGRFeatureDefn *poDefn = poFeature->GetDefnRef();
+
+    AppendRaw(abyBuffer, poFeature->GetFID());
+    AppendString(abyBuffer, poFeature->GetStyleString());
+    AppendString(abyBuffer, poFeature->GetNativeData());
+    AppendString(abyBuffer, poFeature->GetNativeMediaType());
+
+    for( int iField = 0; iField < poDefn->GetFieldCount(); iField++ )
+    {
+        if( !poFeature->IsFieldSet(iField) )
+        {
+            abyBuffer.push_back(0);
+            continue;
+        }
+        if( poFeature->IsFieldNull(iField) )
+        {
+            abyBuffer.push_back(1);
+            continue;
+        }
+        abyBuffer.push_back(2);
+
+        const OGRField *psField = poFeature->GetRawFieldRef(iField);
+        switch( poDefn->GetFieldDefn(iField)->GetType() )
+        {
+            case OFTString:
+                AppendString(abyBuffer, psField->String);
+                break;
+            case OFTBinary:
+                AppendBytes(abyBuffer, psField->Binary.paData,
+                            psField->Binary.nCount);
+                break;
+            case OFTIntegerList:
+                AppendBytes(abyBuffer, psField->IntegerList.paList,
+                            psField->IntegerList.nCount * sizeof(int));
+                break;
+            case OFTInteger64List:
+                AppendBytes(abyBuffer, psField->Integer64List.paList,
+                            psField->Integer64List.nCount * sizeof(GIntBig));
+                break;
+            case OFTRealList:
+                AppendBytes(abyBuffer, psField->RealList.paList,
+                            psField->RealList.nCount * sizeof(double));
+                break;
+            case OFTStringList:
+                AppendRaw(abyBuffer,
+                          static_cast<GUInt32>(psField->StringList.nCount));
+                for( int i = 0; i < psField->StringList.nCount; i++ )
+                    AppendString(abyBuffer, psField->StringList.paList[i]);
+                break;
+            default:
+                // Integer, Integer64, Real, Date, Time and DateTime are
+                // stored by value.
+                AppendRaw(abyBuffer, *psField);
+                break;
+        }
+    }
+
+    for( int iGeom = 0; iGeom < poDefn->GetGeomFieldCount(); iGeom++ )
+    {
+        OGRGeometry *poGeom = poFeature->GetGeomFieldRef(iGeom);
+        if( poGeom == nullptr )
+        {
+            AppendRaw(abyBuffer, static_cast<GUInt32>(0));
+            continue;
+        }
+        const GUInt32 nWkbSize = static_cast<GUInt32>(poGeom->WkbSize());
+        AppendRaw(abyBuffer, nWkbSize);
+        const size_t nOffset = abyBuffer.size();
+        abyBuffer.resize(nOffset + nWkbSize);
+        poGeom->exportToWkb(wkbNDR, &abyBuffer[nOffset], wkbVariantIso);
+    }
+}
+
+/************************************************************************/
+/*                     OGRGenSQLDeserializeFeature()                    */
+/************************************************************************/
+
+template<class T> static T ReadRaw( const GByte*& pabyData )
+{
+    T value;
+    memcpy(&value, pabyData, sizeof(T));
+    pabyData += sizeof(T);
+    return value;
+}
+
+static const char* ReadString( const GByte*& pabyData )
+{
+    const GUInt32 nSize = ReadRaw<GUInt32>(pabyData);
+    if( nSize == 0 )
+        return nullptr;
+    const char *pszStr = reinterpret_cast<const char*>(pabyData);
+    pabyData += nSize;
+    return pszStr;
+}
+
+static OGRFeature *OGRGenSQLDeserializeFeature( OGRFeatureDefn* poDefn,
+                                                const GByte* pabyData )
+{
+    OGRFeature *poFeature = new OGRFeature(poDefn);
+
+    poFeature->SetFID(ReadRaw<GIntBig>(pabyData));
+    poFeature->SetStyleString(ReadString(pabyData));
+    poFeature->SetNativeData(ReadString(pabyData));
+    poFeature->SetNativeMediaType(ReadString(pabyData));
+
+    std::vector<char*> apszList;
+    for( int iField = 0; iField < poDefn->GetFieldCount(); iField++ )
+    {
+        const GByte nState = *(pabyData++);
+        if( nState == 0 )
+            continue;
+        if( nState == 1 )
+        {
+            poFeature->SetFieldNull(iField);
+            continue;
+        }
+
+        OGRField sField;
+        switch( poDefn->GetFieldDefn(iField)->GetType() )
+        {
+            case OFTString:
+                sField.String = const_cast<char*>(ReadString(pabyData));
+                break;
+            case OFTBinary:
+                sField.Binary.nCount = ReadRaw<GUInt32>(pabyData);
+                sField.Binary.paData = const_cast<GByte*>(pabyData);
+                pabyData += sField.Binary.nCount;
+                break;
+            case OFTIntegerList:
+            {
+                const GUInt32 nSize = ReadRaw<GUInt32>(pabyData);
+                sField.IntegerList.nCount =
+                    static_cast<int>(nSize / sizeof(int));
+                sField.IntegerList.paList = reinterpret_cast<int*>(
+                    const_cast<GByte*>(pabyData));
+                pabyData += nSize;
+                break;
+            }
+            case OFTInteger64List:
+            {
+                const GUInt32 nSize = ReadRaw<GUInt32>(pabyData);
+                sField.Integer64List.nCount =
+                    static_cast<int>(nSize / sizeof(GIntBig));
+                sField.Integer64List.paList = reinterpret_cast<GIntBig*>(
+                    const_cast<GByte*>(pabyData));
+                pabyData += nSize;
+                break;
+            }
+            case OFTRealList:
+            {
+                const GUInt32 nSize = ReadRaw<GUInt32>(pabyData);
+                sField.RealList.nCount =
+                    static_cast<int>(nSize / sizeof(double));
+                sField.RealList.paList = reinterpret_cast<double*>(
+                    const_cast<GByte*>(pabyData));
+                pabyData += nSize;
+                break;
+            }
+            case OFTStringList:
+            {
+                const GUInt32 nCount = ReadRaw<GUInt32>(pabyData);
+                apszList.resize(nCount + 1);
+                for( GUInt32 i = 0; i < nCount; i++ )
+                    apszList[i] = const_cast<char*>(ReadString(pabyData));
+                apszList[nCount] = nullptr;
+                sField.StringList.nCount = static_cast<int>(nCount);
+                sField.StringList.paList = &apszList[0];
+                break;
+            }
+            default:
+                sField = ReadRaw<OGRField>(pabyData);
+                break;
+        }
+        poFeature->SetField(iField, &sField);
+    }
+
+    for( int iGeom = 0; iGeom < poDefn->GetGeomFieldCount(); iGeom++ )
+    {
+        const GUInt32 nWkbSize = ReadRaw<GUInt32>(pabyData);
+        if( nWkbSize == 0 )
+            continue;
+        OGRGeometry *poGeom = nullptr;
+        OGRGeometryFactory::createFromWkb(
+            const_cast<GByte*>(pabyData), poDefn->GetGeomFieldDefn(iGeom)->GetSpatialRef(),
+            &poGeom, nWkbSize, wkbVariantIso);
+        poFeature->SetGeomFieldDirectly(iGeom, poGeom);
+        pabyData += nWkbSize;
+    }
+
+    return poFeature;
+}
+
+/************************************************************************/
+/*                        OGRGenSQLExternalSort                         */
+/*                                                                      */
+/*      Sorts the features of the source layer of an ORDER BY query     */
+/*      with a single sequential read.  Serialized features are         */
+/*      accumulated in memory, and each time the memory budget is       */
+/*      exceeded, they are sorted and written as a run in a temporary   */
+/*      file.  Reading then merges the runs.  When everything fits in   */
+/*      memory, no file is written.                                     */
+/*                                                                      */
+/*      The sorted features can only be read sequentially, so that      */
+/*      going back to a previous position, as GetFeature() may do,      */
+/*      merges the runs again from the start: O(N) per call.            */
+/************************************************************************/
+
+// Maximum number of runs merged at once.
+static const int MAX_MERGED_RUNS = 64;
+
+class OGRGenSQLExternalSort
+{
+    struct Run
+    {
+        CPLString   osFilename;
+        VSILFILE   *fp;
+        OGRFeature *poFeature;
+        OGRField   *pasKeys;
+        // Number of merges the features of the run went through.
+        int         nLevel;
+    };
+
+    OGRGenSQLResultsLayer *m_poLayer;
+    OGRFeatureDefn *m_poDefn;
+    const int       m_nOrderItems;
+    const GIntBig   m_nMaxMemory;
+
+    // Features not yet written in a run, or all the features when no
+    // run was needed.
+    std::vector<GByte>  m_abyBuffer;
+    std::vector<size_t> m_anOffsets;
+    std::vector<OGRField> m_asKeys;
+    std::vector<size_t> m_anOrder;
+    GIntBig             m_nMemory;
+
+    std::vector<Run>    m_asRuns;
+    std::vector<int>    m_anHeap;
+    std::vector<GByte>  m_abyRecord;
+
+    GIntBig             m_nNextIndex;
+
+    void        SortBuffer();
+    bool        WriteRun();
+    bool        OpenRun( int iRun );
+    void        CloseRun( Run& sRun );
+    void        CloseRuns();
+    void        StartMerge( int iFirstRun, int nRuns );
+    OGRFeature *PopMergedFeature();
+    bool        MergeRuns( int iFirstRun, int nRuns );
+    bool        ReadRunFeature( int iRun );
+    bool        IsAfter( int iRun1, int iRun2 );
+
+    CPL_DISALLOW_COPY_ASSIGN(OGRGenSQLExternalSort)
+
+  public:
+                OGRGenSQLExternalSort( OGRGenSQLResultsLayer* poLayer,
+                                       OGRFeatureDefn* poDefn,
+                                       int nOrderItems,
+                                       GIntBig nMaxMemory );
+               ~OGRGenSQLExternalSort();
+
+    bool        AddFeature( OGRFeature* poFeature );
+    bool        Finish();
+
+    // Whether some features were written in temporary files.
+    bool        HasRuns() const { return !m_asRuns.empty(); }
+
+    void        Rewind();
+    void        SetNextByIndex( GIntBig nIndex );
+    OGRFeature *GetNextFeature();
+};
+
+/************************************************************************/
+/*                        OGRGenSQLExternalSort()                       */
+/************************************************************************/
+
+OGRGenSQLExternalSort::OGRGenSQLExternalSort( OGRGenSQLResultsLayer* poLayer,
+                                              OGRFeatureDefn* poDefn,
+                                              int nOrderItems,
+                                              GIntBig nMaxMemory ) :
+    m_poLayer(poLayer),
+    m_poDefn(poDefn),
+    m_nOrderItems(nOrderItems),
+    m_nMaxMemory(nMaxMemory),
+    m_nMemory(0),
+    m_nNextIndex(0)
+{
+    m_poDefn->Reference();
+}
+
+/************************************************************************/
+/*                       ~OGRGenSQLExternalSort()                       */
+/************************************************************************/
+
+OGRGenSQLExternalSort::~OGRGenSQLExternalSort()
+
+{
+    if( !m_asKeys.empty() )
+        m_poLayer->FreeIndexFields(&m_asKeys[0], m_anOffsets.size(), false);
+
+    CloseRuns();
+
+    m_poDefn->Release();
+}
+
+/************************************************************************/
+/*                              CloseRun()                              */
+/*                                                                      */
+/*      Close and remove the file of a run.                             */
+/************************************************************************/
+
+void OGRGenSQLExternalSort::CloseRun( Run& sRun )
+
+{
+    if( sRun.fp != nullptr )
+        VSIFCloseL(sRun.fp);
+    sRun.fp = nullptr;
+    VSIUnlink(sRun.osFilename);
+    delete sRun.poFeature;
+    sRun.poFeature = nullptr;
+    if( sRun.pasKeys != nullptr )
+        m_poLayer->FreeIndexFields(sRun.pasKeys, 1);
+    sRun.pasKeys = nullptr;
+}
+
+/************************************************************************/
+/*                             CloseRuns()                              */
+/*                                                                      */
+/*      Close and remove all the run files.                             */
+/************************************************************************/
+
+void OGRGenSQLExternalSort::CloseRuns()
+
+{
+    for( size_t i = 0; i < m_asRuns.size(); i++ )
+        CloseRun(m_asRuns[i]);
+    m_asRuns.clear();
+    m_anHeap.clear();
+}
+
+/************************************************************************/
+/*                             AddFeature()                             */
+/************************************************************************/
+
+bool OGRGenSQLExternalSort::AddFeature( OGRFeature* poFeature )
+
+{
+    const size_t nOffset = m_abyBuffer.size();
+    OGRGenSQLSerializeFeature(poFeature, m_abyBuffer);
+    m_anOffsets.push_back(nOffset);
+
+    m_asKeys.resize(m_asKeys.size() + m_nOrderItems);
+    OGRField *pasKeys = &m_asKeys[m_asKeys.size() - m_nOrderItems];
+    memset(pasKeys, 0, sizeof(OGRField) * m_nOrderItems);
+    m_poLayer->ReadIndexFields(poFeature, m_nOrderItems, pasKeys);
+
+    // String keys are copies of fields already counted in the
+    // serialized record.
+    const GIntBig nRecordSize =
+        static_cast<GIntBig>(m_abyBuffer.size() - nOffset);
+    m_nMemory += 2 * nRecordSize + sizeof(size_t) * 2 +
+                 sizeof(OGRField) * m_nOrderItems;
+
+    if( m_nMemory > m_nMaxMemory )
+        return WriteRun();
+    return true;
+}
+
+/************************************************************************/
+/*                             SortBuffer()                             */
+/************************************************************************/
+
+void OGRGenSQLExternalSort::SortBuffer()
+
+{
+    m_anOrder.resize(m_anOffsets.size());
+    for( size_t i = 0; i < m_anOrder.size(); i++ )
+        m_anOrder[i] = i;
+
+    // A stable sort keeps the order of the source layer for equal keys,
+    // as the FID based index does.
+    std::stable_sort(m_anOrder.begin(), m_anOrder.end(),
+        [this](size_t i, size_t j)
+        {
+            return m_poLayer->Compare(&m_asKeys[i * m_nOrderItems],
+                                      &m_asKeys[j * m_nOrderItems]) < 0;
+        });
+
+    if( !m_asKeys.empty() )
+        m_poLayer->FreeIndexFields(&m_asKeys[0], m_anOffsets.size(), false);
+    m_asKeys.clear();
+}
+
+/************************************************************************/
+/*                              WriteRun()                              */
+/************************************************************************/
+
+bool OGRGenSQLExternalSort::WriteRun()
+
+{
+    if( m_anOffsets.empty() )
+        return true;
+
+    SortBuffer();
+
+    Run sRun;
+    sRun.osFilename = CPLGenerateTempFilename("ogr_sql_sort");
+    sRun.fp = nullptr;
+    sRun.poFeature = nullptr;
+    sRun.pasKeys = nullptr;
+    sRun.nLevel = 0;
+    m_asRuns.push_back(sRun);
+
+    VSILFILE *fp = VSIFOpenL(sRun.osFilename, "wb");
+    if( fp == nullptr )
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "Cannot create temporary file %s",
+                 sRun.osFilename.c_str());
+        return false;
+    }
+
+    bool bOK = true;
+    for( size_t i = 0; bOK && i < m_anOrder.size(); i++ )
+    {
+        const size_t nOffset = m_anOffsets[m_anOrder[i]];
+        const size_t nEnd = m_anOrder[i] + 1 < m_anOffsets.size() ?
+            m_anOffsets[m_anOrder[i] + 1] : m_abyBuffer.size();
+        const GUInt32 nSize = static_cast<GUInt32>(nEnd - nOffset);
+        bOK = VSIFWriteL(&nSize, sizeof(nSize), 1, fp) == 1 &&
+              VSIFWriteL(&m_abyBuffer[nOffset], nSize, 1, fp) == 1;
+    }
+    if( VSIFCloseL(fp) != 0 )
+        bOK = false;
+    if( !bOK )
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "Cannot write temporary file %s",
+                 sRun.osFilename.c_str());
+        return false;
+    }
+
+    CPLDebug("GenSQL", "Wrote run %s of %d features",
+             sRun.osFilename.c_str(), static_cast<int>(m_anOrder.size()));
+
+    m_abyBuffer.clear();
+    m_anOffsets.clear();
+    m_anOrder.clear();
+    m_nMemory = 0;
+
+    // Merge the newest runs once MAX_MERGED_RUNS of them went through
+    // the same number of merges, so that each feature is rewritten a
+    // logarithmic number of times, and the number of runs stays small.
+    while( true )
+    {
+        const int nRuns = static_cast<int>(m_asRuns.size());
+        const int nLevel = m_asRuns.back().nLevel;
+        int nSameLevel = 0;
+        while( nSameLevel < nRuns &&
+               m_asRuns[nRuns - 1 - nSameLevel].nLevel == nLevel )
+        {
+            nSameLevel++;
+        }
+        if( nSameLevel < MAX_MERGED_RUNS )
+            break;
+        if( !MergeRuns(nRuns - MAX_MERGED_RUNS, MAX_MERGED_RUNS) )
+            return false;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                              OpenRun()                               */
+/************************************************************************/
+
+bool OGRGenSQLExternalSort::OpenRun( int iRun )
+
+{
+    Run& sRun = m_asRuns[iRun];
+    if( sRun.fp != nullptr )
+        return true;
+    sRun.fp = VSIFOpenL(sRun.osFilename, "rb");
+    if( sRun.fp == nullptr )
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "Cannot open temporary file %s",
+                 sRun.osFilename.c_str());
+        return false;
+    }
+    sRun.pasKeys = static_cast<OGRField*>(
+        CPLCalloc(sizeof(OGRField), m_nOrderItems));
+    return true;
+}
+
+/************************************************************************/
+/*                             StartMerge()                             */
+/*                                                                      */
+/*      Start merging nRuns consecutive open runs from their start.     */
+/************************************************************************/
+
+void OGRGenSQLExternalSort::StartMerge( int iFirstRun, int nRuns )
+
+{
+    m_anHeap.clear();
+    for( int iRun = iFirstRun; iRun < iFirstRun + nRuns; iRun++ )
+    {
+        VSIFSeekL(m_asRuns[iRun].fp, 0, SEEK_SET);
+        if( ReadRunFeature(iRun) )
+            m_anHeap.push_back(iRun);
+    }
+    std::make_heap(m_anHeap.begin(), m_anHeap.end(),
+                   [this](int i, int j) { return IsAfter(i, j); });
+}
+
+/************************************************************************/
+/*                          PopMergedFeature()                          */
+/************************************************************************/
+
+OGRFeature *OGRGenSQLExternalSort::PopMergedFeature()
+
+{
+    if( m_anHeap.empty() )
+        return nullptr;
+
+    auto oIsAfter = [this](int i, int j) { return IsAfter(i, j); };
+    std::pop_heap(m_anHeap.begin(), m_anHeap.end(), oIsAfter);
+    const int iRun = m_anHeap.back();
+    OGRFeature *poFeature = m_asRuns[iRun].poFeature;
+    m_asRuns[iRun].poFeature = nullptr;
+    if( ReadRunFeature(iRun) )
+        std::push_heap(m_anHeap.begin(), m_anHeap.end(), oIsAfter);
+    else
+        m_anHeap.pop_back();
+    return poFeature;
+}
+
+/************************************************************************/
+/*                             MergeRuns()                              */
+/*                                                                      */
+/*      Replace nRuns consecutive runs by a single one.  As the runs    */
+/*      are consecutive, equal keys keep the order of the source layer. */
+/************************************************************************/
+
+bool OGRGenSQLExternalSort::MergeRuns( int iFirstRun, int nRuns )
+
+{
+    Run sRun;
+    sRun.osFilename = CPLGenerateTempFilename("ogr_sql_sort");
+    sRun.fp = nullptr;
+    sRun.poFeature = nullptr;
+    sRun.pasKeys = nullptr;
+    sRun.nLevel = 0;
+    for( int iRun = iFirstRun; iRun < iFirstRun + nRuns; iRun++ )
+    {
+        if( !OpenRun(iRun) )
+            return false;
+        sRun.nLevel = std::max(sRun.nLevel, m_asRuns[iRun].nLevel + 1);
+    }
+    StartMerge(iFirstRun, nRuns);
+
+    VSILFILE *fp = VSIFOpenL(sRun.osFilename, "wb");
+    if( fp == nullptr )
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "Cannot create temporary file %s",
+                 sRun.osFilename.c_str());
+        return false;
+    }
+
+    bool bOK = true;
+    std::vector<GByte> abyRecord;
+    OGRFeature *poFeature = nullptr;
+    while( bOK && (poFeature = PopMergedFeature()) != nullptr )
+    {
+        abyRecord.clear();
+        OGRGenSQLSerializeFeature(poFeature, abyRecord);
+        delete poFeature;
+        const GUInt32 nSize = static_cast<GUInt32>(abyRecord.size());
+        bOK = VSIFWriteL(&nSize, sizeof(nSize), 1, fp) == 1 &&
+              VSIFWriteL(&abyRecord[0], nSize, 1, fp) == 1;
+    }
+    if( VSIFCloseL(fp) != 0 )
+        bOK = false;
+
+    for( int iRun = iFirstRun; iRun < iFirstRun + nRuns; iRun++ )
+        CloseRun(m_asRuns[iRun]);
+    m_asRuns.erase(m_asRuns.begin() + iFirstRun,
+                   m_asRuns.begin() + iFirstRun + nRuns);
+    m_asRuns.insert(m_asRuns.begin() + iFirstRun, sRun);
+    m_anHeap.clear();
+
+    if( !bOK )
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "Cannot write temporary file %s",
+                 sRun.osFilename.c_str());
+        return false;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                               Finish()                               */
+/*                                                                      */
+/*      Called once all the source features have been added.            */
+/************************************************************************/
+
+bool OGRGenSQLExternalSort::Finish()
+
+{
+    if( m_asRuns.empty() )
+    {
+        SortBuffer();
+    }
+    else
+    {
+        if( !WriteRun() )
+            return false;
+
+        // Bound the number of files open while reading.
+        while( static_cast<int>(m_asRuns.size()) > MAX_MERGED_RUNS )
+        {
+            if( !MergeRuns(0, MAX_MERGED_RUNS) )
+                return false;
+        }
+        for( int iRun = 0; iRun < static_cast<int>(m_asRuns.size()); iRun++ )
+        {
+            if( !OpenRun(iRun) )
+                return false;
+        }
+    }
+
+    Rewind();
+    return true;
+}
+
+/************************************************************************/
+/*                           ReadRunFeature()                           */
+/*                                                                      */
+/*      Read the next feature of a run and its sort keys.  Returns      */
+/*      false at the end of the run.                                    */
+/************************************************************************/
+
+bool OGRGenSQLExternalSort::ReadRunFeature( int iRun )
+
+{
+    Run& sRun = m_asRuns[iRun];
+
+    delete sRun.poFeature;
+    sRun.poFeature = nullptr;
+    m_poLayer->FreeIndexFields(sRun.pasKeys, 1, false);
+    memset(sRun.pasKeys, 0, sizeof(OGRField) * m_nOrderItems);
+
+    GUInt32 nSize = 0;
+    if( VSIFReadL(&nSize, sizeof(nSize), 1, sRun.fp) != 1 )
+        return false;
+    m_abyRecord.resize(nSize);
+    if( VSIFReadL(&m_abyRecord[0], nSize, 1, sRun.fp) != 1 )
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "Cannot read temporary file %s",
+                 sRun.osFilename.c_str());
+        return false;
+    }
+
+    sRun.poFeature = OGRGenSQLDeserializeFeature(m_poDefn, &m_abyRecord[0]);
+    m_poLayer->ReadIndexFields(sRun.poFeature, m_nOrderItems, sRun.pasKeys);
+    return true;
+}
+
+/************************************************************************/
+/*                              IsAfter()                               */
+/*                                                                      */
+/*      Heap ordering of the runs on their current feature.  Runs are   */
+/*      written in the order of the source layer, so equal keys are     */
+/*      taken from the lowest run first.                                */
+/************************************************************************/
+
+bool OGRGenSQLExternalSort::IsAfter( int iRun1, int iRun2 )
+
+{
+    const int nResult = m_poLayer->Compare(m_asRuns[iRun1].pasKeys,
+                                           m_asRuns[iRun2].pasKeys);
+    if( nResult != 0 )
+        return nResult > 0;
+    return iRun1 > iRun2;
+}
+
+/************************************************************************/
+/*                               Rewind()                               */
+/************************************************************************/
+
+void OGRGenSQLExternalSort::Rewind()
+
+{
+    m_nNextIndex = 0;
+    if( m_asRuns.empty() )
+        return;
+
+    StartMerge(0, static_cast<int>(m_asRuns.size()));
+}
+
+/************************************************************************/
+/*                           SetNextByIndex()                           */
+/*                                                                      */
+/*      With runs, going backwards merges them again from the start.    */
+/************************************************************************/
+
+void OGRGenSQLExternalSort::SetNextByIndex( GIntBig nIndex )
+
+{
+    if( m_asRuns.empty() )
+    {
+        m_nNextIndex = nIndex;
+        return;
+    }
+
+    if( nIndex < m_nNextIndex )
+        Rewind();
+    while( m_nNextIndex < nIndex )
+    {
+        OGRFeature *poFeature = GetNextFeature();
+        if( poFeature == nullptr )
+            break;
+        delete poFeature;
+    }
+}
+
+/************************************************************************/
+/*                           GetNextFeature()                           */
+/************************************************************************/
+
+OGRFeature *OGRGenSQLExternalSort::GetNextFeature()
+
+{
+    if( m_asRuns.empty() )
+    {
+        if( m_nNextIndex < 0 ||
+            m_nNextIndex >= static_cast<GIntBig>(m_anOrder.size()) )
+            return nullptr;
+        const size_t nIdx = m_anOrder[static_cast<size_t>(m_nNextIndex++)];
+        return OGRGenSQLDeserializeFeature(m_poDefn,
+                                           &m_abyBuffer[m_anOffsets[nIdx]]);
+    }
+
+    OGRFeature *poFeature = PopMergedFeature();
+    if( poFeature != nullptr )
+        m_nNextIndex++;
+    return poFeature;
+}
+
+/************************************************************************/
+/*                        SetSummaryFieldValue()                        */
+/*                                                                      */
+/*      Set the value of an aggregate column from its accumulated       */
+/*      summary.  Summary is swq_summary, or anything with the same     */
+/*      count, sum, min, max, osMin and osMax members.                  */
+/************************************************************************/
+
+template<class Summary>
+static void SetSummaryFieldValue( OGRFeature* poFeature, int iField,
+                                  const swq_col_def* psColDef,
+                                  const Summary& oSummary )
+{
+    const bool bIsDate = psColDef->field_type == SWQ_DATE ||
+                         psColDef->field_type == SWQ_TIME ||
+                         psColDef->field_type == SWQ_TIMESTAMP;
+
+    if( psColDef->col_func == SWQCF_AVG && oSummary.count > 0 )
+    {
+        if( bIsDate )
+        {
+            struct tm brokendowntime;
+            double dfAvg = oSummary.sum / oSummary.count;
+            CPLUnixTimeToYMDHMS((GIntBig)dfAvg, &brokendowntime);
+            poFeature->SetField( iField,
+                                 brokendowntime.tm_year + 1900,
+                                 brokendowntime.tm_mon + 1,
+                                 brokendowntime.tm_mday,
+                                 brokendowntime.tm_hour,
+                                 brokendowntime.tm_min,
+                                 static_cast<float>(brokendowntime.tm_sec + fmod(dfAvg, 1)),
+                                 0);
+        }
+        else
+            poFeature->SetField( iField, oSummary.sum / oSummary.count );
+    }
+    else if( psColDef->col_func == SWQCF_MIN && oSummary.count > 0 )
+    {
+        if( bIsDate )
+            poFeature->SetField( iField, oSummary.osMin.c_str() );
+        else
+            poFeature->SetField( iField, oSummary.min );
+    }
+    else if( psColDef->col_func == SWQCF_MAX && oSummary.count > 0 )
+    {
+        if( bIsDate )
+            poFeature->SetField( iField, oSummary.osMax.c_str() );
+        else
+            poFeature->SetField( iField, oSummary.max );
+    }
+    else if( psColDef->col_func == SWQCF_COUNT )
+        poFeature->SetField( iField, oSummary.count );
+    else if( psColDef->col_func == SWQCF_SUM && oSummary.count > 0 )
+        poFeature->SetField( iField, oSummary.sum );
+}
+
+/************************************************************************/
+/*                           OGRGenSQLGroupBy                           */
+/*                                                                      */
+/*      Hash aggregation of the source features of a GROUP BY query.    */
+/*      Each group keeps a copy of its first source feature, from       */
+/*      which the grouped columns are taken, and an accumulator per     */
+/*      aggregate column.  Groups are numbered in the order of their    */
+/*      first appearance.                                               */
+/************************************************************************/
+
+class OGRGenSQLGroupBy
+{
+    // Same members as swq_summary, for SetSummaryFieldValue().
+    struct Aggregate
+    {
+        GIntBig     count;
+        double      sum;
+        double      min;
+        double      max;
+        CPLString   osMin;
+        CPLString   osMax;
+
+        Aggregate() : count(0), sum(0.0),
+                      min(std::numeric_limits<double>::infinity()),
+                      max(-std::numeric_limits<double>::infinity()) {}
+    };
+
+    swq_select     *m_psSelectInfo;
+    OGRFeatureDefn *m_poDefn;
+    std::vector<int> m_anMap;
+    std::vector<int> m_anAggregateColumns;
+
+    std::unordered_map<std::string, size_t> m_oMap;
+    std::vector<const std::string*> m_aposKeys;
+    std::vector<OGRFeature*> m_apoFeatures;
+    std::vector<Aggregate> m_aoAggregates;
+    std::string         m_osKey;
+
+    void        GetKey( OGRFeature* poFeature, std::string& osKey ) const;
+    void        Accumulate( Aggregate& oAggregate, const swq_col_def* psColDef,
+                            OGRFeature* poFeature ) const;
+    size_t      AddGroup( const std::string& osKey, OGRFeature* poFeature );
+
+    CPL_DISALLOW_COPY_ASSIGN(OGRGenSQLGroupBy)
+
+  public:
+                OGRGenSQLGroupBy( swq_select* psSelectInfo,
+                                  OGRFeatureDefn* poDefn );
+               ~OGRGenSQLGroupBy();
+
+    bool        AddFeature( OGRFeature* poFeature );
+    bool        Merge( OGRGenSQLGroupBy* poOther );
+
+    size_t      GetGroupCount() const { return m_apoFeatures.size(); }
+    OGRFeature *GetGroupFeature( size_t iGroup )
+                                        { return m_apoFeatures[iGroup]; }
+    bool        CountFitsOnInt32( int iColumn ) const;
+    void        SetAggregateFields( size_t iGroup,
+                                    OGRFeature* poDstFeature ) const;
+};
+
+/************************************************************************/
+/*                          OGRGenSQLGroupBy()                          */
+/*                                                                      */
+/*      poDefn is the definition of the main table, on which the        */
+/*      kept features are created.  The features added may come from   */
+/*      another handle on the same layer.                               */
+/************************************************************************/
+
+OGRGenSQLGroupBy::OGRGenSQLGroupBy( swq_select* psSelectInfo,
+                                    OGRFeatureDefn* poDefn ) :
+    m_psSelectInfo(psSelectInfo),
+    m_poDefn(poDefn)
+{
+    m_poDefn->Reference();
+    for( int i = 0; i < m_poDefn->GetFieldCount(); i++ )
+        m_anMap.push_back(i);
+    for( int iField = 0; iField < psSelectInfo->result_columns; iField++ )
+    {
+        if( psSelectInfo->column_defs[iField].col_func != SWQCF_NONE )
+            m_anAggregateColumns.push_back(iField);
+    }
+}
+
+/************************************************************************/
+/*                         ~OGRGenSQLGroupBy()                          */
+/************************************************************************/
+
+OGRGenSQLGroupBy::~OGRGenSQLGroupBy()
+
+{
+    for( size_t i = 0; i < m_apoFeatures.size(); i++ )
+        delete m_apoFeatures[i];
+    m_poDefn->Release();
+}
+
+/************************************************************************/
+/*                               GetKey()                               */
+/*                                                                      */
+/*      Binary key of the GROUP BY fields of a feature.  Each value is  */
+/*      prefixed by whether it is null, and strings by their length.    */
+/************************************************************************/
+
+void OGRGenSQLGroupBy::GetKey( OGRFeature* poFeature,
+                               std::string& osKey ) const
+{
+    osKey.clear();
+    for( int i = 0; i < m_psSelectInfo->group_specs; i++ )
+    {
+        const int iField = m_psSelectInfo->group_defs[i].field_index;
+        if( !poFeature->IsFieldSetAndNotNull(iField) )
+        {
+            osKey += '\0';
+            continue;
+        }
+        osKey += '\1';
+
+        const OGRFieldType eType = iField < m_poDefn->GetFieldCount() ?
+            m_poDefn->GetFieldDefn(iField)->GetType() : OFTString;
+        const OGRField* psField = eType == OFTString ? nullptr :
+                                        poFeature->GetRawFieldRef(iField);
+        if( eType == OFTInteger )
+        {
+            osKey.append(reinterpret_cast<const char*>(&psField->Integer),
+                         sizeof(psField->Integer));
+        }
+        else if( eType == OFTInteger64 )
+        {
+            osKey.append(reinterpret_cast<const char*>(&psField->Integer64),
+                         sizeof(psField->Integer64));
+        }
+        else if( eType == OFTReal )
+        {
+            // 0.0 and -0.0 are the same group.
+            const double dfVal = psField->Real == 0.0 ? 0.0 : psField->Real;
+            osKey.append(reinterpret_cast<const char*>(&dfVal),
+                         sizeof(dfVal));
+        }
+        else
+        {
+            const char* pszVal = eType == OFTString &&
+                                 iField < m_poDefn->GetFieldCount() ?
+                poFeature->GetRawFieldRef(iField)->String :
+                poFeature->GetFieldAsString(iField);
+            const GUInt32 nLen = static_cast<GUInt32>(strlen(pszVal));
+            osKey.append(reinterpret_cast<const char*>(&nLen), sizeof(nLen));
+            osKey.append(pszVal, nLen);
+        }
+    }
+}
+
+/************************************************************************/
+/*                             Accumulate()                             */
+/*                                                                      */
+/*      Same rules as swq_select_summarize(), without going through     */
+/*      the string representation of numeric values.                    */
+/************************************************************************/
+
+void OGRGenSQLGroupBy::Accumulate( Aggregate& oAggregate,
+                                   const swq_col_def* psColDef,
+                                   OGRFeature* poFeature ) const
+{
+    const int iField = psColDef->field_index;
+
+    if( psColDef->col_func == SWQCF_COUNT )
+    {
+        // psColDef->field_index can be -1 in the case of a COUNT(*)
+        if( iField < 0 )
+            oAggregate.count++;
+        else if( IS_GEOM_FIELD_INDEX(m_poDefn, iField) )
+        {
+            if( poFeature->GetGeomFieldRef(
+                    ALL_FIELD_INDEX_TO_GEOM_FIELD_INDEX(m_poDefn, iField))
+                                                                != nullptr )
+                oAggregate.count++;
+        }
+        else if( poFeature->IsFieldSetAndNotNull(iField) )
+            oAggregate.count++;
+        return;
+    }
+
+    if( !poFeature->IsFieldSetAndNotNull(iField) )
+        return;
+    // Empty strings are ignored, as in swq_select_summarize().
+    if( (iField >= m_poDefn->GetFieldCount() ||
+         m_poDefn->GetFieldDefn(iField)->GetType() == OFTString) &&
+        poFeature->GetFieldAsString(iField)[0] == '\0' )
+        return;
+
+    if( psColDef->field_type == SWQ_DATE ||
+        psColDef->field_type == SWQ_TIME ||
+        psColDef->field_type == SWQ_TIMESTAMP )
+    {
+        if( psColDef->col_func == SWQCF_MIN ||
+            psColDef->col_func == SWQCF_MAX )
+        {
+            const char* pszVal = poFeature->GetFieldAsString(iField);
+            if( psColDef->col_func == SWQCF_MIN &&
+                (oAggregate.count == 0 || strcmp(pszVal, oAggregate.osMin) < 0) )
+                oAggregate.osMin = pszVal;
+            else if( psColDef->col_func == SWQCF_MAX &&
+                     (oAggregate.count == 0 ||
+                      strcmp(pszVal, oAggregate.osMax) > 0) )
+                oAggregate.osMax = pszVal;
+        }
+        else
+        {
+            const OGRField* psField = poFeature->GetRawFieldRef(iField);
+            struct tm brokendowntime;
+            brokendowntime.tm_year = psField->Date.Year - 1900;
+            brokendowntime.tm_mon = psField->Date.Month - 1;
+            brokendowntime.tm_mday = psField->Date.Day;
+            brokendowntime.tm_hour = psField->Date.Hour;
+            brokendowntime.tm_min = psField->Date.Minute;
+            brokendowntime.tm_sec = static_cast<int>(psField->Date.Second);
+            oAggregate.sum += CPLYMDHMSToUnixTime(&brokendowntime);
+            oAggregate.sum += fmod(static_cast<double>(psField->Date.Second),
+                                   1.0);
+        }
+        oAggregate.count++;
+        return;
+    }
+
+    const double dfVal = poFeature->GetFieldAsDouble(iField);
+    if( dfVal < oAggregate.min )
+        oAggregate.min = dfVal;
+    if( dfVal > oAggregate.max )
+        oAggregate.max = dfVal;
+    oAggregate.sum += dfVal;
+    oAggregate.count++;
+}
+
+/************************************************************************/
+/*                              AddGroup()                              */
+/************************************************************************/
+
+size_t OGRGenSQLGroupBy::AddGroup( const std::string& osKey,
+                                   OGRFeature* poFeature )
+{
+    const size_t iGroup = m_apoFeatures.size();
+    auto oIter = m_oMap.insert(
+        std::pair<std::string, size_t>(osKey, iGroup)).first;
+    m_aposKeys.push_back(&(oIter->first));
+    m_apoFeatures.push_back(poFeature);
+    m_aoAggregates.resize(m_aoAggregates.size() +
+                          m_anAggregateColumns.size());
+    return iGroup;
+}
+
+/************************************************************************/
+/*                             AddFeature()                             */
+/*                                                                      */
+/*      Add a source feature to its group.  The feature remains owned   */
+/*      by the caller.  Returns false if out of memory.                 */
+/************************************************************************/
+
+bool OGRGenSQLGroupBy::AddFeature( OGRFeature* poFeature )
+
+{
+    try
+    {
+        GetKey(poFeature, m_osKey);
+
+        size_t iGroup = 0;
+        auto oIter = m_oMap.find(m_osKey);
+        if( oIter != m_oMap.end() )
+            iGroup = oIter->second;
+        else
+        {
+            OGRFeature* poGroupFeature = new OGRFeature(m_poDefn);
+            poGroupFeature->SetFrom(poFeature, &m_anMap[0], TRUE);
+            poGroupFeature->SetFID(poFeature->GetFID());
+            iGroup = AddGroup(m_osKey, poGroupFeature);
+        }
+
+        Aggregate* pasAggregates =
+            &m_aoAggregates[iGroup * m_anAggregateColumns.size()];
+        for( size_t i = 0; i < m_anAggregateColumns.size(); i++ )
+        {
+            Accumulate( pasAggregates[i],
+                        m_psSelectInfo->column_defs + m_anAggregateColumns[i],
+                        poFeature );
+        }
+    }
+    catch( std::bad_alloc& )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory, "Out of memory");
+        return false;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                               Merge()                                */
+/*                                                                      */
+/*      Merge the groups of another aggregation of features coming      */
+/*      after ours in the source layer.  Its new groups are moved at    */
+/*      the end of ours.  Returns false if out of memory.               */
+/************************************************************************/
+
+bool OGRGenSQLGroupBy::Merge( OGRGenSQLGroupBy* poOther )
+
+{
+    const size_t nAggregates = m_anAggregateColumns.size();
+    try
+    {
+        for( size_t iOther = 0; iOther < poOther->m_apoFeatures.size();
+             iOther++ )
+        {
+            const std::string& osKey = *(poOther->m_aposKeys[iOther]);
+            size_t iGroup = 0;
+            auto oIter = m_oMap.find(osKey);
+            if( oIter != m_oMap.end() )
+                iGroup = oIter->second;
+            else
+            {
+                iGroup = AddGroup(osKey, poOther->m_apoFeatures[iOther]);
+                poOther->m_apoFeatures[iOther] = nullptr;
+            }
+
+            for( size_t i = 0; i < nAggregates; i++ )
+            {
+                Aggregate& oAgg = m_aoAggregates[iGroup * nAggregates + i];
+                const Aggregate& oOtherAgg =
+                    poOther->m_aoAggregates[iOther * nAggregates + i];
+                if( oOtherAgg.count == 0 )
+                    continue;
+                if( oAgg.count == 0 ||
+                    strcmp(oOtherAgg.osMin, oAgg.osMin) < 0 )
+                    oAgg.osMin = oOtherAgg.osMin;
+                if( oAgg.count == 0 ||
+                    strcmp(oOtherAgg.osMax, oAgg.osMax) > 0 )
+                    oAgg.osMax = oOtherAgg.osMax;
+                oAgg.min = std::min(oAgg.min, oOtherAgg.min);
+                oAgg.max = std::max(oAgg.max, oOtherAgg.max);
+                oAgg.sum += oOtherAgg.sum;
+                oAgg.count += oOtherAgg.count;
+            }
+        }
+    }
+    catch( std::bad_alloc& )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory, "Out of memory");
+        return false;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                          CountFitsOnInt32()                          */
+/************************************************************************/
+
+bool OGRGenSQLGroupBy::CountFitsOnInt32( int iColumn ) const
+
+{
+    const size_t nAggregates = m_anAggregateColumns.size();
+    for( size_t i = 0; i < nAggregates; i++ )
+    {
+        if( m_anAggregateColumns[i] != iColumn )
+            continue;
+        for( size_t iGroup = 0; iGroup < m_apoFeatures.size(); iGroup++ )
+        {
+            if( !CPL_INT64_FITS_ON_INT32(
+                        m_aoAggregates[iGroup * nAggregates + i].count) )
+                return false;
+        }
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                         SetAggregateFields()                         */
+/************************************************************************/
+
+void OGRGenSQLGroupBy::SetAggregateFields( size_t iGroup,
+                                           OGRFeature* poDstFeature ) const
+{
+    const size_t nAggregates = m_anAggregateColumns.size();
+    for( size_t i = 0; i < nAggregates; i++ )
+    {
+        const int iField = m_anAggregateColumns[i];
+        SetSummaryFieldValue( poDstFeature, iField,
+                              m_psSelectInfo->column_defs + iField,
+                              m_aoAggregates[iGroup * nAggregates + i] );
+    }
+}
+
+/************************************************************************/
+/*                         OGRGenSQLGroupByJob                          */
+/*                                                                      */
+/*      Aggregation, in a worker thread, of the features of the source  */
+/*      layer from index nStart up to the feature of FID nEndFID        */
+/*      (excluded, or up to the end of the layer if it is OGRNullFID),  */
+/*      through its own handle on the dataset.                          */
+/************************************************************************/
+
+struct OGRGenSQLGroupByJob
+{
+    const char         *pszDSName;
+    const char         *pszDriverName;
+    char              **papszOpenOptions;
+    const char         *pszLayerName;
+    const char         *pszWHERE;
+    char              **papszIgnoredFields;
+    int                 nFieldCount;
+    GIntBig             nStart;
+    GIntBig             nEndFID;
+    OGRGenSQLGroupBy   *poGroupBy;
+    bool                bSuccess;
+};
+
+static void OGRGenSQLGroupByJobFunc( void* pData )
+{
+    OGRGenSQLGroupByJob* psJob = static_cast<OGRGenSQLGroupByJob*>(pData);
+
+    // Failures are not reported: the caller falls back to a scan of the
+    // source layer in the calling thread.
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+
+    const char* const apszDrivers[] = { psJob->pszDriverName, nullptr };
+    GDALDataset* poDS = GDALDataset::FromHandle(
+        GDALOpenEx(psJob->pszDSName, GDAL_OF_VECTOR, apszDrivers,
+                   psJob->papszOpenOptions, nullptr));
+    OGRLayer* poLayer =
+        poDS ? poDS->GetLayerByName(psJob->pszLayerName) : nullptr;
+    OGRFeatureQuery oQuery;
+
+    if( poLayer != nullptr &&
+        poLayer->GetLayerDefn()->GetFieldCount() == psJob->nFieldCount &&
+        (psJob->pszWHERE == nullptr ||
+         oQuery.Compile(poLayer->GetLayerDefn(),
+                        psJob->pszWHERE) == OGRERR_NONE) )
+    {
+        poLayer->SetIgnoredFields(
+            const_cast<const char**>(psJob->papszIgnoredFields));
+        psJob->bSuccess =
+            poLayer->SetNextByIndex(psJob->nStart) == OGRERR_NONE;
+
+        while( psJob->bSuccess )
+        {
+            OGRFeature* poFeature = poLayer->GetNextFeature();
+            if( poFeature == nullptr )
+            {
+                // The end of the range must have been reached.
+                psJob->bSuccess = psJob->nEndFID == OGRNullFID;
+                break;
+            }
+            if( poFeature->GetFID() == psJob->nEndFID )
+            {
+                delete poFeature;
+                break;
+            }
+            if( psJob->pszWHERE == nullptr || oQuery.Evaluate(poFeature) )
+                psJob->bSuccess = psJob->poGroupBy->AddFeature(poFeature);
+            delete poFeature;
+        }
+    }
+
+    if( poDS != nullptr )
+        GDALClose(poDS);
+
+    CPLPopErrorHandler();
+}
+
 /************************************************************************/
 /*                       OGRGenSQLResultsLayer()                        */
 /************************************************************************/
@@ -100,12 +1850,15 @@ OGRGenSQLResultsLayer::OGRGenSQLResultsLayer( GDALDataset *poSrcDSIn,
     nIndexSize(0),
     panFIDIndex(nullptr),
     bOrderByValid(FALSE),
+    m_poExternalSort(nullptr),
     nNextIndexFID(0),
     poSummaryFeature(nullptr),
     iFIDFieldIndex(),
     nExtraDSCount(0),
     papoExtraDS(nullptr),
-    nIteratedFeatures(-1)
+    nIteratedFeatures(-1),
+    m_bJoinHashesPrepared(false),
+    m_bGroupByPrepared(false)
 {
     swq_select *psSelectInfo = (swq_select *) pSelectInfoIn;
 
@@ -140,6 +1893,7 @@ OGRGenSQLResultsLayer::OGRGenSQLResultsLayer( GDALDataset *poSrcDSIn,
             papoExtraDS[nExtraDSCount-1] = poTableDS;
         }
 
+        m_apoTableDS.push_back( poTableDS );
         papoTableLayers[iTable] =
             poTableDS->GetLayerByName( psTableDef->table_name );
 
@@ -507,6 +2261,12 @@ OGRGenSQLResultsLayer::~OGRGenSQLResultsLayer()
 
     ClearFilters();
 
+    delete m_poExternalSort;
+    for( size_t i = 0; i < m_apoJoinHashes.size(); i++ )
+        delete m_apoJoinHashes[i];
+    for( size_t i = 0; i < m_apoGroupFeatures.size(); i++ )
+        delete m_apoGroupFeatures[i];
+
 /* -------------------------------------------------------------------- */
 /*      Free various datastructures.                                    */
 /* -------------------------------------------------------------------- */
@@ -637,6 +2397,8 @@ void OGRGenSQLResultsLayer::ResetReading()
 
     nNextIndexFID = psSelectInfo->offset;
     nIteratedFeatures = -1;
+    if( m_poExternalSort != nullptr )
+        m_poExternalSort->Rewind();
 }
 
 /************************************************************************/
@@ -660,11 +2422,17 @@ OGRErr OGRGenSQLResultsLayer::SetNextByIndex( GIntBig nIndex )
 
     if( psSelectInfo->query_mode == SWQM_SUMMARY_RECORD
         || psSelectInfo->query_mode == SWQM_DISTINCT_LIST
+        || psSelectInfo->query_mode == SWQM_GROUP_BY
         || panFIDIndex != nullptr )
     {
         nNextIndexFID = nIndex + psSelectInfo->offset;
         return OGRERR_NONE;
     }
+    else if( m_poExternalSort != nullptr )
+    {
+        m_poExternalSort->SetNextByIndex( nIndex + psSelectInfo->offset );
+        return OGRERR_NONE;
+    }
     else
     {
         return poSrcLayer->SetNextByIndex( nIndex + psSelectInfo->offset );
@@ -729,6 +2497,22 @@ GIntBig OGRGenSQLResultsLayer::GetFeatureCount( int bForce )
 
         nRet = psSelectInfo->column_summary[0].count;
     }
+    else if( psSelectInfo->query_mode == SWQM_GROUP_BY )
+    {
+        if( !PrepareGroupBy() )
+            return 0;
+
+        if( m_poAttrQuery == nullptr )
+            nRet = static_cast<GIntBig>(m_apoGroupFeatures.size());
+        else
+        {
+            for( size_t i = 0; i < m_apoGroupFeatures.size(); i++ )
+            {
+                if( m_poAttrQuery->Evaluate( m_apoGroupFeatures[i] ) )
+                    nRet++;
+            }
+        }
+    }
     else if( psSelectInfo->query_mode != SWQM_RECORDSET )
         return 1;
     else if( m_poAttrQuery == nullptr && !MustEvaluateSpatialFilterOnGenSQL() )
@@ -759,12 +2543,20 @@ int OGRGenSQLResultsLayer::TestCapability( const char *pszCap )
     {
         if( psSelectInfo->query_mode == SWQM_SUMMARY_RECORD
             || psSelectInfo->query_mode == SWQM_DISTINCT_LIST
+            || psSelectInfo->query_mode == SWQM_GROUP_BY
             || panFIDIndex != nullptr )
             return TRUE;
+        else if( m_poExternalSort != nullptr )
+            return FALSE;
         else
             return poSrcLayer->TestCapability( pszCap );
     }
 
+    // Reading the features sorted in temporary files at random is O(N).
+    if( EQUAL(pszCap,OLCRandomRead) && m_poExternalSort != nullptr &&
+        m_poExternalSort->HasRuns() )
+        return FALSE;
+
     if( psSelectInfo->query_mode == SWQM_RECORDSET
         && (EQUAL(pszCap,OLCFastFeatureCount)
             || EQUAL(pszCap,OLCRandomRead)
@@ -779,6 +2571,26 @@ int OGRGenSQLResultsLayer::TestCapability( const char *pszCap )
     return FALSE;
 }
 
+/************************************************************************/
+/*                         IsGeomSpecialField()                         */
+/************************************************************************/
+
+int OGRGenSQLResultsLayer::IsGeomSpecialField(int iTable, int iField)
+{
+    if( iTable != 0 || iField == -1 )
+        return FALSE;
+
+    OGRLayer* poLayer = papoTableLayers[iTable];
+    int nSpecialFieldIdx = iField - poLayer->GetLayerDefn()->GetFieldCount();
+    if( nSpecialFieldIdx == SPF_OGR_GEOMETRY ||
+        nSpecialFieldIdx == SPF_OGR_GEOM_WKT ||
+        nSpecialFieldIdx == SPF_OGR_GEOM_AREA )
+        return TRUE;
+    if( iField == GEOM_FIELD_INDEX_TO_ALL_FIELD_INDEX(poLayer->GetLayerDefn(), 0) )
+        return TRUE;
+    return FALSE;
+}
+
 /************************************************************************/
 /*                        ContainGeomSpecialField()                     */
 /************************************************************************/
@@ -787,20 +2599,7 @@ int OGRGenSQLResultsLayer::ContainGeomSpecialField(swq_expr_node* expr)
 {
     if (expr->eNodeType == SNT_COLUMN)
     {
-        if( expr->table_index == 0 && expr->field_index != -1 )
-        {
-            OGRLayer* poLayer = papoTableLayers[expr->table_index];
-            int nSpecialFieldIdx = expr->field_index -
-                            poLayer->GetLayerDefn()->GetFieldCount();
-            if( nSpecialFieldIdx == SPF_OGR_GEOMETRY ||
-                nSpecialFieldIdx == SPF_OGR_GEOM_WKT ||
-                nSpecialFieldIdx == SPF_OGR_GEOM_AREA )
-                return TRUE;
-            if( expr->field_index ==
-                    GEOM_FIELD_INDEX_TO_ALL_FIELD_INDEX(poLayer->GetLayerDefn(), 0) )
-                return TRUE;
-            return FALSE;
-        }
+        return IsGeomSpecialField(expr->table_index, expr->field_index);
     }
     else if (expr->eNodeType == SNT_OPERATION)
     {
@@ -813,6 +2612,48 @@ int OGRGenSQLResultsLayer::ContainGeomSpecialField(swq_expr_node* expr)
     return FALSE;
 }
 
+/************************************************************************/
+/*                        SummaryNeedsGeometry()                        */
+/*                                                                      */
+/*      Whether the source geometries must be read to summarize the     */
+/*      source layer: if a spatial filter is in place, or if the where  */
+/*      clause, a column or a GROUP BY field references the geometry,   */
+/*      or the OGR_GEOMETRY, OGR_GEOM_WKT or OGR_GEOM_AREA special      */
+/*      fields.                                                         */
+/************************************************************************/
+
+int OGRGenSQLResultsLayer::SummaryNeedsGeometry()
+
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+
+    if( m_poFilterGeom != nullptr )
+        return TRUE;
+
+    if( psSelectInfo->where_expr != nullptr &&
+        ContainGeomSpecialField(psSelectInfo->where_expr) )
+        return TRUE;
+
+    for( int iField = 0; iField < psSelectInfo->result_columns; iField++ )
+    {
+        swq_col_def *psColDef = psSelectInfo->column_defs + iField;
+        if( IsGeomSpecialField(psColDef->table_index, psColDef->field_index) )
+            return TRUE;
+        if (psColDef->expr != nullptr && ContainGeomSpecialField(psColDef->expr))
+            return TRUE;
+    }
+
+    for( int iGroup = 0; iGroup < psSelectInfo->group_specs; iGroup++ )
+    {
+        swq_group_def *psGroupDef = psSelectInfo->group_defs + iGroup;
+        if( IsGeomSpecialField(psGroupDef->table_index,
+                               psGroupDef->field_index) )
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
 /************************************************************************/
 /*                           PrepareSummary()                           */
 /************************************************************************/
@@ -835,46 +2676,11 @@ int OGRGenSQLResultsLayer::PrepareSummary()
     ApplyFiltersToSource();
 
 /* -------------------------------------------------------------------- */
-/*      Ignore geometry reading if no spatial filter in place and that  */
-/*      the where clause and no column references OGR_GEOMETRY,         */
-/*      OGR_GEOM_WKT or OGR_GEOM_AREA special fields.                   */
+/*      Ignore geometry reading if not needed.                          */
 /* -------------------------------------------------------------------- */
     int bSaveIsGeomIgnored = poSrcLayer->GetLayerDefn()->IsGeometryIgnored();
-    if ( m_poFilterGeom == nullptr && ( psSelectInfo->where_expr == nullptr ||
-                !ContainGeomSpecialField(psSelectInfo->where_expr) ) )
-    {
-        int bFoundGeomExpr = FALSE;
-        for( int iField = 0; iField < psSelectInfo->result_columns; iField++ )
-        {
-            swq_col_def *psColDef = psSelectInfo->column_defs + iField;
-            if (psColDef->table_index == 0 && psColDef->field_index != -1)
-            {
-                OGRLayer* poLayer = papoTableLayers[psColDef->table_index];
-                int nSpecialFieldIdx = psColDef->field_index -
-                                poLayer->GetLayerDefn()->GetFieldCount();
-                if (nSpecialFieldIdx == SPF_OGR_GEOMETRY ||
-                    nSpecialFieldIdx == SPF_OGR_GEOM_WKT ||
-                    nSpecialFieldIdx == SPF_OGR_GEOM_AREA)
-                {
-                    bFoundGeomExpr = TRUE;
-                    break;
-                }
-                if( psColDef->field_index ==
-                        GEOM_FIELD_INDEX_TO_ALL_FIELD_INDEX(poLayer->GetLayerDefn(), 0) )
-                {
-                    bFoundGeomExpr = TRUE;
-                    break;
-                }
-            }
-            if (psColDef->expr != nullptr && ContainGeomSpecialField(psColDef->expr))
-            {
-                bFoundGeomExpr = TRUE;
-                break;
-            }
-        }
-        if (!bFoundGeomExpr)
-            poSrcLayer->GetLayerDefn()->SetGeometryIgnored(TRUE);
-    }
+    if( !SummaryNeedsGeometry() )
+        poSrcLayer->GetLayerDefn()->SetGeometryIgnored(TRUE);
 
 /* -------------------------------------------------------------------- */
 /*      We treat COUNT(*) as a special case, and fill with              */
@@ -901,6 +2707,46 @@ int OGRGenSQLResultsLayer::PrepareSummary()
         return TRUE;
     }
 
+/* -------------------------------------------------------------------- */
+/*      Summary records without DISTINCT can be computed in several     */
+/*      threads, as a GROUP BY without grouping field.                  */
+/* -------------------------------------------------------------------- */
+    if( psSelectInfo->query_mode == SWQM_SUMMARY_RECORD )
+    {
+        OGRGenSQLGroupBy* poGroupBy = ScanGroupByInParallel();
+        if( poGroupBy != nullptr )
+        {
+            poSrcLayer->GetLayerDefn()->SetGeometryIgnored(bSaveIsGeomIgnored);
+            ClearFilters();
+
+            // As below, COUNT columns are only downcast if there was at
+            // least one source feature.
+            const bool bHasGroup = poGroupBy->GetGroupCount() == 1;
+            for( int iField = 0; bHasGroup &&
+                                 iField < psSelectInfo->result_columns; iField++ )
+            {
+                if( psSelectInfo->column_defs[iField].col_func == SWQCF_COUNT &&
+                    poGroupBy->CountFitsOnInt32(iField) )
+                    poDefn->GetFieldDefn(iField)->SetType(OFTInteger);
+            }
+
+            delete poSummaryFeature;
+            poSummaryFeature = new OGRFeature( poDefn );
+            poSummaryFeature->SetFID( 0 );
+            for( int iField = 0; iField < psSelectInfo->result_columns; iField++ )
+            {
+                if( psSelectInfo->column_defs[iField].col_func == SWQCF_COUNT )
+                    poSummaryFeature->SetField( iField, 0 );
+            }
+            if( bHasGroup )
+                poGroupBy->SetAggregateFields( 0, poSummaryFeature );
+
+            delete poGroupBy;
+            return TRUE;
+        }
+        ApplyFiltersToSource();
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Otherwise, process all source feature through the summary       */
 /*      building facilities of SWQ.                                     */
@@ -944,119 +2790,333 @@ int OGRGenSQLResultsLayer::PrepareSummary()
                 pszError = swq_select_summarize( psSelectInfo, iField, pszVal );
             }
 
-            if( pszError != nullptr )
-            {
-                delete poSrcFeature;
-                delete poSummaryFeature;
-                poSummaryFeature = nullptr;
+            if( pszError != nullptr )
+            {
+                delete poSrcFeature;
+                delete poSummaryFeature;
+                poSummaryFeature = nullptr;
+
+                poSrcLayer->GetLayerDefn()->SetGeometryIgnored(bSaveIsGeomIgnored);
+
+                CPLError( CE_Failure, CPLE_AppDefined, "%s", pszError );
+                return FALSE;
+            }
+        }
+
+        delete poSrcFeature;
+    }
+
+    poSrcLayer->GetLayerDefn()->SetGeometryIgnored(bSaveIsGeomIgnored);
+
+/* -------------------------------------------------------------------- */
+/*      If we have run out of features on the source layer, clear       */
+/*      away the filters we have installed till a next run through      */
+/*      the features.                                                   */
+/* -------------------------------------------------------------------- */
+    if( poSrcFeature == nullptr )
+        ClearFilters();
+
+/* -------------------------------------------------------------------- */
+/*      Now apply the values to the summary feature.  If we are in      */
+/*      DISTINCT_LIST mode we don't do this step.                       */
+/* -------------------------------------------------------------------- */
+    if( psSelectInfo->query_mode == SWQM_SUMMARY_RECORD )
+    {
+        for( int iField = 0; iField < psSelectInfo->result_columns; iField++ )
+        {
+            swq_col_def *psColDef = psSelectInfo->column_defs + iField;
+            if( !psSelectInfo->column_summary.empty() )
+            {
+                swq_summary& oSummary = psSelectInfo->column_summary[iField];
+                if( psColDef->col_func == SWQCF_COUNT )
+                {
+                    if( CPL_INT64_FITS_ON_INT32(oSummary.count) )
+                    {
+                        delete poSummaryFeature;
+                        poSummaryFeature = nullptr;
+                        poDefn->GetFieldDefn(iField)->SetType(OFTInteger);
+                    }
+                }
+            }
+        }
+
+        if( poSummaryFeature == nullptr )
+        {
+            poSummaryFeature = new OGRFeature( poDefn );
+            poSummaryFeature->SetFID( 0 );
+        }
+
+        for( int iField = 0; iField < psSelectInfo->result_columns; iField++ )
+        {
+            swq_col_def *psColDef = psSelectInfo->column_defs + iField;
+            if (!psSelectInfo->column_summary.empty() )
+            {
+                SetSummaryFieldValue( poSummaryFeature, iField, psColDef,
+                                      psSelectInfo->column_summary[iField] );
+            }
+            else if ( psColDef->col_func == SWQCF_COUNT )
+                poSummaryFeature->SetField( iField, 0 );
+        }
+    }
+
+    return TRUE;
+}
+
+/************************************************************************/
+/*                       ScanGroupByInParallel()                        */
+/*                                                                      */
+/*      Aggregate the source layer for GROUP BY, or for a summary       */
+/*      record without DISTINCT, with GDAL_NUM_THREADS threads, each    */
+/*      reading a range of consecutive features through its own         */
+/*      handle on the source dataset.  This requires the                */
+/*      dataset to be reopenable, and the layer to be quickly           */
+/*      positioned with SetNextByIndex().  Returns nullptr, so that     */
+/*      the caller scans the layer itself, if this is not possible.     */
+/************************************************************************/
+
+OGRGenSQLGroupBy *OGRGenSQLResultsLayer::ScanGroupByInParallel()
+
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+
+    int nThreads = GDALGetNumThreads();
+    if( nThreads <= 1 )
+        return nullptr;
+
+    for( int iField = 0; iField < psSelectInfo->result_columns; iField++ )
+    {
+        if( psSelectInfo->column_defs[iField].distinct_flag )
+            return nullptr;
+    }
+
+    if( psSelectInfo->join_count != 0 ||
+        psSelectInfo->table_defs[0].data_source != nullptr ||
+        m_poFilterGeom != nullptr ||
+        poSrcDS->GetAccess() != GA_ReadOnly ||
+        poSrcDS->GetDriver() == nullptr ||
+        poSrcDS->GetDescription()[0] == '\0' )
+        return nullptr;
+
+    poSrcLayer->SetAttributeFilter( nullptr );
+    poSrcLayer->SetSpatialFilter( nullptr );
+    if( !poSrcLayer->TestCapability(OLCFastSetNextByIndex) ||
+        !poSrcLayer->TestCapability(OLCFastFeatureCount) )
+        return nullptr;
+
+/* -------------------------------------------------------------------- */
+/*      Split the layer in ranges of at least 10000 features, and       */
+/*      find the FID of the first feature of each range, where the      */
+/*      previous range stops.                                           */
+/* -------------------------------------------------------------------- */
+    const GIntBig nTotal = poSrcLayer->GetFeatureCount( TRUE );
+    nThreads = static_cast<int>(
+        std::min(static_cast<GIntBig>(nThreads), nTotal / 10000));
+    if( nThreads <= 1 )
+        return nullptr;
+
+    std::vector<GIntBig> anStarts;
+    std::vector<GIntBig> anStartFIDs;
+    for( int i = 0; i < nThreads; i++ )
+    {
+        const GIntBig nStart = nTotal / nThreads * i;
+        OGRFeature* poFeature = nullptr;
+        if( poSrcLayer->SetNextByIndex( nStart ) == OGRERR_NONE )
+            poFeature = poSrcLayer->GetNextFeature();
+        if( poFeature == nullptr || poFeature->GetFID() == OGRNullFID )
+        {
+            delete poFeature;
+            poSrcLayer->ResetReading();
+            return nullptr;
+        }
+        anStarts.push_back( nStart );
+        anStartFIDs.push_back( poFeature->GetFID() );
+        delete poFeature;
+    }
+    poSrcLayer->ResetReading();
+
+/* -------------------------------------------------------------------- */
+/*      Fields ignored by the workers.                                  */
+/* -------------------------------------------------------------------- */
+    OGRFeatureDefn* poSrcDefn = poSrcLayer->GetLayerDefn();
+    CPLStringList aosIgnoredFields;
+    for( int iField = 0; iField < poSrcDefn->GetFieldCount(); iField++ )
+    {
+        if( poSrcDefn->GetFieldDefn(iField)->IsIgnored() )
+            aosIgnoredFields.AddString(
+                poSrcDefn->GetFieldDefn(iField)->GetNameRef() );
+    }
+    if( poSrcDefn->IsGeometryIgnored() )
+        aosIgnoredFields.AddString( "OGR_GEOMETRY" );
+    if( poSrcDefn->IsStyleIgnored() )
+        aosIgnoredFields.AddString( "OGR_STYLE" );
+
+    CPLWorkerThreadPool* poThreadPool = GDALGetGlobalThreadPool( nThreads );
+    CPLJobQueue* poJobQueue = poThreadPool ?
+        new (std::nothrow) CPLJobQueue( poThreadPool ) : nullptr;
+    if( poJobQueue == nullptr )
+        return nullptr;
+
+    std::vector<OGRGenSQLGroupByJob> asJobs(nThreads);
+    std::vector<void*> apData;
+    for( int i = 0; i < nThreads; i++ )
+    {
+        OGRGenSQLGroupByJob& sJob = asJobs[i];
+        sJob.pszDSName = poSrcDS->GetDescription();
+        sJob.pszDriverName = poSrcDS->GetDriver()->GetDescription();
+        sJob.papszOpenOptions = poSrcDS->GetOpenOptions();
+        sJob.pszLayerName = poSrcLayer->GetName();
+        sJob.pszWHERE = pszWHERE;
+        sJob.papszIgnoredFields = aosIgnoredFields.List();
+        sJob.nFieldCount = poSrcDefn->GetFieldCount();
+        sJob.nStart = anStarts[i];
+        sJob.nEndFID = i + 1 < nThreads ? anStartFIDs[i+1] : OGRNullFID;
+        sJob.poGroupBy = new OGRGenSQLGroupBy( psSelectInfo, poSrcDefn );
+        sJob.bSuccess = false;
+        apData.push_back( &sJob );
+    }
+    if( !poJobQueue->SubmitJobs( OGRGenSQLGroupByJobFunc, apData ) )
+    {
+        for( int i = 0; i < nThreads; i++ )
+            delete asJobs[i].poGroupBy;
+        delete poJobQueue;
+        return nullptr;
+    }
+    poJobQueue->WaitCompletion();
+    delete poJobQueue;
+
+/* -------------------------------------------------------------------- */
+/*      Merge the groups in the order of the ranges, so that they are   */
+/*      numbered as by a scan in a single thread.                       */
+/* -------------------------------------------------------------------- */
+    OGRGenSQLGroupBy* poGroupBy = asJobs[0].poGroupBy;
+    bool bSuccess = true;
+    for( int i = 0; i < nThreads; i++ )
+    {
+        bSuccess = bSuccess && asJobs[i].bSuccess;
+        if( i > 0 )
+        {
+            bSuccess = bSuccess && poGroupBy->Merge( asJobs[i].poGroupBy );
+            delete asJobs[i].poGroupBy;
+        }
+    }
+    if( !bSuccess )
+    {
+        delete poGroupBy;
+        return nullptr;
+    }
+
+    CPLDebug( "OGR", "Aggregated layer %s in %d threads",
+              poSrcLayer->GetName(), nThreads );
+    return poGroupBy;
+}
 
-                poSrcLayer->GetLayerDefn()->SetGeometryIgnored(bSaveIsGeomIgnored);
+/************************************************************************/
+/*                           PrepareGroupBy()                           */
+/*                                                                      */
+/*      Aggregate the source features of a GROUP BY query, and build    */
+/*      the resulting features, whose FID is their position.            */
+/************************************************************************/
 
-                CPLError( CE_Failure, CPLE_AppDefined, "%s", pszError );
-                return FALSE;
-            }
-        }
+int OGRGenSQLResultsLayer::PrepareGroupBy()
 
-        delete poSrcFeature;
-    }
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
 
-    poSrcLayer->GetLayerDefn()->SetGeometryIgnored(bSaveIsGeomIgnored);
+    if( m_bGroupByPrepared )
+        return TRUE;
+    m_bGroupByPrepared = true;
 
 /* -------------------------------------------------------------------- */
-/*      If we have run out of features on the source layer, clear       */
-/*      away the filters we have installed till a next run through      */
-/*      the features.                                                   */
+/*      Ignore geometry reading if not needed, as in PrepareSummary().  */
 /* -------------------------------------------------------------------- */
-    if( poSrcFeature == nullptr )
-        ClearFilters();
+    OGRFeatureDefn* poSrcDefn = poSrcLayer->GetLayerDefn();
+    const int bSaveIsGeomIgnored = poSrcDefn->IsGeometryIgnored();
+    if( !SummaryNeedsGeometry() )
+        poSrcDefn->SetGeometryIgnored(TRUE);
 
-/* -------------------------------------------------------------------- */
-/*      Now apply the values to the summary feature.  If we are in      */
-/*      DISTINCT_LIST mode we don't do this step.                       */
-/* -------------------------------------------------------------------- */
-    if( psSelectInfo->query_mode == SWQM_SUMMARY_RECORD )
+    OGRGenSQLGroupBy* poGroupBy = ScanGroupByInParallel();
+    if( poGroupBy == nullptr )
     {
-        for( int iField = 0; iField < psSelectInfo->result_columns; iField++ )
+        poGroupBy = new OGRGenSQLGroupBy( psSelectInfo, poSrcDefn );
+
+        ApplyFiltersToSource();
+
+        OGRFeature *poSrcFeature = nullptr;
+        while( (poSrcFeature = poSrcLayer->GetNextFeature()) != nullptr )
         {
-            swq_col_def *psColDef = psSelectInfo->column_defs + iField;
-            if( !psSelectInfo->column_summary.empty() )
+            const bool bOK = poGroupBy->AddFeature( poSrcFeature );
+            delete poSrcFeature;
+            if( !bOK )
             {
-                swq_summary& oSummary = psSelectInfo->column_summary[iField];
-                if( psColDef->col_func == SWQCF_COUNT )
-                {
-                    if( CPL_INT64_FITS_ON_INT32(oSummary.count) )
-                    {
-                        delete poSummaryFeature;
-                        poSummaryFeature = nullptr;
-                        poDefn->GetFieldDefn(iField)->SetType(OFTInteger);
-                    }
-                }
+                delete poGroupBy;
+                poSrcDefn->SetGeometryIgnored(bSaveIsGeomIgnored);
+                ClearFilters();
+                return FALSE;
             }
         }
+    }
 
-        if( poSummaryFeature == nullptr )
+    poSrcDefn->SetGeometryIgnored(bSaveIsGeomIgnored);
+    ClearFilters();
+
+/* -------------------------------------------------------------------- */
+/*      Sort the groups on the ORDER BY fields, which are GROUP BY      */
+/*      fields and can therefore be read from the first source         */
+/*      feature of each group.                                          */
+/* -------------------------------------------------------------------- */
+    const size_t nGroups = poGroupBy->GetGroupCount();
+    std::vector<size_t> anOrder(nGroups);
+    for( size_t i = 0; i < nGroups; i++ )
+        anOrder[i] = i;
+
+    const int nOrderItems = psSelectInfo->order_specs;
+    if( nOrderItems > 0 && nGroups > 1 )
+    {
+        std::vector<OGRField> asKeys(nGroups * nOrderItems);
+        for( size_t i = 0; i < nGroups; i++ )
         {
-            poSummaryFeature = new OGRFeature( poDefn );
-            poSummaryFeature->SetFID( 0 );
+            ReadIndexFields( poGroupBy->GetGroupFeature(i), nOrderItems,
+                             &asKeys[i * nOrderItems] );
         }
 
+        std::stable_sort(anOrder.begin(), anOrder.end(),
+            [this, &asKeys, nOrderItems](size_t i, size_t j)
+            {
+                return Compare(&asKeys[i * nOrderItems],
+                               &asKeys[j * nOrderItems]) < 0;
+            });
+
+        FreeIndexFields(&asKeys[0], nGroups, false);
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Downcast COUNT columns to OFTInteger when possible, and build   */
+/*      the resulting features.                                         */
+/* -------------------------------------------------------------------- */
+    for( int iField = 0; iField < psSelectInfo->result_columns; iField++ )
+    {
+        if( psSelectInfo->column_defs[iField].col_func == SWQCF_COUNT &&
+            poGroupBy->CountFitsOnInt32(iField) )
+            poDefn->GetFieldDefn(iField)->SetType(OFTInteger);
+    }
+
+    for( size_t i = 0; i < nGroups; i++ )
+    {
+        OGRFeature* poSrcFeature = poGroupBy->GetGroupFeature(anOrder[i]);
+        OGRFeature* poFeature = new OGRFeature( poDefn );
+        poFeature->SetFID( static_cast<GIntBig>(i) );
         for( int iField = 0; iField < psSelectInfo->result_columns; iField++ )
         {
             swq_col_def *psColDef = psSelectInfo->column_defs + iField;
-            if (!psSelectInfo->column_summary.empty() )
-            {
-                swq_summary& oSummary = psSelectInfo->column_summary[iField];
-
-                if( psColDef->col_func == SWQCF_AVG && oSummary.count > 0 )
-                {
-                    if( psColDef->field_type == SWQ_DATE ||
-                        psColDef->field_type == SWQ_TIME ||
-                        psColDef->field_type == SWQ_TIMESTAMP)
-                    {
-                        struct tm brokendowntime;
-                        double dfAvg = oSummary.sum / oSummary.count;
-                        CPLUnixTimeToYMDHMS((GIntBig)dfAvg, &brokendowntime);
-                        poSummaryFeature->SetField( iField,
-                                                    brokendowntime.tm_year + 1900,
-                                                    brokendowntime.tm_mon + 1,
-                                                    brokendowntime.tm_mday,
-                                                    brokendowntime.tm_hour,
-                                                    brokendowntime.tm_min,
-                                                    static_cast<float>(brokendowntime.tm_sec + fmod(dfAvg, 1)),
-                                                    0);
-                    }
-                    else
-                        poSummaryFeature->SetField( iField,
-                                                    oSummary.sum / oSummary.count );
-                }
-                else if( psColDef->col_func == SWQCF_MIN && oSummary.count > 0 )
-                {
-                    if( psColDef->field_type == SWQ_DATE ||
-                        psColDef->field_type == SWQ_TIME ||
-                        psColDef->field_type == SWQ_TIMESTAMP)
-                        poSummaryFeature->SetField( iField, oSummary.osMin.c_str() );
-                    else
-                        poSummaryFeature->SetField( iField, oSummary.min );
-                }
-                else if( psColDef->col_func == SWQCF_MAX && oSummary.count > 0 )
-                {
-                    if( psColDef->field_type == SWQ_DATE ||
-                        psColDef->field_type == SWQ_TIME ||
-                        psColDef->field_type == SWQ_TIMESTAMP)
-                        poSummaryFeature->SetField( iField, oSummary.osMax.c_str() );
-                    else
-                        poSummaryFeature->SetField( iField, oSummary.max );
-                }
-                else if( psColDef->col_func == SWQCF_COUNT )
-                    poSummaryFeature->SetField( iField, oSummary.count );
-                else if( psColDef->col_func == SWQCF_SUM && oSummary.count > 0 )
-                    poSummaryFeature->SetField( iField, oSummary.sum );
-            }
-            else if ( psColDef->col_func == SWQCF_COUNT )
-                poSummaryFeature->SetField( iField, 0 );
+            if( psColDef->col_func == SWQCF_NONE )
+                CopySourceField( poSrcFeature, psColDef, poFeature, iField );
         }
+        poGroupBy->SetAggregateFields( anOrder[i], poFeature );
+        m_apoGroupFeatures.push_back( poFeature );
     }
 
+    delete poGroupBy;
+
     return TRUE;
 }
 
@@ -1268,6 +3328,93 @@ static CPLString GetFilterForJoin(swq_expr_node* poExpr, OGRFeature* poSrcFeat,
     return "";
 }
 
+/************************************************************************/
+/*                         PrepareJoinHashes()                          */
+/*                                                                      */
+/*      Build the hash tables of the secondary layers of the joins      */
+/*      that can use one.  This is done on the first translated         */
+/*      feature, so that a query that is never read does not scan       */
+/*      the secondary layers.                                           */
+/************************************************************************/
+
+void OGRGenSQLResultsLayer::PrepareJoinHashes()
+
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+
+    m_bJoinHashesPrepared = true;
+    for( int iJoin = 0; iJoin < psSelectInfo->join_count; iJoin++ )
+    {
+        swq_join_def *psJoinInfo = psSelectInfo->join_defs + iJoin;
+        m_apoJoinHashes.push_back( OGRGenSQLJoinHash::Create(
+            psJoinInfo, poSrcLayer,
+            m_apoTableDS[psJoinInfo->secondary_table],
+            papoTableLayers[psJoinInfo->secondary_table]) );
+    }
+}
+
+/************************************************************************/
+/*                          CopySourceField()                           */
+/*                                                                      */
+/*      Copy the value of a non geometry field of the primary table     */
+/*      into field iDstField of the destination feature.                */
+/************************************************************************/
+
+void OGRGenSQLResultsLayer::CopySourceField( OGRFeature* poSrcFeat,
+                                             swq_col_def* psColDef,
+                                             OGRFeature* poDstFeat,
+                                             int iDstField )
+{
+    if( psColDef->field_index >= iFIDFieldIndex )
+    {
+        CPLAssert( psColDef->field_index <
+                                iFIDFieldIndex + SPECIAL_FIELD_COUNT );
+        switch (SpecialFieldTypes[psColDef->field_index - iFIDFieldIndex])
+        {
+          case SWQ_INTEGER:
+          case SWQ_INTEGER64:
+            poDstFeat->SetField( iDstField, poSrcFeat->GetFieldAsInteger64(psColDef->field_index) );
+            break;
+          case SWQ_FLOAT:
+            poDstFeat->SetField( iDstField, poSrcFeat->GetFieldAsDouble(psColDef->field_index) );
+            break;
+          default:
+            poDstFeat->SetField( iDstField, poSrcFeat->GetFieldAsString(psColDef->field_index) );
+        }
+        return;
+    }
+
+    switch (psColDef->target_type)
+    {
+      case SWQ_INTEGER:
+        poDstFeat->SetField( iDstField, poSrcFeat->GetFieldAsInteger(psColDef->field_index) );
+        break;
+
+      case SWQ_INTEGER64:
+        poDstFeat->SetField( iDstField, poSrcFeat->GetFieldAsInteger64(psColDef->field_index) );
+        break;
+
+      case SWQ_FLOAT:
+        poDstFeat->SetField( iDstField, poSrcFeat->GetFieldAsDouble(psColDef->field_index) );
+        break;
+
+      case SWQ_STRING:
+      case SWQ_TIMESTAMP:
+      case SWQ_DATE:
+      case SWQ_TIME:
+        poDstFeat->SetField( iDstField, poSrcFeat->GetFieldAsString(psColDef->field_index) );
+        break;
+
+      case SWQ_GEOMETRY:
+          CPLAssert(false);
+          break;
+
+      default:
+        poDstFeat->SetField( iDstField,
+                 poSrcFeat->GetRawFieldRef( psColDef->field_index ) );
+    }
+}
+
 /************************************************************************/
 /*                          TranslateFeature()                          */
 /************************************************************************/
@@ -1285,9 +3432,14 @@ OGRFeature *OGRGenSQLResultsLayer::TranslateFeature( OGRFeature *poSrcFeat )
 
     apoFeatures.push_back( poSrcFeat );
 
+    if( !m_bJoinHashesPrepared )
+        PrepareJoinHashes();
+
 /* -------------------------------------------------------------------- */
 /*      Fetch the corresponding features from any jointed tables.       */
+/*      Features returned by a join hash table are owned by it.         */
 /* -------------------------------------------------------------------- */
+    std::vector<bool> abOwnedJoinFeatures;
     for( int iJoin = 0; iJoin < psSelectInfo->join_count; iJoin++ )
     {
         CPLString osFilter;
@@ -1299,6 +3451,16 @@ OGRFeature *OGRGenSQLResultsLayer::TranslateFeature( OGRFeature *poSrcFeat )
         /* we have taken care of this */
         CPLAssert(psJoinInfo->secondary_table == iJoin + 1);
 
+        if( m_apoJoinHashes[iJoin] != nullptr )
+        {
+            bool bOwned = false;
+            apoFeatures.push_back(
+                m_apoJoinHashes[iJoin]->GetJoinedFeature(poSrcFeat, &bOwned) );
+            abOwnedJoinFeatures.push_back( bOwned );
+            continue;
+        }
+        abOwnedJoinFeatures.push_back( true );
+
         OGRLayer *poJoinLayer = papoTableLayers[psJoinInfo->secondary_table];
 
         osFilter = GetFilterForJoin(psJoinInfo->poExpr, poSrcFeat, poJoinLayer,
@@ -1454,55 +3616,9 @@ OGRFeature *OGRGenSQLResultsLayer::TranslateFeature( OGRFeature *poSrcFeat )
             poDstFeat->SetGeomField( iGeomField ++,
                                      poSrcFeat->GetGeomFieldRef(iSrcGeomField) );
         }
-        else if( psColDef->field_index >= iFIDFieldIndex )
-        {
-            CPLAssert( psColDef->field_index <
-                                    iFIDFieldIndex + SPECIAL_FIELD_COUNT );
-            switch (SpecialFieldTypes[psColDef->field_index - iFIDFieldIndex])
-            {
-              case SWQ_INTEGER:
-              case SWQ_INTEGER64:
-                poDstFeat->SetField( iRegularField, poSrcFeat->GetFieldAsInteger64(psColDef->field_index) );
-                break;
-              case SWQ_FLOAT:
-                poDstFeat->SetField( iRegularField, poSrcFeat->GetFieldAsDouble(psColDef->field_index) );
-                break;
-              default:
-                poDstFeat->SetField( iRegularField, poSrcFeat->GetFieldAsString(psColDef->field_index) );
-            }
-            iRegularField ++;
-        }
         else
         {
-            switch (psColDef->target_type)
-            {
-              case SWQ_INTEGER:
-                poDstFeat->SetField( iRegularField, poSrcFeat->GetFieldAsInteger(psColDef->field_index) );
-                break;
-
-              case SWQ_INTEGER64:
-                poDstFeat->SetField( iRegularField, poSrcFeat->GetFieldAsInteger64(psColDef->field_index) );
-                break;
-
-              case SWQ_FLOAT:
-                poDstFeat->SetField( iRegularField, poSrcFeat->GetFieldAsDouble(psColDef->field_index) );
-                break;
-
-              case SWQ_STRING:
-              case SWQ_TIMESTAMP:
-              case SWQ_DATE:
-              case SWQ_TIME:
-                poDstFeat->SetField( iRegularField, poSrcFeat->GetFieldAsString(psColDef->field_index) );
-                break;
-
-              case SWQ_GEOMETRY:
-                  CPLAssert(false);
-                  break;
-
-              default:
-                poDstFeat->SetField( iRegularField,
-                         poSrcFeat->GetRawFieldRef( psColDef->field_index ) );
-            }
+            CopySourceField( poSrcFeat, psColDef, poDstFeat, iRegularField );
             iRegularField ++;
         }
     }
@@ -1538,7 +3654,8 @@ OGRFeature *OGRGenSQLResultsLayer::TranslateFeature( OGRFeature *poSrcFeat )
             iRegularField ++;
         }
 
-        delete poJoinFeature;
+        if( abOwnedJoinFeatures[iJoin] )
+            delete poJoinFeature;
     }
 
     return poDstFeat;
@@ -1562,7 +3679,10 @@ OGRFeature *OGRGenSQLResultsLayer::GetNextFeature()
         nIteratedFeatures < 0 && psSelectInfo->offset > 0 &&
         psSelectInfo->query_mode == SWQM_RECORDSET )
     {
-        poSrcLayer->SetNextByIndex(psSelectInfo->offset);
+        if( m_poExternalSort != nullptr )
+            m_poExternalSort->SetNextByIndex(psSelectInfo->offset);
+        else
+            poSrcLayer->SetNextByIndex(psSelectInfo->offset);
     }
     if( nIteratedFeatures < 0 )
         nIteratedFeatures = 0;
@@ -1577,6 +3697,29 @@ OGRFeature *OGRGenSQLResultsLayer::GetNextFeature()
         return GetFeature( nNextIndexFID++ );
     }
 
+/* -------------------------------------------------------------------- */
+/*      Handle GROUP BY results, on which an attribute filter may be    */
+/*      set.                                                            */
+/* -------------------------------------------------------------------- */
+    if( psSelectInfo->query_mode == SWQM_GROUP_BY )
+    {
+        while( true )
+        {
+            OGRFeature *poFeature = GetFeature( nNextIndexFID++ );
+            if( poFeature == nullptr )
+                return nullptr;
+
+            if( m_poAttrQuery == nullptr
+                || m_poAttrQuery->Evaluate( poFeature ) )
+            {
+                nIteratedFeatures ++;
+                return poFeature;
+            }
+
+            delete poFeature;
+        }
+    }
+
     int bEvaluateSpatialFilter = MustEvaluateSpatialFilterOnGenSQL();
 
 /* -------------------------------------------------------------------- */
@@ -1590,7 +3733,9 @@ OGRFeature *OGRGenSQLResultsLayer::GetNextFeature()
             poFeature = GetFeature( nNextIndexFID++ );
         else
         {
-            OGRFeature *poSrcFeat = poSrcLayer->GetNextFeature();
+            OGRFeature *poSrcFeat = m_poExternalSort != nullptr ?
+                m_poExternalSort->GetNextFeature() :
+                poSrcLayer->GetNextFeature();
 
             if( poSrcFeat == nullptr )
                 return nullptr;
@@ -1639,6 +3784,18 @@ OGRFeature *OGRGenSQLResultsLayer::GetFeature( GIntBig nFID )
             return poSummaryFeature->Clone();
     }
 
+/* -------------------------------------------------------------------- */
+/*      Handle request for GROUP BY record.                             */
+/* -------------------------------------------------------------------- */
+    if( psSelectInfo->query_mode == SWQM_GROUP_BY )
+    {
+        if( !PrepareGroupBy() || nFID < 0 ||
+            nFID >= static_cast<GIntBig>(m_apoGroupFeatures.size()) )
+            return nullptr;
+        else
+            return m_apoGroupFeatures[static_cast<size_t>(nFID)]->Clone();
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Handle request for distinct list record.                        */
 /* -------------------------------------------------------------------- */
@@ -1719,6 +3876,25 @@ OGRFeature *OGRGenSQLResultsLayer::GetFeature( GIntBig nFID )
             nFID = panFIDIndex[nFID];
     }
 
+/* -------------------------------------------------------------------- */
+/*      With an external sort, the FID is the position in the sorted    */
+/*      stream, which interrupts sequential reading.  When the features */
+/*      were written in temporary files, going backwards merges them   */
+/*      again from the start, so that each such call is O(N).          */
+/* -------------------------------------------------------------------- */
+    if( m_poExternalSort != nullptr )
+    {
+        if( nFID < 0 )
+            return nullptr;
+        m_poExternalSort->SetNextByIndex( nFID );
+        OGRFeature *poSrcFeature = m_poExternalSort->GetNextFeature();
+        if( poSrcFeature == nullptr )
+            return nullptr;
+        OGRFeature *poResult = TranslateFeature( poSrcFeature );
+        delete poSrcFeature;
+        return poResult;
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Handle request for random record.                               */
 /* -------------------------------------------------------------------- */
@@ -1753,17 +3929,21 @@ OGRFeatureDefn *OGRGenSQLResultsLayer::GetLayerDefn()
 
 {
     swq_select *psSelectInfo = (swq_select *) pSelectInfo;
-    if( psSelectInfo->query_mode == SWQM_SUMMARY_RECORD &&
-        poSummaryFeature == nullptr )
+    if( (psSelectInfo->query_mode == SWQM_SUMMARY_RECORD &&
+         poSummaryFeature == nullptr) ||
+        (psSelectInfo->query_mode == SWQM_GROUP_BY && !m_bGroupByPrepared) )
     {
-        // Run PrepareSummary() is we have a COUNT column so as to be
-        // able to downcast it from OFTInteger64 to OFTInteger
+        // Run PrepareSummary() or PrepareGroupBy() is we have a COUNT column
+        // so as to be able to downcast it from OFTInteger64 to OFTInteger
         for( int iField = 0; iField < psSelectInfo->result_columns; iField++ )
         {
             swq_col_def *psColDef = psSelectInfo->column_defs + iField;
             if( psColDef->col_func == SWQCF_COUNT )
             {
-                PrepareSummary();
+                if( psSelectInfo->query_mode == SWQM_GROUP_BY )
+                    PrepareGroupBy();
+                else
+                    PrepareSummary();
                 break;
             }
         }
@@ -1910,6 +4090,11 @@ void OGRGenSQLResultsLayer::ReadIndexFields( OGRFeature* poSrcFeat,
 /*                                                                      */
 /*      Keeping all the key values in memory will *not* scale up to     */
 /*      very large input datasets.                                      */
+/*                                                                      */
+/*      When the source layer cannot fetch features efficiently by      */
+/*      FID, or when the key values do not fit in the memory budget,    */
+/*      the whole features are sorted instead, with an external merge   */
+/*      sort, so that they are read only once and sequentially.         */
 /************************************************************************/
 
 void OGRGenSQLResultsLayer::CreateOrderByIndex()
@@ -1975,6 +4160,25 @@ void OGRGenSQLResultsLayer::CreateOrderByIndex()
         return;
     }
 
+/* -------------------------------------------------------------------- */
+/*      Sort the whole features if random reading is not available,     */
+/*      or if requested.                                                */
+/* -------------------------------------------------------------------- */
+    const char *pszExternalSort =
+        CPLGetConfigOption("OGR_SQL_EXTERNAL_SORT", nullptr);
+    const bool bExternalSort = pszExternalSort != nullptr ?
+        CPLTestBool(pszExternalSort) :
+        !poSrcLayer->TestCapability(OLCRandomRead);
+    if( bExternalSort )
+    {
+        if( CreateExternalSort() )
+        {
+            ResetReading();
+            return;
+        }
+        ResetReading();
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Allocate set of key values, and the output index.               */
 /* -------------------------------------------------------------------- */
@@ -1986,6 +4190,31 @@ void OGRGenSQLResultsLayer::CreateOrderByIndex()
     GIntBig *panFIDList = static_cast<GIntBig *>(
         CPLMalloc(sizeof(GIntBig) * nFeaturesAlloc));
 
+/* -------------------------------------------------------------------- */
+/*      Find the string keys, whose values are allocated, to account    */
+/*      for the memory of the index.  When the sort method is not       */
+/*      forced, an index over the memory budget is replaced by an       */
+/*      external sort.                                                  */
+/* -------------------------------------------------------------------- */
+    bool bLimitMemory = pszExternalSort == nullptr;
+    const GIntBig nMaxMemory = bLimitMemory ?
+        GetSQLMaxMemoryOption("OGR_SQL_SORT_MAX_MEMORY") : 0;
+    std::vector<bool> abStringKeys(nOrderItems);
+    for( int iKey = 0; iKey < nOrderItems; iKey++ )
+    {
+        const swq_order_def *psKeyDef = psSelectInfo->order_defs + iKey;
+        if( psKeyDef->field_index >= iFIDFieldIndex )
+            abStringKeys[iKey] = SpecialFieldTypes[
+                psKeyDef->field_index - iFIDFieldIndex] == SWQ_STRING;
+        else
+            abStringKeys[iKey] = poSrcLayer->GetLayerDefn()->GetFieldDefn(
+                psKeyDef->field_index)->GetType() == OFTString;
+    }
+    // Key values, source FID, and the two FID arrays of the sort.
+    const GIntBig nEntrySize =
+        sizeof(OGRField) * nOrderItems + 3 * sizeof(GIntBig);
+    GIntBig nMemory = 0;
+
 /* -------------------------------------------------------------------- */
 /*      Read in all the key values.                                     */
 /* -------------------------------------------------------------------- */
@@ -2054,7 +4283,45 @@ void OGRGenSQLResultsLayer::CreateOrderByIndex()
         panFIDList[nIndexSize] = poSrcFeat->GetFID();
         delete poSrcFeat;
 
+        if( bLimitMemory )
+        {
+            nMemory += nEntrySize;
+            const OGRField *pasKeys = pasIndexFields + nIndexSize * nOrderItems;
+            for( int iKey = 0; iKey < nOrderItems; iKey++ )
+            {
+                if( abStringKeys[iKey] &&
+                    !OGR_RawField_IsUnset(&pasKeys[iKey]) &&
+                    !OGR_RawField_IsNull(&pasKeys[iKey]) )
+                {
+                    nMemory += strlen(pasKeys[iKey].String) + 1;
+                }
+            }
+        }
+
         nIndexSize++;
+
+        if( bLimitMemory && nMemory > nMaxMemory )
+        {
+            CPLDebug("GenSQL",
+                     "ORDER BY index over " CPL_FRMT_GIB " bytes. "
+                     "Using an external sort instead", nMaxMemory);
+            FreeIndexFields( pasIndexFields, nIndexSize, false );
+            memset( pasIndexFields, 0,
+                    sizeof(OGRField) * nOrderItems * nFeaturesAlloc );
+            nIndexSize = 0;
+            bLimitMemory = false;
+
+            ResetReading();
+            if( CreateExternalSort() )
+            {
+                VSIFree(pasIndexFields);
+                VSIFree(panFIDList);
+                ResetReading();
+                return;
+            }
+            // Read the key values again, without limit.
+            ResetReading();
+        }
     }
 
     //CPLDebug("GenSQL", "CreateOrderByIndex() = %d features", nIndexSize);
@@ -2122,6 +4389,38 @@ void OGRGenSQLResultsLayer::CreateOrderByIndex()
     ResetReading();
 }
 
+/************************************************************************/
+/*                         CreateExternalSort()                         */
+/************************************************************************/
+
+bool OGRGenSQLResultsLayer::CreateExternalSort()
+
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+
+    m_poExternalSort = new OGRGenSQLExternalSort(
+        this, poSrcLayer->GetLayerDefn(), psSelectInfo->order_specs,
+        GetSQLMaxMemoryOption("OGR_SQL_SORT_MAX_MEMORY"));
+
+    bool bOK = true;
+    OGRFeature *poSrcFeat = nullptr;
+    while( bOK && (poSrcFeat = poSrcLayer->GetNextFeature()) != nullptr )
+    {
+        bOK = m_poExternalSort->AddFeature( poSrcFeat );
+        delete poSrcFeat;
+    }
+    if( bOK )
+        bOK = m_poExternalSort->Finish();
+
+    if( !bOK )
+    {
+        CPLDebug("GenSQL", "External sort failed. Using a FID index instead");
+        delete m_poExternalSort;
+        m_poExternalSort = nullptr;
+    }
+    return bOK;
+}
+
 /************************************************************************/
 /*                          SortIndexSection()                          */
 /*                                                                      */
@@ -2367,6 +4666,12 @@ void OGRGenSQLResultsLayer::FindAndSetIgnoredFields()
         AddFieldDefnToSet(psOrderDef->table_index, psOrderDef->field_index, hSet);
     }
 
+    for( int iGroup = 0; iGroup < psSelectInfo->group_specs; iGroup++ )
+    {
+        swq_group_def *psGroupDef = psSelectInfo->group_defs + iGroup;
+        AddFieldDefnToSet(psGroupDef->table_index, psGroupDef->field_index, hSet);
+    }
+
 /* -------------------------------------------------------------------- */
 /*      2nd phase : now, we can exclude the unused fields               */
 /* -------------------------------------------------------------------- */
@@ -2403,6 +4708,9 @@ void OGRGenSQLResultsLayer::InvalidateOrderByIndex()
     CPLFree( panFIDIndex );
     panFIDIndex = nullptr;
 
+    delete m_poExternalSort;
+    m_poExternalSort = nullptr;
+
     nIndexSize = 0;
     bOrderByValid = FALSE;
 }
@@ -50,12 +50,18 @@
 #define ALL_FIELD_INDEX_TO_GEOM_FIELD_INDEX(poFDefn, idx) \
     ((idx) - ((poFDefn)->GetFieldCount() + SPECIAL_FIELD_COUNT))
 
+class OGRGenSQLJoinHash;
+class OGRGenSQLExternalSort;
+class OGRGenSQLGroupBy;
+
 /************************************************************************/
 /*                        OGRGenSQLResultsLayer                         */
 /************************************************************************/
 
 class OGRGenSQLResultsLayer final: public OGRLayer
 {
+    friend class OGRGenSQLExternalSort;
+
   private:
     GDALDataset *poSrcDS;
     OGRLayer    *poSrcLayer;
@@ -64,6 +70,7 @@ class OGRGenSQLResultsLayer final: public OGRLayer
     char        *pszWHERE;
 
     OGRLayer   **papoTableLayers;
+    std::vector<GDALDataset*> m_apoTableDS;
 
     OGRFeatureDefn *poDefn;
 
@@ -72,6 +79,7 @@ class OGRGenSQLResultsLayer final: public OGRLayer
     size_t      nIndexSize;
     GIntBig    *panFIDIndex;
     int         bOrderByValid;
+    OGRGenSQLExternalSort *m_poExternalSort;
 
     GIntBig      nNextIndexFID;
     OGRFeature  *poSummaryFeature;
@@ -84,10 +92,25 @@ class OGRGenSQLResultsLayer final: public OGRLayer
     GIntBig     nIteratedFeatures;
     std::vector<CPLString> m_oDistinctList;
 
+    bool        m_bJoinHashesPrepared;
+    std::vector<OGRGenSQLJoinHash*> m_apoJoinHashes;
+
+    bool        m_bGroupByPrepared;
+    std::vector<OGRFeature*> m_apoGroupFeatures;
+
     int         PrepareSummary();
+    int         SummaryNeedsGeometry();
+
+    int         PrepareGroupBy();
+    OGRGenSQLGroupBy *ScanGroupByInParallel();
 
+    void        PrepareJoinHashes();
     OGRFeature *TranslateFeature( OGRFeature * );
+    void        CopySourceField( OGRFeature* poSrcFeat,
+                                 swq_col_def* psColDef,
+                                 OGRFeature* poDstFeat, int iDstField );
     void        CreateOrderByIndex();
+    bool        CreateExternalSort();
     void        ReadIndexFields( OGRFeature* poSrcFeat,
                                  int nOrderItems,
                                  OGRField *pasIndexFields );
@@ -106,6 +129,7 @@ class OGRGenSQLResultsLayer final: public OGRLayer
     void        ExploreExprForIgnoredFields(swq_expr_node* expr, CPLHashSet* hSet);
     void        AddFieldDefnToSet(int iTable, int iColumn, CPLHashSet* hSet);
 
+    int         IsGeomSpecialField(int iTable, int iField);
     int         ContainGeomSpecialField(swq_expr_node* expr);
 
     void        InvalidateOrderByIndex();
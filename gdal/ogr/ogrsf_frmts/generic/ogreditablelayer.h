@@ -92,6 +92,10 @@ class CPL_DLL OGREditableLayer : public OGRLayerDecorator
 
     virtual void        ResetReading() override;
     virtual OGRFeature *GetNextFeature() override;
+    // Features must go through GetNextFeature() to merge the edited features.
+    virtual int         GetNextFeatureBatch( OGRFeatureBatch *poBatch,
+                                             int nMaxFeatures ) override
+        { return OGRLayer::GetNextFeatureBatch(poBatch, nMaxFeatures); }
     virtual OGRErr      SetNextByIndex( GIntBig nIndex ) override;
     virtual OGRFeature *GetFeature( GIntBig nFID ) override;
     virtual OGRErr      ISetFeature( OGRFeature *poFeature ) override;
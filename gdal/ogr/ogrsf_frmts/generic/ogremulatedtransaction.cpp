@@ -62,6 +62,10 @@ class OGRLayerWithTransaction final: public OGRLayerDecorator
                                      int bApproxOK = TRUE ) override;
 
     virtual OGRFeature *GetNextFeature() override;
+    // Features must go through GetNextFeature() to be translated.
+    virtual int         GetNextFeatureBatch( OGRFeatureBatch *poBatch,
+                                             int nMaxFeatures ) override
+        { return OGRLayer::GetNextFeatureBatch(poBatch, nMaxFeatures); }
     virtual OGRFeature *GetFeature( GIntBig nFID ) override;
     virtual OGRErr      ISetFeature( OGRFeature *poFeature ) override;
     virtual OGRErr      ICreateFeature( OGRFeature *poFeature ) override;
@@ -33,6 +33,14 @@
 #include "ogr_attrind.h"
 #include "swq.h"
 #include "ograpispy.h"
+#include "cpl_quad_tree.h"
+#include "cpl_worker_thread_pool.h"
+
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <new>
+#include <vector>
 
 CPL_CVSID("$Id$")
 
@@ -550,6 +558,26 @@ OGRFeatureH OGR_L_GetNextFeature( OGRLayerH hLayer )
                 OGRLayer::FromHandle(hLayer)->GetNextFeature());
 }
 
+/************************************************************************/
+/*                        GetNextFeatureBatch()                         */
+/************************************************************************/
+
+int OGRLayer::GetNextFeatureBatch( OGRFeatureBatch *poBatch,
+                                   int nMaxFeatures )
+
+{
+    poBatch->Reset(GetLayerDefn());
+    while( poBatch->GetFeatureCount() < nMaxFeatures )
+    {
+        OGRFeature *poFeature = GetNextFeature();
+        if( poFeature == nullptr )
+            break;
+        poBatch->AddFeature(poFeature);
+        delete poFeature;
+    }
+    return poBatch->GetFeatureCount();
+}
+
 /************************************************************************/
 /*                       ConvertGeomsIfNecessary()                      */
 /************************************************************************/
@@ -1950,25 +1978,6 @@ OGRErr set_result_schema(OGRLayer *pLayerResult,
     return ret;
 }
 
-static
-OGRGeometry *set_filter_from(OGRLayer *pLayer, OGRGeometry *pGeometryExistingFilter, OGRFeature *pFeature)
-{
-    OGRGeometry *geom = pFeature->GetGeometryRef();
-    if (!geom) return nullptr;
-    if (pGeometryExistingFilter) {
-        if (!geom->Intersects(pGeometryExistingFilter)) return nullptr;
-        OGRGeometry *intersection = geom->Intersection(pGeometryExistingFilter);
-        if (intersection) {
-            pLayer->SetSpatialFilter(intersection);
-            delete intersection;
-        } else
-            return nullptr;
-    } else {
-        pLayer->SetSpatialFilter(geom);
-    }
-    return geom;
-}
-
 static OGRGeometry* promote_to_multi(OGRGeometry* poGeom)
 {
     OGRwkbGeometryType eType = wkbFlatten(poGeom->getGeometryType());
@@ -1980,249 +1989,837 @@ static OGRGeometry* promote_to_multi(OGRGeometry* poGeom)
         return poGeom;
 }
 
+namespace {
+
 /************************************************************************/
-/*                          Intersection()                              */
+/*                           OGROverlayIndex                            */
+/*                                                                      */
+/*      The features of the other layer of an overlay method, read      */
+/*      once with the filters installed on that layer, and a quad       */
+/*      tree of their envelopes. This replaces setting a spatial        */
+/*      filter on the layer, and reading it again, for each feature     */
+/*      of the layer that is processed.                                 */
+/*                                                                      */
+/*      The features are kept in memory up to the size set by the       */
+/*      OGR_LAYER_ALGEBRA_MAX_MEMORY configuration option (in MB, 100   */
+/*      by default). Beyond it, if the layer has fast random read,      */
+/*      only their FIDs are kept, and the features are fetched with     */
+/*      GetFeature() when they are selected.                            */
 /************************************************************************/
-/**
- * \brief Intersection of two layers.
- *
- * The result layer contains features whose geometries represent areas
- * that are common between features in the input layer and in the
- * method layer. The features in the result layer have attributes from
- * both input and method layers. The schema of the result layer can be
- * set by the user or, if it is empty, is initialized to contain all
- * fields in the input and method layers.
- *
- * \note If the schema of the result is set by user and contains
- * fields that have the same name as a field in input and in method
- * layer, then the attribute in the result feature will get the value
- * from the feature of the method layer.
- *
- * \note For best performance use the minimum amount of features in
- * the method layer and copy it into a memory layer.
- *
- * \note This method relies on GEOS support. Do not use unless the
- * GEOS support is compiled in.
- *
- * The recognized list of options is:
- * <ul>
- * <li>SKIP_FAILURES=YES/NO. Set to YES to go on, even when a
- *     feature could not be inserted or a GEOS call failed.
- * <li>PROMOTE_TO_MULTI=YES/NO. Set to YES to convert Polygons
- *     into MultiPolygons, or LineStrings to MultiLineStrings.
- * <li>INPUT_PREFIX=string. Set a prefix for the field names that
- *     will be created from the fields of the input layer.
- * <li>METHOD_PREFIX=string. Set a prefix for the field names that
- *     will be created from the fields of the method layer.
- * <li>USE_PREPARED_GEOMETRIES=YES/NO. Set to NO to not use prepared
- *     geometries to pretest intersection of features of method layer
- *     with features of this layer.
- * <li>PRETEST_CONTAINMENT=YES/NO. Set to YES to pretest the
- *     containment of features of method layer within the features of
- *     this layer. This will speed up the method significantly in some
- *     cases. Requires that the prepared geometries are in effect.
- * <li>KEEP_LOWER_DIMENSION_GEOMETRIES=YES/NO. Set to NO to skip
- *     result features with lower dimension geometry that would
- *     otherwise be added to the result layer. The default is to add
- *     but only if the result layer has an unknown geometry type.
- * </ul>
- *
- * This method is the same as the C function OGR_L_Intersection().
- *
- * @param pLayerMethod the method layer. Should not be NULL.
- *
- * @param pLayerResult the layer where the features resulting from the
- * operation are inserted. Should not be NULL. See above the note
- * about the schema.
- *
- * @param papszOptions NULL terminated list of options (may be NULL).
- *
- * @param pfnProgress a GDALProgressFunc() compatible callback function for
- * reporting progress or NULL.
- *
- * @param pProgressArg argument to be passed to pfnProgress. May be NULL.
- *
- * @return an error code if there was an error or the execution was
- * interrupted, OGRERR_NONE otherwise.
- *
- * @note The first geometry field is always used.
- *
- * @since OGR 1.10
- */
 
-OGRErr OGRLayer::Intersection( OGRLayer *pLayerMethod,
-                               OGRLayer *pLayerResult,
-                               char** papszOptions,
-                               GDALProgressFunc pfnProgress,
-                               void * pProgressArg )
+class OGROverlayIndex
 {
-    OGRErr ret = OGRERR_NONE;
-    OGRFeatureDefn *poDefnInput = GetLayerDefn();
-    OGRFeatureDefn *poDefnMethod = pLayerMethod->GetLayerDefn();
-    OGRFeatureDefn *poDefnResult = nullptr;
-    OGRGeometry *pGeometryMethodFilter = nullptr;
-    int *mapInput = nullptr;
-    int *mapMethod = nullptr;
-    OGREnvelope sEnvelopeMethod;
-    GBool bEnvelopeSet;
-    double progress_max = (double) GetFeatureCount(0);
-    double progress_counter = 0;
-    double progress_ticker = 0;
-    int bSkipFailures = CPLTestBool(CSLFetchNameValueDef(papszOptions, "SKIP_FAILURES", "NO"));
-    int bPromoteToMulti = CPLTestBool(CSLFetchNameValueDef(papszOptions, "PROMOTE_TO_MULTI", "NO"));
-    int bUsePreparedGeometries = CPLTestBool(CSLFetchNameValueDef(papszOptions, "USE_PREPARED_GEOMETRIES", "YES"));
-    if (bUsePreparedGeometries) bUsePreparedGeometries = OGRHasPreparedGeometrySupport();
-    int bPretestContainment = CPLTestBool(CSLFetchNameValueDef(papszOptions, "PRETEST_CONTAINMENT", "NO"));
-    int bKeepLowerDimGeom = CPLTestBool(CSLFetchNameValueDef(papszOptions, "KEEP_LOWER_DIMENSION_GEOMETRIES", "YES"));
+    // A feature of the layer, or only its FID if it is fetched on demand.
+    struct Entry
+    {
+        OGRFeature *poFeature;
+        GIntBig     nFID;
+    };
 
-    // check for GEOS
-    if (!OGRGeometryFactory::haveGEOS()) {
-        return OGRERR_UNSUPPORTED_OPERATION;
+    OGRLayer                *m_poLayer = nullptr;
+    std::vector<Entry>       m_asEntries{};
+    CPLQuadTree             *m_hQuadTree = nullptr;
+    bool                     m_bFetchFeatures = false;
+
+    CPL_DISALLOW_COPY_ASSIGN(OGROverlayIndex)
+
+  public:
+    OGROverlayIndex() = default;
+    ~OGROverlayIndex();
+
+    void Build( OGRLayer *poLayer );
+    void Search( OGRGeometry *poGeom, bool bUsePreparedGeometries,
+                 std::vector<OGRFeature*> &apoFeatures,
+                 std::vector<OGRFeatureUniquePtr> &apoFetched ) const;
+
+    // Whether Search() reads the layer, and thus must not be called from
+    // several threads, or while another thread reads a layer.
+    bool FetchesFeatures() const { return m_bFetchFeatures; }
+};
+
+OGROverlayIndex::~OGROverlayIndex()
+{
+    if( m_hQuadTree )
+        CPLQuadTreeDestroy(m_hQuadTree);
+    for( size_t i = 0; i < m_asEntries.size(); i++ )
+        delete m_asEntries[i].poFeature;
+}
+
+/************************************************************************/
+/*                       OGROverlayIndex::Build()                       */
+/************************************************************************/
+
+void OGROverlayIndex::Build( OGRLayer *poLayer )
+{
+    m_poLayer = poLayer;
+    const GUIntBig nMaxMemory = static_cast<GUIntBig>(std::max(0, atoi(
+        CPLGetConfigOption("OGR_LAYER_ALGEBRA_MAX_MEMORY", "100")))) *
+        1024 * 1024;
+    const bool bRandomRead =
+        CPL_TO_BOOL(poLayer->TestCapability(OLCRandomRead));
+    GUIntBig nMemory = 0;
+
+    OGREnvelope sGlobalEnvelope;
+    std::vector<OGREnvelope> asEnvelopes;
+    OGRFeature *poFeature = nullptr;
+    poLayer->ResetReading();
+    while( (poFeature = poLayer->GetNextFeature()) != nullptr ) {
+        // features without geometry are never selected by a spatial filter
+        OGRGeometry *poGeom = poFeature->GetGeometryRef();
+        if (!poGeom) {
+            delete poFeature;
+            continue;
+        }
+        OGREnvelope sEnvelope;
+        poGeom->getEnvelope(&sEnvelope);
+        sGlobalEnvelope.Merge(sEnvelope);
+        asEnvelopes.push_back(sEnvelope);
+        Entry sEntry;
+        sEntry.poFeature = poFeature;
+        sEntry.nFID = poFeature->GetFID();
+        m_asEntries.push_back(sEntry);
+
+        // features without FID stay in memory
+        size_t iFirstToRelease = m_asEntries.size() - 1;
+        if (!m_bFetchFeatures && bRandomRead) {
+            // rough estimate of the size of the feature in memory
+            nMemory += sizeof(OGRFeature) + poGeom->WkbSize() +
+                poFeature->GetFieldCount() * sizeof(OGRField);
+            if (nMemory > nMaxMemory) {
+                CPLDebug("OGR", "Layer algebra: the features of %s exceed "
+                         "OGR_LAYER_ALGEBRA_MAX_MEMORY, they are fetched "
+                         "by FID", poLayer->GetName());
+                m_bFetchFeatures = true;
+                iFirstToRelease = 0;
+            }
+        }
+        if (m_bFetchFeatures) {
+            for( size_t i = iFirstToRelease; i < m_asEntries.size(); i++ ) {
+                if (m_asEntries[i].nFID != OGRNullFID) {
+                    delete m_asEntries[i].poFeature;
+                    m_asEntries[i].poFeature = nullptr;
+                }
+            }
+        }
     }
+    if (m_asEntries.empty()) return;
+
+    CPLRectObj sGlobalBounds;
+    sGlobalBounds.minx = sGlobalEnvelope.MinX;
+    sGlobalBounds.miny = sGlobalEnvelope.MinY;
+    sGlobalBounds.maxx = sGlobalEnvelope.MaxX;
+    sGlobalBounds.maxy = sGlobalEnvelope.MaxY;
+    m_hQuadTree = CPLQuadTreeCreate(&sGlobalBounds, nullptr);
+    CPLQuadTreeSetMaxDepth(m_hQuadTree,
+        CPLQuadTreeGetAdvisedMaxDepth(static_cast<int>(
+            std::min(m_asEntries.size(), static_cast<size_t>(INT_MAX)))));
+    for( size_t i = 0; i < m_asEntries.size(); i++ ) {
+        CPLRectObj sBounds;
+        sBounds.minx = asEnvelopes[i].MinX;
+        sBounds.miny = asEnvelopes[i].MinY;
+        sBounds.maxx = asEnvelopes[i].MaxX;
+        sBounds.maxy = asEnvelopes[i].MaxY;
+        // the element is the address of the entry, so that the search
+        // results can be sorted back into the order of the layer
+        CPLQuadTreeInsertWithBounds(m_hQuadTree, &m_asEntries[i], &sBounds);
+    }
+}
 
-    // get resources
-    ret = clone_spatial_filter(pLayerMethod, &pGeometryMethodFilter);
-    if (ret != OGRERR_NONE) goto done;
-    ret = create_field_map(poDefnInput, &mapInput);
-    if (ret != OGRERR_NONE) goto done;
-    ret = create_field_map(poDefnMethod, &mapMethod);
-    if (ret != OGRERR_NONE) goto done;
-    ret = set_result_schema(pLayerResult, poDefnInput, poDefnMethod, mapInput, mapMethod, 1, papszOptions);
-    if (ret != OGRERR_NONE) goto done;
-    poDefnResult = pLayerResult->GetLayerDefn();
-    bEnvelopeSet = pLayerMethod->GetExtent(&sEnvelopeMethod, 1) == OGRERR_NONE;
-    if (bKeepLowerDimGeom) {
-        // require that the result layer is of geom type unknown
-        if (pLayerResult->GetGeomType() != wkbUnknown) {
-            CPLDebug("OGR", "Resetting KEEP_LOWER_DIMENSION_GEOMETRIES to NO since the result layer does not allow it.");
-            bKeepLowerDimGeom = FALSE;
+/************************************************************************/
+/*                      OGROverlayIndex::Search()                       */
+/*                                                                      */
+/*      Return, in the order of the layer, the features whose           */
+/*      geometry intersects poGeom, as a spatial filter set to poGeom   */
+/*      would. The intersection tests go through a prepared geometry    */
+/*      when there are several candidates. The features fetched from    */
+/*      the layer are appended to apoFetched, which owns them.          */
+/************************************************************************/
+
+void OGROverlayIndex::Search( OGRGeometry *poGeom,
+                              bool bUsePreparedGeometries,
+                              std::vector<OGRFeature*> &apoFeatures,
+                              std::vector<OGRFeatureUniquePtr> &apoFetched ) const
+{
+    apoFeatures.clear();
+    if (!m_hQuadTree || poGeom->IsEmpty()) return;
+
+    OGREnvelope sEnvelope;
+    poGeom->getEnvelope(&sEnvelope);
+    CPLRectObj sAoi;
+    sAoi.minx = sEnvelope.MinX;
+    sAoi.miny = sEnvelope.MinY;
+    sAoi.maxx = sEnvelope.MaxX;
+    sAoi.maxy = sEnvelope.MaxY;
+    int nCount = 0;
+    void **pahEntries = CPLQuadTreeSearch(m_hQuadTree, &sAoi, &nCount);
+    if (nCount == 0) {
+        CPLFree(pahEntries);
+        return;
+    }
+    std::sort(pahEntries, pahEntries + nCount, std::less<void*>());
+
+    OGRPreparedGeometryUniquePtr poPreparedGeom;
+    if (bUsePreparedGeometries && nCount > 1)
+        poPreparedGeom.reset(OGRCreatePreparedGeometry(poGeom));
+    for( int i = 0; i < nCount; i++ ) {
+        const Entry *psEntry = static_cast<const Entry*>(pahEntries[i]);
+        OGRFeature *poFeature = psEntry->poFeature;
+        OGRFeatureUniquePtr poFetched;
+        if (!poFeature) {
+            poFetched.reset(m_poLayer->GetFeature(psEntry->nFID));
+            poFeature = poFetched.get();
+            if (!poFeature || !poFeature->GetGeometryRef()) {
+                CPLError(CE_Failure, CPLE_AppDefined,
+                         "Cannot fetch feature " CPL_FRMT_GIB " of %s",
+                         psEntry->nFID, m_poLayer->GetName());
+                continue;
+            }
+        }
+        OGRGeometry *poFeatureGeom = poFeature->GetGeometryRef();
+        const bool bIntersects = poPreparedGeom ?
+            CPL_TO_BOOL(OGRPreparedGeometryIntersects(poPreparedGeom.get(),
+                                                      poFeatureGeom)) :
+            CPL_TO_BOOL(poGeom->Intersects(poFeatureGeom));
+        if (bIntersects) {
+            apoFeatures.push_back(poFeature);
+            if (poFetched)
+                apoFetched.push_back(std::move(poFetched));
         }
     }
+    CPLFree(pahEntries);
+}
 
-    for( auto&& x: this ) {
+/************************************************************************/
+/*                          OGROverlayContext                           */
+/************************************************************************/
 
-        if (pfnProgress) {
-            double p = progress_counter/progress_max;
-            if (p > progress_ticker) {
-                if (!pfnProgress(p, "", pProgressArg)) {
-                    CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
-                    ret = OGRERR_FAILURE;
-                    goto done;
+// What the processing of one feature by an overlay method depends on.
+// It is shared, read-only, by the worker threads.
+struct OGROverlayContext
+{
+    const OGROverlayIndex *poIndex = nullptr; // features of the other layer
+    OGRGeometry *pGeometryFilter = nullptr;   // spatial filter of the other layer
+    bool bSkipFailures = false;
+    bool bPromoteToMulti = false;
+    bool bUsePreparedGeometries = true;
+    bool bPretestContainment = false;
+    bool bKeepLowerDimGeom = false;
+};
+
+// A geometry to be written to the result layer, with the attributes of
+// the processed feature and, if not null, of poY from the other layer.
+struct OGROverlayPiece
+{
+    OGRFeature *poY;
+    OGRGeometryUniquePtr poGeom;
+
+    OGROverlayPiece(OGRFeature *poYIn, OGRGeometry *poGeomIn) :
+        poY(poYIn), poGeom(poGeomIn) {}
+};
+
+// The features of the other layer fetched for x are added to apoFetchedY,
+// which keeps them until the pieces are written.
+typedef OGRErr (*OGROverlayFeatureFunc)( const OGROverlayContext *psContext,
+                                         OGRFeature *x,
+                                         std::vector<OGROverlayPiece> &aoPieces,
+                                         std::vector<OGRFeatureUniquePtr> &apoFetchedY );
+
+struct OGROverlayError
+{
+    CPLErr      eErr;
+    CPLErrorNum nErrNo;
+    CPLString   osErrorMsg;
+
+    OGROverlayError(CPLErr eErrIn, CPLErrorNum nErrNoIn,
+                    const char* pszErrorMsg) :
+        eErr(eErrIn), nErrNo(nErrNoIn), osErrorMsg(pszErrorMsg) {}
+};
+
+// The processing of one feature, run by a worker thread.
+struct OGROverlayJob
+{
+    const OGROverlayContext *psContext = nullptr;
+    OGROverlayFeatureFunc pfnFunc = nullptr;
+    OGRFeatureUniquePtr poX{};
+
+    // Set by the job.
+    std::vector<OGROverlayPiece> aoPieces{};
+    std::vector<OGRFeatureUniquePtr> apoFetchedY{};
+    std::vector<OGROverlayError> aoErrors{};
+    OGRErr eErr = OGRERR_NONE;
+};
+
+} // namespace
+
+/************************************************************************/
+/*                   helper functions for the overlay jobs              */
+/************************************************************************/
+
+// Collect the errors emitted in the worker thread, so that they can be
+// re-emitted in the thread of the caller, in the order of the features.
+static void CPL_STDCALL overlay_error_handler(CPLErr eErr, CPLErrorNum nErrNo,
+                                              const char* pszErrorMsg)
+{
+    std::vector<OGROverlayError>* paoErrors =
+        static_cast<std::vector<OGROverlayError> *>(
+            CPLGetErrorHandlerUserData());
+    if (paoErrors)
+        paoErrors->push_back(OGROverlayError(eErr, nErrNo, pszErrorMsg));
+}
+
+static void overlay_job_func(void *pData)
+{
+    OGROverlayJob *psJob = static_cast<OGROverlayJob *>(pData);
+    CPLPushErrorHandlerEx(overlay_error_handler, &psJob->aoErrors);
+    psJob->eErr = psJob->pfnFunc(psJob->psContext, psJob->poX.get(),
+                                 psJob->aoPieces, psJob->apoFetchedY);
+    CPLPopErrorHandler();
+}
+
+static CPLJobQueue *create_overlay_job_queue(int nThreads)
+{
+    CPLWorkerThreadPool* poThreadPool = GDALGetGlobalThreadPool(nThreads);
+    return poThreadPool ?
+        new (std::nothrow) CPLJobQueue(poThreadPool) : nullptr;
+}
+
+// Select the features of the other layer that a spatial filter set from the
+// geometry of x, intersected with the existing spatial filter of the other
+// layer, would select. Returns the geometry of x, or nullptr if there is
+// nothing to do with x.
+static
+OGRGeometry *select_from(const OGROverlayContext *psContext, OGRFeature *x,
+                         std::vector<OGRFeature*> &apoY,
+                         std::vector<OGRFeatureUniquePtr> &apoFetchedY)
+{
+    apoY.clear();
+    OGRGeometry *geom = x->GetGeometryRef();
+    if (!geom) return nullptr;
+    if (psContext->pGeometryFilter) {
+        if (!geom->Intersects(psContext->pGeometryFilter)) return nullptr;
+        OGRGeometryUniquePtr intersection(geom->Intersection(psContext->pGeometryFilter));
+        if (!intersection) return nullptr;
+        psContext->poIndex->Search(intersection.get(), psContext->bUsePreparedGeometries, apoY, apoFetchedY);
+    } else {
+        psContext->poIndex->Search(geom, psContext->bUsePreparedGeometries, apoY, apoFetchedY);
+    }
+    return geom;
+}
+
+// Area of x common with each of the selected features.
+static OGRErr intersection_feature(const OGROverlayContext *psContext,
+                                   OGRFeature *x,
+                                   std::vector<OGROverlayPiece> &aoPieces,
+                                   std::vector<OGRFeatureUniquePtr> &apoFetchedY)
+{
+    std::vector<OGRFeature*> apoY;
+    CPLErrorReset();
+    OGRGeometry *x_geom = select_from(psContext, x, apoY, apoFetchedY);
+    if (CPLGetLastErrorType() != CE_None) {
+        if (!psContext->bSkipFailures) {
+            return OGRERR_FAILURE;
+        } else {
+            CPLErrorReset();
+        }
+    }
+    if (!x_geom) {
+        return OGRERR_NONE;
+    }
+
+    OGRPreparedGeometryUniquePtr x_prepared_geom;
+    if (psContext->bUsePreparedGeometries && psContext->bPretestContainment) {
+        x_prepared_geom.reset(OGRCreatePreparedGeometry(x_geom));
+    }
+
+    for( OGRFeature *y: apoY ) {
+        OGRGeometry *y_geom = y->GetGeometryRef();
+        OGRGeometryUniquePtr z_geom;
+
+        if (x_prepared_geom) {
+            CPLErrorReset();
+            if (OGRPreparedGeometryContains(x_prepared_geom.get(), y_geom)) {
+                if (CPLGetLastErrorType() == CE_None)
+                    z_geom.reset(y_geom->clone());
+            }
+            if (CPLGetLastErrorType() != CE_None) {
+                if (!psContext->bSkipFailures) {
+                    return OGRERR_FAILURE;
+                } else {
+                    CPLErrorReset();
+                    continue;
                 }
             }
-            progress_counter += 1.0;
         }
-
-        // is it worth to proceed?
-        if (bEnvelopeSet) {
-            OGRGeometry *x_geom = x->GetGeometryRef();
-            if (x_geom) {
-                OGREnvelope x_env;
-                x_geom->getEnvelope(&x_env);
-                if (x_env.MaxX < sEnvelopeMethod.MinX
-                    || x_env.MaxY < sEnvelopeMethod.MinY
-                    || sEnvelopeMethod.MaxX < x_env.MinX
-                    || sEnvelopeMethod.MaxY < x_env.MinY) {
+        if (!z_geom) {
+            CPLErrorReset();
+            z_geom.reset(x_geom->Intersection(y_geom));
+            if (CPLGetLastErrorType() != CE_None || z_geom == nullptr) {
+                if (!psContext->bSkipFailures) {
+                    return OGRERR_FAILURE;
+                } else {
+                    CPLErrorReset();
                     continue;
                 }
-            } else {
+            }
+            if (z_geom->IsEmpty() ||
+                (!psContext->bKeepLowerDimGeom &&
+                 (x_geom->getDimension() == y_geom->getDimension() &&
+                  z_geom->getDimension() < x_geom->getDimension())))
+            {
                 continue;
             }
         }
+        if (psContext->bPromoteToMulti)
+            z_geom.reset(promote_to_multi(z_geom.release()));
+        aoPieces.emplace_back(y, z_geom.release());
+    }
+    return OGRERR_NONE;
+}
+
+// Area of x common with each of the selected features, and the remaining
+// area of x.
+static OGRErr identity_feature(const OGROverlayContext *psContext,
+                               OGRFeature *x,
+                               std::vector<OGROverlayPiece> &aoPieces,
+                               std::vector<OGRFeatureUniquePtr> &apoFetchedY)
+{
+    std::vector<OGRFeature*> apoY;
+    CPLErrorReset();
+    OGRGeometry *x_geom = select_from(psContext, x, apoY, apoFetchedY);
+    if (CPLGetLastErrorType() != CE_None) {
+        if (!psContext->bSkipFailures) {
+            return OGRERR_FAILURE;
+        } else {
+            CPLErrorReset();
+        }
+    }
+    if (!x_geom) {
+        return OGRERR_NONE;
+    }
+
+    OGRGeometryUniquePtr x_geom_diff(x_geom->clone()); // this will be the geometry of the result feature
+    for( OGRFeature *y: apoY ) {
+        OGRGeometry *y_geom = y->GetGeometryRef();
 
-        // set up the filter for method layer
         CPLErrorReset();
-        OGRGeometry *x_geom = set_filter_from(pLayerMethod, pGeometryMethodFilter, x.get());
-        if (CPLGetLastErrorType() != CE_None) {
-            if (!bSkipFailures) {
-                ret = OGRERR_FAILURE;
-                goto done;
+        OGRGeometryUniquePtr poIntersection(x_geom->Intersection(y_geom));
+        if (CPLGetLastErrorType() != CE_None || poIntersection == nullptr) {
+            if (!psContext->bSkipFailures) {
+                return OGRERR_FAILURE;
             } else {
                 CPLErrorReset();
-                ret = OGRERR_NONE;
+                continue;
             }
         }
-        if (!x_geom) {
+        if( poIntersection->IsEmpty() ||
+            (!psContext->bKeepLowerDimGeom &&
+             (x_geom->getDimension() == y_geom->getDimension() &&
+              poIntersection->getDimension() < x_geom->getDimension())) )
+        {
             continue;
         }
 
-        OGRPreparedGeometryUniquePtr x_prepared_geom;
-        if (bUsePreparedGeometries) {
-            x_prepared_geom.reset(OGRCreatePreparedGeometry(x_geom));
-            if (!x_prepared_geom) {
-                goto done;
-            }
-        }
+        if( psContext->bPromoteToMulti )
+            poIntersection.reset(promote_to_multi(poIntersection.release()));
+        aoPieces.emplace_back(y, poIntersection.release());
 
-        for( auto&& y: pLayerMethod ) {
-            OGRGeometry *y_geom = y->GetGeometryRef();
-            if (!y_geom) continue;
-            OGRGeometryUniquePtr z_geom;
+        if (x_geom_diff) {
+            CPLErrorReset();
+            OGRGeometryUniquePtr x_geom_diff_new(x_geom_diff->Difference(y_geom));
+            if (CPLGetLastErrorType() != CE_None || x_geom_diff_new == nullptr) {
+                if (!psContext->bSkipFailures) {
+                    return OGRERR_FAILURE;
+                } else {
+                    CPLErrorReset();
+                }
+            } else {
+                x_geom_diff.swap(x_geom_diff_new);
+            }
+        }
+    }
 
-            if (x_prepared_geom) {
+    if (x_geom_diff && !x_geom_diff->IsEmpty()) {
+        if( psContext->bPromoteToMulti )
+            x_geom_diff.reset(promote_to_multi(x_geom_diff.release()));
+        aoPieces.emplace_back(nullptr, x_geom_diff.release());
+    }
+    return OGRERR_NONE;
+}
+
+// Area of x not covered by the selected features.
+static OGRErr erase_feature(const OGROverlayContext *psContext,
+                            OGRFeature *x,
+                            std::vector<OGROverlayPiece> &aoPieces,
+                            std::vector<OGRFeatureUniquePtr> &apoFetchedY)
+{
+    std::vector<OGRFeature*> apoY;
+    CPLErrorReset();
+    OGRGeometry *x_geom = select_from(psContext, x, apoY, apoFetchedY);
+    if (CPLGetLastErrorType() != CE_None) {
+        if (!psContext->bSkipFailures) {
+            return OGRERR_FAILURE;
+        } else {
+            CPLErrorReset();
+        }
+    }
+    if (!x_geom) {
+        return OGRERR_NONE;
+    }
+
+    OGRGeometryUniquePtr geom(x_geom->clone()); // this will be the geometry of the result feature
+    // incrementally erase y from geom
+    for( OGRFeature *y: apoY ) {
+        CPLErrorReset();
+        OGRGeometryUniquePtr geom_new(geom->Difference(y->GetGeometryRef()));
+        if (CPLGetLastErrorType() != CE_None || geom_new == nullptr) {
+            if (!psContext->bSkipFailures) {
+                return OGRERR_FAILURE;
+            } else {
                 CPLErrorReset();
-                ret = OGRERR_NONE;
-                if (bPretestContainment && OGRPreparedGeometryContains(x_prepared_geom.get(), y_geom))
-                {
-                    if (CPLGetLastErrorType() == CE_None)
-                        z_geom.reset(y_geom->clone());
-                }
-                else if (!(OGRPreparedGeometryIntersects(x_prepared_geom.get(), y_geom)))
-                {
-                    if (CPLGetLastErrorType() == CE_None) {
-                        continue;
-                    }
+            }
+        } else {
+            geom.swap(geom_new);
+            if (geom->IsEmpty())
+                break;
+        }
+    }
+
+    // add a new feature if there is remaining area
+    if (!geom->IsEmpty()) {
+        if( psContext->bPromoteToMulti )
+            geom.reset(promote_to_multi(geom.release()));
+        aoPieces.emplace_back(nullptr, geom.release());
+    }
+    return OGRERR_NONE;
+}
+
+// Area of x covered by the union of the selected features.
+static OGRErr clip_feature(const OGROverlayContext *psContext,
+                           OGRFeature *x,
+                           std::vector<OGROverlayPiece> &aoPieces,
+                           std::vector<OGRFeatureUniquePtr> &apoFetchedY)
+{
+    std::vector<OGRFeature*> apoY;
+    CPLErrorReset();
+    OGRGeometry *x_geom = select_from(psContext, x, apoY, apoFetchedY);
+    if (CPLGetLastErrorType() != CE_None) {
+        if (!psContext->bSkipFailures) {
+            return OGRERR_FAILURE;
+        } else {
+            CPLErrorReset();
+        }
+    }
+    if (!x_geom) {
+        return OGRERR_NONE;
+    }
+
+    OGRGeometryUniquePtr geom; // this will be the geometry of the result feature
+    // incrementally add area from y to geom
+    for( OGRFeature *y: apoY ) {
+        OGRGeometry *y_geom = y->GetGeometryRef();
+        if (!geom) {
+            geom.reset(y_geom->clone());
+        } else {
+            CPLErrorReset();
+            OGRGeometryUniquePtr geom_new(geom->Union(y_geom));
+            if (CPLGetLastErrorType() != CE_None || geom_new == nullptr) {
+                if (!psContext->bSkipFailures) {
+                    return OGRERR_FAILURE;
+                } else {
+                    CPLErrorReset();
                 }
-                if (CPLGetLastErrorType() != CE_None) {
-                    if (!bSkipFailures) {
+            } else {
+                geom.swap(geom_new);
+            }
+        }
+    }
+
+    // possibly add a new feature with area x intersection sum of y
+    if (geom) {
+        CPLErrorReset();
+        OGRGeometryUniquePtr poIntersection(x_geom->Intersection(geom.get()));
+        if (CPLGetLastErrorType() != CE_None || poIntersection == nullptr) {
+            if (!psContext->bSkipFailures) {
+                return OGRERR_FAILURE;
+            } else {
+                CPLErrorReset();
+            }
+        }
+        else if( !poIntersection->IsEmpty() )
+        {
+            if( psContext->bPromoteToMulti )
+                poIntersection.reset(promote_to_multi(poIntersection.release()));
+            aoPieces.emplace_back(nullptr, poIntersection.release());
+        }
+    }
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/*                             run_overlay()                            */
+/*                                                                      */
+/*      Process the features of pLayerX with pfnFunc, and write the     */
+/*      result features, with attributes from the processed feature     */
+/*      and the feature of the other layer, to pLayerResult. With       */
+/*      GDAL_NUM_THREADS, batches of features are processed in a        */
+/*      shared pool of worker threads, and the result features are      */
+/*      still written in the order of pLayerX.                          */
+/************************************************************************/
+
+static OGRErr run_overlay(OGRLayer *pLayerX,
+                          OGRLayer *pLayerResult,
+                          const OGROverlayContext *psContext,
+                          OGROverlayFeatureFunc pfnFunc,
+                          int *mapX,
+                          int *mapY,
+                          double &progress_counter,
+                          double progress_max,
+                          double progress_ticker,
+                          GDALProgressFunc pfnProgress,
+                          void *pProgressArg)
+{
+    OGRErr ret = OGRERR_NONE;
+    OGRFeatureDefn *poDefnResult = pLayerResult->GetLayerDefn();
+    const int nThreads = GDALGetNumThreads();
+    // features fetched from the other layer must be read by this thread
+    CPLJobQueue *poJobQueue = psContext->poIndex->FetchesFeatures() ?
+        nullptr : create_overlay_job_queue(nThreads);
+    const size_t nBatchSize = poJobQueue ?
+        static_cast<size_t>(nThreads) * 16 : 1;
+    std::vector<OGROverlayJob> asJobs(nBatchSize);
+
+    pLayerX->ResetReading();
+    bool bEOF = false;
+    while (!bEOF) {
+
+        // read and process a batch of features
+        std::vector<void*> apData;
+        while (apData.size() < nBatchSize) {
+            OGRFeature *x = pLayerX->GetNextFeature();
+            if (!x) {
+                bEOF = true;
+                break;
+            }
+            OGROverlayJob &sJob = asJobs[apData.size()];
+            sJob.psContext = psContext;
+            sJob.pfnFunc = pfnFunc;
+            sJob.poX.reset(x);
+            sJob.aoPieces.clear();
+            sJob.apoFetchedY.clear();
+            sJob.aoErrors.clear();
+            sJob.eErr = OGRERR_NONE;
+            apData.push_back(&sJob);
+        }
+        if (poJobQueue && apData.size() > 1 &&
+            poJobQueue->SubmitJobs(overlay_job_func, apData)) {
+            poJobQueue->WaitCompletion();
+        } else {
+            for( size_t i = 0; i < apData.size(); i++ ) {
+                OGROverlayJob &sJob = asJobs[i];
+                sJob.eErr = pfnFunc(psContext, sJob.poX.get(), sJob.aoPieces,
+                                    sJob.apoFetchedY);
+            }
+        }
+
+        // write the results in the order of the features
+        for( size_t i = 0; i < apData.size(); i++ ) {
+            OGROverlayJob &sJob = asJobs[i];
+
+            if (pfnProgress) {
+                double p = progress_counter/progress_max;
+                if (p > progress_ticker) {
+                    if (!pfnProgress(p, "", pProgressArg)) {
+                        CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
                         ret = OGRERR_FAILURE;
                         goto done;
-                    } else {
-                        CPLErrorReset();
-                        ret = OGRERR_NONE;
-                        continue;
                     }
                 }
+                progress_counter += 1.0;
+            }
+
+            for( size_t j = 0; j < sJob.aoErrors.size(); j++ ) {
+                CPLError(sJob.aoErrors[j].eErr, sJob.aoErrors[j].nErrNo,
+                         "%s", sJob.aoErrors[j].osErrorMsg.c_str());
             }
-            if (!z_geom) {
+            if (!sJob.aoErrors.empty() && sJob.eErr == OGRERR_NONE) {
+                // the job has skipped these failures
                 CPLErrorReset();
-                z_geom.reset(x_geom->Intersection(y_geom));
-                if (CPLGetLastErrorType() != CE_None || z_geom == nullptr) {
-                    if (!bSkipFailures) {
-                        ret = OGRERR_FAILURE;
+            }
+
+            for( size_t j = 0; j < sJob.aoPieces.size(); j++ ) {
+                OGROverlayPiece &oPiece = sJob.aoPieces[j];
+                OGRFeatureUniquePtr z(new OGRFeature(poDefnResult));
+                z->SetFieldsFrom(sJob.poX.get(), mapX);
+                if (oPiece.poY) z->SetFieldsFrom(oPiece.poY, mapY);
+                z->SetGeometryDirectly(oPiece.poGeom.release());
+                ret = pLayerResult->CreateFeature(z.get());
+                if (ret != OGRERR_NONE) {
+                    if (!psContext->bSkipFailures) {
                         goto done;
                     } else {
                         CPLErrorReset();
                         ret = OGRERR_NONE;
-                        continue;
                     }
                 }
-                if (z_geom->IsEmpty() ||
-                    (!bKeepLowerDimGeom &&
-                     (x_geom->getDimension() == y_geom->getDimension() &&
-                      z_geom->getDimension() < x_geom->getDimension())))
-                {
-                    continue;
-                }
             }
-            OGRFeatureUniquePtr z(new OGRFeature(poDefnResult));
-            z->SetFieldsFrom(x.get(), mapInput);
-            z->SetFieldsFrom(y.get(), mapMethod);
-            if (bPromoteToMulti)
-                z_geom.reset(promote_to_multi(z_geom.release()));
-            z->SetGeometryDirectly(z_geom.release());
-            ret = pLayerResult->CreateFeature(z.get());
 
-            if (ret != OGRERR_NONE) {
-                if (!bSkipFailures) {
-                    goto done;
-                } else {
-                    CPLErrorReset();
-                    ret = OGRERR_NONE;
-                }
+            if (sJob.eErr != OGRERR_NONE) {
+                ret = sJob.eErr;
+                goto done;
             }
+            sJob.aoPieces.clear();
+            sJob.apoFetchedY.clear();
+            sJob.poX.reset();
+        }
+    }
+done:
+    delete poJobQueue;
+    return ret;
+}
+
+/************************************************************************/
+/*                          Intersection()                              */
+/************************************************************************/
+/**
+ * \brief Intersection of two layers.
+ *
+ * The result layer contains features whose geometries represent areas
+ * that are common between features in the input layer and in the
+ * method layer. The features in the result layer have attributes from
+ * both input and method layers. The schema of the result layer can be
+ * set by the user or, if it is empty, is initialized to contain all
+ * fields in the input and method layers.
+ *
+ * \note If the schema of the result is set by user and contains
+ * fields that have the same name as a field in input and in method
+ * layer, then the attribute in the result feature will get the value
+ * from the feature of the method layer.
+ *
+ * \note For best performance use the minimum amount of features in
+ * the method layer. Its features are read once and kept in memory,
+ * with a spatial index of their extents. Beyond the size set by the
+ * OGR_LAYER_ALGEBRA_MAX_MEMORY configuration option (in MB, 100 by
+ * default), if the method layer has fast random read, only the FIDs of
+ * its features are kept, the features are fetched by FID when they
+ * are selected, and the features of this layer are processed by a
+ * single thread.
+ *
+ * \note Since GDAL 2.3, the features of this layer are processed in
+ * parallel when the GDAL_NUM_THREADS configuration option is set to a
+ * number of threads or ALL_CPUS. The result features are written in the
+ * same order as with a single thread. The other layer algebra methods
+ * are parallelized the same way.
+ *
+ * \note This method relies on GEOS support. Do not use unless the
+ * GEOS support is compiled in.
+ *
+ * The recognized list of options is:
+ * <ul>
+ * <li>SKIP_FAILURES=YES/NO. Set to YES to go on, even when a
+ *     feature could not be inserted or a GEOS call failed.
+ * <li>PROMOTE_TO_MULTI=YES/NO. Set to YES to convert Polygons
+ *     into MultiPolygons, or LineStrings to MultiLineStrings.
+ * <li>INPUT_PREFIX=string. Set a prefix for the field names that
+ *     will be created from the fields of the input layer.
+ * <li>METHOD_PREFIX=string. Set a prefix for the field names that
+ *     will be created from the fields of the method layer.
+ * <li>USE_PREPARED_GEOMETRIES=YES/NO. Set to NO to not use prepared
+ *     geometries to pretest intersection of features of method layer
+ *     with features of this layer.
+ * <li>PRETEST_CONTAINMENT=YES/NO. Set to YES to pretest the
+ *     containment of features of method layer within the features of
+ *     this layer. This will speed up the method significantly in some
+ *     cases. Requires that the prepared geometries are in effect.
+ * <li>KEEP_LOWER_DIMENSION_GEOMETRIES=YES/NO. Set to NO to skip
+ *     result features with lower dimension geometry that would
+ *     otherwise be added to the result layer. The default is to add
+ *     but only if the result layer has an unknown geometry type.
+ * </ul>
+ *
+ * This method is the same as the C function OGR_L_Intersection().
+ *
+ * @param pLayerMethod the method layer. Should not be NULL.
+ *
+ * @param pLayerResult the layer where the features resulting from the
+ * operation are inserted. Should not be NULL. See above the note
+ * about the schema.
+ *
+ * @param papszOptions NULL terminated list of options (may be NULL).
+ *
+ * @param pfnProgress a GDALProgressFunc() compatible callback function for
+ * reporting progress or NULL.
+ *
+ * @param pProgressArg argument to be passed to pfnProgress. May be NULL.
+ *
+ * @return an error code if there was an error or the execution was
+ * interrupted, OGRERR_NONE otherwise.
+ *
+ * @note The first geometry field is always used.
+ *
+ * @since OGR 1.10
+ */
+
+OGRErr OGRLayer::Intersection( OGRLayer *pLayerMethod,
+                               OGRLayer *pLayerResult,
+                               char** papszOptions,
+                               GDALProgressFunc pfnProgress,
+                               void * pProgressArg )
+{
+    OGRErr ret = OGRERR_NONE;
+    OGRFeatureDefn *poDefnInput = GetLayerDefn();
+    OGRFeatureDefn *poDefnMethod = pLayerMethod->GetLayerDefn();
+    OGRGeometry *pGeometryMethodFilter = nullptr;
+    int *mapInput = nullptr;
+    int *mapMethod = nullptr;
+    OGROverlayIndex oIndexMethod;
+    OGROverlayContext sContext;
+    double progress_max = (double) GetFeatureCount(0);
+    double progress_counter = 0;
+    double progress_ticker = 0;
+    int bSkipFailures = CPLTestBool(CSLFetchNameValueDef(papszOptions, "SKIP_FAILURES", "NO"));
+    int bPromoteToMulti = CPLTestBool(CSLFetchNameValueDef(papszOptions, "PROMOTE_TO_MULTI", "NO"));
+    int bUsePreparedGeometries = CPLTestBool(CSLFetchNameValueDef(papszOptions, "USE_PREPARED_GEOMETRIES", "YES"));
+    if (bUsePreparedGeometries) bUsePreparedGeometries = OGRHasPreparedGeometrySupport();
+    int bPretestContainment = CPLTestBool(CSLFetchNameValueDef(papszOptions, "PRETEST_CONTAINMENT", "NO"));
+    int bKeepLowerDimGeom = CPLTestBool(CSLFetchNameValueDef(papszOptions, "KEEP_LOWER_DIMENSION_GEOMETRIES", "YES"));
+
+    // check for GEOS
+    if (!OGRGeometryFactory::haveGEOS()) {
+        return OGRERR_UNSUPPORTED_OPERATION;
+    }
+
+    // get resources
+    ret = clone_spatial_filter(pLayerMethod, &pGeometryMethodFilter);
+    if (ret != OGRERR_NONE) goto done;
+    ret = create_field_map(poDefnInput, &mapInput);
+    if (ret != OGRERR_NONE) goto done;
+    ret = create_field_map(poDefnMethod, &mapMethod);
+    if (ret != OGRERR_NONE) goto done;
+    ret = set_result_schema(pLayerResult, poDefnInput, poDefnMethod, mapInput, mapMethod, 1, papszOptions);
+    if (ret != OGRERR_NONE) goto done;
+    if (bKeepLowerDimGeom) {
+        // require that the result layer is of geom type unknown
+        if (pLayerResult->GetGeomType() != wkbUnknown) {
+            CPLDebug("OGR", "Resetting KEEP_LOWER_DIMENSION_GEOMETRIES to NO since the result layer does not allow it.");
+            bKeepLowerDimGeom = FALSE;
         }
     }
+
+    // read the method layer once
+    oIndexMethod.Build(pLayerMethod);
+    sContext.poIndex = &oIndexMethod;
+    sContext.pGeometryFilter = pGeometryMethodFilter;
+    sContext.bSkipFailures = CPL_TO_BOOL(bSkipFailures);
+    sContext.bPromoteToMulti = CPL_TO_BOOL(bPromoteToMulti);
+    sContext.bUsePreparedGeometries = CPL_TO_BOOL(bUsePreparedGeometries);
+    sContext.bPretestContainment = CPL_TO_BOOL(bPretestContainment);
+    sContext.bKeepLowerDimGeom = CPL_TO_BOOL(bKeepLowerDimGeom);
+
+    ret = run_overlay(this, pLayerResult, &sContext, intersection_feature,
+                      mapInput, mapMethod, progress_counter, progress_max,
+                      progress_ticker, pfnProgress, pProgressArg);
+    if (ret != OGRERR_NONE) goto done;
+
     if (pfnProgress && !pfnProgress(1.0, "", pProgressArg)) {
       CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
       ret = OGRERR_FAILURE;
@@ -2230,7 +2827,6 @@ OGRErr OGRLayer::Intersection( OGRLayer *pLayerMethod,
     }
 done:
     // release resources
-    pLayerMethod->SetSpatialFilter(pGeometryMethodFilter);
     if (pGeometryMethodFilter) delete pGeometryMethodFilter;
     if (mapInput) VSIFree(mapInput);
     if (mapMethod) VSIFree(mapMethod);
@@ -2256,7 +2852,16 @@ done:
  * from the feature of the method layer.
  *
  * \note For best performance use the minimum amount of features in
- * the method layer and copy it into a memory layer.
+ * the method layer. Its features are read once and kept in memory,
+ * with a spatial index of their extents. Beyond the size set by the
+ * OGR_LAYER_ALGEBRA_MAX_MEMORY configuration option (in MB, 100 by
+ * default), if the method layer has fast random read, only the FIDs of
+ * its features are kept, the features are fetched by FID when they
+ * are selected, and the features of this layer are processed by a
+ * single thread.
+ *
+ * \note The features of the input layer are processed in parallel, as
+ * described in OGRLayer::Intersection().
  *
  * \note This method relies on GEOS support. Do not use unless the
  * GEOS support is compiled in.
@@ -2349,7 +2954,13 @@ OGRErr OGR_L_Intersection( OGRLayerH pLayerInput,
  * from the feature of the method layer (even if it is undefined).
  *
  * \note For best performance use the minimum amount of features in
- * the method layer and copy it into a memory layer.
+ * the method layer. The features of the method layer, and then of this
+ * layer, are read once and kept in memory, with a spatial index of
+ * their extents, up to the size set by OGR_LAYER_ALGEBRA_MAX_MEMORY as
+ * described in Intersection().
+ *
+ * \note The features of this layer, and then of the method layer, are
+ * processed in parallel, as described in Intersection().
  *
  * \note This method relies on GEOS support. Do not use unless the
  * GEOS support is compiled in.
@@ -2405,11 +3016,13 @@ OGRErr OGRLayer::Union( OGRLayer *pLayerMethod,
     OGRErr ret = OGRERR_NONE;
     OGRFeatureDefn *poDefnInput = GetLayerDefn();
     OGRFeatureDefn *poDefnMethod = pLayerMethod->GetLayerDefn();
-    OGRFeatureDefn *poDefnResult = nullptr;
     OGRGeometry *pGeometryMethodFilter = nullptr;
     OGRGeometry *pGeometryInputFilter = nullptr;
     int *mapInput = nullptr;
     int *mapMethod = nullptr;
+    OGROverlayIndex oIndexMethod;
+    OGROverlayIndex oIndexInput;
+    OGROverlayContext sContext;
     double progress_max = (double) GetFeatureCount(0) + (double) pLayerMethod->GetFeatureCount(0);
     double progress_counter = 0;
     double progress_ticker = 0;
@@ -2435,7 +3048,6 @@ OGRErr OGRLayer::Union( OGRLayer *pLayerMethod,
     if (ret != OGRERR_NONE) goto done;
     ret = set_result_schema(pLayerResult, poDefnInput, poDefnMethod, mapInput, mapMethod, 1, papszOptions);
     if (ret != OGRERR_NONE) goto done;
-    poDefnResult = pLayerResult->GetLayerDefn();
     if (bKeepLowerDimGeom) {
         // require that the result layer is of geom type unknown
         if (pLayerResult->GetGeomType() != wkbUnknown) {
@@ -2445,220 +3057,27 @@ OGRErr OGRLayer::Union( OGRLayer *pLayerMethod,
     }
 
     // add features based on input layer
-    for( auto&& x: this ) {
-
-        if (pfnProgress) {
-            double p = progress_counter/progress_max;
-            if (p > progress_ticker) {
-                if (!pfnProgress(p, "", pProgressArg)) {
-                    CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
-                    ret = OGRERR_FAILURE;
-                    goto done;
-                }
-            }
-            progress_counter += 1.0;
-        }
-
-        // set up the filter on method layer
-        CPLErrorReset();
-        OGRGeometry *x_geom = set_filter_from(pLayerMethod, pGeometryMethodFilter, x.get());
-        if (CPLGetLastErrorType() != CE_None) {
-            if (!bSkipFailures) {
-                ret = OGRERR_FAILURE;
-                goto done;
-            } else {
-                CPLErrorReset();
-                ret = OGRERR_NONE;
-            }
-        }
-        if (!x_geom) {
-            continue;
-        }
-
-        OGRPreparedGeometryUniquePtr x_prepared_geom;
-        if (bUsePreparedGeometries) {
-            x_prepared_geom.reset(OGRCreatePreparedGeometry(x_geom));
-            if (!x_prepared_geom) {
-                goto done;
-            }
-        }
-
-        OGRGeometryUniquePtr x_geom_diff(x_geom->clone()); // this will be the geometry of the result feature
-        for( auto&& y: pLayerMethod) {
-            OGRGeometry *y_geom = y->GetGeometryRef();
-            if (!y_geom) { continue;}
-
-            CPLErrorReset();
-            if (x_prepared_geom && !(OGRPreparedGeometryIntersects(x_prepared_geom.get(), y_geom))) {
-                if (CPLGetLastErrorType() == CE_None) {
-                    continue;
-                }
-            }
-            if (CPLGetLastErrorType() != CE_None) {
-                if (!bSkipFailures) {
-                    ret = OGRERR_FAILURE;
-                    goto done;
-                } else {
-                    CPLErrorReset();
-                    ret = OGRERR_NONE;
-                }
-            }
-
-            CPLErrorReset();
-            OGRGeometryUniquePtr poIntersection(x_geom->Intersection(y_geom));
-            if (CPLGetLastErrorType() != CE_None || poIntersection == nullptr) {
-                if (!bSkipFailures) {
-                    ret = OGRERR_FAILURE;
-                    goto done;
-                } else {
-                    CPLErrorReset();
-                    ret = OGRERR_NONE;
-                    continue;
-                }
-            }
-            if( poIntersection->IsEmpty() ||
-                (!bKeepLowerDimGeom &&
-                 (x_geom->getDimension() == y_geom->getDimension() &&
-                  poIntersection->getDimension() < x_geom->getDimension())) )
-            {
-                // ok
-            }
-            else
-            {
-                OGRFeatureUniquePtr z(new OGRFeature(poDefnResult));
-                z->SetFieldsFrom(x.get(), mapInput);
-                z->SetFieldsFrom(y.get(), mapMethod);
-                if( bPromoteToMulti )
-                    poIntersection.reset(promote_to_multi(poIntersection.release()));
-                z->SetGeometryDirectly(poIntersection.release());
-
-                if (x_geom_diff) {
-                    CPLErrorReset();
-                    OGRGeometryUniquePtr x_geom_diff_new(x_geom_diff->Difference(y_geom));
-                    if (CPLGetLastErrorType() != CE_None || x_geom_diff_new == nullptr) {
-                        if (!bSkipFailures) {
-                            ret = OGRERR_FAILURE;
-                            goto done;
-                        } else {
-                            CPLErrorReset();
-                        }
-                    } else {
-                        x_geom_diff.swap(x_geom_diff_new);
-                    }
-                }
-
-                ret = pLayerResult->CreateFeature(z.get());
-                if (ret != OGRERR_NONE) {
-                    if (!bSkipFailures) {
-                        goto done;
-                    } else {
-                        CPLErrorReset();
-                        ret = OGRERR_NONE;
-                    }
-                }
-            }
-        }
-        x_prepared_geom.reset();
-
-        if( x_geom_diff == nullptr || x_geom_diff->IsEmpty() )
-        {
-            // ok
-        }
-        else
-        {
-            OGRFeatureUniquePtr z(new OGRFeature(poDefnResult));
-            z->SetFieldsFrom(x.get(), mapInput);
-            if( bPromoteToMulti )
-                x_geom_diff.reset(promote_to_multi(x_geom_diff.release()));
-            z->SetGeometryDirectly(x_geom_diff.release());
-            ret = pLayerResult->CreateFeature(z.get());
-            if (ret != OGRERR_NONE) {
-                if (!bSkipFailures) {
-                    goto done;
-                } else {
-                    CPLErrorReset();
-                    ret = OGRERR_NONE;
-                }
-            }
-        }
-    }
-
-    // restore filter on method layer and add features based on it
-    pLayerMethod->SetSpatialFilter(pGeometryMethodFilter);
-    for( auto&& x: pLayerMethod ) {
-
-        if (pfnProgress) {
-            double p = progress_counter/progress_max;
-            if (p > progress_ticker) {
-                if (!pfnProgress(p, "", pProgressArg)) {
-                    CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
-                    ret = OGRERR_FAILURE;
-                    goto done;
-                }
-            }
-            progress_counter += 1.0;
-        }
-
-        // set up the filter on input layer
-        CPLErrorReset();
-        OGRGeometry *x_geom = set_filter_from(this, pGeometryInputFilter, x.get());
-        if (CPLGetLastErrorType() != CE_None) {
-            if (!bSkipFailures) {
-                ret = OGRERR_FAILURE;
-                goto done;
-            } else {
-                CPLErrorReset();
-                ret = OGRERR_NONE;
-            }
-        }
-        if (!x_geom) {
-            continue;
-        }
-
-        OGRGeometryUniquePtr x_geom_diff(x_geom->clone()); // this will be the geometry of the result feature
-        for( auto&& y: this ) {
-            OGRGeometry *y_geom = y->GetGeometryRef();
-            if (!y_geom) { continue;}
+    oIndexMethod.Build(pLayerMethod);
+    sContext.poIndex = &oIndexMethod;
+    sContext.pGeometryFilter = pGeometryMethodFilter;
+    sContext.bSkipFailures = CPL_TO_BOOL(bSkipFailures);
+    sContext.bPromoteToMulti = CPL_TO_BOOL(bPromoteToMulti);
+    sContext.bUsePreparedGeometries = CPL_TO_BOOL(bUsePreparedGeometries);
+    sContext.bKeepLowerDimGeom = CPL_TO_BOOL(bKeepLowerDimGeom);
+    ret = run_overlay(this, pLayerResult, &sContext, identity_feature,
+                      mapInput, mapMethod, progress_counter, progress_max,
+                      progress_ticker, pfnProgress, pProgressArg);
+    if (ret != OGRERR_NONE) goto done;
 
-            if (x_geom_diff) {
-                CPLErrorReset();
-                OGRGeometryUniquePtr x_geom_diff_new(x_geom_diff->Difference(y_geom));
-                if (CPLGetLastErrorType() != CE_None || x_geom_diff_new == nullptr) {
-                    if (!bSkipFailures) {
-                        ret = OGRERR_FAILURE;
-                        goto done;
-                    } else {
-                        CPLErrorReset();
-                        ret = OGRERR_NONE;
-                    }
-                } else {
-                    x_geom_diff.swap(x_geom_diff_new);
-                }
-            }
-        }
+    // add features based on method layer
+    oIndexInput.Build(this);
+    sContext.poIndex = &oIndexInput;
+    sContext.pGeometryFilter = pGeometryInputFilter;
+    ret = run_overlay(pLayerMethod, pLayerResult, &sContext, erase_feature,
+                      mapMethod, nullptr, progress_counter, progress_max,
+                      progress_ticker, pfnProgress, pProgressArg);
+    if (ret != OGRERR_NONE) goto done;
 
-        if( x_geom_diff == nullptr || x_geom_diff->IsEmpty() )
-        {
-            // ok
-        }
-        else
-        {
-            OGRFeatureUniquePtr z(new OGRFeature(poDefnResult));
-            z->SetFieldsFrom(x.get(), mapMethod);
-            if( bPromoteToMulti )
-                x_geom_diff.reset(promote_to_multi(x_geom_diff.release()));
-            z->SetGeometryDirectly(x_geom_diff.release());
-            ret = pLayerResult->CreateFeature(z.get());
-            if (ret != OGRERR_NONE) {
-                if (!bSkipFailures) {
-                    goto done;
-                } else {
-                    CPLErrorReset();
-                    ret = OGRERR_NONE;
-                }
-            }
-        }
-    }
     if (pfnProgress && !pfnProgress(1.0, "", pProgressArg)) {
       CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
       ret = OGRERR_FAILURE;
@@ -2666,8 +3085,6 @@ OGRErr OGRLayer::Union( OGRLayer *pLayerMethod,
     }
 done:
     // release resources
-    SetSpatialFilter(pGeometryInputFilter);
-    pLayerMethod->SetSpatialFilter(pGeometryMethodFilter);
     if (pGeometryMethodFilter) delete pGeometryMethodFilter;
     if (pGeometryInputFilter) delete pGeometryInputFilter;
     if (mapInput) VSIFree(mapInput);
@@ -2697,7 +3114,13 @@ done:
  * from the feature of the method layer (even if it is undefined).
  *
  * \note For best performance use the minimum amount of features in
- * the method layer and copy it into a memory layer.
+ * the method layer. The features of the method layer, and then of this
+ * layer, are read once and kept in memory, with a spatial index of
+ * their extents, up to the size set by OGR_LAYER_ALGEBRA_MAX_MEMORY as
+ * described in Intersection().
+ *
+ * \note The features of the input layer, and then of the method layer,
+ * are processed in parallel, as described in OGRLayer::Intersection().
  *
  * \note This method relies on GEOS support. Do not use unless the
  * GEOS support is compiled in.
@@ -2786,7 +3209,13 @@ OGRErr OGR_L_Union( OGRLayerH pLayerInput,
  * from the feature of the method layer (even if it is undefined).
  *
  * \note For best performance use the minimum amount of features in
- * the method layer and copy it into a memory layer.
+ * the method layer. The features of the method layer, and then of this
+ * layer, are read once and kept in memory, with a spatial index of
+ * their extents, up to the size set by OGR_LAYER_ALGEBRA_MAX_MEMORY as
+ * described in Intersection().
+ *
+ * \note The features of this layer, and then of the method layer, are
+ * processed in parallel, as described in Intersection().
  *
  * \note This method relies on GEOS support. Do not use unless the
  * GEOS support is compiled in.
@@ -2835,11 +3264,13 @@ OGRErr OGRLayer::SymDifference( OGRLayer *pLayerMethod,
     OGRErr ret = OGRERR_NONE;
     OGRFeatureDefn *poDefnInput = GetLayerDefn();
     OGRFeatureDefn *poDefnMethod = pLayerMethod->GetLayerDefn();
-    OGRFeatureDefn *poDefnResult = nullptr;
     OGRGeometry *pGeometryMethodFilter = nullptr;
     OGRGeometry *pGeometryInputFilter = nullptr;
     int *mapInput = nullptr;
     int *mapMethod = nullptr;
+    OGROverlayIndex oIndexMethod;
+    OGROverlayIndex oIndexInput;
+    OGROverlayContext sContext;
     double progress_max = (double) GetFeatureCount(0) + (double) pLayerMethod->GetFeatureCount(0);
     double progress_counter = 0;
     double progress_ticker = 0;
@@ -2862,150 +3293,28 @@ OGRErr OGRLayer::SymDifference( OGRLayer *pLayerMethod,
     if (ret != OGRERR_NONE) goto done;
     ret = set_result_schema(pLayerResult, poDefnInput, poDefnMethod, mapInput, mapMethod, 1, papszOptions);
     if (ret != OGRERR_NONE) goto done;
-    poDefnResult = pLayerResult->GetLayerDefn();
 
     // add features based on input layer
-    for( auto&& x: this ) {
-
-        if (pfnProgress) {
-            double p = progress_counter/progress_max;
-            if (p > progress_ticker) {
-                if (!pfnProgress(p, "", pProgressArg)) {
-                    CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
-                    ret = OGRERR_FAILURE;
-                    goto done;
-                }
-            }
-            progress_counter += 1.0;
-        }
-
-        // set up the filter on method layer
-        CPLErrorReset();
-        OGRGeometry *x_geom = set_filter_from(pLayerMethod, pGeometryMethodFilter, x.get());
-        if (CPLGetLastErrorType() != CE_None) {
-            if (!bSkipFailures) {
-                ret = OGRERR_FAILURE;
-                goto done;
-            } else {
-                CPLErrorReset();
-                ret = OGRERR_NONE;
-            }
-        }
-        if (!x_geom) {
-            continue;
-        }
-
-        OGRGeometryUniquePtr geom(x_geom->clone()); // this will be the geometry of the result feature
-        for( auto&& y: pLayerMethod ) {
-            OGRGeometry *y_geom = y->GetGeometryRef();
-            if (!y_geom) {continue;}
-            if (geom) {
-                CPLErrorReset();
-                OGRGeometryUniquePtr geom_new(geom->Difference(y_geom));
-                if (CPLGetLastErrorType() != CE_None || geom_new == nullptr) {
-                    if (!bSkipFailures) {
-                        ret = OGRERR_FAILURE;
-                        goto done;
-                    } else {
-                        CPLErrorReset();
-                        ret = OGRERR_NONE;
-                    }
-                } else {
-                    geom.swap(geom_new);
-                }
-            }
-            if (geom && geom->IsEmpty()) break;
-        }
-
-        if (geom && !geom->IsEmpty()) {
-            OGRFeatureUniquePtr z(new OGRFeature(poDefnResult));
-            z->SetFieldsFrom(x.get(), mapInput);
-            if( bPromoteToMulti )
-                geom.reset(promote_to_multi(geom.release()));
-            z->SetGeometryDirectly(geom.release());
-            ret = pLayerResult->CreateFeature(z.get());
-            if (ret != OGRERR_NONE) {
-                if (!bSkipFailures) {
-                    goto done;
-                } else {
-                    CPLErrorReset();
-                    ret = OGRERR_NONE;
-                }
-            }
-        }
-    }
-
-    // restore filter on method layer and add features based on it
-    pLayerMethod->SetSpatialFilter(pGeometryMethodFilter);
-    for( auto&& x: pLayerMethod ) {
-
-        if (pfnProgress) {
-            double p = progress_counter/progress_max;
-            if (p > progress_ticker) {
-                if (!pfnProgress(p, "", pProgressArg)) {
-                    CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
-                    ret = OGRERR_FAILURE;
-                    goto done;
-                }
-            }
-            progress_counter += 1.0;
-        }
-
-        // set up the filter on input layer
-        CPLErrorReset();
-        OGRGeometry *x_geom = set_filter_from(this, pGeometryInputFilter, x.get());
-        if (CPLGetLastErrorType() != CE_None) {
-            if (!bSkipFailures) {
-                ret = OGRERR_FAILURE;
-                goto done;
-            } else {
-                CPLErrorReset();
-                ret = OGRERR_NONE;
-            }
-        }
-        if (!x_geom) {
-            continue;
-        }
+    oIndexMethod.Build(pLayerMethod);
+    sContext.poIndex = &oIndexMethod;
+    sContext.pGeometryFilter = pGeometryMethodFilter;
+    sContext.bSkipFailures = CPL_TO_BOOL(bSkipFailures);
+    sContext.bPromoteToMulti = CPL_TO_BOOL(bPromoteToMulti);
+    sContext.bUsePreparedGeometries = CPL_TO_BOOL(OGRHasPreparedGeometrySupport());
+    ret = run_overlay(this, pLayerResult, &sContext, erase_feature,
+                      mapInput, nullptr, progress_counter, progress_max,
+                      progress_ticker, pfnProgress, pProgressArg);
+    if (ret != OGRERR_NONE) goto done;
 
-        OGRGeometryUniquePtr geom(x_geom->clone()); // this will be the geometry of the result feature
-        for( auto&& y: this ) {
-            OGRGeometry *y_geom = y->GetGeometryRef();
-            if (!y_geom) continue;
-            if (geom) {
-                CPLErrorReset();
-                OGRGeometryUniquePtr geom_new(geom->Difference(y_geom));
-                if (CPLGetLastErrorType() != CE_None || geom_new == nullptr) {
-                    if (!bSkipFailures) {
-                        ret = OGRERR_FAILURE;
-                        goto done;
-                    } else {
-                        CPLErrorReset();
-                        ret = OGRERR_NONE;
-                    }
-                } else {
-                    geom.swap(geom_new);
-                }
-            }
-            if (geom == nullptr || geom->IsEmpty()) break;
-        }
+    // add features based on method layer
+    oIndexInput.Build(this);
+    sContext.poIndex = &oIndexInput;
+    sContext.pGeometryFilter = pGeometryInputFilter;
+    ret = run_overlay(pLayerMethod, pLayerResult, &sContext, erase_feature,
+                      mapMethod, nullptr, progress_counter, progress_max,
+                      progress_ticker, pfnProgress, pProgressArg);
+    if (ret != OGRERR_NONE) goto done;
 
-        if (geom && !geom->IsEmpty()) {
-            OGRFeatureUniquePtr z(new OGRFeature(poDefnResult));
-            z->SetFieldsFrom(x.get(), mapMethod);
-            if( bPromoteToMulti )
-                geom.reset(promote_to_multi(geom.release()));
-            z->SetGeometryDirectly(geom.release());
-            ret = pLayerResult->CreateFeature(z.get());
-            if (ret != OGRERR_NONE) {
-                if (!bSkipFailures) {
-                    goto done;
-                } else {
-                    CPLErrorReset();
-                    ret = OGRERR_NONE;
-                }
-            }
-        }
-    }
     if (pfnProgress && !pfnProgress(1.0, "", pProgressArg)) {
       CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
       ret = OGRERR_FAILURE;
@@ -3013,8 +3322,6 @@ OGRErr OGRLayer::SymDifference( OGRLayer *pLayerMethod,
     }
 done:
     // release resources
-    SetSpatialFilter(pGeometryInputFilter);
-    pLayerMethod->SetSpatialFilter(pGeometryMethodFilter);
     if (pGeometryMethodFilter) delete pGeometryMethodFilter;
     if (pGeometryInputFilter) delete pGeometryInputFilter;
     if (mapInput) VSIFree(mapInput);
@@ -3044,7 +3351,13 @@ done:
  * from the feature of the method layer (even if it is undefined).
  *
  * \note For best performance use the minimum amount of features in
- * the method layer and copy it into a memory layer.
+ * the method layer. The features of the method layer, and then of this
+ * layer, are read once and kept in memory, with a spatial index of
+ * their extents, up to the size set by OGR_LAYER_ALGEBRA_MAX_MEMORY as
+ * described in Intersection().
+ *
+ * \note The features of the input layer, and then of the method layer,
+ * are processed in parallel, as described in OGRLayer::Intersection().
  *
  * \note This method relies on GEOS support. Do not use unless the
  * GEOS support is compiled in.
@@ -3124,7 +3437,16 @@ OGRErr OGR_L_SymDifference( OGRLayerH pLayerInput,
  * from the feature of the method layer (even if it is undefined).
  *
  * \note For best performance use the minimum amount of features in
- * the method layer and copy it into a memory layer.
+ * the method layer. Its features are read once and kept in memory,
+ * with a spatial index of their extents. Beyond the size set by the
+ * OGR_LAYER_ALGEBRA_MAX_MEMORY configuration option (in MB, 100 by
+ * default), if the method layer has fast random read, only the FIDs of
+ * its features are kept, the features are fetched by FID when they
+ * are selected, and the features of this layer are processed by a
+ * single thread.
+ *
+ * \note The features of this layer are processed in parallel, as
+ * described in Intersection().
  *
  * \note This method relies on GEOS support. Do not use unless the
  * GEOS support is compiled in.
@@ -3180,10 +3502,11 @@ OGRErr OGRLayer::Identity( OGRLayer *pLayerMethod,
     OGRErr ret = OGRERR_NONE;
     OGRFeatureDefn *poDefnInput = GetLayerDefn();
     OGRFeatureDefn *poDefnMethod = pLayerMethod->GetLayerDefn();
-    OGRFeatureDefn *poDefnResult = nullptr;
     OGRGeometry *pGeometryMethodFilter = nullptr;
     int *mapInput = nullptr;
     int *mapMethod = nullptr;
+    OGROverlayIndex oIndexMethod;
+    OGROverlayContext sContext;
     double progress_max = (double) GetFeatureCount(0);
     double progress_counter = 0;
     double progress_ticker = 0;
@@ -3214,145 +3537,20 @@ OGRErr OGRLayer::Identity( OGRLayer *pLayerMethod,
     if (ret != OGRERR_NONE) goto done;
     ret = set_result_schema(pLayerResult, poDefnInput, poDefnMethod, mapInput, mapMethod, 1, papszOptions);
     if (ret != OGRERR_NONE) goto done;
-    poDefnResult = pLayerResult->GetLayerDefn();
 
     // split the features in input layer to the result layer
-    for( auto&& x: this ) {
-
-        if (pfnProgress) {
-            double p = progress_counter/progress_max;
-            if (p > progress_ticker) {
-                if (!pfnProgress(p, "", pProgressArg)) {
-                    CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
-                    ret = OGRERR_FAILURE;
-                    goto done;
-                }
-            }
-            progress_counter += 1.0;
-        }
-
-        // set up the filter on method layer
-        CPLErrorReset();
-        OGRGeometry *x_geom = set_filter_from(pLayerMethod, pGeometryMethodFilter, x.get());
-        if (CPLGetLastErrorType() != CE_None) {
-            if (!bSkipFailures) {
-                ret = OGRERR_FAILURE;
-                goto done;
-            } else {
-                CPLErrorReset();
-                ret = OGRERR_NONE;
-            }
-        }
-        if (!x_geom) {
-            continue;
-        }
-
-        OGRPreparedGeometryUniquePtr x_prepared_geom;
-        if (bUsePreparedGeometries) {
-            x_prepared_geom.reset(OGRCreatePreparedGeometry(x_geom));
-            if (!x_prepared_geom) {
-                goto done;
-            }
-        }
-
-        OGRGeometryUniquePtr x_geom_diff(x_geom->clone()); // this will be the geometry of the result feature
-        for( auto&& y: pLayerMethod ) {
-            OGRGeometry *y_geom = y->GetGeometryRef();
-            if (!y_geom)
-                continue;
-
-            CPLErrorReset();
-            if (x_prepared_geom && !(OGRPreparedGeometryIntersects(x_prepared_geom.get(), y_geom))) {
-                if (CPLGetLastErrorType() == CE_None) {
-                    continue;
-                }
-            }
-            if (CPLGetLastErrorType() != CE_None) {
-                if (!bSkipFailures) {
-                    ret = OGRERR_FAILURE;
-                    goto done;
-                } else {
-                    CPLErrorReset();
-                    ret = OGRERR_NONE;
-                }
-            }
-
-            CPLErrorReset();
-            OGRGeometryUniquePtr poIntersection(x_geom->Intersection(y_geom));
-            if (CPLGetLastErrorType() != CE_None || poIntersection == nullptr) {
-                if (!bSkipFailures) {
-                    ret = OGRERR_FAILURE;
-                    goto done;
-                } else {
-                    CPLErrorReset();
-                    ret = OGRERR_NONE;
-                }
-            }
-            else if( poIntersection->IsEmpty() ||
-                     (!bKeepLowerDimGeom &&
-                      (x_geom->getDimension() == y_geom->getDimension() &&
-                       poIntersection->getDimension() < x_geom->getDimension())) )
-            {
-                /* ok*/
-            }
-            else
-            {
-                OGRFeatureUniquePtr z(new OGRFeature(poDefnResult));
-                z->SetFieldsFrom(x.get(), mapInput);
-                z->SetFieldsFrom(y.get(), mapMethod);
-                if( bPromoteToMulti )
-                    poIntersection.reset(promote_to_multi(poIntersection.release()));
-                z->SetGeometryDirectly(poIntersection.release());
-                if (x_geom_diff) {
-                    CPLErrorReset();
-                    OGRGeometryUniquePtr x_geom_diff_new(x_geom_diff->Difference(y_geom));
-                    if (CPLGetLastErrorType() != CE_None || x_geom_diff_new == nullptr) {
-                        if (!bSkipFailures) {
-                            ret = OGRERR_FAILURE;
-                            goto done;
-                        } else {
-                            CPLErrorReset();
-                        }
-                    } else {
-                        x_geom_diff.swap(x_geom_diff_new);
-                    }
-                }
-                ret = pLayerResult->CreateFeature(z.get());
-                if (ret != OGRERR_NONE) {
-                    if (!bSkipFailures) {
-                        goto done;
-                    } else {
-                        CPLErrorReset();
-                        ret = OGRERR_NONE;
-                    }
-                }
-            }
-        }
-
-        x_prepared_geom.reset();
+    oIndexMethod.Build(pLayerMethod);
+    sContext.poIndex = &oIndexMethod;
+    sContext.pGeometryFilter = pGeometryMethodFilter;
+    sContext.bSkipFailures = CPL_TO_BOOL(bSkipFailures);
+    sContext.bPromoteToMulti = CPL_TO_BOOL(bPromoteToMulti);
+    sContext.bUsePreparedGeometries = CPL_TO_BOOL(bUsePreparedGeometries);
+    sContext.bKeepLowerDimGeom = CPL_TO_BOOL(bKeepLowerDimGeom);
+    ret = run_overlay(this, pLayerResult, &sContext, identity_feature,
+                      mapInput, mapMethod, progress_counter, progress_max,
+                      progress_ticker, pfnProgress, pProgressArg);
+    if (ret != OGRERR_NONE) goto done;
 
-        if( x_geom_diff == nullptr || x_geom_diff->IsEmpty() )
-        {
-            /* ok */
-        }
-        else
-        {
-            OGRFeatureUniquePtr z(new OGRFeature(poDefnResult));
-            z->SetFieldsFrom(x.get(), mapInput);
-            if( bPromoteToMulti )
-                x_geom_diff.reset(promote_to_multi(x_geom_diff.release()));
-            z->SetGeometryDirectly(x_geom_diff.release());
-            ret = pLayerResult->CreateFeature(z.get());
-            if (ret != OGRERR_NONE) {
-                if (!bSkipFailures) {
-                    goto done;
-                } else {
-                    CPLErrorReset();
-                    ret = OGRERR_NONE;
-                }
-            }
-        }
-    }
     if (pfnProgress && !pfnProgress(1.0, "", pProgressArg)) {
       CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
       ret = OGRERR_FAILURE;
@@ -3360,7 +3558,6 @@ OGRErr OGRLayer::Identity( OGRLayer *pLayerMethod,
     }
 done:
     // release resources
-    pLayerMethod->SetSpatialFilter(pGeometryMethodFilter);
     if (pGeometryMethodFilter) delete pGeometryMethodFilter;
     if (mapInput) VSIFree(mapInput);
     if (mapMethod) VSIFree(mapMethod);
@@ -3387,7 +3584,16 @@ done:
  * from the feature of the method layer (even if it is undefined).
  *
  * \note For best performance use the minimum amount of features in
- * the method layer and copy it into a memory layer.
+ * the method layer. Its features are read once and kept in memory,
+ * with a spatial index of their extents. Beyond the size set by the
+ * OGR_LAYER_ALGEBRA_MAX_MEMORY configuration option (in MB, 100 by
+ * default), if the method layer has fast random read, only the FIDs of
+ * its features are kept, the features are fetched by FID when they
+ * are selected, and the features of this layer are processed by a
+ * single thread.
+ *
+ * \note The features of the input layer are processed in parallel, as
+ * described in OGRLayer::Intersection().
  *
  * \note This method relies on GEOS support. Do not use unless the
  * GEOS support is compiled in.
@@ -3476,7 +3682,16 @@ OGRErr OGR_L_Identity( OGRLayerH pLayerInput,
  * layer will get the value from the feature of the method layer.
  *
  * \note For best performance use the minimum amount of features in
- * the method layer and copy it into a memory layer.
+ * the method layer. Its features are read once and kept in memory,
+ * with a spatial index of their extents. Beyond the size set by the
+ * OGR_LAYER_ALGEBRA_MAX_MEMORY configuration option (in MB, 100 by
+ * default), if the method layer has fast random read, only the FIDs of
+ * its features are kept, the features are fetched by FID when they
+ * are selected, and the features of this layer are processed by a
+ * single thread.
+ *
+ * \note The features of this layer are processed in parallel, as
+ * described in Intersection().
  *
  * \note This method relies on GEOS support. Do not use unless the
  * GEOS support is compiled in.
@@ -3529,6 +3744,8 @@ OGRErr OGRLayer::Update( OGRLayer *pLayerMethod,
     OGRGeometry *pGeometryMethodFilter = nullptr;
     int *mapInput = nullptr;
     int *mapMethod = nullptr;
+    OGROverlayIndex oIndexMethod;
+    OGROverlayContext sContext;
     double progress_max = (double) GetFeatureCount(0) + (double) pLayerMethod->GetFeatureCount(0);
     double progress_counter = 0;
     double progress_ticker = 0;
@@ -3552,82 +3769,18 @@ OGRErr OGRLayer::Update( OGRLayer *pLayerMethod,
     poDefnResult = pLayerResult->GetLayerDefn();
 
     // add clipped features from the input layer
-    for( auto&& x: this ) {
-
-        if (pfnProgress) {
-            double p = progress_counter/progress_max;
-            if (p > progress_ticker) {
-                if (!pfnProgress(p, "", pProgressArg)) {
-                    CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
-                    ret = OGRERR_FAILURE;
-                    goto done;
-                }
-            }
-            progress_counter += 1.0;
-        }
-
-        // set up the filter on method layer
-        CPLErrorReset();
-        OGRGeometry *x_geom = set_filter_from(pLayerMethod, pGeometryMethodFilter, x.get());
-        if (CPLGetLastErrorType() != CE_None) {
-            if (!bSkipFailures) {
-                ret = OGRERR_FAILURE;
-                goto done;
-            } else {
-                CPLErrorReset();
-                ret = OGRERR_NONE;
-            }
-        }
-        if (!x_geom) {
-            continue;
-        }
-
-        OGRGeometryUniquePtr x_geom_diff(x_geom->clone()); //this will be the geometry of a result feature
-        for( auto&& y: pLayerMethod ) {
-            OGRGeometry *y_geom = y->GetGeometryRef();
-            if (!y_geom) continue;
-            if (x_geom_diff) {
-                CPLErrorReset();
-                OGRGeometryUniquePtr x_geom_diff_new(x_geom_diff->Difference(y_geom));
-                if (CPLGetLastErrorType() != CE_None || x_geom_diff_new == nullptr) {
-                    if (!bSkipFailures) {
-                        ret = OGRERR_FAILURE;
-                        goto done;
-                    } else {
-                        CPLErrorReset();
-                        ret = OGRERR_NONE;
-                    }
-                } else {
-                    x_geom_diff.swap(x_geom_diff_new);
-                }
-            }
-        }
-
-        if( x_geom_diff == nullptr || x_geom_diff->IsEmpty() )
-        {
-            /* ok */
-        }
-        else
-        {
-            OGRFeatureUniquePtr z(new OGRFeature(poDefnResult));
-            z->SetFieldsFrom(x.get(), mapInput);
-            if( bPromoteToMulti )
-                x_geom_diff.reset(promote_to_multi(x_geom_diff.release()));
-            z->SetGeometryDirectly(x_geom_diff.release());
-            ret = pLayerResult->CreateFeature(z.get());
-            if (ret != OGRERR_NONE) {
-                if (!bSkipFailures) {
-                    goto done;
-                } else {
-                    CPLErrorReset();
-                    ret = OGRERR_NONE;
-                }
-            }
-        }
-    }
+    oIndexMethod.Build(pLayerMethod);
+    sContext.poIndex = &oIndexMethod;
+    sContext.pGeometryFilter = pGeometryMethodFilter;
+    sContext.bSkipFailures = CPL_TO_BOOL(bSkipFailures);
+    sContext.bPromoteToMulti = CPL_TO_BOOL(bPromoteToMulti);
+    sContext.bUsePreparedGeometries = CPL_TO_BOOL(OGRHasPreparedGeometrySupport());
+    ret = run_overlay(this, pLayerResult, &sContext, erase_feature,
+                      mapInput, nullptr, progress_counter, progress_max,
+                      progress_ticker, pfnProgress, pProgressArg);
+    if (ret != OGRERR_NONE) goto done;
 
-    // restore the original filter and add features from the update layer
-    pLayerMethod->SetSpatialFilter(pGeometryMethodFilter);
+    // add features from the update layer
     for( auto&& y: pLayerMethod ) {
 
         if (pfnProgress) {
@@ -3664,7 +3817,6 @@ OGRErr OGRLayer::Update( OGRLayer *pLayerMethod,
     }
 done:
     // release resources
-    pLayerMethod->SetSpatialFilter(pGeometryMethodFilter);
     if (pGeometryMethodFilter) delete pGeometryMethodFilter;
     if (mapInput) VSIFree(mapInput);
     if (mapMethod) VSIFree(mapMethod);
@@ -3693,7 +3845,16 @@ done:
  * layer will get the value from the feature of the method layer.
  *
  * \note For best performance use the minimum amount of features in
- * the method layer and copy it into a memory layer.
+ * the method layer. Its features are read once and kept in memory,
+ * with a spatial index of their extents. Beyond the size set by the
+ * OGR_LAYER_ALGEBRA_MAX_MEMORY configuration option (in MB, 100 by
+ * default), if the method layer has fast random read, only the FIDs of
+ * its features are kept, the features are fetched by FID when they
+ * are selected, and the features of this layer are processed by a
+ * single thread.
+ *
+ * \note The features of the input layer are processed in parallel, as
+ * described in OGRLayer::Intersection().
  *
  * \note This method relies on GEOS support. Do not use unless the
  * GEOS support is compiled in.
@@ -3768,7 +3929,16 @@ OGRErr OGR_L_Update( OGRLayerH pLayerInput,
  * empty, is initialized to contain all fields in the input layer.
  *
  * \note For best performance use the minimum amount of features in
- * the method layer and copy it into a memory layer.
+ * the method layer. Its features are read once and kept in memory,
+ * with a spatial index of their extents. Beyond the size set by the
+ * OGR_LAYER_ALGEBRA_MAX_MEMORY configuration option (in MB, 100 by
+ * default), if the method layer has fast random read, only the FIDs of
+ * its features are kept, the features are fetched by FID when they
+ * are selected, and the features of this layer are processed by a
+ * single thread.
+ *
+ * \note The features of this layer are processed in parallel, as
+ * described in Intersection().
  *
  * \note This method relies on GEOS support. Do not use unless the
  * GEOS support is compiled in.
@@ -3816,9 +3986,10 @@ OGRErr OGRLayer::Clip( OGRLayer *pLayerMethod,
 {
     OGRErr ret = OGRERR_NONE;
     OGRFeatureDefn *poDefnInput = GetLayerDefn();
-    OGRFeatureDefn *poDefnResult = nullptr;
     OGRGeometry *pGeometryMethodFilter = nullptr;
     int *mapInput = nullptr;
+    OGROverlayIndex oIndexMethod;
+    OGROverlayContext sContext;
     double progress_max = (double) GetFeatureCount(0);
     double progress_counter = 0;
     double progress_ticker = 0;
@@ -3830,6 +4001,7 @@ OGRErr OGRLayer::Clip( OGRLayer *pLayerMethod,
         return OGRERR_UNSUPPORTED_OPERATION;
     }
 
+    // get resources
     ret = clone_spatial_filter(pLayerMethod, &pGeometryMethodFilter);
     if (ret != OGRERR_NONE) goto done;
     ret = create_field_map(poDefnInput, &mapInput);
@@ -3837,93 +4009,17 @@ OGRErr OGRLayer::Clip( OGRLayer *pLayerMethod,
     ret = set_result_schema(pLayerResult, poDefnInput, nullptr, mapInput, nullptr, 0, papszOptions);
     if (ret != OGRERR_NONE) goto done;
 
-    poDefnResult = pLayerResult->GetLayerDefn();
-    for( auto&& x: this ) {
-
-        if (pfnProgress) {
-            double p = progress_counter/progress_max;
-            if (p > progress_ticker) {
-                if (!pfnProgress(p, "", pProgressArg)) {
-                    CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
-                    ret = OGRERR_FAILURE;
-                    goto done;
-                }
-            }
-            progress_counter += 1.0;
-        }
-
-        // set up the filter on method layer
-        CPLErrorReset();
-        OGRGeometry *x_geom = set_filter_from(pLayerMethod, pGeometryMethodFilter, x.get());
-        if (CPLGetLastErrorType() != CE_None) {
-            if (!bSkipFailures) {
-                ret = OGRERR_FAILURE;
-                goto done;
-            } else {
-                CPLErrorReset();
-                ret = OGRERR_NONE;
-            }
-        }
-        if (!x_geom) {
-            continue;
-        }
-
-        OGRGeometryUniquePtr geom; // this will be the geometry of the result feature
-        // incrementally add area from y to geom
-        for( auto&& y: pLayerMethod ) {
-            OGRGeometry *y_geom = y->GetGeometryRef();
-            if (!y_geom) continue;
-            if (!geom) {
-                geom.reset(y_geom->clone());
-            } else {
-                CPLErrorReset();
-                OGRGeometryUniquePtr geom_new(geom->Union(y_geom));
-                if (CPLGetLastErrorType() != CE_None || geom_new == nullptr) {
-                    if (!bSkipFailures) {
-                        ret = OGRERR_FAILURE;
-                        goto done;
-                    } else {
-                        CPLErrorReset();
-                        ret = OGRERR_NONE;
-                    }
-                } else {
-                    geom.swap(geom_new);
-                }
-            }
-        }
+    oIndexMethod.Build(pLayerMethod);
+    sContext.poIndex = &oIndexMethod;
+    sContext.pGeometryFilter = pGeometryMethodFilter;
+    sContext.bSkipFailures = CPL_TO_BOOL(bSkipFailures);
+    sContext.bPromoteToMulti = CPL_TO_BOOL(bPromoteToMulti);
+    sContext.bUsePreparedGeometries = CPL_TO_BOOL(OGRHasPreparedGeometrySupport());
+    ret = run_overlay(this, pLayerResult, &sContext, clip_feature,
+                      mapInput, nullptr, progress_counter, progress_max,
+                      progress_ticker, pfnProgress, pProgressArg);
+    if (ret != OGRERR_NONE) goto done;
 
-        // possibly add a new feature with area x intersection sum of y
-        if (geom) {
-            CPLErrorReset();
-            OGRGeometryUniquePtr poIntersection(x_geom->Intersection(geom.get()));
-            if (CPLGetLastErrorType() != CE_None || poIntersection == nullptr) {
-                if (!bSkipFailures) {
-                    ret = OGRERR_FAILURE;
-                    goto done;
-                } else {
-                    CPLErrorReset();
-                    ret = OGRERR_NONE;
-                }
-            }
-            else if( !poIntersection->IsEmpty() )
-            {
-                OGRFeatureUniquePtr z(new OGRFeature(poDefnResult));
-                z->SetFieldsFrom(x.get(), mapInput);
-                if( bPromoteToMulti )
-                    poIntersection.reset(promote_to_multi(poIntersection.release()));
-                z->SetGeometryDirectly(poIntersection.release());
-                ret = pLayerResult->CreateFeature(z.get());
-                if (ret != OGRERR_NONE) {
-                    if (!bSkipFailures) {
-                        goto done;
-                    } else {
-                        CPLErrorReset();
-                        ret = OGRERR_NONE;
-                    }
-                }
-            }
-        }
-    }
     if (pfnProgress && !pfnProgress(1.0, "", pProgressArg)) {
       CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
       ret = OGRERR_FAILURE;
@@ -3931,7 +4027,6 @@ OGRErr OGRLayer::Clip( OGRLayer *pLayerMethod,
     }
 done:
     // release resources
-    pLayerMethod->SetSpatialFilter(pGeometryMethodFilter);
     if (pGeometryMethodFilter) delete pGeometryMethodFilter;
     if (mapInput) VSIFree(mapInput);
     return ret;
@@ -3952,7 +4047,16 @@ done:
  * empty, is initialized to contain all fields in the input layer.
  *
  * \note For best performance use the minimum amount of features in
- * the method layer and copy it into a memory layer.
+ * the method layer. Its features are read once and kept in memory,
+ * with a spatial index of their extents. Beyond the size set by the
+ * OGR_LAYER_ALGEBRA_MAX_MEMORY configuration option (in MB, 100 by
+ * default), if the method layer has fast random read, only the FIDs of
+ * its features are kept, the features are fetched by FID when they
+ * are selected, and the features of this layer are processed by a
+ * single thread.
+ *
+ * \note The features of the input layer are processed in parallel, as
+ * described in OGRLayer::Intersection().
  *
  * \note This method relies on GEOS support. Do not use unless the
  * GEOS support is compiled in.
@@ -4027,7 +4131,16 @@ OGRErr OGR_L_Clip( OGRLayerH pLayerInput,
  * layer.
  *
  * \note For best performance use the minimum amount of features in
- * the method layer and copy it into a memory layer.
+ * the method layer. Its features are read once and kept in memory,
+ * with a spatial index of their extents. Beyond the size set by the
+ * OGR_LAYER_ALGEBRA_MAX_MEMORY configuration option (in MB, 100 by
+ * default), if the method layer has fast random read, only the FIDs of
+ * its features are kept, the features are fetched by FID when they
+ * are selected, and the features of this layer are processed by a
+ * single thread.
+ *
+ * \note The features of this layer are processed in parallel, as
+ * described in Intersection().
  *
  * \note This method relies on GEOS support. Do not use unless the
  * GEOS support is compiled in.
@@ -4075,9 +4188,10 @@ OGRErr OGRLayer::Erase( OGRLayer *pLayerMethod,
 {
     OGRErr ret = OGRERR_NONE;
     OGRFeatureDefn *poDefnInput = GetLayerDefn();
-    OGRFeatureDefn *poDefnResult = nullptr;
     OGRGeometry *pGeometryMethodFilter = nullptr;
     int *mapInput = nullptr;
+    OGROverlayIndex oIndexMethod;
+    OGROverlayContext sContext;
     double progress_max = (double) GetFeatureCount(0);
     double progress_counter = 0;
     double progress_ticker = 0;
@@ -4096,80 +4210,18 @@ OGRErr OGRLayer::Erase( OGRLayer *pLayerMethod,
     if (ret != OGRERR_NONE) goto done;
     ret = set_result_schema(pLayerResult, poDefnInput, nullptr, mapInput, nullptr, 0, papszOptions);
     if (ret != OGRERR_NONE) goto done;
-    poDefnResult = pLayerResult->GetLayerDefn();
-
-    for( auto&& x: this ) {
-
-        if (pfnProgress) {
-            double p = progress_counter/progress_max;
-            if (p > progress_ticker) {
-                if (!pfnProgress(p, "", pProgressArg)) {
-                    CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
-                    ret = OGRERR_FAILURE;
-                    goto done;
-                }
-            }
-            progress_counter += 1.0;
-        }
-
-        // set up the filter on the method layer
-        CPLErrorReset();
-        OGRGeometry *x_geom = set_filter_from(pLayerMethod, pGeometryMethodFilter, x.get());
-        if (CPLGetLastErrorType() != CE_None) {
-            if (!bSkipFailures) {
-                ret = OGRERR_FAILURE;
-                goto done;
-            } else {
-                CPLErrorReset();
-                ret = OGRERR_NONE;
-            }
-        }
-        if (!x_geom) {
-            continue;
-        }
 
-        OGRGeometryUniquePtr geom(x_geom->clone()); // this will be the geometry of the result feature
-        // incrementally erase y from geom
-        for( auto&& y: pLayerMethod ) {
-            OGRGeometry *y_geom = y->GetGeometryRef();
-            if (!y_geom) continue;
-            CPLErrorReset();
-            OGRGeometryUniquePtr geom_new(geom->Difference(y_geom));
-            if (CPLGetLastErrorType() != CE_None || geom_new == nullptr) {
-                if (!bSkipFailures) {
-                    ret = OGRERR_FAILURE;
-                    goto done;
-                } else {
-                    CPLErrorReset();
-                    ret = OGRERR_NONE;
-                }
-            } else {
-                geom.swap(geom_new);
-                if (geom->IsEmpty())
-                {
-                    break;
-                }
-            }
-        }
+    oIndexMethod.Build(pLayerMethod);
+    sContext.poIndex = &oIndexMethod;
+    sContext.pGeometryFilter = pGeometryMethodFilter;
+    sContext.bSkipFailures = CPL_TO_BOOL(bSkipFailures);
+    sContext.bPromoteToMulti = CPL_TO_BOOL(bPromoteToMulti);
+    sContext.bUsePreparedGeometries = CPL_TO_BOOL(OGRHasPreparedGeometrySupport());
+    ret = run_overlay(this, pLayerResult, &sContext, erase_feature,
+                      mapInput, nullptr, progress_counter, progress_max,
+                      progress_ticker, pfnProgress, pProgressArg);
+    if (ret != OGRERR_NONE) goto done;
 
-        // add a new feature if there is remaining area
-        if (!geom->IsEmpty()) {
-            OGRFeatureUniquePtr z(new OGRFeature(poDefnResult));
-            z->SetFieldsFrom(x.get(), mapInput);
-            if( bPromoteToMulti )
-                geom.reset(promote_to_multi(geom.release()));
-            z->SetGeometryDirectly(geom.release());
-            ret = pLayerResult->CreateFeature(z.get());
-            if (ret != OGRERR_NONE) {
-                if (!bSkipFailures) {
-                    goto done;
-                } else {
-                    CPLErrorReset();
-                    ret = OGRERR_NONE;
-                }
-            }
-        }
-    }
     if (pfnProgress && !pfnProgress(1.0, "", pProgressArg)) {
       CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
       ret = OGRERR_FAILURE;
@@ -4177,7 +4229,6 @@ OGRErr OGRLayer::Erase( OGRLayer *pLayerMethod,
     }
 done:
     // release resources
-    pLayerMethod->SetSpatialFilter(pGeometryMethodFilter);
     if (pGeometryMethodFilter) delete pGeometryMethodFilter;
     if (mapInput) VSIFree(mapInput);
     return ret;
@@ -4198,7 +4249,16 @@ done:
  * layer.
  *
  * \note For best performance use the minimum amount of features in
- * the method layer and copy it into a memory layer.
+ * the method layer. Its features are read once and kept in memory,
+ * with a spatial index of their extents. Beyond the size set by the
+ * OGR_LAYER_ALGEBRA_MAX_MEMORY configuration option (in MB, 100 by
+ * default), if the method layer has fast random read, only the FIDs of
+ * its features are kept, the features are fetched by FID when they
+ * are selected, and the features of this layer are processed by a
+ * single thread.
+ *
+ * \note The features of the input layer are processed in parallel, as
+ * described in OGRLayer::Intersection().
  *
  * \note This method relies on GEOS support. Do not use unless the
  * GEOS support is compiled in.
@@ -97,6 +97,17 @@ OGRFeature *OGRLayerDecorator::GetNextFeature()
     return m_poDecoratedLayer->GetNextFeature();
 }
 
+int OGRLayerDecorator::GetNextFeatureBatch( OGRFeatureBatch *poBatch,
+                                            int nMaxFeatures )
+{
+    if( !m_poDecoratedLayer )
+    {
+        poBatch->Reset(nullptr);
+        return 0;
+    }
+    return m_poDecoratedLayer->GetNextFeatureBatch(poBatch, nMaxFeatures);
+}
+
 OGRErr      OGRLayerDecorator::SetNextByIndex( GIntBig nIndex )
 {
     if( !m_poDecoratedLayer ) return OGRERR_FAILURE;
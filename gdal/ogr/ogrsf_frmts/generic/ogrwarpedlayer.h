@@ -75,6 +75,10 @@ class OGRWarpedLayer : public OGRLayerDecorator
                                               double dfMaxX, double dfMaxY ) override;
 
     virtual OGRFeature *GetNextFeature() override;
+    // Features must go through GetNextFeature() to be translated.
+    virtual int         GetNextFeatureBatch( OGRFeatureBatch *poBatch,
+                                             int nMaxFeatures ) override
+        { return OGRLayer::GetNextFeatureBatch(poBatch, nMaxFeatures); }
     virtual OGRFeature *GetFeature( GIntBig nFID ) override;
     virtual OGRErr      ISetFeature( OGRFeature *poFeature ) override;
     virtual OGRErr      ICreateFeature( OGRFeature *poFeature ) override;
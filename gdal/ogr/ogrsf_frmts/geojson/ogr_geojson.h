@@ -79,6 +79,9 @@ class OGRGeoJSONLayer : public OGRMemLayer
 
     virtual void        ResetReading() override;
     virtual OGRFeature* GetNextFeature() override;
+    virtual int         GetNextFeatureBatch( OGRFeatureBatch *poBatch,
+                                             int nMaxFeatures ) override
+        { return OGRLayer::GetNextFeatureBatch(poBatch, nMaxFeatures); }
     virtual OGRFeature* GetFeature(GIntBig nFID) override;
     virtual GIntBig     GetFeatureCount(int bForce) override;
 
@@ -148,6 +148,90 @@ OGRFeature *OGRGeoPackageLayer::GetNextFeature()
     }
 }
 
+/************************************************************************/
+/*                        GPKGTranslateFields()                         */
+/*                                                                      */
+/*      Set the attribute fields of an OGRFeature or an OGRFeatureBatch */
+/*      from the current row of a statement.                            */
+/************************************************************************/
+
+template<class T>
+static void GPKGTranslateFields( OGRFeatureDefn *poFeatureDefn,
+                                 const int *panFieldOrdinals,
+                                 sqlite3_stmt* hStmt, T *poTarget )
+
+{
+    for( int iField = 0; iField < poFeatureDefn->GetFieldCount(); iField++ )
+    {
+        OGRFieldDefn *poFieldDefn = poFeatureDefn->GetFieldDefn( iField );
+        if ( poFieldDefn->IsIgnored() )
+            continue;
+
+        const int iRawField = panFieldOrdinals[iField];
+
+        if( sqlite3_column_type( hStmt, iRawField ) == SQLITE_NULL )
+        {
+            poTarget->SetFieldNull( iField );
+            continue;
+        }
+
+        switch( poFieldDefn->GetType() )
+        {
+            case OFTInteger:
+                poTarget->SetField( iField,
+                    sqlite3_column_int( hStmt, iRawField ) );
+                break;
+
+            case OFTInteger64:
+                poTarget->SetField( iField,
+                    sqlite3_column_int64( hStmt, iRawField ) );
+                break;
+
+            case OFTReal:
+                poTarget->SetField( iField,
+                    sqlite3_column_double( hStmt, iRawField ) );
+                break;
+
+            case OFTBinary:
+            {
+                const int nBytes = sqlite3_column_bytes( hStmt, iRawField );
+                // coverity[tainted_data_return]
+                const GByte* pabyData = reinterpret_cast<const GByte*>(
+                    sqlite3_column_blob( hStmt, iRawField ) );
+                poTarget->SetField( iField, nBytes,
+                                     const_cast<GByte*>(pabyData) );
+                break;
+            }
+
+            case OFTDate:
+            {
+                const char* pszTxt = (const char*)sqlite3_column_text( hStmt, iRawField );
+                int nYear, nMonth, nDay;
+                if( sscanf(pszTxt, "%d-%d-%d", &nYear, &nMonth, &nDay) == 3 )
+                    poTarget->SetField(iField, nYear, nMonth, nDay, 0, 0, 0, 0);
+                break;
+            }
+
+            case OFTDateTime:
+            {
+                const char* pszTxt = (const char*)sqlite3_column_text( hStmt, iRawField );
+                OGRField sField;
+                if( OGRParseXMLDateTime(pszTxt, &sField) )
+                    poTarget->SetField(iField, &sField);
+                break;
+            }
+
+            case OFTString:
+                poTarget->SetField( iField,
+                        (const char *) sqlite3_column_text( hStmt, iRawField ) );
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
 /************************************************************************/
 /*                         TranslateFeature()                           */
 /************************************************************************/
@@ -211,77 +295,76 @@ OGRFeature *OGRGeoPackageLayer::TranslateFeature( sqlite3_stmt* hStmt )
 /* -------------------------------------------------------------------- */
 /*      set the fields.                                                 */
 /* -------------------------------------------------------------------- */
-    for( int iField = 0; iField < m_poFeatureDefn->GetFieldCount(); iField++ )
-    {
-        OGRFieldDefn *poFieldDefn = m_poFeatureDefn->GetFieldDefn( iField );
-        if ( poFieldDefn->IsIgnored() )
-            continue;
+    GPKGTranslateFields( m_poFeatureDefn, panFieldOrdinals, hStmt, poFeature );
 
-        const int iRawField = panFieldOrdinals[iField];
+    return poFeature;
+}
 
-        if( sqlite3_column_type( hStmt, iRawField ) == SQLITE_NULL )
-        {
-            poFeature->SetFieldNull( iField );
-            continue;
-        }
+/************************************************************************/
+/*                      TranslateFeatureToBatch()                       */
+/************************************************************************/
 
-        switch( poFieldDefn->GetType() )
-        {
-            case OFTInteger:
-                poFeature->SetField( iField,
-                    sqlite3_column_int( hStmt, iRawField ) );
-                break;
+void OGRGeoPackageLayer::TranslateFeatureToBatch( sqlite3_stmt* hStmt,
+                                                  OGRFeatureBatch *poBatch )
 
-            case OFTInteger64:
-                poFeature->SetField( iField,
-                    sqlite3_column_int64( hStmt, iRawField ) );
-                break;
-
-            case OFTReal:
-                poFeature->SetField( iField,
-                    sqlite3_column_double( hStmt, iRawField ) );
-                break;
+{
+    GIntBig nFID = iNextShapeId;
+    if( iFIDCol >= 0 )
+    {
+        nFID = sqlite3_column_int64( hStmt, iFIDCol );
+        if( m_pszFidColumn == nullptr && nFID == 0 )
+        {
+            // Might be the case for views with joins.
+            nFID = iNextShapeId;
+        }
+    }
+    poBatch->AddFeature( nFID );
 
-            case OFTBinary:
-            {
-                const int nBytes = sqlite3_column_bytes( hStmt, iRawField );
-                // coverity[tainted_data_return]
-                const GByte* pabyData = reinterpret_cast<const GByte*>(
-                    sqlite3_column_blob( hStmt, iRawField ) );
-                poFeature->SetField( iField, nBytes,
-                                     const_cast<GByte*>(pabyData) );
-                break;
-            }
+    iNextShapeId++;
 
-            case OFTDate:
-            {
-                const char* pszTxt = (const char*)sqlite3_column_text( hStmt, iRawField );
-                int nYear, nMonth, nDay;
-                if( sscanf(pszTxt, "%d-%d-%d", &nYear, &nMonth, &nDay) == 3 )
-                    poFeature->SetField(iField, nYear, nMonth, nDay, 0, 0, 0, 0);
-                break;
-            }
+    m_nFeaturesRead++;
 
-            case OFTDateTime:
+    if( iGeomCol >= 0 &&
+        sqlite3_column_type(hStmt, iGeomCol) != SQLITE_NULL &&
+        !m_poFeatureDefn->GetGeomFieldDefn(0)->IsIgnored() )
+    {
+        const int iGpkgSize = sqlite3_column_bytes(hStmt, iGeomCol);
+        // coverity[tainted_data_return]
+        const GByte *pabyGpkg = static_cast<const GByte*>(
+            sqlite3_column_blob(hStmt, iGeomCol));
+
+        // The WKB of standard GeoPackage geometry blobs is ISO WKB, which
+        // can be copied as it is when it is little endian.
+        GPkgHeader oHeader;
+        if( GPkgHeaderFromWKB(pabyGpkg, iGpkgSize, &oHeader) == OGRERR_NONE &&
+            !oHeader.bExtended &&
+            static_cast<size_t>(iGpkgSize) >= oHeader.nHeaderLen + 5 &&
+            pabyGpkg[oHeader.nHeaderLen] == wkbNDR &&
+            CPL_LSBUINT32PTR(pabyGpkg + oHeader.nHeaderLen + 1) < 4000 )
+        {
+            poBatch->SetGeomFieldWkb( 0, pabyGpkg + oHeader.nHeaderLen,
+                                      iGpkgSize - oHeader.nHeaderLen );
+        }
+        else
+        {
+            OGRGeometry *poGeom =
+                GPkgGeometryToOGR(pabyGpkg, iGpkgSize, nullptr);
+            if ( poGeom == nullptr )
             {
-                const char* pszTxt = (const char*)sqlite3_column_text( hStmt, iRawField );
-                OGRField sField;
-                if( OGRParseXMLDateTime(pszTxt, &sField) )
-                    poFeature->SetField(iField, &sField);
-                break;
+                // Try also spatialite geometry blobs
+                if( OGRSQLiteLayer::ImportSpatiaLiteGeometry(
+                        pabyGpkg, iGpkgSize, &poGeom ) != OGRERR_NONE )
+                {
+                    CPLError( CE_Failure, CPLE_AppDefined,
+                              "Unable to read geometry");
+                }
             }
-
-            case OFTString:
-                poFeature->SetField( iField,
-                        (const char *) sqlite3_column_text( hStmt, iRawField ) );
-                break;
-
-            default:
-                break;
+            poBatch->SetGeomField( 0, poGeom );
+            delete poGeom;
         }
     }
 
-    return poFeature;
+    GPKGTranslateFields( m_poFeatureDefn, panFieldOrdinals, hStmt, poBatch );
 }
 
 /************************************************************************/
@@ -2112,6 +2112,66 @@ OGRFeature* OGRGeoPackageTableLayer::GetNextFeature()
     return poFeature;
 }
 
+/************************************************************************/
+/*                        GetNextFeatureBatch()                         */
+/************************************************************************/
+
+int OGRGeoPackageTableLayer::GetNextFeatureBatch( OGRFeatureBatch *poBatch,
+                                                  int nMaxFeatures )
+{
+    // Attribute filters are normally translated to SQL, but the spatial
+    // filter needs the geometries to be built to be refined.
+    if( m_poFilterGeom != nullptr || m_poAttrQuery != nullptr ||
+        m_iFIDAsRegularColumnIndex >= 0 )
+    {
+        return OGRLayer::GetNextFeatureBatch(poBatch, nMaxFeatures);
+    }
+
+    if( !m_bFeatureDefnCompleted )
+        GetLayerDefn();
+    poBatch->Reset(m_poFeatureDefn);
+    if( m_bDeferredCreation && RunDeferredCreationIfNecessary() != OGRERR_NONE )
+        return 0;
+
+    CreateSpatialIndexIfNecessary();
+
+    while( poBatch->GetFeatureCount() < nMaxFeatures )
+    {
+        if( m_poQueryStatement == nullptr )
+        {
+            ResetStatement();
+            if (m_poQueryStatement == nullptr)
+                break;
+        }
+
+        if( bDoStep )
+        {
+            int rc = sqlite3_step( m_poQueryStatement );
+            if( rc != SQLITE_ROW )
+            {
+                if ( rc != SQLITE_DONE )
+                {
+                    sqlite3_reset(m_poQueryStatement);
+                    CPLError( CE_Failure, CPLE_AppDefined,
+                            "In GetNextFeatureBatch(): sqlite3_step() : %s",
+                            sqlite3_errmsg(m_poDS->GetDB()) );
+                }
+
+                ClearStatement();
+                break;
+            }
+        }
+        else
+        {
+            bDoStep = true;
+        }
+
+        TranslateFeatureToBatch(m_poQueryStatement, poBatch);
+    }
+
+    return poBatch->GetFeatureCount();
+}
+
 /************************************************************************/
 /*                        GetFeature()                                  */
 /************************************************************************/
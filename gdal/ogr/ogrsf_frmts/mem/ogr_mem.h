@@ -70,6 +70,8 @@ class OGRMemLayer : public OGRLayer
     // doesn't change.
     IOGRMemLayerFeatureIterator* GetIterator();
 
+    OGRFeature         *GetNextMatchingFeature();
+
   public:
                         OGRMemLayer( const char * pszName,
                                      OGRSpatialReference *poSRS,
@@ -78,6 +80,8 @@ class OGRMemLayer : public OGRLayer
 
     void                ResetReading() override;
     OGRFeature *        GetNextFeature() override;
+    virtual int         GetNextFeatureBatch( OGRFeatureBatch *poBatch,
+                                             int nMaxFeatures ) override;
     virtual OGRErr      SetNextByIndex( GIntBig nIndex ) override;
 
     OGRFeature         *GetFeature( GIntBig nFeatureId ) override;
@@ -142,10 +142,13 @@ void OGRMemLayer::ResetReading()
 }
 
 /************************************************************************/
-/*                           GetNextFeature()                           */
+/*                        GetNextMatchingFeature()                      */
+/*                                                                      */
+/*      Return the next feature passing the filters, without cloning   */
+/*      it.                                                             */
 /************************************************************************/
 
-OGRFeature *OGRMemLayer::GetNextFeature()
+OGRFeature *OGRMemLayer::GetNextMatchingFeature()
 
 {
     while( true )
@@ -175,13 +178,45 @@ OGRFeature *OGRMemLayer::GetNextFeature()
                 m_poAttrQuery->Evaluate(poFeature)) )
         {
             m_nFeaturesRead++;
-            return poFeature->Clone();
+            return poFeature;
         }
     }
 
     return nullptr;
 }
 
+/************************************************************************/
+/*                           GetNextFeature()                           */
+/************************************************************************/
+
+OGRFeature *OGRMemLayer::GetNextFeature()
+
+{
+    OGRFeature *poFeature = GetNextMatchingFeature();
+    return poFeature ? poFeature->Clone() : nullptr;
+}
+
+/************************************************************************/
+/*                        GetNextFeatureBatch()                         */
+/************************************************************************/
+
+int OGRMemLayer::GetNextFeatureBatch( OGRFeatureBatch *poBatch,
+                                      int nMaxFeatures )
+
+{
+    // The features are copied directly into the batch, which saves the
+    // Clone() of GetNextFeature().
+    poBatch->Reset(m_poFeatureDefn);
+    while( poBatch->GetFeatureCount() < nMaxFeatures )
+    {
+        OGRFeature *poFeature = GetNextMatchingFeature();
+        if( poFeature == nullptr )
+            break;
+        poBatch->AddFeature(poFeature);
+    }
+    return poBatch->GetFeatureCount();
+}
+
 /************************************************************************/
 /*                           SetNextByIndex()                           */
 /************************************************************************/
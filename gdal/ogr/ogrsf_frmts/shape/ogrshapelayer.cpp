@@ -891,6 +891,58 @@ OGRFeature *OGRShapeLayer::GetNextFeature()
     }
 }
 
+/************************************************************************/
+/*                        GetNextFeatureBatch()                         */
+/************************************************************************/
+
+int OGRShapeLayer::GetNextFeatureBatch( OGRFeatureBatch *poBatch,
+                                        int nMaxFeatures )
+
+{
+    // Filtered reads go through the indices and need a full feature to
+    // evaluate the filters, so use the generic implementation.
+    if( m_poAttrQuery != nullptr || m_poFilterGeom != nullptr ||
+        panMatchingFIDs != nullptr )
+    {
+        return OGRLayer::GetNextFeatureBatch(poBatch, nMaxFeatures);
+    }
+
+    poBatch->Reset(poFeatureDefn);
+    if( !TouchLayer() )
+        return 0;
+
+    while( poBatch->GetFeatureCount() < nMaxFeatures &&
+           iNextShapeId < nTotalShapeCount )
+    {
+        if( (hSHP != nullptr && iNextShapeId >= hSHP->nRecords) ||
+            (hDBF != nullptr && iNextShapeId >= hDBF->nRecords) )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "Attempt to read shape with feature id (%d) out of "
+                      "available range.", iNextShapeId );
+            break;
+        }
+
+        if( hDBF )
+        {
+            if( DBFIsRecordDeleted( hDBF, iNextShapeId ) )
+            {
+                iNextShapeId++;
+                continue;
+            }
+            if( VSIFEofL(VSI_SHP_GetVSIL(hDBF->fp)) )
+                break;  // I/O error.
+        }
+
+        SHPReadOGRFeatureToBatch( hSHP, hDBF, poFeatureDefn, iNextShapeId,
+                                  osEncoding, poBatch );
+        iNextShapeId++;
+        m_nFeaturesRead++;
+    }
+
+    return poBatch->GetFeatureCount();
+}
+
 /************************************************************************/
 /*                             GetFeature()                             */
 /************************************************************************/
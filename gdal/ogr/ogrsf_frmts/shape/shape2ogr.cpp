@@ -38,6 +38,8 @@
 #include <algorithm>
 #include <limits>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
@@ -1137,96 +1139,73 @@ OGRFeatureDefn *SHPReadOGRFeatureDefn( const char * pszName,
 }
 
 /************************************************************************/
-/*                         SHPReadOGRFeature()                          */
+/*                         SHPReadOGRGeometry()                         */
+/*                                                                      */
+/*      Read the geometry of a shape, with its dimension adjusted to    */
+/*      the one of the layer.                                           */
 /************************************************************************/
 
-OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
-                               OGRFeatureDefn * poDefn, int iShape,
-                               SHPObject *psShape, const char *pszSHPEncoding )
+static OGRGeometry *SHPReadOGRGeometry( SHPHandle hSHP,
+                                        OGRFeatureDefn * poDefn, int iShape,
+                                        SHPObject *psShape )
 
 {
-    if( iShape < 0
-        || (hSHP != nullptr && iShape >= hSHP->nRecords)
-        || (hDBF != nullptr && iShape >= hDBF->nRecords) )
-    {
-        CPLError( CE_Failure, CPLE_AppDefined,
-                  "Attempt to read shape with feature id (%d) out of available"
-                  " range.", iShape );
-        return nullptr;
-    }
-
-    if( hDBF && DBFIsRecordDeleted( hDBF, iShape ) )
+    OGRGeometry* poGeometry =
+        SHPReadOGRObject( hSHP, iShape, psShape );
+
+    // Two possibilities are expected here (both are tested by
+    // GDAL Autotests):
+    //   1. Read valid geometry and assign it directly.
+    //   2. Read and assign null geometry if it can not be read
+    //      correctly from a shapefile.
+    //
+    // It is NOT required here to test poGeometry == NULL.
+
+    if( poGeometry )
     {
-        CPLError( CE_Failure, CPLE_AppDefined,
-                  "Attempt to read shape with feature id (%d), "
-                  "but it is marked deleted.",
-                  iShape );
-        if( psShape != nullptr )
-            SHPDestroyObject(psShape);
-        return nullptr;
-    }
-
-    OGRFeature  *poFeature = new OGRFeature( poDefn );
+        // Set/unset flags.
+        const OGRwkbGeometryType eMyGeomType =
+            poDefn->GetGeomFieldDefn(0)->GetType();
 
-/* -------------------------------------------------------------------- */
-/*      Fetch geometry from Shapefile to OGRFeature.                    */
-/* -------------------------------------------------------------------- */
-    if( hSHP != nullptr )
-    {
-        if( !poDefn->IsGeometryIgnored() )
+        if( eMyGeomType != wkbUnknown )
         {
-            OGRGeometry* poGeometry =
-                SHPReadOGRObject( hSHP, iShape, psShape );
-
-            // Two possibilities are expected here (both are tested by
-            // GDAL Autotests):
-            //   1. Read valid geometry and assign it directly.
-            //   2. Read and assign null geometry if it can not be read
-            //      correctly from a shapefile.
-            //
-            // It is NOT required here to test poGeometry == NULL.
-
-            if( poGeometry )
+            OGRwkbGeometryType eGeomInType =
+                poGeometry->getGeometryType();
+            if( wkbHasZ(eMyGeomType) && !wkbHasZ(eGeomInType) )
             {
-                // Set/unset flags.
-                const OGRwkbGeometryType eMyGeomType =
-                    poFeature->GetDefnRef()->GetGeomFieldDefn(0)->GetType();
-
-                if( eMyGeomType != wkbUnknown )
-                {
-                    OGRwkbGeometryType eGeomInType =
-                        poGeometry->getGeometryType();
-                    if( wkbHasZ(eMyGeomType) && !wkbHasZ(eGeomInType) )
-                    {
-                        poGeometry->set3D(TRUE);
-                    }
-                    else if( !wkbHasZ(eMyGeomType) && wkbHasZ(eGeomInType) )
-                    {
-                        poGeometry->set3D(FALSE);
-                    }
-                    if( wkbHasM(eMyGeomType) && !wkbHasM(eGeomInType) )
-                    {
-                        poGeometry->setMeasured(TRUE);
-                    }
-                    else if( !wkbHasM(eMyGeomType) && wkbHasM(eGeomInType) )
-                    {
-                        poGeometry->setMeasured(FALSE);
-                    }
-                }
+                poGeometry->set3D(TRUE);
+            }
+            else if( !wkbHasZ(eMyGeomType) && wkbHasZ(eGeomInType) )
+            {
+                poGeometry->set3D(FALSE);
+            }
+            if( wkbHasM(eMyGeomType) && !wkbHasM(eGeomInType) )
+            {
+                poGeometry->setMeasured(TRUE);
+            }
+            else if( !wkbHasM(eMyGeomType) && wkbHasM(eGeomInType) )
+            {
+                poGeometry->setMeasured(FALSE);
             }
-
-            poFeature->SetGeometryDirectly( poGeometry );
-        }
-        else if( psShape != nullptr )
-        {
-            SHPDestroyObject( psShape );
         }
     }
 
-/* -------------------------------------------------------------------- */
-/*      Fetch feature attributes to OGRFeature fields.                  */
-/* -------------------------------------------------------------------- */
+    return poGeometry;
+}
 
+/************************************************************************/
+/*                          SHPReadOGRFields()                          */
+/*                                                                      */
+/*      Read the attributes of a record into an OGRFeature or an        */
+/*      OGRFeatureBatch, which share the same setters.                  */
+/************************************************************************/
+
+template<class T>
+static void SHPReadOGRFields( DBFHandle hDBF, OGRFeatureDefn * poDefn,
+                              int iShape, const char *pszSHPEncoding,
+                              T *poTarget )
+
+{
     for( int iField = 0;
          hDBF != nullptr && iField < poDefn->GetFieldCount();
          iField++ )
@@ -1247,15 +1226,15 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
                 {
                     char * const pszUTF8Field =
                         CPLRecode( pszFieldVal, pszSHPEncoding, CPL_ENC_UTF8);
-                    poFeature->SetField( iField, pszUTF8Field );
+                    poTarget->SetField( iField, pszUTF8Field );
                     CPLFree( pszUTF8Field );
                 }
                 else
-                    poFeature->SetField( iField, pszFieldVal );
+                    poTarget->SetField( iField, pszFieldVal );
               }
               else
               {
-                  poFeature->SetFieldNull(iField);
+                  poTarget->SetFieldNull(iField);
               }
               break;
           }
@@ -1265,11 +1244,11 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
           {
               if( DBFIsAttributeNULL( hDBF, iShape, iField ) )
               {
-                  poFeature->SetFieldNull(iField);
+                  poTarget->SetFieldNull(iField);
               }
               else
               {
-                  poFeature->SetField(
+                  poTarget->SetField(
                       iField,
                       DBFReadStringAttribute( hDBF, iShape, iField ) );
               }
@@ -1279,7 +1258,7 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
           {
               if( DBFIsAttributeNULL( hDBF, iShape, iField ) )
               {
-                  poFeature->SetFieldNull(iField);
+                  poTarget->SetFieldNull(iField);
                   continue;
               }
 
@@ -1310,7 +1289,7 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
                   sFld.Date.Day = static_cast<GByte>(nFullDate % 100);
               }
 
-              poFeature->SetField( iField, &sFld );
+              poTarget->SetField( iField, &sFld );
           }
           break;
 
@@ -1318,6 +1297,64 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
             CPLAssert( false );
         }
     }
+}
+
+/************************************************************************/
+/*                         SHPReadOGRFeature()                          */
+/************************************************************************/
+
+OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
+                               OGRFeatureDefn * poDefn, int iShape,
+                               SHPObject *psShape, const char *pszSHPEncoding )
+
+{
+    if( iShape < 0
+        || (hSHP != nullptr && iShape >= hSHP->nRecords)
+        || (hDBF != nullptr && iShape >= hDBF->nRecords) )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Attempt to read shape with feature id (%d) out of available"
+                  " range.", iShape );
+        return nullptr;
+    }
+
+    if( hDBF && DBFIsRecordDeleted( hDBF, iShape ) )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Attempt to read shape with feature id (%d), "
+                  "but it is marked deleted.",
+                  iShape );
+        if( psShape != nullptr )
+            SHPDestroyObject(psShape);
+        return nullptr;
+    }
+
+    OGRFeature  *poFeature = new OGRFeature( poDefn );
+
+/* -------------------------------------------------------------------- */
+/*      Fetch geometry from Shapefile to OGRFeature.                    */
+/* -------------------------------------------------------------------- */
+    if( hSHP != nullptr )
+    {
+        if( !poDefn->IsGeometryIgnored() )
+        {
+            OGRGeometry* poGeometry =
+                SHPReadOGRGeometry( hSHP, poDefn, iShape, psShape );
+
+            poFeature->SetGeometryDirectly( poGeometry );
+        }
+        else if( psShape != nullptr )
+        {
+            SHPDestroyObject( psShape );
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Fetch feature attributes to OGRFeature fields.                  */
+/* -------------------------------------------------------------------- */
+
+    if( hDBF != nullptr )
+        SHPReadOGRFields( hDBF, poDefn, iShape, pszSHPEncoding, poFeature );
 
     if( poFeature != nullptr )
         poFeature->SetFID( iShape );
@@ -1325,6 +1362,240 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
     return poFeature;
 }
 
+/************************************************************************/
+/*                          SHPWkbAddUInt32()                           */
+/************************************************************************/
+
+static void SHPWkbAddUInt32( std::vector<GByte>& abyWkb, GUInt32 nValue )
+{
+    CPL_LSBPTR32(&nValue);
+    const GByte *pabyValue = reinterpret_cast<const GByte*>(&nValue);
+    abyWkb.insert(abyWkb.end(), pabyValue, pabyValue + sizeof(nValue));
+}
+
+/************************************************************************/
+/*                          SHPWkbAddDouble()                           */
+/************************************************************************/
+
+static void SHPWkbAddDouble( std::vector<GByte>& abyWkb, double dfValue )
+{
+    CPL_LSBPTR64(&dfValue);
+    const GByte *pabyValue = reinterpret_cast<const GByte*>(&dfValue);
+    abyWkb.insert(abyWkb.end(), pabyValue, pabyValue + sizeof(dfValue));
+}
+
+/************************************************************************/
+/*                          SHPWkbAddHeader()                           */
+/************************************************************************/
+
+static void SHPWkbAddHeader( std::vector<GByte>& abyWkb,
+                             OGRwkbGeometryType eFlatType,
+                             bool bHasZ, bool bHasM )
+{
+    abyWkb.push_back(static_cast<GByte>(wkbNDR));
+    SHPWkbAddUInt32(abyWkb, static_cast<GUInt32>(eFlatType) +
+                            (bHasZ ? 1000 : 0) + (bHasM ? 2000 : 0));
+}
+
+/************************************************************************/
+/*                             SHPWriteWkb()                            */
+/*                                                                      */
+/*      Write the geometry of a shape as ISO WKB, without building an   */
+/*      OGRGeometry, with the same result as SHPReadOGRGeometry().      */
+/*      abyWkb is left empty for a null geometry.  Return false for     */
+/*      the shapes that need the OGRGeometry path: multi-part           */
+/*      polygons, whose rings must be organized, and multipatches.      */
+/************************************************************************/
+
+static bool SHPWriteWkb( const SHPObject *psShape,
+                         OGRwkbGeometryType eLayerGeomType,
+                         std::vector<GByte>& abyWkb )
+
+{
+    const int nSHPType = psShape->nSHPType;
+    if( nSHPType == SHPT_NULL )
+        return true;
+
+    OGRwkbGeometryType eFlatType = wkbUnknown;
+    bool bShapeHasZ = false;
+    bool bShapeHasM = false;
+    switch( nSHPType )
+    {
+        case SHPT_POINT:
+        case SHPT_POINTZ:
+        case SHPT_POINTM:
+            if( psShape->nVertices < 1 )
+                return false;
+            eFlatType = wkbPoint;
+            bShapeHasZ = nSHPType == SHPT_POINTZ;
+            bShapeHasM = nSHPType == SHPT_POINTM ||
+                         (bShapeHasZ && psShape->bMeasureIsUsed);
+            break;
+        case SHPT_MULTIPOINT:
+        case SHPT_MULTIPOINTZ:
+        case SHPT_MULTIPOINTM:
+            if( psShape->nVertices == 0 )
+                return true;
+            eFlatType = wkbMultiPoint;
+            bShapeHasZ = nSHPType == SHPT_MULTIPOINTZ;
+            bShapeHasM = nSHPType != SHPT_MULTIPOINT &&
+                         psShape->padfM != nullptr;
+            break;
+        case SHPT_ARC:
+        case SHPT_ARCZ:
+        case SHPT_ARCM:
+            if( psShape->nParts == 0 )
+                return true;
+            eFlatType = psShape->nParts == 1 ? wkbLineString :
+                                               wkbMultiLineString;
+            bShapeHasZ = nSHPType == SHPT_ARCZ;
+            bShapeHasM = nSHPType != SHPT_ARC && psShape->padfM != nullptr;
+            break;
+        case SHPT_POLYGON:
+        case SHPT_POLYGONZ:
+        case SHPT_POLYGONM:
+            if( psShape->nParts == 0 )
+                return true;
+            if( psShape->nParts > 1 || psShape->nVertices == 0 )
+                return false;
+            eFlatType = wkbPolygon;
+            bShapeHasZ = nSHPType == SHPT_POLYGONZ;
+            bShapeHasM = nSHPType != SHPT_POLYGON &&
+                         psShape->padfM != nullptr;
+            break;
+        default:
+            return false;
+    }
+    if( bShapeHasZ && psShape->padfZ == nullptr )
+        return false;
+
+    // As SHPReadOGRGeometry(), use the dimension of the layer, if known.
+    const bool bHasZ = eLayerGeomType != wkbUnknown ?
+        CPL_TO_BOOL(wkbHasZ(eLayerGeomType)) : bShapeHasZ;
+    const bool bHasM = eLayerGeomType != wkbUnknown ?
+        CPL_TO_BOOL(wkbHasM(eLayerGeomType)) : bShapeHasM;
+
+    // Parts of lines and polygons, as (start, count).
+    std::vector<std::pair<int, int>> aoParts;
+    if( eFlatType != wkbPoint && eFlatType != wkbMultiPoint )
+    {
+        for( int iPart = 0; iPart < psShape->nParts; iPart++ )
+        {
+            int nStart = 0;
+            int nCount = psShape->nVertices;
+            if( psShape->panPartStart != nullptr )
+            {
+                nStart = psShape->panPartStart[iPart];
+                nCount = (iPart == psShape->nParts - 1 ?
+                          psShape->nVertices :
+                          psShape->panPartStart[iPart + 1]) - nStart;
+            }
+            if( nStart < 0 || nCount < 0 ||
+                nStart > psShape->nVertices - nCount )
+                return false;
+            aoParts.push_back(std::pair<int, int>(nStart, nCount));
+        }
+    }
+    else
+    {
+        aoParts.push_back(std::pair<int, int>(0, psShape->nVertices));
+    }
+
+    const size_t nPointSize = sizeof(double) * (2 + (bHasZ ? 1 : 0) +
+                                                (bHasM ? 1 : 0));
+    abyWkb.reserve(9 + 13 * aoParts.size() +
+                   (5 + nPointSize) * psShape->nVertices);
+
+    const auto AddPoint = [&](int i)
+    {
+        SHPWkbAddDouble(abyWkb, psShape->padfX[i]);
+        SHPWkbAddDouble(abyWkb, psShape->padfY[i]);
+        if( bHasZ )
+            SHPWkbAddDouble(abyWkb, bShapeHasZ ? psShape->padfZ[i] : 0.0);
+        if( bHasM )
+            SHPWkbAddDouble(abyWkb, bShapeHasM ? psShape->padfM[i] : 0.0);
+    };
+    const auto AddPoints = [&](const std::pair<int, int>& oPart)
+    {
+        SHPWkbAddUInt32(abyWkb, static_cast<GUInt32>(oPart.second));
+        for( int i = oPart.first; i < oPart.first + oPart.second; i++ )
+            AddPoint(i);
+    };
+
+    SHPWkbAddHeader(abyWkb, eFlatType, bHasZ, bHasM);
+    switch( eFlatType )
+    {
+        case wkbPoint:
+            AddPoint(0);
+            break;
+        case wkbMultiPoint:
+            SHPWkbAddUInt32(abyWkb, static_cast<GUInt32>(psShape->nVertices));
+            for( int i = 0; i < psShape->nVertices; i++ )
+            {
+                SHPWkbAddHeader(abyWkb, wkbPoint, bHasZ, bHasM);
+                AddPoint(i);
+            }
+            break;
+        case wkbLineString:
+            AddPoints(aoParts[0]);
+            break;
+        case wkbMultiLineString:
+            SHPWkbAddUInt32(abyWkb, static_cast<GUInt32>(aoParts.size()));
+            for( size_t i = 0; i < aoParts.size(); i++ )
+            {
+                SHPWkbAddHeader(abyWkb, wkbLineString, bHasZ, bHasM);
+                AddPoints(aoParts[i]);
+            }
+            break;
+        default:
+            SHPWkbAddUInt32(abyWkb, 1);
+            AddPoints(aoParts[0]);
+            break;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                      SHPReadOGRFeatureToBatch()                      */
+/*                                                                      */
+/*      Append a shape to a feature batch. The shape id is assumed to   */
+/*      be valid and not deleted.  The geometry is written as WKB from  */
+/*      the shape when possible.                                        */
+/************************************************************************/
+
+void SHPReadOGRFeatureToBatch( SHPHandle hSHP, DBFHandle hDBF,
+                               OGRFeatureDefn * poDefn, int iShape,
+                               const char *pszSHPEncoding,
+                               OGRFeatureBatch *poBatch )
+
+{
+    poBatch->AddFeature( iShape );
+
+    if( hSHP != nullptr && !poDefn->IsGeometryIgnored() )
+    {
+        SHPObject *psShape = SHPReadObject( hSHP, iShape );
+        std::vector<GByte> abyWkb;
+        if( psShape != nullptr &&
+            SHPWriteWkb( psShape, poDefn->GetGeomFieldDefn(0)->GetType(),
+                         abyWkb ) )
+        {
+            if( !abyWkb.empty() )
+                poBatch->SetGeomFieldWkb( 0, abyWkb.data(), abyWkb.size() );
+            SHPDestroyObject( psShape );
+        }
+        else if( psShape != nullptr )
+        {
+            OGRGeometry* poGeometry =
+                SHPReadOGRGeometry( hSHP, poDefn, iShape, psShape );
+            poBatch->SetGeomField( 0, poGeometry );
+            delete poGeometry;
+        }
+    }
+
+    if( hDBF != nullptr )
+        SHPReadOGRFields( hDBF, poDefn, iShape, pszSHPEncoding, poBatch );
+}
+
 /************************************************************************/
 /*                             GrowField()                              */
 /************************************************************************/
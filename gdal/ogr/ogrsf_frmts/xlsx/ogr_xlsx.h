@@ -79,6 +79,9 @@ class OGRXLSXLayer : public OGRMemLayer
 
     /* For external usage. Mess with FID */
     virtual OGRFeature *        GetNextFeature() override;
+    virtual int                 GetNextFeatureBatch( OGRFeatureBatch *poBatch,
+                                                     int nMaxFeatures ) override
+        { return OGRLayer::GetNextFeatureBatch(poBatch, nMaxFeatures); }
     virtual OGRFeature         *GetFeature( GIntBig nFeatureId ) override;
     virtual OGRErr              ISetFeature( OGRFeature *poFeature ) override;
     virtual OGRErr              DeleteFeature( GIntBig nFID ) override;
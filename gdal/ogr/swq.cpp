@@ -257,6 +257,8 @@ int swqlex( YYSTYPE *ppNode, swq_parse_context *context )
             nReturn = SWQT_ON;
         else if( EQUAL(osToken, "ORDER") )
             nReturn = SWQT_ORDER;
+        else if( EQUAL(osToken, "GROUP") )
+            nReturn = SWQT_GROUP;
         else if( EQUAL(osToken, "BY") )
             nReturn = SWQT_BY;
         else if( EQUAL(osToken, "FROM") )
@@ -800,6 +802,7 @@ static const char* const apszSQLReservedKeywords[] = {
     "WHERE",
     "ON",
     "ORDER",
+    "GROUP",
     "BY",
     "FROM",
     "AS",
@@ -261,6 +261,7 @@ const char*    SWQFieldTypeToString( swq_field_type field_type );
 #define SWQM_SUMMARY_RECORD  1
 #define SWQM_RECORDSET       2
 #define SWQM_DISTINCT_LIST   3
+#define SWQM_GROUP_BY        4
 
 typedef enum {
     SWQCF_NONE = 0,
@@ -323,6 +324,13 @@ typedef struct {
     int   ascending_flag;
 } swq_order_def;
 
+typedef struct {
+    char *table_name;
+    char *field_name;
+    int   table_index;
+    int   field_index;
+} swq_group_def;
+
 typedef struct {
     int        secondary_table;
     swq_expr_node  *poExpr;
@@ -349,6 +357,8 @@ public:
 class swq_select
 {
     void        postpreparse();
+    int         find_group_def( int table_index, int field_index ) const;
+    CPLErr      parse_group_by( swq_field_list *field_list );
 
 public:
     swq_select();
@@ -376,6 +386,10 @@ public:
 
     swq_expr_node *where_expr;
 
+    void        PushGroupBy( const char* pszTableName, const char *pszFieldName );
+    int         group_specs;
+    swq_group_def *group_defs;
+
     void        PushOrderBy( const char* pszTableName, const char *pszFieldName, int bAscending );
     int         order_specs;
     swq_order_def *order_defs;
@@ -174,24 +174,25 @@ extern int swqdebug;
     SWQT_WHERE = 271,
     SWQT_ON = 272,
     SWQT_ORDER = 273,
-    SWQT_BY = 274,
-    SWQT_FROM = 275,
-    SWQT_AS = 276,
-    SWQT_ASC = 277,
-    SWQT_DESC = 278,
-    SWQT_DISTINCT = 279,
-    SWQT_CAST = 280,
-    SWQT_UNION = 281,
-    SWQT_ALL = 282,
-    SWQT_LIMIT = 283,
-    SWQT_OFFSET = 284,
-    SWQT_VALUE_START = 285,
-    SWQT_SELECT_START = 286,
-    SWQT_NOT = 287,
-    SWQT_OR = 288,
-    SWQT_AND = 289,
-    SWQT_UMINUS = 290,
-    SWQT_RESERVED_KEYWORD = 291
+    SWQT_GROUP = 274,
+    SWQT_BY = 275,
+    SWQT_FROM = 276,
+    SWQT_AS = 277,
+    SWQT_ASC = 278,
+    SWQT_DESC = 279,
+    SWQT_DISTINCT = 280,
+    SWQT_CAST = 281,
+    SWQT_UNION = 282,
+    SWQT_ALL = 283,
+    SWQT_LIMIT = 284,
+    SWQT_OFFSET = 285,
+    SWQT_VALUE_START = 286,
+    SWQT_SELECT_START = 287,
+    SWQT_NOT = 288,
+    SWQT_OR = 289,
+    SWQT_AND = 290,
+    SWQT_UMINUS = 291,
+    SWQT_RESERVED_KEYWORD = 292
   };
 #endif
 
@@ -210,7 +211,7 @@ int swqparse (swq_parse_context *context);
 
 /* Copy the second part of user declarations.  */
 
-#line 214 "swq_parser.cpp" /* yacc.c:358  */
+#line 215 "swq_parser.cpp" /* yacc.c:358  */
 
 #ifdef short
 # undef short
@@ -452,21 +453,21 @@ union yyalloc
 /* YYFINAL -- State number of the termination state.  */
 #define YYFINAL  20
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   400
+#define YYLAST   399
 
 /* YYNTOKENS -- Number of terminals.  */
-#define YYNTOKENS  50
+#define YYNTOKENS  51
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  22
+#define YYNNTS  25
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  91
+#define YYNRULES  96
 /* YYNSTATES -- Number of states.  */
-#define YYNSTATES  193
+#define YYNSTATES  202
 
 /* YYTRANSLATE[YYX] -- Symbol number corresponding to YYX as returned
    by yylex, with out-of-bounds checking.  */
 #define YYUNDEFTOK  2
-#define YYMAXUTOK   291
+#define YYMAXUTOK   292
 
 #define YYTRANSLATE(YYX)                                                \
   ((unsigned int) (YYX) <= YYMAXUTOK ? yytranslate[YYX] : YYUNDEFTOK)
@@ -478,10 +479,10 @@ static const yytype_uint8 yytranslate[] =
        0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-       2,     2,     2,    38,     2,     2,     2,    43,     2,     2,
-      46,    47,    41,    39,    48,    40,    49,    42,     2,     2,
+       2,     2,     2,    39,     2,     2,     2,    44,     2,     2,
+      47,    48,    42,    40,    49,    41,    50,    43,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-      36,    35,    37,     2,     2,     2,     2,     2,     2,     2,
+      37,    36,    38,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -504,23 +505,23 @@ static const yytype_uint8 yytranslate[] =
        5,     6,     7,     8,     9,    10,    11,    12,    13,    14,
       15,    16,    17,    18,    19,    20,    21,    22,    23,    24,
       25,    26,    27,    28,    29,    30,    31,    32,    33,    34,
-      44,    45
+      35,    45,    46
 };
 
 #if YYDEBUG
   /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_uint16 yyrline[] =
 {
-       0,   121,   121,   122,   127,   133,   138,   146,   154,   161,
-     169,   177,   185,   193,   201,   209,   217,   225,   233,   241,
-     253,   262,   275,   284,   297,   306,   319,   326,   338,   344,
-     351,   359,   372,   377,   382,   386,   391,   396,   401,   417,
-     424,   431,   438,   445,   452,   488,   496,   502,   509,   518,
-     536,   556,   557,   560,   565,   571,   572,   574,   582,   583,
-     586,   595,   606,   621,   642,   673,   708,   733,   762,   768,
-     770,   771,   776,   777,   783,   790,   791,   794,   795,   798,
-     804,   810,   817,   818,   825,   826,   834,   844,   855,   866,
-     879,   890
+       0,   122,   122,   123,   128,   134,   139,   147,   155,   162,
+     170,   178,   186,   194,   202,   210,   218,   226,   234,   242,
+     254,   263,   276,   285,   298,   307,   320,   327,   339,   345,
+     352,   360,   373,   378,   383,   387,   392,   397,   402,   418,
+     425,   432,   439,   446,   453,   489,   497,   503,   510,   519,
+     537,   557,   558,   561,   566,   572,   573,   575,   583,   584,
+     587,   596,   607,   622,   643,   674,   709,   734,   763,   769,
+     771,   772,   777,   778,   784,   791,   792,   795,   796,   799,
+     806,   807,   810,   811,   814,   820,   826,   833,   834,   841,
+     842,   850,   860,   871,   882,   895,   906
 };
 #endif
 
@@ -533,15 +534,16 @@ static const char *const yytname[] =
   "\"floating point number\"", "\"string\"", "\"identifier\"", "\"IN\"",
   "\"LIKE\"", "\"ESCAPE\"", "\"BETWEEN\"", "\"NULL\"", "\"IS\"",
   "\"SELECT\"", "\"LEFT\"", "\"JOIN\"", "\"WHERE\"", "\"ON\"", "\"ORDER\"",
-  "\"BY\"", "\"FROM\"", "\"AS\"", "\"ASC\"", "\"DESC\"", "\"DISTINCT\"",
-  "\"CAST\"", "\"UNION\"", "\"ALL\"", "\"LIMIT\"", "\"OFFSET\"",
-  "SWQT_VALUE_START", "SWQT_SELECT_START", "\"NOT\"", "\"OR\"", "\"AND\"",
-  "'='", "'<'", "'>'", "'!'", "'+'", "'-'", "'*'", "'/'", "'%'",
-  "SWQT_UMINUS", "\"reserved keyword\"", "'('", "')'", "','", "'.'",
-  "$accept", "input", "value_expr", "value_expr_list", "field_value",
-  "value_expr_non_logical", "type_def", "select_statement", "select_core",
-  "opt_union_all", "union_all", "select_field_list", "column_spec",
-  "as_clause", "opt_where", "opt_joins", "opt_order_by", "sort_spec_list",
+  "\"GROUP\"", "\"BY\"", "\"FROM\"", "\"AS\"", "\"ASC\"", "\"DESC\"",
+  "\"DISTINCT\"", "\"CAST\"", "\"UNION\"", "\"ALL\"", "\"LIMIT\"",
+  "\"OFFSET\"", "SWQT_VALUE_START", "SWQT_SELECT_START", "\"NOT\"",
+  "\"OR\"", "\"AND\"", "'='", "'<'", "'>'", "'!'", "'+'", "'-'", "'*'",
+  "'/'", "'%'", "SWQT_UMINUS", "\"reserved keyword\"", "'('", "')'", "','",
+  "'.'", "$accept", "input", "value_expr", "value_expr_list",
+  "field_value", "value_expr_non_logical", "type_def", "select_statement",
+  "select_core", "opt_union_all", "union_all", "select_field_list",
+  "column_spec", "as_clause", "opt_where", "opt_joins", "opt_group_by",
+  "group_spec_list", "group_spec", "opt_order_by", "sort_spec_list",
   "sort_spec", "opt_limit", "opt_offset", "table_def", YY_NULLPTR
 };
 #endif
@@ -554,8 +556,9 @@ static const yytype_uint16 yytoknum[] =
        0,   256,   257,   258,   259,   260,   261,   262,   263,   264,
      265,   266,   267,   268,   269,   270,   271,   272,   273,   274,
      275,   276,   277,   278,   279,   280,   281,   282,   283,   284,
-     285,   286,   287,   288,   289,    61,    60,    62,    33,    43,
-      45,    42,    47,    37,   290,   291,    40,    41,    44,    46
+     285,   286,   287,   288,   289,   290,    61,    60,    62,    33,
+      43,    45,    42,    47,    37,   291,   292,    40,    41,    44,
+      46
 };
 # endif
 
@@ -573,26 +576,27 @@ static const yytype_uint16 yytoknum[] =
      STATE-NUM.  */
 static const yytype_int16 yypact[] =
 {
-      10,   181,    -9,    12,  -126,  -126,  -126,   -29,  -126,   -27,
-     181,   204,   181,   314,  -126,   183,    53,     8,  -126,    28,
-    -126,   181,    59,   181,   352,  -126,   230,    30,   181,   204,
-      -8,     6,   181,   181,    86,   104,   158,    63,   204,   204,
-     204,   204,   204,    20,   171,  -126,   266,    94,    58,    69,
-      92,  -126,    -9,   223,    70,  -126,   299,  -126,   181,   111,
-      61,  -126,   110,    78,   181,   204,   331,   346,   181,   181,
-    -126,   181,   181,  -126,   181,  -126,   181,   -13,   -13,  -126,
-    -126,  -126,   148,     1,   107,  -126,   122,  -126,    55,   171,
-      28,  -126,  -126,   181,  -126,   124,    84,   181,   204,  -126,
-     181,   126,   357,  -126,  -126,  -126,  -126,  -126,  -126,   127,
-      91,  -126,    55,  -126,    88,     4,    65,  -126,  -126,  -126,
-      96,    93,  -126,  -126,   183,    98,   181,   204,    97,   100,
-       2,    65,   137,   142,  -126,   140,    55,   141,    49,  -126,
-    -126,  -126,   183,     2,  -126,   141,     2,     2,    55,   143,
-     181,   138,    36,    39,  -126,   138,  -126,  -126,   149,   181,
-     314,   146,   150,  -126,   165,  -126,   167,   150,   181,   281,
-     127,   168,   152,   132,   144,   152,   281,  -126,    90,  -126,
-     147,  -126,   194,  -126,  -126,  -126,  -126,  -126,  -126,  -126,
-     127,  -126,  -126
+      22,   194,    -6,    12,  -126,  -126,  -126,   -37,  -126,   -33,
+     194,   207,   194,   320,  -126,    16,    74,     3,  -126,    13,
+    -126,   194,    15,   194,   340,  -126,   232,    -5,   194,   207,
+       6,    96,   194,   194,    86,   133,   149,    30,   207,   207,
+     207,   207,   207,   -24,   183,  -126,   269,    48,    25,    36,
+      59,  -126,    -6,   224,    45,  -126,   287,  -126,   194,    89,
+     345,  -126,    84,    55,   194,   207,   327,   334,   194,   194,
+    -126,   194,   194,  -126,   194,  -126,   194,   -14,   -14,  -126,
+    -126,  -126,   137,    -4,    92,  -126,   114,  -126,    76,   183,
+      13,  -126,  -126,   194,  -126,   116,    78,   194,   207,  -126,
+     194,   123,   355,  -126,  -126,  -126,  -126,  -126,  -126,   129,
+      97,  -126,    76,  -126,   100,     2,    94,  -126,  -126,  -126,
+      99,   103,  -126,  -126,    16,   108,   194,   207,   111,   109,
+      -3,    94,   141,   158,  -126,   150,    76,   152,    58,  -126,
+    -126,  -126,    16,    -3,  -126,   152,    -3,    -3,    76,   155,
+     194,   154,    62,    80,  -126,   154,  -126,  -126,   159,   194,
+     320,   157,   163,  -126,   180,  -126,   188,   163,   194,   278,
+     129,   172,   164,   147,   153,   164,   278,  -126,  -126,  -126,
+     165,   129,   199,   173,  -126,  -126,   173,  -126,   129,   107,
+    -126,   166,  -126,   201,  -126,  -126,  -126,  -126,  -126,   129,
+    -126,  -126
 };
 
   /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
@@ -611,23 +615,24 @@ static const yytype_uint8 yydefact[] =
       42,    43,     0,     0,     0,    69,     0,    61,     0,     0,
       55,    57,    56,     0,    44,     0,     0,     0,     0,    27,
        0,    19,     0,    15,    16,    14,    10,    17,    11,     0,
-       0,    63,     0,    68,     0,    86,    72,    59,    52,    28,
+       0,    63,     0,    68,     0,    91,    72,    59,    52,    28,
       46,     0,    22,    20,    24,     0,     0,     0,    30,     0,
-      64,    72,     0,     0,    87,     0,     0,    70,     0,    45,
-      23,    21,    25,    66,    65,    70,    88,    90,     0,     0,
-       0,    75,     0,     0,    67,    75,    89,    91,     0,     0,
-      71,     0,    82,    47,     0,    49,     0,    82,     0,    72,
-       0,     0,    84,     0,     0,    84,    72,    73,    79,    76,
-      78,    83,     0,    53,    48,    50,    54,    74,    80,    81,
-       0,    85,    77
+      64,    72,     0,     0,    92,     0,     0,    70,     0,    45,
+      23,    21,    25,    66,    65,    70,    93,    95,     0,     0,
+       0,    75,     0,     0,    67,    75,    94,    96,     0,     0,
+      71,     0,    80,    47,     0,    49,     0,    80,     0,    72,
+       0,     0,    87,     0,     0,    87,    72,    73,    79,    76,
+      78,     0,     0,    89,    48,    50,    89,    74,     0,    84,
+      81,    83,    88,     0,    53,    54,    77,    85,    86,     0,
+      90,    82
 };
 
   /* YYPGOTO[NTERM-NUM].  */
 static const yytype_int16 yypgoto[] =
 {
-    -126,  -126,    -1,   -19,  -108,     7,  -126,   153,   182,   112,
-    -126,   -39,  -126,   139,    56,  -125,    45,    24,  -126,    51,
-      41,  -110
+    -126,  -126,    -1,   -38,  -105,     7,  -126,   156,   189,   117,
+    -126,   -39,  -126,   -29,    72,  -125,    64,    33,  -126,    56,
+      23,  -126,    51,    42,  -111
 };
 
   /* YYDEFGOTO[NTERM-NUM].  */
@@ -635,7 +640,7 @@ static const yytype_int16 yydefgoto[] =
 {
       -1,     3,    53,    54,    14,    15,   121,    18,    19,    51,
       52,    47,    48,    87,   151,   137,   162,   179,   180,   172,
-     183,   116
+     190,   191,   183,   194,   116
 };
 
   /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
@@ -643,133 +648,132 @@ static const yytype_int16 yydefgoto[] =
      number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_uint8 yytable[] =
 {
-      13,   129,   131,    61,    16,    84,   145,    55,    85,    24,
-      85,    26,    20,    63,    64,    46,    65,    21,    25,    23,
-      22,    16,    56,    86,    62,    86,   149,    59,    40,    41,
-      42,    66,    67,    70,    73,    75,    60,    17,   158,    96,
-       1,     2,   111,    46,   177,    77,    78,    79,    80,    81,
-     117,   187,   152,   133,    50,   153,     4,     5,     6,    43,
-     114,   115,   178,   101,     8,    55,    82,   103,   104,    83,
-     105,   106,   102,   107,   119,   108,    58,    44,     9,   135,
-     136,   125,   178,   163,   164,    10,   165,   166,    46,     4,
-       5,     6,     7,    11,    45,    98,   123,     8,    76,    12,
-      38,    39,    40,    41,    42,   124,    89,     4,     5,     6,
-       7,     9,   188,   189,    88,     8,    90,    94,    10,    91,
-      97,    99,    68,    69,   100,   141,    11,   112,   113,     9,
-     120,   122,    12,   128,   142,   126,    10,   132,   130,    71,
-     139,    72,   138,   146,    11,   140,    22,   143,   147,   160,
-      12,     4,     5,     6,     7,   148,   161,   150,   169,     8,
-     159,     4,     5,     6,     7,   170,   168,   176,   173,     8,
-     174,   181,   109,     9,     4,     5,     6,    43,   171,   184,
-      10,   182,     8,     9,     4,     5,     6,     7,    11,   110,
-      10,   185,     8,    74,    12,   190,     9,   191,    11,    49,
-     167,   155,   118,    10,    12,    92,     9,     4,     5,     6,
-       7,    11,    45,    10,   192,     8,   186,    12,   175,     0,
-       0,    11,    38,    39,    40,    41,    42,    12,     0,     9,
-      27,    28,     0,    29,     0,    30,     0,    27,    28,     0,
-      29,     0,    30,     0,    11,     0,     0,     0,     0,     0,
-      12,     0,     0,     0,   134,    31,    32,    33,    34,    35,
-      36,    37,    31,    32,    33,    34,    35,    36,    37,   144,
-       0,    93,    85,    27,    28,     0,    29,    57,    30,     0,
-       0,     0,   154,     0,     0,   156,   157,    86,    27,    28,
-       0,    29,     0,    30,     0,   135,   136,     0,    31,    32,
-      33,    34,    35,    36,    37,     0,    27,    28,     0,    29,
-       0,    30,     0,    31,    32,    33,    34,    35,    36,    37,
-      95,    27,    28,     0,    29,     0,    30,     0,     0,     0,
-       0,    31,    32,    33,    34,    35,    36,    37,    27,    28,
-       0,    29,     0,    30,     0,     0,    31,    32,    33,    34,
-      35,    36,    37,    27,    28,     0,    29,     0,    30,    27,
-      28,     0,    29,    31,    30,    33,    34,    35,    36,    37,
-       0,     0,     0,     0,     0,     0,     0,     0,    31,     0,
-       0,    34,    35,    36,    37,     0,     0,    34,    35,    36,
-      37,   127,     0,     0,     0,     0,    38,    39,    40,    41,
-      42
+      13,   131,    55,    85,   129,    84,   145,    16,    85,    24,
+      21,    26,    20,    22,    23,    46,    16,    61,    25,    86,
+      96,    55,    56,    82,    86,   149,    83,    59,    40,    41,
+      42,    66,    67,    70,    73,    75,    60,   158,   111,    62,
+      50,    17,    58,    46,   177,    77,    78,    79,    80,    81,
+     117,   187,   133,     1,     2,   119,    38,    39,    40,    41,
+      42,   152,   125,   101,   153,   178,    76,   103,   104,    88,
+     105,   106,   102,   107,    89,   108,   189,     4,     5,     6,
+      43,   114,   115,   178,    90,     8,   134,    91,    46,     4,
+       5,     6,     7,    94,   189,    99,   123,     8,    97,    44,
+       9,   144,   100,    63,    64,   124,    65,    10,   135,   136,
+     163,   164,     9,   112,   154,    11,    45,   156,   157,    10,
+     113,    12,   120,    68,    69,   141,   122,    11,   165,   166,
+     197,   198,   126,    12,   142,   128,     4,     5,     6,     7,
+       4,     5,     6,     7,     8,   130,   138,   146,     8,   160,
+     132,   139,     4,     5,     6,     7,   140,   143,   169,     9,
+       8,    22,   109,     9,   147,   148,    10,   176,   150,    71,
+      10,    72,   159,   161,    11,     9,   168,   170,    11,   110,
+      12,   171,    10,   173,    12,    74,     4,     5,     6,    43,
+      11,   174,   181,   182,     8,   184,    12,     4,     5,     6,
+       7,   185,   192,   193,   200,     8,    49,   118,    92,     9,
+       4,     5,     6,     7,   188,   199,    10,   155,     8,   167,
+       9,   196,   201,   175,    11,    45,   186,    10,   195,     0,
+      12,    27,    28,     9,    29,    11,    30,     0,     0,    27,
+      28,    12,    29,     0,    30,     0,     0,     0,    11,     0,
+       0,     0,     0,     0,    12,     0,     0,    31,    32,    33,
+      34,    35,    36,    37,     0,    31,    32,    33,    34,    35,
+      36,    37,     0,    93,     0,    85,    27,    28,     0,    29,
+      57,    30,     0,     0,     0,    27,    28,     0,    29,     0,
+      30,    86,   135,   136,    27,    28,     0,    29,     0,    30,
+       0,     0,    31,    32,    33,    34,    35,    36,    37,    95,
+       0,    31,    32,    33,    34,    35,    36,    37,     0,     0,
+      31,    32,    33,    34,    35,    36,    37,    27,    28,     0,
+      29,     0,    30,     0,    27,    28,     0,    29,     0,    30,
+       0,    27,    28,     0,    29,     0,    30,    27,    28,     0,
+      29,     0,    30,    31,    32,    33,    34,    35,    36,    37,
+      31,     0,    33,    34,    35,    36,    37,    31,     0,     0,
+      34,    35,    36,    37,     0,     0,    34,    35,    36,    37,
+      98,     0,     0,     0,     0,    38,    39,    40,    41,    42,
+     127,     0,     0,     0,     0,    38,    39,    40,    41,    42
 };
 
 static const yytype_int16 yycheck[] =
 {
-       1,   109,   112,    11,    13,    44,   131,     6,     6,    10,
-       6,    12,     0,     7,     8,    16,    10,    46,    11,    46,
-      49,    13,    23,    21,    32,    21,   136,    28,    41,    42,
-      43,    32,    33,    34,    35,    36,    29,    46,   148,    58,
-      30,    31,    41,    44,   169,    38,    39,    40,    41,    42,
-      89,   176,     3,    49,    26,     6,     3,     4,     5,     6,
-       5,     6,   170,    64,    11,     6,    46,    68,    69,    49,
-      71,    72,    65,    74,    93,    76,    46,    24,    25,    14,
-      15,   100,   190,    47,    48,    32,    47,    48,    89,     3,
-       4,     5,     6,    40,    41,    34,    97,    11,    35,    46,
-      39,    40,    41,    42,    43,    98,    48,     3,     4,     5,
-       6,    25,    22,    23,    20,    11,    47,    47,    32,    27,
-       9,    11,    36,    37,    46,   126,    40,    20,     6,    25,
-       6,    47,    46,     6,   127,     9,    32,    49,    47,    35,
-      47,    37,    46,     6,    40,    47,    49,    47,     6,   150,
-      46,     3,     4,     5,     6,    15,    18,    16,   159,    11,
-      17,     3,     4,     5,     6,    19,    17,   168,     3,    11,
-       3,     3,    24,    25,     3,     4,     5,     6,    28,    47,
-      32,    29,    11,    25,     3,     4,     5,     6,    40,    41,
-      32,    47,    11,    35,    46,    48,    25,     3,    40,    17,
-     155,   145,    90,    32,    46,    52,    25,     3,     4,     5,
-       6,    40,    41,    32,   190,    11,   175,    46,   167,    -1,
-      -1,    40,    39,    40,    41,    42,    43,    46,    -1,    25,
-       7,     8,    -1,    10,    -1,    12,    -1,     7,     8,    -1,
-      10,    -1,    12,    -1,    40,    -1,    -1,    -1,    -1,    -1,
-      46,    -1,    -1,    -1,   115,    32,    33,    34,    35,    36,
-      37,    38,    32,    33,    34,    35,    36,    37,    38,   130,
-      -1,    48,     6,     7,     8,    -1,    10,    47,    12,    -1,
-      -1,    -1,   143,    -1,    -1,   146,   147,    21,     7,     8,
-      -1,    10,    -1,    12,    -1,    14,    15,    -1,    32,    33,
-      34,    35,    36,    37,    38,    -1,     7,     8,    -1,    10,
-      -1,    12,    -1,    32,    33,    34,    35,    36,    37,    38,
-      21,     7,     8,    -1,    10,    -1,    12,    -1,    -1,    -1,
-      -1,    32,    33,    34,    35,    36,    37,    38,     7,     8,
-      -1,    10,    -1,    12,    -1,    -1,    32,    33,    34,    35,
-      36,    37,    38,     7,     8,    -1,    10,    -1,    12,     7,
-       8,    -1,    10,    32,    12,    34,    35,    36,    37,    38,
-      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    32,    -1,
-      -1,    35,    36,    37,    38,    -1,    -1,    35,    36,    37,
-      38,    34,    -1,    -1,    -1,    -1,    39,    40,    41,    42,
-      43
+       1,   112,     6,     6,   109,    44,   131,    13,     6,    10,
+      47,    12,     0,    50,    47,    16,    13,    11,    11,    22,
+      58,     6,    23,    47,    22,   136,    50,    28,    42,    43,
+      44,    32,    33,    34,    35,    36,    29,   148,    42,    33,
+      27,    47,    47,    44,   169,    38,    39,    40,    41,    42,
+      89,   176,    50,    31,    32,    93,    40,    41,    42,    43,
+      44,     3,   100,    64,     6,   170,    36,    68,    69,    21,
+      71,    72,    65,    74,    49,    76,   181,     3,     4,     5,
+       6,     5,     6,   188,    48,    11,   115,    28,    89,     3,
+       4,     5,     6,    48,   199,    11,    97,    11,     9,    25,
+      26,   130,    47,     7,     8,    98,    10,    33,    14,    15,
+      48,    49,    26,    21,   143,    41,    42,   146,   147,    33,
+       6,    47,     6,    37,    38,   126,    48,    41,    48,    49,
+      23,    24,     9,    47,   127,     6,     3,     4,     5,     6,
+       3,     4,     5,     6,    11,    48,    47,     6,    11,   150,
+      50,    48,     3,     4,     5,     6,    48,    48,   159,    26,
+      11,    50,    25,    26,     6,    15,    33,   168,    16,    36,
+      33,    38,    17,    19,    41,    26,    17,    20,    41,    42,
+      47,    18,    33,     3,    47,    36,     3,     4,     5,     6,
+      41,     3,    20,    29,    11,    48,    47,     3,     4,     5,
+       6,    48,     3,    30,     3,    11,    17,    90,    52,    26,
+       3,     4,     5,     6,    49,    49,    33,   145,    11,   155,
+      26,   188,   199,   167,    41,    42,   175,    33,   186,    -1,
+      47,     7,     8,    26,    10,    41,    12,    -1,    -1,     7,
+       8,    47,    10,    -1,    12,    -1,    -1,    -1,    41,    -1,
+      -1,    -1,    -1,    -1,    47,    -1,    -1,    33,    34,    35,
+      36,    37,    38,    39,    -1,    33,    34,    35,    36,    37,
+      38,    39,    -1,    49,    -1,     6,     7,     8,    -1,    10,
+      48,    12,    -1,    -1,    -1,     7,     8,    -1,    10,    -1,
+      12,    22,    14,    15,     7,     8,    -1,    10,    -1,    12,
+      -1,    -1,    33,    34,    35,    36,    37,    38,    39,    22,
+      -1,    33,    34,    35,    36,    37,    38,    39,    -1,    -1,
+      33,    34,    35,    36,    37,    38,    39,     7,     8,    -1,
+      10,    -1,    12,    -1,     7,     8,    -1,    10,    -1,    12,
+      -1,     7,     8,    -1,    10,    -1,    12,     7,     8,    -1,
+      10,    -1,    12,    33,    34,    35,    36,    37,    38,    39,
+      33,    -1,    35,    36,    37,    38,    39,    33,    -1,    -1,
+      36,    37,    38,    39,    -1,    -1,    36,    37,    38,    39,
+      35,    -1,    -1,    -1,    -1,    40,    41,    42,    43,    44,
+      35,    -1,    -1,    -1,    -1,    40,    41,    42,    43,    44
 };
 
   /* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
      symbol of state STATE-NUM.  */
 static const yytype_uint8 yystos[] =
 {
-       0,    30,    31,    51,     3,     4,     5,     6,    11,    25,
-      32,    40,    46,    52,    54,    55,    13,    46,    57,    58,
-       0,    46,    49,    46,    52,    55,    52,     7,     8,    10,
-      12,    32,    33,    34,    35,    36,    37,    38,    39,    40,
-      41,    42,    43,     6,    24,    41,    52,    61,    62,    58,
-      26,    59,    60,    52,    53,     6,    52,    47,    46,    52,
-      55,    11,    32,     7,     8,    10,    52,    52,    36,    37,
-      52,    35,    37,    52,    35,    52,    35,    55,    55,    55,
-      55,    55,    46,    49,    61,     6,    21,    63,    20,    48,
-      47,    27,    57,    48,    47,    21,    53,     9,    34,    11,
-      46,    52,    55,    52,    52,    52,    52,    52,    52,    24,
-      41,    41,    20,     6,     5,     6,    71,    61,    59,    53,
-       6,    56,    47,    52,    55,    53,     9,    34,     6,    54,
-      47,    71,    49,    49,    63,    14,    15,    65,    46,    47,
-      47,    52,    55,    47,    63,    65,     6,     6,    15,    71,
-      16,    64,     3,     6,    63,    64,    63,    63,    71,    17,
-      52,    18,    66,    47,    48,    47,    48,    66,    17,    52,
-      19,    28,    69,     3,     3,    69,    52,    65,    54,    67,
-      68,     3,    29,    70,    47,    47,    70,    65,    22,    23,
-      48,     3,    67
+       0,    31,    32,    52,     3,     4,     5,     6,    11,    26,
+      33,    41,    47,    53,    55,    56,    13,    47,    58,    59,
+       0,    47,    50,    47,    53,    56,    53,     7,     8,    10,
+      12,    33,    34,    35,    36,    37,    38,    39,    40,    41,
+      42,    43,    44,     6,    25,    42,    53,    62,    63,    59,
+      27,    60,    61,    53,    54,     6,    53,    48,    47,    53,
+      56,    11,    33,     7,     8,    10,    53,    53,    37,    38,
+      53,    36,    38,    53,    36,    53,    36,    56,    56,    56,
+      56,    56,    47,    50,    62,     6,    22,    64,    21,    49,
+      48,    28,    58,    49,    48,    22,    54,     9,    35,    11,
+      47,    53,    56,    53,    53,    53,    53,    53,    53,    25,
+      42,    42,    21,     6,     5,     6,    75,    62,    60,    54,
+       6,    57,    48,    53,    56,    54,     9,    35,     6,    55,
+      48,    75,    50,    50,    64,    14,    15,    66,    47,    48,
+      48,    53,    56,    48,    64,    66,     6,     6,    15,    75,
+      16,    65,     3,     6,    64,    65,    64,    64,    75,    17,
+      53,    19,    67,    48,    49,    48,    49,    67,    17,    53,
+      20,    18,    70,     3,     3,    70,    53,    66,    55,    68,
+      69,    20,    29,    73,    48,    48,    73,    66,    49,    55,
+      71,    72,     3,    30,    74,    74,    68,    23,    24,    49,
+       3,    71
 };
 
   /* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
 static const yytype_uint8 yyr1[] =
 {
-       0,    50,    51,    51,    51,    52,    52,    52,    52,    52,
-      52,    52,    52,    52,    52,    52,    52,    52,    52,    52,
-      52,    52,    52,    52,    52,    52,    52,    52,    53,    53,
-      54,    54,    55,    55,    55,    55,    55,    55,    55,    55,
-      55,    55,    55,    55,    55,    55,    56,    56,    56,    56,
-      56,    57,    57,    58,    58,    59,    59,    60,    61,    61,
-      62,    62,    62,    62,    62,    62,    62,    62,    63,    63,
-      64,    64,    65,    65,    65,    66,    66,    67,    67,    68,
-      68,    68,    69,    69,    70,    70,    71,    71,    71,    71,
-      71,    71
+       0,    51,    52,    52,    52,    53,    53,    53,    53,    53,
+      53,    53,    53,    53,    53,    53,    53,    53,    53,    53,
+      53,    53,    53,    53,    53,    53,    53,    53,    54,    54,
+      55,    55,    56,    56,    56,    56,    56,    56,    56,    56,
+      56,    56,    56,    56,    56,    56,    57,    57,    57,    57,
+      57,    58,    58,    59,    59,    60,    60,    61,    62,    62,
+      63,    63,    63,    63,    63,    63,    63,    63,    64,    64,
+      65,    65,    66,    66,    66,    67,    67,    68,    68,    69,
+      70,    70,    71,    71,    72,    72,    72,    73,    73,    74,
+      74,    75,    75,    75,    75,    75,    75
 };
 
   /* YYR2[YYN] -- Number of symbols on the right hand side of rule YYN.  */
@@ -780,11 +784,11 @@ static const yytype_uint8 yyr2[] =
        5,     6,     5,     6,     5,     6,     3,     4,     3,     1,
        1,     3,     1,     1,     1,     1,     3,     1,     2,     3,
        3,     3,     3,     3,     4,     6,     1,     4,     6,     4,
-       6,     2,     4,     9,    10,     0,     2,     2,     1,     3,
+       6,     2,     4,    10,    11,     0,     2,     2,     1,     3,
        1,     2,     1,     3,     4,     5,     5,     6,     2,     1,
        0,     2,     0,     5,     6,     0,     3,     3,     1,     1,
-       2,     2,     0,     2,     0,     2,     1,     2,     3,     4,
-       3,     4
+       0,     3,     3,     1,     1,     2,     2,     0,     2,     0,
+       2,     1,     2,     3,     4,     3,     4
 };
 
 
@@ -1210,63 +1214,63 @@ yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep, swq_parse_context
   switch (yytype)
     {
           case 3: /* "integer number"  */
-#line 116 "swq_parser.y" /* yacc.c:1257  */
+#line 117 "swq_parser.y" /* yacc.c:1257  */
       { delete ((*yyvaluep)); }
-#line 1216 "swq_parser.cpp" /* yacc.c:1257  */
+#line 1220 "swq_parser.cpp" /* yacc.c:1257  */
         break;
 
     case 4: /* "floating point number"  */
-#line 116 "swq_parser.y" /* yacc.c:1257  */
+#line 117 "swq_parser.y" /* yacc.c:1257  */
       { delete ((*yyvaluep)); }
-#line 1222 "swq_parser.cpp" /* yacc.c:1257  */
+#line 1226 "swq_parser.cpp" /* yacc.c:1257  */
         break;
 
     case 5: /* "string"  */
-#line 116 "swq_parser.y" /* yacc.c:1257  */
+#line 117 "swq_parser.y" /* yacc.c:1257  */
       { delete ((*yyvaluep)); }
-#line 1228 "swq_parser.cpp" /* yacc.c:1257  */
+#line 1232 "swq_parser.cpp" /* yacc.c:1257  */
         break;
 
     case 6: /* "identifier"  */
-#line 116 "swq_parser.y" /* yacc.c:1257  */
+#line 117 "swq_parser.y" /* yacc.c:1257  */
       { delete ((*yyvaluep)); }
-#line 1234 "swq_parser.cpp" /* yacc.c:1257  */
+#line 1238 "swq_parser.cpp" /* yacc.c:1257  */
         break;
 
-    case 52: /* value_expr  */
-#line 117 "swq_parser.y" /* yacc.c:1257  */
+    case 53: /* value_expr  */
+#line 118 "swq_parser.y" /* yacc.c:1257  */
       { delete ((*yyvaluep)); }
-#line 1240 "swq_parser.cpp" /* yacc.c:1257  */
+#line 1244 "swq_parser.cpp" /* yacc.c:1257  */
         break;
 
-    case 53: /* value_expr_list  */
-#line 117 "swq_parser.y" /* yacc.c:1257  */
+    case 54: /* value_expr_list  */
+#line 118 "swq_parser.y" /* yacc.c:1257  */
       { delete ((*yyvaluep)); }
-#line 1246 "swq_parser.cpp" /* yacc.c:1257  */
+#line 1250 "swq_parser.cpp" /* yacc.c:1257  */
         break;
 
-    case 54: /* field_value  */
-#line 117 "swq_parser.y" /* yacc.c:1257  */
+    case 55: /* field_value  */
+#line 118 "swq_parser.y" /* yacc.c:1257  */
       { delete ((*yyvaluep)); }
-#line 1252 "swq_parser.cpp" /* yacc.c:1257  */
+#line 1256 "swq_parser.cpp" /* yacc.c:1257  */
         break;
 
-    case 55: /* value_expr_non_logical  */
-#line 117 "swq_parser.y" /* yacc.c:1257  */
+    case 56: /* value_expr_non_logical  */
+#line 118 "swq_parser.y" /* yacc.c:1257  */
       { delete ((*yyvaluep)); }
-#line 1258 "swq_parser.cpp" /* yacc.c:1257  */
+#line 1262 "swq_parser.cpp" /* yacc.c:1257  */
         break;
 
-    case 56: /* type_def  */
-#line 117 "swq_parser.y" /* yacc.c:1257  */
+    case 57: /* type_def  */
+#line 118 "swq_parser.y" /* yacc.c:1257  */
       { delete ((*yyvaluep)); }
-#line 1264 "swq_parser.cpp" /* yacc.c:1257  */
+#line 1268 "swq_parser.cpp" /* yacc.c:1257  */
         break;
 
-    case 71: /* table_def  */
-#line 117 "swq_parser.y" /* yacc.c:1257  */
+    case 75: /* table_def  */
+#line 118 "swq_parser.y" /* yacc.c:1257  */
       { delete ((*yyvaluep)); }
-#line 1270 "swq_parser.cpp" /* yacc.c:1257  */
+#line 1274 "swq_parser.cpp" /* yacc.c:1257  */
         break;
 
 
@@ -1532,173 +1536,173 @@ yyreduce:
   switch (yyn)
     {
         case 3:
-#line 123 "swq_parser.y" /* yacc.c:1646  */
+#line 124 "swq_parser.y" /* yacc.c:1646  */
     {
             context->poRoot = (yyvsp[0]);
         }
-#line 1540 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1544 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 4:
-#line 128 "swq_parser.y" /* yacc.c:1646  */
+#line 129 "swq_parser.y" /* yacc.c:1646  */
     {
             context->poRoot = (yyvsp[0]);
         }
-#line 1548 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1552 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 5:
-#line 134 "swq_parser.y" /* yacc.c:1646  */
+#line 135 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = (yyvsp[0]);
         }
-#line 1556 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1560 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 6:
-#line 139 "swq_parser.y" /* yacc.c:1646  */
+#line 140 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = new swq_expr_node( SWQ_AND );
             (yyval)->field_type = SWQ_BOOLEAN;
             (yyval)->PushSubExpression( (yyvsp[-2]) );
             (yyval)->PushSubExpression( (yyvsp[0]) );
         }
-#line 1567 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1571 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 7:
-#line 147 "swq_parser.y" /* yacc.c:1646  */
+#line 148 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = new swq_expr_node( SWQ_OR );
             (yyval)->field_type = SWQ_BOOLEAN;
             (yyval)->PushSubExpression( (yyvsp[-2]) );
             (yyval)->PushSubExpression( (yyvsp[0]) );
         }
-#line 1578 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1582 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 8:
-#line 155 "swq_parser.y" /* yacc.c:1646  */
+#line 156 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = new swq_expr_node( SWQ_NOT );
             (yyval)->field_type = SWQ_BOOLEAN;
             (yyval)->PushSubExpression( (yyvsp[0]) );
         }
-#line 1588 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1592 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 9:
-#line 162 "swq_parser.y" /* yacc.c:1646  */
+#line 163 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = new swq_expr_node( SWQ_EQ );
             (yyval)->field_type = SWQ_BOOLEAN;
             (yyval)->PushSubExpression( (yyvsp[-2]) );
             (yyval)->PushSubExpression( (yyvsp[0]) );
         }
-#line 1599 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1603 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 10:
-#line 170 "swq_parser.y" /* yacc.c:1646  */
+#line 171 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = new swq_expr_node( SWQ_NE );
             (yyval)->field_type = SWQ_BOOLEAN;
             (yyval)->PushSubExpression( (yyvsp[-3]) );
             (yyval)->PushSubExpression( (yyvsp[0]) );
         }
-#line 1610 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1614 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 11:
-#line 178 "swq_parser.y" /* yacc.c:1646  */
+#line 179 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = new swq_expr_node( SWQ_NE );
             (yyval)->field_type = SWQ_BOOLEAN;
             (yyval)->PushSubExpression( (yyvsp[-3]) );
             (yyval)->PushSubExpression( (yyvsp[0]) );
         }
-#line 1621 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1625 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 12:
-#line 186 "swq_parser.y" /* yacc.c:1646  */
+#line 187 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = new swq_expr_node( SWQ_LT );
             (yyval)->field_type = SWQ_BOOLEAN;
             (yyval)->PushSubExpression( (yyvsp[-2]) );
             (yyval)->PushSubExpression( (yyvsp[0]) );
         }
-#line 1632 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1636 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 13:
-#line 194 "swq_parser.y" /* yacc.c:1646  */
+#line 195 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = new swq_expr_node( SWQ_GT );
             (yyval)->field_type = SWQ_BOOLEAN;
             (yyval)->PushSubExpression( (yyvsp[-2]) );
             (yyval)->PushSubExpression( (yyvsp[0]) );
         }
-#line 1643 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1647 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 14:
-#line 202 "swq_parser.y" /* yacc.c:1646  */
+#line 203 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = new swq_expr_node( SWQ_LE );
             (yyval)->field_type = SWQ_BOOLEAN;
             (yyval)->PushSubExpression( (yyvsp[-3]) );
             (yyval)->PushSubExpression( (yyvsp[0]) );
         }
-#line 1654 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1658 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 15:
-#line 210 "swq_parser.y" /* yacc.c:1646  */
+#line 211 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = new swq_expr_node( SWQ_LE );
             (yyval)->field_type = SWQ_BOOLEAN;
             (yyval)->PushSubExpression( (yyvsp[-3]) );
             (yyval)->PushSubExpression( (yyvsp[0]) );
         }
-#line 1665 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1669 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 16:
-#line 218 "swq_parser.y" /* yacc.c:1646  */
+#line 219 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = new swq_expr_node( SWQ_LE );
             (yyval)->field_type = SWQ_BOOLEAN;
             (yyval)->PushSubExpression( (yyvsp[-3]) );
             (yyval)->PushSubExpression( (yyvsp[0]) );
         }
-#line 1676 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1680 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 17:
-#line 226 "swq_parser.y" /* yacc.c:1646  */
+#line 227 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = new swq_expr_node( SWQ_GE );
             (yyval)->field_type = SWQ_BOOLEAN;
             (yyval)->PushSubExpression( (yyvsp[-3]) );
             (yyval)->PushSubExpression( (yyvsp[0]) );
         }
-#line 1687 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1691 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 18:
-#line 234 "swq_parser.y" /* yacc.c:1646  */
+#line 235 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = new swq_expr_node( SWQ_LIKE );
             (yyval)->field_type = SWQ_BOOLEAN;
             (yyval)->PushSubExpression( (yyvsp[-2]) );
             (yyval)->PushSubExpression( (yyvsp[0]) );
         }
-#line 1698 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1702 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 19:
-#line 242 "swq_parser.y" /* yacc.c:1646  */
+#line 243 "swq_parser.y" /* yacc.c:1646  */
     {
             swq_expr_node *like = new swq_expr_node( SWQ_LIKE );
             like->field_type = SWQ_BOOLEAN;
@@ -1709,11 +1713,11 @@ yyreduce:
             (yyval)->field_type = SWQ_BOOLEAN;
             (yyval)->PushSubExpression( like );
         }
-#line 1713 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1717 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 20:
-#line 254 "swq_parser.y" /* yacc.c:1646  */
+#line 255 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = new swq_expr_node( SWQ_LIKE );
             (yyval)->field_type = SWQ_BOOLEAN;
@@ -1721,11 +1725,11 @@ yyreduce:
             (yyval)->PushSubExpression( (yyvsp[-2]) );
             (yyval)->PushSubExpression( (yyvsp[0]) );
         }
-#line 1725 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1729 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 21:
-#line 263 "swq_parser.y" /* yacc.c:1646  */
+#line 264 "swq_parser.y" /* yacc.c:1646  */
     {
             swq_expr_node *like = new swq_expr_node( SWQ_LIKE );
             like->field_type = SWQ_BOOLEAN;
@@ -1737,11 +1741,11 @@ yyreduce:
             (yyval)->field_type = SWQ_BOOLEAN;
             (yyval)->PushSubExpression( like );
         }
-#line 1741 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1745 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 22:
-#line 276 "swq_parser.y" /* yacc.c:1646  */
+#line 277 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = (yyvsp[-1]);
             (yyval)->field_type = SWQ_BOOLEAN;
@@ -1749,11 +1753,11 @@ yyreduce:
             (yyval)->PushSubExpression( (yyvsp[-4]) );
             (yyval)->ReverseSubExpressions();
         }
-#line 1753 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1757 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 23:
-#line 285 "swq_parser.y" /* yacc.c:1646  */
+#line 286 "swq_parser.y" /* yacc.c:1646  */
     {
             swq_expr_node *in = (yyvsp[-1]);
             in->field_type = SWQ_BOOLEAN;
@@ -1765,11 +1769,11 @@ yyreduce:
             (yyval)->field_type = SWQ_BOOLEAN;
             (yyval)->PushSubExpression( in );
         }
-#line 1769 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1773 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 24:
-#line 298 "swq_parser.y" /* yacc.c:1646  */
+#line 299 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = new swq_expr_node( SWQ_BETWEEN );
             (yyval)->field_type = SWQ_BOOLEAN;
@@ -1777,11 +1781,11 @@ yyreduce:
             (yyval)->PushSubExpression( (yyvsp[-2]) );
             (yyval)->PushSubExpression( (yyvsp[0]) );
         }
-#line 1781 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1785 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 25:
-#line 307 "swq_parser.y" /* yacc.c:1646  */
+#line 308 "swq_parser.y" /* yacc.c:1646  */
     {
             swq_expr_node *between = new swq_expr_node( SWQ_BETWEEN );
             between->field_type = SWQ_BOOLEAN;
@@ -1793,21 +1797,21 @@ yyreduce:
             (yyval)->field_type = SWQ_BOOLEAN;
             (yyval)->PushSubExpression( between );
         }
-#line 1797 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1801 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 26:
-#line 320 "swq_parser.y" /* yacc.c:1646  */
+#line 321 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = new swq_expr_node( SWQ_ISNULL );
             (yyval)->field_type = SWQ_BOOLEAN;
             (yyval)->PushSubExpression( (yyvsp[-2]) );
         }
-#line 1807 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1811 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 27:
-#line 327 "swq_parser.y" /* yacc.c:1646  */
+#line 328 "swq_parser.y" /* yacc.c:1646  */
     {
             swq_expr_node *isnull = new swq_expr_node( SWQ_ISNULL );
             isnull->field_type = SWQ_BOOLEAN;
@@ -1817,40 +1821,40 @@ yyreduce:
             (yyval)->field_type = SWQ_BOOLEAN;
             (yyval)->PushSubExpression( isnull );
         }
-#line 1821 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1825 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 28:
-#line 339 "swq_parser.y" /* yacc.c:1646  */
+#line 340 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = (yyvsp[0]);
             (yyvsp[0])->PushSubExpression( (yyvsp[-2]) );
         }
-#line 1830 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1834 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 29:
-#line 345 "swq_parser.y" /* yacc.c:1646  */
+#line 346 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = new swq_expr_node( SWQ_ARGUMENT_LIST ); /* temporary value */
             (yyval)->PushSubExpression( (yyvsp[0]) );
         }
-#line 1839 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1843 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 30:
-#line 352 "swq_parser.y" /* yacc.c:1646  */
+#line 353 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = (yyvsp[0]);  // validation deferred.
             (yyval)->eNodeType = SNT_COLUMN;
             (yyval)->field_index = -1;
             (yyval)->table_index = -1;
         }
-#line 1850 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1854 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 31:
-#line 360 "swq_parser.y" /* yacc.c:1646  */
+#line 361 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = (yyvsp[-2]);  // validation deferred.
             (yyval)->eNodeType = SNT_COLUMN;
@@ -1861,59 +1865,59 @@ yyreduce:
             delete (yyvsp[0]);
             (yyvsp[0]) = nullptr;
         }
-#line 1865 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1869 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 32:
-#line 373 "swq_parser.y" /* yacc.c:1646  */
+#line 374 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = (yyvsp[0]);
         }
-#line 1873 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1877 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 33:
-#line 378 "swq_parser.y" /* yacc.c:1646  */
+#line 379 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = (yyvsp[0]);
         }
-#line 1881 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1885 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 34:
-#line 383 "swq_parser.y" /* yacc.c:1646  */
+#line 384 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = (yyvsp[0]);
         }
-#line 1889 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1893 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 35:
-#line 387 "swq_parser.y" /* yacc.c:1646  */
+#line 388 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = (yyvsp[0]);
         }
-#line 1897 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1901 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 36:
-#line 392 "swq_parser.y" /* yacc.c:1646  */
+#line 393 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = (yyvsp[-1]);
         }
-#line 1905 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1909 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 37:
-#line 397 "swq_parser.y" /* yacc.c:1646  */
+#line 398 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = new swq_expr_node((const char*)nullptr);
         }
-#line 1913 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1917 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 38:
-#line 402 "swq_parser.y" /* yacc.c:1646  */
+#line 403 "swq_parser.y" /* yacc.c:1646  */
     {
             if ((yyvsp[0])->eNodeType == SNT_CONSTANT)
             {
@@ -1928,61 +1932,61 @@ yyreduce:
                 (yyval)->PushSubExpression( (yyvsp[0]) );
             }
         }
-#line 1932 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1936 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 39:
-#line 418 "swq_parser.y" /* yacc.c:1646  */
+#line 419 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = new swq_expr_node( SWQ_ADD );
             (yyval)->PushSubExpression( (yyvsp[-2]) );
             (yyval)->PushSubExpression( (yyvsp[0]) );
         }
-#line 1942 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1946 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 40:
-#line 425 "swq_parser.y" /* yacc.c:1646  */
+#line 426 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = new swq_expr_node( SWQ_SUBTRACT );
             (yyval)->PushSubExpression( (yyvsp[-2]) );
             (yyval)->PushSubExpression( (yyvsp[0]) );
         }
-#line 1952 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1956 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 41:
-#line 432 "swq_parser.y" /* yacc.c:1646  */
+#line 433 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = new swq_expr_node( SWQ_MULTIPLY );
             (yyval)->PushSubExpression( (yyvsp[-2]) );
             (yyval)->PushSubExpression( (yyvsp[0]) );
         }
-#line 1962 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1966 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 42:
-#line 439 "swq_parser.y" /* yacc.c:1646  */
+#line 440 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = new swq_expr_node( SWQ_DIVIDE );
             (yyval)->PushSubExpression( (yyvsp[-2]) );
             (yyval)->PushSubExpression( (yyvsp[0]) );
         }
-#line 1972 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1976 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 43:
-#line 446 "swq_parser.y" /* yacc.c:1646  */
+#line 447 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = new swq_expr_node( SWQ_MODULUS );
             (yyval)->PushSubExpression( (yyvsp[-2]) );
             (yyval)->PushSubExpression( (yyvsp[0]) );
         }
-#line 1982 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1986 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 44:
-#line 453 "swq_parser.y" /* yacc.c:1646  */
+#line 454 "swq_parser.y" /* yacc.c:1646  */
     {
             const swq_operation *poOp =
                     swq_op_registrar::GetOperator( (yyvsp[-3])->string_value );
@@ -2017,51 +2021,51 @@ yyreduce:
                 delete (yyvsp[-3]);
             }
         }
-#line 2021 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2025 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 45:
-#line 489 "swq_parser.y" /* yacc.c:1646  */
+#line 490 "swq_parser.y" /* yacc.c:1646  */
     {
             (yyval) = (yyvsp[-1]);
             (yyval)->PushSubExpression( (yyvsp[-3]) );
             (yyval)->ReverseSubExpressions();
         }
-#line 2031 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2035 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 46:
-#line 497 "swq_parser.y" /* yacc.c:1646  */
+#line 498 "swq_parser.y" /* yacc.c:1646  */
     {
         (yyval) = new swq_expr_node( SWQ_CAST );
         (yyval)->PushSubExpression( (yyvsp[0]) );
     }
-#line 2040 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2044 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 47:
-#line 503 "swq_parser.y" /* yacc.c:1646  */
+#line 504 "swq_parser.y" /* yacc.c:1646  */
     {
         (yyval) = new swq_expr_node( SWQ_CAST );
         (yyval)->PushSubExpression( (yyvsp[-1]) );
         (yyval)->PushSubExpression( (yyvsp[-3]) );
     }
-#line 2050 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2054 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 48:
-#line 510 "swq_parser.y" /* yacc.c:1646  */
+#line 511 "swq_parser.y" /* yacc.c:1646  */
     {
         (yyval) = new swq_expr_node( SWQ_CAST );
         (yyval)->PushSubExpression( (yyvsp[-1]) );
         (yyval)->PushSubExpression( (yyvsp[-3]) );
         (yyval)->PushSubExpression( (yyvsp[-5]) );
     }
-#line 2061 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2065 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 49:
-#line 519 "swq_parser.y" /* yacc.c:1646  */
+#line 520 "swq_parser.y" /* yacc.c:1646  */
     {
         OGRwkbGeometryType eType = OGRFromOGCGeomType((yyvsp[-1])->string_value);
         if( !EQUAL((yyvsp[-3])->string_value, "GEOMETRY") ||
@@ -2077,11 +2081,11 @@ yyreduce:
         (yyval)->PushSubExpression( (yyvsp[-1]) );
         (yyval)->PushSubExpression( (yyvsp[-3]) );
     }
-#line 2081 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2085 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 50:
-#line 537 "swq_parser.y" /* yacc.c:1646  */
+#line 538 "swq_parser.y" /* yacc.c:1646  */
     {
         OGRwkbGeometryType eType = OGRFromOGCGeomType((yyvsp[-3])->string_value);
         if( !EQUAL((yyvsp[-5])->string_value, "GEOMETRY") ||
@@ -2099,38 +2103,38 @@ yyreduce:
         (yyval)->PushSubExpression( (yyvsp[-3]) );
         (yyval)->PushSubExpression( (yyvsp[-5]) );
     }
-#line 2103 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2107 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 53:
-#line 561 "swq_parser.y" /* yacc.c:1646  */
+#line 562 "swq_parser.y" /* yacc.c:1646  */
     {
-        delete (yyvsp[-5]);
+        delete (yyvsp[-6]);
     }
-#line 2111 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2115 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 54:
-#line 566 "swq_parser.y" /* yacc.c:1646  */
+#line 567 "swq_parser.y" /* yacc.c:1646  */
     {
         context->poCurSelect->query_mode = SWQM_DISTINCT_LIST;
-        delete (yyvsp[-5]);
+        delete (yyvsp[-6]);
     }
-#line 2120 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2124 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 57:
-#line 575 "swq_parser.y" /* yacc.c:1646  */
+#line 576 "swq_parser.y" /* yacc.c:1646  */
     {
         swq_select* poNewSelect = new swq_select();
         context->poCurSelect->PushUnionAll(poNewSelect);
         context->poCurSelect = poNewSelect;
     }
-#line 2130 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2134 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 60:
-#line 587 "swq_parser.y" /* yacc.c:1646  */
+#line 588 "swq_parser.y" /* yacc.c:1646  */
     {
             if( !context->poCurSelect->PushField( (yyvsp[0]) ) )
             {
@@ -2138,11 +2142,11 @@ yyreduce:
                 YYERROR;
             }
         }
-#line 2142 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2146 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 61:
-#line 596 "swq_parser.y" /* yacc.c:1646  */
+#line 597 "swq_parser.y" /* yacc.c:1646  */
     {
             if( !context->poCurSelect->PushField( (yyvsp[-1]), (yyvsp[0])->string_value ) )
             {
@@ -2152,11 +2156,11 @@ yyreduce:
             }
             delete (yyvsp[0]);
         }
-#line 2156 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2160 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 62:
-#line 607 "swq_parser.y" /* yacc.c:1646  */
+#line 608 "swq_parser.y" /* yacc.c:1646  */
     {
             swq_expr_node *poNode = new swq_expr_node();
             poNode->eNodeType = SNT_COLUMN;
@@ -2170,11 +2174,11 @@ yyreduce:
                 YYERROR;
             }
         }
-#line 2174 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2178 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 63:
-#line 622 "swq_parser.y" /* yacc.c:1646  */
+#line 623 "swq_parser.y" /* yacc.c:1646  */
     {
             CPLString osTableName = (yyvsp[-2])->string_value;
 
@@ -2194,11 +2198,11 @@ yyreduce:
                 YYERROR;
             }
         }
-#line 2198 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2202 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 64:
-#line 643 "swq_parser.y" /* yacc.c:1646  */
+#line 644 "swq_parser.y" /* yacc.c:1646  */
     {
                 // special case for COUNT(*), confirm it.
             if( !EQUAL((yyvsp[-3])->string_value, "COUNT") )
@@ -2228,11 +2232,11 @@ yyreduce:
                 YYERROR;
             }
         }
-#line 2232 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2236 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 65:
-#line 674 "swq_parser.y" /* yacc.c:1646  */
+#line 675 "swq_parser.y" /* yacc.c:1646  */
     {
                 // special case for COUNT(*), confirm it.
             if( !EQUAL((yyvsp[-4])->string_value, "COUNT") )
@@ -2266,11 +2270,11 @@ yyreduce:
 
             delete (yyvsp[0]);
         }
-#line 2270 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2274 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 66:
-#line 709 "swq_parser.y" /* yacc.c:1646  */
+#line 710 "swq_parser.y" /* yacc.c:1646  */
     {
                 // special case for COUNT(DISTINCT x), confirm it.
             if( !EQUAL((yyvsp[-4])->string_value, "COUNT") )
@@ -2294,11 +2298,11 @@ yyreduce:
                 YYERROR;
             }
         }
-#line 2298 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2302 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 67:
-#line 734 "swq_parser.y" /* yacc.c:1646  */
+#line 735 "swq_parser.y" /* yacc.c:1646  */
     {
             // special case for COUNT(DISTINCT x), confirm it.
             if( !EQUAL((yyvsp[-5])->string_value, "COUNT") )
@@ -2325,98 +2329,108 @@ yyreduce:
             delete (yyvsp[-5]);
             delete (yyvsp[0]);
         }
-#line 2329 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2333 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 68:
-#line 763 "swq_parser.y" /* yacc.c:1646  */
+#line 764 "swq_parser.y" /* yacc.c:1646  */
     {
             delete (yyvsp[-1]);
             (yyval) = (yyvsp[0]);
         }
-#line 2338 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2342 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 71:
-#line 772 "swq_parser.y" /* yacc.c:1646  */
+#line 773 "swq_parser.y" /* yacc.c:1646  */
     {
             context->poCurSelect->where_expr = (yyvsp[0]);
         }
-#line 2346 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2350 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 73:
-#line 778 "swq_parser.y" /* yacc.c:1646  */
+#line 779 "swq_parser.y" /* yacc.c:1646  */
     {
             context->poCurSelect->PushJoin( static_cast<int>((yyvsp[-3])->int_value),
                                             (yyvsp[-1]) );
             delete (yyvsp[-3]);
         }
-#line 2356 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2360 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 74:
-#line 784 "swq_parser.y" /* yacc.c:1646  */
+#line 785 "swq_parser.y" /* yacc.c:1646  */
     {
             context->poCurSelect->PushJoin( static_cast<int>((yyvsp[-3])->int_value),
                                             (yyvsp[-1]) );
             delete (yyvsp[-3]);
         }
-#line 2366 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2370 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
   case 79:
-#line 799 "swq_parser.y" /* yacc.c:1646  */
+#line 800 "swq_parser.y" /* yacc.c:1646  */
+    {
+            context->poCurSelect->PushGroupBy( (yyvsp[0])->table_name, (yyvsp[0])->string_value );
+            delete (yyvsp[0]);
+            (yyvsp[0]) = nullptr;
+        }
+#line 2380 "swq_parser.cpp" /* yacc.c:1646  */
+    break;
+
+  case 84:
+#line 815 "swq_parser.y" /* yacc.c:1646  */
     {
             context->poCurSelect->PushOrderBy( (yyvsp[0])->table_name, (yyvsp[0])->string_value, TRUE );
             delete (yyvsp[0]);
             (yyvsp[0]) = nullptr;
         }
-#line 2376 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2390 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
-  case 80:
-#line 805 "swq_parser.y" /* yacc.c:1646  */
+  case 85:
+#line 821 "swq_parser.y" /* yacc.c:1646  */
     {
             context->poCurSelect->PushOrderBy( (yyvsp[-1])->table_name, (yyvsp[-1])->string_value, TRUE );
             delete (yyvsp[-1]);
             (yyvsp[-1]) = nullptr;
         }
-#line 2386 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2400 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
-  case 81:
-#line 811 "swq_parser.y" /* yacc.c:1646  */
+  case 86:
+#line 827 "swq_parser.y" /* yacc.c:1646  */
     {
             context->poCurSelect->PushOrderBy( (yyvsp[-1])->table_name, (yyvsp[-1])->string_value, FALSE );
             delete (yyvsp[-1]);
             (yyvsp[-1]) = nullptr;
         }
-#line 2396 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2410 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
-  case 83:
-#line 819 "swq_parser.y" /* yacc.c:1646  */
+  case 88:
+#line 835 "swq_parser.y" /* yacc.c:1646  */
     {
         context->poCurSelect->SetLimit( (yyvsp[0])->int_value );
         delete (yyvsp[0]);
         (yyvsp[0]) = nullptr;
     }
-#line 2406 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2420 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
-  case 85:
-#line 827 "swq_parser.y" /* yacc.c:1646  */
+  case 90:
+#line 843 "swq_parser.y" /* yacc.c:1646  */
     {
         context->poCurSelect->SetOffset( (yyvsp[0])->int_value );
         delete (yyvsp[0]);
         (yyvsp[0]) = nullptr;
     }
-#line 2416 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2430 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
-  case 86:
-#line 835 "swq_parser.y" /* yacc.c:1646  */
+  case 91:
+#line 851 "swq_parser.y" /* yacc.c:1646  */
     {
         const int iTable =
             context->poCurSelect->PushTableDef( nullptr, (yyvsp[0])->string_value,
@@ -2425,11 +2439,11 @@ yyreduce:
 
         (yyval) = new swq_expr_node( iTable );
     }
-#line 2429 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2443 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
-  case 87:
-#line 845 "swq_parser.y" /* yacc.c:1646  */
+  case 92:
+#line 861 "swq_parser.y" /* yacc.c:1646  */
     {
         const int iTable =
             context->poCurSelect->PushTableDef( nullptr, (yyvsp[-1])->string_value,
@@ -2439,11 +2453,11 @@ yyreduce:
 
         (yyval) = new swq_expr_node( iTable );
     }
-#line 2443 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2457 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
-  case 88:
-#line 856 "swq_parser.y" /* yacc.c:1646  */
+  case 93:
+#line 872 "swq_parser.y" /* yacc.c:1646  */
     {
         const int iTable =
             context->poCurSelect->PushTableDef( (yyvsp[-2])->string_value,
@@ -2453,11 +2467,11 @@ yyreduce:
 
         (yyval) = new swq_expr_node( iTable );
     }
-#line 2457 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2471 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
-  case 89:
-#line 867 "swq_parser.y" /* yacc.c:1646  */
+  case 94:
+#line 883 "swq_parser.y" /* yacc.c:1646  */
     {
         const int iTable =
             context->poCurSelect->PushTableDef( (yyvsp[-3])->string_value,
@@ -2469,11 +2483,11 @@ yyreduce:
 
         (yyval) = new swq_expr_node( iTable );
     }
-#line 2473 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2487 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
-  case 90:
-#line 880 "swq_parser.y" /* yacc.c:1646  */
+  case 95:
+#line 896 "swq_parser.y" /* yacc.c:1646  */
     {
         const int iTable =
             context->poCurSelect->PushTableDef( (yyvsp[-2])->string_value,
@@ -2483,11 +2497,11 @@ yyreduce:
 
         (yyval) = new swq_expr_node( iTable );
     }
-#line 2487 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2501 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
-  case 91:
-#line 891 "swq_parser.y" /* yacc.c:1646  */
+  case 96:
+#line 907 "swq_parser.y" /* yacc.c:1646  */
     {
         const int iTable =
             context->poCurSelect->PushTableDef( (yyvsp[-3])->string_value,
@@ -2499,11 +2513,11 @@ yyreduce:
 
         (yyval) = new swq_expr_node( iTable );
     }
-#line 2503 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2517 "swq_parser.cpp" /* yacc.c:1646  */
     break;
 
 
-#line 2507 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2521 "swq_parser.cpp" /* yacc.c:1646  */
       default: break;
     }
   /* User semantic actions sometimes alter yychar, and that requires
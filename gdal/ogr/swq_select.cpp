@@ -58,6 +58,8 @@ swq_select::swq_select() :
     join_count(0),
     join_defs(nullptr),
     where_expr(nullptr),
+    group_specs(0),
+    group_defs(nullptr),
     order_specs(0),
     order_defs(nullptr),
     limit(-1),
@@ -96,6 +98,14 @@ swq_select::~swq_select()
 
     CPLFree( column_defs );
 
+    for( int i = 0; i < group_specs; i++ )
+    {
+        CPLFree( group_defs[i].table_name );
+        CPLFree( group_defs[i].field_name );
+    }
+
+    CPLFree( group_defs );
+
     for( int i = 0; i < order_specs; i++ )
     {
         CPLFree( order_defs[i].table_name );
@@ -285,6 +295,18 @@ void swq_select::Dump( FILE *fp )
         where_expr->Dump( fp, 2 );
     }
 
+/* -------------------------------------------------------------------- */
+/*      Group by                                                        */
+/* -------------------------------------------------------------------- */
+
+    for( int i = 0; i < group_specs; i++ )
+    {
+        fprintf( fp, "  GROUP BY: %s (%d/%d)\n",
+                 group_defs[i].field_name,
+                 group_defs[i].table_index,
+                 group_defs[i].field_index );
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Order by                                                        */
 /* -------------------------------------------------------------------- */
@@ -412,6 +434,19 @@ char* swq_select::Unparse()
         CPLFree(pszTmp);
     }
 
+    for( int i = 0; i < group_specs; i++ )
+    {
+        osSelect += i == 0 ? " GROUP BY " : ", ";
+        if( group_defs[i].table_name[0] != '\0' )
+        {
+            osSelect += swq_expr_node::QuoteIfNecessary(
+                group_defs[i].table_name, '"');
+            osSelect += ".";
+        }
+        osSelect +=
+            swq_expr_node::QuoteIfNecessary(group_defs[i].field_name, '"');
+    }
+
     for( int i = 0; i < order_specs; i++ )
     {
         osSelect += " ORDER BY ";
@@ -740,6 +775,25 @@ int swq_select::PushTableDef( const char *pszDataSource,
     return table_count-1;
 }
 
+/************************************************************************/
+/*                            PushGroupBy()                             */
+/************************************************************************/
+
+void swq_select::PushGroupBy( const char* pszTableName,
+                              const char *pszFieldName )
+
+{
+    group_specs++;
+    group_defs = static_cast<swq_group_def *>(
+        CPLRealloc(group_defs, sizeof(swq_group_def) * group_specs));
+
+    group_defs[group_specs-1].table_name =
+        CPLStrdup(pszTableName ? pszTableName : "");
+    group_defs[group_specs-1].field_name = CPLStrdup(pszFieldName);
+    group_defs[group_specs-1].table_index = -1;
+    group_defs[group_specs-1].field_index = -1;
+}
+
 /************************************************************************/
 /*                            PushOrderBy()                             */
 /************************************************************************/
@@ -805,6 +859,120 @@ void swq_select::SetOffset( GIntBig nOffset )
     offset = nOffset;
 }
 
+/************************************************************************/
+/*                           find_group_def()                           */
+/*                                                                      */
+/*      Return the index of the GROUP BY key matching a field, or -1.   */
+/************************************************************************/
+
+int swq_select::find_group_def( int table_index, int field_index ) const
+
+{
+    for( int i = 0; i < group_specs; i++ )
+    {
+        if( group_defs[i].table_index == table_index &&
+            group_defs[i].field_index == field_index )
+            return i;
+    }
+    return -1;
+}
+
+/************************************************************************/
+/*                           parse_group_by()                           */
+/*                                                                      */
+/*      Identify the GROUP BY fields, check that each result column     */
+/*      is either one of them or an aggregate of the main table, and    */
+/*      switch to SWQM_GROUP_BY mode.                                   */
+/************************************************************************/
+
+CPLErr swq_select::parse_group_by( swq_field_list *field_list )
+
+{
+    if( query_mode == SWQM_DISTINCT_LIST )
+    {
+        CPLError( CE_Failure, CPLE_NotSupported,
+                  "SELECT DISTINCT not supported with GROUP BY." );
+        return CE_Failure;
+    }
+
+    for( int i = 0; i < group_specs; i++ )
+    {
+        swq_group_def *def = group_defs + i;
+
+        swq_field_type field_type;
+        def->field_index = swq_identify_field(def->table_name,
+                                              def->field_name, field_list,
+                                              &field_type, &(def->table_index));
+        if( def->field_index == -1 )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "Unrecognized field name %s in GROUP BY.",
+                      def->table_name[0] ?
+                      CPLSPrintf("%s.%s", def->table_name, def->field_name)
+                      : def->field_name );
+            return CE_Failure;
+        }
+
+        if( def->table_index != 0 )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "Cannot use field '%s' of a secondary table in "
+                     "a GROUP BY clause",
+                     def->field_name );
+            return CE_Failure;
+        }
+
+        if( field_type == SWQ_GEOMETRY )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "Cannot use geometry field '%s' in a GROUP BY clause",
+                      def->field_name );
+            return CE_Failure;
+        }
+    }
+
+    for( int i = 0; i < result_columns; i++ )
+    {
+        swq_col_def *def = column_defs + i;
+
+        if( def->col_func == SWQCF_MIN
+            || def->col_func == SWQCF_MAX
+            || def->col_func == SWQCF_AVG
+            || def->col_func == SWQCF_SUM
+            || def->col_func == SWQCF_COUNT )
+        {
+            if( def->distinct_flag )
+            {
+                CPLError( CE_Failure, CPLE_NotSupported,
+                          "COUNT(DISTINCT) not supported with GROUP BY." );
+                return CE_Failure;
+            }
+            if( def->field_index >= 0 && def->table_index != 0 )
+            {
+                CPLError( CE_Failure, CPLE_AppDefined,
+                          "Cannot use field '%s' of a secondary table in "
+                          "an aggregate of a GROUP BY query",
+                          def->field_name );
+                return CE_Failure;
+            }
+        }
+        else if( def->col_func != SWQCF_NONE ||
+                 def->field_index < 0 ||
+                 find_group_def( def->table_index, def->field_index ) < 0 )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "Column '%s' must appear in the GROUP BY clause or "
+                      "be used in an aggregate function",
+                      def->field_alias ? def->field_alias : def->field_name );
+            return CE_Failure;
+        }
+    }
+
+    query_mode = SWQM_GROUP_BY;
+
+    return CE_None;
+}
+
 /************************************************************************/
 /*                          expand_wildcard()                           */
 /*                                                                      */
@@ -1122,6 +1290,13 @@ CPLErr swq_select::parse( swq_field_list *field_list,
 /*      indications.                                                    */
 /* -------------------------------------------------------------------- */
 
+    if( group_specs > 0 )
+    {
+        eError = parse_group_by( field_list );
+        if( eError != CE_None )
+            return eError;
+    }
+
     int bAllowDistinctOnMultipleFields = (
         poParseOptions && poParseOptions->bAllowDistinctOnMultipleFields );
     if( query_mode == SWQM_DISTINCT_LIST && result_columns > 1 &&
@@ -1132,7 +1307,7 @@ CPLErr swq_select::parse( swq_field_list *field_list,
             return CE_Failure;
     }
 
-    for( int i = 0; i < result_columns; i++ )
+    for( int i = 0; query_mode != SWQM_GROUP_BY && i < result_columns; i++ )
     {
         swq_col_def *def = column_defs + i;
         int this_indicator = -1;
@@ -1248,6 +1423,17 @@ CPLErr swq_select::parse( swq_field_list *field_list,
                       def->field_name );
             return CE_Failure;
         }
+
+        // Groups are sorted on their key, so only grouped fields can be used.
+        if( query_mode == SWQM_GROUP_BY &&
+            find_group_def( def->table_index, def->field_index ) < 0 )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "Field '%s' must appear in the GROUP BY clause to be "
+                      "used in the ORDER BY clause",
+                      def->field_name );
+            return CE_Failure;
+        }
     }
 
 /* -------------------------------------------------------------------- */
@@ -35,11 +35,14 @@ CPL_CVSID("$Id$")
 //! @cond Doxygen_Suppress
 
 #define CPUID_SSSE3_ECX_BIT     9
+#define CPUID_FMA_ECX_BIT       12
 #define CPUID_OSXSAVE_ECX_BIT   27
 #define CPUID_AVX_ECX_BIT       28
 
 #define CPUID_SSE_EDX_BIT       25
 
+#define CPUID_AVX2_EBX_BIT      5
+
 #define BIT_XMM_STATE           (1 << 1)
 #define BIT_YMM_STATE           (2 << 1)
 
@@ -67,10 +70,30 @@ CPL_CVSID("$Id$")
 
 #define CPL_CPUID(level, array) GCC_CPUID(level, array[0], array[1], array[2], array[3])
 
+#if defined(__x86_64)
+#define GCC_CPUID_COUNT(level, count, a, b, c, d)   \
+  __asm__ ("xchgq %%rbx, %q1\n"                     \
+           "cpuid\n"                                \
+           "xchgq %%rbx, %q1"                       \
+       : "=a" (a), "=r" (b), "=c" (c), "=d" (d)     \
+       : "0" (level), "2" (count))
+#else
+#define GCC_CPUID_COUNT(level, count, a, b, c, d)   \
+  __asm__ ("xchgl %%ebx, %1\n"                      \
+           "cpuid\n"                                \
+           "xchgl %%ebx, %1"                        \
+       : "=a" (a), "=r" (b), "=c" (c), "=d" (d)     \
+       : "0" (level), "2" (count))
+#endif
+
+#define CPL_CPUID_COUNT(level, count, array) \
+    GCC_CPUID_COUNT(level, count, array[0], array[1], array[2], array[3])
+
 #elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
 
 #include <intrin.h>
 #define CPL_CPUID(level, array) __cpuid(array, level)
+#define CPL_CPUID_COUNT(level, count, array) __cpuidex(array, level, count)
 
 #endif
 
@@ -188,4 +211,54 @@ bool CPLHaveRuntimeAVX()
 
 #endif // defined(HAVE_AVX_AT_COMPILE_TIME) && !defined(CPLHaveRuntimeAVX)
 
+#if defined(HAVE_AVX2_AT_COMPILE_TIME) && !defined(HAVE_INLINE_AVX2)
+
+/************************************************************************/
+/*                      CPLHaveRuntimeAVX2Uncached()                    */
+/************************************************************************/
+
+static bool CPLHaveRuntimeAVX2Uncached()
+{
+#ifdef HAVE_AVX_AT_COMPILE_TIME
+    // AVX2 requires the OS to save the YMM state, exactly as AVX.
+    if( !CPLHaveRuntimeAVX() )
+        return false;
+
+    int cpuinfo[4] = { 0, 0, 0, 0 };
+
+    // The AVX2 code paths are also compiled with FMA.
+    CPL_CPUID(1, cpuinfo);
+    if( (cpuinfo[REG_ECX] & (1 << CPUID_FMA_ECX_BIT)) == 0 )
+        return false;
+
+    CPL_CPUID(0, cpuinfo);
+    if( cpuinfo[REG_EAX] < 7 )
+        return false;
+
+    // Extended features are reported by leaf 7, sub-leaf 0.
+    CPL_CPUID_COUNT(7, 0, cpuinfo);
+    return (cpuinfo[REG_EBX] & (1 << CPUID_AVX2_EBX_BIT)) != 0;
+#else
+    return false;
+#endif
+}
+
+/************************************************************************/
+/*                         CPLHaveRuntimeAVX2()                         */
+/************************************************************************/
+
+// The result is cached since, contrary to the other checks, this one is
+// issued from GDALCopyWords(), which is a hot path.
+bool CPLHaveRuntimeAVX2()
+{
+#ifdef DEBUG
+    if( !CPLTestBool(CPLGetConfigOption("GDAL_USE_AVX2", "YES")) )
+        return false;
+#endif
+    static const bool bHasAVX2 = CPLHaveRuntimeAVX2Uncached();
+    return bHasAVX2;
+}
+
+#endif // defined(HAVE_AVX2_AT_COMPILE_TIME) && !defined(HAVE_INLINE_AVX2)
+
 //! @endcond
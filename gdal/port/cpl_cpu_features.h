@@ -68,6 +68,24 @@ bool CPLHaveRuntimeAVX();
 #endif
 #endif
 
+// The AVX2 code paths are compiled with FMA too, which is thus checked
+// together with AVX2.
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+#if defined(__AVX2__) && defined(__FMA__)
+#define HAVE_INLINE_AVX2
+static bool inline CPLHaveRuntimeAVX2()
+{
+#ifdef DEBUG
+    if( !CPLTestBool(CPLGetConfigOption("GDAL_USE_AVX2", "YES")) )
+        return false;
+#endif
+    return true;
+}
+#else
+bool CPLHaveRuntimeAVX2();
+#endif
+#endif
+
 //! @endcond
 
 #endif // CPL_CPU_FEATURES_H
@@ -214,6 +214,9 @@ class CPL_DLL CPLLockHolder
 #define CTLS_CONFIGOPTIONS              14         /* cpl_conv.cpp */
 #define CTLS_FINDFILE                   15         /* cpl_findfile.cpp */
 #define CTLS_VSIERRORCONTEXT            16         /* cpl_vsi_error.cpp */
+#define CTLS_RASTERIO_RESAMPLED_BUFFERS 17         /* rasterio.cpp */
+#define CTLS_GDAL_GLOBAL_THREAD_POOL    18         /* gdal_thread_pool.cpp */
+#define CTLS_GDAL_THREAD_SAFE_DATASETS  19         /* gdalthreadsafedataset.cpp */
 
 #define CTLS_MAX                        32
 
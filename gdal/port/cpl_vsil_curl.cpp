@@ -30,6 +30,7 @@
 #include "cpl_vsil_curl_priv.h"
 
 #include <algorithm>
+#include <atomic>
 #include <set>
 #include <map>
 
@@ -42,6 +43,7 @@
 #include "cpl_json.h"
 #include "cpl_minixml.h"
 #include "cpl_multiproc.h"
+#include "cpl_sha256.h"
 #include "cpl_string.h"
 #include "cpl_time.h"
 #include "cpl_vsi.h"
@@ -87,6 +89,12 @@ void VSICurlClearCache( void )
     // Not supported.
 }
 
+char **VSICurlGetFileStatistics( const char* /* pszFilename */ )
+{
+    // Not supported.
+    return nullptr;
+}
+
 /************************************************************************/
 /*                      VSICurlInstallReadCbk()                         */
 /************************************************************************/
@@ -123,6 +131,11 @@ struct curl_slist* VSICurlMergeHeaders( struct curl_slist* poDest,
                                         struct curl_slist* poSrcToDestroy );
 
 #include <map>
+#include <vector>
+
+#ifndef WIN32
+#include <utime.h>
+#endif
 
 #define ENABLE_DEBUG 1
 
@@ -151,6 +164,7 @@ class CachedFileProp
     bool            bS3LikeRedirect;
     time_t          nExpireTimestampLocal;
     CPLString       osRedirectURL;
+    CPLString       osETag;
 
                     CachedFileProp() :
                         eExists(EXIST_UNKNOWN),
@@ -200,9 +214,39 @@ typedef struct
     bool                bInterrupted;
 } WriteFuncStruct;
 
-static const char* VSICurlGetCacheFileName()
+static const char VSICURL_CACHE_DIR_MAGIC[] = "GDALVCC1";
+// File of the cache directory holding its approximate size, in bytes.
+static const char VSICURL_CACHE_DIR_SIZE_FILE[] = "cache_size.txt";
+
+/************************************************************************/
+/*                          VSICurlGetETag()                            */
+/************************************************************************/
+
+// Returns the value of the last ETag header of pszHeaders (there might be
+// several responses in case of redirections), or an empty string.
+static CPLString VSICurlGetETag( const char* pszHeaders )
 {
-    return "gdal_vsicurl_cache.bin";
+    CPLString osETag;
+    if( pszHeaders == nullptr )
+        return osETag;
+    for( const char* pszIter = pszHeaders; *pszIter != '\0'; )
+    {
+        if( STARTS_WITH_CI(pszIter, "ETag:") )
+        {
+            const char* pszValue = pszIter + strlen("ETag:");
+            while( *pszValue == ' ' )
+                pszValue++;
+            const char* pszEnd = pszValue;
+            while( *pszEnd != '\0' && *pszEnd != '\r' && *pszEnd != '\n' )
+                pszEnd++;
+            osETag.assign(pszValue, pszEnd - pszValue);
+        }
+        const char* pszEOL = strchr(pszIter, '\n');
+        if( pszEOL == nullptr )
+            break;
+        pszIter = pszEOL + 1;
+    }
+    return osETag;
 }
 
 /************************************************************************/
@@ -294,11 +338,45 @@ class VSICurlFilesystemHandler : public VSIFilesystemHandler
     std::map<CPLString, CachedFileProp*>   cacheFileSize;
     std::map<CPLString, CachedDirList*>        cacheDirList;
 
-    bool            bUseCacheDisk;
+    // Persistent cache of downloaded chunks, shared by all processes using
+    // the same directory. Empty if disabled.
+    CPLString       m_osCacheDir;
+    GIntBig         m_nCacheDirMaxSize;
+    // Protects the members below. Distinct from hMutex so that the disk
+    // I/O of the cache directory never blocks the in-memory cache.
+    CPLMutex       *m_hCacheDirMutex;
+    // Bytes written by this process not yet added to the size file.
+    GIntBig         m_nCacheDirPendingBytes;
+    bool            m_bCacheDirTrimInProgress;
+
+    bool            GetCacheDirKey( const char* pszURL,
+                                    vsi_l_offset nFileOffsetStart,
+                                    CPLString& osKey,
+                                    CPLString& osCacheFilename );
+    void            InitCacheDir();
+    void            UpdateCacheDirSize( GIntBig nAddedBytes, bool bForce );
+    GIntBig         ReadCacheDirSize();
+    void            WriteCacheDirSize( GIntBig nSize );
+    GIntBig         TrimCacheDir();
+    CachedRegion*   AddRegionToMemoryCache( const char* pszURL,
+                                            vsi_l_offset nFileOffsetStart,
+                                            size_t nSize,
+                                            const char *pData );
 
     // Per-thread Curl connection cache.
     std::map<GIntBig, CachedConnection*> mapConnections;
 
+    // Statistics of the closed handles, by filename.
+    struct FileStatistics
+    {
+        GUIntBig    nCacheHits;
+        GUIntBig    nCacheMisses;
+        GUIntBig    nReadAheadCount;
+        GUIntBig    nBytesDownloaded;
+        GUIntBig    nBytesReadAhead;
+    };
+    std::map<CPLString, FileStatistics> m_oMapFileStatistics;
+
     char**              ParseHTMLFileList(const char* pszFilename,
                                           int nMaxFiles,
                                           char* pszData,
@@ -380,12 +458,24 @@ public:
     CachedFileProp*     GetCachedFileProp( const char* pszURL );
     void                InvalidateCachedData( const char* pszURL );
 
-    void                AddRegionToCacheDisk( CachedRegion* psRegion );
+    bool                IsCacheDirEnabled() const
+                                        { return !m_osCacheDir.empty(); }
+    void                AddRegionToCacheDisk( const char* pszURL,
+                                              vsi_l_offset nFileOffsetStart,
+                                              size_t nSize,
+                                              const char *pData );
     const CachedRegion* GetRegionFromCacheDisk( const char* pszURL,
                                                 vsi_l_offset nFileOffsetStart );
 
     CURLM              *GetCurlMultiHandleFor( const CPLString& osURL );
 
+    void                AddFileStatistics( const CPLString& osFilename,
+                                           int nCacheHits, int nCacheMisses,
+                                           int nReadAheadCount,
+                                           GUIntBig nBytesDownloaded,
+                                           GUIntBig nBytesReadAhead );
+    char              **GetFileStatistics( const char* pszFilename );
+
     virtual void        ClearCache();
 
     bool ExistsInCacheDirList( const CPLString& osDirname, bool *pbIsDir )
@@ -431,10 +521,45 @@ class VSICurlHandle : public VSIVirtualHandle
 
     vsi_l_offset    lastDownloadedOffset;
     int             nBlocksToDownload;
+    int             m_nMaxBlocksToDownload;
     bool            bEOF;
 
     bool            DownloadRegion(vsi_l_offset startOffset, int nBlocks);
 
+    // Background download of the window that follows the last downloaded
+    // one, when the file is read sequentially. The thread is created for
+    // the first read ahead, and waits on m_hReadAheadCond for the next ones.
+    bool                m_bReadAhead;
+    CPLJoinableThread  *m_hReadAheadThread;
+    CPLMutex           *m_hReadAheadMutex;
+    CPLCond            *m_hReadAheadCond;
+    // Protected by m_hReadAheadMutex: a read ahead was requested and is not
+    // finished yet, and the thread must exit.
+    bool                m_bReadAheadPending;
+    bool                m_bStopReadAheadThread;
+    CURLM              *m_hReadAheadCurlMultiHandle;
+    char              **m_papszReadAheadConfigOptions;
+    // Set from a request of a read ahead until FinishReadAhead().
+    bool                m_bInReadAheadThread;
+    std::atomic<bool>   m_bAbortReadAhead;
+    vsi_l_offset        m_nReadAheadOffset;
+    int                 m_nReadAheadBlocks;
+    bool                m_bReadAheadSuccess;
+    char               *m_pReadAheadData;
+    size_t              m_nReadAheadDataSize;
+
+    void            StartReadAhead();
+    void            FinishReadAhead( bool bAbort );
+    bool            SleepBeforeRetry( double dfDelay );
+
+    // Statistics, reported when closing the handle, and then available
+    // through VSICurlGetFileStatistics().
+    int             m_nCacheHits;
+    int             m_nCacheMisses;
+    int             m_nReadAheadCount;
+    GUIntBig        m_nBytesDownloaded;
+    GUIntBig        m_nBytesReadAhead;
+
     VSICurlReadCbkFunc  pfnReadCbk;
     void               *pReadCbkUserData;
     bool                bStopOnInterruptUntilUninstall;
@@ -451,6 +576,12 @@ class VSICurlHandle : public VSIVirtualHandle
     int          ReadMultiRangeSingleGet( int nRanges, void ** ppData,
                                          const vsi_l_offset* panOffsets,
                                          const size_t* panSizes );
+    int          ReadMultiRangeThroughCacheDir( int nRanges, void ** ppData,
+                                         const vsi_l_offset* panOffsets,
+                                         const size_t* panSizes );
+    int          ReadMultiRangeDirect( int nRanges, void ** ppData,
+                                       const vsi_l_offset* panOffsets,
+                                       const size_t* panSizes );
     CPLString    GetRedirectURLIfValid(CachedFileProp* cachedFileProp,
                                                bool& bHasExpired);
 
@@ -496,6 +627,8 @@ class VSICurlHandle : public VSIVirtualHandle
     int                  UninstallReadCbk();
 
     const char          *GetURL() const { return m_pszURL; }
+
+    void                 ReadAheadInThread();
 };
 
 
@@ -627,7 +760,29 @@ VSICurlHandle::VSICurlHandle( VSICurlFilesystemHandler* poFSIn,
     curOffset(0),
     lastDownloadedOffset(VSI_L_OFFSET_MAX),
     nBlocksToDownload(1),
+    m_nMaxBlocksToDownload(100),
     bEOF(false),
+    m_bReadAhead(CPLTestBool(CPLGetConfigOption("CPL_VSIL_CURL_READ_AHEAD",
+                                                "NO"))),
+    m_hReadAheadThread(nullptr),
+    m_hReadAheadMutex(nullptr),
+    m_hReadAheadCond(nullptr),
+    m_bReadAheadPending(false),
+    m_bStopReadAheadThread(false),
+    m_hReadAheadCurlMultiHandle(nullptr),
+    m_papszReadAheadConfigOptions(nullptr),
+    m_bInReadAheadThread(false),
+    m_bAbortReadAhead(false),
+    m_nReadAheadOffset(0),
+    m_nReadAheadBlocks(0),
+    m_bReadAheadSuccess(false),
+    m_pReadAheadData(nullptr),
+    m_nReadAheadDataSize(0),
+    m_nCacheHits(0),
+    m_nCacheMisses(0),
+    m_nReadAheadCount(0),
+    m_nBytesDownloaded(0),
+    m_nBytesReadAhead(0),
     pfnReadCbk(nullptr),
     pReadCbkUserData(nullptr),
     bStopOnInterruptUntilUninstall(false),
@@ -643,6 +798,21 @@ VSICurlHandle::VSICurlHandle( VSICurlFilesystemHandler* poFSIn,
 {
     m_osFilename = pszFilename;
     m_papszHTTPOptions = CPLHTTPGetOptionsFromEnv();
+
+    // Maximum size of the windows downloaded when reading sequentially,
+    // limited to half of the memory cache so that the window being read and
+    // the one being read ahead fit together in it.
+    const GIntBig nMaxReadAheadSize = CPLAtoGIntBig(
+        CPLGetConfigOption("CPL_VSIL_CURL_READ_AHEAD_MAX_SIZE", "4194304"));
+    if( nMaxReadAheadSize >= DOWNLOAD_CHUNK_SIZE )
+    {
+        m_nMaxBlocksToDownload = static_cast<int>(
+            std::min(nMaxReadAheadSize / DOWNLOAD_CHUNK_SIZE,
+                     static_cast<GIntBig>(INT_MAX / 2)));
+    }
+    m_nMaxBlocksToDownload = std::max(1,
+        std::min(m_nMaxBlocksToDownload, N_MAX_REGIONS / 2));
+
     if( pszURLIn )
     {
         m_pszURL = CPLStrdup(pszURLIn);
@@ -672,6 +842,22 @@ VSICurlHandle::VSICurlHandle( VSICurlFilesystemHandler* poFSIn,
 
 VSICurlHandle::~VSICurlHandle()
 {
+    FinishReadAhead(true);
+    if( m_hReadAheadThread != nullptr )
+    {
+        CPLAcquireMutex(m_hReadAheadMutex, 1000.0);
+        m_bStopReadAheadThread = true;
+        CPLCondBroadcast(m_hReadAheadCond);
+        CPLReleaseMutex(m_hReadAheadMutex);
+        CPLJoinThread(m_hReadAheadThread);
+    }
+    if( m_hReadAheadCond )
+        CPLDestroyCond(m_hReadAheadCond);
+    if( m_hReadAheadMutex )
+        CPLDestroyMutex(m_hReadAheadMutex);
+    if( m_hReadAheadCurlMultiHandle )
+        curl_multi_cleanup(m_hReadAheadCurlMultiHandle);
+
     if( !m_bCached )
     {
         poFS->InvalidateCachedData(m_pszURL);
@@ -1140,6 +1326,16 @@ retry:
     long mtime = 0;
     curl_easy_getinfo(hCurlHandle, CURLINFO_FILETIME, &mtime);
 
+    if( poFS->IsCacheDirEnabled() )
+    {
+        // Record the validators of the persistent cache now, as the first
+        // bytes of the file might be added to the cache below.
+        CachedFileProp* cachedFileProp = poFS->GetCachedFileProp(m_pszURL);
+        cachedFileProp->osETag = VSICurlGetETag(sWriteFuncHeaderData.pBuffer);
+        if( mtime > 0 )
+            cachedFileProp->mTime = mtime;
+    }
+
     if( STARTS_WITH(osURL, "ftp") )
     {
         if( sWriteFuncData.pBuffer != nullptr )
@@ -1467,6 +1663,39 @@ CPLString VSICurlHandle::GetRedirectURLIfValid(CachedFileProp* cachedFileProp,
     return osURL;
 }
 
+/************************************************************************/
+/*                        VSICurlReadAheadCbk()                         */
+/************************************************************************/
+
+static int VSICurlReadAheadCbk( VSILFILE* /* fp */, void * /* pabyBuffer */,
+                                size_t /* nBufferSize */, void* pUserData )
+{
+    return !*static_cast<std::atomic<bool>*>(pUserData);
+}
+
+/************************************************************************/
+/*                          SleepBeforeRetry()                          */
+/************************************************************************/
+
+// Waits before retrying a request. In the read ahead thread, the wait is
+// interrupted when the read ahead is aborted, and false is then returned.
+bool VSICurlHandle::SleepBeforeRetry( double dfDelay )
+{
+    if( !m_bInReadAheadThread )
+    {
+        CPLSleep(dfDelay);
+        return true;
+    }
+
+    const double dfStep = 0.05;
+    while( dfDelay > 0 && !m_bAbortReadAhead )
+    {
+        CPLSleep(std::min(dfDelay, dfStep));
+        dfDelay -= dfStep;
+    }
+    return !m_bAbortReadAhead;
+}
+
 /************************************************************************/
 /*                          DownloadRegion()                            */
 /************************************************************************/
@@ -1481,7 +1710,10 @@ bool VSICurlHandle::DownloadRegion( const vsi_l_offset startOffset,
     if( cachedFileProp->eExists == EXIST_NO )
         return false;
 
-    CURLM* hCurlMultiHandle = poFS->GetCurlMultiHandleFor(m_pszURL);
+    // The multi handles of the filesystem are per-thread, so the read ahead
+    // thread uses its own.
+    CURLM* hCurlMultiHandle = m_bInReadAheadThread ?
+        m_hReadAheadCurlMultiHandle : poFS->GetCurlMultiHandleFor(m_pszURL);
 
     bool bHasExpired = false;
     CPLString osURL(GetRedirectURLIfValid(cachedFileProp, bHasExpired));
@@ -1500,9 +1732,19 @@ retry:
     if( !AllowAutomaticRedirection() )
         curl_easy_setopt(hCurlHandle, CURLOPT_FOLLOWLOCATION, 0);
 
-    VSICURLInitWriteFuncStruct(&sWriteFuncData,
-                               reinterpret_cast<VSILFILE *>(this),
-                               pfnReadCbk, pReadCbkUserData);
+    if( m_bInReadAheadThread )
+    {
+        VSICURLInitWriteFuncStruct(&sWriteFuncData,
+                                   reinterpret_cast<VSILFILE *>(this),
+                                   VSICurlReadAheadCbk,
+                                   &m_bAbortReadAhead);
+    }
+    else
+    {
+        VSICURLInitWriteFuncStruct(&sWriteFuncData,
+                                   reinterpret_cast<VSILFILE *>(this),
+                                   pfnReadCbk, pReadCbkUserData);
+    }
     curl_easy_setopt(hCurlHandle, CURLOPT_WRITEDATA, &sWriteFuncData);
     curl_easy_setopt(hCurlHandle, CURLOPT_WRITEFUNCTION,
                      VSICurlHandleWriteFunc);
@@ -1559,7 +1801,9 @@ retry:
 
     if( sWriteFuncData.bInterrupted )
     {
-        bInterrupted = true;
+        // An aborted read ahead is not an interruption requested by the user.
+        if( !m_bInReadAheadThread )
+            bInterrupted = true;
 
         CPLFree(sWriteFuncData.pBuffer);
         CPLFree(sWriteFuncHeaderData.pBuffer);
@@ -1664,12 +1908,14 @@ retry:
                         "Retrying again in %.1f secs",
                         static_cast<int>(response_code), m_pszURL,
                         dfRetryDelay);
-            CPLSleep(dfRetryDelay);
+            const bool bRetry = SleepBeforeRetry(dfRetryDelay);
             dfRetryDelay = dfNewRetryDelay;
             nRetryCount++;
             CPLFree(sWriteFuncData.pBuffer);
             CPLFree(sWriteFuncHeaderData.pBuffer);
             curl_easy_cleanup(hCurlHandle);
+            if( !bRetry )
+                return false;
             goto retry;
         }
 
@@ -1775,6 +2021,21 @@ retry:
                 static_cast<unsigned int>(nBlocks * DOWNLOAD_CHUNK_SIZE));
     }
 
+    if( m_bInReadAheadThread )
+    {
+        // The memory cache is shared with the other handles, so the data
+        // is only added to it by FinishReadAhead(), in the thread of the
+        // caller.
+        m_nBytesReadAhead += nSize;
+        m_pReadAheadData = sWriteFuncData.pBuffer;
+        m_nReadAheadDataSize =
+            std::min(nSize, static_cast<size_t>(nBlocks) * DOWNLOAD_CHUNK_SIZE);
+        CPLFree(sWriteFuncHeaderData.pBuffer);
+        curl_easy_cleanup(hCurlHandle);
+        return true;
+    }
+    m_nBytesDownloaded += nSize;
+
     vsi_l_offset l_startOffset = startOffset;
     while( nSize > 0 )
     {
@@ -1820,6 +2081,23 @@ size_t VSICurlHandle::Read( void * const pBufferIn, size_t const nSize,
              static_cast<int>(curOffset), static_cast<int>(nBufferRequestSize));
 #endif
 
+    // The persistent cache needs the ETag or Last-Modified of the file,
+    // which are collected when getting its size.
+    if( poFS->IsCacheDirEnabled() && !bHasComputedFileSize )
+        GetFileSize(false);
+
+    if( m_bInReadAheadThread )
+    {
+        // Wait for the read ahead if this read continues the sequential
+        // scan, and abort it otherwise.
+        const vsi_l_offset nReadAheadSize =
+            static_cast<vsi_l_offset>(m_nReadAheadBlocks) * DOWNLOAD_CHUNK_SIZE;
+        FinishReadAhead(
+            curOffset >= m_nReadAheadOffset + nReadAheadSize ||
+            curOffset + nBufferRequestSize + nReadAheadSize <=
+                                                        m_nReadAheadOffset);
+    }
+
     vsi_l_offset iterOffset = curOffset;
     while( nBufferRequestSize )
     {
@@ -1837,8 +2115,12 @@ size_t VSICurlHandle::Read( void * const pBufferIn, size_t const nSize,
         }
 
         const CachedRegion* psRegion = poFS->GetRegion(m_pszURL, iterOffset);
-        if( psRegion == nullptr )
+        if( psRegion != nullptr )
+            m_nCacheHits++;
+        else
         {
+            m_nCacheMisses++;
+
             const vsi_l_offset nOffsetToDownload =
                 (iterOffset / DOWNLOAD_CHUNK_SIZE) * DOWNLOAD_CHUNK_SIZE;
 
@@ -1848,8 +2130,11 @@ size_t VSICurlHandle::Read( void * const pBufferIn, size_t const nSize,
                 // heuristic that we will read the file sequentially, so
                 // we double the requested size to decrease the number of
                 // client/server roundtrips.
-                if( nBlocksToDownload < 100 )
-                    nBlocksToDownload *= 2;
+                if( nBlocksToDownload < m_nMaxBlocksToDownload )
+                {
+                    nBlocksToDownload = std::min(nBlocksToDownload * 2,
+                                                 m_nMaxBlocksToDownload);
+                }
             }
             else
             {
@@ -1921,9 +2206,160 @@ size_t VSICurlHandle::Read( void * const pBufferIn, size_t const nSize,
 
     curOffset = iterOffset;
 
+    StartReadAhead();
+
     return ret;
 }
 
+/************************************************************************/
+/*                       VSICurlReadAheadThread()                       */
+/************************************************************************/
+
+static void VSICurlReadAheadThread( void* pArg )
+{
+    static_cast<VSICurlHandle *>(pArg)->ReadAheadInThread();
+}
+
+/************************************************************************/
+/*                         ReadAheadInThread()                          */
+/************************************************************************/
+
+// Runs the read aheads requested by StartReadAhead(), one at a time, until
+// the handle is destroyed.
+void VSICurlHandle::ReadAheadInThread()
+{
+    CPLAcquireMutex(m_hReadAheadMutex, 1000.0);
+    while( true )
+    {
+        while( !m_bReadAheadPending && !m_bStopReadAheadThread )
+            CPLCondWait(m_hReadAheadCond, m_hReadAheadMutex);
+        if( m_bStopReadAheadThread )
+            break;
+        CPLReleaseMutex(m_hReadAheadMutex);
+
+        CPLSetThreadLocalConfigOptions(m_papszReadAheadConfigOptions);
+        // Errors are not reported: the data will just be downloaded again
+        // when it is read.
+        CPLPushErrorHandler(CPLQuietErrorHandler);
+        const bool bSuccess = DownloadRegion(m_nReadAheadOffset,
+                                             m_nReadAheadBlocks);
+        CPLPopErrorHandler();
+        CPLSetThreadLocalConfigOptions(nullptr);
+
+        CPLAcquireMutex(m_hReadAheadMutex, 1000.0);
+        m_bReadAheadSuccess = bSuccess;
+        m_bReadAheadPending = false;
+        CPLCondBroadcast(m_hReadAheadCond);
+    }
+    CPLReleaseMutex(m_hReadAheadMutex);
+}
+
+/************************************************************************/
+/*                          StartReadAhead()                            */
+/************************************************************************/
+
+// Starts downloading in a background thread the window that follows the
+// last downloaded one, when the file is read sequentially (that is when
+// consecutive windows have been downloaded) and the reader has consumed
+// half of the last window. Each read ahead window is twice as large as the
+// previous one, up to CPL_VSIL_CURL_READ_AHEAD_MAX_SIZE.
+void VSICurlHandle::StartReadAhead()
+{
+    if( !m_bReadAhead || m_bInReadAheadThread ||
+        pfnReadCbk != nullptr || nBlocksToDownload < 2 ||
+        lastDownloadedOffset == VSI_L_OFFSET_MAX )
+    {
+        return;
+    }
+
+    const vsi_l_offset nWindowSize =
+        static_cast<vsi_l_offset>(nBlocksToDownload) * DOWNLOAD_CHUNK_SIZE;
+    if( curOffset + nWindowSize / 2 < lastDownloadedOffset )
+        return;
+
+    CachedFileProp* cachedFileProp = poFS->GetCachedFileProp(m_pszURL);
+    if( !cachedFileProp->bHasComputedFileSize ||
+        lastDownloadedOffset >= cachedFileProp->fileSize ||
+        poFS->GetRegion(m_pszURL, lastDownloadedOffset) != nullptr )
+    {
+        return;
+    }
+
+    if( m_hReadAheadThread == nullptr )
+    {
+        if( m_hReadAheadMutex == nullptr )
+        {
+            m_hReadAheadMutex = CPLCreateMutex();
+            CPLReleaseMutex(m_hReadAheadMutex);
+            m_hReadAheadCond = CPLCreateCond();
+        }
+        m_hReadAheadThread =
+            CPLCreateJoinableThread(VSICurlReadAheadThread, this);
+        if( m_hReadAheadThread == nullptr )
+            return;
+    }
+
+    if( m_hReadAheadCurlMultiHandle == nullptr )
+        m_hReadAheadCurlMultiHandle = curl_multi_init();
+
+    nBlocksToDownload = std::min(nBlocksToDownload * 2,
+                                 m_nMaxBlocksToDownload);
+    m_nReadAheadOffset = lastDownloadedOffset;
+    m_nReadAheadBlocks = nBlocksToDownload;
+    m_bReadAheadSuccess = false;
+    m_bAbortReadAhead = false;
+    m_papszReadAheadConfigOptions = CPLGetThreadLocalConfigOptions();
+    m_bInReadAheadThread = true;
+
+    CPLAcquireMutex(m_hReadAheadMutex, 1000.0);
+    m_bReadAheadPending = true;
+    CPLCondBroadcast(m_hReadAheadCond);
+    CPLReleaseMutex(m_hReadAheadMutex);
+
+    m_nReadAheadCount++;
+}
+
+/************************************************************************/
+/*                          FinishReadAhead()                           */
+/************************************************************************/
+
+// Waits for the read ahead, after having asked it to stop as soon as
+// possible if bAbort is set, and adds the data it got to the cache.
+void VSICurlHandle::FinishReadAhead( bool bAbort )
+{
+    if( !m_bInReadAheadThread )
+        return;
+
+    if( bAbort )
+        m_bAbortReadAhead = true;
+    CPLAcquireMutex(m_hReadAheadMutex, 1000.0);
+    while( m_bReadAheadPending )
+        CPLCondWait(m_hReadAheadCond, m_hReadAheadMutex);
+    CPLReleaseMutex(m_hReadAheadMutex);
+    m_bInReadAheadThread = false;
+    CSLDestroy(m_papszReadAheadConfigOptions);
+    m_papszReadAheadConfigOptions = nullptr;
+
+    if( m_bReadAheadSuccess )
+    {
+        vsi_l_offset nOffset = m_nReadAheadOffset;
+        const char* pData = m_pReadAheadData;
+        size_t nSize = m_nReadAheadDataSize;
+        while( nSize > 0 )
+        {
+            const size_t nChunkSize =
+                std::min(static_cast<size_t>(DOWNLOAD_CHUNK_SIZE), nSize);
+            poFS->AddRegion(m_pszURL, nOffset, nChunkSize, pData);
+            nOffset += nChunkSize;
+            pData += nChunkSize;
+            nSize -= nChunkSize;
+        }
+    }
+    CPLFree(m_pReadAheadData);
+    m_pReadAheadData = nullptr;
+    m_nReadAheadDataSize = 0;
+}
+
 /************************************************************************/
 /*                           ReadMultiRange()                           */
 /************************************************************************/
@@ -1931,6 +2367,112 @@ size_t VSICurlHandle::Read( void * const pBufferIn, size_t const nSize,
 int VSICurlHandle::ReadMultiRange( int const nRanges, void ** const ppData,
                                    const vsi_l_offset* const panOffsets,
                                    const size_t* const panSizes )
+{
+    FinishReadAhead(true);
+
+    if( poFS->IsCacheDirEnabled() )
+    {
+        return ReadMultiRangeThroughCacheDir(nRanges, ppData,
+                                             panOffsets, panSizes);
+    }
+    return ReadMultiRangeDirect(nRanges, ppData, panOffsets, panSizes);
+}
+
+/************************************************************************/
+/*                   ReadMultiRangeThroughCacheDir()                    */
+/************************************************************************/
+
+// Downloads, with a single multi-range request, the chunks covering the
+// requested ranges that are neither in the memory nor in the persistent
+// cache, and then serves the ranges from the cache.
+int VSICurlHandle::ReadMultiRangeThroughCacheDir(
+                                    int const nRanges, void ** const ppData,
+                                    const vsi_l_offset* const panOffsets,
+                                    const size_t* const panSizes )
+{
+    const vsi_l_offset nFileSize = GetFileSize(false);
+    if( bInterrupted && bStopOnInterruptUntilUninstall )
+        return FALSE;
+    if( eExists == EXIST_NO || nFileSize == 0 )
+    {
+        return VSIVirtualHandle::ReadMultiRange(
+                                    nRanges, ppData, panOffsets, panSizes);
+    }
+
+    // Collect the missing chunks, merging consecutive ones.
+    std::vector<vsi_l_offset> anMissingOffsets;
+    std::vector<size_t> anMissingSizes;
+    for( int i = 0; i < nRanges; i++ )
+    {
+        if( panSizes[i] == 0 || panOffsets[i] >= nFileSize )
+            continue;
+        const vsi_l_offset nEnd =
+            std::min(panOffsets[i] + panSizes[i], nFileSize);
+        for( vsi_l_offset nChunkOffset =
+                (panOffsets[i] / DOWNLOAD_CHUNK_SIZE) * DOWNLOAD_CHUNK_SIZE;
+             nChunkOffset < nEnd; nChunkOffset += DOWNLOAD_CHUNK_SIZE )
+        {
+            if( poFS->GetRegion(m_pszURL, nChunkOffset) != nullptr )
+                continue;
+            const size_t nChunkSize = static_cast<size_t>(
+                std::min(static_cast<vsi_l_offset>(DOWNLOAD_CHUNK_SIZE),
+                         nFileSize - nChunkOffset));
+            if( !anMissingOffsets.empty() &&
+                anMissingOffsets.back() + anMissingSizes.back() >=
+                                                            nChunkOffset )
+            {
+                if( anMissingOffsets.back() + anMissingSizes.back() <
+                                                nChunkOffset + nChunkSize )
+                {
+                    anMissingSizes.back() = static_cast<size_t>(
+                        nChunkOffset + nChunkSize - anMissingOffsets.back());
+                }
+            }
+            else
+            {
+                anMissingOffsets.push_back(nChunkOffset);
+                anMissingSizes.push_back(nChunkSize);
+            }
+        }
+    }
+
+    if( !anMissingOffsets.empty() )
+    {
+        const int nMissing = static_cast<int>(anMissingOffsets.size());
+        std::vector<void*> apBuffers(nMissing);
+        bool bOK = true;
+        for( int i = 0; i < nMissing; i++ )
+        {
+            apBuffers[i] = VSI_MALLOC_VERBOSE(anMissingSizes[i]);
+            if( apBuffers[i] == nullptr )
+                bOK = false;
+        }
+        // The downloaded chunks are added to the cache by
+        // ReadMultiRangeDirect().
+        if( bOK )
+        {
+            CPL_IGNORE_RET_VAL(ReadMultiRangeDirect(nMissing, &apBuffers[0],
+                                                    &anMissingOffsets[0],
+                                                    &anMissingSizes[0]));
+        }
+        for( int i = 0; i < nMissing; i++ )
+            VSIFree(apBuffers[i]);
+    }
+
+    // Read() takes the data from the cache, or downloads it again if the
+    // memory cache is too small to hold all of it.
+    return VSIVirtualHandle::ReadMultiRange(
+                                    nRanges, ppData, panOffsets, panSizes);
+}
+
+/************************************************************************/
+/*                        ReadMultiRangeDirect()                        */
+/************************************************************************/
+
+int VSICurlHandle::ReadMultiRangeDirect( int const nRanges,
+                                         void ** const ppData,
+                                         const vsi_l_offset* const panOffsets,
+                                         const size_t* const panSizes )
 {
     if( bInterrupted && bStopOnInterruptUntilUninstall )
         return FALSE;
@@ -1976,36 +2518,64 @@ int VSICurlHandle::ReadMultiRange( int const nRanges, void ** const ppData,
     }
 #endif
 
-    std::vector<CURL*> aHandles;
-    std::vector<WriteFuncStruct> asWriteFuncData;
-    std::vector<WriteFuncStruct> asWriteFuncHeaderData;
-    std::vector<char*> apszRanges;
-    std::vector<struct curl_slist*> aHeaders;
-
-    asWriteFuncData.resize(nRanges);
-    asWriteFuncHeaderData.resize(nRanges);
-
+    // Group the ranges, in the order of their offsets, into requests.
+    // Consecutive or overlapping ranges, as well as ranges separated by a
+    // gap small enough for the extra bytes to cost less than an
+    // additional request, are fetched with a single request.
     const bool bMergeConsecutiveRanges = CPLTestBool(CPLGetConfigOption(
         "GDAL_HTTP_MERGE_CONSECUTIVE_RANGES", "TRUE"));
+    const vsi_l_offset nMaxGap = bMergeConsecutiveRanges ?
+        static_cast<vsi_l_offset>(std::max(0, atoi(CPLGetConfigOption(
+            "GDAL_HTTP_MERGE_RANGES_MAX_GAP",
+            CPLSPrintf("%d", DOWNLOAD_CHUNK_SIZE))))) : 0;
 
-    for( int i = 0, iRequest = 0; i < nRanges; )
+    std::vector<int> anOrder;
+    for( int i = 0; i < nRanges; i++ )
     {
-        size_t nSize = 0;
-        int iNext = i;
-        // Identify consecutive ranges
-        while( bMergeConsecutiveRanges &&
-               iNext + 1 < nRanges &&
-               panOffsets[iNext] + panSizes[iNext] == panOffsets[iNext+1] )
+        if( panSizes[i] != 0 )
+            anOrder.push_back(i);
+    }
+    std::stable_sort(anOrder.begin(), anOrder.end(),
+                     [panOffsets](int a, int b)
+                     { return panOffsets[a] < panOffsets[b]; });
+
+    struct RangeRequest
+    {
+        vsi_l_offset     nStart;
+        vsi_l_offset     nEnd; // exclusive
+        std::vector<int> anRanges;
+    };
+    std::vector<RangeRequest> asRequests;
+    for( size_t i = 0; i < anOrder.size(); i++ )
+    {
+        const int iRange = anOrder[i];
+        const vsi_l_offset nEnd = panOffsets[iRange] + panSizes[iRange];
+        if( bMergeConsecutiveRanges && !asRequests.empty() &&
+            panOffsets[iRange] <= asRequests.back().nEnd + nMaxGap )
         {
-            nSize += panSizes[iNext];
-            iNext++;
+            asRequests.back().nEnd = std::max(asRequests.back().nEnd, nEnd);
         }
-        nSize += panSizes[iNext];
-        if( nSize == 0 )
-            continue;
+        else
+        {
+            RangeRequest sRequest;
+            sRequest.nStart = panOffsets[iRange];
+            sRequest.nEnd = nEnd;
+            asRequests.push_back(sRequest);
+        }
+        asRequests.back().anRanges.push_back(iRange);
+    }
 
+    const size_t nRequests = asRequests.size();
+    std::vector<CURL*> aHandles(nRequests);
+    std::vector<WriteFuncStruct> asWriteFuncData(nRequests);
+    std::vector<WriteFuncStruct> asWriteFuncHeaderData(nRequests);
+    std::vector<char*> apszRanges(nRequests);
+    std::vector<struct curl_slist*> aHeaders(nRequests);
+
+    for( size_t iRequest = 0; iRequest < nRequests; iRequest++ )
+    {
         CURL* hCurlHandle = curl_easy_init();
-        aHandles.push_back(hCurlHandle);
+        aHandles[iRequest] = hCurlHandle;
 
         // As the multi-range request is likely not the first one, we don't
         // need to wait as we already know if pipelining is possible
@@ -2029,9 +2599,10 @@ int VSICurlHandle::ReadMultiRange( int const nRanges, void ** const ppData,
         curl_easy_setopt(hCurlHandle, CURLOPT_HEADERFUNCTION,
                          VSICurlHandleWriteFunc);
         asWriteFuncHeaderData[iRequest].bIsHTTP = STARTS_WITH(m_pszURL, "http");
-        asWriteFuncHeaderData[iRequest].nStartOffset = panOffsets[i];
-
-        asWriteFuncHeaderData[iRequest].nEndOffset = panOffsets[i] + nSize-1;
+        asWriteFuncHeaderData[iRequest].nStartOffset =
+            asRequests[iRequest].nStart;
+        asWriteFuncHeaderData[iRequest].nEndOffset =
+            asRequests[iRequest].nEnd - 1;
 
         char rangeStr[512] = {};
         snprintf(rangeStr, sizeof(rangeStr),
@@ -2048,48 +2619,42 @@ int VSICurlHandle::ReadMultiRange( int const nRanges, void ** const ppData,
             osHeaderRange.Printf("Range: bytes=%s", rangeStr);
             // So it gets included in Azure signature
             char* pszRange = CPLStrdup(osHeaderRange);
-            apszRanges.push_back(pszRange);
+            apszRanges[iRequest] = pszRange;
             headers = curl_slist_append(headers, pszRange);
             curl_easy_setopt(hCurlHandle, CURLOPT_RANGE, nullptr);
         }
         else
         {
-            apszRanges.push_back(nullptr);
+            apszRanges[iRequest] = nullptr;
             curl_easy_setopt(hCurlHandle, CURLOPT_RANGE, rangeStr);
         }
 
         headers = VSICurlMergeHeaders(headers, GetCurlHeaders("GET", headers));
         curl_easy_setopt(hCurlHandle, CURLOPT_HTTPHEADER, headers);
-        aHeaders.push_back(headers);
+        aHeaders[iRequest] = headers;
         curl_multi_add_handle(hMultiHandle, hCurlHandle);
-
-        i = iNext + 1;
-        iRequest ++;
     }
 
+    // All requests are run concurrently, so the latency of the whole
+    // operation is the one of the slowest request.
     if( !aHandles.empty() )
     {
         MultiPerform(hMultiHandle);
     }
 
+    // Only add whole chunks to the cache, except the last one of the file.
+    const vsi_l_offset nKnownFileSize =
+        cachedFileProp->bHasComputedFileSize ? cachedFileProp->fileSize : 0;
+
     int nRet = 0;
-    size_t iReq = 0;
-    int iRange = 0;
-    for( ; iReq < aHandles.size(); iReq++, iRange++ )
+    for( size_t iReq = 0; iReq < nRequests; iReq++ )
     {
-        while( iRange < nRanges && panSizes[iRange] == 0 )
-        {
-            iRange ++;
-        }
-        if( iRange == nRanges )
-            break;
-
+        const vsi_l_offset nStart = asRequests[iReq].nStart;
+        const vsi_l_offset nEnd = asRequests[iReq].nEnd;
         long response_code = 0;
         curl_easy_getinfo(aHandles[iReq], CURLINFO_HTTP_CODE, &response_code);
         if( (response_code != 206 && response_code != 225) ||
-            asWriteFuncHeaderData[iReq].nEndOffset+1 !=
-                asWriteFuncHeaderData[iReq].nStartOffset +
-                    asWriteFuncData[iReq].nSize )
+            nEnd != nStart + asWriteFuncData[iReq].nSize )
         {
             char rangeStr[512] = {};
             snprintf(rangeStr, sizeof(rangeStr),
@@ -2101,39 +2666,34 @@ int VSICurlHandle::ReadMultiRange( int const nRanges, void ** const ppData,
                      "Request for %s failed", rangeStr);
             nRet = -1;
         }
-        else if( nRet == 0 )
+        else
         {
-            size_t nOffset = 0;
-            size_t nRemainingSize = asWriteFuncData[iReq].nSize;
-            CPLAssert( iRange < nRanges );
-            while( true )
+            const char* pabyBuffer = asWriteFuncData[iReq].pBuffer;
+            for( size_t j = 0; j < asRequests[iReq].anRanges.size(); j++ )
             {
-                if( nRemainingSize < panSizes[iRange] )
-                {
-                    nRet = -1;
-                    break;
-                }
-
-                if( panSizes[iRange] > 0 )
-                {
-                    memcpy( ppData[iRange],
-                            asWriteFuncData[iReq].pBuffer + nOffset,
-                            panSizes[iRange] );
-                }
+                const int iRange = asRequests[iReq].anRanges[j];
+                memcpy( ppData[iRange],
+                        pabyBuffer + (panOffsets[iRange] - nStart),
+                        panSizes[iRange] );
+            }
 
-                if( bMergeConsecutiveRanges &&
-                    iRange + 1 < nRanges &&
-                    panOffsets[iRange] + panSizes[iRange] ==
-                                                    panOffsets[iRange + 1] )
-                {
-                    nOffset += panSizes[iRange];
-                    nRemainingSize -= panSizes[iRange];
-                    iRange++;
-                }
-                else
+            // Make the data available to Read() and later opens.
+            for( vsi_l_offset nChunkOffset =
+                    ((nStart + DOWNLOAD_CHUNK_SIZE - 1) /
+                            DOWNLOAD_CHUNK_SIZE) * DOWNLOAD_CHUNK_SIZE;
+                 nChunkOffset < nEnd;
+                 nChunkOffset += DOWNLOAD_CHUNK_SIZE )
+            {
+                if( nChunkOffset + DOWNLOAD_CHUNK_SIZE > nEnd &&
+                    nEnd != nKnownFileSize )
                 {
                     break;
                 }
+                poFS->AddRegion(m_pszURL, nChunkOffset,
+                    static_cast<size_t>(std::min(
+                        static_cast<vsi_l_offset>(DOWNLOAD_CHUNK_SIZE),
+                        nEnd - nChunkOffset)),
+                    pabyBuffer + (nChunkOffset - nStart));
             }
         }
 
@@ -2567,6 +3127,30 @@ int       VSICurlHandle::Flush()
 
 int       VSICurlHandle::Close()
 {
+    FinishReadAhead(true);
+
+    if( m_nCacheHits > 0 || m_nCacheMisses > 0 )
+    {
+        if( ENABLE_DEBUG )
+        {
+            CPLDebug("VSICURL", "%s: %d cache hits, %d cache misses, "
+                     CPL_FRMT_GUIB " bytes downloaded, including "
+                     CPL_FRMT_GUIB " bytes read ahead in %d requests",
+                     m_pszURL, m_nCacheHits, m_nCacheMisses,
+                     m_nBytesDownloaded + m_nBytesReadAhead,
+                     m_nBytesReadAhead, m_nReadAheadCount);
+        }
+        poFS->AddFileStatistics(m_osFilename, m_nCacheHits, m_nCacheMisses,
+                                m_nReadAheadCount,
+                                m_nBytesDownloaded + m_nBytesReadAhead,
+                                m_nBytesReadAhead);
+        m_nCacheHits = 0;
+        m_nCacheMisses = 0;
+        m_nReadAheadCount = 0;
+        m_nBytesDownloaded = 0;
+        m_nBytesReadAhead = 0;
+    }
+
     return 0;
 }
 
@@ -2579,8 +3163,44 @@ VSICurlFilesystemHandler::VSICurlFilesystemHandler()
     hMutex = nullptr;
     papsRegions = nullptr;
     nRegions = 0;
-    bUseCacheDisk =
-        CPLTestBool(CPLGetConfigOption("CPL_VSIL_CURL_USE_CACHE", "NO"));
+    m_hCacheDirMutex = nullptr;
+    m_nCacheDirPendingBytes = 0;
+    m_bCacheDirTrimInProgress = false;
+    InitCacheDir();
+}
+
+/************************************************************************/
+/*                            InitCacheDir()                            */
+/************************************************************************/
+
+// Reads the configuration options of the persistent cache. Done again by
+// ClearCache(), so that they can be changed afterwards.
+void VSICurlFilesystemHandler::InitCacheDir()
+{
+    m_osCacheDir = CPLGetConfigOption("CPL_VSIL_CURL_CACHE_DIR", "");
+    // CPL_VSIL_CURL_USE_CACHE=YES was the former way of enabling a cache
+    // on disk, in the current directory.
+    if( m_osCacheDir.empty() &&
+        CPLTestBool(CPLGetConfigOption("CPL_VSIL_CURL_USE_CACHE", "NO")) )
+    {
+        m_osCacheDir = "gdal_vsicurl_cache";
+    }
+    m_nCacheDirMaxSize = CPLAtoGIntBig(
+        CPLGetConfigOption("CPL_VSIL_CURL_CACHE_DIR_SIZE", "1073741824"));
+    m_nCacheDirPendingBytes = 0;
+    if( !m_osCacheDir.empty() )
+    {
+        VSIStatBufL sStat;
+        if( VSIStatL(m_osCacheDir, &sStat) != 0 &&
+            VSIMkdir(m_osCacheDir, 0755) != 0 &&
+            VSIStatL(m_osCacheDir, &sStat) != 0 )
+        {
+            CPLError(CE_Warning, CPLE_FileIO,
+                     "Cannot create %s. Persistent /vsicurl/ cache disabled",
+                     m_osCacheDir.c_str());
+            m_osCacheDir.clear();
+        }
+    }
 }
 
 /************************************************************************/
@@ -2594,6 +3214,9 @@ VSICurlFilesystemHandler::~VSICurlFilesystemHandler()
     if( hMutex != nullptr )
         CPLDestroyMutex( hMutex );
     hMutex = nullptr;
+    if( m_hCacheDirMutex != nullptr )
+        CPLDestroyMutex( m_hCacheDirMutex );
+    m_hCacheDirMutex = nullptr;
 }
 
 /************************************************************************/
@@ -2639,6 +3262,107 @@ CURLM* VSICurlFilesystemHandler::GetCurlMultiHandleFor(const CPLString& /*osURL*
     return iterConnections->second->hCurlMultiHandle;
 }
 
+/************************************************************************/
+/*                         AddFileStatistics()                          */
+/************************************************************************/
+
+void VSICurlFilesystemHandler::AddFileStatistics( const CPLString& osFilename,
+                                                  int nCacheHits,
+                                                  int nCacheMisses,
+                                                  int nReadAheadCount,
+                                                  GUIntBig nBytesDownloaded,
+                                                  GUIntBig nBytesReadAhead )
+{
+    CPLMutexHolder oHolder( &hMutex );
+
+    std::map<CPLString, FileStatistics>::iterator oIter =
+        m_oMapFileStatistics.find(osFilename);
+    if( oIter == m_oMapFileStatistics.end() )
+    {
+        FileStatistics sStats;
+        memset(&sStats, 0, sizeof(sStats));
+        oIter = m_oMapFileStatistics.insert(
+            std::pair<CPLString, FileStatistics>(osFilename, sStats)).first;
+    }
+    oIter->second.nCacheHits += nCacheHits;
+    oIter->second.nCacheMisses += nCacheMisses;
+    oIter->second.nReadAheadCount += nReadAheadCount;
+    oIter->second.nBytesDownloaded += nBytesDownloaded;
+    oIter->second.nBytesReadAhead += nBytesReadAhead;
+}
+
+/************************************************************************/
+/*                         GetFileStatistics()                          */
+/************************************************************************/
+
+char **VSICurlFilesystemHandler::GetFileStatistics( const char* pszFilename )
+{
+    CPLMutexHolder oHolder( &hMutex );
+
+    std::map<CPLString, FileStatistics>::const_iterator oIter =
+        m_oMapFileStatistics.find(pszFilename);
+    if( oIter == m_oMapFileStatistics.end() )
+        return nullptr;
+
+    CPLStringList aosStats;
+    aosStats.SetNameValue("CACHE_HITS",
+        CPLSPrintf(CPL_FRMT_GUIB, oIter->second.nCacheHits));
+    aosStats.SetNameValue("CACHE_MISSES",
+        CPLSPrintf(CPL_FRMT_GUIB, oIter->second.nCacheMisses));
+    aosStats.SetNameValue("READ_AHEAD_COUNT",
+        CPLSPrintf(CPL_FRMT_GUIB, oIter->second.nReadAheadCount));
+    aosStats.SetNameValue("BYTES_DOWNLOADED",
+        CPLSPrintf(CPL_FRMT_GUIB, oIter->second.nBytesDownloaded));
+    aosStats.SetNameValue("BYTES_READ_AHEAD",
+        CPLSPrintf(CPL_FRMT_GUIB, oIter->second.nBytesReadAhead));
+    return aosStats.StealList();
+}
+
+/************************************************************************/
+/*                          GetCacheDirKey()                            */
+/************************************************************************/
+
+// Computes the key of a chunk in the persistent cache, and the name of the
+// file that holds it. The key includes the ETag or, failing that, the
+// modification time of the file, so that the content of modified files is
+// not served from the cache. Returns false if none of them is known.
+// Files are spread in 256 subdirectories, named after the first byte of
+// the hash of the key, to keep directories small.
+bool VSICurlFilesystemHandler::GetCacheDirKey( const char* pszURL,
+                                               vsi_l_offset nFileOffsetStart,
+                                               CPLString& osKey,
+                                               CPLString& osCacheFilename )
+{
+    CPLMutexHolder oHolder( &hMutex );
+
+    std::map<CPLString, CachedFileProp*>::const_iterator oIter =
+        cacheFileSize.find(pszURL);
+    if( oIter == cacheFileSize.end() )
+        return false;
+    CPLString osValidator;
+    if( !oIter->second->osETag.empty() )
+        osValidator = "ETag=" + oIter->second->osETag;
+    else if( oIter->second->mTime > 0 )
+        osValidator.Printf("mtime=" CPL_FRMT_GIB,
+                           static_cast<GIntBig>(oIter->second->mTime));
+    else
+        return false;
+
+    osKey.Printf("%s\n%s\n" CPL_FRMT_GUIB "\n%d",
+                 pszURL, osValidator.c_str(), nFileOffsetStart,
+                 DOWNLOAD_CHUNK_SIZE);
+
+    GByte abyHash[CPL_SHA256_HASH_SIZE];
+    CPL_SHA256(osKey.c_str(), osKey.size(), abyHash);
+    char* pszHex = CPLBinaryToHex(16, abyHash);
+    const CPLString osPrefix(CPLString(pszHex).substr(0, 2));
+    const CPLString osSubDir(
+        CPLFormFilename(m_osCacheDir, osPrefix, nullptr));
+    osCacheFilename = CPLFormFilename(osSubDir, pszHex, "bin");
+    CPLFree(pszHex);
+    return true;
+}
+
 /************************************************************************/
 /*                   GetRegionFromCacheDisk()                           */
 /************************************************************************/
@@ -2649,116 +3373,294 @@ VSICurlFilesystemHandler::GetRegionFromCacheDisk(const char* pszURL,
 {
     nFileOffsetStart =
         (nFileOffsetStart / DOWNLOAD_CHUNK_SIZE) * DOWNLOAD_CHUNK_SIZE;
-    VSILFILE* fp = VSIFOpenL(VSICurlGetCacheFileName(), "rb");
-    if( fp )
+
+    CPLString osKey;
+    CPLString osCacheFilename;
+    if( !GetCacheDirKey(pszURL, nFileOffsetStart, osKey, osCacheFilename) )
+        return nullptr;
+
+    // Entries are written in a temporary file and renamed, so a file that
+    // exists is complete.
+    VSILFILE* fp = VSIFOpenL(osCacheFilename, "rb");
+    if( fp == nullptr )
+        return nullptr;
+
+    const size_t nHeaderSize =
+        strlen(VSICURL_CACHE_DIR_MAGIC) + sizeof(GUInt32) + osKey.size();
+    std::vector<char> abyData;
+    bool bOK = VSIFSeekL(fp, 0, SEEK_END) == 0;
+    const vsi_l_offset nFileSize = VSIFTellL(fp);
+    if( bOK && nFileSize >= nHeaderSize &&
+        nFileSize - nHeaderSize <=
+                        static_cast<vsi_l_offset>(DOWNLOAD_CHUNK_SIZE) )
     {
-        const unsigned long pszURLHash = CPLHashSetHashStr(pszURL);
-        while( true )
+        abyData.resize(static_cast<size_t>(nFileSize));
+        bOK = VSIFSeekL(fp, 0, SEEK_SET) == 0 &&
+              VSIFReadL(&abyData[0], 1, abyData.size(), fp) ==
+                                                            abyData.size();
+    }
+    else
+    {
+        bOK = false;
+    }
+    CPL_IGNORE_RET_VAL(VSIFCloseL(fp));
+
+    // Check that this is not a hash collision.
+    GUInt32 nKeySize = 0;
+    if( bOK )
+    {
+        memcpy(&nKeySize, &abyData[strlen(VSICURL_CACHE_DIR_MAGIC)],
+               sizeof(nKeySize));
+        CPL_LSBPTR32(&nKeySize);
+        bOK = memcmp(&abyData[0], VSICURL_CACHE_DIR_MAGIC,
+                     strlen(VSICURL_CACHE_DIR_MAGIC)) == 0 &&
+              nKeySize == osKey.size() &&
+              memcmp(&abyData[nHeaderSize - osKey.size()], osKey.c_str(),
+                     osKey.size()) == 0;
+    }
+    if( !bOK )
+        return nullptr;
+
+#ifndef WIN32
+    // Update the modification time, which is what the LRU eviction of
+    // TrimCacheDir() relies on.
+    utime(osCacheFilename, nullptr);
+#endif
+
+    if( ENABLE_DEBUG )
+        CPLDebug("VSICURL", "Got data at offset "
+                 CPL_FRMT_GUIB " from disk", nFileOffsetStart);
+    const size_t nSize = abyData.size() - nHeaderSize;
+    return AddRegionToMemoryCache(pszURL, nFileOffsetStart, nSize,
+                                  nSize ? &abyData[nHeaderSize] : nullptr);
+}
+
+/************************************************************************/
+/*                  AddRegionToCacheDisk()                                */
+/************************************************************************/
+
+void VSICurlFilesystemHandler::AddRegionToCacheDisk(
+                                            const char* pszURL,
+                                            vsi_l_offset nFileOffsetStart,
+                                            size_t nSize,
+                                            const char *pData )
+{
+    CPLString osKey;
+    CPLString osCacheFilename;
+    if( !GetCacheDirKey(pszURL, nFileOffsetStart, osKey, osCacheFilename) )
+        return;
+
+    VSIStatBufL sStat;
+    if( VSIStatExL(osCacheFilename, &sStat, VSI_STAT_EXISTS_FLAG) == 0 )
+        return;
+
+    // Write in a file specific to this process and thread, and rename it
+    // once complete, so that other processes never see partial content.
+    const CPLString osTmpFilename(osCacheFilename +
+        CPLSPrintf(".%d_" CPL_FRMT_GIB ".tmp",
+                   CPLGetCurrentProcessID(), CPLGetPID()));
+    VSILFILE* fp = VSIFOpenL(osTmpFilename, "wb");
+    if( fp == nullptr )
+    {
+        // First file of its subdirectory.
+        VSIMkdir(CPLGetPath(osCacheFilename), 0755);
+        fp = VSIFOpenL(osTmpFilename, "wb");
+        if( fp == nullptr )
+            return;
+    }
+
+    GUInt32 nKeySize = static_cast<GUInt32>(osKey.size());
+    CPL_LSBPTR32(&nKeySize);
+    bool bOK =
+        VSIFWriteL(VSICURL_CACHE_DIR_MAGIC, 1,
+                   strlen(VSICURL_CACHE_DIR_MAGIC), fp) ==
+                                        strlen(VSICURL_CACHE_DIR_MAGIC) &&
+        VSIFWriteL(&nKeySize, 1, sizeof(nKeySize), fp) == sizeof(nKeySize) &&
+        VSIFWriteL(osKey.c_str(), 1, osKey.size(), fp) == osKey.size() &&
+        (nSize == 0 || VSIFWriteL(pData, 1, nSize, fp) == nSize);
+    bOK = VSIFCloseL(fp) == 0 && bOK;
+    if( !bOK || VSIRename(osTmpFilename, osCacheFilename) != 0 )
+    {
+        VSIUnlink(osTmpFilename);
+        return;
+    }
+
+    if( ENABLE_DEBUG )
+        CPLDebug("VSICURL",
+                 "Write data at offset " CPL_FRMT_GUIB " to disk",
+                 nFileOffsetStart);
+
+    UpdateCacheDirSize(static_cast<GIntBig>(strlen(VSICURL_CACHE_DIR_MAGIC) +
+                                            sizeof(nKeySize) +
+                                            osKey.size() + nSize),
+                       false);
+}
+
+/************************************************************************/
+/*                          ReadCacheDirSize()                          */
+/************************************************************************/
+
+// Returns the size recorded in the size file of the cache directory, or -1
+// if there is none.
+GIntBig VSICurlFilesystemHandler::ReadCacheDirSize()
+{
+    VSILFILE* fp = VSIFOpenL(
+        CPLFormFilename(m_osCacheDir, VSICURL_CACHE_DIR_SIZE_FILE, nullptr),
+        "rb");
+    if( fp == nullptr )
+        return -1;
+    char szBuffer[32] = {};
+    CPL_IGNORE_RET_VAL(VSIFReadL(szBuffer, 1, sizeof(szBuffer) - 1, fp));
+    CPL_IGNORE_RET_VAL(VSIFCloseL(fp));
+    if( szBuffer[0] < '0' || szBuffer[0] > '9' )
+        return -1;
+    return CPLAtoGIntBig(szBuffer);
+}
+
+/************************************************************************/
+/*                          WriteCacheDirSize()                         */
+/************************************************************************/
+
+void VSICurlFilesystemHandler::WriteCacheDirSize( GIntBig nSize )
+{
+    const CPLString osFilename(
+        CPLFormFilename(m_osCacheDir, VSICURL_CACHE_DIR_SIZE_FILE, nullptr));
+    const CPLString osTmpFilename(osFilename +
+        CPLSPrintf(".%d_" CPL_FRMT_GIB ".tmp",
+                   CPLGetCurrentProcessID(), CPLGetPID()));
+    VSILFILE* fp = VSIFOpenL(osTmpFilename, "wb");
+    if( fp == nullptr )
+        return;
+    const char* pszSize = CPLSPrintf(CPL_FRMT_GIB, std::max<GIntBig>(0, nSize));
+    bool bOK = VSIFWriteL(pszSize, 1, strlen(pszSize), fp) == strlen(pszSize);
+    bOK = VSIFCloseL(fp) == 0 && bOK;
+    if( !bOK || VSIRename(osTmpFilename, osFilename) != 0 )
+        VSIUnlink(osTmpFilename);
+}
+
+/************************************************************************/
+/*                         UpdateCacheDirSize()                         */
+/************************************************************************/
+
+// Adds the bytes written by this process to the size file of the cache
+// directory, once they reach 1% of CPL_VSIL_CURL_CACHE_DIR_SIZE (or when
+// bForce is set), and trims the directory when the size exceeds it. The
+// size file saves a scan of the directory at each update. It is only
+// approximate when several processes update it at the same time, and
+// becomes exact again after each trim.
+void VSICurlFilesystemHandler::UpdateCacheDirSize( GIntBig nAddedBytes,
+                                                   bool bForce )
+{
+    {
+        CPLMutexHolder oHolder( &m_hCacheDirMutex );
+        m_nCacheDirPendingBytes += nAddedBytes;
+        if( m_bCacheDirTrimInProgress || m_nCacheDirPendingBytes == 0 ||
+            (!bForce &&
+             m_nCacheDirPendingBytes < m_nCacheDirMaxSize / 100) )
         {
-            unsigned long pszURLHashCached = 0;
-            if( VSIFReadL(&pszURLHashCached, sizeof(unsigned long),
-                          1, fp) == 0 )
-                break;
-            vsi_l_offset nFileOffsetStartCached = 0;
-            if( VSIFReadL(&nFileOffsetStartCached, sizeof(vsi_l_offset),
-                          1, fp) == 0)
-                break;
-            size_t nSizeCached = 0;
-            if( VSIFReadL(&nSizeCached, sizeof(size_t), 1, fp) == 0)
-                break;
-            if( pszURLHash == pszURLHashCached &&
-                nFileOffsetStart == nFileOffsetStartCached )
-            {
-                if( ENABLE_DEBUG )
-                    CPLDebug("VSICURL", "Got data at offset "
-                             CPL_FRMT_GUIB " from disk", nFileOffsetStart);
-                if( nSizeCached )
-                {
-                    char* pBuffer = static_cast<char *>(CPLMalloc(nSizeCached));
-                    if( VSIFReadL(pBuffer, 1, nSizeCached, fp) != nSizeCached )
-                    {
-                        CPLFree(pBuffer);
-                        break;
-                    }
-                    AddRegion(pszURL, nFileOffsetStart, nSizeCached, pBuffer);
-                    CPLFree(pBuffer);
-                }
-                else
-                {
-                    AddRegion(pszURL, nFileOffsetStart, 0, nullptr);
-                }
-                CPL_IGNORE_RET_VAL(VSIFCloseL(fp));
-                return GetRegion(pszURL, nFileOffsetStart);
-            }
-            else
-            {
-                if( VSIFSeekL(fp, nSizeCached, SEEK_CUR) != 0 )
-                    break;
-            }
+            return;
         }
-        CPL_IGNORE_RET_VAL(VSIFCloseL(fp));
+
+        // A missing size file, e.g. in a directory created by a former
+        // version, is computed by TrimCacheDir().
+        const GIntBig nRecordedSize = ReadCacheDirSize();
+        if( nRecordedSize >= 0 &&
+            nRecordedSize + m_nCacheDirPendingBytes <= m_nCacheDirMaxSize )
+        {
+            WriteCacheDirSize(nRecordedSize + m_nCacheDirPendingBytes);
+            m_nCacheDirPendingBytes = 0;
+            return;
+        }
+        m_nCacheDirPendingBytes = 0;
+        m_bCacheDirTrimInProgress = true;
     }
-    return nullptr;
+
+    // Scanning the directory can be long: let the other threads of this
+    // process write to it meanwhile.
+    WriteCacheDirSize(TrimCacheDir());
+
+    CPLMutexHolder oHolder( &m_hCacheDirMutex );
+    m_bCacheDirTrimInProgress = false;
 }
 
 /************************************************************************/
-/*                  AddRegionToCacheDisk()                                */
+/*                           TrimCacheDir()                             */
 /************************************************************************/
 
-void VSICurlFilesystemHandler::AddRegionToCacheDisk(CachedRegion* psRegion)
+// Removes the least recently used entries of the persistent cache until
+// its size is below 90% of CPL_VSIL_CURL_CACHE_DIR_SIZE, as well as
+// temporary files left by killed processes. Returns the size of the
+// remaining entries.
+GIntBig VSICurlFilesystemHandler::TrimCacheDir()
 {
-    VSILFILE* fp = VSIFOpenL(VSICurlGetCacheFileName(), "r+b");
-    if( fp )
+    struct CacheDirEntry
     {
-        while( true )
+        CPLString    osFilename;
+        GIntBig      nMTime;
+        GIntBig      nSize;
+    };
+    std::vector<CacheDirEntry> asEntries;
+    GIntBig nTotalSize = 0;
+    const GIntBig nNow = static_cast<GIntBig>(time(nullptr));
+
+    std::vector<CPLString> aosDirs;
+    aosDirs.push_back(m_osCacheDir);
+    for( size_t iDir = 0; iDir < aosDirs.size(); iDir++ )
+    {
+        char** papszFiles = VSIReadDir(aosDirs[iDir]);
+        for( char** papszIter = papszFiles; papszIter && *papszIter;
+             ++papszIter )
         {
-            unsigned long pszURLHashCached = 0;
-            if( VSIFReadL(&pszURLHashCached, 1, sizeof(unsigned long),
-                          fp) == 0 )
-                break;
-            vsi_l_offset nFileOffsetStartCached = 0;
-            if( VSIFReadL(&nFileOffsetStartCached, sizeof(vsi_l_offset), 1, fp)
-                == 0 )
-                break;
-            size_t nSizeCached = 0;
-            if( VSIFReadL(&nSizeCached, sizeof(size_t), 1, fp) == 0 )
-                break;
-            if( psRegion->pszURLHash == pszURLHashCached &&
-                psRegion->nFileOffsetStart == nFileOffsetStartCached )
+            const CPLString osFilename(
+                CPLFormFilename(aosDirs[iDir], *papszIter, nullptr));
+            // Subdirectories of the sharded layout.
+            if( iDir == 0 && strlen(*papszIter) == 2 &&
+                isxdigit(static_cast<unsigned char>((*papszIter)[0])) &&
+                isxdigit(static_cast<unsigned char>((*papszIter)[1])) )
             {
-                CPLAssert(psRegion->nSize == nSizeCached);
-                CPL_IGNORE_RET_VAL(VSIFCloseL(fp));
-                return;
+                aosDirs.push_back(osFilename);
+                continue;
             }
-            else
+            const bool bIsTmp = EQUAL(CPLGetExtension(*papszIter), "tmp");
+            if( !bIsTmp && !EQUAL(CPLGetExtension(*papszIter), "bin") )
+                continue;
+            VSIStatBufL sStat;
+            if( VSIStatL(osFilename, &sStat) != 0 )
+                continue;
+            if( bIsTmp )
             {
-                if( VSIFSeekL(fp, nSizeCached, SEEK_CUR) != 0 )
-                    break;
+                if( nNow - static_cast<GIntBig>(sStat.st_mtime) > 3600 )
+                    VSIUnlink(osFilename);
+                continue;
             }
+            CacheDirEntry sEntry;
+            sEntry.osFilename = osFilename;
+            sEntry.nMTime = static_cast<GIntBig>(sStat.st_mtime);
+            sEntry.nSize = static_cast<GIntBig>(sStat.st_size);
+            nTotalSize += sEntry.nSize;
+            asEntries.push_back(sEntry);
         }
+        CSLDestroy(papszFiles);
     }
-    else
-    {
-        fp = VSIFOpenL(VSICurlGetCacheFileName(), "wb");
-    }
-    if( fp )
-    {
-        if( ENABLE_DEBUG )
-            CPLDebug("VSICURL",
-                     "Write data at offset " CPL_FRMT_GUIB " to disk",
-                     psRegion->nFileOffsetStart);
-        CPL_IGNORE_RET_VAL(VSIFWriteL(&psRegion->pszURLHash, 1,
-                                      sizeof(unsigned long), fp));
-        CPL_IGNORE_RET_VAL(VSIFWriteL(&psRegion->nFileOffsetStart, 1,
-                                      sizeof(vsi_l_offset), fp));
-        CPL_IGNORE_RET_VAL(VSIFWriteL(&psRegion->nSize, 1, sizeof(size_t), fp));
-        if( psRegion->nSize )
-            CPL_IGNORE_RET_VAL(
-                VSIFWriteL(psRegion->pData, 1, psRegion->nSize, fp));
 
-        CPL_IGNORE_RET_VAL(VSIFCloseL(fp));
+    if( nTotalSize <= m_nCacheDirMaxSize )
+        return nTotalSize;
+
+    std::sort(asEntries.begin(), asEntries.end(),
+              [](const CacheDirEntry& a, const CacheDirEntry& b)
+              { return a.nMTime < b.nMTime; });
+    const GIntBig nTargetSize = m_nCacheDirMaxSize / 10 * 9;
+    size_t nRemoved = 0;
+    for( ; nRemoved < asEntries.size() && nTotalSize > nTargetSize;
+         nRemoved++ )
+    {
+        // Another process might have removed it already: not an error.
+        VSIUnlink(asEntries[nRemoved].osFilename);
+        nTotalSize -= asEntries[nRemoved].nSize;
     }
-    return;
+    CPLDebug("VSICURL", "Removed %d entries from %s",
+             static_cast<int>(nRemoved), m_osCacheDir.c_str());
+    return nTotalSize;
 }
 
 /************************************************************************/
@@ -2769,25 +3671,30 @@ const CachedRegion*
 VSICurlFilesystemHandler::GetRegion( const char* pszURL,
                                      vsi_l_offset nFileOffsetStart )
 {
-    CPLMutexHolder oHolder( &hMutex );
-
     const unsigned long pszURLHash = CPLHashSetHashStr(pszURL);
 
     nFileOffsetStart =
         (nFileOffsetStart / DOWNLOAD_CHUNK_SIZE) * DOWNLOAD_CHUNK_SIZE;
 
-    for( int i = 0; i < nRegions; i++ )
     {
-        CachedRegion* psRegion = papsRegions[i];
-        if( psRegion->pszURLHash == pszURLHash &&
-            nFileOffsetStart == psRegion->nFileOffsetStart )
+        CPLMutexHolder oHolder( &hMutex );
+
+        for( int i = 0; i < nRegions; i++ )
         {
-            memmove(papsRegions + 1, papsRegions, i * sizeof(CachedRegion*));
-            papsRegions[0] = psRegion;
-            return psRegion;
+            CachedRegion* psRegion = papsRegions[i];
+            if( psRegion->pszURLHash == pszURLHash &&
+                nFileOffsetStart == psRegion->nFileOffsetStart )
+            {
+                memmove(papsRegions + 1, papsRegions,
+                        i * sizeof(CachedRegion*));
+                papsRegions[0] = psRegion;
+                return psRegion;
+            }
         }
     }
-    if( bUseCacheDisk )
+
+    // Read the cache directory without holding the mutex.
+    if( IsCacheDirEnabled() )
         return GetRegionFromCacheDisk(pszURL, nFileOffsetStart);
     return nullptr;
 }
@@ -2800,13 +3707,46 @@ void VSICurlFilesystemHandler::AddRegion( const char* pszURL,
                                           vsi_l_offset nFileOffsetStart,
                                           size_t nSize,
                                           const char *pData )
+{
+    AddRegionToMemoryCache(pszURL, nFileOffsetStart, nSize, pData);
+
+    // Written from pData rather than from the cached region, which
+    // another thread may evict meanwhile, so that the mutex is not held
+    // during the disk I/O.
+    if( IsCacheDirEnabled() )
+        AddRegionToCacheDisk(pszURL, nFileOffsetStart, nSize, pData);
+}
+
+/************************************************************************/
+/*                       AddRegionToMemoryCache()                       */
+/************************************************************************/
+
+CachedRegion* VSICurlFilesystemHandler::AddRegionToMemoryCache(
+                                            const char* pszURL,
+                                            vsi_l_offset nFileOffsetStart,
+                                            size_t nSize,
+                                            const char *pData )
 {
     CPLMutexHolder oHolder( &hMutex );
 
     const unsigned long pszURLHash = CPLHashSetHashStr(pszURL);
 
     CachedRegion* psRegion = nullptr;
-    if( nRegions == N_MAX_REGIONS )
+    for( int i = 0; i < nRegions; i++ )
+    {
+        if( papsRegions[i]->pszURLHash == pszURLHash &&
+            papsRegions[i]->nFileOffsetStart == nFileOffsetStart )
+        {
+            // Already cached (e.g. fetched by another thread): reuse the
+            // slot rather than holding the same chunk twice.
+            psRegion = papsRegions[i];
+            memmove(papsRegions + 1, papsRegions, i * sizeof(CachedRegion*));
+            papsRegions[0] = psRegion;
+            CPLFree(psRegion->pData);
+            break;
+        }
+    }
+    if( psRegion == nullptr && nRegions == N_MAX_REGIONS )
     {
         psRegion = papsRegions[N_MAX_REGIONS-1];
         memmove(papsRegions + 1,
@@ -2815,7 +3755,7 @@ void VSICurlFilesystemHandler::AddRegion( const char* pszURL,
         papsRegions[0] = psRegion;
         CPLFree(psRegion->pData);
     }
-    else
+    else if( psRegion == nullptr )
     {
         papsRegions = static_cast<CachedRegion **>(
             CPLRealloc(papsRegions, (nRegions + 1) * sizeof(CachedRegion*)));
@@ -2835,8 +3775,7 @@ void VSICurlFilesystemHandler::AddRegion( const char* pszURL,
     if( nSize )
         memcpy(psRegion->pData, pData, nSize);
 
-    if( bUseCacheDisk )
-        AddRegionToCacheDisk(psRegion);
+    return psRegion;
 }
 
 /************************************************************************/
@@ -2942,6 +3881,12 @@ void VSICurlFilesystemHandler::ClearCache()
         delete iterConnections->second;
     }
     mapConnections.clear();
+
+    m_oMapFileStatistics.clear();
+
+    if( IsCacheDirEnabled() )
+        UpdateCacheDirSize(0, true);
+    InitCacheDir();
 }
 
 /************************************************************************/
@@ -2994,6 +3939,10 @@ const char* VSICurlFilesystemHandler::GetActualURL(const char* pszFilename)
     "  <Option name='GDAL_HTTP_MERGE_CONSECUTIVE_RANGES' type='boolean' " \
         "description='Whether to merge consecutive ranges in multirange " \
         "requests' default='YES'/>" \
+    "  <Option name='GDAL_HTTP_MERGE_RANGES_MAX_GAP' type='int' " \
+        "description='Maximum number of bytes between two ranges of a " \
+        "multirange request for them to be fetched by a single request' " \
+        "default='16384'/>" \
     "  <Option name='CPL_VSIL_CURL_NON_CACHED' type='string' " \
         "description='Colon-separated list of filenames whose content" \
         "must not be cached across open attempts'/>" \
@@ -3017,7 +3966,20 @@ const char* VSICurlFilesystemHandler::GetActualURL(const char* pszFilename)
         "file' default='16384' min='1024' max='10485760'/>" \
     "  <Option name='CPL_VSIL_CURL_CACHE_SIZE' type='integer' " \
         "description='Size in bytes of the global /vsicurl/ cache' " \
-        "default='16384000'/>"
+        "default='16384000'/>" \
+    "  <Option name='CPL_VSIL_CURL_CACHE_DIR' type='string' " \
+        "description='Directory of a persistent cache of downloaded data, " \
+        "that can be shared by several processes'/>" \
+    "  <Option name='CPL_VSIL_CURL_CACHE_DIR_SIZE' type='integer' " \
+        "description='Maximum size in bytes of the persistent cache' " \
+        "default='1073741824'/>" \
+    "  <Option name='CPL_VSIL_CURL_READ_AHEAD' type='boolean' " \
+        "description='Whether to download in the background the data that " \
+        "follows the one being read, when a file is read sequentially' " \
+        "default='YES'/>" \
+    "  <Option name='CPL_VSIL_CURL_READ_AHEAD_MAX_SIZE' type='integer' " \
+        "description='Maximum size in bytes of the data downloaded at once " \
+        "when a file is read sequentially' default='4194304'/>"
 
 const char* VSICurlFilesystemHandler::GetOptions()
 {
@@ -8549,4 +9511,37 @@ void VSICurlClearCache( void )
     VSICurlStreamingClearCache();
 }
 
+/************************************************************************/
+/*                      VSICurlGetFileStatistics()                      */
+/************************************************************************/
+
+/**
+ * \brief Return the statistics of the reads of a /vsicurl/ (or related
+ * file systems) file.
+ *
+ * The statistics are accumulated over the handles of the file that have
+ * been closed, until VSICurlClearCache() is called. They are returned as a
+ * list of KEY=VALUE strings, with the following keys: CACHE_HITS and
+ * CACHE_MISSES (reads of chunks found or not in the memory cache),
+ * READ_AHEAD_COUNT (number of read aheads started), BYTES_DOWNLOADED and
+ * BYTES_READ_AHEAD (of which downloaded by read aheads).
+ *
+ * @param pszFilename the filename, for example
+ * "/vsicurl/http://example.com/a.tif".
+ * @return a list to free with CSLDestroy(), or NULL if no statistics are
+ * available for the file.
+ *
+ * @since GDAL 2.3
+ */
+
+char **VSICurlGetFileStatistics( const char* pszFilename )
+{
+    VSICurlFilesystemHandler *poFSHandler =
+        dynamic_cast<VSICurlFilesystemHandler*>(
+            VSIFileManager::GetHandler( pszFilename ));
+    if( poFSHandler == nullptr )
+        return nullptr;
+    return poFSHandler->GetFileStatistics(pszFilename);
+}
+
 #endif /* HAVE_CURL */
@@ -109,6 +109,9 @@ CPL_CVSID("$Id$")
 #ifndef VSI_FTRUNCATE64
 #define VSI_FTRUNCATE64 ftruncate64
 #endif
+#if !defined(VSI_PREAD64) && defined(HAVE_PREAD64)
+#define VSI_PREAD64 pread64
+#endif
 
 #else /* not UNIX_STDIO_64 */
 
@@ -130,6 +133,9 @@ CPL_CVSID("$Id$")
 #ifndef VSI_FTRUNCATE64
 #define VSI_FTRUNCATE64 ftruncate
 #endif
+#if !defined(VSI_PREAD64) && defined(HAVE_PREAD)
+#define VSI_PREAD64 pread
+#endif
 
 #endif /* ndef UNIX_STDIO_64 */
 
@@ -206,6 +212,11 @@ class VSIUnixStdioHandle final : public VSIVirtualHandle
     int Flush() override;
     int Close() override;
     int Truncate( vsi_l_offset nNewSize ) override;
+#ifdef VSI_PREAD64
+    int ReadMultiRange( int nRanges, void ** ppData,
+                        const vsi_l_offset* panOffsets,
+                        const size_t* panSizes ) override;
+#endif
     void *GetNativeFileDescriptor() override {
         return reinterpret_cast<void *>(static_cast<size_t>(fileno(fp))); }
     VSIRangeStatus GetRangeStatus( vsi_l_offset nOffset,
@@ -439,6 +450,50 @@ size_t VSIUnixStdioHandle::Read( void * pBuffer, size_t nSize, size_t nCount )
     return nResult;
 }
 
+/************************************************************************/
+/*                          ReadMultiRange()                            */
+/************************************************************************/
+
+#ifdef VSI_PREAD64
+// Read the ranges with positional reads, directly into the destination
+// buffers, without going through the stdio buffer nor moving the file
+// position.
+int VSIUnixStdioHandle::ReadMultiRange( int nRanges, void ** ppData,
+                                        const vsi_l_offset* panOffsets,
+                                        const size_t* panSizes )
+{
+    // Writes might still be in the stdio buffer.
+    if( !bReadOnly )
+        return VSIVirtualHandle::ReadMultiRange(nRanges, ppData,
+                                                panOffsets, panSizes);
+
+    const int fd = fileno(fp);
+    for( int i = 0; i < nRanges; i++ )
+    {
+        GByte* pabyData = static_cast<GByte*>(ppData[i]);
+        vsi_l_offset nOffset = panOffsets[i];
+        size_t nRemaining = panSizes[i];
+        while( nRemaining > 0 )
+        {
+            const ssize_t nRead =
+                VSI_PREAD64( fd, pabyData, nRemaining, nOffset );
+            if( nRead < 0 && errno == EINTR )
+                continue;
+            if( nRead <= 0 )
+                return -1;
+            pabyData += nRead;
+            nOffset += nRead;
+            nRemaining -= nRead;
+#ifdef VSI_COUNT_BYTES_READ
+            nTotalBytesRead += nRead;
+#endif
+        }
+    }
+
+    return 0;
+}
+#endif
+
 /************************************************************************/
 /*                               Write()                                */
 /************************************************************************/
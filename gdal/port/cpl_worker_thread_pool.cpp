@@ -506,3 +506,146 @@ CPLWorkerThreadPool::GetNextJob( CPLWorkerThread* psWorkerThread )
         //    return psJob;
     }
 }
+
+/************************************************************************/
+/*                            CPLJobQueue()                             */
+/************************************************************************/
+
+namespace {
+typedef struct
+{
+    CPLJobQueue   *poQueue;
+    CPLThreadFunc  pfnFunc;
+    void          *pData;
+} CPLJobQueueJob;
+}  // namespace
+
+/** Instantiate a new queue of jobs run by a pool of worker threads.
+ *
+ * @param poPool Pool, already setup, that must outlive the queue.
+ */
+CPLJobQueue::CPLJobQueue( CPLWorkerThreadPool* poPool ) :
+    m_poPool(poPool),
+    m_hCond(CPLCreateCond()),
+    m_nPendingJobs(0)
+{
+    m_hMutex = CPLCreateMutexEx(CPL_MUTEX_REGULAR);
+    CPLReleaseMutex(m_hMutex);
+}
+
+/************************************************************************/
+/*                           ~CPLJobQueue()                             */
+/************************************************************************/
+
+/** Destroys a queue of jobs.
+ *
+ * Any still pending job of the queue will be completed before the
+ * destructor returns.
+ */
+CPLJobQueue::~CPLJobQueue()
+{
+    WaitCompletion();
+    CPLDestroyCond(m_hCond);
+    CPLDestroyMutex(m_hMutex);
+}
+
+/************************************************************************/
+/*                            JobFunction()                             */
+/************************************************************************/
+
+void CPLJobQueue::JobFunction( void* user_data )
+{
+    CPLJobQueueJob* psJob = static_cast<CPLJobQueueJob *>(user_data);
+    CPLJobQueue* poQueue = psJob->poQueue;
+    psJob->pfnFunc(psJob->pData);
+    CPLFree(psJob);
+    poQueue->DeclareJobFinished();
+}
+
+/************************************************************************/
+/*                          DeclareJobFinished()                        */
+/************************************************************************/
+
+void CPLJobQueue::DeclareJobFinished()
+{
+    CPLAcquireMutex(m_hMutex, 1000.0);
+    m_nPendingJobs--;
+    CPLCondSignal(m_hCond);
+    CPLReleaseMutex(m_hMutex);
+}
+
+/************************************************************************/
+/*                             SubmitJob()                              */
+/************************************************************************/
+
+/** Queue a new job.
+ *
+ * @param pfnFunc Function to run for the job.
+ * @param pData User data to pass to the job function.
+ * @return true in case of success.
+ */
+bool CPLJobQueue::SubmitJob( CPLThreadFunc pfnFunc, void* pData )
+{
+    std::vector<void*> apData;
+    apData.push_back(pData);
+    return SubmitJobs(pfnFunc, apData);
+}
+
+/************************************************************************/
+/*                             SubmitJobs()                             */
+/************************************************************************/
+
+/** Queue several jobs
+ *
+ * @param pfnFunc Function to run for the job.
+ * @param apData User data instances to pass to the job function.
+ * @return true in case of success.
+ */
+bool CPLJobQueue::SubmitJobs( CPLThreadFunc pfnFunc,
+                              const std::vector<void*>& apData )
+{
+    std::vector<void*> apJobs;
+    for( size_t i = 0; i < apData.size(); i++ )
+    {
+        CPLJobQueueJob* psJob = static_cast<CPLJobQueueJob *>(
+            VSI_MALLOC_VERBOSE(sizeof(CPLJobQueueJob)));
+        if( psJob == nullptr )
+        {
+            for( size_t j = 0; j < apJobs.size(); j++ )
+                VSIFree(apJobs[j]);
+            return false;
+        }
+        psJob->poQueue = this;
+        psJob->pfnFunc = pfnFunc;
+        psJob->pData = apData[i];
+        apJobs.push_back(psJob);
+    }
+
+    CPLAcquireMutex(m_hMutex, 1000.0);
+    m_nPendingJobs += static_cast<int>(apJobs.size());
+    CPLReleaseMutex(m_hMutex);
+
+    if( !m_poPool->SubmitJobs(JobFunction, apJobs) )
+    {
+        for( size_t j = 0; j < apJobs.size(); j++ )
+            VSIFree(apJobs[j]);
+        CPLAcquireMutex(m_hMutex, 1000.0);
+        m_nPendingJobs -= static_cast<int>(apJobs.size());
+        CPLReleaseMutex(m_hMutex);
+        return false;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                            WaitCompletion()                          */
+/************************************************************************/
+
+/** Wait for completion of all the jobs submitted through this queue. */
+void CPLJobQueue::WaitCompletion()
+{
+    CPLAcquireMutex(m_hMutex, 1000.0);
+    while( m_nPendingJobs > 0 )
+        CPLCondWait(m_hCond, m_hMutex);
+    CPLReleaseMutex(m_hMutex);
+}
@@ -104,4 +104,35 @@ class CPL_DLL CPLWorkerThreadPool
         int GetThreadCount() const { return (int)aWT.size(); }
 };
 
+/** Queue of jobs submitted to a pool of worker threads that may be shared
+ * with other users of the pool.
+ *
+ * WaitCompletion() only waits for the jobs submitted through this queue.
+ * @since GDAL 2.3
+ */
+class CPL_DLL CPLJobQueue
+{
+        CPLWorkerThreadPool* m_poPool;
+        CPLMutex* m_hMutex;
+        CPLCond* m_hCond;
+        int m_nPendingJobs;
+
+        static void JobFunction(void* user_data);
+
+        void DeclareJobFinished();
+
+        CPL_DISALLOW_COPY_ASSIGN(CPLJobQueue)
+
+    public:
+        explicit CPLJobQueue(CPLWorkerThreadPool* poPool);
+       ~CPLJobQueue();
+
+        bool SubmitJob(CPLThreadFunc pfnFunc, void* pData);
+        bool SubmitJobs(CPLThreadFunc pfnFunc, const std::vector<void*>& apData);
+        void WaitCompletion();
+
+        /** Return the pool the jobs are run by */
+        CPLWorkerThreadPool* GetPool() { return m_poPool; }
+};
+
 #endif // CPL_WORKER_THREAD_POOL_H_INCLUDED_